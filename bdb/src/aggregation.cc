@@ -0,0 +1,289 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/aggregation.cc
+ * Contains implementation of class "bdb::aggregation".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cstring>
+#include <map>
+#include <string>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::aggregation".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::string;
+
+/**
+ * @private Adds one record to aggregated values of a group.
+ */
+static void add_value (aggregate_value * group,     /**< [in/out] Aggregated values.              */
+                       bool              found,     /**< [in]     Whether the record has a value. */
+                       int64_t           value)     /**< [in]     Value of the record.            */
+{
+    group->count++;
+
+    if (!found) return;
+
+    if (group->values == 0 || value < group->min) group->min = value;
+    if (group->values == 0 || value > group->max) group->max = value;
+
+    group->sum += value;
+    group->values++;
+}
+
+/**
+ * @private Merges aggregated values of two groups.
+ */
+static void merge_value (aggregate_value       * to,      /**< [in/out] Resulted values. */
+                         const aggregate_value & from)    /**< [in]     Merged values.   */
+{
+    if (from.values != 0)
+    {
+        if (to->values == 0 || from.min < to->min) to->min = from.min;
+        if (to->values == 0 || from.max > to->max) to->max = from.max;
+    }
+
+    to->count  += from.count;
+    to->values += from.values;
+    to->sum    += from.sum;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Makes empty aggregation of specified field. Only integer types of the field are supported
+ * (values of "uint64" and "fixed64" fields are aggregated as signed ones). Records are grouped
+ * by raw value of grouping field (see "bdb::field_value"), so string groups are keyed by contents of
+ * the strings, and records without the field are in the group with empty key.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the field type is not supported.
+ */
+aggregation::aggregation (int field,    /**< [in] Aggregated field ("0" - records are counted only).   */
+                          int type,     /**< [in] Type of the field (see @ref fieldtypes "types").     */
+                          int group)    /**< [in] Grouping field ("0" - all records are in one group). */
+  : m_field(field),
+    m_type(type),
+    m_group(group)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::aggregation::aggregation] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::aggregation::aggregation] field = " << field << ", type = " << type << ", group = " << group);
+
+    if (type == BDB_FIELD_STRING || type == BDB_FIELD_FLOAT || type == BDB_FIELD_DOUBLE)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::aggregation::aggregation] Only integer fields can be aggregated.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::aggregation::aggregation] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Aggregates all remaining records of specified recordset, fetching them as views (see "bdb::recordset::fetch_view").
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void aggregation::run (recordset * rs)  /**< [in] Recordset to aggregate. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::aggregation::run] ENTER");
+
+    record_view view;
+
+    while (rs->fetch_view(NULL, &view))
+    {
+        add(&view);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::aggregation::run] EXIT = " << m_groups.size());
+}
+
+/**
+ * Adds a record, fetched as a view, to the aggregation.
+ */
+void aggregation::add (const record_view * view)    /**< [in] View of the record data. */
+{
+    DBT data;
+    view->make(&data);
+
+    add(&data);
+}
+
+/**
+ * Adds serialized data of a record to the aggregation (e.g. from callback of parallel scan).
+ */
+void aggregation::add (const DBT * data)    /**< [in] Serialized data of the record. */
+{
+    string key;
+
+    if (m_group != 0)
+    {
+        field_value raw;
+
+        if (extract_field(data, m_group, &raw))
+        {
+            key.assign((const char *) raw.data, raw.size);
+        }
+    }
+
+    aggregate_groups::iterator i = m_groups.find(key);
+
+    if (i == m_groups.end())
+    {
+        aggregate_value empty;
+        memset(&empty, 0, sizeof(aggregate_value));
+
+        i = m_groups.insert(aggregate_groups::value_type(key, empty)).first;
+    }
+
+    int64_t value = 0;
+    bool    found = (m_field != 0 && decode(data, &value));
+
+    add_value(&i->second, found, value);
+}
+
+/**
+ * Merges partial aggregation of the same field (e.g. of another worker of parallel scan) into this one.
+ */
+void aggregation::merge (const aggregation & other)     /**< [in] Partial aggregation. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::aggregation::merge] ENTER");
+
+    for (aggregate_groups::const_iterator i = other.m_groups.begin(); i != other.m_groups.end(); ++i)
+    {
+        aggregate_groups::iterator j = m_groups.find(i->first);
+
+        if (j == m_groups.end())
+        {
+            m_groups.insert(*i);
+        }
+        else
+        {
+            merge_value(&j->second, i->second);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::aggregation::merge] EXIT");
+}
+
+/**
+ * Removes all aggregated values.
+ */
+void aggregation::clear ()
+{
+    m_groups.clear();
+}
+
+/**
+ * Returns aggregated values by groups.
+ */
+const aggregate_groups & aggregation::groups () const
+{
+    return m_groups;
+}
+
+/**
+ * Returns aggregated values of all records, regardless of groups.
+ */
+aggregate_value aggregation::total () const
+{
+    aggregate_value total;
+    memset(&total, 0, sizeof(aggregate_value));
+
+    for (aggregate_groups::const_iterator i = m_groups.begin(); i != m_groups.end(); ++i)
+    {
+        merge_value(&total, i->second);
+    }
+
+    return total;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Decodes value of aggregated field from serialized data of a record, according to the field type.
+ *
+ * @return true  - the value is decoded.
+ * @return false - the record doesn't contain the field.
+ */
+bool aggregation::decode (const DBT * data,     /**< [in]  Serialized data of the record. */
+                          int64_t   * value)    /**< [out] Value of the field.            */
+    const
+{
+    int64_t raw;
+
+    if (!extract_field(data, m_field, &raw)) return false;
+
+    switch (m_type)
+    {
+        case BDB_FIELD_SINT32:
+        case BDB_FIELD_SINT64:
+            *value = (int64_t) ((uint64_t) raw >> 1) ^ -(raw & 1);
+            break;
+
+        case BDB_FIELD_UINT32:
+        case BDB_FIELD_FIXED32:
+            *value = (int64_t) (uint32_t) raw;
+            break;
+
+        case BDB_FIELD_SFIXED32:
+            *value = (int64_t) (int32_t) (uint32_t) raw;
+            break;
+
+        default:
+            *value = raw;
+    }
+
+    return true;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
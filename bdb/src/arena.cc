@@ -0,0 +1,171 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/arena.cc
+ * Contains implementation of class "bdb::arena".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <map>
+#include <vector>
+
+// Protocol Buffers
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::arena".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Makes empty arena.
+ */
+arena::arena ()
+{ }
+
+/**
+ * Deletes all messages of the arena.
+ */
+arena::~arena () throw ()
+{
+    clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns empty message of the same type as specified prototype, owned by the arena.
+ * The message is taken from released messages of the type, if any, otherwise it is created.
+ * The message is valid until the arena is reset or cleared.
+ */
+Message * arena::create (const Message * prototype)     /**< [in] Message of required type (e.g. default instance). */
+{
+    vector <Message*> & released = m_free[prototype->GetDescriptor()];
+
+    Message * msg;
+
+    if (released.empty())
+    {
+        msg = prototype->New();
+    }
+    else
+    {
+        msg = released.back();
+        released.pop_back();
+    }
+
+    m_used.push_back(msg);
+
+    return msg;
+}
+
+/**
+ * Releases one message of the current batch before the batch ends. The message is cleared and kept.
+ */
+void arena::release (Message * msg)     /**< [in] Message of the arena. */
+{
+    // the message is usually the last one created
+    for (size_t i = m_used.size(); i > 0; i--)
+    {
+        if (m_used[i - 1] == msg)
+        {
+            m_used.erase(m_used.begin() + (i - 1));
+
+            msg->Clear();
+            m_free[msg->GetDescriptor()].push_back(msg);
+
+            return;
+        }
+    }
+}
+
+/**
+ * Releases all messages of the current batch at once. The messages are cleared and kept for next batches.
+ */
+void arena::reset ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::arena::reset] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::arena::reset] messages = " << m_used.size());
+
+    for (size_t i = 0; i < m_used.size(); i++)
+    {
+        Message * msg = m_used[i];
+
+        msg->Clear();
+        m_free[msg->GetDescriptor()].push_back(msg);
+    }
+
+    m_used.clear();
+
+    LOG4CPLUS_TRACE(logger, "[bdb::arena::reset] EXIT");
+}
+
+/**
+ * Deletes all messages of the arena, including released ones.
+ */
+void arena::clear ()
+{
+    for (size_t i = 0; i < m_used.size(); i++)
+    {
+        delete m_used[i];
+    }
+
+    for (free_lists::iterator i = m_free.begin(); i != m_free.end(); ++i)
+    {
+        for (size_t n = 0; n < i->second.size(); n++)
+        {
+            delete i->second[n];
+        }
+    }
+
+    m_used.clear();
+    m_free.clear();
+}
+
+/**
+ * Returns number of messages of the current batch.
+ */
+size_t arena::size () const
+{
+    return m_used.size();
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,734 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/async.cc
+ * Contains implementation of classes "bdb::async_database" and "bdb::async_result".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cassert>
+#include <deque>
+#include <map>
+#include <vector>
+
+// Protocol Buffers
+#include <google/protobuf/message.h>
+
+// Boost C++ Libraries
+#include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of classes "bdb::async_database" and "bdb::async_result".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::deque;
+using std::map;
+using std::vector;
+
+using google::protobuf::Message;
+
+/** @private Kinds of asynchronous operations. */
+enum { ASYNC_EXISTS, ASYNC_SELECT, ASYNC_INSERT, ASYNC_UPDATE, ASYNC_REMOVE };
+
+/** @private Completion state of asynchronous result. */
+class async_state
+{
+public:
+
+    async_state () : ready(true), error(0), found(false) { }
+
+    boost::mutex                mutex;      /**< Guards all the fields below.          */
+    boost::condition_variable   cond;       /**< Signals completion of the operation.  */
+    bool                        ready;      /**< Whether the operation is completed.   */
+    int                         error;      /**< Error of the operation ("0" if none). */
+    bool                        found;      /**< Whether the record is found.          */
+};
+
+/** @private Queued asynchronous operation. */
+class async_operation
+{
+public:
+
+    async_operation (int                 op_kind,
+                     const Message     * op_key,
+                     const Message     * op_input,
+                     Message           * op_output,
+                     async_result      * op_result,
+                     completion_callback op_done,
+                     void              * op_param)
+      : kind(op_kind),
+        key(op_key),
+        input(op_input),
+        output(op_output),
+        result(op_result),
+        fn_done(op_done),
+        param(op_param),
+        error(0),
+        found(false)
+    {
+    }
+
+    int                 kind;       /**< Kind of the operation.                     */
+    const Message     * key;        /**< Key of the record.                         */
+    const Message     * input;      /**< Data to write ("NULL" for reads).          */
+    Message           * output;     /**< Data to read ("NULL" for other operations). */
+    async_result      * result;     /**< Result to complete ("NULL" if none).        */
+    completion_callback fn_done;    /**< Completion callback ("NULL" if none).       */
+    void              * param;      /**< Parameter of the callback.                  */
+    int                 error;      /**< Error of executed operation.                */
+    bool                found;      /**< Whether the record is found.                */
+
+    /** Checks whether the operation doesn't change the table. */
+    bool is_read () const
+    {
+        return (kind == ASYNC_EXISTS || kind == ASYNC_SELECT);
+    }
+};
+
+/** @private Queue of asynchronous operations of one table. */
+class table_queue
+{
+public:
+
+    table_queue () : busy(false) { }
+
+    deque <async_operation>     ops;        /**< Queued operations, in order of submission.    */
+    bool                        busy;       /**< Whether a worker runs operations of the table. */
+};
+
+/**
+ * @private Queues of asynchronous operations by tables, and worker threads (own ones, or tasks of shared work pool
+ * of the database), which run them. Each table is run by one worker at a time, so operations of a table complete
+ * in order of their queue, while operations of different tables run concurrently.
+ */
+class async_queue
+{
+public:
+
+    async_queue (database * db, unsigned int nbatch, work_pool * pool)
+      : m_database(db),
+        m_batch(nbatch == 0 ? 1 : nbatch),
+        m_pool(pool),
+        m_pending(0),
+        m_tasks(0),
+        m_stop(false),
+        m_executor(NULL),
+        m_executor_param(NULL)
+    {
+    }
+
+    /** Sets executor of completions ("NULL" - workers complete operations themselves). */
+    void set_executor (executor_callback fn_post, void * param)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        m_executor       = fn_post;
+        m_executor_param = param;
+    }
+
+    /** Queues specified operation of the table. */
+    void push (table * tbl, const async_operation & op)
+    {
+        if (op.result != NULL) op.result->reset();
+
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        table_queue & queue = m_tables[tbl];
+
+        // table with queued operations is already ready (or busy)
+        if (queue.ops.empty() && !queue.busy)
+        {
+            make_ready(tbl);
+        }
+
+        queue.ops.push_back(op);
+        m_pending++;
+    }
+
+    /** Waits until all queued operations are completed. */
+    void flush ()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        while (m_pending != 0)
+        {
+            m_idle.wait(lock);
+        }
+    }
+
+    /** Returns number of queued (not completed yet) operations. */
+    size_t pending ()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        return m_pending;
+    }
+
+    /** Stops worker threads (or waits for tasks of the pool), when all queued operations are completed. */
+    void stop ()
+    {
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            m_stop = true;
+            m_work.notify_all();
+
+            while (m_tasks != 0)
+            {
+                m_idle.wait(lock);
+            }
+        }
+
+        m_threads.join_all();
+    }
+
+    /** Starts specified number of own worker threads. */
+    void start (unsigned int nthreads)
+    {
+        for (unsigned int i = 0; i < nthreads; i++)
+        {
+            m_threads.create_thread(boost::bind(&async_queue::run, this));
+        }
+    }
+
+protected:
+
+    /** Marks the table as ready, and wakes up a worker (or submits a task to the pool). Must be called under lock. */
+    void make_ready (table * tbl)
+    {
+        m_ready.push_back(tbl);
+
+        if (m_pool == NULL)
+        {
+            m_work.notify_one();
+        }
+        else
+        {
+            m_tasks++;
+            m_pool->submit(async_queue::run_task, this);
+        }
+    }
+
+    /**
+     * Runs ready tables, until the queue is stopped and all operations are completed. Body of own worker thread.
+     */
+    void run ()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        for (;;)
+        {
+            while (m_ready.empty() && !m_stop)
+            {
+                m_work.wait(lock);
+            }
+
+            if (m_ready.empty()) return;
+
+            run_ready(lock);
+        }
+    }
+
+    /**
+     * Runs one ready table. Body of task of the pool (one task is submitted per ready table).
+     */
+    static void run_task (void * param)
+    {
+        async_queue * queue = static_cast <async_queue *> (param);
+
+        boost::mutex::scoped_lock lock(queue->m_mutex);
+
+        if (!queue->m_ready.empty()) queue->run_ready(lock);
+
+        queue->m_tasks--;
+
+        if (queue->m_tasks == 0) queue->m_idle.notify_all();
+    }
+
+    /**
+     * Takes a ready table, and runs the longest sequence of its reads (or writes) from the head of its queue.
+     * Must be called under the lock, which is released while the operations run.
+     */
+    void run_ready (boost::mutex::scoped_lock & lock)
+    {
+        vector <async_operation> ops;
+
+        executor_callback fn_post  = m_executor;
+        void            * post_arg = m_executor_param;
+
+        table * tbl = m_ready.front();
+        m_ready.pop_front();
+
+        {
+            table_queue & queue = m_tables[tbl];
+            queue.busy = true;
+
+            bool read = queue.ops.front().is_read();
+
+            while (!queue.ops.empty() && ops.size() < m_batch && queue.ops.front().is_read() == read)
+            {
+                ops.push_back(queue.ops.front());
+                queue.ops.pop_front();
+            }
+        }
+
+        lock.unlock();
+
+        if (ops[0].is_read())
+        {
+            execute_reads(tbl, ops);
+        }
+        else
+        {
+            execute_writes(tbl, ops);
+        }
+
+        // callbacks may queue next operations of the same table
+        for (size_t i = 0; i < ops.size(); i++)
+        {
+            if (fn_post == NULL)
+            {
+                complete(&ops[i]);
+            }
+            else
+            {
+                async_operation * op = new async_operation(ops[i]);
+                assert(op != NULL);
+
+                fn_post(async_queue::deliver, op, post_arg);
+            }
+        }
+
+        lock.lock();
+
+        table_queue & queue = m_tables[tbl];
+        queue.busy = false;
+
+        if (!queue.ops.empty())
+        {
+            make_ready(tbl);
+        }
+
+        m_pending -= ops.size();
+
+        if (m_pending == 0) m_idle.notify_all();
+    }
+
+    /**
+     * Runs reads of the table. Selects are run as one pass of a cursor in order of keys,
+     * and are retried one by one, if the pass fails.
+     */
+    void execute_reads (table * tbl, vector <async_operation> & ops)
+    {
+        keylist         keys;
+        datalist        data;
+        vector <size_t> selects;
+
+        for (size_t i = 0; i < ops.size(); i++)
+        {
+            if (ops[i].kind == ASYNC_SELECT && ops.size() > 1)
+            {
+                keys.push_back(ops[i].key);
+                data.push_back(ops[i].output);
+                selects.push_back(i);
+            }
+            else
+            {
+                execute_one(tbl, &ops[i]);
+            }
+        }
+
+        if (selects.empty()) return;
+
+        try
+        {
+            vector <bool> found;
+            tbl->select_many(keys, data, &found);
+
+            for (size_t i = 0; i < selects.size(); i++)
+            {
+                ops[selects[i]].found = found[i];
+                ops[selects[i]].error = (found[i] ? 0 : BDB_ERROR_NOT_FOUND);
+            }
+        }
+        catch (exception &)
+        {
+            for (size_t i = 0; i < selects.size(); i++)
+            {
+                execute_one(tbl, &ops[selects[i]]);
+            }
+        }
+    }
+
+    /**
+     * Runs writes of the table, committing them in one transaction, and retries them one by one, if it fails.
+     */
+    void execute_writes (table * tbl, vector <async_operation> & ops)
+    {
+        if (ops.size() == 1)
+        {
+            execute_one(tbl, &ops[0]);
+            return;
+        }
+
+        try
+        {
+            write_batch batch(m_database);
+
+            for (size_t i = 0; i < ops.size(); i++)
+            {
+                switch (ops[i].kind)
+                {
+                    case ASYNC_INSERT:  batch.insert(tbl, ops[i].key, ops[i].input); break;
+                    case ASYNC_UPDATE:  batch.update(tbl, ops[i].key, ops[i].input); break;
+                    default:            batch.remove(tbl, ops[i].key);               break;
+                }
+            }
+
+            batch.commit();
+        }
+        catch (exception &)
+        {
+            // the batch is rolled back, so each write is retried, and completes with its own error
+            for (size_t i = 0; i < ops.size(); i++)
+            {
+                execute_one(tbl, &ops[i]);
+            }
+        }
+    }
+
+    /** Completes result of executed operation, and calls its completion callback. */
+    static void complete (const async_operation * op)
+    {
+        if (op->result  != NULL) op->result->complete(op->error, op->found);
+        if (op->fn_done != NULL) op->fn_done(op->error, op->found, op->param);
+    }
+
+    /** Completes executed operation, handed over to executor, and deletes it. */
+    static void deliver (void * arg)
+    {
+        async_operation * op = static_cast <async_operation *> (arg);
+
+        complete(op);
+        delete op;
+    }
+
+    /** Runs single operation of the table, keeping its error. */
+    static void execute_one (table * tbl, async_operation * op)
+    {
+        try
+        {
+            switch (op->kind)
+            {
+                case ASYNC_EXISTS:  op->found = tbl->exists(op->key);       break;
+                case ASYNC_SELECT:  tbl->select(op->key, op->output);       op->found = true;   break;
+                case ASYNC_INSERT:  tbl->insert(op->key, op->input);        break;
+                case ASYNC_UPDATE:  tbl->update(op->key, op->input);        break;
+                default:            tbl->remove(op->key);                   break;
+            }
+
+            op->error = 0;
+        }
+        catch (exception & e)
+        {
+            op->error = e.error();
+        }
+        catch (...)
+        {
+            op->error = BDB_ERROR_UNKNOWN;
+        }
+    }
+
+protected:
+
+    database                      * m_database;         /**< Database of the tables.                                  */
+    size_t                          m_batch;            /**< Maximum number of operations, run at once.               */
+    work_pool                     * m_pool;             /**< Shared pool, which runs the tables ("NULL" - own threads). */
+
+    boost::mutex                    m_mutex;            /**< Guards all the fields below.                             */
+    boost::condition_variable       m_work;             /**< Signals ready tables (and stop) to workers.              */
+    boost::condition_variable       m_idle;             /**< Signals completion of all queued operations.             */
+    map <table *, table_queue>      m_tables;           /**< Queues of tables.                                        */
+    deque <table *>                 m_ready;            /**< Tables with queued operations, which no worker runs.     */
+    size_t                          m_pending;          /**< Number of queued (not executed yet) operations.          */
+    size_t                          m_tasks;            /**< Number of submitted, but not finished tasks of the pool. */
+    bool                            m_stop;             /**< Whether workers should stop, when queues are empty.      */
+    executor_callback               m_executor;         /**< Executor of completions ("NULL" if none).                */
+    void                          * m_executor_param;   /**< Parameter of the executor.                               */
+
+    boost::thread_group             m_threads;          /**< Worker threads.                                          */
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Result.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Makes result, which is not used by any operation yet (so it's ready).
+ */
+async_result::async_result ()
+  : m_state(new async_state)
+{
+    assert(m_state != NULL);
+}
+
+/**
+ * Deletes the result (its operation must be completed).
+ */
+async_result::~async_result () throw ()
+{
+    delete m_state;
+}
+
+/**
+ * Checks whether the operation is completed.
+ */
+bool async_result::is_ready ()
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+    return m_state->ready;
+}
+
+/**
+ * Waits until the operation is completed.
+ *
+ * @return Error of the operation ("0" on success, or one of "BDB_ERROR_*").
+ */
+int async_result::wait ()
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    while (!m_state->ready)
+    {
+        m_state->cond.wait(lock);
+    }
+
+    return m_state->error;
+}
+
+/**
+ * Waits until the operation is completed, and checks whether the record is found ("exists" and "select").
+ */
+bool async_result::found ()
+{
+    wait();
+
+    boost::mutex::scoped_lock lock(m_state->mutex);
+    return m_state->found;
+}
+
+/**
+ * Prepares the result for another operation.
+ */
+void async_result::reset ()
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    m_state->ready = false;
+    m_state->error = 0;
+    m_state->found = false;
+}
+
+/**
+ * Completes the result, waking up the waiting threads.
+ */
+void async_result::complete (int  error,    /**< [in] Error of the operation.        */
+                             bool found)    /**< [in] Whether the record is found.   */
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    m_state->ready = true;
+    m_state->error = error;
+    m_state->found = found;
+
+    m_state->cond.notify_all();
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Starts worker threads of the database.
+ */
+async_database::async_database (database   * db,        /**< [in] Database of the tables.                          */
+                                unsigned int nthreads,  /**< [in] Number of own worker threads ("0" - shared work pool of the database). */
+                                unsigned int batch)     /**< [in] Maximum number of operations of a table, run at once. */
+  : m_queue(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::async_database] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::async_database::async_database] threads = " << nthreads << ", batch = " << batch);
+
+    m_queue = new async_queue(db, batch, (nthreads == 0 ? db->m_pool : NULL));
+    assert(m_queue != NULL);
+
+    m_queue->start(nthreads);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::async_database] EXIT");
+}
+
+/**
+ * Completes all queued operations, and stops worker threads.
+ */
+async_database::~async_database () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::~async_database] ENTER");
+
+    m_queue->stop();
+    delete m_queue;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::~async_database] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Queues check that a record with specified key exists (see "bdb::table::exists").
+ * The operation completes with "found" flag of the record.
+ */
+void async_database::exists (table             * tbl,       /**< [in] Table of the record.                   */
+                             const Message     * key,       /**< [in] Key of the record.                     */
+                             async_result      * result,    /**< [in] Result to complete ("NULL" if none).   */
+                             completion_callback fn_done,   /**< [in] Completion callback ("NULL" if none).  */
+                             void              * param)     /**< [in] Parameter of the callback.             */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::exists] ENTER");
+    m_queue->push(tbl, async_operation(ASYNC_EXISTS, key, NULL, NULL, result, fn_done, param));
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::exists] EXIT");
+}
+
+/**
+ * Queues retrieval of a record with specified key (see "bdb::table::select").
+ * The operation completes with "BDB_ERROR_NOT_FOUND", if the record is not found.
+ */
+void async_database::select (table             * tbl,       /**< [in]  Table of the record.                  */
+                             const Message     * key,       /**< [in]  Key of the record.                    */
+                             Message           * data,      /**< [out] Data of the found record.             */
+                             async_result      * result,    /**< [in]  Result to complete ("NULL" if none).  */
+                             completion_callback fn_done,   /**< [in]  Completion callback ("NULL" if none). */
+                             void              * param)     /**< [in]  Parameter of the callback.            */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::select] ENTER");
+    m_queue->push(tbl, async_operation(ASYNC_SELECT, key, NULL, data, result, fn_done, param));
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::select] EXIT");
+}
+
+/**
+ * Queues insertion of new record (see "bdb::table::insert").
+ */
+void async_database::insert (table             * tbl,       /**< [in] Table of the record.                   */
+                             const Message     * key,       /**< [in] Key of new record.                     */
+                             const Message     * data,      /**< [in] Data of new record.                    */
+                             async_result      * result,    /**< [in] Result to complete ("NULL" if none).   */
+                             completion_callback fn_done,   /**< [in] Completion callback ("NULL" if none).  */
+                             void              * param)     /**< [in] Parameter of the callback.             */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::insert] ENTER");
+    m_queue->push(tbl, async_operation(ASYNC_INSERT, key, data, NULL, result, fn_done, param));
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::insert] EXIT");
+}
+
+/**
+ * Queues update of existing record (see "bdb::table::update").
+ */
+void async_database::update (table             * tbl,       /**< [in] Table of the record.                   */
+                             const Message     * key,       /**< [in] Key of the record.                     */
+                             const Message     * data,      /**< [in] New data of the record.                */
+                             async_result      * result,    /**< [in] Result to complete ("NULL" if none).   */
+                             completion_callback fn_done,   /**< [in] Completion callback ("NULL" if none).  */
+                             void              * param)     /**< [in] Parameter of the callback.             */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::update] ENTER");
+    m_queue->push(tbl, async_operation(ASYNC_UPDATE, key, data, NULL, result, fn_done, param));
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::update] EXIT");
+}
+
+/**
+ * Queues deletion of existing record (see "bdb::table::remove").
+ */
+void async_database::remove (table             * tbl,       /**< [in] Table of the record.                   */
+                             const Message     * key,       /**< [in] Key of the record.                     */
+                             async_result      * result,    /**< [in] Result to complete ("NULL" if none).   */
+                             completion_callback fn_done,   /**< [in] Completion callback ("NULL" if none).  */
+                             void              * param)     /**< [in] Parameter of the callback.             */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::remove] ENTER");
+    m_queue->push(tbl, async_operation(ASYNC_REMOVE, key, NULL, NULL, result, fn_done, param));
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::remove] EXIT");
+}
+
+/**
+ * Sets executor of completions, which the workers hand completed operations over to, instead of completing
+ * them themselves. The executor is used by operations, executed after the call.
+ */
+void async_database::set_executor (executor_callback fn_post,  /**< [in] Executor ("NULL" - workers complete operations). */
+                                   void            * param)    /**< [in] Parameter of the executor.                       */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::set_executor] ENTER");
+    m_queue->set_executor(fn_post, param);
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::set_executor] EXIT");
+}
+
+/**
+ * Waits until all queued operations are executed (with an executor, their completions may be not delivered yet).
+ */
+void async_database::flush ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::flush] ENTER");
+    m_queue->flush();
+    LOG4CPLUS_TRACE(logger, "[bdb::async_database::flush] EXIT");
+}
+
+/**
+ * Returns number of queued operations, which are not completed yet.
+ */
+size_t async_database::pending ()
+{
+    return m_queue->pending();
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
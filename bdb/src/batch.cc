@@ -0,0 +1,692 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/batch.cc
+ * Contains implementation of class "bdb::write_batch".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// Bulk puts are available since Berkeley DB 4.8
+#if (DB_VERSION_MAJOR > 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR >= 8)
+#define BDB_BULK_PUT
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::write_batch".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::map;
+using std::pair;
+using std::set;
+using std::string;
+using std::vector;
+
+using google::protobuf::Message;
+
+/** @private Kinds of batch changes. */
+enum { BATCH_INSERT, BATCH_UPDATE, BATCH_REMOVE };
+
+/** @private Size of service data, which the bulk buffer needs per record, besides key and data. */
+static const size_t BATCH_RECORD_OVERHEAD = 8 * sizeof(u_int32_t);
+
+/** @private Single change of the batch. */
+class batch_mutation
+{
+public:
+
+    table  * tbl;       /**< Changed table.                         */
+    int      kind;      /**< Kind of the change.                    */
+    string   key;       /**< Serialized key.                        */
+    string   data;      /**< Serialized data (empty for removals).  */
+};
+
+/**
+ * @private Foreign keys, which are verified in a transaction. The keys stay valid until the transaction ends,
+ * since the transaction holds read locks of them.
+ */
+class foreign_cache
+{
+public:
+
+    foreign_cache () : txn(NULL), id(0) { }
+
+    DB_TXN                              * txn;  /**< Transaction of the keys ("NULL" if none).    */
+    u_int32_t                             id;   /**< Identifier of the transaction.             */
+    set <pair <const index *, string> >   keys; /**< Verified keys of constrained indexes.      */
+};
+
+/**
+ * @private Last changes of records of a batch by their tables and serialized keys (see "bdb::write_batch::find").
+ * Equal keys are serialized to the same bytes, so the keys are compared as they are.
+ */
+class batch_overlay
+{
+public:
+
+    map <pair <const table *, string>, size_t> latest;  /**< Indexes of last changes in the batch. */
+};
+
+/**
+ * @private Makes "DBT" object, which references specified string.
+ */
+static void make_dbt (const string & from,  /**< [in]  Source string.       */
+                      DBT          * to)    /**< [out] Resulted "DBT" object. */
+{
+    memset(to, 0, sizeof(DBT));
+
+    to->data = (void *) from.data();
+    to->size = (u_int32_t) from.size();
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Creates empty batch.
+ */
+write_batch::write_batch (database * db,        /**< [in] Database of the batch.                                       */
+                          bool       validate)  /**< [in] Whether foreign keys of the batch are validated before writing. */
+  : m_database(db),
+    m_mutations(NULL),
+    m_validate(validate),
+    m_verified(NULL),
+    m_overlay(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::write_batch] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::write_batch::write_batch] validate = " << validate);
+
+    m_mutations = new vector <batch_mutation>;
+    assert(m_mutations != NULL);
+
+    m_verified = new foreign_cache;
+    assert(m_verified != NULL);
+
+    m_overlay = new batch_overlay;
+    assert(m_overlay != NULL);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::write_batch] EXIT");
+}
+
+/**
+ * Discards all changes, which are not committed.
+ */
+write_batch::~write_batch () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::~write_batch] ENTER");
+
+    delete m_mutations;
+    delete m_verified;
+    delete m_overlay;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::~write_batch] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds new record to the batch (see "table::insert").
+ */
+void write_batch::insert (table             * tbl,      /**< [in] Table of the record. */
+                          key_ref             key,      /**< [in] Key of new record.   */
+                          const MessageLite * data)     /**< [in] Data of new record.  */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::insert] ENTER");
+
+    tbl->check_open();
+
+    scratch_scope scope;
+    DBT k, d;
+
+    tbl->encode_key(key, &k, &scope);
+    scope.serialize(data, &d);
+    tbl->stamp_value(&d, &scope);
+
+    add(tbl, BATCH_INSERT, &k, &d);
+
+    release(&k);
+    release(&d);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::insert] EXIT");
+}
+
+/**
+ * Adds update of existing record to the batch (see "table::update").
+ */
+void write_batch::update (table             * tbl,      /**< [in] Table of the record.          */
+                          key_ref             key,      /**< [in] Key of the record to be updated. */
+                          const MessageLite * data)     /**< [in] New data of the record.       */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::update] ENTER");
+
+    tbl->check_open();
+
+    scratch_scope scope;
+    DBT k, d;
+
+    tbl->encode_key(key, &k, &scope);
+    scope.serialize(data, &d);
+    tbl->stamp_value(&d, &scope);
+
+    add(tbl, BATCH_UPDATE, &k, &d);
+
+    release(&k);
+    release(&d);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::update] EXIT");
+}
+
+/**
+ * Adds removal of existing record to the batch (see "table::remove").
+ */
+void write_batch::remove (table         * tbl,      /**< [in] Table of the record.             */
+                          key_ref         key)      /**< [in] Key of the record to be deleted. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::remove] ENTER");
+
+    tbl->check_open();
+
+    scratch_scope scope;
+    DBT k;
+
+    tbl->encode_key(key, &k, &scope);
+
+    add(tbl, BATCH_REMOVE, &k, NULL);
+
+    release(&k);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::remove] EXIT");
+}
+
+/**
+ * Checks whether specified record exists, taking changes of the batch into account.
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+bool write_batch::exists (table         * tbl,  /**< [in] Table of the record.                         */
+                          key_ref         key,  /**< [in] Key of the record.                           */
+                          transaction   * txn)  /**< [in] Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::exists] ENTER");
+
+    string data;
+
+    int kind = lookup(tbl, key, &data);
+
+    bool res = (kind == 0 ? tbl->exists(key, txn) : kind != BATCH_REMOVE);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::exists] EXIT = " << res);
+
+    return res;
+}
+
+/**
+ * Finds specified record, taking changes of the batch into account (see "table::find").
+ *
+ * @return true  - the record is found.
+ * @return false - the record is not found ("data" is not changed).
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+bool write_batch::find (table         * tbl,    /**< [in]  Table of the record.                         */
+                        key_ref         key,    /**< [in]  Key of the record.                           */
+                        MessageLite   * data,   /**< [out] Data of the record.                          */
+                        transaction   * txn)    /**< [in]  Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::find] ENTER");
+
+    string value;
+
+    int kind = lookup(tbl, key, &value);
+
+    if (kind == 0)
+    {
+        bool res = tbl->find(key, data, txn);
+        LOG4CPLUS_TRACE(logger, "[bdb::write_batch::find] EXIT = " << res);
+        return res;
+    }
+
+    DBT d;
+    make_dbt(value, &d);
+
+    // changed data can expire as well as written ones
+    if (kind == BATCH_REMOVE || tbl->is_expired(&d))
+    {
+        LOG4CPLUS_TRACE(logger, "[bdb::write_batch::find] EXIT = false");
+        return false;
+    }
+
+    tbl->unserialize_data(&d, data);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::find] EXIT = true");
+
+    return true;
+}
+
+/**
+ * Applies all changes of the batch in a single transaction, and clears the batch.
+ * The changes are applied grouped by tables and ordered by keys, so pages of each table are visited
+ * sequentially; changes of the same record are applied in order they were added. Consecutive insertions
+ * into a table without covering indexes are put at once ("DB_MULTIPLE_KEY").
+ * In bulk-load mode, distinct foreign keys of inserted and updated records are looked up once before
+ * anything is written, and keys, verified by previous batches of the same transaction, are not looked
+ * up again; Berkeley DB still enforces the constraints (including cascades) on every change.
+ * When an error occurs, none of the changes is applied, and the batch keeps them.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND   - updated or removed record is not found.
+ * @throw bdb::exception BDB_ERROR_EXISTS      - inserted key already exists.
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - foreign constraint violation.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ */
+void write_batch::commit (transaction * txn)    /**< [in] Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::commit] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::write_batch::commit] size = " << m_mutations->size());
+
+    std::stable_sort(m_mutations->begin(), m_mutations->end(), less);
+
+    // failed batch keeps its changes, so they are found again in their new order
+    reindex();
+
+    DB_TXN * parent = m_database->get_transaction(txn);
+    DB_TXN * ctxn   = NULL;
+
+    size_t failed = 0;
+
+    int res = m_database->begin_txn(parent, &ctxn, BDB_DURABILITY_DEFAULT);
+
+    if (res == 0 && m_validate) res = validate(ctxn, parent, &failed);
+    if (res == 0) res = apply(ctxn, &failed);
+
+    if (res == 0)
+    {
+        DB_TXN * committed = ctxn;
+        ctxn = NULL;
+        res = m_database->commit_txn(committed, BDB_DURABILITY_DEFAULT, parent != NULL);
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::write_batch::commit] " << db_strerror(res));
+        LOG4CPLUS_DEBUG(logger, "[bdb::write_batch::commit] failed = " << failed);
+
+        if (ctxn != NULL) m_database->abort_txn(ctxn);
+
+        // locks of keys, verified by the failed batch, are released
+        m_verified->keys.clear();
+        m_verified->txn = NULL;
+
+        switch (res)
+        {
+            case DB_NOTFOUND:           throw exception(BDB_ERROR_NOT_FOUND);
+            case DB_KEYEMPTY:           throw exception(BDB_ERROR_NOT_FOUND);
+            case EINVAL:                throw exception(BDB_ERROR_EXISTS);
+            case DB_KEYEXIST:           throw exception(BDB_ERROR_EXISTS);
+            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    m_mutations->clear();
+    m_overlay->latest.clear();
+
+    // locks of verified keys are released with own transaction
+    if (parent == NULL)
+    {
+        m_verified->keys.clear();
+        m_verified->txn = NULL;
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::commit] EXIT");
+}
+
+/**
+ * Discards all changes of the batch.
+ */
+void write_batch::clear ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::clear] ENTER");
+    m_mutations->clear();
+    m_overlay->latest.clear();
+    LOG4CPLUS_TRACE(logger, "[bdb::write_batch::clear] EXIT");
+}
+
+/**
+ * Returns number of changes in the batch.
+ */
+size_t write_batch::size ()
+{
+    return m_mutations->size();
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * @private Adds change of specified serialized record to the batch ("data" is "NULL" for removals).
+ */
+void write_batch::add (table     * tbl,     /**< [in] Table of the record.  */
+                       int         kind,    /**< [in] Kind of the change.   */
+                       const DBT * key,     /**< [in] Serialized key.       */
+                       const DBT * data)    /**< [in] Serialized data.      */
+{
+    m_mutations->push_back(batch_mutation());
+
+    batch_mutation & m = m_mutations->back();
+
+    m.tbl  = tbl;
+    m.kind = kind;
+    m.key.assign((const char *) key->data, key->size);
+
+    if (data != NULL) m.data.assign((const char *) data->data, data->size);
+
+    m_overlay->latest[std::make_pair((const table *) tbl, m.key)] = m_mutations->size() - 1;
+}
+
+/**
+ * @private Finds the last change of specified record in the batch.
+ *
+ * @return Kind of the change ("0" - the record is not changed by the batch).
+ */
+int write_batch::lookup (table   * tbl,     /**< [in]  Table of the record.                 */
+                         key_ref   key,     /**< [in]  Key of the record.                   */
+                         string  * data)    /**< [out] Changed data (unless it's removed).  */
+{
+    tbl->check_open();
+
+    if (m_overlay->latest.empty()) return 0;
+
+    scratch_scope scope;
+    DBT k;
+
+    tbl->encode_key(key, &k, &scope);
+    string raw((const char *) k.data, k.size);
+    release(&k);
+
+    map <pair <const table *, string>, size_t>::const_iterator i = m_overlay->latest.find(std::make_pair((const table *) tbl, raw));
+
+    if (i == m_overlay->latest.end()) return 0;
+
+    const batch_mutation & m = (*m_mutations)[i->second];
+
+    if (m.kind != BATCH_REMOVE) data->assign(m.data);
+
+    return m.kind;
+}
+
+/**
+ * @private Finds the last changes of records again, after the changes are reordered.
+ */
+void write_batch::reindex ()
+{
+    m_overlay->latest.clear();
+
+    for (size_t i = 0; i < m_mutations->size(); i++)
+    {
+        const batch_mutation & m = (*m_mutations)[i];
+        m_overlay->latest[std::make_pair((const table *) m.tbl, m.key)] = i;
+    }
+}
+
+/**
+ * @private Orders changes by tables, and by keys within each table.
+ */
+bool write_batch::less (const batch_mutation & m1,  /**< [in] First change.  */
+                        const batch_mutation & m2)  /**< [in] Second change. */
+{
+    if (m1.tbl != m2.tbl) return (m1.tbl < m2.tbl);
+
+    DBT k1, k2;
+
+    make_dbt(m1.key, &k1);
+    make_dbt(m2.key, &k2);
+
+    return (m1.tbl->compare_keys(&k1, &k2) < 0);
+}
+
+/**
+ * @private Applies all (sorted) changes of the batch in specified transaction.
+ * Returns error code of Berkeley DB.
+ */
+int write_batch::apply (DB_TXN * txn,       /**< [in]  Transaction to use.          */
+                        size_t * failed)    /**< [out] Index of the failed change.  */
+{
+    vector <batch_mutation> & mutations = *m_mutations;
+
+    int res = 0;
+
+    for (size_t i = 0; i < mutations.size() && res == 0; i++)
+    {
+        batch_mutation & m = mutations[i];
+
+        *failed = i;
+
+#ifdef BDB_BULK_PUT
+
+        // find consecutive insertions into the same table, which can be put at once
+        if (m.kind == BATCH_INSERT && !m.tbl->is_tracked())
+        {
+            size_t last = i + 1;
+
+            while (last < mutations.size() && mutations[last].tbl == m.tbl && mutations[last].kind == BATCH_INSERT)
+            {
+                last++;
+            }
+
+            if (last - i > 1)
+            {
+                res = apply_bulk(txn, i, last);
+                i = last - 1;
+                continue;
+            }
+        }
+
+#endif
+
+        DBT k, d;
+
+        make_dbt(m.key,  &k);
+        make_dbt(m.data, &d);
+
+        switch (m.kind)
+        {
+            case BATCH_INSERT:  res = m.tbl->insert_record(txn, &k, &d);    break;
+            case BATCH_UPDATE:  res = m.tbl->update_record(txn, &k, &d);    break;
+            default:            res = m.tbl->remove_record(txn, &k);        break;
+        }
+    }
+
+    return res;
+}
+
+/**
+ * @private Verifies, that foreign keys of all inserted and updated records of the (sorted) batch exist in
+ * their foreign tables, looking up each distinct key once. Verified keys are remembered until parent
+ * transaction ends, so next batches of a bulk load in the same transaction don't look them up again.
+ * Returns error code of Berkeley DB.
+ */
+int write_batch::validate (DB_TXN * txn,        /**< [in]  Transaction to use.                      */
+                           DB_TXN * parent,     /**< [in]  Parent transaction ("NULL" if none).     */
+                           size_t * failed)     /**< [out] Index of the change with missing key.    */
+{
+    vector <batch_mutation> & mutations = *m_mutations;
+
+    // keys, verified in another transaction, are not locked any longer
+    if (parent == NULL || parent != m_verified->txn || parent->id(parent) != m_verified->id)
+    {
+        m_verified->keys.clear();
+        m_verified->txn = parent;
+        m_verified->id  = (parent != NULL ? parent->id(parent) : 0);
+    }
+
+    vector <string> keys;
+
+    int res = 0;
+
+    for (size_t i = 0; i < mutations.size() && res == 0; i++)
+    {
+        batch_mutation & m = mutations[i];
+
+        if (m.kind == BATCH_REMOVE) continue;
+
+        *failed = i;
+
+        for (size_t j = 0; j < m.tbl->m_indexes.size() && res == 0; j++)
+        {
+            index * idx = m.tbl->m_indexes[j];
+
+            // Berkeley DB doesn't change deferred indexes, so their keys are not constrained
+            if (idx->m_foreign == NULL || idx->m_position != NULL) continue;
+
+            keys.clear();
+
+            res = idx->make_keys(m.key, m.data, &keys);
+
+            for (size_t n = 0; n < keys.size() && res == 0; n++)
+            {
+                pair <const index *, string> verified(idx, keys[n]);
+
+                if (m_verified->keys.find(verified) != m_verified->keys.end()) continue;
+
+                DB * foreign = idx->m_foreign->m_db;
+
+                DBT k, d;
+                make_dbt(keys[n], &k);
+                memset(&d, 0, sizeof(DBT));
+
+                // only existence of the key is checked
+                d.flags = DB_DBT_PARTIAL | DB_DBT_USERMEM;
+
+                res = foreign->get(foreign, txn, &k, &d, 0);
+
+                if (res == DB_NOTFOUND || res == DB_KEYEMPTY) res = DB_FOREIGN_CONFLICT;
+
+                if (res == 0) m_verified->keys.insert(verified);
+            }
+        }
+    }
+
+    return res;
+}
+
+/**
+ * @private Puts specified range of insertions into the same table at once ("DB_MULTIPLE_KEY").
+ * Returns error code of Berkeley DB.
+ */
+int write_batch::apply_bulk (DB_TXN * txn,      /**< [in] Transaction to use.               */
+                             size_t   first,    /**< [in] First insertion of the range.     */
+                             size_t   last)     /**< [in] Next after last insertion.        */
+{
+#ifdef BDB_BULK_PUT
+
+    vector <batch_mutation> & mutations = *m_mutations;
+
+    table * tbl = mutations[first].tbl;
+
+    size_t bytes = 0;
+
+    for (size_t i = first; i < last; i++)
+    {
+        bytes += mutations[i].key.size() + mutations[i].data.size() + BATCH_RECORD_OVERHEAD;
+    }
+
+    vector <char> buffer(bytes + BATCH_RECORD_OVERHEAD);
+
+    DBT bulk, empty;
+    memset(&bulk,  0, sizeof(bulk));
+    memset(&empty, 0, sizeof(empty));
+
+    bulk.data  = &buffer[0];
+    bulk.ulen  = buffer.size();
+    bulk.flags = DB_DBT_USERMEM | DB_DBT_BULK;
+
+    void * ptr = NULL;
+    DB_MULTIPLE_WRITE_INIT(ptr, &bulk);
+
+    for (size_t i = first; i < last; i++)
+    {
+        batch_mutation & m = mutations[i];
+
+        DBT k, d;
+        memset(&k, 0, sizeof(DBT));
+        memset(&d, 0, sizeof(DBT));
+
+        k.data = (void *) m.key.data();
+        k.size = (u_int32_t) m.key.size();
+        d.data = (void *) m.data.data();
+        d.size = (u_int32_t) m.data.size();
+
+        tbl->write_bulk(ptr, &bulk, &k, &d);
+        assert(ptr != NULL);
+    }
+
+    return tbl->m_db->put(tbl->m_db, txn, &bulk, &empty, DB_MULTIPLE_KEY | DB_NOOVERWRITE);
+
+#else
+
+    (void) txn;
+    (void) first;
+    (void) last;
+
+    return EINVAL;
+
+#endif
+}
+
+}
@@ -30,12 +30,23 @@
 #include <bdb.h>
 
 // Standard C/C++ Libraries
+#include <algorithm>
+#include <cctype>
 #include <cstdlib>
 #include <cstring>
 #include <string>
+#include <vector>
 
 // Protocol Buffers
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/message.h>
+#include <google/protobuf/wire_format_lite.h>
+
+// Boost C++ Libraries
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/once.hpp>
+#include <boost/thread/tss.hpp>
 
 // Berkeley DB
 #include <db.h>
@@ -45,6 +56,11 @@
 #error Berkeley DB 4.7 or later is required.
 #endif
 
+// Heap databases are available since Berkeley DB 5.2
+#if (DB_VERSION_MAJOR > 5) || (DB_VERSION_MAJOR == 5) && (DB_VERSION_MINOR >= 2)
+#define BDB_HEAP
+#endif
+
 //--------------------------------------------------------------------------------------------------
 //  Implementation of global functions.
 //--------------------------------------------------------------------------------------------------
@@ -53,7 +69,18 @@ namespace bdb
 {
 
 using std::string;
+using std::vector;
+
+using google::protobuf::Descriptor;
+using google::protobuf::EnumValueDescriptor;
+using google::protobuf::FieldDescriptor;
 using google::protobuf::Message;
+using google::protobuf::Reflection;
+using google::protobuf::uint8;
+using google::protobuf::uint32;
+using google::protobuf::io::CodedInputStream;
+using google::protobuf::io::CodedOutputStream;
+using google::protobuf::internal::WireFormatLite;
 
 //--------------------------------------------------------------------------------------------------
 //  Berkeley DB version.
@@ -70,6 +97,66 @@ void version (int * major, int * minor, int * patch)
 {
     char * ver = db_version(major, minor, patch);
     LOG4CPLUS_DEBUG(logger, "[bdb::version] " << ver);
+    (void) ver;     // unused if debug logging is compiled out
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Runtime logging.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Cached log level of library's logger ("-1" until the level is cached first time).
+ * A plain "int" is read and written atomically on all supported platforms, so no lock is needed.
+ */
+volatile int log_level = -1;
+
+/**
+ * Library's logger, which is shared by all translation units.
+ */
+const log_port logger = log_port();
+
+/**
+ * @private Library's log4cplus logger (never destroyed, so it can be used by static destructors).
+ */
+static log4cplus::Logger * port_logger = NULL;
+
+/**
+ * @private Guards lookup of library's log4cplus logger.
+ */
+static boost::once_flag port_once = BOOST_ONCE_INIT;
+
+/**
+ * @private Looks library's log4cplus logger up.
+ */
+static void lookup_logger ()
+{
+    port_logger = new log4cplus::Logger(log4cplus::Logger::getInstance(BDB_LOGGER_PORT));
+}
+
+/**
+ * Returns library's log4cplus logger. The logger is looked up on first call (from any thread),
+ * so static initialization of the library and the application doesn't depend on log4cplus.
+ */
+log4cplus::Logger & library_logger ()
+{
+    boost::call_once(lookup_logger, port_once);
+
+    return *port_logger;
+}
+
+/**
+ * Caches current log level of library's logger, so disabled messages are rejected without asking log4cplus.
+ * The level is cached on first message, and when a database is opened; the function should be called again
+ * if log level of the "BDB_LOGGER_PORT" logger (or of its ancestors) is changed while databases are open.
+ * Returns the cached level.
+ */
+int refresh_logging ()
+{
+    int level = library_logger().getChainedLogLevel();
+
+    log_level = level;
+
+    return level;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -87,72 +174,2246 @@ void version (int * major, int * minor, int * patch)
  *
  * @see release
  */
-void serialize (const Message * from,   /**< [in]  Source ProtoBuf message. */
-                DBT           * to)     /**< [out] Resulted "DBT" object.   */
+void serialize (const MessageLite * from,   /**< [in]  Source ProtoBuf message. */
+                DBT               * to)     /**< [out] Resulted "DBT" object.   */
+{
+    serialize(from, to, NULL, 0);
+}
+
+/**
+ * Serializes specified "google::protobuf::Message" into "DBT" object, using caller-supplied buffer.
+ * If the buffer is large enough, the message is serialized right into it, and no memory is allocated
+ * (the "DBT" object is marked as "DB_DBT_USERMEM" and references the buffer). Otherwise the function
+ * falls back to allocation of required amount of memory, as "bdb::serialize" above does.
+ * Messages, generated by "protoc --cpp_out=fixed_layout:DIR", which have only required scalar fields,
+ * have "kMaxByteSize" constant, so a buffer of this size on the stack always fits them.
+ *
+ * If a codec is set (see "bdb::set_codec"), large value is compressed, unless "compress" is "false"
+ * (keys of tables are never compressed, so their order and prefixes are kept).
+ *
+ * In both cases the caller should call "bdb::release" when the "DBT" object is not needed anymore
+ * (the function doesn't free caller-supplied buffer).
+ *
+ * @see release
+ */
+void serialize (const MessageLite * from,       /**< [in]  Source ProtoBuf message.                 */
+                DBT               * to,         /**< [out] Resulted "DBT" object.                   */
+                void              * buffer,     /**< [in]  Caller-supplied buffer (can be "NULL").  */
+                size_t              size,       /**< [in]  Size of caller-supplied buffer in bytes. */
+                bool                compress)   /**< [in]  Whether large value can be compressed.   */
 {
-    string str;
-    from->SerializeToString(&str);
+    latency_scope latency(BDB_LATENCY_SERIALIZE);
 
     memset(to, 0, sizeof(DBT));
 
-    to->data = malloc(str.size());
-    memcpy(to->data, str.c_str(), str.size());
+    // calculate size once, so serialization below can use cached sizes
+    size_t bytes = (size_t) from->ByteSize();
 
-    to->flags = DB_DBT_USERMEM | DB_DBT_APPMALLOC;
-    to->size = to->ulen = str.size();
+    if (buffer != NULL && bytes <= size)
+    {
+        to->data  = buffer;
+        to->flags = DB_DBT_USERMEM;
+        to->ulen  = (u_int32_t) size;
+    }
+    else
+    {
+        to->data  = malloc(bytes == 0 ? 1 : bytes);
+        to->flags = DB_DBT_USERMEM | DB_DBT_APPMALLOC;
+        to->ulen  = (u_int32_t) bytes;
+    }
+
+    to->size = (u_int32_t) bytes;
+
+    if (compress && should_compress(bytes))
+    {
+        vector <uint8> raw(bytes);
+        from->SerializeWithCachedSizesToArray(&raw[0]);
+
+        size_t packed = compress_value(&raw[0], bytes, to->data);
+
+        if (packed != 0)
+        {
+            to->size = (u_int32_t) packed;
+        }
+        else
+        {
+            memcpy(to->data, &raw[0], bytes);
+        }
+
+        return;
+    }
+
+    from->SerializeWithCachedSizesToArray((uint8 *) to->data);
 }
 
 /**
  * Unserializes specified "DBT" object into "google::protobuf::Message".
+ * The message is parsed right from memory of the "DBT" object, without intermediate copy,
+ * unless the value is compressed (see "bdb::set_codec").
+ */
+void unserialize (const DBT   * from,     /**< [in]  Source "DBT" object.       */
+                  MessageLite * to)       /**< [out] Resulted ProtoBuf message. */
+{
+    latency_scope latency(BDB_LATENCY_UNSERIALIZE);
+
+    const DBT * plain = plain_value(from);
+    to->ParseFromArray(plain->data, (int) plain->size);
+}
+
+/**
+ * @private Returns specified message as a message of full runtime, for formats and operations, which read
+ * fields of messages by reflection (e.g. "bdb::serialize_key"). Messages of "LITE_RUNTIME" types have no
+ * reflection, and can be used only where messages are serialized as a whole.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the message is of "LITE_RUNTIME" type.
+ */
+const Message * reflected (const MessageLite * msg)     /**< [in] ProtoBuf message. */
+{
+    const Message * full = dynamic_cast <const Message *> (msg);
+
+    if (full == NULL && msg != NULL)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::reflected] Message of type \"" << msg->GetTypeName() << "\" has no reflection (LITE_RUNTIME).");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    return full;
+}
+
+/**
+ * @private Returns specified message as a message of full runtime (see "bdb::reflected").
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the message is of "LITE_RUNTIME" type.
+ */
+Message * reflected (MessageLite * msg)     /**< [in] ProtoBuf message. */
+{
+    return const_cast <Message *> (reflected(static_cast <const MessageLite *> (msg)));
+}
+
+/**
+ * Unserializes specified "DBT" object into new message of the same type as specified prototype,
+ * owned by specified arena (see "bdb::arena"). Returns the message.
  */
-void unserialize (const DBT * from,     /**< [in]  Source "DBT" object.       */
-                  Message   * to)       /**< [out] Resulted ProtoBuf message. */
+Message * unserialize (const DBT     * from,        /**< [in] Source "DBT" object.                 */
+                       const Message * prototype,   /**< [in] Message of required type.            */
+                       arena         * to)          /**< [in] Arena, which will own the message.   */
 {
-    string str((char *) from->data, from->size);
-    to->ParseFromString(str);
+    Message * msg = to->create(prototype);
+    unserialize(from, msg);
+
+    return msg;
 }
 
 /**
  * Releases memory, occupied by serialized "DBT" object.
+ * Caller-supplied buffers (see "bdb::serialize") and temporary buffers of scratch arena are not freed.
  */
 void release (DBT * dbt)    /**< [in/out] Serialized "DBT" object. */
 {
     if (dbt->data != NULL)
     {
-        free(dbt->data);
+        bool usermem = (dbt->flags & DB_DBT_USERMEM) && !(dbt->flags & DB_DBT_APPMALLOC);
+
+        if (!usermem) free(dbt->data);
         memset(dbt, 0, sizeof(DBT));
     }
 }
 
 //--------------------------------------------------------------------------------------------------
-//  Memory allocation functions.
+//  Order-preserving encoding of keys.
 //--------------------------------------------------------------------------------------------------
 
+/** @private Markers of the order-preserving encoding. */
+//@{
+#define KEY_ABSENT      0x00    /**< Field is absent, or end of repeated field.         */
+#define KEY_PRESENT     0x01    /**< Field (or next element of repeated one) follows.   */
+#define KEY_ESCAPE      0x00    /**< Escape byte in strings.                            */
+#define KEY_ZERO        0xFF    /**< Escaped zero byte of string.                       */
+#define KEY_END         0x01    /**< Escaped end of string.                             */
+//@}
+
+/** @private Sign bits of 32-bit and 64-bit integers. */
+static const uint32_t SIGN32 = (uint32_t) 1 << 31;
+static const uint64_t SIGN64 = (uint64_t) 1 << 63;
+
 /**
- * Allocate memory block.
- * The function is to be internally used by Berkeley DB API.
+ * @private Appends big-endian integer of specified size.
  */
-void * malloc (size_t size)
+static void encode_uint (string & out, uint64_t value, int size)
 {
-    return ::malloc(size);
+    for (int i = size - 1; i >= 0; i--)
+    {
+        out.push_back((char) (uint8) (value >> (i * 8)));
+    }
 }
 
 /**
- * Reallocate memory block.
- * The function is to be internally used by Berkeley DB API.
+ * @private Appends escaped and terminated bytes of a string, so strings are sorted as by "memcmp".
  */
-void * realloc (void * ptr, size_t size)
+static void encode_bytes (string & out, const uint8 * data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        out.push_back((char) data[i]);
+        if (data[i] == KEY_ESCAPE) out.push_back((char) KEY_ZERO);
+    }
+
+    out.push_back((char) KEY_ESCAPE);
+    out.push_back((char) KEY_END);
+}
+
+/**
+ * @private Reads big-endian integer of specified size, advancing the position.
+ */
+static bool decode_uint (const uint8 ** pos, const uint8 * end, uint64_t * value, int size)
 {
-    return ::realloc(ptr, size);
+    if (end - *pos < size) return false;
+
+    *value = 0;
+
+    for (int i = 0; i < size; i++)
+    {
+        *value = (*value << 8) | *(*pos)++;
+    }
+
+    return true;
 }
 
+static void encode_message (string & out, const Message & msg, bool partial = false);
+static bool decode_message (const uint8 ** pos, const uint8 * end, Message * msg);
+
 /**
- * Deallocate space in memory.
- * The function is to be internally used by Berkeley DB API.
+ * @private Appends value of specified field ("index" is negative for non-repeated fields).
  */
-void free (void * ptr)
+static void encode_value (string & out, const Message & msg, const FieldDescriptor * field, int index)
+{
+    const Reflection * r = msg.GetReflection();
+    bool single = (index < 0);
+
+    switch (field->cpp_type())
+    {
+        case FieldDescriptor::CPPTYPE_INT32:
+        {
+            int32_t v = (single ? r->GetInt32(msg, field) : r->GetRepeatedInt32(msg, field, index));
+            encode_uint(out, (uint32_t) v ^ SIGN32, 4);
+            break;
+        }
+
+        case FieldDescriptor::CPPTYPE_INT64:
+        {
+            int64_t v = (single ? r->GetInt64(msg, field) : r->GetRepeatedInt64(msg, field, index));
+            encode_uint(out, (uint64_t) v ^ SIGN64, 8);
+            break;
+        }
+
+        case FieldDescriptor::CPPTYPE_UINT32:
+            encode_uint(out, (single ? r->GetUInt32(msg, field) : r->GetRepeatedUInt32(msg, field, index)), 4);
+            break;
+
+        case FieldDescriptor::CPPTYPE_UINT64:
+            encode_uint(out, (single ? r->GetUInt64(msg, field) : r->GetRepeatedUInt64(msg, field, index)), 8);
+            break;
+
+        case FieldDescriptor::CPPTYPE_BOOL:
+            encode_uint(out, (single ? r->GetBool(msg, field) : r->GetRepeatedBool(msg, field, index)) ? 1 : 0, 1);
+            break;
+
+        case FieldDescriptor::CPPTYPE_ENUM:
+        {
+            const EnumValueDescriptor * v = (single ? r->GetEnum(msg, field) : r->GetRepeatedEnum(msg, field, index));
+            encode_uint(out, (uint32_t) v->number() ^ SIGN32, 4);
+            break;
+        }
+
+        case FieldDescriptor::CPPTYPE_FLOAT:
+        {
+            float    v = (single ? r->GetFloat(msg, field) : r->GetRepeatedFloat(msg, field, index));
+            uint32_t bits;
+            memcpy(&bits, &v, sizeof(bits));
+            encode_uint(out, (bits & SIGN32) ? ~bits : bits | SIGN32, 4);
+            break;
+        }
+
+        case FieldDescriptor::CPPTYPE_DOUBLE:
+        {
+            double   v = (single ? r->GetDouble(msg, field) : r->GetRepeatedDouble(msg, field, index));
+            uint64_t bits;
+            memcpy(&bits, &v, sizeof(bits));
+            encode_uint(out, (bits & SIGN64) ? ~bits : bits | SIGN64, 8);
+            break;
+        }
+
+        case FieldDescriptor::CPPTYPE_STRING:
+        {
+            string v = (single ? r->GetString(msg, field) : r->GetRepeatedString(msg, field, index));
+            encode_bytes(out, (const uint8 *) v.data(), v.size());
+            break;
+        }
+
+        case FieldDescriptor::CPPTYPE_MESSAGE:
+            encode_message(out, (single ? r->GetMessage(msg, field) : r->GetRepeatedMessage(msg, field, index)));
+            break;
+    }
+}
+
+/**
+ * @private Decodes value of specified field, adding new element if the field is repeated.
+ */
+static bool decode_value (const uint8 ** pos, const uint8 * end, Message * msg, const FieldDescriptor * field)
 {
-    ::free(ptr);
+    const Reflection * r = msg->GetReflection();
+    bool single = !field->is_repeated();
+    uint64_t v;
+
+    switch (field->cpp_type())
+    {
+        case FieldDescriptor::CPPTYPE_INT32:
+            if (!decode_uint(pos, end, &v, 4)) return false;
+            if (single) r->SetInt32(msg, field, (int32_t) ((uint32_t) v ^ SIGN32));
+            else        r->AddInt32(msg, field, (int32_t) ((uint32_t) v ^ SIGN32));
+            break;
+
+        case FieldDescriptor::CPPTYPE_INT64:
+            if (!decode_uint(pos, end, &v, 8)) return false;
+            if (single) r->SetInt64(msg, field, (int64_t) (v ^ SIGN64));
+            else        r->AddInt64(msg, field, (int64_t) (v ^ SIGN64));
+            break;
+
+        case FieldDescriptor::CPPTYPE_UINT32:
+            if (!decode_uint(pos, end, &v, 4)) return false;
+            if (single) r->SetUInt32(msg, field, (uint32_t) v);
+            else        r->AddUInt32(msg, field, (uint32_t) v);
+            break;
+
+        case FieldDescriptor::CPPTYPE_UINT64:
+            if (!decode_uint(pos, end, &v, 8)) return false;
+            if (single) r->SetUInt64(msg, field, v);
+            else        r->AddUInt64(msg, field, v);
+            break;
+
+        case FieldDescriptor::CPPTYPE_BOOL:
+            if (!decode_uint(pos, end, &v, 1)) return false;
+            if (single) r->SetBool(msg, field, v != 0);
+            else        r->AddBool(msg, field, v != 0);
+            break;
+
+        case FieldDescriptor::CPPTYPE_ENUM:
+        {
+            if (!decode_uint(pos, end, &v, 4)) return false;
+            const EnumValueDescriptor * e = field->enum_type()->FindValueByNumber((int32_t) ((uint32_t) v ^ SIGN32));
+            if (e == NULL) return false;
+            if (single) r->SetEnum(msg, field, e);
+            else        r->AddEnum(msg, field, e);
+            break;
+        }
+
+        case FieldDescriptor::CPPTYPE_FLOAT:
+        {
+            if (!decode_uint(pos, end, &v, 4)) return false;
+            uint32_t bits = (uint32_t) v;
+            bits = (bits & SIGN32) ? bits & ~SIGN32 : ~bits;
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            if (single) r->SetFloat(msg, field, f);
+            else        r->AddFloat(msg, field, f);
+            break;
+        }
+
+        case FieldDescriptor::CPPTYPE_DOUBLE:
+        {
+            if (!decode_uint(pos, end, &v, 8)) return false;
+            v = (v & SIGN64) ? v & ~SIGN64 : ~v;
+            double f;
+            memcpy(&f, &v, sizeof(f));
+            if (single) r->SetDouble(msg, field, f);
+            else        r->AddDouble(msg, field, f);
+            break;
+        }
+
+        case FieldDescriptor::CPPTYPE_STRING:
+        {
+            string s;
+
+            for (;;)
+            {
+                if (*pos >= end) return false;
+                uint8 c = *(*pos)++;
+
+                if (c == KEY_ESCAPE)
+                {
+                    if (*pos >= end) return false;
+                    uint8 next = *(*pos)++;
+
+                    if (next == KEY_END) break;
+                    if (next != KEY_ZERO) return false;
+                }
+
+                s.push_back((char) c);
+            }
+
+            if (single) r->SetString(msg, field, s);
+            else        r->AddString(msg, field, s);
+            break;
+        }
+
+        case FieldDescriptor::CPPTYPE_MESSAGE:
+            if (!decode_message(pos, end, (single ? r->MutableMessage(msg, field) : r->AddMessage(msg, field)))) return false;
+            break;
+    }
+
+    return true;
+}
+
+/**
+ * @private Appends all fields of specified message in order of their declaration.
+ * If "partial" is set, stops at the first absent field, so the result is a prefix of encoded complete keys.
+ */
+static void encode_message (string & out, const Message & msg, bool partial)
+{
+    const Descriptor * d = msg.GetDescriptor();
+    const Reflection * r = msg.GetReflection();
+
+    for (int i = 0; i < d->field_count(); i++)
+    {
+        const FieldDescriptor * field = d->field(i);
+
+        if (field->is_repeated())
+        {
+            for (int j = 0; j < r->FieldSize(msg, field); j++)
+            {
+                out.push_back((char) KEY_PRESENT);
+                encode_value(out, msg, field, j);
+            }
+
+            out.push_back((char) KEY_ABSENT);
+        }
+        else if (r->HasField(msg, field))
+        {
+            out.push_back((char) KEY_PRESENT);
+            encode_value(out, msg, field, -1);
+        }
+        else if (partial)
+        {
+            break;
+        }
+        else
+        {
+            out.push_back((char) KEY_ABSENT);
+        }
+    }
+}
+
+/**
+ * @private Decodes all fields of specified message, advancing the position.
+ */
+static bool decode_message (const uint8 ** pos, const uint8 * end, Message * msg)
+{
+    const Descriptor * d = msg->GetDescriptor();
+
+    for (int i = 0; i < d->field_count(); i++)
+    {
+        const FieldDescriptor * field = d->field(i);
+
+        for (;;)
+        {
+            if (*pos >= end) return false;
+            uint8 marker = *(*pos)++;
+
+            if (marker == KEY_ABSENT)  break;
+            if (marker != KEY_PRESENT) return false;
+
+            if (!decode_value(pos, end, msg, field)) return false;
+            if (!field->is_repeated()) break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Serializes specified key into "DBT" object, using order-preserving encoding.
+ * Encoded keys are sorted by plain comparison of bytes in the same order as the messages are sorted
+ * by their fields (in order of declaration), so tables with such keys don't need comparison function.
+ * Integers are stored in big-endian order with flipped sign bit, strings are escaped and terminated,
+ * absent fields are sorted before present ones.
+ *
+ * The function allocates required amount of memory, and the caller is
+ * responsible to free this memory by "bdb::release" function.
+ *
+ * @see release
+ */
+void serialize_key (const Message * from,   /**< [in]  Source ProtoBuf message. */
+                    DBT           * to)     /**< [out] Resulted "DBT" object.   */
+{
+    memset(to, 0, sizeof(DBT));
+
+    string out;
+    encode_message(out, *from);
+
+    to->data  = malloc(out.empty() ? 1 : out.size());
+    to->flags = DB_DBT_USERMEM | DB_DBT_APPMALLOC;
+    to->ulen  = (u_int32_t) out.size();
+    to->size  = (u_int32_t) out.size();
+
+    memcpy(to->data, out.data(), out.size());
+}
+
+/**
+ * Serializes leading fields of specified partial key into "DBT" object, using order-preserving encoding.
+ * Encoding stops at the first absent field, so the result is a prefix of "bdb::serialize_key" encoding
+ * of any key with the same leading fields.
+ *
+ * The function allocates required amount of memory, and the caller is
+ * responsible to free this memory by "bdb::release" function.
+ *
+ * @see release
+ */
+void serialize_key_prefix (const Message * from,    /**< [in]  Source ProtoBuf message. */
+                           DBT           * to)      /**< [out] Resulted "DBT" object.   */
+{
+    memset(to, 0, sizeof(DBT));
+
+    string out;
+    encode_message(out, *from, true);
+
+    to->data  = malloc(out.empty() ? 1 : out.size());
+    to->flags = DB_DBT_USERMEM | DB_DBT_APPMALLOC;
+    to->ulen  = (u_int32_t) out.size();
+    to->size  = (u_int32_t) out.size();
+
+    memcpy(to->data, out.data(), out.size());
+}
+
+/**
+ * Unserializes specified "DBT" object, encoded by "bdb::serialize_key", into "google::protobuf::Message".
+ * If the object is malformed, the message is left cleared.
+ */
+void unserialize_key (const DBT * from,     /**< [in]  Source "DBT" object.       */
+                      Message   * to)       /**< [out] Resulted ProtoBuf message. */
+{
+    to->Clear();
+
+    const uint8 * pos = (const uint8 *) from->data;
+
+    if (!decode_message(&pos, pos + from->size, to))
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::unserialize_key] malformed key");
+        to->Clear();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Record numbers.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Serializes specified key into record number ("db_recno_t") of recno and queue tables.
+ * The key must consist of a single integer field (e.g. an identifier of "bdb::sequence"),
+ * which value is a positive number of 32 bits.
+ *
+ * The function allocates required amount of memory, and the caller is
+ * responsible to free this memory by "bdb::release" function.
+ *
+ * @see release
+ */
+void serialize_recno (const Message * from,     /**< [in]  Source ProtoBuf message. */
+                      DBT           * to)       /**< [out] Resulted "DBT" object.   */
+{
+    memset(to, 0, sizeof(DBT));
+
+    const FieldDescriptor * f = from->GetDescriptor()->field(0);
+    const Reflection      * r = from->GetReflection();
+
+    db_recno_t recno = 0;
+
+    switch (f->cpp_type())
+    {
+        case FieldDescriptor::CPPTYPE_INT32:    recno = (db_recno_t) r->GetInt32(*from, f);  break;
+        case FieldDescriptor::CPPTYPE_INT64:    recno = (db_recno_t) r->GetInt64(*from, f);  break;
+        case FieldDescriptor::CPPTYPE_UINT32:   recno = (db_recno_t) r->GetUInt32(*from, f); break;
+        case FieldDescriptor::CPPTYPE_UINT64:   recno = (db_recno_t) r->GetUInt64(*from, f); break;
+        default:                                LOG4CPLUS_WARN(logger, "[bdb::serialize_recno] key is not an integer");
+    }
+
+    to->data  = malloc(sizeof(db_recno_t));
+    to->flags = DB_DBT_USERMEM | DB_DBT_APPMALLOC;
+    to->ulen  = sizeof(db_recno_t);
+    to->size  = sizeof(db_recno_t);
+
+    memcpy(to->data, &recno, sizeof(db_recno_t));
+}
+
+/**
+ * Unserializes specified record number, made by "bdb::serialize_recno", into "google::protobuf::Message".
+ */
+void unserialize_recno (const DBT * from,   /**< [in]  Source "DBT" object.       */
+                        Message   * to)     /**< [out] Resulted ProtoBuf message. */
+{
+    to->Clear();
+
+    if (from->size != sizeof(db_recno_t))
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::unserialize_recno] malformed record number");
+        return;
+    }
+
+    db_recno_t recno;
+    memcpy(&recno, from->data, sizeof(db_recno_t));
+
+    const FieldDescriptor * f = to->GetDescriptor()->field(0);
+    const Reflection      * r = to->GetReflection();
+
+    switch (f->cpp_type())
+    {
+        case FieldDescriptor::CPPTYPE_INT32:    r->SetInt32(to, f, (int32_t) recno);   break;
+        case FieldDescriptor::CPPTYPE_INT64:    r->SetInt64(to, f, (int64_t) recno);   break;
+        case FieldDescriptor::CPPTYPE_UINT32:   r->SetUInt32(to, f, (uint32_t) recno); break;
+        case FieldDescriptor::CPPTYPE_UINT64:   r->SetUInt64(to, f, (uint64_t) recno); break;
+        default:                                LOG4CPLUS_WARN(logger, "[bdb::unserialize_recno] key is not an integer");
+    }
+}
+
+/**
+ * Serializes specified key into record id ("DB_HEAP_RID") of heap tables.
+ * The key must consist of a single integer field, which value is an id, returned by "bdb::table::insert"
+ * (page number in the upper bits, and index of the record on the page in the lower 16 bits).
+ *
+ * The function allocates required amount of memory, and the caller is
+ * responsible to free this memory by "bdb::release" function.
+ *
+ * @see release
+ */
+void serialize_rid (const Message * from,   /**< [in]  Source ProtoBuf message. */
+                    DBT           * to)     /**< [out] Resulted "DBT" object.   */
+{
+    memset(to, 0, sizeof(DBT));
+
+#ifdef BDB_HEAP
+
+    const FieldDescriptor * f = from->GetDescriptor()->field(0);
+    const Reflection      * r = from->GetReflection();
+
+    uint64_t id = 0;
+
+    switch (f->cpp_type())
+    {
+        case FieldDescriptor::CPPTYPE_INT32:    id = (uint64_t) r->GetInt32(*from, f);  break;
+        case FieldDescriptor::CPPTYPE_INT64:    id = (uint64_t) r->GetInt64(*from, f);  break;
+        case FieldDescriptor::CPPTYPE_UINT32:   id = (uint64_t) r->GetUInt32(*from, f); break;
+        case FieldDescriptor::CPPTYPE_UINT64:   id = (uint64_t) r->GetUInt64(*from, f); break;
+        default:                                LOG4CPLUS_WARN(logger, "[bdb::serialize_rid] key is not an integer");
+    }
+
+    DB_HEAP_RID rid;
+
+    rid.pgno = (db_pgno_t) (id >> 16);
+    rid.indx = (db_indx_t) (id & 0xFFFF);
+
+    to->data  = malloc(sizeof(DB_HEAP_RID));
+    to->flags = DB_DBT_USERMEM | DB_DBT_APPMALLOC;
+    to->ulen  = sizeof(DB_HEAP_RID);
+    to->size  = DB_HEAP_RID_SZ;
+
+    memcpy(to->data, &rid, sizeof(DB_HEAP_RID));
+
+#else
+
+    LOG4CPLUS_WARN(logger, "[bdb::serialize_rid] Heap tables require Berkeley DB 5.2 or later.");
+
+#endif
+}
+
+/**
+ * Unserializes specified record id, made by "bdb::serialize_rid", into "google::protobuf::Message".
+ */
+void unserialize_rid (const DBT * from,     /**< [in]  Source "DBT" object.       */
+                      Message   * to)       /**< [out] Resulted ProtoBuf message. */
+{
+    to->Clear();
+
+#ifdef BDB_HEAP
+
+    if (from->size != DB_HEAP_RID_SZ)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::unserialize_rid] malformed record id");
+        return;
+    }
+
+    DB_HEAP_RID rid;
+    memcpy(&rid, from->data, DB_HEAP_RID_SZ);
+
+    uint64_t id = ((uint64_t) rid.pgno << 16) | rid.indx;
+
+    const FieldDescriptor * f = to->GetDescriptor()->field(0);
+    const Reflection      * r = to->GetReflection();
+
+    switch (f->cpp_type())
+    {
+        case FieldDescriptor::CPPTYPE_INT32:    r->SetInt32(to, f, (int32_t) id);   break;
+        case FieldDescriptor::CPPTYPE_INT64:    r->SetInt64(to, f, (int64_t) id);   break;
+        case FieldDescriptor::CPPTYPE_UINT32:   r->SetUInt32(to, f, (uint32_t) id); break;
+        case FieldDescriptor::CPPTYPE_UINT64:   r->SetUInt64(to, f, id);            break;
+        default:                                LOG4CPLUS_WARN(logger, "[bdb::unserialize_rid] key is not an integer");
+    }
+
+#else
+
+    LOG4CPLUS_WARN(logger, "[bdb::unserialize_rid] Heap tables require Berkeley DB 5.2 or later.");
+
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Comparison of serialized ProtoBuf messages.
+//--------------------------------------------------------------------------------------------------
+
+/** @private ProtoBuf wire types. */
+//@{
+#define WIRETYPE_VARINT             0
+#define WIRETYPE_FIXED64            1
+#define WIRETYPE_LENGTH_DELIMITED   2
+#define WIRETYPE_FIXED32            5
+//@}
+
+/**
+ * @private Reads varint from specified position of serialized message, advancing the position.
+ * Returns "false" if the message is malformed.
+ */
+static bool read_varint (const uint8 ** pos, const uint8 * end, uint64_t * value)
+{
+    *value = 0;
+
+    for (int shift = 0; shift < 64 && *pos < end; shift += 7)
+    {
+        uint8 byte = *(*pos)++;
+        *value |= (uint64_t) (byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0) return true;
+    }
+
+    return false;
+}
+
+/**
+ * @private Reads little-endian integer of specified size from specified position, advancing the position.
+ * Returns "false" if the message is malformed.
+ */
+static bool read_fixed (const uint8 ** pos, const uint8 * end, int size, uint64_t * value)
+{
+    if (end - *pos < size) return false;
+
+    *value = 0;
+
+    for (int i = 0; i < size; i++)
+    {
+        *value |= (uint64_t) (*pos)[i] << (i * 8);
+    }
+
+    *pos += size;
+
+    return true;
+}
+
+/** @private Raw value of a field, found in serialized message. */
+struct raw_field
+{
+    int           wiretype;     /**< Wire type of the field ("-1" if not found).                       */
+    const uint8 * begin;        /**< First byte of the value (including length of length-delimited). */
+    const uint8 * end;          /**< Byte after the value.                                            */
+};
+
+/**
+ * @private Finds specified fields in serialized message in one pass.
+ * If a field occurs several times, the first occurrence is found.
+ * Returns number of found fields.
+ */
+static int scan_fields (const DBT  * dbt,       /**< [in]  Serialized message.       */
+                        const int  * fields,    /**< [in]  Field numbers.            */
+                        int          count,     /**< [in]  Number of fields.         */
+                        raw_field  * raws)      /**< [out] Raw values of the fields. */
+{
+    for (int i = 0; i < count; i++)
+    {
+        raws[i].wiretype = -1;
+        raws[i].begin    = NULL;
+        raws[i].end      = NULL;
+    }
+
+    // raw values of compressed message reference per-thread buffer of its decompressed value
+    dbt = plain_value(dbt);
+
+    CodedInputStream input((const uint8 *) dbt->data, (int) dbt->size);
+
+    int found = 0;
+
+    while (found < count)
+    {
+        uint32 tag = input.ReadTag();
+        if (tag == 0) break;
+
+        const void * begin;
+        const void * end;
+        int          before, after;
+
+        input.GetDirectBufferPointerInline(&begin, &before);
+        if (!WireFormatLite::SkipField(&input, tag)) break;
+        input.GetDirectBufferPointerInline(&end, &after);
+
+        int number = WireFormatLite::GetTagFieldNumber(tag);
+
+        for (int i = 0; i < count; i++)
+        {
+            if (fields[i] == number && raws[i].wiretype == -1)
+            {
+                raws[i].wiretype = (int) WireFormatLite::GetTagWireType(tag);
+                raws[i].begin    = (const uint8 *) begin;
+                raws[i].end      = (const uint8 *) begin + (before - after);
+                found++;
+            }
+        }
+    }
+
+    return found;
+}
+
+/**
+ * @private Finds specified field in serialized message.
+ * Returns wire type of the field, and raw bytes of its value (including length of length-delimited one).
+ * Returns "false" if the field is not found.
+ */
+static bool find_raw (const DBT      * dbt,         /**< [in]  Serialized message.           */
+                      int              field,       /**< [in]  Field number.                 */
+                      int            * wiretype,    /**< [out] Wire type of the field.       */
+                      const uint8   ** begin,       /**< [out] First byte of the raw value.  */
+                      const uint8   ** end)         /**< [out] Byte after the raw value.     */
+{
+    raw_field raw;
+
+    if (scan_fields(dbt, &field, 1, &raw) == 0) return false;
+
+    *wiretype = raw.wiretype;
+    *begin    = raw.begin;
+    *end      = raw.end;
+
+    return true;
+}
+
+/**
+ * @private Converts raw value of a field into public form (length of length-delimited value is skipped).
+ */
+static void to_field_value (const raw_field & raw, field_value * value)
+{
+    value->wiretype = raw.wiretype;
+    value->data     = raw.begin;
+    value->size     = raw.end - raw.begin;
+
+    if (raw.wiretype == WIRETYPE_LENGTH_DELIMITED)
+    {
+        const uint8 * pos = raw.begin;
+        uint64_t      size;
+
+        if (read_varint(&pos, raw.end, &size))
+        {
+            value->data = pos;
+            value->size = (size_t) size;
+        }
+    }
+}
+
+/**
+ * @private Finds specified field in serialized message.
+ * Integer values are returned in "value", strings are returned as "data" and "size".
+ * Returns "false" if the field is not found.
+ */
+static bool find_field (const DBT      * dbt,       /**< [in]  Serialized message.              */
+                        int              field,     /**< [in]  Field number.                    */
+                        uint64_t       * value,     /**< [out] Value of integer field.          */
+                        const uint8   ** data,      /**< [out] Value of length-delimited field. */
+                        uint64_t       * size)      /**< [out] Size of length-delimited field.  */
+{
+    int           wiretype;
+    const uint8 * begin;
+    const uint8 * end;
+
+    if (!find_raw(dbt, field, &wiretype, &begin, &end)) return false;
+
+    switch (wiretype)
+    {
+        case WIRETYPE_VARINT:           return read_varint(&begin, end, value);
+        case WIRETYPE_FIXED64:          return read_fixed(&begin, end, 8, value);
+        case WIRETYPE_FIXED32:          return read_fixed(&begin, end, 4, value);
+
+        case WIRETYPE_LENGTH_DELIMITED:
+            if (!read_varint(&begin, end, size)) return false;
+            *data  = begin;
+            *value = *size;
+            return true;
+    }
+
+    return false;
+}
+
+/** @private Three-way comparison of two values. */
+template <typename T>
+static inline int compare_values (T v1, T v2)
+{
+    return (v1 < v2 ? -1 : (v1 > v2 ? +1 : 0));
+}
+
+/**
+ * Compares two serialized ProtoBuf messages by specified field, without unserializing them.
+ * A message without the field is less than any message with it.
+ *
+ * @return 0 if field of dbt1 is equal to one of dbt2.
+ * @return -1 if field of dbt1 is less than one of dbt2.
+ * @return +1 if field of dbt1 is greater than one of dbt2.
+ *
+ * @see field_compare
+ */
+int compare_field (const DBT * dbt1,    /**< [in] First serialized message.                    */
+                   const DBT * dbt2,    /**< [in] Second serialized message.                   */
+                   int         field,   /**< [in] Field number.                                */
+                   int         type)    /**< [in] Field type (see @ref fieldtypes "types").    */
+{
+    decoded_field f1, f2;
+    const uint8 * d1 = NULL, * d2 = NULL;
+    uint64_t      s1 = 0,    s2 = 0;
+
+    f1.value = f2.value = 0;
+
+    f1.found = find_field(dbt1, field, &f1.value, &d1, &s1);
+    f2.found = find_field(dbt2, field, &f2.value, &d2, &s2);
+
+    f1.data = d1;
+    f2.data = d2;
+
+    return compare_decoded(&f1, &f2, type);
+}
+
+/**
+ * @private Compares two decoded values of a field of specified type (see "bdb::compare_field").
+ * An absent value is less than any present one.
+ */
+int compare_decoded (const decoded_field * f1,      /**< [in] First value.                               */
+                     const decoded_field * f2,      /**< [in] Second value.                              */
+                     int                   type)    /**< [in] Field type (see @ref fieldtypes "types").  */
+{
+    if (!f1->found || !f2->found)
+    {
+        return compare_values(f1->found, f2->found);
+    }
+
+    uint64_t v1 = f1->value, v2 = f2->value;
+
+    switch (type)
+    {
+        case BDB_FIELD_STRING:
+        {
+            int res = memcmp(f1->data, f2->data, (size_t) (v1 < v2 ? v1 : v2));
+            return (res != 0 ? (res < 0 ? -1 : +1) : compare_values(v1, v2));
+        }
+
+        case BDB_FIELD_INT32:
+        case BDB_FIELD_INT64:
+        case BDB_FIELD_SFIXED64:
+            return compare_values((int64_t) v1, (int64_t) v2);
+
+        case BDB_FIELD_SFIXED32:
+            return compare_values((int32_t) (uint32_t) v1, (int32_t) (uint32_t) v2);
+
+        case BDB_FIELD_SINT32:
+        case BDB_FIELD_SINT64:
+            return compare_values((int64_t) (v1 >> 1) ^ -(int64_t) (v1 & 1),
+                                  (int64_t) (v2 >> 1) ^ -(int64_t) (v2 & 1));
+
+        case BDB_FIELD_FLOAT:
+        {
+            uint32_t b1 = (uint32_t) v1, b2 = (uint32_t) v2;
+            float    x1, x2;
+            memcpy(&x1, &b1, sizeof(x1));
+            memcpy(&x2, &b2, sizeof(x2));
+            return compare_values(x1, x2);
+        }
+
+        case BDB_FIELD_DOUBLE:
+        {
+            double x1, x2;
+            memcpy(&x1, &v1, sizeof(x1));
+            memcpy(&x2, &v2, sizeof(x2));
+            return compare_values(x1, x2);
+        }
+
+        default:    // unsigned types
+            return compare_values(v1, v2);
+    }
+}
+
+/**
+ * @private Reads value of single field of a key, when the field comes first and its tag takes one byte
+ * (fields 1 to 15). Integer values are returned in "value", strings are returned as "data" and "value" (size).
+ * Returns "false" if the fast path is not applicable (e.g. the field is absent, or the key is compressed).
+ */
+static inline bool read_single (const DBT      * dbt,   /**< [in]  Serialized key.                  */
+                                uint8            tag,   /**< [in]  Expected one-byte tag.           */
+                                uint64_t       * value, /**< [out] Value (or size) of the field.    */
+                                const uint8   ** data)  /**< [out] Value of length-delimited field. */
+{
+    const uint8 * pos = (const uint8 *) dbt->data;
+    const uint8 * end = pos + dbt->size;
+
+    // compressed values start with zero byte, which is never a tag
+    if (pos == end || *pos != tag) return false;
+
+    pos++;
+
+    // one-byte varints (small numbers and short strings) are the most common
+    if (pos < end && (*pos & 0x80) == 0)
+    {
+        *value = *pos++;
+    }
+    else if (!read_varint(&pos, end, value))
+    {
+        return false;
+    }
+
+    if ((tag & 0x07) == WIRETYPE_LENGTH_DELIMITED)
+    {
+        if ((uint64_t) (end - pos) < *value) return false;
+        *data = pos;
+    }
+
+    return true;
+}
+
+/**
+ * Compares two serialized ProtoBuf keys by specified field, like "bdb::compare_field", but reads the field
+ * straight from the first bytes of the keys when it comes first (as in keys of a single field with number
+ * from 1 to 15), so the keys are not scanned at all. Other keys are compared by "bdb::compare_field".
+ * Supported types are "BDB_FIELD_INT32", "BDB_FIELD_INT64", "BDB_FIELD_UINT32", "BDB_FIELD_UINT64",
+ * and "BDB_FIELD_STRING" (both "string" and "bytes"); other types are always compared by "bdb::compare_field".
+ *
+ * @return 0 if field of dbt1 is equal to one of dbt2.
+ * @return -1 if field of dbt1 is less than one of dbt2.
+ * @return +1 if field of dbt1 is greater than one of dbt2.
+ *
+ * @see single_compare
+ */
+int compare_single (const DBT * dbt1,   /**< [in] First serialized key.                        */
+                    const DBT * dbt2,   /**< [in] Second serialized key.                       */
+                    int         field,  /**< [in] Field number.                                */
+                    int         type)   /**< [in] Field type (see @ref fieldtypes "types").    */
+{
+    int wiretype;
+
+    switch (type)
+    {
+        case BDB_FIELD_STRING:  wiretype = WIRETYPE_LENGTH_DELIMITED;   break;
+        case BDB_FIELD_INT32:
+        case BDB_FIELD_INT64:
+        case BDB_FIELD_UINT32:
+        case BDB_FIELD_UINT64:  wiretype = WIRETYPE_VARINT;             break;
+        default:                return compare_field(dbt1, dbt2, field, type);
+    }
+
+    if (field < 1 || field > 15) return compare_field(dbt1, dbt2, field, type);
+
+    uint8 tag = (uint8) ((field << 3) | wiretype);
+
+    uint64_t      v1, v2;
+    const uint8 * d1 = NULL;
+    const uint8 * d2 = NULL;
+
+    if (!read_single(dbt1, tag, &v1, &d1) || !read_single(dbt2, tag, &v2, &d2))
+    {
+        return compare_field(dbt1, dbt2, field, type);
+    }
+
+    switch (type)
+    {
+        case BDB_FIELD_STRING:
+        {
+            int res = memcmp(d1, d2, (size_t) (v1 < v2 ? v1 : v2));
+            return (res != 0 ? (res < 0 ? -1 : +1) : compare_values(v1, v2));
+        }
+
+        case BDB_FIELD_INT32:
+        case BDB_FIELD_INT64:
+            return compare_values((int64_t) v1, (int64_t) v2);
+
+        default:    // unsigned types
+            return compare_values(v1, v2);
+    }
+}
+
+/**
+ * Keys comparison function of keys of single "int32" (or "enum") field with number 1 (see "bdb::compare_single").
+ */
+int int32_key_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    return compare_single(dbt1, dbt2, 1, BDB_FIELD_INT32);
+}
+
+/**
+ * Keys comparison function of keys of single "int64" field with number 1 (see "bdb::compare_single").
+ */
+int int64_key_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    return compare_single(dbt1, dbt2, 1, BDB_FIELD_INT64);
+}
+
+/**
+ * Keys comparison function of keys of single "uint64" field with number 1 (see "bdb::compare_single").
+ */
+int uint64_key_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    return compare_single(dbt1, dbt2, 1, BDB_FIELD_UINT64);
+}
+
+/**
+ * Keys comparison function of keys of single "string" field with number 1, in lexicographical order of
+ * bytes (see "bdb::compare_single").
+ */
+int string_key_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    return compare_single(dbt1, dbt2, 1, BDB_FIELD_STRING);
+}
+
+/**
+ * Keys comparison function of keys of single "bytes" field with number 1, in lexicographical order
+ * (see "bdb::compare_single").
+ */
+int bytes_key_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    return compare_single(dbt1, dbt2, 1, BDB_FIELD_STRING);
+}
+
+/**
+ * Extracts raw value of specified field from serialized message, without unserializing the message.
+ * The value references memory of the "DBT" object. For length-delimited fields (strings, bytes, nested
+ * messages) it's the content of the field, for others it's encoded value (varint or fixed-size integer).
+ *
+ * @return true  - the field is found.
+ * @return false - the message doesn't contain the field.
+ */
+bool extract_field (const DBT   * from,     /**< [in]  Serialized message.       */
+                    int           field,    /**< [in]  Field number.             */
+                    field_value * value)    /**< [out] Raw value of the field.   */
+{
+    raw_field raw;
+
+    if (scan_fields(from, &field, 1, &raw) == 0)
+    {
+        memset(value, 0, sizeof(field_value));
+        value->wiretype = -1;
+        return false;
+    }
+
+    to_field_value(raw, value);
+
+    return true;
+}
+
+/**
+ * Extracts value of specified integer field (of any varint or fixed-size type) from serialized message.
+ * Values of "sint32" and "sint64" fields are returned in ZigZag encoding.
+ *
+ * @return true  - the field is found.
+ * @return false - the message doesn't contain the field, or it's not an integer one.
+ */
+bool extract_field (const DBT * from,       /**< [in]  Serialized message.       */
+                    int         field,      /**< [in]  Field number.             */
+                    int64_t   * value)      /**< [out] Value of the field.       */
+{
+    uint64_t      v = 0;
+    int           wiretype;
+    const uint8 * begin;
+    const uint8 * end;
+
+    if (!find_raw(from, field, &wiretype, &begin, &end)) return false;
+
+    switch (wiretype)
+    {
+        case WIRETYPE_VARINT:   if (!read_varint(&begin, end, &v))   return false; break;
+        case WIRETYPE_FIXED64:  if (!read_fixed(&begin, end, 8, &v)) return false; break;
+        case WIRETYPE_FIXED32:  if (!read_fixed(&begin, end, 4, &v)) return false; break;
+        default:                return false;
+    }
+
+    *value = (int64_t) v;
+
+    return true;
+}
+
+/**
+ * Extracts raw values of several fields from serialized message in one pass (see "bdb::extract_field").
+ * Useful for index callbacks, which make a key of several fields, or for several indexes, sharing one pass.
+ * Values of absent fields have "NULL" data and "-1" wire type.
+ *
+ * @return Number of found fields.
+ */
+int extract_fields (const DBT   * from,     /**< [in]  Serialized message.                        */
+                    const int   * fields,   /**< [in]  Field numbers.                             */
+                    int           count,    /**< [in]  Number of fields.                          */
+                    field_value * values)   /**< [out] Raw values of the fields ("count" items).  */
+{
+    vector <raw_field> raws(count);
+
+    int found = (count > 0 ? scan_fields(from, fields, count, &raws[0]) : 0);
+
+    for (int i = 0; i < count; i++)
+    {
+        to_field_value(raws[i], &values[i]);
+    }
+
+    return found;
+}
+
+/**
+ * @private Encodes tag of specified field into specified buffer (at least 10 bytes), returns its size.
+ */
+static size_t encode_tag (uint8 * tag, int field, int wiretype)
+{
+    size_t size = 0;
+
+    for (uint64_t t = ((uint64_t) field << 3) | wiretype; ; t >>= 7)
+    {
+        tag[size++] = (uint8) ((t & 0x7F) | (t >= 0x80 ? 0x80 : 0));
+        if (t < 0x80) break;
+    }
+
+    return size;
+}
+
+/**
+ * Makes serialized key of secondary index from specified field of serialized primary data.
+ * The key is a message, which consists of the only field "key_field" of the same type as "field".
+ * The field is copied straight from serialized data, so no messages are constructed or parsed.
+ * Can be used in index callback functions (see "index_callback"), e.g.:
+ *
+ * return bdb::index_field(data, month::data::kSeasonFieldNumber, month::season_ix::kSeasonFieldNumber, result);
+ *
+ * @return 0 on success.
+ * @return "DB_DONOTINDEX" if the data doesn't contain the field.
+ */
+int index_field (const DBT * data,          /**< [in]  Serialized primary data.      */
+                 int         field,         /**< [in]  Field number in primary data. */
+                 int         key_field,     /**< [in]  Field number in index key.    */
+                 DBT       * result)        /**< [out] Serialized index key.         */
+{
+    int           wiretype;
+    const uint8 * begin;
+    const uint8 * end;
+
+    if (!find_raw(data, field, &wiretype, &begin, &end))
+    {
+        return DB_DONOTINDEX;
+    }
+
+    uint8  tag[10];
+    size_t tagsize = encode_tag(tag, key_field, wiretype);
+
+    size_t bytes = tagsize + (end - begin);
+
+    memset(result, 0, sizeof(DBT));
+
+    result->data  = malloc(bytes);
+    result->flags = DB_DBT_USERMEM | DB_DBT_APPMALLOC;
+    result->ulen  = (u_int32_t) bytes;
+    result->size  = (u_int32_t) bytes;
+
+    memcpy(result->data, tag, tagsize);
+    memcpy((uint8 *) result->data + tagsize, begin, end - begin);
+
+    return 0;
+}
+
+/**
+ * Makes serialized keys of secondary index from all values of specified repeated field of serialized
+ * primary data, so the record is indexed by each of them (Berkeley DB "DB_DBT_MULTIPLE" result).
+ * Each key is a message, which consists of the only field "key_field", like one made by "bdb::index_field".
+ * Equal values are indexed once. Packed repeated fields are not supported. Can be used in index callback
+ * functions (see "index_callback"), e.g.:
+ *
+ * return bdb::index_repeated(data, article::data::kTagFieldNumber, article::tag_ix::kTagFieldNumber, result);
+ *
+ * @return 0 on success.
+ * @return "DB_DONOTINDEX" if the data doesn't contain the field.
+ */
+int index_repeated (const DBT * data,       /**< [in]  Serialized primary data.      */
+                    int         field,      /**< [in]  Field number in primary data. */
+                    int         key_field,  /**< [in]  Field number in index key.    */
+                    DBT       * result)     /**< [out] Serialized index keys.        */
+{
+    vector <raw_field> raws;
+
+    // raw values reference per-thread buffer of decompressed value, which is kept until keys are made
+    const DBT * plain = plain_value(data);
+
+    CodedInputStream input((const uint8 *) plain->data, (int) plain->size);
+
+    for (;;)
+    {
+        uint32 tag = input.ReadTag();
+        if (tag == 0) break;
+
+        const void * begin;
+        const void * end;
+        int          before, after;
+
+        input.GetDirectBufferPointerInline(&begin, &before);
+        if (!WireFormatLite::SkipField(&input, tag)) break;
+        input.GetDirectBufferPointerInline(&end, &after);
+
+        if (WireFormatLite::GetTagFieldNumber(tag) != field) continue;
+
+        raw_field raw;
+
+        raw.wiretype = (int) WireFormatLite::GetTagWireType(tag);
+        raw.begin    = (const uint8 *) begin;
+        raw.end      = (const uint8 *) begin + (before - after);
+
+        // the same value must not be indexed twice for the same record
+        bool duplicate = false;
+
+        for (size_t i = 0; i < raws.size() && !duplicate; i++)
+        {
+            duplicate = (raws[i].wiretype == raw.wiretype &&
+                         raws[i].end - raws[i].begin == raw.end - raw.begin &&
+                         memcmp(raws[i].begin, raw.begin, raw.end - raw.begin) == 0);
+        }
+
+        if (!duplicate) raws.push_back(raw);
+    }
+
+    if (raws.empty())
+    {
+        return DB_DONOTINDEX;
+    }
+
+    DBT * keys = (DBT *) malloc(raws.size() * sizeof(DBT));
+
+    for (size_t i = 0; i < raws.size(); i++)
+    {
+        uint8  tag[10];
+        size_t tagsize = encode_tag(tag, key_field, raws[i].wiretype);
+
+        size_t bytes = tagsize + (raws[i].end - raws[i].begin);
+
+        memset(&keys[i], 0, sizeof(DBT));
+
+        keys[i].data  = malloc(bytes);
+        keys[i].flags = DB_DBT_USERMEM | DB_DBT_APPMALLOC;
+        keys[i].ulen  = (u_int32_t) bytes;
+        keys[i].size  = (u_int32_t) bytes;
+
+        memcpy(keys[i].data, tag, tagsize);
+        memcpy((uint8 *) keys[i].data + tagsize, raws[i].begin, raws[i].end - raws[i].begin);
+    }
+
+    memset(result, 0, sizeof(DBT));
+
+    result->data  = keys;
+    result->flags = DB_DBT_MULTIPLE | DB_DBT_APPMALLOC;
+    result->size  = (u_int32_t) raws.size();
+
+    return 0;
+}
+
+/**
+ * Makes serialized key of secondary index from raw value of a field (see "bdb::extract_fields").
+ * Useful for index callbacks, which share one pass over primary data (see also "bdb::index_field").
+ *
+ * @return 0 on success.
+ * @return "DB_DONOTINDEX" if the field is absent.
+ */
+int index_value (const field_value * value,     /**< [in]  Raw value of the field.   */
+                 int                 key_field, /**< [in]  Field number in index key. */
+                 DBT               * result)    /**< [out] Serialized index key.     */
+{
+    if (value->wiretype == -1)
+    {
+        return DB_DONOTINDEX;
+    }
+
+    uint8  tag[10];
+    size_t tagsize = encode_tag(tag, key_field, value->wiretype);
+
+    // length of length-delimited value is restored
+    uint8  len[10];
+    size_t lensize = 0;
+
+    if (value->wiretype == WIRETYPE_LENGTH_DELIMITED)
+    {
+        lensize = CodedOutputStream::WriteVarint32ToArray((uint32) value->size, len) - len;
+    }
+
+    size_t bytes = tagsize + lensize + value->size;
+
+    memset(result, 0, sizeof(DBT));
+
+    result->data  = malloc(bytes);
+    result->flags = DB_DBT_USERMEM | DB_DBT_APPMALLOC;
+    result->ulen  = (u_int32_t) bytes;
+    result->size  = (u_int32_t) bytes;
+
+    memcpy(result->data, tag, tagsize);
+    memcpy((uint8 *) result->data + tagsize, len, lensize);
+    memcpy((uint8 *) result->data + tagsize + lensize, value->data, value->size);
+
+    return 0;
+}
+
+/**
+ * @private Appends raw value of a field (see "bdb::extract_fields") of specified comparison type
+ * in order-preserving encoding, the same as "bdb::serialize_key" encodes field of that type.
+ * Returns "false" if wire type of the value doesn't match the type.
+ */
+static bool encode_raw (string            & out,    /**< [out] Encoded value.                         */
+                        const field_value & value,  /**< [in]  Raw value of the field.                */
+                        int                 type)   /**< [in]  Type of the field ("BDB_FIELD_STRING"). */
+{
+    const uint8 * pos = (const uint8 *) value.data;
+    const uint8 * end = pos + value.size;
+
+    uint64_t v = 0;
+
+    switch (type)
+    {
+        case BDB_FIELD_STRING:
+        {
+            if (value.wiretype != WIRETYPE_LENGTH_DELIMITED) return false;
+
+            encode_bytes(out, pos, value.size);
+            return true;
+        }
+
+        case BDB_FIELD_INT32:
+        case BDB_FIELD_INT64:
+        case BDB_FIELD_UINT32:
+        case BDB_FIELD_UINT64:
+        case BDB_FIELD_SINT32:
+        case BDB_FIELD_SINT64:
+            if (value.wiretype != WIRETYPE_VARINT || !read_varint(&pos, end, &v)) return false;
+            break;
+
+        case BDB_FIELD_FIXED32:
+        case BDB_FIELD_SFIXED32:
+        case BDB_FIELD_FLOAT:
+            if (value.wiretype != WIRETYPE_FIXED32 || !read_fixed(&pos, end, 4, &v)) return false;
+            break;
+
+        case BDB_FIELD_FIXED64:
+        case BDB_FIELD_SFIXED64:
+        case BDB_FIELD_DOUBLE:
+            if (value.wiretype != WIRETYPE_FIXED64 || !read_fixed(&pos, end, 8, &v)) return false;
+            break;
+
+        default:
+            return false;
+    }
+
+    switch (type)
+    {
+        case BDB_FIELD_INT32:
+        case BDB_FIELD_SFIXED32:
+            encode_uint(out, (uint32_t) v ^ SIGN32, 4);
+            break;
+
+        case BDB_FIELD_INT64:
+        case BDB_FIELD_SFIXED64:
+            encode_uint(out, v ^ SIGN64, 8);
+            break;
+
+        case BDB_FIELD_UINT32:
+        case BDB_FIELD_FIXED32:
+            encode_uint(out, (uint32_t) v, 4);
+            break;
+
+        case BDB_FIELD_UINT64:
+        case BDB_FIELD_FIXED64:
+            encode_uint(out, v, 8);
+            break;
+
+        case BDB_FIELD_SINT32:
+            encode_uint(out, (uint32_t) WireFormatLite::ZigZagDecode32((uint32) v) ^ SIGN32, 4);
+            break;
+
+        case BDB_FIELD_SINT64:
+            encode_uint(out, (uint64_t) WireFormatLite::ZigZagDecode64(v) ^ SIGN64, 8);
+            break;
+
+        case BDB_FIELD_FLOAT:
+        {
+            uint32_t bits = (uint32_t) v;
+            encode_uint(out, (bits & SIGN32) ? ~bits : bits | SIGN32, 4);
+            break;
+        }
+
+        case BDB_FIELD_DOUBLE:
+            encode_uint(out, (v & SIGN64) ? ~v : v | SIGN64, 8);
+            break;
+    }
+
+    return true;
+}
+
+/**
+ * Makes serialized key of composite index from specified fields of serialized primary data
+ * (see "table::add_index"). The key is encoded in order-preserving format, as "bdb::serialize_key" encodes
+ * a message of the same fields (of the same types, and in the same order), so the keys are sorted by plain
+ * comparison of bytes, and need no comparison function. Absent fields (and the fields, which wire type
+ * doesn't match their types) are encoded as absent ones, and are sorted before present ones.
+ * For repeated fields the first value is used. Fields of type "BDB_FIELD_UINT32" are encoded as "uint32"
+ * ones, so "bool" fields of key messages don't match them.
+ *
+ * @return 0 on success.
+ */
+int index_fields (const DBT * data,     /**< [in]  Serialized primary data.                   */
+                  const int * fields,   /**< [in]  Field numbers in primary data.             */
+                  const int * types,    /**< [in]  Types of the fields ("BDB_FIELD_STRING"). */
+                  int         count,    /**< [in]  Number of the fields.                      */
+                  DBT       * result)   /**< [out] Serialized index key.                      */
+{
+    vector <field_value> values(count);
+    extract_fields(data, fields, count, &values[0]);
+
+    string out;
+
+    for (int i = 0; i < count; i++)
+    {
+        size_t size = out.size();
+
+        out.push_back((char) KEY_PRESENT);
+
+        if (values[i].wiretype == -1 || !encode_raw(out, values[i], types[i]))
+        {
+            out.resize(size);
+            out.push_back((char) KEY_ABSENT);
+        }
+    }
+
+    memset(result, 0, sizeof(DBT));
+
+    result->data  = malloc(out.size());
+    result->flags = DB_DBT_USERMEM | DB_DBT_APPMALLOC;
+    result->ulen  = (u_int32_t) out.size();
+    result->size  = (u_int32_t) out.size();
+
+    memcpy(result->data, out.data(), out.size());
+
+    return 0;
+}
+
+/**
+ * @private Splits specified text into words of full-text index (see "table::add_text_index").
+ * Words are runs of ASCII letters and digits, and of non-ASCII bytes (so UTF-8 letters are kept),
+ * ASCII letters are folded to lower case. Every word is returned once, in order of its first occurrence.
+ */
+void split_words (const void      * text,   /**< [in]  Text.           */
+                  size_t            size,   /**< [in]  Size of text.   */
+                  vector <string> * words)  /**< [out] Distinct words. */
+{
+    words->clear();
+
+    const uint8 * pos = (const uint8 *) text;
+    const uint8 * end = pos + size;
+
+    string word;
+
+    for (;;)
+    {
+        bool letter = (pos < end && (*pos >= 0x80 || isalnum(*pos)));
+
+        if (letter)
+        {
+            word.push_back((char) (*pos < 0x80 ? tolower(*pos) : *pos));
+        }
+        else if (!word.empty())
+        {
+            if (std::find(words->begin(), words->end(), word) == words->end()) words->push_back(word);
+            word.clear();
+        }
+
+        if (pos++ == end) break;
+    }
+}
+
+/**
+ * @private Encodes specified word into key of full-text index, the same as "bdb::serialize_key" encodes
+ * a key message with the only string field.
+ */
+void encode_word (const string & word,  /**< [in]  Word of the index.    */
+                  string       * key)   /**< [out] Encoded key.          */
+{
+    key->clear();
+    key->push_back((char) KEY_PRESENT);
+    encode_bytes(*key, (const uint8 *) word.data(), word.size());
+}
+
+/**
+ * Makes serialized keys of full-text index from specified string field of serialized primary data,
+ * so the record is indexed by each distinct word of the field (Berkeley DB "DB_DBT_MULTIPLE" result).
+ * Keys are encoded as "bdb::serialize_key" encodes a key message with the only string field, e.g.
+ * "month::season_ix" (see "table::add_text_index").
+ *
+ * @return 0 on success.
+ * @return "DB_DONOTINDEX" if the data doesn't contain the field, or the field has no words.
+ */
+int index_words (const DBT * data,      /**< [in]  Serialized primary data.      */
+                 int         field,     /**< [in]  Field number in primary data. */
+                 DBT       * result)    /**< [out] Serialized index keys.        */
+{
+    field_value value;
+
+    if (!extract_field(data, field, &value) || value.wiretype != WIRETYPE_LENGTH_DELIMITED)
+    {
+        return DB_DONOTINDEX;
+    }
+
+    vector <string> words;
+    split_words(value.data, value.size, &words);
+
+    if (words.empty())
+    {
+        return DB_DONOTINDEX;
+    }
+
+    DBT * keys = (DBT *) malloc(words.size() * sizeof(DBT));
+
+    string key;
+
+    for (size_t i = 0; i < words.size(); i++)
+    {
+        encode_word(words[i], &key);
+
+        memset(&keys[i], 0, sizeof(DBT));
+
+        keys[i].data  = malloc(key.size());
+        keys[i].flags = DB_DBT_USERMEM | DB_DBT_APPMALLOC;
+        keys[i].ulen  = (u_int32_t) key.size();
+        keys[i].size  = (u_int32_t) key.size();
+
+        memcpy(keys[i].data, key.data(), key.size());
+    }
+
+    memset(result, 0, sizeof(DBT));
+
+    result->data  = keys;
+    result->flags = DB_DBT_MULTIPLE | DB_DBT_APPMALLOC;
+    result->size  = (u_int32_t) words.size();
+
+    return 0;
+}
+
+/**
+ * Makes serialized projection of specified fields of serialized primary data (see "project_callback").
+ * The projection is a message of the same type, which consists of specified (non-repeated) fields only.
+ * The fields are copied straight from serialized data, so no messages are constructed or parsed, e.g.:
+ *
+ * static const int fields[] = { month::data::kSeasonFieldNumber, month::data::kDaysFieldNumber };
+ * return bdb::project_fields(data, fields, 2, result);
+ *
+ * @return 0 on success.
+ */
+int project_fields (const DBT * data,       /**< [in]  Serialized primary data.    */
+                    const int * fields,     /**< [in]  Field numbers to project.   */
+                    int         count,      /**< [in]  Number of fields.           */
+                    DBT       * result)     /**< [out] Serialized projection.      */
+{
+    vector <raw_field> raws(count + 1);
+
+    if (count > 0) scan_fields(data, fields, count, &raws[0]);
+
+    string out;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (raws[i].wiretype < 0) continue;
+
+        uint8  tag[10];
+        size_t tagsize = encode_tag(tag, fields[i], raws[i].wiretype);
+
+        out.append((const char *) tag, tagsize);
+        out.append((const char *) raws[i].begin, raws[i].end - raws[i].begin);
+    }
+
+    memset(result, 0, sizeof(DBT));
+
+    result->data  = malloc(out.empty() ? 1 : out.size());
+    result->flags = DB_DBT_USERMEM | DB_DBT_APPMALLOC;
+    result->ulen  = (u_int32_t) out.size();
+    result->size  = (u_int32_t) out.size();
+
+    memcpy(result->data, out.data(), out.size());
+
+    return 0;
+}
+
+/**
+ * Merges serialized delta into serialized data of a record by rules of ProtoBuf merge (see "merge_callback"):
+ * singular fields of the delta replace ones of the data, and repeated fields of the delta are appended
+ * to ones of the data. Serialized messages are merged by concatenation, so neither of them is parsed.
+ *
+ * @return true (the record is always changed).
+ */
+bool merge_append (const DBT * data,    /**< [in]  Serialized data of the record ("NULL" if it doesn't exist). */
+                   const DBT * delta,   /**< [in]  Serialized delta.                                           */
+                   string    * result,  /**< [out] Serialized merged data.                                     */
+                   void      *)
+{
+    result->clear();
+
+    if (data != NULL) result->append((const char *) data->data, data->size);
+    result->append((const char *) delta->data, delta->size);
+
+    return true;
+}
+
+/**
+ * Adds integer field of serialized delta to the same field of serialized data of a record (see "merge_callback"),
+ * e.g. to increment a counter. The parameter is the number of the field ("int *"), which must be of a varint type
+ * ("int32", "int64", "uint32" or "uint64"). Other fields of the data are kept, and other fields of the delta are
+ * ignored, unless the record doesn't exist, and is created by the delta itself. Fields are copied straight from
+ * serialized data, so no messages are constructed or parsed.
+ *
+ * @return true  - the field is added.
+ * @return false - the delta doesn't contain the field (the record is left as it is).
+ */
+bool merge_add (const DBT * data,   /**< [in]  Serialized data of the record ("NULL" if it doesn't exist). */
+                const DBT * delta,  /**< [in]  Serialized delta.                                           */
+                string    * result, /**< [out] Serialized merged data.                                     */
+                void      * param)  /**< [in]  Number of added field ("int *").                            */
+{
+    int field = *(const int *) param;
+
+    int64_t value = 0;
+    int64_t total = 0;
+
+    if (!extract_field(delta, field, &value)) return false;
+    if (data != NULL) extract_field(data, field, &total);
+
+    result->clear();
+
+    // all occurrences of the field are replaced by the sum at the end
+    {
+        const DBT * plain = (data != NULL ? plain_value(data) : delta);
+
+        CodedInputStream input((const uint8 *) plain->data, (int) plain->size);
+
+        for (;;)
+        {
+            const void * begin;
+            int          before, after;
+
+            input.GetDirectBufferPointerInline(&begin, &before);
+
+            uint32 tag = input.ReadTag();
+            if (tag == 0) break;
+
+            if (!WireFormatLite::SkipField(&input, tag)) break;
+
+            const void * end;
+            input.GetDirectBufferPointerInline(&end, &after);
+
+            if (WireFormatLite::GetTagFieldNumber(tag) != field) result->append((const char *) begin, before - after);
+        }
+    }
+
+    uint8  tag[10];
+    size_t tagsize = encode_tag(tag, field, WIRETYPE_VARINT);
+
+    uint8  varint[10];
+    size_t varsize = CodedOutputStream::WriteVarint64ToArray((uint64_t) (total + value), varint) - varint;
+
+    result->append((const char *) tag, tagsize);
+    result->append((const char *) varint, varsize);
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  States of comparison functions.
+//--------------------------------------------------------------------------------------------------
+
+/** @private Decoded key, cached for a comparison function. */
+struct compare_entry
+{
+    state_callback      fn_decode;  /**< Decoding function of the comparison function. */
+    free_state_callback fn_free;    /**< Freeing function of the state.                */
+    string              key;        /**< Serialized key.                               */
+    void              * state;      /**< Decoded key ("NULL" if none).                 */
+};
+
+/** @private Decoded keys of all comparison functions, used by a thread. */
+struct compare_states
+{
+    vector <compare_entry> entries;     /**< Decoded keys. */
+
+    ~compare_states ()
+    {
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            if (entries[i].state != NULL && entries[i].fn_free != NULL) entries[i].fn_free(entries[i].state);
+        }
+    }
+};
+
+/** @private Per-thread states of comparison functions. */
+static boost::thread_specific_ptr <compare_states> compare_caches;
+
+/**
+ * Returns state of comparison function, decoded from specified serialized key by "fn_decode",
+ * e.g. the key, parsed into a message (see "bdb::message_compare"). Btree search calls the comparison
+ * function several times with the same application key as "dbt1", so the key is decoded once per
+ * operation, and only the tree key ("dbt2") is decoded by each call. The state is cached per thread,
+ * and is valid until the thread decodes a different key by the same function ("fn_free" frees it then).
+ */
+void * compare_state (const DBT           * dbt,        /**< [in] Serialized key (usually "dbt1").    */
+                      state_callback        fn_decode,  /**< [in] Decoding function.                  */
+                      free_state_callback   fn_free)    /**< [in] Freeing function (can be "NULL").   */
+{
+    compare_states * states = compare_caches.get();
+
+    if (states == NULL)
+    {
+        states = new compare_states;
+        compare_caches.reset(states);
+    }
+
+    compare_entry * entry = NULL;
+
+    for (size_t i = 0; i < states->entries.size() && entry == NULL; i++)
+    {
+        if (states->entries[i].fn_decode == fn_decode) entry = &states->entries[i];
+    }
+
+    if (entry == NULL)
+    {
+        compare_entry empty = { fn_decode, fn_free, string(), NULL };
+        states->entries.push_back(empty);
+        entry = &states->entries.back();
+    }
+    else if (entry->key.size() == dbt->size && memcmp(entry->key.data(), dbt->data, dbt->size) == 0)
+    {
+        return entry->state;
+    }
+
+    if (entry->state != NULL && entry->fn_free != NULL) entry->fn_free(entry->state);
+
+    entry->key.assign((const char *) dbt->data, dbt->size);
+    entry->fn_free = fn_free;
+    entry->state   = fn_decode(dbt);
+
+    return entry->state;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Compression of values.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * @private Marker of compressed value.
+ * Serialized ProtoBuf message never starts with zero byte, since zero is not a valid tag.
+ */
+static const uint8 COMPRESSED_MARKER = 0;
+
+/** @private Size of header of compressed value (marker and original size), at most. */
+static const size_t COMPRESSED_HEADER_SIZE = 1 + 5;
+
+/** @private Marker of value, tagged by version of schema of its table (never a tag of ProtoBuf field). */
+static const uint8 VERSIONED_MARKER = 0x06;
+
+/** @private Marker of encrypted value (never a tag of ProtoBuf field, since wire type "7" is not valid). */
+static const uint8 ENCRYPTED_MARKER = 0x07;
+
+/** @private Current codec of values. */
+static value_codec current_codec = { 0, NULL, NULL };
+
+/** @private Current cipher of values. */
+static value_cipher current_cipher = { 0, NULL, NULL };
+
+/** @private Last decompressed value of a thread. */
+struct plain_cache
+{
+    string packed;      /**< Compressed value. */
+    string plain;       /**< Decompressed one. */
+    DBT    dbt;         /**< Decompressed value as "DBT" object. */
+    DBT    body;        /**< Value without its version (see "bdb::version_header"). */
+    string sealed;      /**< Encrypted value.  */
+    string opened;      /**< Decrypted one.    */
+    DBT    clear;       /**< Decrypted value as "DBT" object. */
+};
+
+/** @private Per-thread cache of decompressed values. */
+static boost::thread_specific_ptr <plain_cache> plain_caches;
+
+/**
+ * Sets codec to compress large serialized values by "bdb::serialize", or disables compression.
+ * Compressed value is marked by zero header byte, so values, written before the codec was set,
+ * are still read as is. The codec should be set before the database is opened, and must not be
+ * disabled while the database contains compressed values.
+ */
+void set_codec (const value_codec * codec)  /**< [in] Codec of values (can be "NULL"). */
+{
+    LOG4CPLUS_DEBUG(logger, "[bdb::set_codec] " << (codec == NULL ? "none" : "custom"));
+
+    if (codec == NULL)
+    {
+        memset(&current_codec, 0, sizeof(value_codec));
+    }
+    else
+    {
+        current_codec = *codec;
+    }
+}
+
+/**
+ * Sets cipher to encrypt values of records, written by tables (after their compression, if any), or disables
+ * encryption. Values are encrypted in memory of the process, so pages, the log and the cache keep only encrypted
+ * values, and Berkeley DB doesn't spend time on encryption of whole pages (see "bdb::table_options::encrypted").
+ * Keys are never encrypted, so their order is kept. Encrypted value is marked by its header byte, so values,
+ * written before the cipher was set, are still read as is. The cipher should be set before the database is
+ * opened, and must not be disabled while the database contains encrypted values.
+ */
+void set_cipher (const value_cipher * cipher)   /**< [in] Cipher of values (can be "NULL"). */
+{
+    LOG4CPLUS_DEBUG(logger, "[bdb::set_cipher] " << (cipher == NULL ? "none" : "custom"));
+
+    if (cipher == NULL)
+    {
+        memset(&current_cipher, 0, sizeof(value_cipher));
+    }
+    else
+    {
+        current_cipher = *cipher;
+    }
+}
+
+/**
+ * @private Checks whether serialized values should be encrypted.
+ */
+bool should_encrypt ()
+{
+    return (current_cipher.fn_encrypt != NULL);
+}
+
+/**
+ * @private Returns maximal size of encrypted value of specified size, with its header.
+ */
+size_t sealed_size (size_t size)    /**< [in] Size of serialized value. */
+{
+    return 1 + size + current_cipher.overhead;
+}
+
+/**
+ * @private Encrypts specified serialized (and maybe compressed) value into buffer of "bdb::sealed_size" bytes,
+ * prefixed by header. Returns size of encrypted value, or "0" if the cipher fails.
+ */
+size_t encrypt_value (const void * raw,     /**< [in]  Serialized value.                  */
+                      size_t       size,    /**< [in]  Size of the value.                 */
+                      void       * dest)    /**< [out] Buffer of "sealed_size" bytes.     */
+{
+    uint8 * out = (uint8 *) dest;
+
+    out[0] = ENCRYPTED_MARKER;
+
+    size_t sealed = current_cipher.fn_encrypt(raw, size, out + 1);
+
+    if (sealed == 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::encrypt_value] value cannot be encrypted");
+        return 0;
+    }
+
+    return 1 + sealed;
+}
+
+/**
+ * @private Checks whether serialized value of specified size should be compressed.
+ */
+bool should_compress (size_t size)  /**< [in] Size of serialized value. */
+{
+    return (current_codec.fn_compress != NULL && size >= current_codec.threshold && size > COMPRESSED_HEADER_SIZE);
+}
+
+/**
+ * @private Compresses specified serialized value into buffer of the same size, prefixed by header.
+ * Returns size of compressed value, or "0" if the value isn't compressed smaller.
+ */
+size_t compress_value (const void * raw,    /**< [in]  Serialized value.               */
+                       size_t       size,   /**< [in]  Size of the value.              */
+                       void       * dest)   /**< [out] Buffer of "size" bytes.         */
+{
+    if (!should_compress(size))
+    {
+        return 0;
+    }
+
+    uint8 * out = (uint8 *) dest;
+
+    out[0] = COMPRESSED_MARKER;
+    size_t header = CodedOutputStream::WriteVarint32ToArray((uint32) size, out + 1) - out;
+
+    size_t packed = current_codec.fn_compress(raw, size, out + header, size - header - 1);
+
+    return (packed == 0 ? 0 : header + packed);
+}
+
+/**
+ * @private Writes header of value, tagged by specified version of schema (see "bdb::table_options::schema_version"),
+ * into buffer of at least 6 bytes. Returns size of the header.
+ */
+size_t version_header (unsigned int   version,  /**< [in]  Version of schema.  */
+                       void         * dest)     /**< [out] Buffer of header.   */
+{
+    uint8 * out = (uint8 *) dest;
+
+    out[0] = VERSIONED_MARKER;
+
+    return CodedOutputStream::WriteVarint32ToArray((uint32) version, out + 1) - out;
+}
+
+/**
+ * @private Returns version of schema of specified serialized value ("0" if the value is not tagged).
+ */
+unsigned int value_version (const DBT * dbt)    /**< [in] Serialized value. */
+{
+    const uint8 * data = (const uint8 *) dbt->data;
+
+    if (dbt->size == 0 || data[0] != VERSIONED_MARKER)
+    {
+        return 0;
+    }
+
+    const uint8 * pos = data + 1;
+    uint64_t      version;
+
+    return (read_varint(&pos, data + dbt->size, &version) ? (unsigned int) version : 0);
+}
+
+/**
+ * @private Returns decompressed value of specified "DBT" object, or the object itself, if it's not compressed.
+ * Version of value, tagged by version of schema, is skipped, and encrypted value is decrypted first.
+ * Decompressed value is kept in per-thread buffer, until a different value is decompressed by the thread.
+ */
+const DBT * plain_value (const DBT * dbt)   /**< [in] Serialized value. */
+{
+    const uint8 * data = (const uint8 *) dbt->data;
+
+    if (dbt->size == 0 || (data[0] != COMPRESSED_MARKER && data[0] != VERSIONED_MARKER && data[0] != ENCRYPTED_MARKER))
+    {
+        return dbt;
+    }
+
+    plain_cache * cache = plain_caches.get();
+
+    if (cache == NULL)
+    {
+        cache = new plain_cache;
+        plain_caches.reset(cache);
+    }
+
+    if (data[0] == VERSIONED_MARKER)
+    {
+        // version is skipped, and the rest is read as untagged value (which can be compressed)
+        const uint8 * pos = data + 1;
+        uint64_t      version;
+
+        if (!read_varint(&pos, data + dbt->size, &version))
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::plain_value] malformed version of value");
+            return dbt;
+        }
+
+        memset(&cache->body, 0, sizeof(DBT));
+        cache->body.data = (void *) pos;
+        cache->body.size = (u_int32_t) (dbt->size - (pos - data));
+
+        dbt  = &cache->body;
+        data = pos;
+
+        if (dbt->size == 0 || (data[0] != COMPRESSED_MARKER && data[0] != ENCRYPTED_MARKER))
+        {
+            return dbt;
+        }
+    }
+
+    if (data[0] == ENCRYPTED_MARKER)
+    {
+        // decrypted value is read as plain one (which can be compressed)
+        if (cache->sealed.size() != dbt->size || memcmp(cache->sealed.data(), data, dbt->size) != 0)
+        {
+            size_t decrypted = 0;
+
+            cache->sealed.clear();
+            cache->opened.resize(dbt->size);
+
+            if (current_cipher.fn_decrypt == NULL || !current_cipher.fn_decrypt(data + 1, dbt->size - 1, &cache->opened[0], &decrypted))
+            {
+                LOG4CPLUS_WARN(logger, "[bdb::plain_value] encrypted value cannot be decrypted");
+                return dbt;
+            }
+
+            cache->sealed.assign((const char *) data, dbt->size);
+
+            memset(&cache->clear, 0, sizeof(DBT));
+            cache->clear.data = &cache->opened[0];
+            cache->clear.size = (u_int32_t) decrypted;
+        }
+
+        dbt  = &cache->clear;
+        data = (const uint8 *) dbt->data;
+
+        if (dbt->size == 0 || data[0] != COMPRESSED_MARKER)
+        {
+            return dbt;
+        }
+    }
+
+    // several callbacks of indexes usually read the same record one by one
+    if (cache->packed.size() == dbt->size && memcmp(cache->packed.data(), data, dbt->size) == 0)
+    {
+        return &cache->dbt;
+    }
+
+    const uint8 * pos = data + 1;
+    const uint8 * end = data + dbt->size;
+    uint64_t      original;
+
+    if (current_codec.fn_decompress == NULL || !read_varint(&pos, end, &original))
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::plain_value] compressed value cannot be decompressed");
+        return dbt;
+    }
+
+    size_t header = pos - data;
+
+    cache->packed.clear();
+    cache->plain.resize((size_t) original);
+
+    if (!current_codec.fn_decompress(data + header, dbt->size - header, &cache->plain[0], (size_t) original))
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::plain_value] malformed compressed value");
+        return dbt;
+    }
+
+    cache->packed.assign((const char *) data, dbt->size);
+
+    memset(&cache->dbt, 0, sizeof(DBT));
+    cache->dbt.data = &cache->plain[0];
+    cache->dbt.size = (u_int32_t) original;
+
+    return &cache->dbt;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Memory allocation functions.
+//--------------------------------------------------------------------------------------------------
+
+/** @private Current memory allocator. */
+static allocator current_allocator = { ::malloc, ::realloc, ::free };
+
+/** @private Whether memory allocations are counted. */
+static volatile bool stats_enabled = false;
+
+/** @private Statistics of memory allocations. */
+static memory_stats stats;
+
+/** @private Lock of the statistics. */
+static boost::mutex stats_mutex;
+
+/**
+ * Sets memory allocator, used by the library and by Berkeley DB for memory, which is returned to the library
+ * (e.g. pool or arena allocator, or one of jemalloc or tcmalloc). "NULL" restores the default one ("malloc").
+ * The allocator must be set before any database is opened, and can't be changed while databases are open,
+ * since memory must be freed by the same allocator which allocated it.
+ */
+void set_allocator (const allocator * alloc)    /**< [in] Memory allocator (can be "NULL"). */
+{
+    LOG4CPLUS_DEBUG(logger, "[bdb::set_allocator] " << (alloc == NULL ? "default" : "custom"));
+
+    if (alloc == NULL)
+    {
+        current_allocator.fn_malloc  = ::malloc;
+        current_allocator.fn_realloc = ::realloc;
+        current_allocator.fn_free    = ::free;
+    }
+    else
+    {
+        current_allocator = *alloc;
+    }
+}
+
+/**
+ * Enables or disables counting of memory allocations, and resets the counters.
+ * The counters are shared by all threads, so counting is disabled by default.
+ *
+ * @see get_memory_stats
+ */
+void set_memory_stats (bool enable)     /**< [in] Whether to count memory allocations. */
+{
+    boost::mutex::scoped_lock lock(stats_mutex);
+
+    memset(&stats, 0, sizeof(memory_stats));
+    stats_enabled = enable;
+}
+
+/**
+ * Returns statistics of memory allocations, made through the library's allocator since counting was enabled.
+ *
+ * @see set_memory_stats
+ */
+void get_memory_stats (memory_stats * result)   /**< [out] Statistics of memory allocations. */
+{
+    boost::mutex::scoped_lock lock(stats_mutex);
+    *result = stats;
+}
+
+/**
+ * Allocate memory block.
+ * The function is to be internally used by Berkeley DB API.
+ */
+void * malloc (size_t size)
+{
+    if (stats_enabled)
+    {
+        boost::mutex::scoped_lock lock(stats_mutex);
+        stats.mallocs++;
+        stats.bytes += size;
+    }
+
+    return current_allocator.fn_malloc(size);
+}
+
+/**
+ * Reallocate memory block.
+ * The function is to be internally used by Berkeley DB API.
+ */
+void * realloc (void * ptr, size_t size)
+{
+    if (stats_enabled)
+    {
+        boost::mutex::scoped_lock lock(stats_mutex);
+        stats.reallocs++;
+        stats.bytes += size;
+    }
+
+    return current_allocator.fn_realloc(ptr, size);
+}
+
+/**
+ * Deallocate space in memory.
+ * The function is to be internally used by Berkeley DB API.
+ */
+void free (void * ptr)
+{
+    if (stats_enabled && ptr != NULL)
+    {
+        boost::mutex::scoped_lock lock(stats_mutex);
+        stats.frees++;
+    }
+
+    current_allocator.fn_free(ptr);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -0,0 +1,91 @@
+// Generated by the protocol buffer compiler.  DO NOT EDIT!
+
+#define INTERNAL_SUPPRESS_PROTOBUF_FIELD_DEPRECATION
+#include "bdb.pb.h"
+
+#include <algorithm>
+
+#include <google/protobuf/stubs/once.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite_inl.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/reflection_ops.h>
+#include <google/protobuf/wire_format.h>
+// @@protoc_insertion_point(includes)
+
+namespace bdb {
+
+namespace {
+
+
+}  // namespace
+
+
+void protobuf_AssignDesc_bdb_2eproto() {
+  protobuf_AddDesc_bdb_2eproto();
+  const ::google::protobuf::FileDescriptor* file =
+    ::google::protobuf::DescriptorPool::generated_pool()->FindFileByName(
+      "bdb.proto");
+  GOOGLE_CHECK(file != NULL);
+}
+
+namespace {
+
+GOOGLE_PROTOBUF_DECLARE_ONCE(protobuf_AssignDescriptors_once_);
+inline void protobuf_AssignDescriptorsOnce() {
+  ::google::protobuf::GoogleOnceInit(&protobuf_AssignDescriptors_once_,
+                 &protobuf_AssignDesc_bdb_2eproto);
+}
+
+void protobuf_RegisterTypes(const ::std::string&) {
+  protobuf_AssignDescriptorsOnce();
+}
+
+}  // namespace
+
+void protobuf_ShutdownFile_bdb_2eproto() {
+}
+
+void protobuf_AddDesc_bdb_2eproto() {
+  static bool already_here = false;
+  if (already_here) return;
+  already_here = true;
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  ::google::protobuf::protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();
+  ::google::protobuf::DescriptorPool::InternalAddGeneratedFile(
+    "\n\tbdb.proto\022\003bdb\032 google/protobuf/descri"
+    "ptor.proto:1\n\010sort_key\022\035.google.protobuf"
+    ".FieldOptions\030\271\216\003 \001(\010:2\n\tindex_key\022\035.goo"
+    "gle.protobuf.FieldOptions\030\272\216\003 \001(\t", 153);
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
+    "bdb.proto", &protobuf_RegisterTypes);
+  ::google::protobuf::internal::ExtensionSet::RegisterExtension(
+    &::google::protobuf::FieldOptions::default_instance(),
+    51001, 8, false, false);
+  ::google::protobuf::internal::ExtensionSet::RegisterExtension(
+    &::google::protobuf::FieldOptions::default_instance(),
+    51002, 9, false, false);
+  ::google::protobuf::internal::OnShutdown(&protobuf_ShutdownFile_bdb_2eproto);
+}
+
+// Force AddDescriptors() to be called at static initialization time.
+struct StaticDescriptorInitializer_bdb_2eproto {
+  StaticDescriptorInitializer_bdb_2eproto() {
+    protobuf_AddDesc_bdb_2eproto();
+  }
+} static_descriptor_initializer_bdb_2eproto_;
+
+::google::protobuf::internal::ExtensionIdentifier< ::google::protobuf::FieldOptions,
+    ::google::protobuf::internal::PrimitiveTypeTraits< bool >, 8, false >
+  sort_key(kSortKeyFieldNumber, false);
+const ::std::string index_key_default("");
+::google::protobuf::internal::ExtensionIdentifier< ::google::protobuf::FieldOptions,
+    ::google::protobuf::internal::StringTypeTraits, 9, false >
+  index_key(kIndexKeyFieldNumber, index_key_default);
+
+// @@protoc_insertion_point(namespace_scope)
+
+}  // namespace bdb
+
+// @@protoc_insertion_point(global_scope)
@@ -0,0 +1,246 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/budget.cc
+ * Contains implementation of class "bdb::memory_governor".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cassert>
+#include <cstring>
+#include <map>
+
+// Boost C++ Libraries
+#include <boost/thread/mutex.hpp>
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::memory_governor".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::map;
+
+/** @private Table, which takes memory from the budget. */
+struct budget_consumer
+{
+    uint64_t filter;    /**< Memory of Bloom filter of the table.              */
+    uint64_t limit;     /**< Memory, granted to the cache of the table.        */
+    bool     cache;     /**< Whether the table has a cache of records.         */
+};
+
+/** @private Split of the budget between its consumers. */
+class governor_state
+{
+public:
+
+    governor_state () : budget(0), mpool(0), library(0), buffers(0), evictions(0), rebalances(0), warned(false) { }
+
+    boost::mutex                        mutex;      /**< Guards all the fields below.                          */
+    uint64_t                            budget;     /**< Whole memory budget.                                  */
+    uint64_t                            mpool;      /**< Part of the budget, taken by the cache of the environment. */
+    uint64_t                            library;    /**< Part of the budget, left for the library.             */
+    uint64_t                            buffers;    /**< Memory, reserved by buffers of buffered tables.       */
+    uint64_t                            evictions;  /**< Number of records, evicted by caches for lack of memory. */
+    uint64_t                            rebalances; /**< Number of splits of the memory between caches.        */
+    bool                                warned;     /**< Whether overflow of the budget is reported.           */
+    map <table *, budget_consumer>      consumers;  /**< Tables with caches of records or Bloom filters.       */
+
+    /**
+     * Splits memory, which is left after Bloom filters and buffers, between caches of records: half of it
+     * equally, and another half in proportion to evictions of the caches since the previous split.
+     */
+    void rebalance ()
+    {
+        uint64_t reserved = buffers;
+        unsigned int ncaches = 0;
+
+        for (map <table *, budget_consumer>::const_iterator i = consumers.begin(); i != consumers.end(); i++)
+        {
+            reserved += i->second.filter;
+            if (i->second.cache) ncaches++;
+        }
+
+        if (reserved > library && !warned)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::memory_governor::rebalance] Bloom filters and buffers take " << reserved << " bytes of " << library << " ones of the budget.");
+            warned = true;
+        }
+
+        if (ncaches == 0) return;
+
+        uint64_t available = (reserved < library ? library - reserved : 0);
+
+        map <table *, uint64_t> pressure;
+        uint64_t total = 0;
+
+        for (map <table *, budget_consumer>::const_iterator i = consumers.begin(); i != consumers.end(); i++)
+        {
+            if (!i->second.cache) continue;
+
+            uint64_t n = i->first->cache_evictions();
+
+            pressure[i->first] = n;
+            total += n;
+        }
+
+        evictions += total;
+
+        uint64_t equal = available / 2 / ncaches;
+        uint64_t extra = available - equal * ncaches;
+
+        for (map <table *, budget_consumer>::iterator i = consumers.begin(); i != consumers.end(); i++)
+        {
+            if (!i->second.cache) continue;
+
+            uint64_t share = (total != 0 ? (uint64_t) ((double) extra * pressure[i->first] / total) : extra / ncaches);
+
+            i->second.limit = equal + share;
+            i->first->limit_cache(i->second.limit);
+        }
+
+        rebalances++;
+
+        LOG4CPLUS_DEBUG(logger, "[bdb::memory_governor::rebalance] caches = " << ncaches << ", available = " << available << ", evictions = " << total);
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Creates the budget with no consumers.
+ */
+memory_governor::memory_governor (uint64_t budget,      /**< [in] Whole memory budget, in bytes.            */
+                                  uint64_t mpool)       /**< [in] Size of the cache of the environment.     */
+{
+    m_state = new governor_state;
+    assert(m_state != NULL);
+
+    m_state->budget  = budget;
+    m_state->mpool   = mpool;
+    m_state->library = (mpool < budget ? budget - mpool : 0);
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::memory_governor::memory_governor] budget = " << budget << ", library = " << m_state->library);
+}
+
+/**
+ * Destroys the budget (all its consumers must be gone).
+ */
+memory_governor::~memory_governor () throw ()
+{
+    delete m_state;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds table, which has cache of records or Bloom filter of keys, and rebalances the budget.
+ */
+void memory_governor::add (table * tbl)     /**< [in] Opened table. */
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    budget_consumer & consumer = m_state->consumers[tbl];
+
+    consumer.filter = tbl->filter_bytes();
+    consumer.limit  = 0;
+    consumer.cache  = (tbl->m_cache != NULL);
+
+    m_state->rebalance();
+}
+
+/**
+ * Removes table (e.g. when it's closed), and gives its memory to other tables.
+ */
+void memory_governor::remove (table * tbl)  /**< [in] Table being closed. */
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    if (m_state->consumers.erase(tbl) != 0) m_state->rebalance();
+}
+
+/**
+ * Reserves memory of a buffer in the budget, or releases it, if "bytes" is negative.
+ */
+void memory_governor::reserve (int64_t bytes)   /**< [in] Size of the buffer. */
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    m_state->buffers = (uint64_t) ((int64_t) m_state->buffers + bytes);
+
+    m_state->rebalance();
+}
+
+/**
+ * Splits the memory between caches of records again (a cache has evicted records for lack of memory).
+ */
+void memory_governor::rebalance ()
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    m_state->rebalance();
+}
+
+/**
+ * Returns current split of the budget.
+ */
+void memory_governor::stats (budget_stats * result)     /**< [out] Statistics of the budget. */
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    memset(result, 0, sizeof(budget_stats));
+
+    result->budget          = m_state->budget;
+    result->mpool_bytes     = m_state->mpool;
+    result->library_bytes   = m_state->library;
+    result->buffer_bytes    = m_state->buffers;
+    result->cache_evictions = m_state->evictions;
+    result->rebalances      = m_state->rebalances;
+
+    for (map <table *, budget_consumer>::const_iterator i = m_state->consumers.begin(); i != m_state->consumers.end(); i++)
+    {
+        result->filter_bytes += i->second.filter;
+
+        if (i->second.cache)
+        {
+            result->cache_limit += i->second.limit;
+            result->cache_bytes += i->first->cache_bytes();
+        }
+    }
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,848 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/buffered.cc
+ * Contains implementation of class "bdb::buffered_table".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Boost C++ Libraries
+#include <boost/thread/mutex.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::buffered_table".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::map;
+using std::string;
+using std::vector;
+
+/** @private Kinds of buffered changes ("0" - the key is not buffered). */
+enum { BUFFER_PUT = 1, BUFFER_REMOVE = 2, BUFFER_MERGE = 3 };
+
+/** @private Default size of buffered changes, which triggers a flush, in bytes. */
+static const size_t BUFFER_MEMORY = 4 * 1024 * 1024;
+
+/** @private Memory, which the buffer needs per change, besides its key and data (approximately). */
+static const size_t BUFFER_ENTRY_OVERHEAD = 64;
+
+/** @private Buffered change of a record. */
+class buffer_entry
+{
+public:
+
+    buffer_entry () : kind(0) { }
+
+    int     kind;   /**< Kind of the change.                                        */
+    string  data;   /**< Serialized data (empty for removals, coalesced delta for merges). */
+};
+
+/** @private Order of serialized keys of buffered changes the way the table sorts them. */
+class buffer_less
+{
+public:
+
+    buffer_less (table * tbl) : m_table(tbl) { }
+
+    bool operator () (const string & k1, const string & k2) const
+    {
+        DBT d1, d2;
+
+        memset(&d1, 0, sizeof(DBT));
+        memset(&d2, 0, sizeof(DBT));
+
+        d1.data = (void *) k1.data();
+        d1.size = (u_int32_t) k1.size();
+        d2.data = (void *) k2.data();
+        d2.size = (u_int32_t) k2.size();
+
+        return m_table->compare_keys(&d1, &d2) < 0;
+    }
+
+protected:
+
+    table * m_table;
+};
+
+/** @private Buffered changes of buffered table ("memtable"). */
+class buffer_state
+{
+public:
+
+    buffer_state (table * tbl, merge_callback fn, void * p) : entries(buffer_less(tbl)), bytes(0), fn_merge(fn), param(p) { }
+
+    boost::mutex                                    mutex;      /**< Guards all the fields below.            */
+    map <string, buffer_entry, buffer_less>         entries;    /**< Last changes of records by their keys.  */
+    size_t                                          bytes;      /**< Size of buffered changes, in bytes.     */
+    merge_callback                                  fn_merge;   /**< Merge function of deltas.               */
+    void                                          * param;      /**< Parameter of the merge function.        */
+
+    /** Adds change of a record, replacing the previous one of the same key. */
+    void add (const string & key, int kind, const string & data)
+    {
+        map <string, buffer_entry, buffer_less>::iterator i = entries.find(key);
+
+        if (i == entries.end())
+        {
+            i = entries.insert(std::make_pair(key, buffer_entry())).first;
+            bytes += key.size() + BUFFER_ENTRY_OVERHEAD;
+        }
+
+        bytes -= i->second.data.size();
+        bytes += data.size();
+
+        i->second.kind = kind;
+        i->second.data = data;
+    }
+
+    /** Coalesces delta of a record with its buffered change (if any). */
+    void merge (const string & key, const string & delta)
+    {
+        map <string, buffer_entry, buffer_less>::const_iterator i = entries.find(key);
+
+        if (i == entries.end())
+        {
+            add(key, BUFFER_MERGE, delta);
+            return;
+        }
+
+        DBT d, m;
+
+        memset(&d, 0, sizeof(DBT));
+        memset(&m, 0, sizeof(DBT));
+
+        d.data = (void *) i->second.data.data();
+        d.size = (u_int32_t) i->second.data.size();
+        m.data = (void *) delta.data();
+        m.size = (u_int32_t) delta.size();
+
+        string result;
+
+        // removed record is created by the delta, and buffered data or deltas are merged with it
+        if (i->second.kind == BUFFER_REMOVE)
+        {
+            if (fn_merge(NULL, &m, &result, param)) add(key, BUFFER_PUT, result);
+        }
+        else if (i->second.kind == BUFFER_PUT)
+        {
+            if (fn_merge(plain_value(&d), &m, &result, param)) add(key, BUFFER_PUT, result);
+        }
+        else
+        {
+            if (fn_merge(&d, &m, &result, param)) add(key, BUFFER_MERGE, result);
+        }
+    }
+};
+
+/**
+ * @private Makes "DBT" object, which references specified string.
+ */
+static void make_dbt (const string & from,  /**< [in]  Source string.       */
+                      DBT          * to)    /**< [out] Resulted "DBT" object. */
+{
+    memset(to, 0, sizeof(DBT));
+
+    to->data = (void *) from.data();
+    to->size = (u_int32_t) from.size();
+}
+
+/**
+ * @private Appends specified change to the log of buffered changes: kind of the change (1 byte),
+ * size of the key (4 bytes), the key, and the data.
+ */
+static int append_log (DB           * log,      /**< [in] Log of buffered changes.  */
+                       DB_TXN       * txn,      /**< [in] Transaction to use.       */
+                       int            kind,     /**< [in] Kind of the change.       */
+                       const string & key,      /**< [in] Serialized key.           */
+                       const string & data)     /**< [in] Serialized data.          */
+{
+    u_int32_t size = (u_int32_t) key.size();
+
+    string change;
+    change.reserve(1 + sizeof(size) + key.size() + data.size());
+
+    change.append(1, (char) kind);
+    change.append((const char *) &size, sizeof(size));
+    change.append(key);
+    change.append(data);
+
+    db_recno_t recno = 0;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.data  = &recno;
+    k.ulen  = sizeof(recno);
+    k.flags = DB_DBT_USERMEM;
+
+    d.data = (void *) change.data();
+    d.size = (u_int32_t) change.size();
+
+    return log->put(log, txn, &k, &d, DB_APPEND);
+}
+
+/**
+ * @private Parses change, read from the log of buffered changes (see "append_log").
+ *
+ * @return true  - the change is parsed.
+ * @return false - the change is malformed.
+ */
+static bool parse_log (const DBT * change,  /**< [in]  Logged change.      */
+                       int       * kind,    /**< [out] Kind of the change. */
+                       string    * key,     /**< [out] Serialized key.     */
+                       string    * data)    /**< [out] Serialized data.    */
+{
+    const char * pos = (const char *) change->data;
+    const char * end = pos + change->size;
+
+    u_int32_t size;
+
+    if ((size_t) (end - pos) < 1 + sizeof(size)) return false;
+
+    *kind = *pos++;
+    memcpy(&size, pos, sizeof(size));
+    pos += sizeof(size);
+
+    if ((u_int32_t) (end - pos) < size) return false;
+    if (*kind != BUFFER_PUT && *kind != BUFFER_REMOVE && *kind != BUFFER_MERGE) return false;
+
+    key->assign(pos, size);
+    data->assign(pos + size, end);
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens the table with its log of buffered changes (it's created on first use), and replays changes,
+ * which were not flushed before the table was closed last time.
+ * If "create" is "true" and table doesn't exist, then creates it.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the table is not found.
+ * @throw bdb::exception BDB_ERROR_EXISTS    - the table already exists.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+buffered_table::buffered_table (database            * db,       /**< [in] Database of the table.                                  */
+                                const char          * name,     /**< [in] Name of the table.                                      */
+                                compare_callback      fn_cmp,   /**< [in] Keys comparision function.                              */
+                                bool                  create,   /**< [in] Whether to create the table if it doesn't exist.        */
+                                const table_options & options,  /**< [in] Tuning options of the table.                            */
+                                size_t                memory,   /**< [in] Size of buffered changes, which triggers a flush ("0" - default). */
+                                merge_callback        fn_merge, /**< [in] Merge function of deltas (see "bdb::table::merge").     */
+                                void                * param)    /**< [in] Parameter to pass to the merge function.                */
+  : m_database(db),
+    m_table(NULL),
+    m_log(NULL),
+    m_memory(memory != 0 ? memory : BUFFER_MEMORY),
+    m_state(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::buffered_table] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::buffered_table::buffered_table] name = " << name);
+    LOG4CPLUS_DEBUG(logger, "[bdb::buffered_table::buffered_table] memory = " << m_memory);
+
+    // the table is closed with its database
+    m_table = db->add_table(name, fn_cmp, create, options);
+
+    m_table->check_open();
+
+    int res = db_create(&m_log, db->m_env, 0);
+    if (res == 0) res = db->open_file(m_log, db->get_transaction(), string(name) + ".buffer", "buffer", DB_RECNO, DB_THREAD | DB_CREATE);
+
+    if (res == 0)
+    {
+        m_state = new buffer_state(m_table, fn_merge, param);
+        assert(m_state != NULL);
+
+        res = replay();
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::buffered_table::buffered_table] " << db_strerror(res));
+
+        delete m_state;
+        if (m_log != NULL) m_log->close(m_log, 0);
+
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    // the buffer reserves its memory in the budget of the database
+    if (db->m_governor != NULL) db->m_governor->reserve((int64_t) m_memory);
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::buffered_table::buffered_table] replayed = " << m_state->entries.size());
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::buffered_table] EXIT");
+}
+
+/**
+ * Flushes buffered changes, and closes the log. Changes, which cannot be flushed, stay in the log,
+ * and are replayed on the next opening.
+ */
+buffered_table::~buffered_table () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::~buffered_table] ENTER");
+
+    {
+        boost::mutex::scoped_lock lock(m_state->mutex);
+
+        int res = write_changes();
+
+        if (res != 0)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::buffered_table::~buffered_table] " << db_strerror(res));
+        }
+    }
+
+    delete m_state;
+    m_log->close(m_log, 0);
+
+    if (m_database->m_governor != NULL) m_database->m_governor->reserve(-(int64_t) m_memory);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::~buffered_table] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Buffers new data of specified record, which is added or overwritten by the next flush.
+ * When the buffer is full, flushes it.
+ *
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - foreign constraint violation (on flush).
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ */
+void buffered_table::put (key_ref             key,      /**< [in] Key of the record.  */
+                          const MessageLite * data)     /**< [in] Data of the record. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::put] ENTER");
+    change(key, data, BUFFER_PUT);
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::put] EXIT");
+}
+
+/**
+ * Buffers removal of specified record, which is removed by the next flush (if it exists).
+ * When the buffer is full, flushes it.
+ *
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - foreign constraint violation (on flush).
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ */
+void buffered_table::remove (key_ref key)   /**< [in] Key of the record. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::remove] ENTER");
+    change(key, NULL, BUFFER_REMOVE);
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::remove] EXIT");
+}
+
+/**
+ * Buffers delta of specified record, which is merged into the record by the next flush (see "bdb::table::merge").
+ * Deltas of the same record are coalesced in the buffer. When the buffer is full, flushes it.
+ *
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - foreign constraint violation (on flush).
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ */
+void buffered_table::merge (key_ref             key,    /**< [in] Key of the record.    */
+                            const MessageLite * delta)  /**< [in] Delta of the record.  */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::merge] ENTER");
+    change(key, delta, BUFFER_MERGE);
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::merge] EXIT");
+}
+
+/**
+ * Checks whether the record with specified key exists, taking buffered changes into account.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+bool buffered_table::exists (key_ref key)   /**< [in] Key of the record. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::exists] ENTER");
+
+    scratch_scope scope;
+    DBT k;
+
+    m_table->encode_key(key, &k, &scope);
+    string raw((const char *) k.data, k.size);
+    release(&k);
+
+    string data;
+
+    int kind = lookup(raw, &data);
+
+    bool res = (kind == 0 ? m_table->exists(key_ref(raw.data(), raw.size())) : kind == BUFFER_PUT);
+
+    if (kind == BUFFER_MERGE)
+    {
+        string merged;
+
+        int err = resolve(raw, data, &merged, &res);
+
+        if (err != 0)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::buffered_table::exists] " << db_strerror(err));
+            throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::exists] EXIT = " << res);
+
+    return res;
+}
+
+/**
+ * Finds the record with specified key, taking buffered changes into account.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the record is not found.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void buffered_table::select (key_ref         key,   /**< [in]  Key of the record.   */
+                             MessageLite   * data)  /**< [out] Data of the record.  */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::select] ENTER");
+
+    if (!find(key, data))
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::buffered_table::select] " << db_strerror(DB_NOTFOUND));
+        throw exception(BDB_ERROR_NOT_FOUND);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::select] EXIT");
+}
+
+/**
+ * Finds the record with specified key, taking buffered changes into account, like "select",
+ * but reports missing record without an exception (see "bdb::table::find").
+ *
+ * @return true  - the record is found.
+ * @return false - the record is not found ("data" is not changed).
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+bool buffered_table::find (key_ref         key,     /**< [in]  Key of the record.   */
+                           MessageLite   * data)    /**< [out] Data of the record.  */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::find] ENTER");
+
+    scratch_scope scope;
+    DBT k;
+
+    m_table->encode_key(key, &k, &scope);
+    string raw((const char *) k.data, k.size);
+    release(&k);
+
+    string value;
+
+    int kind = lookup(raw, &value);
+
+    if (kind == 0)
+    {
+        bool res = m_table->find(key_ref(raw.data(), raw.size()), data);
+        LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::find] EXIT = " << res);
+        return res;
+    }
+
+    // buffered deltas are merged into the flushed record
+    if (kind == BUFFER_MERGE)
+    {
+        string delta;
+        delta.swap(value);
+
+        bool found = false;
+
+        int res = resolve(raw, delta, &value, &found);
+
+        if (res != 0)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::buffered_table::find] " << db_strerror(res));
+
+            switch (res)
+            {
+                case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+                case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+                default:                    throw exception(BDB_ERROR_UNKNOWN);
+            }
+        }
+
+        kind = (found ? BUFFER_PUT : BUFFER_REMOVE);
+    }
+
+    DBT d;
+    memset(&d, 0, sizeof(DBT));
+
+    d.data = (void *) value.data();
+    d.size = (u_int32_t) value.size();
+
+    // buffered data can expire as well as flushed ones
+    if (kind == BUFFER_REMOVE || m_table->is_expired(&d))
+    {
+        LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::find] EXIT = false");
+        return false;
+    }
+
+    m_table->unserialize_data(&d, data);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::find] EXIT = true");
+
+    return true;
+}
+
+/**
+ * Writes all buffered changes to the table in order of keys, in one transaction (current one, if any),
+ * which also clears the log of buffered changes. When an error occurs, the changes stay buffered.
+ *
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - foreign constraint violation.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ */
+void buffered_table::flush ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::flush] ENTER");
+
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::buffered_table::flush] size = " << m_state->entries.size());
+
+    int res = write_changes();
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::buffered_table::flush] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::buffered_table::flush] EXIT");
+}
+
+/**
+ * Returns number of buffered changes (of distinct keys).
+ */
+size_t buffered_table::size () const
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+    return m_state->entries.size();
+}
+
+/**
+ * Returns underlying table, e.g. to read its records by recordsets after a flush.
+ */
+table * buffered_table::get () const
+{
+    return m_table;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * @private Logs and buffers new data or delta of specified record ("NULL" - the record is removed),
+ * and flushes the buffer, when it's full.
+ */
+void buffered_table::change (key_ref             key,   /**< [in] Key of the record.           */
+                             const MessageLite * data,  /**< [in] Data of the record (or "NULL"). */
+                             int                 kind)  /**< [in] Kind of the change.          */
+{
+    m_table->check_open();
+
+    scratch_scope scope;
+    DBT k, d;
+
+    memset(&d, 0, sizeof(DBT));
+
+    // deltas are merged as they are, so they are never compressed
+    m_table->encode_key(key, &k, &scope);
+    if (data != NULL) scope.serialize(data, &d, kind != BUFFER_MERGE);
+    if (data != NULL && kind != BUFFER_MERGE) m_table->stamp_value(&d, &scope);
+
+    string raw((const char *) k.data, k.size);
+    string value;
+
+    if (data != NULL) value.assign((const char *) d.data, d.size);
+
+    release(&k);
+    if (data != NULL) release(&d);
+
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    DB_TXN * txn = m_database->get_transaction();
+    DB_TXN * own = NULL;
+
+    int res = m_database->begin_auto(&txn, &own);
+
+    if (res == 0) res = append_log(m_log, txn, kind, raw, value);
+
+    res = m_database->end_auto(own, res);
+
+    if (res == 0)
+    {
+        if (kind == BUFFER_MERGE) m_state->merge(raw, value);
+        else                      m_state->add(raw, kind, value);
+    }
+
+    if (res == 0 && m_state->bytes >= m_memory) res = write_changes();
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::buffered_table::change] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+}
+
+/**
+ * @private Finds buffered change of specified serialized key.
+ *
+ * @return Kind of the change ("0" - the key is not buffered).
+ */
+int buffered_table::lookup (const string & key,     /**< [in]  Serialized key.                    */
+                            string       * data)    /**< [out] Buffered data (for buffered put).  */
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    map <string, buffer_entry, buffer_less>::const_iterator i = m_state->entries.find(key);
+
+    if (i == m_state->entries.end()) return 0;
+
+    if (i->second.kind != BUFFER_REMOVE) data->assign(i->second.data);
+
+    return i->second.kind;
+}
+
+/**
+ * @private Merges specified buffered delta into flushed record with specified serialized key, the way
+ * the next flush does it (see "bdb::table::merge_record"). Returns error code of Berkeley DB.
+ */
+int buffered_table::resolve (const string & key,     /**< [in]  Serialized key.                          */
+                             const string & delta,   /**< [in]  Coalesced delta.                         */
+                             string       * data,    /**< [out] Merged data.                             */
+                             bool         * found)   /**< [out] Whether the record exists after merging. */
+{
+    DB * db = m_table->m_db;
+
+    DBT k, d, m;
+
+    make_dbt(key, &k);
+    make_dbt(delta, &m);
+
+    memset(&d, 0, sizeof(DBT));
+    d.flags = DB_DBT_MALLOC;
+
+    int res = db->get(db, m_database->get_transaction(), &k, &d, 0);
+
+    bool missing = (res == DB_NOTFOUND || res == DB_KEYEMPTY);
+    if (missing) res = 0;
+
+    *found = false;
+
+    if (res == 0)
+    {
+        const DBT * plain = (missing ? NULL : plain_value(&d));
+
+        *found = m_state->fn_merge(plain, &m, data, m_state->param);
+
+        // the function may leave the record as it is
+        if (!*found && plain != NULL)
+        {
+            data->assign((const char *) plain->data, plain->size);
+            *found = true;
+        }
+    }
+
+    free(d.data);
+
+    return res;
+}
+
+/**
+ * @private Reads changes of the log into the buffer (in order they were logged).
+ * Returns error code of Berkeley DB.
+ */
+int buffered_table::replay ()
+{
+    DBC * cursor = NULL;
+
+    int res = m_log->cursor(m_log, m_database->get_transaction(), &cursor, 0);
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+    k.flags = DB_DBT_REALLOC;
+    d.flags = DB_DBT_REALLOC;
+
+    while (res == 0)
+    {
+        res = cursor->get(cursor, &k, &d, DB_NEXT);
+
+        int    kind;
+        string key, data;
+
+        if (res == 0 && !parse_log(&d, &kind, &key, &data)) res = EINVAL;
+        if (res == 0 && kind == BUFFER_MERGE) m_state->merge(key, data);
+        else if (res == 0) m_state->add(key, kind, data);
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    free(k.data);
+    free(d.data);
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    return res;
+}
+
+/**
+ * @private Writes all buffered changes to the table in order of keys, and clears the log, in one transaction
+ * (the buffer must be locked). Consecutive puts are written at once (see "bdb::table::put_records"),
+ * and coalesced deltas are merged into their records (see "bdb::table::merge_record").
+ * Returns error code of Berkeley DB.
+ */
+int buffered_table::write_changes ()
+{
+    if (m_state->entries.empty()) return 0;
+
+    DB_TXN * txn = m_database->get_transaction();
+    DB_TXN * own = NULL;
+
+    int res = m_database->begin_auto(&txn, &own);
+
+    vector <DBT> keys, data;
+
+    map <string, buffer_entry, buffer_less>::iterator i = m_state->entries.begin();
+
+    while (i != m_state->entries.end() && res == 0)
+    {
+        if (i->second.kind == BUFFER_REMOVE)
+        {
+            DBT k;
+            make_dbt(i->first, &k);
+
+            // removed record may have never been flushed
+            res = m_table->remove_record(txn, &k);
+            if (res == DB_NOTFOUND || res == DB_KEYEMPTY) res = 0;
+
+            ++i;
+            continue;
+        }
+
+        if (i->second.kind == BUFFER_MERGE)
+        {
+            DBT k, d;
+
+            make_dbt(i->first, &k);
+            make_dbt(i->second.data, &d);
+
+            bool created = false;
+
+            res = m_table->merge_record(txn, &k, &d, m_state->fn_merge, m_state->param, &created);
+
+            ++i;
+            continue;
+        }
+
+        // consecutive puts are written together, up to the next removal
+        keys.clear();
+        data.clear();
+
+        for (; i != m_state->entries.end() && i->second.kind == BUFFER_PUT; ++i)
+        {
+            DBT k, d;
+
+            make_dbt(i->first, &k);
+            make_dbt(i->second.data, &d);
+
+            keys.push_back(k);
+            data.push_back(d);
+        }
+
+        res = m_table->put_records(txn, keys, data);
+    }
+
+    u_int32_t count = 0;
+
+    if (res == 0) res = m_log->truncate(m_log, txn, &count, 0);
+
+    res = m_database->end_auto(own, res);
+
+    if (res == 0)
+    {
+        m_state->entries.clear();
+        m_state->bytes = 0;
+    }
+
+    return res;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
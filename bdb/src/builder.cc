@@ -0,0 +1,585 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/builder.cc
+ * Contains implementation of class "bdb::table_builder".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// Bulk puts are available since Berkeley DB 4.8
+#if (DB_VERSION_MAJOR > 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR >= 8)
+#define BDB_BULK_PUT
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::table_builder".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::string;
+using std::vector;
+
+/** @private Suffix of the name of new table, while it's being built. */
+static const char * BUILD_SUFFIX = ".build";
+
+/** @private Initial size of buffer for bulk puts. */
+static const size_t BUILD_BUFFER_SIZE = 1024 * 1024;
+
+/** @private Size of service data, which the bulk buffer needs per record, besides key and data. */
+static const size_t BUILD_RECORD_OVERHEAD = 8 * sizeof(u_int32_t);
+
+/**
+ * @private Makes "DBT" object, which references specified string.
+ */
+static void make_dbt (const string & from,  /**< [in]  Source string.       */
+                      DBT          * to)    /**< [out] Resulted "DBT" object. */
+{
+    memset(to, 0, sizeof(DBT));
+
+    to->data = (void *) from.data();
+    to->size = (u_int32_t) from.size();
+}
+
+/** @private State of the builder. */
+class build_state
+{
+public:
+
+    build_state ()
+      : sorter(NULL),
+        count(0),
+        written(false),
+        committed(false),
+        ptr(NULL),
+        buffered(0)
+    {
+        memset(&bulk, 0, sizeof(bulk));
+    }
+
+    ~build_state ()
+    {
+        delete sorter;
+    }
+
+    external_sorter   * sorter;     /**< Sort of added records ("NULL" - records are added in order). */
+    uint64_t            count;      /**< Number of added records.                  */
+    vector <string>     drops;      /**< Names of indexes, which are dropped on commit. */
+    string              last;       /**< Key of last written record.               */
+    bool                written;    /**< Whether any record is written.            */
+    bool                committed;  /**< Whether the new table has replaced the old one. */
+    vector <char>       buffer;     /**< Bulk buffer.                              */
+    DBT                 bulk;       /**< Bulk buffer as "DBT" object.              */
+    void              * ptr;        /**< Current position in the bulk buffer.      */
+    unsigned int        buffered;   /**< Number of records in the bulk buffer.     */
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Starts a build of specified table: creates new empty file of the table, which is not logged.
+ * The table must not be opened in the database till the build is committed, and must be btree one
+ * (not partitioned). Options of the table are the same as for "bdb::database::add_table", while
+ * the page size and compression take effect on the new table.
+ *
+ * If "memory" is zero, records must be added in order of keys, and are written to the new file at once.
+ * Otherwise, records can be added in any order: they are sorted by external sort within "memory" bytes
+ * (see "bdb::external_sorter"), and are written on commit.
+ *
+ * @throw bdb::exception BDB_ERROR_EXISTS  - the table is opened.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+table_builder::table_builder (database            * db,         /**< [in] Database of the table.                                  */
+                              const char          * name,       /**< [in] Name of the table.                                      */
+                              compare_callback      fn_cmp,     /**< [in] Keys comparision function (see "Db::set_bt_compare()"). */
+                              const table_options & options,    /**< [in] Tuning options of the table.                            */
+                              size_t                memory)     /**< [in] Memory for sorting of records, in bytes ("0" - records are in order). */
+  : m_database(db),
+    m_table(NULL),
+    m_name(string(name)),
+    m_state(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table_builder::table_builder] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table_builder::table_builder] name = " << name);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table_builder::table_builder] memory = " << memory);
+
+    if (options.access_method != BDB_ACCESS_BTREE || options.partitions > 1)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table_builder::table_builder] Only btree tables without partitions can be built.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    if (is_opened())
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table_builder::table_builder] The table is opened, and cannot be replaced.");
+        throw exception(BDB_ERROR_EXISTS);
+    }
+
+    // the new table is configured as lazily opened one, and is opened below without any transaction
+    table_options tmp_options = options;
+
+    tmp_options.lazy_open     = true;
+    tmp_options.read_only     = false;
+    tmp_options.cache_records = 0;
+    tmp_options.bloom_bits    = 0;
+
+    string tmp_name = m_name + BUILD_SUFFIX;
+
+    m_table = new table(db, tmp_name.c_str(), fn_cmp, false, tmp_options);
+    assert(m_table != NULL);
+
+    // leftover of failed build, if any
+    int res = db->remove_file(NULL, m_table->get_filename(), tmp_name);
+
+    if (res == ENOENT) res = 0;
+
+    // nothing is logged, since the file is not used by anyone till it's complete
+    if (!db->m_concurrent && res == 0) res = m_table->m_db->set_flags(m_table->m_db, DB_TXN_NOT_DURABLE);
+
+    if (res == 0) res = db->open_file(m_table->m_db, NULL, m_table->get_filename(), tmp_name, DB_BTREE, DB_THREAD | DB_CREATE | DB_EXCL);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table_builder::table_builder] " << db_strerror(res));
+
+        delete m_table;
+        m_table = NULL;
+
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    m_table->m_lazy = false;
+
+    m_state = new build_state;
+    assert(m_state != NULL);
+
+    if (memory != 0)
+    {
+        m_state->sorter = new external_sorter(m_table, memory);
+        assert(m_state->sorter != NULL);
+    }
+
+#ifdef BDB_BULK_PUT
+
+    m_state->buffer.resize(BUILD_BUFFER_SIZE);
+
+    m_state->bulk.data  = &m_state->buffer[0];
+    m_state->bulk.ulen  = m_state->buffer.size();
+    m_state->bulk.flags = DB_DBT_USERMEM | DB_DBT_BULK;
+
+    DB_MULTIPLE_WRITE_INIT(m_state->ptr, &m_state->bulk);
+
+#endif
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table_builder::table_builder] EXIT");
+}
+
+/**
+ * Discards the build, if it's not committed, and removes the new file.
+ */
+table_builder::~table_builder () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table_builder::~table_builder] ENTER");
+
+    if (m_state == NULL || !m_state->committed)
+    {
+        string tmp_name = m_name + BUILD_SUFFIX;
+
+        delete m_table;
+        m_database->remove_file(NULL, tmp_name + ".db", tmp_name);
+    }
+
+    delete m_state;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table_builder::~table_builder] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds new record to the table.
+ * If the builder has no memory for sorting, records must be added in order of keys.
+ *
+ * @throw bdb::exception BDB_ERROR_EXISTS  - the same key is already added.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the record is out of order, the build is over, or unknown error.
+ */
+void table_builder::add (key_ref             key,   /**< [in] Key of new record.  */
+                         const MessageLite * data)  /**< [in] Data of new record. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table_builder::add] ENTER");
+
+    check_active();
+
+    scratch_scope scope;
+    DBT k, d;
+
+    m_table->encode_key(key, &k, &scope);
+    scope.serialize(data, &d);
+    m_table->stamp_value(&d, &scope);
+
+    int res = add_record(&k, &d);
+
+    release(&k);
+    release(&d);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table_builder::add] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_KEYEXIST:   throw exception(BDB_ERROR_EXISTS);
+            default:            throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table_builder::add] EXIT");
+}
+
+/**
+ * Adds new record, which is already serialized in format of the table (e.g. it's read from a dump of
+ * a table, see "bdb::restore"), without parsing of it; otherwise it's the same as the method above.
+ *
+ * @throw bdb::exception BDB_ERROR_EXISTS  - the same key is already added.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the record is out of order, the build is over, or unknown error.
+ */
+void table_builder::add (const DBT * key,   /**< [in] Serialized key.  */
+                         const DBT * data)  /**< [in] Serialized data. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table_builder::add] ENTER");
+
+    check_active();
+
+    int res = add_record(key, data);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table_builder::add] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_KEYEXIST:   throw exception(BDB_ERROR_EXISTS);
+            default:            throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table_builder::add] EXIT");
+}
+
+/**
+ * Declares specified index of the table as dropped, so the index is removed on commit together with
+ * the old table, and is built again when it's added to the new table (see "bdb::table::add_index").
+ * All indexes of the table must be dropped, since they don't match the new table.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the build is over.
+ */
+void table_builder::drop_index (const char * name)  /**< [in] Name of the index. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table_builder::drop_index] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table_builder::drop_index] name = " << name);
+
+    check_active();
+
+    m_state->drops.push_back(string(name));
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table_builder::drop_index] EXIT");
+}
+
+/**
+ * Completes the build: writes remaining records (sorted ones, if any), flushes the new file
+ * to disk, and replaces the old table (and dropped indexes) with the new file at once, in implicit
+ * transaction (if there is no one). Then the table can be opened by "bdb::database::add_table".
+ * Since the new file is not logged, the database should be backed up after the build
+ * (see "bdb::database::backup"), so catastrophic recovery doesn't depend on the file.
+ *
+ * @throw bdb::exception BDB_ERROR_EXISTS  - the same key is added twice, or the table is opened.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the build is over, or unknown error.
+ */
+void table_builder::commit ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table_builder::commit] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table_builder::commit] records = " << m_state->count);
+
+    check_active();
+
+    if (is_opened())
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table_builder::commit] The table is opened, and cannot be replaced.");
+        throw exception(BDB_ERROR_EXISTS);
+    }
+
+    int res = write_records();
+
+    // closing of the file flushes it to disk, the build is over anyway
+    DB * db = m_table->m_db;
+    m_table->m_db = NULL;
+
+    int err = db->close(db, 0);
+
+    if (res == 0) res = err;
+
+    delete m_table;
+    m_table = NULL;
+
+    if (res == 0) res = swap_files();
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table_builder::commit] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_KEYEXIST:           throw exception(BDB_ERROR_EXISTS);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    m_state->committed = true;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table_builder::commit] EXIT");
+}
+
+/**
+ * Returns number of records, added to the table.
+ */
+uint64_t table_builder::size ()
+{
+    return (m_state != NULL ? m_state->count : 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Checks that the build is not over yet.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the build is over.
+ */
+void table_builder::check_active ()
+{
+    if (m_table == NULL)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table_builder::check_active] The build is over.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+}
+
+/**
+ * Adds specified record to the sort, or writes it into the new file, if the builder doesn't sort records.
+ * Returns error code of Berkeley DB.
+ */
+int table_builder::add_record (const DBT * key,     /**< [in] Serialized key.  */
+                               const DBT * data)    /**< [in] Serialized data. */
+{
+    int res = (m_state->sorter == NULL ? put_record(key, data) : m_state->sorter->add(key, data));
+
+    if (res == 0) m_state->count++;
+
+    return res;
+}
+
+/**
+ * Writes specified record into the new file (through the bulk buffer, if available).
+ * Records must be written in order of keys.
+ * Returns error code of Berkeley DB.
+ */
+int table_builder::put_record (const DBT * key,     /**< [in] Serialized key.  */
+                               const DBT * data)    /**< [in] Serialized data. */
+{
+    if (m_state->written)
+    {
+        DBT last;
+        make_dbt(m_state->last, &last);
+
+        int cmp = m_table->compare_keys(&last, key);
+
+        if (cmp == 0) return DB_KEYEXIST;
+
+        if (cmp > 0)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::table_builder::put_record] Records are not in order of keys.");
+            return EINVAL;
+        }
+    }
+
+    int res = 0;
+
+#ifdef BDB_BULK_PUT
+
+    m_table->write_bulk(m_state->ptr, &m_state->bulk, key, data);
+
+    if (m_state->ptr == NULL)
+    {
+        // the buffer is full - flush it, and try again
+        res = flush_bulk();
+
+        // the record doesn't fit into empty buffer - enlarge the buffer
+        size_t needed = key->size + data->size + BUILD_RECORD_OVERHEAD;
+
+        if (m_state->buffer.size() < needed)
+        {
+            m_state->buffer.resize(needed);
+            m_state->bulk.data = &m_state->buffer[0];
+            m_state->bulk.ulen = m_state->buffer.size();
+        }
+
+        DB_MULTIPLE_WRITE_INIT(m_state->ptr, &m_state->bulk);
+        m_table->write_bulk(m_state->ptr, &m_state->bulk, key, data);
+        assert(m_state->ptr != NULL);
+    }
+
+    m_state->buffered++;
+
+#else
+
+    res = m_table->m_db->put(m_table->m_db, NULL, (DBT *) key, (DBT *) data, 0);
+
+#endif
+
+    m_state->last.assign((const char *) key->data, key->size);
+    m_state->written = true;
+
+    return res;
+}
+
+/**
+ * Puts records of the bulk buffer into the new file, and empties the buffer.
+ * Returns error code of Berkeley DB.
+ */
+int table_builder::flush_bulk ()
+{
+    int res = 0;
+
+#ifdef BDB_BULK_PUT
+
+    if (m_state->buffered != 0)
+    {
+        DBT empty;
+        memset(&empty, 0, sizeof(empty));
+
+        res = m_table->m_db->put(m_table->m_db, NULL, &m_state->bulk, &empty, DB_MULTIPLE_KEY);
+
+        m_state->buffered = 0;
+        DB_MULTIPLE_WRITE_INIT(m_state->ptr, &m_state->bulk);
+    }
+
+#endif
+
+    return res;
+}
+
+/**
+ * Writes sorted records, if any, into the new file, and flushes the bulk buffer.
+ * Returns error code of Berkeley DB.
+ */
+int table_builder::write_records ()
+{
+    int res = 0;
+
+    if (m_state->sorter != NULL)
+    {
+        res = m_state->sorter->finish();
+
+        DBT k, d;
+
+        while (res == 0 && (res = m_state->sorter->next(&k, &d)) == 0)
+        {
+            res = put_record(&k, &d);
+        }
+
+        if (res == DB_NOTFOUND) res = 0;
+    }
+
+    if (res == 0) res = flush_bulk();
+
+    return res;
+}
+
+/**
+ * Removes the old table with dropped indexes, and renames the new file to the table,
+ * in implicit transaction, if there is no one.
+ * Returns error code of Berkeley DB.
+ */
+int table_builder::swap_files ()
+{
+    string tmp_name = m_name + BUILD_SUFFIX;
+
+    DB_TXN * txn = m_database->get_transaction();
+    DB_TXN * own = NULL;
+
+    int res = m_database->begin_auto(&txn, &own);
+
+    if (res == 0) res = m_database->remove_file(txn, m_name + ".db", m_name);
+    if (res == ENOENT) res = 0;
+
+    for (size_t i = 0; i < m_state->drops.size() && res == 0; i++)
+    {
+        res = m_database->remove_file(txn, m_state->drops[i] + ".db", m_state->drops[i]);
+        if (res == ENOENT) res = 0;
+    }
+
+    if (res == 0) res = m_database->rename_file(txn, tmp_name + ".db", tmp_name, m_name + ".db", m_name);
+
+    return m_database->end_auto(own, res);
+}
+
+/**
+ * Checks whether the replaced table is opened in the database.
+ */
+bool table_builder::is_opened ()
+{
+    return (m_database->get_table(m_name.c_str()) != NULL);
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
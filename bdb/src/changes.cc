@@ -0,0 +1,452 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/changes.cc
+ * Contains implementation of class "bdb::change_stream", and of change log of class "bdb::database".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cassert>
+#include <cstring>
+#include <string>
+
+// Boost C++ Libraries
+#include <boost/thread/thread.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::change_stream".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::string;
+
+/** @private Size of absent field of captured change (old data of insertion, new data of removal). */
+static const u_int32_t CHANGE_ABSENT = 0xFFFFFFFF;
+
+/** @private Period of polling of change log for new changes (in milliseconds). */
+static const long CHANGE_POLL_PERIOD = 10;
+
+/**
+ * @private Appends specified field (its size, and contents) to serialized change.
+ */
+static void append_field (string     & to,      /**< [in/out] Serialized change.             */
+                          const void * data,    /**< [in]     Contents of the field.         */
+                          u_int32_t    size)    /**< [in]     Size of the field (or "CHANGE_ABSENT"). */
+{
+    to.append((const char *) &size, sizeof(size));
+
+    if (size != CHANGE_ABSENT && size != 0) to.append((const char *) data, size);
+}
+
+/**
+ * @private Parses next field of serialized change.
+ * Returns "false" if the change is malformed.
+ */
+static bool parse_field (const char *& pos,     /**< [in/out] Current position in the change. */
+                         const char  * end,     /**< [in]     End of the change.              */
+                         string      * field)   /**< [out]    Contents of the field.          */
+{
+    u_int32_t size;
+
+    if (end - pos < (long) sizeof(size)) return false;
+
+    memcpy(&size, pos, sizeof(size));
+    pos += sizeof(size);
+
+    if (size == CHANGE_ABSENT) size = 0;
+
+    if ((u_int32_t) (end - pos) < size) return false;
+
+    field->assign(pos, size);
+    pos += size;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Change log of the database.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens change log of the database, if it's not opened yet (it's created on first use).
+ * Changes are numbered by records of the log, which are appended in order ("DB_APPEND").
+ * Returns error code of Berkeley DB.
+ */
+int database::open_changes ()
+{
+    if (m_changes != NULL) return 0;
+
+    int res = db_create(&m_changes, m_env, 0);
+    if (res == 0) res = open_file(m_changes, NULL, "__changes.db", "__changes", DB_RECNO, DB_THREAD | DB_CREATE | DB_AUTO_COMMIT);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::open_changes] " << db_strerror(res));
+
+        if (m_changes != NULL) m_changes->close(m_changes, 0);
+        m_changes = NULL;
+    }
+
+    return res;
+}
+
+/**
+ * Appends change of specified record to change log of the database, in transaction of the change.
+ * Returns error code of Berkeley DB.
+ */
+int database::append_change (DB_TXN       * txn,        /**< [in] Transaction of the change.                */
+                             const string & table,      /**< [in] Name of changed table.                    */
+                             const DBT    * key,        /**< [in] Primary key.                              */
+                             const DBT    * olddata,    /**< [in] Old primary data ("NULL" for new record). */
+                             const DBT    * newdata)    /**< [in] New primary data ("NULL" for removed one). */
+{
+    latency_scope berkeley(BDB_LATENCY_BERKELEY);
+
+    char operation = (olddata == NULL ? BDB_CHANGE_INSERT : (newdata == NULL ? BDB_CHANGE_REMOVE : BDB_CHANGE_UPDATE));
+
+    string change;
+    change.reserve(1 + 4 * sizeof(u_int32_t) + table.size() + key->size + (olddata != NULL ? olddata->size : 0) + (newdata != NULL ? newdata->size : 0));
+
+    change.append(1, operation);
+    append_field(change, table.data(), (u_int32_t) table.size());
+    append_field(change, key->data, key->size);
+    append_field(change, (olddata != NULL ? olddata->data : NULL), (olddata != NULL ? olddata->size : CHANGE_ABSENT));
+    append_field(change, (newdata != NULL ? newdata->data : NULL), (newdata != NULL ? newdata->size : CHANGE_ABSENT));
+
+    db_recno_t recno = 0;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.data  = &recno;
+    k.ulen  = sizeof(recno);
+    k.flags = DB_DBT_USERMEM;
+
+    d.data = (void *) change.data();
+    d.size = (u_int32_t) change.size();
+
+    return m_changes->put(m_changes, txn, &k, &d, DB_APPEND);
+}
+
+/**
+ * Removes captured changes up to specified sequence number (inclusive), e.g. when all consumers
+ * have processed them (in implicit transaction, if there is no one). Sequence numbers of remaining
+ * and new changes stay the same.
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+void database::trim_changes (uint64_t sequence)     /**< [in] Sequence number of the last removed change. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::trim_changes] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::trim_changes] sequence = " << sequence);
+
+    if (m_changes == NULL)
+    {
+        LOG4CPLUS_TRACE(logger, "[bdb::database::trim_changes] EXIT");
+        return;
+    }
+
+    // changes, which are not applied to deferred indexes yet, are kept
+    uint64_t applied = m_applier->min_applied();
+    if (sequence >= applied) sequence = applied - 1;
+
+    DB_TXN * txn = get_transaction();
+    DB_TXN * own = NULL;
+
+    int res = begin_auto(&txn, &own);
+
+    DBC * cursor = NULL;
+    if (res == 0) res = m_changes->cursor(m_changes, txn, &cursor, write_flags());
+
+    db_recno_t recno = 0;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.data  = &recno;
+    k.ulen  = sizeof(recno);
+    k.flags = DB_DBT_USERMEM;
+
+    // only keys are read
+    d.flags = DB_DBT_PARTIAL;
+
+    while (res == 0)
+    {
+        res = cursor->get(cursor, &k, &d, DB_NEXT | DB_RMW);
+
+        if (res == 0 && recno > sequence) break;
+        if (res == 0) res = cursor->del(cursor, 0);
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    res = end_auto(own, res);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::trim_changes] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::trim_changes] EXIT");
+}
+
+/**
+ * Returns sequence number of the last change in change log of the database ("0" if the log is empty).
+ * Returns error code of Berkeley DB.
+ */
+int database::last_change (uint64_t * sequence)     /**< [out] Sequence number of the last change. */
+{
+    *sequence = 0;
+
+    if (m_changes == NULL) return 0;
+
+    DBC * cursor = NULL;
+
+    int res = m_changes->cursor(m_changes, get_transaction(), &cursor, read_flags());
+
+    db_recno_t recno = 0;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.data  = &recno;
+    k.ulen  = sizeof(recno);
+    k.flags = DB_DBT_USERMEM;
+
+    // only keys are read
+    d.flags = DB_DBT_PARTIAL;
+
+    if (res == 0) res = cursor->get(cursor, &k, &d, DB_LAST);
+
+    if (res == 0) *sequence = recno;
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    return res;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens change log of specified database (creating it, if no table has captured changes yet).
+ * The first returned change is the one with specified sequence number, or the next existing one.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+change_stream::change_stream (database * db,    /**< [in] Database of the change log.               */
+                              uint64_t   from)  /**< [in] Sequence number of the first change to read. */
+  : m_database(db),
+    m_next(from != 0 ? from : 1)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::change_stream::change_stream] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::change_stream::change_stream] from = " << from);
+
+    if (db->open_changes() != 0)
+    {
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::change_stream::change_stream] EXIT");
+}
+
+/**
+ * Closes the stream.
+ */
+change_stream::~change_stream () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::change_stream::~change_stream] ENTER");
+    LOG4CPLUS_TRACE(logger, "[bdb::change_stream::~change_stream] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Reads the next change of the log. If there are no new changes, waits for them up to specified timeout,
+ * polling the log. Returns "false" if there are no new changes yet (the stream can be read again later).
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+bool change_stream::next (change_record * change,   /**< [out] The next change.                                   */
+                          unsigned int    timeout)  /**< [in]  Time to wait for new changes, in milliseconds ("0" - don't wait). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::change_stream::next] ENTER");
+
+    uint64_t deadline = (timeout != 0 ? monotonic_time() + (uint64_t) timeout * 1000000 : 0);
+
+    for (;;)
+    {
+        int res = read_change(change);
+
+        if (res == 0)
+        {
+            m_next = change->sequence + 1;
+            break;
+        }
+
+        if (res != DB_NOTFOUND)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::change_stream::next] " << db_strerror(res));
+
+            switch (res)
+            {
+                case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+                case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+                default:                    throw exception(BDB_ERROR_UNKNOWN);
+            }
+        }
+
+        if (timeout == 0 || monotonic_time() >= deadline)
+        {
+            LOG4CPLUS_TRACE(logger, "[bdb::change_stream::next] EXIT");
+            return false;
+        }
+
+        boost::this_thread::sleep(boost::posix_time::milliseconds(CHANGE_POLL_PERIOD));
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::change_stream::next] EXIT");
+
+    return true;
+}
+
+/**
+ * Returns sequence number of the next change to read (e.g. to resume the stream later).
+ */
+uint64_t change_stream::position ()
+{
+    return m_next;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Reads the first existing change, starting from the next sequence number.
+ * Trimmed changes and changes of aborted transactions are skipped.
+ * Returns error code of Berkeley DB ("DB_NOTFOUND" if there are no new changes).
+ */
+int change_stream::read_change (change_record * change)     /**< [out] Read change. */
+{
+    // numbers of records are 32-bit
+    if (m_next > 0xFFFFFFFFULL) return DB_NOTFOUND;
+
+    DB * log = m_database->m_changes;
+
+    DBC * cursor = NULL;
+    int res = log->cursor(log, m_database->get_transaction(), &cursor, m_database->read_flags());
+
+    db_recno_t recno = (db_recno_t) m_next;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.data  = &recno;
+    k.size  = sizeof(recno);
+    k.ulen  = sizeof(recno);
+    k.flags = DB_DBT_USERMEM;
+
+    d.flags = DB_DBT_MALLOC;
+
+    if (res == 0) res = cursor->get(cursor, &k, &d, DB_SET);
+
+    // the change is removed, but there are later ones
+    if (res == DB_KEYEMPTY) res = cursor->get(cursor, &k, &d, DB_NEXT);
+
+    if (res == 0)
+    {
+        const char * pos = (const char *) d.data;
+        const char * end = pos + d.size;
+
+        change->sequence  = recno;
+        change->operation = (d.size != 0 ? *pos++ : 0);
+
+        if (!parse_field(pos, end, &change->table)   ||
+            !parse_field(pos, end, &change->key)     ||
+            !parse_field(pos, end, &change->olddata) ||
+            !parse_field(pos, end, &change->newdata))
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::change_stream::read_change] Malformed change " << recno << ".");
+            res = EINVAL;
+        }
+    }
+
+    free(d.data);
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    return res;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,879 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+
+/** @file bdb/src/columns.cc
+ * Contains implementation of class "bdb::column_store".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::column_store".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::string;
+using std::vector;
+
+using google::protobuf::uint8;
+
+/**
+ * @private Marker of stored chunk, which is not compressed (header of chunk can start with a byte,
+ * which marks compressed or versioned values, see "bdb::plain_value").
+ */
+static const char CHUNK_PLAIN = 'C';
+
+/** @private Header of stored chunk of columns. */
+struct chunk_header
+{
+    uint32_t rows;      /**< Number of rows of the chunk.     */
+    uint32_t columns;   /**< Number of columns of the chunk.  */
+};
+
+/**
+ * @private Rows of consecutive primary keys, split by columns. Stored chunk contains the header,
+ * values of each column (8 bytes per row), presence flags of each column (1 byte per row), and
+ * primary keys of the rows (each is prefixed by its size), so a column is read by a single copy.
+ */
+class column_chunk
+{
+public:
+
+    column_chunk (size_t columns) : values(columns), present(columns) { }
+
+    vector <string>             keys;       /**< Primary keys of the rows, in order of the table. */
+    vector < vector <int64_t> > values;     /**< Values of the rows by columns.                  */
+    vector < vector <uint8> >   present;    /**< Whether the rows contain the fields, by columns. */
+
+    /** Inserts row at specified position. */
+    void insert (size_t pos, const DBT * key, const vector <int64_t> & v, const vector <uint8> & p)
+    {
+        keys.insert(keys.begin() + pos, string((const char *) key->data, key->size));
+
+        for (size_t c = 0; c < values.size(); c++)
+        {
+            values [c].insert(values [c].begin() + pos, v[c]);
+            present[c].insert(present[c].begin() + pos, p[c]);
+        }
+    }
+
+    /** Replaces values of the row at specified position. */
+    void assign (size_t pos, const vector <int64_t> & v, const vector <uint8> & p)
+    {
+        for (size_t c = 0; c < values.size(); c++)
+        {
+            values [c][pos] = v[c];
+            present[c][pos] = p[c];
+        }
+    }
+
+    /** Removes the row at specified position. */
+    void erase (size_t pos)
+    {
+        keys.erase(keys.begin() + pos);
+
+        for (size_t c = 0; c < values.size(); c++)
+        {
+            values [c].erase(values [c].begin() + pos);
+            present[c].erase(present[c].begin() + pos);
+        }
+    }
+
+    /** Removes all rows. */
+    void clear ()
+    {
+        keys.clear();
+
+        for (size_t c = 0; c < values.size(); c++)
+        {
+            values [c].clear();
+            present[c].clear();
+        }
+    }
+
+    /** Serializes rows "[from, to)" into specified buffer. */
+    void encode (size_t from, size_t to, string * out) const
+    {
+        chunk_header header;
+
+        header.rows    = (uint32_t) (to - from);
+        header.columns = (uint32_t) values.size();
+
+        out->assign((const char *) &header, sizeof(chunk_header));
+
+        for (size_t c = 0; c < values.size(); c++)
+        {
+            if (to > from) out->append((const char *) &values[c][from], (to - from) * sizeof(int64_t));
+        }
+
+        for (size_t c = 0; c < present.size(); c++)
+        {
+            if (to > from) out->append((const char *) &present[c][from], to - from);
+        }
+
+        for (size_t r = from; r < to; r++)
+        {
+            uint32_t size = (uint32_t) keys[r].size();
+
+            out->append((const char *) &size, sizeof(uint32_t));
+            out->append(keys[r]);
+        }
+    }
+
+    /** Unserializes all rows from specified buffer; returns "false", if the buffer is malformed. */
+    bool decode (const DBT * dbt)
+    {
+        clear();
+
+        chunk_header header;
+
+        if (dbt->size < sizeof(chunk_header)) return false;
+
+        memcpy(&header, dbt->data, sizeof(chunk_header));
+
+        size_t rows = header.rows;
+        size_t size = sizeof(chunk_header) + rows * values.size() * (sizeof(int64_t) + 1);
+
+        if (header.columns != values.size() || dbt->size < size) return false;
+
+        const char * pos = (const char *) dbt->data + sizeof(chunk_header);
+        const char * end = (const char *) dbt->data + dbt->size;
+
+        for (size_t c = 0; c < values.size(); c++)
+        {
+            values[c].resize(rows);
+            if (rows != 0) memcpy(&values[c][0], pos, rows * sizeof(int64_t));
+            pos += rows * sizeof(int64_t);
+        }
+
+        for (size_t c = 0; c < present.size(); c++)
+        {
+            present[c].resize(rows);
+            if (rows != 0) memcpy(&present[c][0], pos, rows);
+            pos += rows;
+        }
+
+        keys.resize(rows);
+
+        for (size_t r = 0; r < rows; r++)
+        {
+            uint32_t ksize;
+
+            if (end - pos < (ptrdiff_t) sizeof(uint32_t)) return false;
+            memcpy(&ksize, pos, sizeof(uint32_t));
+            pos += sizeof(uint32_t);
+
+            if ((size_t) (end - pos) < ksize) return false;
+            keys[r].assign(pos, ksize);
+            pos += ksize;
+        }
+
+        return true;
+    }
+};
+
+/**
+ * @private Returns stored chunk without its marker, or decompressed one.
+ */
+static const DBT * plain_chunk (const DBT * stored,     /**< [in]  Stored chunk.              */
+                                DBT       * body)       /**< [out] Chunk without its marker.  */
+{
+    if (stored->size == 0 || *(const char *) stored->data != CHUNK_PLAIN) return plain_value(stored);
+
+    memset(body, 0, sizeof(DBT));
+
+    body->data = (char *) stored->data + 1;
+    body->size = stored->size - 1;
+
+    return body;
+}
+
+/**
+ * @private Copies values and presence flags of one column of stored chunk (which isn't aligned) into
+ * specified buffers, without unserializing of other columns and keys of the chunk.
+ * Returns number of rows of the chunk, or "-1" if the chunk is malformed.
+ */
+static int read_column (const DBT          * dbt,       /**< [in]  Stored chunk.         */
+                        size_t               column,    /**< [in]  Index of the column.  */
+                        vector <int64_t>   * values,    /**< [out] Values of the column. */
+                        vector <uint8>     * present)   /**< [out] Presence flags.       */
+{
+    chunk_header header;
+
+    if (dbt->size < sizeof(chunk_header)) return -1;
+
+    memcpy(&header, dbt->data, sizeof(chunk_header));
+
+    size_t rows = header.rows;
+
+    if (column >= header.columns || dbt->size < sizeof(chunk_header) + rows * header.columns * (sizeof(int64_t) + 1)) return -1;
+
+    const char * data = (const char *) dbt->data + sizeof(chunk_header);
+
+    values->resize(rows);
+    present->resize(rows);
+
+    if (rows != 0)
+    {
+        memcpy(&(*values)[0],  data + column * rows * sizeof(int64_t), rows * sizeof(int64_t));
+        memcpy(&(*present)[0], data + header.columns * rows * sizeof(int64_t) + column * rows, rows);
+    }
+
+    return (int) rows;
+}
+
+/**
+ * @private Adds selected rows of a column to aggregated values. The loops have no branches but
+ * for minimums and maximums, so the compiler can vectorize them over fixed-width values.
+ */
+static void sum_column (const int64_t   * values,   /**< [in]     Values of the column.            */
+                        const uint8     * present,  /**< [in]     Presence flags of the column.    */
+                        const uint8     * selected, /**< [in]     Whether the rows pass the filter. */
+                        size_t            rows,     /**< [in]     Number of rows.                  */
+                        aggregate_value * result)   /**< [in,out] Aggregated values.               */
+{
+    uint64_t count  = 0;
+    uint64_t found  = 0;
+    int64_t  sum    = 0;
+
+    for (size_t r = 0; r < rows; r++)
+    {
+        uint8 mask = selected[r] & present[r];
+
+        count += selected[r];
+        found += mask;
+        sum   += values[r] & -(int64_t) mask;
+    }
+
+    // values of previous chunks (if any) bound minimum and maximum
+    bool    any = (result->values != 0);
+    int64_t min = result->min;
+    int64_t max = result->max;
+
+    for (size_t r = 0; r < rows; r++)
+    {
+        if ((selected[r] & present[r]) == 0) continue;
+
+        if (!any || values[r] < min) min = values[r];
+        if (!any || values[r] > max) max = values[r];
+
+        any = true;
+    }
+
+    result->min     = min;
+    result->max     = max;
+    result->count  += count;
+    result->values += found;
+    result->sum    += sum;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens column store of specified integer fields of the table.
+ * If the store doesn't exist yet (or is empty), then creates it from all records of the table.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error, or type of a field is not supported.
+ */
+column_store::column_store (table        * tbl,     /**< [in] Master table.                                    */
+                            const char   * name,    /**< [in] Name of the store.                               */
+                            const int    * fields,  /**< [in] Projected fields.                                */
+                            const int    * types,   /**< [in] Types of the fields (see @ref fieldtypes "types"). */
+                            int            count,   /**< [in] Number of the fields.                            */
+                            unsigned int   rows)    /**< [in] Maximum number of rows of a chunk.               */
+  : m_table(tbl),
+    m_name(string(name)),
+    m_db(NULL),
+    m_rows(rows < 2 ? 2 : rows)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::column_store::column_store] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::column_store::column_store] name = " << name << ", count = " << count << ", rows = " << rows);
+
+    try
+    {
+        // types of the fields are checked by the decoders
+        for (int i = 0; i < count; i++)
+        {
+            m_decoders.push_back(NULL);
+            m_decoders.back() = new aggregation(fields[i], types[i]);
+            m_fields.push_back(fields[i]);
+        }
+    }
+    catch (exception &)
+    {
+        for (size_t i = 0; i < m_decoders.size(); i++) delete m_decoders[i];
+        throw;
+    }
+
+    int res = db_create(&m_db, tbl->m_db->get_env(tbl->m_db), 0);
+
+    if (res == 0) m_db->app_private = this;
+
+    if (tbl->m_options.page_size != 0)
+    {
+        if (res == 0) res = m_db->set_pagesize(m_db, tbl->m_options.page_size);
+    }
+
+    if (tbl->m_options.encrypted)
+    {
+        if (res == 0) res = m_db->set_flags(m_db, DB_ENCRYPT);
+    }
+
+    // chunks are keyed by their first primary keys, in order of the table
+    if (tbl->m_callback != NULL)
+    {
+        if (res == 0) res = m_db->set_bt_compare(m_db, tbl->m_callback);
+    }
+
+    if (res == 0)
+    {
+        res = tbl->m_database->open_file(m_db,
+                                         tbl->m_database->get_transaction(),
+                                         get_filename(),
+                                         m_name,
+                                         DB_BTREE,
+                                         DB_THREAD | DB_CREATE | (tbl->m_options.multiversion ? DB_MULTIVERSION : 0));
+    }
+
+    if (res == 0) res = build();
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::column_store::column_store] " << db_strerror(res));
+        if (m_db != NULL) m_db->close(m_db, 0);
+        for (size_t i = 0; i < m_decoders.size(); i++) delete m_decoders[i];
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::column_store::column_store] EXIT");
+}
+
+/**
+ * Closes the store.
+ */
+column_store::~column_store () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::column_store::~column_store] ENTER");
+
+    if (m_db != NULL) m_db->close(m_db, m_table->m_database->m_close_flags);
+
+    for (size_t i = 0; i < m_decoders.size(); i++) delete m_decoders[i];
+
+    LOG4CPLUS_TRACE(logger, "[bdb::column_store::~column_store] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Aggregates projected field of all records (see "bdb::aggregation::total"), reading only its column.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the field is not projected by the store.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK  - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+aggregate_value column_store::aggregate (int           field,   /**< [in] Aggregated field.    */
+                                         transaction * txn)     /**< [in] Transaction to use.  */
+{
+    return aggregate(field, 0, 0, 0, txn);
+}
+
+/**
+ * Aggregates projected field of records, which contain another projected field in range "[low, high]"
+ * ("filter" is "0" - of all records), reading only the two columns.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - a field is not projected by the store.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK  - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+aggregate_value column_store::aggregate (int           field,   /**< [in] Aggregated field.                 */
+                                         int           filter,  /**< [in] Filtering field ("0" - none).     */
+                                         int64_t       low,     /**< [in] Lowest value of filtering field.  */
+                                         int64_t       high,    /**< [in] Highest value of filtering field. */
+                                         transaction * txn)     /**< [in] Transaction to use.               */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::column_store::aggregate] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::column_store::aggregate] field = " << field << ", filter = " << filter << ", low = " << low << ", high = " << high);
+
+    int column = column_of(field);
+    int other  = (filter != 0 ? column_of(filter) : -1);
+
+    if (column < 0 || (filter != 0 && other < 0))
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::column_store::aggregate] Field is not projected by the store.");
+        throw exception(BDB_ERROR_NOT_FOUND);
+    }
+
+    database * db = m_table->m_database;
+
+    aggregate_value result;
+    memset(&result, 0, sizeof(aggregate_value));
+
+    int res = scan(db->get_transaction(txn), db->read_flags(txn), column, other, low, high, &result);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::column_store::aggregate] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::column_store::aggregate] EXIT = " << result.sum);
+
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns index of column of specified field, or "-1" if the field is not projected.
+ */
+int column_store::column_of (int field)     /**< [in] Projected field. */
+{
+    for (size_t i = 0; i < m_fields.size(); i++)
+    {
+        if (m_fields[i] == field) return (int) i;
+    }
+
+    return -1;
+}
+
+/**
+ * Decodes projected fields of specified record.
+ */
+void column_store::make_row (const DBT         * data,      /**< [in]  Primary data.                        */
+                             vector <int64_t>  * values,    /**< [out] Values of the fields.                */
+                             vector <uint8>    * present)   /**< [out] Whether the record contains the fields. */
+{
+    values->assign(m_decoders.size(), 0);
+    present->assign(m_decoders.size(), 0);
+
+    for (size_t c = 0; c < m_decoders.size(); c++)
+    {
+        (*present)[c] = (m_decoders[c]->decode(data, &(*values)[c]) ? 1 : 0);
+    }
+}
+
+/**
+ * Applies change of specified record to the chunk, which contains its primary key.
+ * Returns error code of Berkeley DB.
+ */
+int column_store::apply_change (DB_TXN    * txn,        /**< [in] Transaction to use.                       */
+                                const DBT * key,        /**< [in] Primary key.                              */
+                                const DBT * olddata,    /**< [in] Old primary data ("NULL" for new record). */
+                                const DBT * newdata)    /**< [in] New primary data ("NULL" for removed one). */
+{
+    (void) olddata;
+
+    column_chunk chunk(m_fields.size());
+    string       first;
+    bool         found = false;
+
+    int res = load_chunk(txn, key, &chunk, &first, &found);
+
+    if (res != 0) return res;
+
+    // position of the key in the chunk
+    size_t lo = 0, hi = chunk.keys.size();
+
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+
+        DBT k;
+        memset(&k, 0, sizeof(DBT));
+
+        k.data = (void *) chunk.keys[mid].data();
+        k.size = (u_int32_t) chunk.keys[mid].size();
+
+        if (m_table->compare_keys(&k, key) < 0) lo = mid + 1; else hi = mid;
+    }
+
+    bool same = false;
+
+    if (lo < chunk.keys.size())
+    {
+        DBT k;
+        memset(&k, 0, sizeof(DBT));
+
+        k.data = (void *) chunk.keys[lo].data();
+        k.size = (u_int32_t) chunk.keys[lo].size();
+
+        same = (m_table->compare_keys(&k, key) == 0);
+    }
+
+    if (newdata != NULL)
+    {
+        vector <int64_t> values;
+        vector <uint8>   present;
+
+        make_row(newdata, &values, &present);
+
+        if (same) chunk.assign(lo, values, present);
+        else      chunk.insert(lo, key, values, present);
+    }
+    else if (same)
+    {
+        chunk.erase(lo);
+    }
+    else
+    {
+        return 0;
+    }
+
+    return store_chunk(txn, chunk, first, found);
+}
+
+/**
+ * Reads the chunk, which should contain specified primary key: the last chunk, starting not after the key,
+ * or the first one, if all chunks start after it.
+ * Returns error code of Berkeley DB ("found" is "false", if the store is empty).
+ */
+int column_store::load_chunk (DB_TXN       * txn,       /**< [in]  Transaction to use.             */
+                              const DBT    * key,       /**< [in]  Primary key.                    */
+                              column_chunk * chunk,     /**< [out] Rows of the chunk.              */
+                              string       * first,     /**< [out] Key of the chunk in the store.  */
+                              bool         * found)     /**< [out] Whether the chunk is found.     */
+{
+    u_int32_t rmw = (txn != NULL ? DB_RMW : 0);
+
+    DBC * cursor = NULL;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.flags = DB_DBT_REALLOC;
+    d.flags = DB_DBT_REALLOC;
+
+    k.data = malloc(key->size + 1);
+    k.size = key->size;
+
+    if (k.data == NULL) return ENOMEM;
+
+    memcpy(k.data, key->data, key->size);
+
+    int res = m_db->cursor(m_db, txn, &cursor, 0);
+
+    if (res == 0)
+    {
+        res = cursor->get(cursor, &k, &d, DB_SET_RANGE | rmw);
+
+        if (res == 0 && m_table->compare_keys(&k, key) != 0)
+        {
+            // the chunk starts after the key, so the key belongs to the previous chunk (if any)
+            res = cursor->get(cursor, &k, &d, DB_PREV | rmw);
+            if (res == DB_NOTFOUND) res = cursor->get(cursor, &k, &d, DB_FIRST | rmw);
+        }
+        else if (res == DB_NOTFOUND)
+        {
+            res = cursor->get(cursor, &k, &d, DB_LAST | rmw);
+        }
+    }
+
+    if (res == 0)
+    {
+        first->assign((const char *) k.data, k.size);
+
+        DBT body;
+        if (!chunk->decode(plain_chunk(&d, &body))) res = EINVAL;
+
+        *found = true;
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    free(k.data);
+    free(d.data);
+
+    return res;
+}
+
+/**
+ * Writes changed chunk under its first primary key (removing its previous key, if it has changed),
+ * splitting the chunk in halves, when it has too many rows.
+ * Returns error code of Berkeley DB.
+ */
+int column_store::store_chunk (DB_TXN             * txn,    /**< [in] Transaction to use.                  */
+                               const column_chunk & chunk,  /**< [in] Rows of the chunk.                   */
+                               const string       & first,  /**< [in] Previous key of the chunk.           */
+                               bool                 found)  /**< [in] Whether the chunk has been stored.   */
+{
+    int res = 0;
+
+    if (found && (chunk.keys.empty() || chunk.keys[0] != first))
+    {
+        DBT k;
+        memset(&k, 0, sizeof(DBT));
+
+        k.data = (void *) first.data();
+        k.size = (u_int32_t) first.size();
+
+        res = m_db->del(m_db, txn, &k, 0);
+        if (res == DB_NOTFOUND) res = 0;
+    }
+
+    size_t rows = chunk.keys.size();
+    size_t half = (rows > m_rows ? rows / 2 : rows);
+
+    if (res == 0 && rows != 0)         res = put_chunk(txn, chunk, 0, half);
+    if (res == 0 && half < rows)       res = put_chunk(txn, chunk, half, rows);
+
+    return res;
+}
+
+/**
+ * Writes rows "[from, to)" of the chunk under the first of their primary keys, compressing them
+ * by the codec of values (see "bdb::set_codec"), if it's set.
+ * Returns error code of Berkeley DB.
+ */
+int column_store::put_chunk (DB_TXN             * txn,      /**< [in] Transaction to use.  */
+                             const column_chunk & chunk,    /**< [in] Rows of the chunk.   */
+                             size_t               from,     /**< [in] First row.           */
+                             size_t               to)       /**< [in] Row after the last.  */
+{
+    string raw;
+    chunk.encode(from, to, &raw);
+
+    vector <char> packed(raw.size());
+
+    size_t size = compress_value(raw.data(), raw.size(), &packed[0]);
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.data = (void *) chunk.keys[from].data();
+    k.size = (u_int32_t) chunk.keys[from].size();
+
+    if (size != 0)
+    {
+        d.data = &packed[0];
+        d.size = (u_int32_t) size;
+    }
+    else
+    {
+        raw.insert(raw.begin(), CHUNK_PLAIN);
+
+        d.data = (void *) raw.data();
+        d.size = (u_int32_t) raw.size();
+    }
+
+    return m_db->put(m_db, txn, &k, &d, 0);
+}
+
+/**
+ * Makes chunks of all records of the table, if the store is empty (e.g. it's just created).
+ * Records are read in order of keys, so the chunks are filled one by one.
+ * Returns error code of Berkeley DB.
+ */
+int column_store::build ()
+{
+    DB_TXN * parent = m_table->m_database->get_transaction();
+
+    DBC * cursor = NULL;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.flags = DB_DBT_REALLOC;
+    d.flags = DB_DBT_REALLOC;
+
+    // the store is built only if it's empty
+    int res = m_db->cursor(m_db, parent, &cursor, 0);
+
+    if (res == 0) res = cursor->get(cursor, &k, &d, DB_FIRST);
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0 || res == DB_NOTFOUND) res = (err != 0 ? err : res);
+        cursor = NULL;
+    }
+
+    if (res != DB_NOTFOUND)
+    {
+        free(k.data);
+        free(d.data);
+        return res;
+    }
+
+    // the chunks are written in one transaction (if the table is transactional)
+    DB_TXN * txn = parent;
+    DB_TXN * own = NULL;
+
+    res = m_table->m_database->begin_auto(&txn, &own);
+
+    if (res == 0) res = m_table->m_db->cursor(m_table->m_db, txn, &cursor, m_table->m_database->read_flags());
+
+    column_chunk     chunk(m_fields.size());
+    vector <int64_t> values;
+    vector <uint8>   present;
+
+    while (res == 0 && (res = cursor->get(cursor, &k, &d, DB_NEXT)) == 0)
+    {
+        make_row(plain_value(&d), &values, &present);
+        chunk.insert(chunk.keys.size(), &k, values, present);
+
+        if (chunk.keys.size() < m_rows) continue;
+
+        res = put_chunk(txn, chunk, 0, chunk.keys.size());
+        chunk.clear();
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (res == 0 && !chunk.keys.empty()) res = put_chunk(txn, chunk, 0, chunk.keys.size());
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    free(k.data);
+    free(d.data);
+
+    return m_table->m_database->end_auto(own, res);
+}
+
+/**
+ * Aggregates specified column of all chunks, selecting rows by another column ("filter" is "-1" - all rows).
+ * Returns error code of Berkeley DB.
+ */
+int column_store::scan (DB_TXN          * txn,      /**< [in]  Transaction to use.                 */
+                        u_int32_t         flags,    /**< [in]  Flags of the cursor.                */
+                        int               column,   /**< [in]  Index of aggregated column.         */
+                        int               filter,   /**< [in]  Index of filtering column ("-1" - none). */
+                        int64_t           low,      /**< [in]  Lowest value of filtering column.   */
+                        int64_t           high,     /**< [in]  Highest value of filtering column.  */
+                        aggregate_value * result)   /**< [out] Aggregated values.                  */
+{
+    DBC * cursor = NULL;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.flags = DB_DBT_REALLOC;
+    d.flags = DB_DBT_REALLOC;
+
+    vector <int64_t> values, fvalues;
+    vector <uint8>   present, fpresent, selected;
+
+    int res = m_db->cursor(m_db, txn, &cursor, flags);
+
+    while (res == 0 && (res = cursor->get(cursor, &k, &d, DB_NEXT)) == 0)
+    {
+        DBT body;
+        const DBT * chunk = plain_chunk(&d, &body);
+
+        int rows = read_column(chunk, column, &values, &present);
+
+        if (rows >= 0 && filter >= 0 && read_column(chunk, filter, &fvalues, &fpresent) != rows) rows = -1;
+
+        if (rows < 0)
+        {
+            res = EINVAL;
+            break;
+        }
+
+        if (rows == 0) continue;
+
+        selected.resize(rows);
+
+        if (filter < 0)
+        {
+            memset(&selected[0], 1, rows);
+        }
+        else
+        {
+            const int64_t * v = &fvalues[0];
+            const uint8   * p = &fpresent[0];
+
+            for (int r = 0; r < rows; r++)
+            {
+                selected[r] = (uint8) (p[r] & (v[r] >= low) & (v[r] <= high));
+            }
+        }
+
+        sum_column(&values[0], &present[0], &selected[0], rows, result);
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    free(k.data);
+    free(d.data);
+
+    return res;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
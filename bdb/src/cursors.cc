@@ -0,0 +1,364 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/cursors.cc
+ * Contains implementation of class "bdb::cursor_pool", and of cursors of recordsets of class "bdb::database".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Boost C++ Libraries
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::cursor_pool".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::vector;
+
+using boost::thread_specific_ptr;
+
+/** @private Cache of closed cursors of one thread. */
+class cursor_slot
+{
+public:
+
+    cursor_slot () : buffer(NULL), size(0) { }
+
+    boost::mutex    mutex;      /**< Guards all the fields below (other threads take it only to clear the cache). */
+    vector <DBC *>  cursors;    /**< Closed cursors of transactions of the thread.      */
+    void          * buffer;     /**< Buffer of the last closed recordset key ("NULL" if none). */
+    size_t          size;       /**< Size of the buffer.                                */
+
+    /** Closes all cached cursors of specified transaction (of any one, if "NULL"). */
+    void close (DB_TXN * txn)
+    {
+        for (size_t i = cursors.size(); i > 0; i--)
+        {
+            DBC * cursor = cursors[i - 1];
+
+            if (txn == NULL || cursor->txn == txn)
+            {
+                cursors[i - 1] = cursors.back();
+                cursors.pop_back();
+                cursor->close(cursor);
+            }
+        }
+    }
+};
+
+/**
+ * @private Cleanup function for thread-specific pointer.
+ * Does nothing, since all slots are owned by the registry below.
+ */
+static void cursor_slot_cleanup (cursor_slot *)
+{ }
+
+/** @private Registry of per-thread caches of cursors, so all of them are closed when database is closed. */
+class cursor_state
+{
+public:
+
+    cursor_state (unsigned int limit) : local(cursor_slot_cleanup), size(limit) { }
+
+    boost::mutex                        mutex;  /**< Guards list of all slots.                  */
+    thread_specific_ptr <cursor_slot>   local;  /**< Cache of current thread.                   */
+    vector <cursor_slot *>              all;    /**< Caches of all threads.                     */
+    unsigned int                        size;   /**< Maximum number of cached cursors of a thread. */
+
+    /**
+     * Returns cache of the current thread, creating it if required.
+     */
+    cursor_slot * get ()
+    {
+        cursor_slot * slot = local.get();
+
+        if (slot == NULL)
+        {
+            slot = new cursor_slot;
+            assert(slot != NULL);
+
+            boost::mutex::scoped_lock lock(mutex);
+            all.push_back(slot);
+            local.reset(slot);
+        }
+
+        return slot;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Creates empty caches, each of specified number of cursors at most.
+ */
+cursor_pool::cursor_pool (unsigned int size)    /**< [in] Maximum number of cached cursors of a thread. */
+{
+    m_state = new cursor_state(size);
+    assert(m_state != NULL);
+}
+
+/**
+ * Closes all cached cursors of all threads.
+ */
+cursor_pool::~cursor_pool () throw ()
+{
+    clear();
+
+    for (size_t i = 0; i < m_state->all.size(); i++)
+    {
+        delete m_state->all[i];
+    }
+
+    m_state->local.release();
+    delete m_state;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Takes cached cursor of specified handle and transaction, or opens a new one, if there is none.
+ * Returns error code of Berkeley DB.
+ */
+int cursor_pool::open (DB        * db,      /**< [in]  Berkeley DB handle.      */
+                       DB_TXN    * txn,     /**< [in]  Transaction of the cursor. */
+                       u_int32_t   flags,   /**< [in]  Flags of new cursor.     */
+                       DBC      ** cursor)  /**< [out] The cursor.              */
+{
+    cursor_slot * slot = m_state->get();
+
+    {
+        boost::mutex::scoped_lock lock(slot->mutex);
+
+        for (size_t i = slot->cursors.size(); i > 0; i--)
+        {
+            DBC * cached = slot->cursors[i - 1];
+
+            if (cached->dbp == db && cached->txn == txn)
+            {
+                slot->cursors[i - 1] = slot->cursors.back();
+                slot->cursors.pop_back();
+
+                *cursor = cached;
+                return 0;
+            }
+        }
+    }
+
+    return db->cursor(db, txn, cursor, flags);
+}
+
+/**
+ * Puts specified cursor into cache of the current thread, or closes it, if the cache is full.
+ */
+void cursor_pool::put (DBC * cursor)    /**< [in] Cursor, which is not needed anymore. */
+{
+    cursor_slot * slot = m_state->get();
+
+    {
+        boost::mutex::scoped_lock lock(slot->mutex);
+
+        if (slot->cursors.size() < m_state->size)
+        {
+            slot->cursors.push_back(cursor);
+            return;
+        }
+    }
+
+    cursor->close(cursor);
+}
+
+/**
+ * Closes cached cursors of specified transaction of the current thread, before the transaction is resolved.
+ */
+void cursor_pool::release (DB_TXN * txn)    /**< [in] Transaction to be resolved. */
+{
+    cursor_slot * slot = m_state->local.get();
+
+    if (slot != NULL)
+    {
+        boost::mutex::scoped_lock lock(slot->mutex);
+        slot->close(txn);
+    }
+}
+
+/**
+ * Closes cached cursors of all threads (e.g. before their handles are closed), and frees their buffers.
+ */
+void cursor_pool::clear ()
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    for (size_t i = 0; i < m_state->all.size(); i++)
+    {
+        cursor_slot * slot = m_state->all[i];
+
+        boost::mutex::scoped_lock guard(slot->mutex);
+
+        slot->close(NULL);
+
+        free(slot->buffer);
+        slot->buffer = NULL;
+        slot->size   = 0;
+    }
+}
+
+/**
+ * Takes buffer of the last closed recordset key of the current thread.
+ * Returns "NULL" if there is none; otherwise the caller owns the buffer (allocated by "malloc").
+ */
+void * cursor_pool::take_buffer (size_t * size)     /**< [out] Size of the buffer. */
+{
+    cursor_slot * slot = m_state->get();
+
+    boost::mutex::scoped_lock lock(slot->mutex);
+
+    void * buffer = slot->buffer;
+    *size = slot->size;
+
+    slot->buffer = NULL;
+    slot->size   = 0;
+
+    return buffer;
+}
+
+/**
+ * Puts buffer of closed recordset key into cache of the current thread (the larger buffer is kept).
+ */
+void cursor_pool::give_buffer (void   * buffer,     /**< [in] Buffer, allocated by "malloc". */
+                               size_t   size)       /**< [in] Size of the buffer.            */
+{
+    cursor_slot * slot = m_state->get();
+
+    boost::mutex::scoped_lock lock(slot->mutex);
+
+    if (size > slot->size)
+    {
+        free(slot->buffer);
+        slot->buffer = buffer;
+        slot->size   = size;
+    }
+    else
+    {
+        free(buffer);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Cursors of recordsets of class "bdb::database".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens cursor of specified handle for a recordset. Cursors of the current transaction of the thread
+ * are taken from the cache of the thread, if it's enabled (see "bdb::database_options::cursor_cache").
+ * Returns error code of Berkeley DB.
+ */
+int database::open_cursor (DB          * db,        /**< [in]  Berkeley DB handle.                         */
+                           transaction * txn,       /**< [in]  Transaction to use (current one, if "NULL"). */
+                           DBC        ** cursor)    /**< [out] The cursor.                                 */
+{
+    DB_TXN * local = (txn == NULL && m_cursors != NULL ? local_transaction() : NULL);
+
+    if (local != NULL)
+    {
+        return m_cursors->open(db, local, read_flags(), cursor);
+    }
+
+    return db->cursor(db, get_transaction(txn), cursor, read_flags(txn));
+}
+
+/**
+ * Closes cursor of a recordset, or puts it into the cache of the thread, if the cursor belongs to
+ * the current transaction of the thread (so it's closed before the transaction is resolved).
+ */
+void database::close_cursor (DBC * cursor)  /**< [in] Cursor, opened by "bdb::database::open_cursor". */
+{
+    if (m_cursors != NULL && cursor->txn != NULL && cursor->txn == local_transaction())
+    {
+        // priority of scan-resistant recordset is not passed to the next one
+        cursor->set_priority(cursor, DB_PRIORITY_UNCHANGED);
+        m_cursors->put(cursor);
+    }
+    else
+    {
+        cursor->close(cursor);
+    }
+}
+
+/**
+ * Takes recycled buffer of recordset key of the thread ("NULL" if there is none, or the cache is disabled).
+ */
+void * database::take_buffer (size_t * size)    /**< [out] Size of the buffer. */
+{
+    *size = 0;
+
+    return (m_cursors != NULL ? m_cursors->take_buffer(size) : NULL);
+}
+
+/**
+ * Keeps memory of specified recordset key for the next recordset of the thread.
+ * Returns "false" if the cache is disabled (and the key should be released as usual).
+ */
+bool database::give_buffer (DBT * dbt)  /**< [in/out] Key of closed recordset; its memory is taken. */
+{
+    if (m_cursors == NULL || dbt->data == NULL)
+    {
+        return false;
+    }
+
+    m_cursors->give_buffer(dbt->data, dbt->ulen);
+    memset(dbt, 0, sizeof(DBT));
+
+    return true;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -30,15 +30,29 @@
 #include <bdb.h>
 
 // Standard C/C++ Libraries
+#include <algorithm>
+#include <cassert>
 #include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <stack>
 #include <string>
 #include <vector>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <signal.h>
+#endif
+
 // Boost C++ Libraries
-#include <boost/interprocess/sync/interprocess_mutex.hpp>
-#include <boost/interprocess/sync/scoped_lock.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/thread/tss.hpp>
 
 // Berkeley DB
 #include <db.h>
@@ -48,6 +62,17 @@
 #error Berkeley DB 4.7 or later is required.
 #endif
 
+// Sites of replication manager and commit tokens are available since Berkeley DB 5.2
+#if (DB_VERSION_MAJOR > 5) || (DB_VERSION_MAJOR == 5) && (DB_VERSION_MINOR >= 2)
+#define BDB_REPMGR_SITE
+#define BDB_TXN_TOKEN
+#endif
+
+// Hot backups of environments are available since Berkeley DB 5.3
+#if (DB_VERSION_MAJOR > 5) || (DB_VERSION_MAJOR == 5) && (DB_VERSION_MINOR >= 3)
+#define BDB_ENV_BACKUP
+#endif
+
 // C++ Logging Library
 #include <log4cplus/logger.h>
 
@@ -62,285 +87,2437 @@ using std::stack;
 using std::string;
 using std::vector;
 
-using boost::interprocess::interprocess_mutex;
-using boost::interprocess::scoped_lock;
+using boost::thread_specific_ptr;
+using boost::get_system_time;
+using boost::system_time;
+using boost::posix_time::microseconds;
+
+/** @private Number of threads of all processes of shared environment, tracked unless specified explicitly. */
+static const u_int32_t MULTI_PROCESS_THREADS = 256;
+
+/** @private Size of log buffer of in-memory database, which keeps the whole log, unless specified explicitly (in bytes). */
+static const u_int32_t MEMORY_LOG_BUFFER = 10 * 1024 * 1024;
+
+/** @private Part of memory budget, taken by the cache of the environment by default (in percents). */
+static const unsigned int BUDGET_MPOOL_PERCENT = 50;
+
+/** @private Size of cache, which Berkeley DB increases by a quarter for its overhead (below this size, in bytes). */
+static const uint64_t SMALL_CACHE_BYTES = 500 * 1024 * 1024;
+
+/** @private Number of bytes in gigabyte. */
+static const uint64_t GIGABYTE = 1024 * 1024 * 1024;
 
 //--------------------------------------------------------------------------------------------------
-//  Constructors/destructors.
+//  Per-thread stacks of nested transactions.
 //--------------------------------------------------------------------------------------------------
 
 /**
- * Opens the database.
- * If "create" is "true" and database doesn't exist, then creates it.
- *
- * @throw bdb::exception BDB_ERROR_NOT_FOUND - the database home is not found, or the database doesn't exist.
- * @throw bdb::exception BDB_ERROR_EXISTS    - the database already exists (cannot be created).
- * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ * @private Stack of active nested transactions. Savepoints, which have no changes yet, are kept as "NULL"
+ * (see "bdb::database::set_savepoint"), and become nested transactions on first use.
  */
-database::database (const char * home,      /**< [in] Home path of the database.                          */
-                    bool         create)    /**< [in] Whether to create the database if it doesn't exist. */
-  : m_home(string(home)),
-    m_env(NULL),
-    m_seq(NULL)
+class txn_stack : public stack <DB_TXN*>
 {
-    LOG4CPLUS_TRACE(logger, "[bdb::database::database] ENTER");
-    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] home = " << home);
-    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] create = " << create);
+public:
 
-    // database flags
-    u_int32_t flags = DB_THREAD         // multi-threaded access
-                    | DB_INIT_LOCK      // locking for concurrent applications
-                    | DB_INIT_LOG       // recoverability
-                    | DB_INIT_MPOOL     // in-memory cache
-                    | DB_INIT_TXN;      // transaction subsystem
+    /** Returns the innermost begun transaction ("NULL" if none), skipping pending savepoints. */
+    DB_TXN * parent () const
+    {
+        for (size_t i = c.size(); i > 0; i--)
+        {
+            if (c[i - 1] != NULL) return c[i - 1];
+        }
 
-    if (create) flags |= DB_CREATE;
+        return NULL;
+    }
+};
 
-    // open/create the environment
-    int res = db_env_create(&m_env, 0);
+/**
+ * @private Cleanup function for thread-specific pointer.
+ * Does nothing, since all stacks are owned by the registry below.
+ */
+static void txn_stack_cleanup (txn_stack *)
+{ }
 
-    if (res == 0) res = m_env->set_alloc(m_env, malloc, realloc, free);
-    if (res == 0) res = m_env->open(m_env, m_home.c_str(), flags, 0);
+/**
+ * @private Registry of per-thread stacks of active nested transactions.
+ * Each thread has its own stack, so independent threads don't interfere with each other's
+ * transactions. All stacks are kept in the registry to be rolled back when database is closed.
+ */
+class txn_stacks
+{
+public:
 
-    // create top-level transaction
-    DB_TXN * txn = NULL;
-    if (res == 0) res = m_env->txn_begin(m_env, NULL, &txn, DB_READ_COMMITTED | DB_TXN_SYNC);
-    if (res == 0) m_txns.push(txn);
+    txn_stacks () : local(txn_stack_cleanup) { }
 
-    // open/create the sequences database
-    flags = DB_THREAD;
+    boost::mutex                        mutex;  /**< Guards list of all stacks.          */
+    thread_specific_ptr <txn_stack>     local;  /**< Stack of current thread.            */
+    vector <txn_stack*>                 all;    /**< Stacks of all threads.              */
 
-    if (create) flags |= DB_CREATE | DB_EXCL;
+    /**
+     * Returns stack of the current thread, creating it if required.
+     */
+    txn_stack * get ()
+    {
+        txn_stack * txns = local.get();
 
-    if (res == 0) res = db_create(&m_seq, m_env, 0);
-    if (res == 0) res = m_seq->open(m_seq, txn, "__seq.db", "__seq", DB_BTREE, flags, 0);
+        if (txns == NULL)
+        {
+            txns = new txn_stack;
+            assert(txns != NULL);
 
-    // handle error, if any
-    if (res != 0)
+            boost::mutex::scoped_lock lock(mutex);
+            all.push_back(txns);
+            local.reset(txns);
+        }
+
+        return txns;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Group commit.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * @private Coordinator of group commits.
+ * Committed transactions are written to the log without flushing, and the committers are gathered
+ * into batches. The first committer of a batch becomes a leader, waits for others during the window
+ * (or until the batch is full), and then flushes the log once for the whole batch.
+ */
+class group_commit
+{
+public:
+
+    group_commit () : window(0), size(0), pending(0), batch(0), flushed(0), leader(false), status(0) { }
+
+    boost::mutex                mutex;      /**< Guards all the fields below.                     */
+    boost::condition_variable   cond;       /**< Signals of joined committers and flushed batches. */
+    unsigned int                window;     /**< Maximum time leader waits for others (in usec).  */
+    unsigned int                size;       /**< Batch size to flush immediately ("0" - no limit). */
+    unsigned int                pending;    /**< Number of committers in the open batch.          */
+    unsigned long               batch;      /**< Number of the open batch.                        */
+    unsigned long               flushed;    /**< Number of batches which are already flushed.     */
+    bool                        leader;     /**< Whether the open batch has a leader.             */
+    int                         status;     /**< Result of the last flush.                        */
+
+    /**
+     * Waits until the log is flushed with records of the calling committer.
+     */
+    int flush (DB_ENV * env)
     {
-        LOG4CPLUS_WARN(logger, "[bdb::database::database] " << db_strerror(res));
+        boost::mutex::scoped_lock lock(mutex);
 
-        if (m_seq != NULL) m_seq->close(m_seq, 0);
-        if (txn   != NULL) txn->abort(txn);
-        if (m_env != NULL) m_env->close(m_env, 0);
+        unsigned long mine = batch;
+        pending++;
 
-        switch (res)
+        if (leader)
         {
-            case ENOENT:    throw exception(BDB_ERROR_NOT_FOUND);
-            case EEXIST:    throw exception(BDB_ERROR_EXISTS);
-            default:        throw exception(BDB_ERROR_UNKNOWN);
+            cond.notify_all();
+
+            while (flushed <= mine)
+            {
+                cond.wait(lock);
+            }
+
+            return status;
+        }
+
+        leader = true;
+
+        system_time deadline = get_system_time() + microseconds(window);
+
+        while (window != 0 && (size == 0 || pending < size))
+        {
+            if (!cond.timed_wait(lock, deadline)) break;
         }
+
+        batch++;
+        pending = 0;
+        leader  = false;
+
+        lock.unlock();
+        int res = env->log_flush(env, NULL);
+        lock.lock();
+
+        status = res;
+        if (flushed < mine + 1) flushed = mine + 1;
+        cond.notify_all();
+
+        return res;
     }
+};
 
-    LOG4CPLUS_TRACE(logger, "[bdb::database::database] EXIT");
-}
+//--------------------------------------------------------------------------------------------------
+//  Background maintenance.
+//--------------------------------------------------------------------------------------------------
+
+/** @private Period of checks of checkpoint thresholds (and of dead processes) by maintenance thread, in seconds. */
+static const unsigned int MAINTENANCE_PERIOD = 1;
 
 /**
- * Closes the database and all associated sequences, tables, and indexes.
- * Any active transactions will be rolled back.
+ * @private Background thread, which checkpoints the environment when enough log is written or enough
+ * time is passed since the last checkpoint, and removes log files, which are no longer needed for recovery.
+ * Checkpoints flush the cache by small portions in the background, so writers are not stalled, and recovery
+ * after a crash replays the log since the last checkpoint only.
+ * In environment, shared by several processes, the thread also releases locks and aborts transactions
+ * of the processes, which have died ("DB_ENV->failchk").
  */
-database::~database () throw ()
+class maintenance
 {
-    LOG4CPLUS_TRACE(logger, "[bdb::database::~database] ENTER");
+public:
+
+    maintenance (DB_ENV * environment, const database_options & options, bool shared)
+      : env(environment),
+        minutes(options.checkpoint_minutes),
+        kbytes(options.checkpoint_kbytes),
+        remove(options.remove_logs),
+        failchk(shared),
+        stop(false),
+        thread(boost::bind(&maintenance::run, this))
+    {
+    }
+
+    ~maintenance ()
+    {
+        {
+            boost::mutex::scoped_lock lock(mutex);
+            stop = true;
+            cond.notify_all();
+        }
 
-    // lock stack of active transactions
-    interprocess_mutex mutex;
-    scoped_lock <interprocess_mutex> lock(mutex);
+        thread.join();
+    }
 
-    // rollback non-completed transactions (besides top-level one)
-    while (m_txns.size() != 1)
+    DB_ENV                    * env;        /**< Maintained environment.                              */
+    unsigned int                minutes;    /**< Checkpoint interval, in minutes ("0" - no interval). */
+    unsigned int                kbytes;     /**< Written log to checkpoint, in kilobytes ("0" - any). */
+    bool                        remove;     /**< Whether to remove unneeded log files.                */
+    bool                        failchk;    /**< Whether to check for dead processes.                 */
+    boost::mutex                mutex;      /**< Guards "stop" flag.                                   */
+    boost::condition_variable   cond;       /**< Signals stop of the thread.                           */
+    bool                        stop;       /**< Whether the thread should stop.                       */
+    boost::thread               thread;     /**< Maintenance thread (started the last).                */
+
+    /**
+     * Body of maintenance thread.
+     */
+    void run ()
     {
-        DB_TXN * txn = m_txns.top();
-        m_txns.pop();
-        txn->abort(txn);
+        boost::mutex::scoped_lock lock(mutex);
+
+        while (!stop)
+        {
+            system_time deadline = get_system_time() + boost::posix_time::seconds(MAINTENANCE_PERIOD);
+
+            while (!stop && cond.timed_wait(lock, deadline)) { }
+
+            if (stop) break;
+
+            lock.unlock();
+
+            int res = 0;
+
+            // Berkeley DB checkpoints only when either threshold is reached
+            if (minutes != 0 || kbytes != 0) res = env->txn_checkpoint(env, kbytes, minutes, 0);
+
+            if (res == 0 && remove) res = env->log_archive(env, NULL, DB_ARCH_REMOVE);
+            if (res == 0 && failchk) res = env->failchk(env, 0);
+
+            if (res != 0)
+            {
+                LOG4CPLUS_WARN(logger, "[bdb::database::maintenance] " << db_strerror(res));
+            }
+
+            lock.lock();
+        }
     }
+};
 
-    // close all associated sequences
-    for (unsigned int i = 0; i < m_sequences.size(); i++)
+/** @private The shortest period of background writer of dirty pages, in milliseconds. */
+static const unsigned int TRICKLE_MIN_PERIOD = 10;
+
+/** @private The longest period of background writer of dirty pages, in milliseconds. */
+static const unsigned int TRICKLE_MAX_PERIOD = 1000;
+
+/**
+ * @private Background thread, which writes dirty pages of the cache, until the target percentage of its pages
+ * is clean ("DB_ENV->memp_trickle"), so pages, evicted by readers, are rarely to be written synchronously, and
+ * checkpoints have less pages to flush at once. The period adapts to write load: it is halved each time some
+ * pages have been written, and doubled each time there have been none to write.
+ */
+class trickle_writer
+{
+public:
+
+    trickle_writer (DB_ENV * environment, unsigned int target)
+      : env(environment),
+        percent(target),
+        period(TRICKLE_MAX_PERIOD),
+        stop(false),
+        thread(boost::bind(&trickle_writer::run, this))
     {
-        delete m_sequences[i];
     }
 
-    // close all associated tables
-    for (unsigned int i = 0; i < m_tables.size(); i++)
+    ~trickle_writer ()
     {
-        delete m_tables[i];
+        {
+            boost::mutex::scoped_lock lock(mutex);
+            stop = true;
+            cond.notify_all();
+        }
+
+        thread.join();
     }
 
-    DB_TXN * txn = m_txns.top();
+    DB_ENV                    * env;        /**< Environment of the cache.                            */
+    unsigned int                percent;    /**< Target percentage of clean pages.                    */
+    unsigned int                period;     /**< Current period, in milliseconds.                     */
+    boost::mutex                mutex;      /**< Guards "stop" flag.                                   */
+    boost::condition_variable   cond;       /**< Signals stop of the thread.                           */
+    bool                        stop;       /**< Whether the thread should stop.                       */
+    boost::thread               thread;     /**< Writing thread (started the last).                    */
+
+    /**
+     * Body of writing thread.
+     */
+    void run ()
+    {
+        boost::mutex::scoped_lock lock(mutex);
 
-    if (m_seq != NULL) m_seq->close(m_seq, 0);
-    txn->commit(txn, DB_TXN_SYNC);
-    if (m_env != NULL) m_env->close(m_env, 0);
+        while (!stop)
+        {
+            system_time deadline = get_system_time() + boost::posix_time::milliseconds(period);
 
-    LOG4CPLUS_TRACE(logger, "[bdb::database::~database] EXIT");
-}
+            while (!stop && cond.timed_wait(lock, deadline)) { }
+
+            if (stop) break;
+
+            lock.unlock();
+
+            int nwrote = 0;
+            int res = env->memp_trickle(env, percent, &nwrote);
+
+            if (res != 0)
+            {
+                LOG4CPLUS_WARN(logger, "[bdb::database::trickle_writer] " << db_strerror(res));
+            }
+
+            if (nwrote > 0)
+            {
+                period = std::max(period / 2, TRICKLE_MIN_PERIOD);
+            }
+            else
+            {
+                period = std::min(period * 2, TRICKLE_MAX_PERIOD);
+            }
+
+            lock.lock();
+        }
+    }
+};
 
 //--------------------------------------------------------------------------------------------------
-//  Public interface.
+//  Warming of the cache.
 //--------------------------------------------------------------------------------------------------
 
+/** @private Name of the database with snapshot of the cache. */
+static const char * CACHE_SNAPSHOT = "__cache.db";
+
 /**
- * Adds specified sequence to the database and opens the sequence.
- * If "create" is "true" and sequence doesn't exist, then creates it.
- *
- * @throw bdb::exception BDB_ERROR_NOT_FOUND - the sequence is not found.
- * @throw bdb::exception BDB_ERROR_EXISTS    - the sequence already exists (cannot be created).
- * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ * @private Shared state of the threads, which prefetch pages of hot files into the cache.
+ * Files are taken in order of their heat, and each file is read sequentially from its first page,
+ * until the file ends or the cache budget is exhausted.
  */
-sequence * database::add_sequence (const char * name,       /**< [in] Name of the sequence.                               */
-                                   bool         create)     /**< [in] Whether to create the sequence if it doesn't exist. */
+class cache_warmup
 {
-    LOG4CPLUS_TRACE(logger, "[bdb::database::add_sequence] ENTER");
-    LOG4CPLUS_DEBUG(logger, "[bdb::database::add_sequence] name = " << name);
-    LOG4CPLUS_DEBUG(logger, "[bdb::database::add_sequence] create = " << create);
+public:
 
-    sequence * s = NULL;
+    cache_warmup (uint64_t bytes) : budget(bytes), next(0), pages(0) { }
 
-    try
+    boost::mutex                mutex;      /**< Guards all the fields below.          */
+    vector <DB*>                files;      /**< Databases of hot files, hottest first. */
+    uint64_t                    budget;     /**< Remaining size of the cache, in bytes. */
+    size_t                      next;       /**< Index of the next file to prefetch.   */
+    unsigned int                pages;      /**< Number of prefetched pages.            */
+
+    /**
+     * Body of prefetching task.
+     */
+    static void run (void * param)
     {
-        s = new sequence(this, name, create);
-        assert(s != NULL);
-        m_sequences.push_back(s);
+        static_cast <cache_warmup *> (param)->prefetch();
     }
-    catch (...)
+
+    /**
+     * Prefetches the next files, until all of them are prefetched, or the cache is full.
+     */
+    void prefetch ()
     {
-        throw;
-    }
+        for (;;)
+        {
+            DB * db = NULL;
 
-    LOG4CPLUS_TRACE(logger, "[bdb::database::add_sequence] EXIT");
+            {
+                boost::mutex::scoped_lock lock(mutex);
+                if (next == files.size() || budget == 0) return;
+                db = files[next++];
+            }
 
-    return s;
-}
+            u_int32_t pagesize = 0;
+            db->get_pagesize(db, &pagesize);
+
+            DB_MPOOLFILE * mpf = db->get_mpf(db);
+
+            for (db_pgno_t pgno = 0; ; pgno++)
+            {
+                {
+                    boost::mutex::scoped_lock lock(mutex);
+                    if (budget < pagesize) { budget = 0; return; }
+                    budget -= pagesize;
+                }
+
+                void * page = NULL;
+                int res = mpf->get(mpf, &pgno, NULL, 0, &page);
+
+                if (res == DB_PAGE_NOTFOUND) break;
+
+                if (res != 0)
+                {
+                    LOG4CPLUS_WARN(logger, "[bdb::database::warm_cache] " << db_strerror(res));
+                    break;
+                }
+
+                mpf->put(mpf, page, DB_PRIORITY_UNCHANGED, 0);
+
+                boost::mutex::scoped_lock lock(mutex);
+                pages++;
+            }
+        }
+    }
+};
 
 /**
- * Adds specified table to the database and opens the table.
- * If "create" is "true" and table doesn't exist, then creates it.
- *
- * @throw bdb::exception BDB_ERROR_NOT_FOUND - the table is not found.
- * @throw bdb::exception BDB_ERROR_EXISTS    - the table already exists (cannot be created).
- * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ * @private Shared state of the threads, which open tables by their specifications (see "bdb::database::add_tables").
  */
-table * database::add_table (const char       * name,       /**< [in] Name of the table.                                      */
-                             compare_callback   fn_cmp,     /**< [in] Keys comparision function (see "Db::set_bt_compare()"). */
-                             bool               create)     /**< [in] Whether to create the table if it doesn't exist.        */
+class table_opener
 {
-    LOG4CPLUS_TRACE(logger, "[bdb::database::add_table] ENTER");
-    LOG4CPLUS_DEBUG(logger, "[bdb::database::add_table] name = " << name);
-    LOG4CPLUS_DEBUG(logger, "[bdb::database::add_table] create = " << create);
+public:
 
-    table * t = NULL;
+    table_opener (database * d, const vector <table_spec> & s) : db(d), specs(s), tables(s.size(), (table *) NULL), next(0), error(0) { }
 
-    try
+    database                    * db;       /**< Database of the tables.                        */
+    const vector <table_spec>   & specs;    /**< Specifications of the tables.                  */
+    vector <table*>               tables;   /**< Opened tables by their specifications ("NULL" - not opened). */
+    boost::mutex                  mutex;    /**< Guards the fields below.                       */
+    size_t                        next;     /**< Index of the next specification.               */
+    int                           error;    /**< The first error ("0" - none, or one of "BDB_ERROR_*"). */
+
+    /**
+     * Body of opening task.
+     */
+    static void run (void * param)
     {
-        t = new table(this, name, fn_cmp, create);
-        assert(t != NULL);
-        m_tables.push_back(t);
+        static_cast <table_opener *> (param)->open();
     }
-    catch (...)
+
+    /**
+     * Opens the next tables, until all of them are opened, or any of them fails.
+     */
+    void open ()
     {
-        throw;
+        for (;;)
+        {
+            size_t i;
+
+            {
+                boost::mutex::scoped_lock lock(mutex);
+                if (next == specs.size() || error != 0) return;
+                i = next++;
+            }
+
+            int res = 0;
+
+            try
+            {
+                tables[i] = open_table(specs[i]);
+            }
+            catch (exception & e)
+            {
+                res = e.error();
+            }
+            catch (...)
+            {
+                res = BDB_ERROR_UNKNOWN;
+            }
+
+            if (res != 0)
+            {
+                boost::mutex::scoped_lock lock(mutex);
+                if (error == 0) error = res;
+            }
+        }
     }
 
-    LOG4CPLUS_TRACE(logger, "[bdb::database::add_table] EXIT");
+    /**
+     * Opens the table with its indexes in its own transaction of the thread (nested one of top-level transaction,
+     * if there is one), so tables are opened by several threads at once.
+     */
+    table * open_table (const table_spec & spec)
+    {
+        bool own = !db->m_concurrent;
 
-    return t;
-}
+        if (own) db->begin_transaction();
 
-/**
- * Begins new transaction.
- *
- * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
- */
-void database::begin_transaction ()
-{
-    LOG4CPLUS_TRACE(logger, "[bdb::database::begin_transaction] ENTER");
+        table * tbl = NULL;
 
-    interprocess_mutex mutex;
-    scoped_lock <interprocess_mutex> lock(mutex);
+        try
+        {
+            tbl = new table(db, spec.name, spec.fn_cmp, spec.create, spec.options);
+            assert(tbl != NULL);
+
+            for (size_t i = 0; i < spec.indexes.size(); i++)
+            {
+                const index_spec & idx = spec.indexes[i];
+                tbl->add_index(idx.name, idx.fn_idx, idx.fn_cmp, idx.unique, idx.immutable);
+            }
+        }
+        catch (...)
+        {
+            delete tbl;
+            if (own) db->rollback_transaction();
+            throw;
+        }
 
-    DB_TXN * txn = NULL;
+        try
+        {
+            if (own) db->commit_transaction();
+        }
+        catch (...)
+        {
+            delete tbl;
+            throw;
+        }
 
-    int res = m_env->txn_begin(m_env, m_txns.top(), &txn, DB_READ_COMMITTED | DB_TXN_SYNC);
+        return tbl;
+    }
+};
 
-    if (res == 0)
+/**
+ * @private Writes all dirty pages of the cache on fast shutdown (see "bdb::database_options::fast_shutdown").
+ */
+static void trickle_cache (DB_ENV * env)    /**< [in] Environment of the database. */
+{
+    int nwrote = 0;
+    int res = env->memp_trickle(env, 100, &nwrote);
+
+    if (res != 0)
     {
-        m_txns.push(txn);
+        LOG4CPLUS_WARN(logger, "[bdb::trickle_cache] " << db_strerror(res));
     }
     else
     {
-        LOG4CPLUS_WARN(logger, "[bdb::database::begin_transaction] " << db_strerror(res));
-        if (txn != NULL) txn->abort(txn);
-        throw exception(BDB_ERROR_UNKNOWN);
+        LOG4CPLUS_DEBUG(logger, "[bdb::trickle_cache] pages = " << nwrote);
     }
-
-    LOG4CPLUS_TRACE(logger, "[bdb::database::begin_transaction] EXIT");
 }
 
 /**
- * Commits current transaction.
- *
- * @throw bdb::exception BDB_ERROR_NOT_FOUND - the database has no active transactions.
- * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ * @private Orders files of the cache snapshot by their heat, the hottest first.
  */
-void database::commit_transaction ()
+static bool hotter (const std::pair <uint64_t, string> & f1,    /**< [in] First file.  */
+                    const std::pair <uint64_t, string> & f2)    /**< [in] Second file. */
 {
-    LOG4CPLUS_TRACE(logger, "[bdb::database::commit_transaction] ENTER");
-
-    interprocess_mutex mutex;
-    scoped_lock <interprocess_mutex> lock(mutex);
+    return f1.first > f2.first;
+}
 
-    if (m_txns.size() == 1)
+/**
+ * @private Returns flags of Berkeley DB transaction for specified durability policy.
+ */
+static u_int32_t durability_flags (int durability)
+{
+    switch (durability)
     {
-        LOG4CPLUS_WARN(logger, "[bdb::database::commit_transaction] the database has no active transactions");
-        throw exception(BDB_ERROR_NOT_FOUND);
+        case BDB_DURABILITY_WRITE_NOSYNC:
+        case BDB_DURABILITY_GROUP:          return DB_TXN_WRITE_NOSYNC;
+        case BDB_DURABILITY_NOSYNC:         return DB_TXN_NOSYNC;
+        default:                            return DB_TXN_SYNC;
     }
+}
 
-    DB_TXN * txn = m_txns.top();
-    m_txns.pop();
-
-    int res = txn->commit(txn, DB_TXN_SYNC);
-
-    if (res != 0)
+/**
+ * @private Returns flags of Berkeley DB deadlock detector for specified policy.
+ */
+static u_int32_t deadlock_flags (int policy)
+{
+    switch (policy)
     {
-        LOG4CPLUS_WARN(logger, "[bdb::database::commit_transaction] " << db_strerror(res));
-        throw exception(BDB_ERROR_UNKNOWN);
+        case BDB_DEADLOCK_OLDEST:           return DB_LOCK_OLDEST;
+        case BDB_DEADLOCK_YOUNGEST:         return DB_LOCK_YOUNGEST;
+        case BDB_DEADLOCK_MINLOCKS:         return DB_LOCK_MINLOCKS;
+        case BDB_DEADLOCK_MINWRITE:         return DB_LOCK_MINWRITE;
+        case BDB_DEADLOCK_MAXLOCKS:         return DB_LOCK_MAXLOCKS;
+        case BDB_DEADLOCK_RANDOM:           return DB_LOCK_RANDOM;
+        default:                            return DB_LOCK_DEFAULT;
     }
-
-    LOG4CPLUS_TRACE(logger, "[bdb::database::commit_transaction] EXIT");
 }
 
 /**
- * Rolls back current transaction.
- *
- * @throw bdb::exception BDB_ERROR_NOT_FOUND - the database has no active transactions.
- * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ * @private Returns flags of environment opening for specified recovery mode.
  */
-void database::rollback_transaction ()
+static u_int32_t recovery_flags (int mode)
 {
-    LOG4CPLUS_TRACE(logger, "[bdb::database::rollback_transaction] ENTER");
-
-    interprocess_mutex mutex;
-    scoped_lock <interprocess_mutex> lock(mutex);
-
-    if (m_txns.size() == 1)
+    switch (mode)
     {
-        LOG4CPLUS_WARN(logger, "[bdb::database::rollback_transaction] the database has no active transactions");
-        throw exception(BDB_ERROR_NOT_FOUND);
+        case BDB_RECOVERY_NORMAL:           return DB_CREATE | DB_RECOVER;
+        case BDB_RECOVERY_FATAL:            return DB_CREATE | DB_RECOVER_FATAL;
+        case BDB_RECOVERY_AUTO:             return DB_CREATE | DB_RECOVER | DB_REGISTER;
+        case BDB_RECOVERY_DETECT:           return DB_REGISTER;
+        default:                            return 0;
     }
+}
 
-    DB_TXN * txn = m_txns.top();
-    m_txns.pop();
+/**
+ * @private Returns whether the process is alive (callback of "DB_ENV->failchk").
+ * Threads of alive processes are never considered dead, since they cannot be checked portably.
+ */
+static int is_alive (DB_ENV *,          /**< [in] Environment (unused).                           */
+                     pid_t pid,         /**< [in] Process of the thread.                          */
+                     db_threadid_t,     /**< [in] Thread (unused).                                */
+                     u_int32_t)         /**< [in] Whether only the process is checked (unused).   */
+{
+#ifdef _WIN32
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, pid);
 
-    int res = txn->abort(txn);
+    if (process == NULL) return 0;
 
-    if (res != 0)
-    {
-        LOG4CPLUS_WARN(logger, "[bdb::database::rollback_transaction] " << db_strerror(res));
-        throw exception(BDB_ERROR_UNKNOWN);
+    DWORD res = WaitForSingleObject(process, 0);
+    CloseHandle(process);
+
+    return (res == WAIT_TIMEOUT);
+#else
+    // the process may exist while belonging to another user
+    return (kill(pid, 0) == 0 || errno == EPERM);
+#endif
+}
+
+/**
+ * @private Returns flags of replication manager for specified role of the site.
+ */
+static u_int32_t replication_flags (int role)
+{
+    switch (role)
+    {
+        case BDB_REPL_MASTER:               return DB_REP_MASTER;
+        case BDB_REPL_CLIENT:               return DB_REP_CLIENT;
+        default:                            return DB_REP_ELECTION;
+    }
+}
+
+/**
+ * @private Splits address of replication site ("host:port") into host and port.
+ */
+static bool parse_site (const char * address,   /**< [in]  Address of the site. */
+                        string     * host,      /**< [out] Host of the site.    */
+                        u_int      * port)      /**< [out] Port of the site.    */
+{
+    const char * colon = (address != NULL ? strrchr(address, ':') : NULL);
+
+    if (colon == NULL || colon == address || atoi(colon + 1) <= 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::database] Invalid address of replication site: " << (address != NULL ? address : "NULL"));
+        return false;
+    }
+
+    host->assign(address, colon - address);
+    *port = (u_int) atoi(colon + 1);
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of struct "bdb::database_options".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Sets all options to Berkeley DB defaults.
+ */
+database_options::database_options ()
+  : cache_gbytes(0),
+    cache_bytes(0),
+    cache_regions(0),
+    log_buffer(0),
+    max_locks(0),
+    max_lockers(0),
+    max_objects(0),
+    deadlocks(BDB_DEADLOCK_DEFAULT),
+    auto_commit(false),
+    repl_role(BDB_REPL_NONE),
+    repl_local(NULL),
+    repl_remote(NULL),
+    repl_priority(100),
+    repl_threads(0),
+    checkpoint_minutes(0),
+    checkpoint_kbytes(0),
+    remove_logs(false),
+    recovery(BDB_RECOVERY_NONE),
+    in_memory(false),
+    concurrent(false),
+    worker_threads(0),
+    worker_affinity(false),
+    worker_first_cpu(0),
+    direct_db(false),
+    direct_log(false),
+    log_dsync(false),
+    mmap_size(0),
+    read_only(false),
+    cursor_cache(0),
+    multi_process(false),
+    shm_key(0),
+    max_threads(0),
+    log_dir(NULL),
+    data_dirs(NULL),
+    tmp_dir(NULL),
+    memory_budget(0),
+    mpool_percent(0),
+    huge_pages(false),
+    numa_policy(BDB_NUMA_DEFAULT),
+    encrypt_password(NULL),
+    fast_shutdown(false),
+    trickle_percent(0)
+{
+    // do nothing
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens the database.
+ * If "create" is "true" and database doesn't exist, then creates it.
+ * Tuning options take effect when the environment regions are created, and are ignored otherwise.
+ *
+ * Read-only database (see "read_only" option) is never created, and its files (including indexes) must
+ * exist. It has no transactions and no locks, so any number of processes may read it at once; files
+ * up to "mmap_size" bytes are read via memory mapping. Any changes of read-only database fail.
+ *
+ * Environment, shared by several processes at once (see "multi_process" option), tracks its processes:
+ * the first process, opening it after any process has failed uncleanly, runs recovery (unless another
+ * recovery mode is specified), and locks and transactions of dead processes are released periodically
+ * (see "check_failures"). Regions are kept in system shared memory, if "shm_key" is specified. Since
+ * top-level transaction would hold locks until the database is closed, the processes should auto-commit.
+ *
+ * Shared regions may be backed by huge pages (see "huge_pages" option), and placed on NUMA nodes (see
+ * "numa_policy" option); private regions of in-memory and read-only databases are not affected.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the database home is not found, or the database doesn't exist.
+ * @throw bdb::exception BDB_ERROR_EXISTS    - the database already exists (cannot be created).
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+database::database (const char             * home,      /**< [in] Home path of the database.                          */
+                    bool                     create,    /**< [in] Whether to create the database if it doesn't exist. */
+                    const database_options & options)   /**< [in] Tuning options of the environment.                  */
+  : m_home(string(home)),
+    m_env(NULL),
+    m_seq(NULL),
+    m_seqc(NULL),
+    m_histograms(NULL),
+    m_changes(NULL),
+    m_txn(NULL),
+    m_txns(NULL),
+    m_durability(BDB_DURABILITY_SYNC),
+    m_group(NULL),
+    m_maintenance(NULL),
+    m_trickle(NULL),
+    m_pool(NULL),
+    m_notifier(NULL),
+    m_applier(NULL),
+    m_reaper(NULL),
+    m_cursors(NULL),
+    m_governor(NULL),
+    m_memory(options.in_memory),
+    m_concurrent(options.concurrent || options.read_only),
+    m_readonly(options.read_only),
+    m_fast_shutdown(options.fast_shutdown),
+    m_close_flags(0),
+    m_role(options.repl_role == BDB_REPL_NONE || options.repl_role == BDB_REPL_MASTER ? BDB_REPL_MASTER : BDB_REPL_CLIENT),
+    m_slow(0),
+    m_slow_callback(NULL),
+    m_slow_param(NULL)
+{
+    refresh_logging();
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::database] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] home = " << home);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] create = " << create);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] cache = " << options.cache_gbytes << "G + " << options.cache_bytes << " (" << options.cache_regions << " regions)");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] log buffer = " << options.log_buffer);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] max locks/lockers/objects = " << options.max_locks << "/" << options.max_lockers << "/" << options.max_objects);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] deadlocks = " << options.deadlocks);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] auto commit = " << options.auto_commit);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] replication = " << options.repl_role);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] checkpoints = " << options.checkpoint_minutes << " min / " << options.checkpoint_kbytes << " KB, remove logs = " << options.remove_logs);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] recovery = " << options.recovery);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] in memory = " << options.in_memory << ", concurrent = " << options.concurrent << ", read only = " << options.read_only);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] direct I/O = " << options.direct_db << "/" << options.direct_log << ", log dsync = " << options.log_dsync << ", mmap = " << options.mmap_size);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] multi-process = " << options.multi_process << ", shm key = " << options.shm_key << ", threads = " << options.max_threads);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] memory budget = " << options.memory_budget << " (" << options.mpool_percent << "% cache)");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] huge pages = " << options.huge_pages << ", NUMA policy = " << options.numa_policy);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] fast shutdown = " << options.fast_shutdown << ", trickle = " << options.trickle_percent << "%");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] log dir = " << (options.log_dir != NULL ? options.log_dir : "") << ", tmp dir = " << (options.tmp_dir != NULL ? options.tmp_dir : ""));
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::database] workers = " << options.worker_threads << ", affinity = " << options.worker_affinity << " (from CPU " << options.worker_first_cpu << ")");
+
+    // database flags
+    u_int32_t flags = DB_THREAD         // multi-threaded access
+                    | DB_INIT_MPOOL;    // in-memory cache
+
+    if (m_readonly)
+    {
+        flags |= DB_PRIVATE;            // no shared regions (nothing is written to the home), no locking
+    }
+    else if (m_concurrent)
+    {
+        flags |= DB_INIT_CDB;           // single writer, multiple readers
+    }
+    else
+    {
+        flags |= DB_INIT_LOCK           // locking for concurrent applications
+              |  DB_INIT_LOG            // recoverability
+              |  DB_INIT_TXN;           // transaction subsystem
+    }
+
+    // private environment is created on each opening, and disappears on closing
+    if (m_memory) create = true;
+
+    if (m_memory) flags |= DB_PRIVATE;
+    if (create)   flags |= DB_CREATE;
+
+    // files of read-only database are never created, while its private environment always is
+    if (m_readonly) create = false;
+    if (m_readonly) flags |= DB_CREATE;
+
+    if (options.repl_role != BDB_REPL_NONE && !m_concurrent) flags |= DB_INIT_REP;
+
+    // shared environment is recovered by the first process, opening it after a failure of any process
+    bool shared = options.multi_process && !m_memory && !m_concurrent;
+
+    if (shared && !options.auto_commit)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::database] Top-level transaction holds its locks against other processes until the database is closed.");
+    }
+
+    // recovery recreates the environment regions
+    if (!m_memory && !m_concurrent) flags |= recovery_flags(shared && options.recovery == BDB_RECOVERY_NONE ? BDB_RECOVERY_AUTO : options.recovery);
+
+    if (shared) flags |= DB_REGISTER;
+
+    // regions are kept in system shared memory instead of files
+    if (options.shm_key != 0 && !m_memory && !m_readonly) flags |= DB_SYSTEM_MEM;
+
+    // open/create the environment
+    int res = db_env_create(&m_env, 0);
+
+    if (res == 0) res = m_env->set_alloc(m_env, malloc, realloc, free);
+
+    // tune the environment (these settings are ignored if the environment already exists)
+    if (options.cache_gbytes != 0 || options.cache_bytes != 0)
+    {
+        if (res == 0) res = m_env->set_cachesize(m_env, options.cache_gbytes, options.cache_bytes, options.cache_regions);
+    }
+
+    // the cache takes its part of the memory budget, unless its size is specified
+    uint64_t mpool = (uint64_t) options.cache_gbytes * GIGABYTE + options.cache_bytes;
+
+    if (options.memory_budget != 0 && mpool == 0)
+    {
+        unsigned int percent = (options.mpool_percent != 0 ? options.mpool_percent : BUDGET_MPOOL_PERCENT);
+        if (percent > 100) percent = 100;
+
+        mpool = options.memory_budget / 100 * percent;
+
+        // small cache is requested smaller, so it fits the budget together with the overhead, added by Berkeley DB
+        uint64_t size = (mpool / 5 * 4 < SMALL_CACHE_BYTES ? mpool / 5 * 4 : mpool);
+
+        if (size != 0 && res == 0) res = m_env->set_cachesize(m_env, (u_int32_t) (size / GIGABYTE), (u_int32_t) (size % GIGABYTE), options.cache_regions);
+    }
+
+    if (options.log_buffer  != 0 && res == 0) res = m_env->set_lg_bsize(m_env, options.log_buffer);
+
+    // whole log of in-memory database is kept in the log buffer
+    if (m_memory && !m_concurrent)
+    {
+        if (options.log_buffer == 0 && res == 0) res = m_env->set_lg_bsize(m_env, MEMORY_LOG_BUFFER);
+        if (res == 0) res = m_env->log_set_config(m_env, DB_LOG_IN_MEMORY, 1);
+    }
+
+    // pages are cached by the environment only, not by the operating system as well
+    if (options.direct_db && res == 0) res = m_env->set_flags(m_env, DB_DIRECT_DB, 1);
+
+    if (!m_memory && !m_concurrent)
+    {
+        if (options.direct_log && res == 0) res = m_env->log_set_config(m_env, DB_LOG_DIRECT, 1);
+        if (options.log_dsync  && res == 0) res = m_env->log_set_config(m_env, DB_LOG_DSYNC,  1);
+    }
+
+    // read-only files up to this size are mapped into memory, instead of being copied into the cache
+    if (options.mmap_size != 0 && res == 0) res = m_env->set_mp_mmapsize(m_env, options.mmap_size);
+
+    // log, data and temporary files may be placed on separate devices (relative paths are within the home)
+    if (!m_memory)
+    {
+        if (options.log_dir != NULL && !m_concurrent && res == 0) res = m_env->set_lg_dir(m_env, options.log_dir);
+        if (options.tmp_dir != NULL && res == 0) res = m_env->set_tmp_dir(m_env, options.tmp_dir);
+
+        for (const char ** dir = options.data_dirs; dir != NULL && *dir != NULL && res == 0; dir++)
+        {
+            LOG4CPLUS_DEBUG(logger, "[bdb::database::database] data dir = " << *dir);
+            res = m_env->set_data_dir(m_env, *dir);
+        }
+    }
+
+    if (options.max_locks   != 0 && res == 0) res = m_env->set_lk_max_locks(m_env, options.max_locks);
+    if (options.max_lockers != 0 && res == 0) res = m_env->set_lk_max_lockers(m_env, options.max_lockers);
+    if (options.max_objects != 0 && res == 0) res = m_env->set_lk_max_objects(m_env, options.max_objects);
+
+    if ((flags & DB_SYSTEM_MEM) != 0)
+    {
+        if (res == 0) res = m_env->set_shm_key(m_env, options.shm_key);
+    }
+
+    // threads of all processes are tracked, so locks of dead ones can be released
+    if (shared)
+    {
+        if (options.max_threads != 0 && res == 0) res = m_env->set_thread_count(m_env, options.max_threads);
+        if (options.max_threads == 0 && res == 0) res = m_env->set_thread_count(m_env, MULTI_PROCESS_THREADS);
+        if (res == 0) res = m_env->set_isalive(m_env, is_alive);
+    }
+
+    // run deadlock detector whenever a lock conflict occurs
+    if (options.deadlocks != BDB_DEADLOCK_NONE && !m_concurrent && res == 0) res = m_env->set_lk_detect(m_env, deadlock_flags(options.deadlocks));
+
+    // commit each operation outside of transactions on its own
+    if (options.auto_commit && !m_concurrent && res == 0) res = m_env->set_flags(m_env, DB_AUTO_COMMIT, 1);
+
+    // the log is encrypted as a whole, and tables - if they are opened as encrypted ones
+    if (options.encrypt_password != NULL && res == 0) res = m_env->set_encrypt(m_env, options.encrypt_password, DB_ENCRYPT_AES);
+
+    // shared regions are mapped by the library itself, if they are placed into huge pages or on NUMA nodes
+    if (res == 0) res = place_regions(options);
+
+    if (res == 0) res = m_env->open(m_env, m_home.c_str(), flags, 0);
+
+    // release what is left by processes, which have died since the environment was recovered
+    if (shared && res == 0) res = m_env->failchk(m_env, 0);
+
+    // join replication group before any database is opened
+    if ((flags & DB_INIT_REP) != 0 && res == 0) res = start_replication(options);
+
+    // create top-level transaction, which holds all changes outside of transactions until the database is closed
+    if (!options.auto_commit && !m_concurrent && res == 0) res = m_env->txn_begin(m_env, NULL, &m_txn, DB_READ_COMMITTED | DB_TXN_SYNC);
+
+    // open/create the sequences database
+    flags = DB_THREAD;
+
+    if (create) flags |= DB_CREATE | DB_EXCL;
+
+    if (res == 0) res = db_create(&m_seq, m_env, 0);
+    if (res == 0) res = open_file(m_seq, m_txn, "__seq.db", "__seq", DB_BTREE, flags);
+
+    // handle error, if any
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::database] " << db_strerror(res));
+
+        if (res == DB_RUNRECOVERY)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::database::database] The database must be opened with recovery.");
+        }
+
+        if (m_seq != NULL) m_seq->close(m_seq, 0);
+        if (m_txn != NULL) m_txn->abort(m_txn);
+        if (m_env != NULL) m_env->close(m_env, 0);
+
+        release_regions();
+
+        switch (res)
+        {
+            case ENOENT:    throw exception(BDB_ERROR_NOT_FOUND);
+            case EEXIST:    throw exception(BDB_ERROR_EXISTS);
+            default:        throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    m_txns = new txn_stacks;
+    assert(m_txns != NULL);
+
+    m_group = new group_commit;
+    assert(m_group != NULL);
+
+    m_pool = new work_pool(options.worker_threads, options.worker_affinity, options.worker_first_cpu);
+    assert(m_pool != NULL);
+
+    m_notifier = new notifier;
+    assert(m_notifier != NULL);
+
+    m_applier = new index_applier(this);
+    assert(m_applier != NULL);
+
+    m_reaper = new expiry_reaper(this);
+    assert(m_reaper != NULL);
+
+    if (options.memory_budget != 0)
+    {
+        m_governor = new memory_governor(options.memory_budget, mpool);
+        assert(m_governor != NULL);
+    }
+
+    if (options.cursor_cache != 0)
+    {
+        m_cursors = new cursor_pool(options.cursor_cache);
+        assert(m_cursors != NULL);
+    }
+
+    if ((options.checkpoint_minutes != 0 || options.checkpoint_kbytes != 0 || shared) && !m_concurrent)
+    {
+        m_maintenance = new maintenance(m_env, options, shared);
+        assert(m_maintenance != NULL);
+    }
+
+    if (options.trickle_percent != 0 && !m_memory && !m_readonly)
+    {
+        m_trickle = new trickle_writer(m_env, std::min(options.trickle_percent, 100U));
+        assert(m_trickle != NULL);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::database] EXIT");
+}
+
+/**
+ * Closes the database and all associated sequences, tables, and indexes.
+ * Any active transactions will be rolled back.
+ *
+ * On fast shutdown (see "bdb::database_options::fast_shutdown"), dirty pages of the cache are written by a background
+ * thread, while workers of the database are stopped, and handles are closed with "DB_NOSYNC", instead of flushing
+ * their files one by one. The rest of dirty pages are written by one checkpoint after the top-level transaction is
+ * committed (or by one flush of the cache, if the database has no transactions).
+ */
+database::~database () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::~database] ENTER");
+
+    // on fast shutdown dirty pages of all files are written in background, while the rest of workers are stopped
+    boost::thread * trickle = NULL;
+
+    if (m_fast_shutdown && !m_memory && !m_readonly)
+    {
+        try
+        {
+            trickle = new boost::thread(boost::bind(trickle_cache, m_env));
+        }
+        catch (...)
+        {
+            trickle = NULL;
+        }
+    }
+
+    // stop background maintenance and workers of parallel operations before anything is closed
+    delete m_trickle;
+    delete m_maintenance;
+    delete m_pool;
+
+    // undelivered change notifications are dropped, deferred indexes are applied and expired records are removed on the next open
+    m_notifier->shutdown();
+    m_applier->shutdown();
+    m_reaper->shutdown();
+
+    // cached cursors are closed before their transactions and handles
+    delete m_cursors;
+    m_cursors = NULL;
+
+    // rollback non-completed transactions of all threads (besides top-level one)
+    {
+        boost::mutex::scoped_lock lock(m_txns->mutex);
+
+        for (unsigned int i = 0; i < m_txns->all.size(); i++)
+        {
+            txn_stack * txns = m_txns->all[i];
+
+            while (!txns->empty())
+            {
+                DB_TXN * txn = txns->top();
+                txns->pop();
+                if (txn != NULL) txn->abort(txn);
+            }
+
+            delete txns;
+        }
+    }
+
+    m_txns->local.release();
+    delete m_txns;
+    delete m_group;
+
+    if (trickle != NULL)
+    {
+        trickle->join();
+        delete trickle;
+    }
+
+    // once the pages are written (without log, by one flush of the whole cache), handles are closed without flushing them
+    // one by one; in transactional environment, pages, which are still dirty, are written by the final checkpoint
+    if (m_fast_shutdown)
+    {
+        if (m_concurrent && !m_memory && !m_readonly) m_env->memp_sync(m_env, NULL);
+
+        m_close_flags = DB_NOSYNC;
+    }
+
+    // close all associated sequences
+    for (unsigned int i = 0; i < m_sequences.size(); i++)
+    {
+        delete m_sequences[i];
+    }
+
+    for (unsigned int i = 0; i < m_generators.size(); i++)
+    {
+        delete m_generators[i];
+    }
+
+    // close all associated tables
+    for (unsigned int i = 0; i < m_tables.size(); i++)
+    {
+        delete m_tables[i];
+    }
+
+    delete m_notifier;
+    m_notifier = NULL;
+
+    delete m_applier;
+    m_applier = NULL;
+
+    delete m_reaper;
+    m_reaper = NULL;
+
+    // tables have given their memory back
+    delete m_governor;
+    m_governor = NULL;
+
+    if (m_changes != NULL) m_changes->close(m_changes, m_close_flags);
+    if (m_histograms != NULL) m_histograms->close(m_histograms, m_close_flags);
+    if (m_seqc != NULL) m_seqc->close(m_seqc, m_close_flags);
+    if (m_seq  != NULL) m_seq->close(m_seq, m_close_flags);
+    if (m_txn  != NULL) commit_txn(m_txn, BDB_DURABILITY_SYNC, false);
+
+    if (m_fast_shutdown && !m_memory && !m_concurrent) m_env->txn_checkpoint(m_env, 0, 0, 0);
+
+    if (m_env != NULL) m_env->close(m_env, 0);
+
+    release_regions();
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::~database] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds specified sequence to the database and opens the sequence.
+ * If "create" is "true" and sequence doesn't exist, then creates it.
+ *
+ * If "cache" is not zero, the sequence caches specified number of identifiers in memory, so most of
+ * identifiers are generated without any access to the database. Cached sequences are not transactional
+ * (identifiers are allocated outside of any transaction, and are never returned back on rollback),
+ * and are kept apart from regular ones, so a sequence must be always opened either with or without cache.
+ *
+ * If "autonomous" is "true", identifiers of uncached sequence are allocated outside of any transaction as well
+ * (each allocation is committed on its own without flushing the log), so record of the sequence is never locked
+ * by a long transaction until its end, blocking allocations of other threads. Identifiers are never returned back
+ * on rollback, so there are gaps in them. Autonomous sequences are kept with cached ones.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the sequence is not found.
+ * @throw bdb::exception BDB_ERROR_EXISTS    - the sequence already exists (cannot be created).
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+sequence * database::add_sequence (const char * name,       /**< [in] Name of the sequence.                               */
+                                   bool         create,     /**< [in] Whether to create the sequence if it doesn't exist. */
+                                   int          cache,      /**< [in] Number of identifiers to cache ("0" - no cache).    */
+                                   bool         autonomous) /**< [in] Whether identifiers are allocated outside of transactions. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::add_sequence] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::add_sequence] name = " << name);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::add_sequence] create = " << create);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::add_sequence] cache = " << cache);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::add_sequence] autonomous = " << autonomous);
+
+    // cached (and autonomous) sequences are updated in their own auto-committed transactions, so they have a separate
+    // database, where records cannot be locked by the top-level transaction
+    if (cache != 0 || autonomous)
+    {
+        int res = open_autonomous();
+
+        if (res != 0)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::database::add_sequence] " << db_strerror(res));
+            throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    sequence * s = NULL;
+
+    try
+    {
+        s = new sequence(this, name, create, cache, autonomous);
+        assert(s != NULL);
+        m_sequences.push_back(s);
+    }
+    catch (...)
+    {
+        throw;
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::add_sequence] EXIT");
+
+    return s;
+}
+
+/**
+ * Adds generator of time-ordered IDs with specified name to the database (see "bdb::id_generator").
+ * Each node (e.g. each database of sharded or replicated deployment), which generates IDs of the same kind,
+ * must have its own number from 0 to 1023. The generator is created on first opening.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - invalid node, or unknown error.
+ */
+id_generator * database::add_generator (const char   * name,    /**< [in] Name of the generator.      */
+                                        unsigned int   node)    /**< [in] Number of the node (0-1023). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::add_generator] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::add_generator] name = " << name);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::add_generator] node = " << node);
+
+    // reserved time is written in its own auto-committed transactions, as cached sequences are
+    int res = open_autonomous();
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::add_generator] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    id_generator * g = new id_generator(this, name, node);
+    assert(g != NULL);
+    m_generators.push_back(g);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::add_generator] EXIT");
+
+    return g;
+}
+
+/**
+ * Adds specified table to the database and opens the table.
+ * If "create" is "true" and table doesn't exist, then creates it.
+ *
+ * Access method of the table is set by its options (see @ref accessmethods "methods"):
+ * - Btree tables support all operations;
+ * - hash tables ignore keys comparision function, and are scanned in no particular order;
+ *   ranges of keys (range recordsets, seeks, range estimates and deletes, parallel scans) are not supported;
+ * - keys of recno and queue tables are record numbers, taken from the only integer field of key messages
+ *   ("BDB_KEY_RECNO"), and the tables are scanned in order of the numbers; ranges of keys are not supported;
+ *   data of queue tables are padded to fixed record length, which must fit the largest data.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the table is not found.
+ * @throw bdb::exception BDB_ERROR_EXISTS    - the table already exists (cannot be created).
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+table * database::add_table (const char          * name,    /**< [in] Name of the table.                                      */
+                             compare_callback      fn_cmp,  /**< [in] Keys comparision function (see "Db::set_bt_compare()"). */
+                             bool                  create,  /**< [in] Whether to create the table if it doesn't exist.        */
+                             const table_options & options) /**< [in] Tuning options of the table.                            */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::add_table] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::add_table] name = " << name);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::add_table] create = " << create);
+
+    table * t = NULL;
+
+    try
+    {
+        t = new table(this, name, fn_cmp, create, options);
+        assert(t != NULL);
+        m_tables.push_back(t);
+        m_names[t->m_name] = t;
+    }
+    catch (...)
+    {
+        throw;
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::add_table] EXIT");
+
+    return t;
+}
+
+/**
+ * Returns opened table of the database by its name ("NULL" if the table is not added to the database).
+ */
+table * database::get_table (const char * name) const   /**< [in] Name of the table. */
+{
+    std::map <string, table*>::const_iterator i = m_names.find(name);
+
+    return (i != m_names.end() ? i->second : NULL);
+}
+
+/**
+ * Adds specified tables with their indexes to the database, and opens them by several tasks of the shared
+ * work pool at once (see "bdb::database::add_table"). Each table is opened in its own transaction, nested
+ * into top-level transaction of the database, if there is one. If any table fails to open, the rest of
+ * them are not opened, and the error is thrown, but tables, which have been opened, are added to the
+ * database all the same (see "bdb::database::get_table").
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - a table is not found.
+ * @throw bdb::exception BDB_ERROR_EXISTS    - a table already exists (cannot be created).
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void database::add_tables (const vector <table_spec> & specs,       /**< [in]  Specifications of the tables.                       */
+                           vector <table*>           * tables,      /**< [out] Tables by their specifications ("NULL" - not opened). */
+                           unsigned int                nthreads)    /**< [in]  Number of parallel tasks.                           */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::add_tables] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::add_tables] specs = " << specs.size() << ", nthreads = " << nthreads);
+
+    table_opener opener(this, specs);
+
+    {
+        task_group tasks(m_pool);
+
+        for (unsigned int i = 0; i < std::max(nthreads, 1U); i++)
+        {
+            tasks.run(table_opener::run, &opener);
+        }
+    }
+
+    if (tables != NULL) tables->clear();
+
+    // tables are listed in order of their specifications, whichever task has opened them
+    for (size_t i = 0; i < specs.size(); i++)
+    {
+        table * t = opener.tables[i];
+
+        if (t != NULL)
+        {
+            m_tables.push_back(t);
+            m_names[t->m_name] = t;
+        }
+
+        if (tables != NULL) tables->push_back(t);
+    }
+
+    if (opener.error != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::add_tables] Some tables have failed to open.");
+        throw exception(opener.error);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::add_tables] EXIT");
+}
+
+/**
+ * Closes specified table with all its indexes, and removes their files from the database
+ * (in implicit transaction, if there is no one), so all records of the table are dropped at once.
+ * Other tables must not have foreign constraints on indexes of the table.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the table doesn't belong to the database.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void database::remove_table (table * tbl)   /**< [in] Table to remove. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::remove_table] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::remove_table] name = " << tbl->m_name);
+
+    vector <table*>::iterator i = std::find(m_tables.begin(), m_tables.end(), tbl);
+
+    if (i == m_tables.end())
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::remove_table] The table doesn't belong to the database.");
+        throw exception(BDB_ERROR_NOT_FOUND);
+    }
+
+    vector <std::pair <string, string> > files;
+    files.push_back(std::make_pair(tbl->get_filename(), tbl->m_name));
+
+    for (unsigned int j = 0; j < tbl->m_indexes.size(); j++)
+    {
+        index * idx = tbl->m_indexes[j];
+
+        files.push_back(std::make_pair(idx->get_filename(), idx->m_name));
+
+        // in-memory projections are a database of their own, not a part of the index file
+        if (m_memory && idx->m_cover != NULL) files.push_back(std::make_pair(idx->get_filename(), idx->m_name + ".cover"));
+    }
+
+    for (unsigned int j = 0; j < tbl->m_aggregates.size(); j++)
+    {
+        files.push_back(std::make_pair(tbl->m_aggregates[j]->get_filename(), tbl->m_aggregates[j]->m_name));
+    }
+
+    for (unsigned int j = 0; j < tbl->m_columns.size(); j++)
+    {
+        files.push_back(std::make_pair(tbl->m_columns[j]->get_filename(), tbl->m_columns[j]->m_name));
+    }
+
+    // files can be removed only when all their handles are closed
+    if (m_cursors != NULL) m_cursors->clear();
+
+    m_tables.erase(i);
+
+    std::map <string, table*>::iterator n = m_names.find(tbl->m_name);
+    if (n != m_names.end() && n->second == tbl) m_names.erase(n);
+
+    delete tbl;
+
+    DB_TXN * txn = get_transaction();
+    DB_TXN * own = NULL;
+
+    int res = begin_auto(&txn, &own);
+
+    for (unsigned int j = 0; j < files.size() && res == 0; j++)
+    {
+        res = remove_file(txn, files[j].first, files[j].second);
+    }
+
+    res = end_auto(own, res);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::remove_table] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::remove_table] EXIT");
+}
+
+/**
+ * Begins new transaction.
+ * Transactions are tracked per thread, so each thread has its own stack of nested transactions,
+ * while the top-level transaction of the database is a parent of outermost transaction of each thread.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void database::begin_transaction ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::begin_transaction] ENTER");
+
+    txn_stack * txns = m_txns->get();
+
+    DB_TXN * txn = NULL;
+
+    int res = begin_txn(get_transaction(), &txn, BDB_DURABILITY_DEFAULT);
+
+    if (res == 0)
+    {
+        txns->push(txn);
+    }
+    else
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::begin_transaction] " << db_strerror(res));
+        if (txn != NULL) abort_txn(txn);
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::begin_transaction] EXIT");
+}
+
+/**
+ * Commits current transaction.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the database has no active transactions.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void database::commit_transaction ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::commit_transaction] ENTER");
+
+    txn_stack * txns = m_txns->get();
+
+    if (txns->empty())
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::commit_transaction] the database has no active transactions");
+        throw exception(BDB_ERROR_NOT_FOUND);
+    }
+
+    DB_TXN * txn = txns->top();
+    txns->pop();
+
+    int res = (txn != NULL ? commit_txn(txn, BDB_DURABILITY_DEFAULT, txns->parent() != NULL || m_txn != NULL) : 0);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::commit_transaction] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::commit_transaction] EXIT");
+}
+
+/**
+ * Rolls back current transaction.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the database has no active transactions.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void database::rollback_transaction ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::rollback_transaction] ENTER");
+
+    txn_stack * txns = m_txns->get();
+
+    if (txns->empty())
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::rollback_transaction] the database has no active transactions");
+        throw exception(BDB_ERROR_NOT_FOUND);
+    }
+
+    DB_TXN * txn = txns->top();
+    txns->pop();
+
+    int res = (txn != NULL ? abort_txn(txn) : 0);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::rollback_transaction] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::rollback_transaction] EXIT");
+}
+
+/**
+ * Sets savepoint in current transaction of the calling thread. The savepoint is a nested transaction,
+ * which is begun on first use only, so a savepoint without changes costs nothing to release or roll back,
+ * and several savepoints without changes between them share one nested transaction. Savepoints are
+ * nested with transactions of the thread (see "database::begin_transaction").
+ */
+void database::set_savepoint ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::set_savepoint] ENTER");
+
+    m_txns->get()->push(NULL);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::set_savepoint] EXIT");
+}
+
+/**
+ * Releases the last savepoint, keeping the changes made since it.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the thread has no savepoints.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void database::release_savepoint ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::release_savepoint] ENTER");
+
+    txn_stack * txns = m_txns->get();
+
+    if (txns->empty())
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::release_savepoint] the database has no active savepoints");
+        throw exception(BDB_ERROR_NOT_FOUND);
+    }
+
+    DB_TXN * txn = txns->top();
+    txns->pop();
+
+    int res = 0;
+
+    if (txn != NULL)
+    {
+        // changes, made since the previous savepoint without its own changes, are passed to that savepoint
+        if (!txns->empty() && txns->top() == NULL)
+        {
+            txns->pop();
+            txns->push(txn);
+        }
+        else
+        {
+            res = commit_txn(txn, BDB_DURABILITY_DEFAULT, txns->parent() != NULL || m_txn != NULL);
+        }
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::release_savepoint] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::release_savepoint] EXIT");
+}
+
+/**
+ * Rolls back all the changes made since the last savepoint, and removes the savepoint.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the thread has no savepoints.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void database::rollback_savepoint ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::rollback_savepoint] ENTER");
+
+    txn_stack * txns = m_txns->get();
+
+    if (txns->empty())
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::rollback_savepoint] the database has no active savepoints");
+        throw exception(BDB_ERROR_NOT_FOUND);
+    }
+
+    DB_TXN * txn = txns->top();
+    txns->pop();
+
+    int res = (txn != NULL ? abort_txn(txn) : 0);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::rollback_savepoint] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::rollback_savepoint] EXIT");
+}
+
+/**
+ * Runs specified function in new transaction, which is committed when the function returns.
+ * If the function (or the commit) fails with a deadlock, the transaction is rolled back and the function
+ * is called again, at most "max_retries" times. Any other error rolls back the transaction and is rethrown.
+ * The transaction is nested into current one of the thread, if any.
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - the transaction is still deadlocked after all retries.
+ * @throw bdb::exception                    - any other error, thrown by the function.
+ */
+void database::run_in_transaction (transaction_callback fn_txn,         /**< [in] Function to run.                          */
+                                   void               * param,          /**< [in] Parameter to pass to the function.        */
+                                   unsigned int         max_retries)    /**< [in] Maximum number of retries on deadlock.    */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::run_in_transaction] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::run_in_transaction] max_retries = " << max_retries);
+
+    for (unsigned int attempt = 0; ; attempt++)
+    {
+        transaction txn(this);
+
+        try
+        {
+            fn_txn(&txn, param);
+            txn.commit();
+            break;
+        }
+        catch (exception & e)
+        {
+            if (e.error() != BDB_ERROR_DEADLOCK || attempt == max_retries)
+            {
+                throw;
+            }
+
+            LOG4CPLUS_DEBUG(logger, "[bdb::database::run_in_transaction] retry = " << attempt + 1);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::run_in_transaction] EXIT");
+}
+
+/**
+ * Sets default durability policy of transactions, which are committed with "BDB_DURABILITY_DEFAULT".
+ * Initially the policy is "BDB_DURABILITY_SYNC".
+ *
+ * For "BDB_DURABILITY_GROUP" the log is flushed once for a batch of concurrent commits: the first
+ * committer waits for others during "window" microseconds, or until "size" committers are gathered.
+ * Each committer returns only after the log is flushed, so no committed transaction can be lost.
+ * The policy should be set before the database is shared between threads.
+ */
+void database::set_durability (int          policy,     /**< [in] Durability policy (see @ref durability "codes"). */
+                               unsigned int window,     /**< [in] Group commit window, in microseconds.           */
+                               unsigned int size)       /**< [in] Group commit batch size ("0" - no limit).       */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::set_durability] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::set_durability] policy = " << policy);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::set_durability] window = " << window);
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::set_durability] size = " << size);
+
+    m_durability = (policy == BDB_DURABILITY_DEFAULT ? BDB_DURABILITY_SYNC : policy);
+
+    boost::mutex::scoped_lock lock(m_group->mutex);
+    m_group->window = window;
+    m_group->size   = size;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::set_durability] EXIT");
+}
+
+/**
+ * Checks whether the database is writable, i.e. it's not replicated, or it's the master of replication group.
+ * The role of replicated site changes on elections, so writes to a client fail with "BDB_ERROR_UNKNOWN".
+ */
+bool database::is_master ()
+{
+    return (m_role == BDB_REPL_MASTER);
+}
+
+/**
+ * Waits until the transaction, committed with specified token (possibly on another site), is applied
+ * to this database, so the following reads of this replica see its changes ("DB_ENV->txn_applied").
+ * Requires Berkeley DB 5.2 or later.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the transaction will never be applied (e.g. it's rolled back on master change).
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ *
+ * @return true  - the transaction is applied.
+ * @return false - the timeout is expired.
+ */
+bool database::wait_applied (const commit_token & token,    /**< [in] Token of committed transaction.                   */
+                             unsigned int         timeout)  /**< [in] Timeout, in microseconds ("0" - don't wait at all). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::wait_applied] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::wait_applied] timeout = " << timeout);
+
+    int res = EINVAL;
+
+#ifdef BDB_TXN_TOKEN
+    DB_TXN_TOKEN t;
+
+    assert(sizeof(t) == sizeof(token.data));
+    memcpy(&t, token.data, sizeof(t));
+
+    res = m_env->txn_applied(m_env, &t, timeout, 0);
+#else
+    LOG4CPLUS_WARN(logger, "[bdb::database::wait_applied] Commit tokens require Berkeley DB 5.2 or later.");
+#endif
+
+    // the transaction has made no changes
+    if (res == DB_KEYEMPTY) res = 0;
+
+    if (res != 0 && res != DB_TIMEOUT)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::wait_applied] " << db_strerror(res));
+        throw exception(res == DB_NOTFOUND ? BDB_ERROR_NOT_FOUND : BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::wait_applied] EXIT = " << (res == 0));
+
+    return (res == 0);
+}
+
+/**
+ * Checkpoints the environment at once, flushing all changed pages of the cache to database files, and
+ * optionally removes log files, which are no longer needed for recovery (e.g. before a file-level backup).
+ * Log files, needed by active transactions (including top-level one, unless the database auto-commits), are kept.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void database::checkpoint (bool remove_logs)    /**< [in] Whether to remove unneeded log files. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::checkpoint] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::checkpoint] remove logs = " << remove_logs);
+
+    int res = m_env->txn_checkpoint(m_env, 0, 0, DB_FORCE);
+
+    if (res == 0 && remove_logs) res = m_env->log_archive(m_env, NULL, DB_ARCH_REMOVE);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::checkpoint] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::checkpoint] EXIT");
+}
+
+/**
+ * Releases locks and aborts transactions of dead processes (threads), which share the environment
+ * ("DB_ENV->failchk"), so the other processes can go on (e.g. after a worker of a pre-fork pool has crashed).
+ * Environment, shared by several processes (see "bdb::database_options::multi_process"), is checked
+ * by the background maintenance thread as well.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - a dead process had modified the environment (it must be recovered),
+ *                                           the environment is not shared, or unknown error.
+ */
+void database::check_failures ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::check_failures] ENTER");
+
+    int res = m_env->failchk(m_env, 0);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::check_failures] " << db_strerror(res));
+
+        if (res == DB_RUNRECOVERY)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::database::check_failures] The database must be reopened with recovery.");
+        }
+
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::check_failures] EXIT");
+}
+
+/**
+ * Makes hot backup of the database (database files and log files) into specified directory, while the database
+ * is used by others ("DB_ENV->backup"). Incremental backup copies only log files, which are written since
+ * the previous backup into the directory, so the backup can be kept up to date cheaply, and "catastrophic"
+ * recovery of the backup directory makes consistent copy of the database. Requires Berkeley DB 5.3 or later.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the directory doesn't exist.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void database::backup (const char * target,     /**< [in] Directory of the backup.                          */
+                       bool         update)     /**< [in] Whether to update existing backup incrementally.  */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::backup] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::backup] target = " << target << ", update = " << update);
+
+    int res = EINVAL;
+
+#ifdef BDB_ENV_BACKUP
+    res = m_env->backup(m_env, target, (update ? DB_BACKUP_UPDATE : DB_BACKUP_CLEAN | DB_BACKUP_FILES));
+#else
+    LOG4CPLUS_WARN(logger, "[bdb::database::backup] Hot backups require Berkeley DB 5.3 or later.");
+#endif
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::backup] " << db_strerror(res));
+        throw exception(res == ENOENT ? BDB_ERROR_NOT_FOUND : BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::backup] EXIT");
+}
+
+/**
+ * Returns statistics of the cache, locks, log, and transactions of the environment.
+ * If "clear" is "true", the counters are reset after reading, so the next statistics are increments
+ * since this call (values of current state, like numbers of locks or active transactions, are not reset).
+ * Concurrent data store has no locks, log, and transactions, so their statistics are zero.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void database::stats (database_stats * result,  /**< [out] Statistics of the environment.       */
+                      bool             clear)   /**< [in]  Whether to reset the counters.       */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::stats] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::stats] clear = " << clear);
+
+    u_int32_t flags = (clear ? DB_STAT_CLEAR : 0);
+
+    DB_MPOOL_STAT * msp = NULL;
+    DB_LOCK_STAT  * ksp = NULL;
+    DB_LOG_STAT   * lsp = NULL;
+    DB_TXN_STAT   * tsp = NULL;
+
+    int res = m_env->memp_stat(m_env, &msp, NULL, flags);
+
+    if (!m_concurrent)
+    {
+        if (res == 0) res = m_env->lock_stat(m_env, &ksp, flags);
+        if (res == 0) res = m_env->log_stat(m_env, &lsp, flags);
+        if (res == 0) res = m_env->txn_stat(m_env, &tsp, flags);
+    }
+
+    if (res == 0)
+    {
+        memset(result, 0, sizeof(database_stats));
+
+        result->cache_bytes     = (uint64_t) msp->st_gbytes * 1024 * 1024 * 1024 + msp->st_bytes;
+        result->cache_pages     = msp->st_pages;
+        result->dirty_pages     = msp->st_page_dirty;
+        result->cache_hits      = msp->st_cache_hit;
+        result->cache_misses    = msp->st_cache_miss;
+        result->pages_read      = msp->st_page_in;
+        result->pages_written   = msp->st_page_out;
+        result->pages_evicted   = msp->st_ro_evict + msp->st_rw_evict;
+
+        if (ksp != NULL)
+        {
+            result->lock_requests   = ksp->st_nrequests;
+            result->lock_waits      = ksp->st_lock_wait;
+            result->deadlocks       = ksp->st_ndeadlocks;
+            result->lock_timeouts   = ksp->st_nlocktimeouts + ksp->st_ntxntimeouts;
+            result->locks           = ksp->st_nlocks;
+            result->lockers         = ksp->st_nlockers;
+        }
+
+        if (lsp != NULL)
+        {
+            result->log_records     = lsp->st_record;
+            result->log_bytes       = (uint64_t) lsp->st_w_mbytes * 1024 * 1024 + lsp->st_w_bytes;
+            result->log_writes      = lsp->st_wcount;
+            result->log_syncs       = lsp->st_scount;
+        }
+
+        if (tsp != NULL)
+        {
+            result->txn_begins      = tsp->st_nbegins;
+            result->txn_commits     = tsp->st_ncommits;
+            result->txn_aborts      = tsp->st_naborts;
+            result->txn_active      = tsp->st_nactive;
+        }
+    }
+
+    bdb::free(msp);
+    bdb::free(ksp);
+    bdb::free(lsp);
+    bdb::free(tsp);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::stats] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::stats] cache hits/misses = " << result->cache_hits << "/" << result->cache_misses);
+    LOG4CPLUS_TRACE(logger, "[bdb::database::stats] EXIT");
+}
+
+/**
+ * Returns split of memory budget of the database (see "bdb::database_options::memory_budget").
+ * All the counters are "0", if the database has no budget.
+ */
+void database::stats (budget_stats * result)    /**< [out] Statistics of the budget. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::stats] ENTER");
+
+    if (m_governor != NULL)
+    {
+        m_governor->stats(result);
+    }
+    else
+    {
+        memset(result, 0, sizeof(budget_stats));
     }
 
-    LOG4CPLUS_TRACE(logger, "[bdb::database::rollback_transaction] EXIT");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::stats] cache bytes/limit = " << result->cache_bytes << "/" << result->cache_limit);
+    LOG4CPLUS_TRACE(logger, "[bdb::database::stats] EXIT");
+}
+
+/**
+ * Saves snapshot of the cache into the database, so the cache can be warmed after restart (see "bdb::database::warm_cache").
+ * Berkeley DB doesn't expose the list of cached pages, so the snapshot keeps heat of each database file
+ * (number of its page accesses since the environment has been opened), which is the best measure of its share in the cache.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void database::save_cache_snapshot ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::save_cache_snapshot] ENTER");
+
+    DB_MPOOL_STAT   *  gsp = NULL;
+    DB_MPOOL_FSTAT  ** fsp = NULL;
+    DB              *  snapshot = NULL;
+
+    u_int32_t    removed = 0;
+    unsigned int saved   = 0;
+
+    int res = m_env->memp_stat(m_env, &gsp, &fsp, 0);
+
+    if (res == 0) res = db_create(&snapshot, m_env, 0);
+    if (res == 0) res = open_file(snapshot, NULL, CACHE_SNAPSHOT, "__cache", DB_BTREE, DB_THREAD | DB_CREATE | DB_AUTO_COMMIT);
+    if (res == 0) res = snapshot->truncate(snapshot, NULL, &removed, 0);
+
+    for (DB_MPOOL_FSTAT ** f = fsp; res == 0 && f != NULL && *f != NULL; f++)
+    {
+        const char * name = (*f)->file_name;
+
+        // internal databases of the library are not warmed
+        if (name == NULL || strncmp(name, "__", 2) == 0) continue;
+
+        uint64_t heat = (uint64_t) ((*f)->st_cache_hit + (*f)->st_cache_miss);
+
+        if (heat == 0) continue;
+
+        DBT k, d;
+
+        memset(&k, 0, sizeof(DBT));
+        memset(&d, 0, sizeof(DBT));
+
+        k.data = (void *) name;
+        k.size = (u_int32_t) strlen(name);
+        d.data = &heat;
+        d.size = sizeof(uint64_t);
+
+        res = snapshot->put(snapshot, NULL, &k, &d, 0);
+
+        if (res == 0) saved++;
+    }
+
+    if (snapshot != NULL) snapshot->close(snapshot, 0);
+
+    bdb::free(gsp);
+    bdb::free(fsp);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::save_cache_snapshot] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::save_cache_snapshot] EXIT = " << saved);
+}
+
+/**
+ * Warms the cache by saved snapshot (see "bdb::database::save_cache_snapshot"), prefetching pages of hot files
+ * in parallel, until the cache is full. Each file is read sequentially, so the pages are read by large reads
+ * of the file system. Only files of opened tables and indexes are warmed (lazily opened tables, which are not
+ * used yet, are skipped), so the cache should be warmed after the tables are added.
+ *
+ * @return Number of prefetched pages ("0" if there is no snapshot).
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+unsigned int database::warm_cache (unsigned int nthreads)   /**< [in] Number of prefetching tasks, run by shared work pool ("0" - one task). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::warm_cache] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::warm_cache] threads = " << nthreads);
+
+    if (nthreads == 0) nthreads = 1;
+
+    vector <std::pair <uint64_t, string> > heats;
+
+    DB  * snapshot = NULL;
+    DBC * cursor   = NULL;
+
+    int res = db_create(&snapshot, m_env, 0);
+    if (res == 0) res = open_file(snapshot, NULL, CACHE_SNAPSHOT, "__cache", DB_BTREE, DB_THREAD);
+    if (res == 0) res = snapshot->cursor(snapshot, NULL, &cursor, 0);
+
+    while (res == 0)
+    {
+        DBT k, d;
+
+        memset(&k, 0, sizeof(DBT));
+        memset(&d, 0, sizeof(DBT));
+
+        res = cursor->get(cursor, &k, &d, DB_NEXT);
+
+        if (res == 0 && d.size == sizeof(uint64_t))
+        {
+            uint64_t heat;
+            memcpy(&heat, d.data, sizeof(uint64_t));
+
+            heats.push_back(std::make_pair(heat, string((const char *) k.data, k.size)));
+        }
+    }
+
+    if (cursor   != NULL) cursor->close(cursor);
+    if (snapshot != NULL) snapshot->close(snapshot, 0);
+
+    if (res != DB_NOTFOUND && res != ENOENT)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::warm_cache] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    std::stable_sort(heats.begin(), heats.end(), hotter);
+
+    // the cache is filled up to its size
+    DB_MPOOL_STAT * gsp = NULL;
+
+    res = m_env->memp_stat(m_env, &gsp, NULL, 0);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::warm_cache] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    cache_warmup warmup((uint64_t) gsp->st_gbytes * 1024 * 1024 * 1024 + gsp->st_bytes);
+
+    bdb::free(gsp);
+
+    for (size_t i = 0; i < heats.size(); i++)
+    {
+        for (size_t j = 0; j < m_tables.size(); j++)
+        {
+            table * tbl = m_tables[j];
+
+            if (tbl->m_lazy) continue;
+
+            if (tbl->get_filename() == heats[i].second)
+            {
+                warmup.files.push_back(tbl->m_db);
+            }
+
+            for (size_t n = 0; n < tbl->m_indexes.size(); n++)
+            {
+                if (tbl->m_indexes[n]->get_filename() == heats[i].second)
+                {
+                    warmup.files.push_back(tbl->m_indexes[n]->m_db);
+                }
+            }
+        }
+    }
+
+    {
+        task_group tasks(m_pool);
+
+        for (unsigned int i = 0; i < nthreads; i++)
+        {
+            tasks.run(cache_warmup::run, &warmup);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::warm_cache] EXIT = " << warmup.pages);
+
+    return warmup.pages;
+}
+
+/**
+ * Sets threshold of slow operations. Operations of tables, recordsets and transactions of the database,
+ * taking longer than the threshold, are reported one record per operation (see "bdb::slow_operation")
+ * to specified handler, or logged as warnings to "BDB_SLOW_LOGGER_PORT" logging port if there is no handler.
+ * The handler should be changed while no operations are in progress.
+ */
+void database::set_slow_threshold (unsigned int   threshold,    /**< [in] Threshold, in microseconds ("0" - disabled). */
+                                   slow_callback  fn_slow,      /**< [in] Handler of slow operations ("NULL" - logging). */
+                                   void         * param)        /**< [in] Parameter of the handler.                     */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::set_slow_threshold] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::set_slow_threshold] threshold = " << threshold);
+
+    m_slow = 0;
+
+    m_slow_callback = fn_slow;
+    m_slow_param    = param;
+
+    m_slow = (uint64_t) threshold * 1000;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::set_slow_threshold] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns number of active nested transactions of the calling thread.
+ */
+unsigned int database::txn_depth ()
+{
+    txn_stack * txns = m_txns->local.get();
+
+    return (txns == NULL ? 0 : (unsigned int) txns->size());
+}
+
+/**
+ * Returns specified transaction, or current transaction of the calling thread if "txn" is "NULL".
+ * If the thread has no active transactions, then the top-level transaction is returned.
+ */
+DB_TXN * database::get_transaction (transaction * txn)  /**< [in] Explicit transaction (can be "NULL"). */
+{
+    if (txn != NULL)
+    {
+        return txn->m_txn;
+    }
+
+    txn_stack * txns = m_txns->local.get();
+
+    if (txns == NULL || txns->empty()) return m_txn;
+
+    // pending savepoint begins its nested transaction
+    if (txns->top() == NULL)
+    {
+        DB_TXN * parent = txns->parent();
+        DB_TXN * child  = NULL;
+
+        int res = begin_txn(parent != NULL ? parent : m_txn, &child, BDB_DURABILITY_DEFAULT);
+
+        if (res != 0)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::database::get_transaction] " << db_strerror(res));
+            if (child != NULL) abort_txn(child);
+            throw exception(BDB_ERROR_UNKNOWN);
+        }
+
+        txns->pop();
+        txns->push(child);
+    }
+
+    return txns->top();
+}
+
+/**
+ * Opens database of cached and autonomous sequences on first use, where records are never locked
+ * by the top-level transaction. Returns error code of Berkeley DB.
+ */
+int database::open_autonomous ()
+{
+    if (m_seqc != NULL) return 0;
+
+    int res = db_create(&m_seqc, m_env, 0);
+    if (res == 0) res = open_file(m_seqc, NULL, "__seqc.db", "__seqc", DB_BTREE, DB_THREAD | DB_CREATE | DB_AUTO_COMMIT);
+
+    if (res != 0)
+    {
+        if (m_seqc != NULL) m_seqc->close(m_seqc, 0);
+        m_seqc = NULL;
+    }
+
+    return res;
+}
+
+/**
+ * Returns current transaction of the thread's own stack ("NULL" if the thread has no active transactions),
+ * so cursors of the transaction can be cached by the thread (see "bdb::database::open_cursor").
+ */
+DB_TXN * database::local_transaction ()
+{
+    txn_stack * txns = m_txns->local.get();
+
+    return (txns == NULL || txns->empty()) ? NULL : get_transaction();
+}
+
+/**
+ * Opens Berkeley DB database of specified file. Databases of in-memory environment have no files,
+ * so they are named by both the file and the database name ("file/name").
+ * Flags of transactional opening are dropped in concurrent data store, and files of read-only database
+ * are opened read-only ("DB_RDONLY"), and are never created.
+ */
+int database::open_file (DB           * db,     /**< [in] Database handle.                    */
+                         DB_TXN       * txn,    /**< [in] Transaction to use (can be "NULL"). */
+                         const string & file,   /**< [in] Name of the file.                   */
+                         const string & name,   /**< [in] Name of the database in the file.   */
+                         int            type,   /**< [in] Type of the database ("DBTYPE").    */
+                         u_int32_t      flags)  /**< [in] Flags of the opening.               */
+{
+    if (m_concurrent) flags &= ~(DB_AUTO_COMMIT | DB_MULTIVERSION);
+
+    // files of read-only database must exist (e.g. indexes, built offline)
+    if (m_readonly) flags = (flags & ~(DB_CREATE | DB_EXCL)) | DB_RDONLY;
+
+    if (m_memory)
+    {
+        return db->open(db, txn, NULL, (file + "/" + name).c_str(), (DBTYPE) type, flags, 0);
+    }
+
+    return db->open(db, txn, file.c_str(), name.c_str(), (DBTYPE) type, flags, 0);
+}
+
+/**
+ * Removes specified file with all its databases, or specified in-memory database (see "bdb::database::open_file").
+ */
+int database::remove_file (DB_TXN       * txn,   /**< [in] Transaction to use (can be "NULL"). */
+                           const string & file,  /**< [in] Name of the file.                   */
+                           const string & name)  /**< [in] Name of the database in the file.   */
+{
+    if (m_memory)
+    {
+        return m_env->dbremove(m_env, txn, NULL, (file + "/" + name).c_str(), 0);
+    }
+
+    return m_env->dbremove(m_env, txn, file.c_str(), NULL, 0);
+}
+
+/**
+ * Renames specified database with its file, or specified in-memory database (see "bdb::database::open_file").
+ */
+int database::rename_file (DB_TXN       * txn,      /**< [in] Transaction to use (can be "NULL"). */
+                           const string & file,     /**< [in] Name of the file.                   */
+                           const string & name,     /**< [in] Name of the database in the file.   */
+                           const string & newfile,  /**< [in] New name of the file.               */
+                           const string & newname)  /**< [in] New name of the database.           */
+{
+    if (m_memory)
+    {
+        return m_env->dbrename(m_env, txn, NULL, (file + "/" + name).c_str(), (newfile + "/" + newname).c_str(), 0);
+    }
+
+    int res = m_env->dbrename(m_env, txn, file.c_str(), name.c_str(), newname.c_str(), 0);
+
+    if (res == 0) res = m_env->dbrename(m_env, txn, file.c_str(), NULL, newfile.c_str(), 0);
+
+    return res;
+}
+
+/**
+ * Returns flags of cursors, which change records ("DB_WRITECURSOR" in concurrent data store).
+ */
+u_int32_t database::write_flags ()
+{
+    return (m_concurrent ? DB_WRITECURSOR : 0);
+}
+
+/**
+ * Begins new transaction with specified durability policy.
+ * Returns error code of Berkeley DB.
+ */
+int database::begin_txn (DB_TXN  * parent,      /**< [in]  Parent transaction (can be "NULL").              */
+                         DB_TXN ** txn,         /**< [out] New transaction.                                 */
+                         int       durability,  /**< [in]  Durability policy (see @ref durability "codes"). */
+                         int       flags)       /**< [in]  Flags of the transaction (see @ref txnflags "flags"). */
+{
+    if (durability == BDB_DURABILITY_DEFAULT) durability = m_durability;
+
+    u_int32_t f = durability_flags(durability);
+
+    f |= (flags & BDB_TXN_SNAPSHOT) ? DB_TXN_SNAPSHOT : DB_READ_COMMITTED;
+
+    if (flags & BDB_TXN_NOWAIT) f |= DB_TXN_NOWAIT;
+
+    int res = m_env->txn_begin(m_env, parent, txn, f);
+
+    if (res == 0 && m_notifier != NULL && m_notifier->active()) m_notifier->begin(*txn, parent);
+
+    return res;
+}
+
+/**
+ * Commits specified transaction with specified durability policy.
+ * Nested transactions are just merged into their parents, so the log is flushed for top-level ones only.
+ * Returns error code of Berkeley DB.
+ */
+int database::commit_txn (DB_TXN * txn,         /**< [in] Transaction to be committed.                     */
+                          int      durability,  /**< [in] Durability policy (see @ref durability "codes"). */
+                          bool     nested)      /**< [in] Whether the transaction has a parent.            */
+{
+    latency_scope latency(BDB_LATENCY_COMMIT);
+    slow_scope    slow(this, BDB_LATENCY_COMMIT, "");
+
+    if (durability == BDB_DURABILITY_DEFAULT) durability = m_durability;
+
+    // cursors must be closed before the transaction is resolved
+    if (m_cursors != NULL) m_cursors->release(txn);
+
+    int res = txn->commit(txn, nested ? 0 : durability_flags(durability));
+
+    // changes of failed commit are aborted
+    if (m_notifier != NULL && m_notifier->active())
+    {
+        if (res == 0) m_notifier->commit(txn, m_txn);
+        else          m_notifier->abort(txn);
+    }
+
+    if (res == 0 && !nested && durability == BDB_DURABILITY_GROUP)
+    {
+        res = m_group->flush(m_env);
+    }
+
+    return res;
+}
+
+/**
+ * Returns flags of Berkeley DB read operations for specified transaction.
+ * Reads in snapshot transactions inherit their isolation, while others read committed data only.
+ */
+u_int32_t database::read_flags (transaction * txn)  /**< [in] Explicit transaction (can be "NULL"). */
+{
+    if (m_concurrent) return 0;
+
+    return (txn != NULL && (txn->m_flags & BDB_TXN_SNAPSHOT)) ? 0 : DB_READ_COMMITTED;
+}
+
+/**
+ * Configures sites of replication group, and starts replication manager in the role of the database.
+ * Returns error code of Berkeley DB.
+ */
+int database::start_replication (const database_options & options)    /**< [in] Tuning options of the environment. */
+{
+    string host;
+    u_int  port;
+
+    if (!parse_site(options.repl_local, &host, &port)) return EINVAL;
+
+    m_env->app_private = this;
+
+    int res = m_env->set_event_notify(m_env, on_event);
+
+    if (res == 0) res = m_env->rep_set_priority(m_env, options.repl_priority);
+
+#ifdef BDB_REPMGR_SITE
+    DB_SITE * site = NULL;
+
+    if (res == 0) res = m_env->repmgr_site(m_env, host.c_str(), port, &site, 0);
+    if (res == 0) res = site->set_config(site, DB_LOCAL_SITE, 1);
+    if (site != NULL) site->close(site);
+#else
+    if (res == 0) res = m_env->repmgr_set_local_site(m_env, host.c_str(), port, 0);
+#endif
+
+    for (const char ** remote = options.repl_remote; remote != NULL && *remote != NULL && res == 0; remote++)
+    {
+        if (!parse_site(*remote, &host, &port)) return EINVAL;
+
+#ifdef BDB_REPMGR_SITE
+        site = NULL;
+
+        res = m_env->repmgr_site(m_env, host.c_str(), port, &site, 0);
+        if (res == 0) res = site->set_config(site, DB_BOOTSTRAP_HELPER, 1);
+        if (site != NULL) site->close(site);
+#else
+        res = m_env->repmgr_add_remote_site(m_env, host.c_str(), port, NULL, 0);
+#endif
+    }
+
+    int threads = (options.repl_threads != 0 ? (int) options.repl_threads : 1);
+
+    if (res == 0) res = m_env->repmgr_start(m_env, threads, replication_flags(options.repl_role));
+
+    return res;
+}
+
+/**
+ * Tracks the role of the site, changed by elections in replication group ("DB_ENV->set_event_notify").
+ */
+void database::on_event (DB_ENV    * env,   /**< [in] Environment of the database. */
+                         u_int32_t   event, /**< [in] Event of Berkeley DB.        */
+                         void      *)       /**< [in] Information of the event.    */
+{
+    database * db = (database *) env->app_private;
+
+    if (event == DB_EVENT_REP_MASTER)
+    {
+        LOG4CPLUS_DEBUG(logger, "[bdb::database::on_event] The site became the master of replication group.");
+        db->m_role = BDB_REPL_MASTER;
+    }
+    else if (event == DB_EVENT_REP_CLIENT)
+    {
+        LOG4CPLUS_DEBUG(logger, "[bdb::database::on_event] The site became a client of replication group.");
+        db->m_role = BDB_REPL_CLIENT;
+    }
+}
+
+/**
+ * Begins own transaction of an operation, which consists of several Berkeley DB calls and has no
+ * transaction at all (auto-commit mode), so the calls are committed together.
+ * Returns error code of Berkeley DB.
+ */
+int database::begin_auto (DB_TXN ** txn,    /**< [in/out] Transaction of the operation.              */
+                          DB_TXN ** own)    /**< [out]    Own transaction ("NULL" if it's not needed). */
+{
+    *own = NULL;
+
+    // concurrent data store has no transactions, and each operation is atomic on its own
+    if (*txn != NULL || m_concurrent) return 0;
+
+    int res = begin_txn(NULL, own, BDB_DURABILITY_DEFAULT);
+
+    if (res == 0) *txn = *own;
+
+    return res;
+}
+
+/**
+ * Completes own transaction of an operation (see "database::begin_auto").
+ * The transaction is committed if the operation succeeded, and is aborted otherwise.
+ * Returns error code of Berkeley DB.
+ */
+int database::end_auto (DB_TXN * own,   /**< [in] Own transaction (can be "NULL").  */
+                        int      res)   /**< [in] Result of the operation.          */
+{
+    if (own == NULL) return res;
+
+    if (res != 0)
+    {
+        abort_txn(own);
+        return res;
+    }
+
+    return commit_txn(own, BDB_DURABILITY_DEFAULT, false);
 }
 
 }
@@ -0,0 +1,557 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/deferred.cc
+ * Contains implementation of class "bdb::index_applier", and of deferred indexes of class "bdb::index".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Boost C++ Libraries
+#include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::index_applier".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::string;
+using std::vector;
+
+using boost::get_system_time;
+using boost::posix_time::milliseconds;
+
+/** @private Period of polling of change log for changes of deferred indexes (in milliseconds). */
+static const long DEFERRED_POLL_PERIOD = 10;
+
+/** @private Maximum number of changes, applied to deferred index in one transaction. */
+static const unsigned int DEFERRED_BATCH = 1024;
+
+/** @private Key of the position of deferred index in change log. */
+static const char DEFERRED_POSITION[] = "applied";
+
+/** @private Change of deferred index. */
+class deferred_change
+{
+public:
+
+    deferred_change (const string & index_key, const string & primary_key, bool is_put)
+      : skey(index_key), pkey(primary_key), put(is_put) { }
+
+    string  skey;   /**< Index key.                                   */
+    string  pkey;   /**< Primary key.                                 */
+    bool    put;    /**< Whether the entry is added (or removed).     */
+};
+
+/** @private Order of changes of deferred index by index keys (changes of equal keys keep their order). */
+class deferred_less
+{
+public:
+
+    deferred_less (table * tbl) : m_table(tbl) { }
+
+    bool operator () (const deferred_change & c1, const deferred_change & c2) const
+    {
+        DBT d1, d2;
+
+        memset(&d1, 0, sizeof(DBT));
+        memset(&d2, 0, sizeof(DBT));
+
+        d1.data = (void *) c1.skey.data();
+        d1.size = (u_int32_t) c1.skey.size();
+        d2.data = (void *) c2.skey.data();
+        d2.size = (u_int32_t) c2.skey.size();
+
+        return m_table->compare_keys(&d1, &d2) < 0;
+    }
+
+protected:
+
+    table * m_table;
+};
+
+/** @private Deferred indexes, and applying thread of index applier. */
+class applier_state
+{
+public:
+
+    applier_state () : stop(false), thread(NULL) { }
+
+    boost::mutex                busy;       /**< Held while changes are applied (so indexes are not closed meanwhile). */
+    boost::mutex                mutex;      /**< Guards all the fields below.                           */
+    boost::condition_variable   cond;       /**< Signals stop, and completed rounds of applying.        */
+    bool                        stop;       /**< Whether the applying thread should stop.               */
+    vector <index *>            indexes;    /**< Deferred indexes.                                      */
+    boost::thread             * thread;     /**< Applying thread ("NULL" if not started).               */
+
+    /** Body of applying thread. */
+    void run ()
+    {
+        for (;;)
+        {
+            bool applied = false;
+
+            {
+                boost::mutex::scoped_lock guard(busy);
+
+                vector <index *> all;
+
+                {
+                    boost::mutex::scoped_lock lock(mutex);
+                    if (stop) break;
+                    all = indexes;
+                }
+
+                for (size_t i = 0; i < all.size(); i++)
+                {
+                    uint64_t before = all[i]->m_applied;
+
+                    int res = all[i]->apply_deferred();
+
+                    // deadlocked batch is retried on the next round
+                    if (res != 0 && res != DB_LOCK_DEADLOCK && res != DB_LOCK_NOTGRANTED)
+                    {
+                        LOG4CPLUS_WARN(logger, "[bdb::index_applier::run] " << db_strerror(res));
+                    }
+
+                    applied = applied || (all[i]->m_applied != before);
+                }
+            }
+
+            boost::mutex::scoped_lock lock(mutex);
+
+            cond.notify_all();
+
+            // the log is polled again at once, while there are changes to apply
+            if (!applied && !stop) cond.timed_wait(lock, get_system_time() + milliseconds(DEFERRED_POLL_PERIOD));
+
+            if (stop) break;
+        }
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Creates index applier with no indexes.
+ */
+index_applier::index_applier (database *)
+{
+    m_state = new applier_state;
+    assert(m_state != NULL);
+}
+
+/**
+ * Stops applying thread (if it's running).
+ */
+index_applier::~index_applier () throw ()
+{
+    shutdown();
+    delete m_state;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds deferred index, and starts applying thread, if it's not running.
+ */
+void index_applier::add (index * idx)   /**< [in] Deferred index. */
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    m_state->indexes.push_back(idx);
+
+    if (m_state->thread == NULL && !m_state->stop)
+    {
+        m_state->thread = new boost::thread(boost::bind(&applier_state::run, m_state));
+    }
+}
+
+/**
+ * Removes deferred index (e.g. when it's closed), waiting for completion of applying its changes.
+ */
+void index_applier::remove (index * idx)    /**< [in] Deferred index. */
+{
+    boost::mutex::scoped_lock guard(m_state->busy);
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    vector <index *>::iterator i = std::find(m_state->indexes.begin(), m_state->indexes.end(), idx);
+
+    if (i != m_state->indexes.end()) m_state->indexes.erase(i);
+}
+
+/**
+ * Stops applying thread (if it's running). Changes are not applied any longer.
+ */
+void index_applier::shutdown ()
+{
+    boost::thread * thread = NULL;
+
+    {
+        boost::mutex::scoped_lock lock(m_state->mutex);
+
+        m_state->stop = true;
+        m_state->cond.notify_all();
+
+        thread = m_state->thread;
+        m_state->thread = NULL;
+    }
+
+    if (thread != NULL)
+    {
+        thread->join();
+        delete thread;
+    }
+}
+
+/**
+ * Waits until changes up to specified sequence number (exclusive) are applied to specified index.
+ *
+ * @return true  - the changes are applied.
+ * @return false - the timeout is expired (or the changes can't be applied any longer).
+ */
+bool index_applier::wait (index        * idx,       /**< [in] Deferred index.                           */
+                          uint64_t       sequence,  /**< [in] Sequence number of the first change, which is not waited for. */
+                          unsigned int   timeout)   /**< [in] Timeout, in milliseconds ("0" - don't wait at all). */
+{
+    boost::system_time deadline = get_system_time() + milliseconds(timeout);
+
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    while (idx->m_applied < sequence && !m_state->stop)
+    {
+        if (timeout == 0 || !m_state->cond.timed_wait(lock, deadline)) break;
+    }
+
+    return (idx->m_applied >= sequence);
+}
+
+/**
+ * Returns the least sequence number of the next change to apply of all deferred indexes
+ * ("UINT64_MAX" if there are none), so changes before it are not needed any longer.
+ */
+uint64_t index_applier::min_applied () const
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    uint64_t least = ~(uint64_t) 0;
+
+    for (size_t i = 0; i < m_state->indexes.size(); i++)
+    {
+        if (m_state->indexes[i]->m_applied < least) least = m_state->indexes[i]->m_applied;
+    }
+
+    return least;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of deferred indexes of class "bdb::index".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Waits until changes of the table, which are committed before the call, are applied to deferred index
+ * (e.g. before a read, which needs fresh index). Non-deferred index is always applied.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return true  - the changes are applied.
+ * @return false - the timeout is expired.
+ */
+bool index::wait_applied (unsigned int timeout)     /**< [in] Timeout, in milliseconds ("0" - don't wait at all). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::index::wait_applied] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::index::wait_applied] timeout = " << timeout);
+
+    if (m_position == NULL)
+    {
+        LOG4CPLUS_TRACE(logger, "[bdb::index::wait_applied] EXIT");
+        return true;
+    }
+
+    uint64_t last = 0;
+
+    int res = m_database->last_change(&last);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::index::wait_applied] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    bool applied = m_database->m_applier->wait(this, last + 1, timeout);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::index::wait_applied] EXIT = " << applied);
+
+    return applied;
+}
+
+/**
+ * Opens position of deferred index, which is stored in the same file as the index, and registers the index
+ * in index applier of the database. Changes are written through plain handle of the index (see "index::open_plain"). Changes of the table are captured into change
+ * log of the database, and are applied to the index from its position. Position of new index is the end of
+ * the log, since the index is just built from all records of the table.
+ * Returns error code of Berkeley DB.
+ */
+int index::open_deferred (table * tbl)  /**< [in] Master table. */
+{
+    DB_TXN * txn = m_database->get_transaction();
+
+    int res = m_database->open_changes();
+
+    if (res == 0) res = db_create(&m_position, tbl->m_db->get_env(tbl->m_db), 0);
+    if (res == 0) res = m_database->open_file(m_position, txn, get_filename(), m_name + ".applied", DB_BTREE, DB_THREAD | DB_CREATE);
+
+    uint64_t applied = 0;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.data  = (void *) DEFERRED_POSITION;
+    k.size  = sizeof(DEFERRED_POSITION) - 1;
+    d.data  = &applied;
+    d.ulen  = sizeof(applied);
+    d.size  = sizeof(applied);
+    d.flags = DB_DBT_USERMEM;
+
+    if (res == 0) res = m_position->get(m_position, txn, &k, &d, 0);
+
+    if (res == DB_NOTFOUND)
+    {
+        res = m_database->last_change(&applied);
+        applied++;
+
+        if (res == 0) res = m_position->put(m_position, txn, &k, &d, 0);
+    }
+
+    if (res == 0)
+    {
+        m_applied = applied;
+
+        // the index itself never captures changes
+        m_options.capture_changes      = false;
+        tbl->m_options.capture_changes = true;
+
+        m_database->m_applier->add(this);
+    }
+
+    return res;
+}
+
+/**
+ * Applies the next batch of captured changes of the table to deferred index, in one transaction together
+ * with the new position of the index. Changes of the batch are applied in order of index keys, so pages
+ * of the index are visited sequentially.
+ * Returns error code of Berkeley DB.
+ */
+int index::apply_deferred ()
+{
+    latency_scope berkeley(BDB_LATENCY_BERKELEY);
+
+    change_stream stream(m_database, m_applied);
+
+    vector <deferred_change> changes;
+    vector <string> oldkeys, newkeys;
+
+    change_record change;
+
+    int res = 0;
+
+    for (unsigned int n = 0; n < DEFERRED_BATCH && res == 0; n++)
+    {
+        res = stream.read_change(&change);
+
+        if (res != 0) break;
+
+        stream.m_next = change.sequence + 1;
+
+        if (change.table != m_master->m_name) continue;
+
+        oldkeys.clear();
+        newkeys.clear();
+
+        if (change.operation != BDB_CHANGE_INSERT) res = make_keys(change.key, change.olddata, &oldkeys);
+        if (change.operation != BDB_CHANGE_REMOVE && res == 0) res = make_keys(change.key, change.newdata, &newkeys);
+
+        // entries, which keys are not changed, are left as they are
+        for (size_t i = 0; i < oldkeys.size() && res == 0; i++)
+        {
+            if (std::find(newkeys.begin(), newkeys.end(), oldkeys[i]) == newkeys.end()) changes.push_back(deferred_change(oldkeys[i], change.key, false));
+        }
+
+        for (size_t i = 0; i < newkeys.size() && res == 0; i++)
+        {
+            if (std::find(oldkeys.begin(), oldkeys.end(), newkeys[i]) == oldkeys.end()) changes.push_back(deferred_change(newkeys[i], change.key, true));
+        }
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (res != 0 || stream.m_next == m_applied) return res;
+
+    std::stable_sort(changes.begin(), changes.end(), deferred_less(this));
+
+    DB_TXN * txn = m_database->get_transaction();
+    DB_TXN * own = NULL;
+
+    res = m_database->begin_auto(&txn, &own);
+
+    DBC * cursor = NULL;
+
+    if (res == 0 && !changes.empty()) res = m_plain->cursor(m_plain, txn, &cursor, m_database->write_flags());
+
+    for (size_t i = 0; i < changes.size() && res == 0; i++)
+    {
+        DBT k, d;
+        memset(&k, 0, sizeof(DBT));
+        memset(&d, 0, sizeof(DBT));
+
+        k.data = (void *) changes[i].skey.data();
+        k.size = (u_int32_t) changes[i].skey.size();
+        d.data = (void *) changes[i].pkey.data();
+        d.size = (u_int32_t) changes[i].pkey.size();
+
+        if (changes[i].put)
+        {
+            // the entry can exist already, if the index is built after the change
+            res = m_plain->put(m_plain, txn, &k, &d, DB_NODUPDATA);
+            if (res == DB_KEYEXIST) res = 0;
+        }
+        else
+        {
+            res = cursor->get(cursor, &k, &d, DB_GET_BOTH | DB_RMW);
+            if (res == 0) res = cursor->del(cursor, 0);
+            if (res == DB_NOTFOUND) res = 0;
+        }
+    }
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    uint64_t applied = stream.m_next;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.data = (void *) DEFERRED_POSITION;
+    k.size = sizeof(DEFERRED_POSITION) - 1;
+    d.data = &applied;
+    d.size = sizeof(applied);
+
+    if (res == 0) res = m_position->put(m_position, txn, &k, &d, 0);
+
+    res = m_database->end_auto(own, res);
+
+    if (res == 0) m_applied = applied;
+
+    return res;
+}
+
+/**
+ * Makes index keys of specified record by indexing function of the index.
+ * Returns error code of Berkeley DB.
+ */
+int index::make_keys (const string    & pkey,   /**< [in]  Serialized primary key.  */
+                      const string    & pdata,  /**< [in]  Serialized primary data. */
+                      vector <string> * keys)   /**< [out] Index keys.              */
+{
+    DBT k, d, r;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+    memset(&r, 0, sizeof(DBT));
+
+    k.data = (void *) pkey.data();
+    k.size = (u_int32_t) pkey.size();
+    d.data = (void *) pdata.data();
+    d.size = (u_int32_t) pdata.size();
+
+    int res = m_indexer(m_db, &k, &d, &r);
+
+    if (res == DB_DONOTINDEX) return 0;
+    if (res != 0) return res;
+
+    if (r.flags & DB_DBT_MULTIPLE)
+    {
+        DBT * all = (DBT *) r.data;
+
+        for (u_int32_t i = 0; i < r.size; i++)
+        {
+            keys->push_back(string((const char *) all[i].data, all[i].size));
+            if (all[i].flags & DB_DBT_APPMALLOC) free(all[i].data);
+        }
+    }
+    else
+    {
+        keys->push_back(string((const char *) r.data, r.size));
+    }
+
+    if (r.flags & DB_DBT_APPMALLOC) free(r.data);
+
+    return 0;
+}
+
+/**
+ * Indexing callback of deferred indexes, which are changed by index applier only (see "index::apply_deferred").
+ */
+int index::index_deferred (DB *, const DBT *, const DBT *, DBT *)
+{
+    return DB_DONOTINDEX;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,390 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+
+/** @file bdb/src/dump.cc
+ * Contains implementation of binary dumps of tables.
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cerrno>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Protocol Buffers
+#include <google/protobuf/io/coded_stream.h>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of binary dumps of tables.
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::string;
+using std::vector;
+
+using google::protobuf::uint8;
+using google::protobuf::uint32;
+using google::protobuf::io::CodedOutputStream;
+
+/**
+ * @private Signature of a dump. The dump is a sequence of blocks, each is prefixed by its size (varint)
+ * and by a flag of compression (one byte), and it ends with an empty block. Block contains records, each
+ * is its serialized key and its serialized data, prefixed by their sizes (varints).
+ */
+static const char DUMP_MAGIC[] = { 'B', 'D', 'B', 'D', 'U', 'M', 'P', '1' };
+
+/** @private Size of a block of records, after which the block is written. */
+static const size_t DUMP_BLOCK_SIZE = 64 * 1024;
+
+/** @private Size of bulk buffer of a dump, in bytes (see "DB_MULTIPLE_KEY"). */
+static const u_int32_t DUMP_BULK_SIZE = 1024 * 1024;
+
+/** @private Bulk buffers must be a multiple of this size (see "DB_MULTIPLE_KEY"). */
+static const u_int32_t DUMP_BULK_ALIGNMENT = 1024;
+
+/** @private Flag of block, which is compressed by the codec of values (see "bdb::set_codec"). */
+static const uint8 DUMP_COMPRESSED = 1;
+
+/**
+ * @private Appends varint of specified value to the block.
+ */
+static void append_varint (string * block,  /**< [in,out] Block of records. */
+                           uint32   value)  /**< [in]     Value to append.  */
+{
+    uint8 buffer[5];
+    uint8 * end = CodedOutputStream::WriteVarint32ToArray(value, buffer);
+
+    block->append((const char *) buffer, end - buffer);
+}
+
+/**
+ * @private Reads varint, starting at specified position.
+ * Returns "false", if the varint is malformed.
+ */
+static bool take_varint (const uint8 ** pos,    /**< [in,out] Current position.   */
+                         const uint8  * end,    /**< [in]     End of the buffer.  */
+                         uint32       * value)  /**< [out]    Value of varint.    */
+{
+    *value = 0;
+
+    for (int shift = 0; shift < 35 && *pos < end; shift += 7)
+    {
+        uint8 byte = *(*pos)++;
+
+        *value |= (uint32) (byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0) return true;
+    }
+
+    return false;
+}
+
+/**
+ * @private Reads varint from the stream.
+ * Returns "false", if the stream is over, or the varint is malformed.
+ */
+static bool read_varint (std::istream & in,     /**< [in]  Input stream.    */
+                         uint32       * value)  /**< [out] Value of varint. */
+{
+    *value = 0;
+
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        int byte = in.get();
+
+        if (byte == std::istream::traits_type::eof()) return false;
+
+        *value |= (uint32) (byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0) return true;
+    }
+
+    return false;
+}
+
+/**
+ * @private Writes specified block of records into the stream, compressing it, if requested.
+ * Returns "false", if the stream fails.
+ */
+static bool write_block (std::ostream & out,        /**< [in] Output stream.                   */
+                         const string & block,      /**< [in] Records of the block.            */
+                         bool           compress)   /**< [in] Whether the block is compressed. */
+{
+    vector <char> packed(compress ? block.size() : 0);
+
+    size_t size = (compress && !block.empty() ? compress_value(block.data(), block.size(), &packed[0]) : 0);
+
+    string header;
+    append_varint(&header, (uint32) (size != 0 ? size : block.size()));
+    header.push_back((char) (size != 0 ? DUMP_COMPRESSED : 0));
+
+    out.write(header.data(), header.size());
+
+    if (size != 0) out.write(&packed[0], size);
+    else           out.write(block.data(), block.size());
+
+    return out.good();
+}
+
+/**
+ * Writes all records of specified table into the stream, as their serialized keys and data, without
+ * parsing of them. Records are read by large bulks, and are written by blocks (optionally compressed
+ * by the codec of values, see "bdb::set_codec"), so the dump is read back at disk speed by "bdb::restore".
+ * Returns number of dumped records.
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - the stream fails, or unknown error.
+ */
+uint64_t dump (table        * tbl,          /**< [in] Dumped table.                                   */
+               std::ostream & out,          /**< [in] Output stream (should be opened in binary mode). */
+               bool           compress,     /**< [in] Whether blocks are compressed by the codec.      */
+               transaction  * txn)          /**< [in] Transaction to use.                             */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::dump] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::dump] compress = " << compress);
+
+    tbl->check_open();
+
+    database * db = tbl->m_database;
+
+    out.write(DUMP_MAGIC, sizeof(DUMP_MAGIC));
+
+    DBC * cursor = NULL;
+
+    vector <char> buffer(DUMP_BULK_SIZE);
+
+    DBT dummy, bulk;
+    memset(&dummy, 0, sizeof(DBT));
+    memset(&bulk,  0, sizeof(DBT));
+
+    dummy.flags = DB_DBT_REALLOC;
+    bulk.data   = &buffer[0];
+    bulk.ulen   = (u_int32_t) buffer.size();
+    bulk.flags  = DB_DBT_USERMEM;
+
+    string   block;
+    uint64_t count = 0;
+
+    int res = tbl->m_db->cursor(tbl->m_db, db->get_transaction(txn), &cursor, db->read_flags(txn));
+
+    while (res == 0)
+    {
+        res = cursor->get(cursor, &dummy, &bulk, DB_NEXT | DB_MULTIPLE_KEY);
+
+        if (res == DB_BUFFER_SMALL)
+        {
+            // a single record doesn't fit into the buffer - enlarge it, and try again
+            buffer.resize((bulk.size + DUMP_BULK_ALIGNMENT - 1) / DUMP_BULK_ALIGNMENT * DUMP_BULK_ALIGNMENT);
+
+            bulk.data = &buffer[0];
+            bulk.ulen = (u_int32_t) buffer.size();
+
+            res = cursor->get(cursor, &dummy, &bulk, DB_NEXT | DB_MULTIPLE_KEY);
+        }
+
+        if (res != 0) break;
+
+        void * ptr;
+        DB_MULTIPLE_INIT(ptr, &bulk);
+
+        for (;;)
+        {
+            void    * kdata, * ddata;
+            u_int32_t ksize,   dsize;
+
+            DB_MULTIPLE_KEY_NEXT(ptr, &bulk, kdata, ksize, ddata, dsize);
+
+            if (ptr == NULL) break;
+
+            append_varint(&block, ksize);
+            block.append((const char *) kdata, ksize);
+            append_varint(&block, dsize);
+            block.append((const char *) ddata, dsize);
+
+            count++;
+
+            if (block.size() < DUMP_BLOCK_SIZE) continue;
+
+            if (!write_block(out, block, compress)) res = EIO;
+            block.clear();
+
+            if (res != 0) break;
+        }
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    free(dummy.data);
+
+    // the last block, and the empty block at the end
+    if (res == 0 && !block.empty() && !write_block(out, block, compress)) res = EIO;
+    if (res == 0 && !write_block(out, string(), false)) res = EIO;
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::dump] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::dump] EXIT = " << count);
+
+    return count;
+}
+
+/**
+ * Adds all records of a dump (see "bdb::dump") to the builder of a table, without parsing of them.
+ * Dumped records are in order of keys, so the builder writes them into the new file at once, even if
+ * it has no memory for sorting; the build is committed by the caller (see "bdb::table_builder::commit").
+ * Returns number of restored records.
+ *
+ * @throw bdb::exception BDB_ERROR_EXISTS  - the same key is already added.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the dump is malformed, or unknown error.
+ */
+uint64_t restore (table_builder * builder,  /**< [in] Builder of the restored table.                 */
+                  std::istream  & in)       /**< [in] Input stream (should be opened in binary mode). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::restore] ENTER");
+
+    char magic[sizeof(DUMP_MAGIC)];
+
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, DUMP_MAGIC, sizeof(DUMP_MAGIC)) != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::restore] Stream is not a dump of a table.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    vector <char> buffer;
+    uint64_t      count = 0;
+
+    for (;;)
+    {
+        uint32 size = 0;
+        int    flag = 0;
+
+        bool valid = read_varint(in, &size) && (flag = in.get()) != std::istream::traits_type::eof();
+
+        if (valid && size != 0)
+        {
+            buffer.resize(size);
+            valid = in.read(&buffer[0], size).good();
+        }
+
+        if (!valid)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::restore] Dump is truncated.");
+            throw exception(BDB_ERROR_UNKNOWN);
+        }
+
+        if (size == 0) break;
+
+        DBT packed;
+        memset(&packed, 0, sizeof(DBT));
+
+        packed.data = &buffer[0];
+        packed.size = size;
+
+        const DBT * plain = (flag == DUMP_COMPRESSED ? plain_value(&packed) : &packed);
+
+        if (flag == DUMP_COMPRESSED && plain == &packed)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::restore] Block of the dump cannot be decompressed.");
+            throw exception(BDB_ERROR_UNKNOWN);
+        }
+
+        const uint8 * pos = (const uint8 *) plain->data;
+        const uint8 * end = pos + plain->size;
+
+        while (pos < end)
+        {
+            uint32 ksize, dsize;
+
+            DBT k, d;
+            memset(&k, 0, sizeof(DBT));
+            memset(&d, 0, sizeof(DBT));
+
+            valid = take_varint(&pos, end, &ksize) && (size_t) (end - pos) >= ksize;
+
+            if (valid)
+            {
+                k.data = (void *) pos;
+                k.size = ksize;
+                pos += ksize;
+
+                valid = take_varint(&pos, end, &dsize) && (size_t) (end - pos) >= dsize;
+            }
+
+            if (!valid)
+            {
+                LOG4CPLUS_WARN(logger, "[bdb::restore] Block of the dump is malformed.");
+                throw exception(BDB_ERROR_UNKNOWN);
+            }
+
+            d.data = (void *) pos;
+            d.size = dsize;
+            pos += dsize;
+
+            builder->add(&k, &d);
+            count++;
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::restore] EXIT = " << count);
+
+    return count;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,384 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/expiry.cc
+ * Contains implementation of class "bdb::expiry_reaper", and of expiration of records of class "bdb::table".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+// Boost C++ Libraries
+#include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::expiry_reaper".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::string;
+using std::vector;
+
+using boost::get_system_time;
+using boost::posix_time::milliseconds;
+
+/** @private Period of looking for expired records, while there are no full batches of them (in milliseconds). */
+static const long EXPIRY_POLL_PERIOD = 1000;
+
+/** @private Maximum number of expired records, removed in one transaction. */
+static const unsigned int EXPIRY_BATCH = 256;
+
+/** @private Suffix of the name of the index of expiration times of a table. */
+static const char EXPIRY_SUFFIX[] = ".expiry";
+
+/** @private First byte of keys of composite index, which field is present ("BDB_KEY_ORDERED"). */
+static const char EXPIRY_PRESENT = 0x01;
+
+/** @private Order of raw primary keys the way the table sorts them. */
+class expiry_less
+{
+public:
+
+    expiry_less (table * tbl) : m_table(tbl) { }
+
+    bool operator () (const string & k1, const string & k2) const
+    {
+        DBT d1, d2;
+
+        memset(&d1, 0, sizeof(DBT));
+        memset(&d2, 0, sizeof(DBT));
+
+        d1.data = (void *) k1.data();
+        d1.size = (u_int32_t) k1.size();
+        d2.data = (void *) k2.data();
+        d2.size = (u_int32_t) k2.size();
+
+        return m_table->compare_keys(&d1, &d2) < 0;
+    }
+
+protected:
+
+    table * m_table;
+};
+
+/** @private Tables with time to live, and removing thread of expiry reaper. */
+class reaper_state
+{
+public:
+
+    reaper_state () : stop(false), thread(NULL) { }
+
+    boost::mutex                busy;       /**< Held while expired records are removed (so tables are not closed meanwhile). */
+    boost::mutex                mutex;      /**< Guards all the fields below.                           */
+    boost::condition_variable   cond;       /**< Signals stop.                                          */
+    bool                        stop;       /**< Whether the removing thread should stop.               */
+    vector <table *>            tables;     /**< Tables with time to live.                              */
+    boost::thread             * thread;     /**< Removing thread ("NULL" if not started).               */
+
+    /** Body of removing thread. */
+    void run ()
+    {
+        for (;;)
+        {
+            bool full = false;
+
+            {
+                boost::mutex::scoped_lock guard(busy);
+
+                vector <table *> all;
+
+                {
+                    boost::mutex::scoped_lock lock(mutex);
+                    if (stop) break;
+                    all = tables;
+                }
+
+                for (size_t i = 0; i < all.size(); i++)
+                {
+                    unsigned int reaped = 0;
+
+                    int res = all[i]->reap_expired(&reaped);
+
+                    // deadlocked batch is retried on the next round
+                    if (res != 0 && res != DB_LOCK_DEADLOCK && res != DB_LOCK_NOTGRANTED)
+                    {
+                        LOG4CPLUS_WARN(logger, "[bdb::expiry_reaper::run] " << db_strerror(res));
+                    }
+
+                    full = full || (reaped == EXPIRY_BATCH);
+                }
+            }
+
+            boost::mutex::scoped_lock lock(mutex);
+
+            // the tables are looked through again at once, while there are full batches of expired records
+            if (!full && !stop) cond.timed_wait(lock, get_system_time() + milliseconds(EXPIRY_POLL_PERIOD));
+
+            if (stop) break;
+        }
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Creates expiry reaper with no tables.
+ */
+expiry_reaper::expiry_reaper (database *)
+{
+    m_state = new reaper_state;
+    assert(m_state != NULL);
+}
+
+/**
+ * Stops removing thread (if it's running).
+ */
+expiry_reaper::~expiry_reaper () throw ()
+{
+    shutdown();
+    delete m_state;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds table with time to live, and starts removing thread, if it's not running.
+ */
+void expiry_reaper::add (table * tbl)   /**< [in] Table with time to live. */
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    m_state->tables.push_back(tbl);
+
+    if (m_state->thread == NULL && !m_state->stop)
+    {
+        m_state->thread = new boost::thread(boost::bind(&reaper_state::run, m_state));
+    }
+}
+
+/**
+ * Removes table (e.g. when it's closed), waiting for completion of removing its expired records.
+ */
+void expiry_reaper::remove (table * tbl)    /**< [in] Table with time to live. */
+{
+    boost::mutex::scoped_lock guard(m_state->busy);
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    vector <table *>::iterator i = std::find(m_state->tables.begin(), m_state->tables.end(), tbl);
+
+    if (i != m_state->tables.end()) m_state->tables.erase(i);
+}
+
+/**
+ * Stops removing thread (if it's running). Expired records are not removed any longer.
+ */
+void expiry_reaper::shutdown ()
+{
+    boost::thread * thread = NULL;
+
+    {
+        boost::mutex::scoped_lock lock(m_state->mutex);
+
+        m_state->stop = true;
+        m_state->cond.notify_all();
+
+        thread = m_state->thread;
+        m_state->thread = NULL;
+    }
+
+    if (thread != NULL)
+    {
+        thread->join();
+        delete thread;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of expiration of records of class "bdb::table".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * @private Opens (creating if required) the index of expiration times of records, and adds the table
+ * to expiry reaper of the database. The index is a composite one of the field with time of records,
+ * so it's sorted by Berkeley DB itself, and the records, which expire first, are first in the index.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void table::open_expiry ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::open_expiry] ENTER");
+
+    static const int types[] = { BDB_FIELD_INT64 };
+
+    int field = m_options.ttl_field;
+
+    m_expiry = new index(this, (m_name + EXPIRY_SUFFIX).c_str(), NULL, NULL, m_callback, false, NULL, 0, 0, false, NULL, false, &field, types, 1);
+    assert(m_expiry != NULL);
+
+    // records of read-only tables are filtered on reads only
+    if (!m_options.read_only && !m_database->m_readonly) m_database->m_reaper->add(this);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::open_expiry] EXIT");
+}
+
+/**
+ * @private Checks whether specified serialized data of a record are expired (see "bdb::table_options::ttl_field").
+ * Records without the field never expire.
+ */
+bool table::is_expired (const DBT * data) const     /**< [in] Data of the record. */
+{
+    if (m_options.ttl_field == 0) return false;
+
+    int64_t stamp;
+
+    if (!extract_field(data, m_options.ttl_field, &stamp)) return false;
+
+    return (stamp + (int64_t) m_options.ttl <= (int64_t) time(NULL));
+}
+
+/**
+ * @private Removes the next batch of expired records of the table in one transaction. The records are found
+ * in the index of expiration times, and are removed in order of their primary keys, so the batch touches
+ * as few pages of the table as possible. The records are removed the way "bdb::table::remove" does it, so
+ * covering indexes, materialized aggregates, change log and cache of records are kept up to date.
+ * Returns error code of Berkeley DB.
+ */
+int table::reap_expired (unsigned int * reaped)     /**< [out] Number of removed records. */
+{
+    latency_scope berkeley(BDB_LATENCY_BERKELEY);
+
+    *reaped = 0;
+
+    // replication clients get removals from the master
+    if (m_database->m_role != BDB_REPL_MASTER) return 0;
+
+    // expired records have times up to the deadline, and their index keys sort up to the bound
+    raw_key <int64_t> deadline((int64_t) time(NULL) - (int64_t) m_options.ttl);
+
+    string bound(1, EXPIRY_PRESENT);
+    bound.append((const char *) deadline.ref().m_data, deadline.ref().m_size);
+
+    DB * db = m_expiry->m_plain;
+
+    DB_TXN * txn = m_database->get_transaction();
+    DB_TXN * own = NULL;
+
+    int res = m_database->begin_auto(&txn, &own);
+
+    DBC * cursor = NULL;
+
+    if (res == 0) res = db->cursor(db, txn, &cursor, 0);
+
+    vector <string> keys;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+    k.flags = DB_DBT_REALLOC;
+    d.flags = DB_DBT_REALLOC;
+
+    // records without the field (which never expire) precede all the others
+    char first = EXPIRY_PRESENT;
+
+    k.data = malloc(sizeof(first));
+    k.size = sizeof(first);
+    memcpy(k.data, &first, sizeof(first));
+
+    if (res == 0) res = cursor->get(cursor, &k, &d, DB_SET_RANGE);
+
+    while (res == 0 && keys.size() < EXPIRY_BATCH)
+    {
+        string skey((const char *) k.data, k.size);
+
+        if (skey > bound) break;
+
+        keys.push_back(string((const char *) d.data, d.size));
+
+        res = cursor->get(cursor, &k, &d, DB_NEXT);
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    free(k.data);
+    free(d.data);
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    std::sort(keys.begin(), keys.end(), expiry_less(this));
+
+    for (size_t i = 0; i < keys.size() && res == 0; i++)
+    {
+        DBT key;
+        memset(&key, 0, sizeof(DBT));
+
+        key.data = (void *) keys[i].data();
+        key.size = (u_int32_t) keys[i].size();
+
+        res = remove_record(txn, &key);
+    }
+
+    res = m_database->end_auto(own, res);
+
+    if (res == 0) *reaped = (unsigned int) keys.size();
+
+    return res;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,532 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+
+/** @file bdb/src/export.cc
+ * Contains implementation of parallel export of tables into columnar files.
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Protocol Buffers
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+
+// Boost C++ Libraries
+#include <boost/thread/mutex.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of parallel export of tables into columnar files.
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::map;
+using std::string;
+using std::vector;
+
+using google::protobuf::uint8;
+using google::protobuf::uint32;
+using google::protobuf::uint64;
+using google::protobuf::io::CodedOutputStream;
+using google::protobuf::internal::WireFormatLite;
+
+/**
+ * @private Signature of columnar file. The file contains its header (number of columns, and for each column
+ * its field number, kind of values and name, see "bdb::export_kind"), then groups of rows, and ends with
+ * an empty group. Group contains number of its rows, and for each column its size and encoded values:
+ * runs of absent and present values (starting with absent ones), and then values of present rows, either
+ * as runs of equal values (integers as ZigZag varints, floats and doubles as their raw bits), or as
+ * dictionary of distinct strings of the group, followed by runs of indexes of the dictionary.
+ * All numbers are varints, all strings are prefixed by their sizes.
+ */
+static const char EXPORT_MAGIC[] = { 'B', 'D', 'B', 'C', 'O', 'L', 'S', '1' };
+
+/** @private Kinds of values of exported columns. */
+enum export_kind
+{
+    EXPORT_INTEGER = 0,     /**< Integer, enum or bool field.                  */
+    EXPORT_STRING  = 1,     /**< String or bytes field (dictionary-encoded).   */
+    EXPORT_FLOAT   = 2,     /**< Float field (raw bits).                       */
+    EXPORT_DOUBLE  = 3      /**< Double field (raw bits).                      */
+};
+
+/** @private Exported field. */
+struct export_column
+{
+    int                     field;  /**< Field number.              */
+    FieldDescriptor::Type   type;   /**< Type of the field.         */
+    export_kind             kind;   /**< Kind of exported values.   */
+    string                  name;   /**< Name of the field.         */
+};
+
+/** @private Values of one column in current group of rows of a partition. */
+struct export_values
+{
+    vector <uint8>      present;    /**< Whether the rows contain the field.        */
+    vector <int64_t>    numbers;    /**< Values of numeric fields (present rows).   */
+    vector <string>     strings;    /**< Values of string fields (present rows).    */
+};
+
+/** @private Columnar file of one partition (range of keys) of the export. */
+class export_partition
+{
+public:
+
+    export_partition (size_t columns) : values(columns), rows(0), total(0) { }
+
+    std::ofstream           file;       /**< Columnar file ("is_open" - the partition has records). */
+    vector <export_values>  values;     /**< Values of current group of rows, by columns.           */
+    size_t                  rows;       /**< Number of rows in current group.                        */
+    uint64_t                total;      /**< Number of exported rows of the partition.               */
+};
+
+/** @private State of the export, shared by workers of parallel scan. */
+class export_state
+{
+public:
+
+    export_state () : group(0), error(0) { }
+
+    ~export_state ()
+    {
+        for (size_t i = 0; i < parts.size(); i++) delete parts[i];
+    }
+
+    vector <export_column>      columns;    /**< Exported fields.                           */
+    vector <int>                fields;     /**< Numbers of exported fields, by columns.    */
+    vector <export_partition*>  parts;      /**< Partitions, by workers of the scan.        */
+    string                      prefix;     /**< Prefix of paths of the files.              */
+    size_t                      group;      /**< Maximum number of rows in a group.         */
+    boost::mutex                mutex;      /**< Guards the error.                          */
+    int                         error;      /**< The first error of the workers.            */
+};
+
+/**
+ * @private Appends varint of specified value to the buffer.
+ */
+static void put_varint (string * out,       /**< [in,out] Buffer.         */
+                        uint64   value)     /**< [in]     Value to append. */
+{
+    uint8 buffer[10];
+    uint8 * end = CodedOutputStream::WriteVarint64ToArray(value, buffer);
+
+    out->append((const char *) buffer, end - buffer);
+}
+
+/**
+ * @private Appends string, prefixed by its size, to the buffer.
+ */
+static void put_string (string       * out,     /**< [in,out] Buffer.          */
+                        const string & value)   /**< [in]     String to append. */
+{
+    put_varint(out, value.size());
+    out->append(value);
+}
+
+/**
+ * @private Decodes raw value of numeric field of specified type (integers are sign-extended,
+ * floats and doubles are returned as their raw bits).
+ * Returns "false", if the value doesn't match the type.
+ */
+static bool decode_number (const field_value     & raw,     /**< [in]  Raw value of the field. */
+                           FieldDescriptor::Type   type,    /**< [in]  Type of the field.      */
+                           int64_t               * value)   /**< [out] Decoded value.          */
+{
+    const uint8 * pos = (const uint8 *) raw.data;
+
+    uint64 v = 0;
+
+    if (raw.wiretype == WireFormatLite::WIRETYPE_VARINT)
+    {
+        for (size_t i = 0; i < raw.size && i < 10; i++) v |= (uint64) (pos[i] & 0x7F) << (7 * i);
+    }
+    else if (raw.wiretype == WireFormatLite::WIRETYPE_FIXED32 && raw.size == 4)
+    {
+        for (int i = 3; i >= 0; i--) v = (v << 8) | pos[i];
+    }
+    else if (raw.wiretype == WireFormatLite::WIRETYPE_FIXED64 && raw.size == 8)
+    {
+        for (int i = 7; i >= 0; i--) v = (v << 8) | pos[i];
+    }
+    else
+    {
+        return false;
+    }
+
+    switch (type)
+    {
+        case FieldDescriptor::TYPE_SINT32:
+        case FieldDescriptor::TYPE_SINT64:      *value = (int64_t) (v >> 1) ^ -(int64_t) (v & 1);   break;
+        case FieldDescriptor::TYPE_UINT32:
+        case FieldDescriptor::TYPE_FIXED32:     *value = (int64_t) (uint32) v;                      break;
+        case FieldDescriptor::TYPE_SFIXED32:    *value = (int64_t) (int32_t) (uint32) v;            break;
+        default:                                *value = (int64_t) v;
+    }
+
+    return true;
+}
+
+/**
+ * @private Encodes values of a column of current group of rows.
+ */
+static void encode_column (const export_column & column,    /**< [in]  Exported field.       */
+                           const export_values & values,    /**< [in]  Values of the column. */
+                           string              * out)       /**< [out] Encoded column.       */
+{
+    out->clear();
+
+    // runs of absent and present rows
+    uint8  current = 0;
+    uint64 run     = 0;
+
+    for (size_t r = 0; r < values.present.size(); r++)
+    {
+        if (values.present[r] == current)
+        {
+            run++;
+            continue;
+        }
+
+        put_varint(out, run);
+        current = values.present[r];
+        run     = 1;
+    }
+
+    put_varint(out, run);
+
+    if (column.kind == EXPORT_STRING)
+    {
+        // dictionary of distinct strings, in order of their first rows
+        map <string, uint64> dictionary;
+        vector <uint64>      indexes;
+        string               words;
+
+        indexes.reserve(values.strings.size());
+
+        for (size_t i = 0; i < values.strings.size(); i++)
+        {
+            map <string, uint64>::iterator w = dictionary.find(values.strings[i]);
+
+            if (w == dictionary.end())
+            {
+                w = dictionary.insert(std::make_pair(values.strings[i], (uint64) dictionary.size())).first;
+                put_string(&words, values.strings[i]);
+            }
+
+            indexes.push_back(w->second);
+        }
+
+        put_varint(out, dictionary.size());
+        out->append(words);
+
+        for (size_t i = 0; i < indexes.size(); )
+        {
+            size_t j = i + 1;
+            while (j < indexes.size() && indexes[j] == indexes[i]) j++;
+
+            put_varint(out, indexes[i]);
+            put_varint(out, j - i);
+            i = j;
+        }
+    }
+    else
+    {
+        const vector <int64_t> & numbers = values.numbers;
+
+        for (size_t i = 0; i < numbers.size(); )
+        {
+            size_t j = i + 1;
+            while (j < numbers.size() && numbers[j] == numbers[i]) j++;
+
+            if (column.kind == EXPORT_INTEGER)
+            {
+                put_varint(out, ((uint64) numbers[i] << 1) ^ (uint64) (numbers[i] >> 63));
+            }
+            else
+            {
+                put_varint(out, (uint64) numbers[i]);
+            }
+
+            put_varint(out, j - i);
+            i = j;
+        }
+    }
+}
+
+/**
+ * @private Writes current group of rows of the partition into its file, and empties the group.
+ * Returns "false", if the file fails.
+ */
+static bool write_group (export_state     * state,  /**< [in] State of the export. */
+                         export_partition * part)   /**< [in] Partition.           */
+{
+    string header, column;
+
+    put_varint(&header, part->rows);
+    part->file.write(header.data(), header.size());
+
+    for (size_t c = 0; c < state->columns.size(); c++)
+    {
+        encode_column(state->columns[c], part->values[c], &column);
+
+        header.clear();
+        put_varint(&header, column.size());
+
+        part->file.write(header.data(), header.size());
+        part->file.write(column.data(), column.size());
+
+        part->values[c].present.clear();
+        part->values[c].numbers.clear();
+        part->values[c].strings.clear();
+    }
+
+    part->rows = 0;
+
+    return part->file.good();
+}
+
+/**
+ * @private Creates columnar file of specified partition, and writes its header.
+ * Returns "false", if the file cannot be created.
+ */
+static bool open_partition (export_state     * state,   /**< [in] State of the export. */
+                            int                worker,  /**< [in] Number of partition. */
+                            export_partition * part)    /**< [in] Partition.           */
+{
+    std::ostringstream path;
+    path << state->prefix << "." << worker << ".cols";
+
+    part->file.open(path.str().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!part->file.is_open())
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::export_columns] File " << path.str() << " cannot be created.");
+        return false;
+    }
+
+    string header(EXPORT_MAGIC, sizeof(EXPORT_MAGIC));
+
+    put_varint(&header, state->columns.size());
+
+    for (size_t c = 0; c < state->columns.size(); c++)
+    {
+        put_varint(&header, state->columns[c].field);
+        put_varint(&header, state->columns[c].kind);
+        put_string(&header, state->columns[c].name);
+    }
+
+    part->file.write(header.data(), header.size());
+
+    return part->file.good();
+}
+
+/**
+ * @private Adds record to the partition of calling worker of parallel scan (see "bdb::scan_callback").
+ */
+static int export_record (int         worker,   /**< [in] Number of calling thread.   */
+                          const DBT * key,      /**< [in] Primary key.                */
+                          const DBT * data,     /**< [in] Primary data.               */
+                          void      * param)    /**< [in] State of the export.        */
+{
+    (void) key;
+
+    export_state * state = static_cast <export_state *> (param);
+
+    int res = 0;
+
+    if (worker < 0 || (size_t) worker >= state->parts.size())
+    {
+        res = EINVAL;
+    }
+
+    export_partition * part = (res == 0 ? state->parts[worker] : NULL);
+
+    if (res == 0 && !part->file.is_open() && !open_partition(state, worker, part))
+    {
+        res = EIO;
+    }
+
+    if (res == 0)
+    {
+        vector <field_value> raws(state->fields.size());
+
+        if (!raws.empty()) extract_fields(data, &state->fields[0], (int) raws.size(), &raws[0]);
+
+        for (size_t c = 0; c < raws.size(); c++)
+        {
+            export_values & values = part->values[c];
+
+            int64_t number  = 0;
+            bool    present = (raws[c].wiretype >= 0);
+
+            if (present && state->columns[c].kind == EXPORT_STRING)
+            {
+                values.strings.push_back(string((const char *) raws[c].data, raws[c].size));
+            }
+            else if (present && (present = decode_number(raws[c], state->columns[c].type, &number)))
+            {
+                values.numbers.push_back(number);
+            }
+
+            values.present.push_back(present ? 1 : 0);
+        }
+
+        part->rows++;
+        part->total++;
+
+        if (part->rows >= state->group && !write_group(state, part)) res = EIO;
+    }
+
+    if (res != 0)
+    {
+        boost::mutex::scoped_lock lock(state->mutex);
+        if (state->error == 0) state->error = res;
+    }
+
+    return res;
+}
+
+/**
+ * Exports all records of the table into columnar files, one file per range of keys, which are written
+ * concurrently by workers of parallel scan (see "bdb::table::parallel_scan"). Exported columns are all
+ * scalar fields of specified type, which are read from serialized records straight by their numbers,
+ * so the records are not parsed; repeated fields and submessages are not exported. Each file is written
+ * by groups of rows, and values of each column of a group are run-length encoded (strings are encoded
+ * by dictionary of the group). Files are named "<prefix>.<range>.cols", their ranges follow in order of
+ * keys, and ranges without records have no files.
+ * Returns number of exported records.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - a file cannot be written, or unknown error.
+ */
+uint64_t export_columns (table            * tbl,        /**< [in] Exported table.                       */
+                         const Descriptor * type,       /**< [in] Type of data of the table.            */
+                         const char       * prefix,     /**< [in] Prefix of paths of the files.         */
+                         unsigned int       nthreads,   /**< [in] Number of ranges (files).             */
+                         unsigned int       group)      /**< [in] Maximum number of rows in a group.    */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::export_columns] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::export_columns] prefix = " << prefix << ", nthreads = " << nthreads << ", group = " << group);
+
+    export_state state;
+
+    state.prefix = prefix;
+    state.group  = (group != 0 ? group : 1);
+
+    for (int i = 0; i < type->field_count(); i++)
+    {
+        const FieldDescriptor * fd = type->field(i);
+
+        if (fd->is_repeated()) continue;
+
+        export_column column;
+
+        column.field = fd->number();
+        column.type  = fd->type();
+        column.name  = fd->name();
+
+        switch (fd->type())
+        {
+            case FieldDescriptor::TYPE_STRING:
+            case FieldDescriptor::TYPE_BYTES:   column.kind = EXPORT_STRING;    break;
+            case FieldDescriptor::TYPE_FLOAT:   column.kind = EXPORT_FLOAT;     break;
+            case FieldDescriptor::TYPE_DOUBLE:  column.kind = EXPORT_DOUBLE;    break;
+            case FieldDescriptor::TYPE_MESSAGE:
+            case FieldDescriptor::TYPE_GROUP:   continue;
+            default:                            column.kind = EXPORT_INTEGER;
+        }
+
+        state.columns.push_back(column);
+        state.fields.push_back(column.field);
+    }
+
+    // ranges of parallel scan are never more than requested
+    state.parts.resize(nthreads != 0 ? nthreads : 1, NULL);
+
+    for (size_t i = 0; i < state.parts.size(); i++)
+    {
+        state.parts[i] = new export_partition(state.columns.size());
+    }
+
+    tbl->parallel_scan((unsigned int) state.parts.size(), export_record, &state);
+
+    uint64_t total = 0;
+
+    for (size_t i = 0; i < state.parts.size(); i++)
+    {
+        export_partition * part = state.parts[i];
+
+        if (!part->file.is_open()) continue;
+
+        // the last group, and the empty group at the end
+        if (state.error == 0 && part->rows != 0 && !write_group(&state, part)) state.error = EIO;
+
+        string end;
+        put_varint(&end, 0);
+        part->file.write(end.data(), end.size());
+
+        if (state.error == 0 && !part->file.good()) state.error = EIO;
+
+        part->file.close();
+
+        total += part->total;
+    }
+
+    if (state.error != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::export_columns] " << db_strerror(state.error));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::export_columns] EXIT = " << total);
+
+    return total;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
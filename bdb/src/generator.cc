@@ -0,0 +1,334 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/generator.cc
+ * Contains implementation of class "bdb::id_generator".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Boost C++ Libraries
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/thread/tss.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::id_generator".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::string;
+using std::vector;
+
+using boost::thread_specific_ptr;
+
+/** @private Number of bits of node of generated ID. */
+static const unsigned int GENERATOR_NODE_BITS = 10;
+
+/** @private Number of bits of counter of generated ID. */
+static const unsigned int GENERATOR_COUNTER_BITS = 12;
+
+/** @private Number of IDs, generated within one millisecond. */
+static const uint32_t GENERATOR_COUNTERS = (uint32_t) 1 << GENERATOR_COUNTER_BITS;
+
+/** @private Number of counters, taken by a thread at once. */
+static const uint32_t GENERATOR_BLOCK = 64;
+
+/** @private Time, IDs are reserved up to at once (in milliseconds). */
+static const uint64_t GENERATOR_RESERVE = 10000;
+
+/** @private Prefix of keys of reserved times (names of sequences never start with it). */
+static const char GENERATOR_PREFIX[] = "\x01generator.";
+
+/** @private Counters of one millisecond, taken by a thread. */
+class generator_block
+{
+public:
+
+    generator_block () : time(0), next(0), end(0) { }
+
+    uint64_t    time;   /**< Millisecond of the counters.       */
+    uint32_t    next;   /**< Next counter to use.               */
+    uint32_t    end;    /**< End of the counters of the block.  */
+};
+
+/**
+ * @private Cleanup function for thread-specific pointer.
+ * Does nothing, since all blocks are owned by the state below.
+ */
+static void generator_block_cleanup (generator_block *)
+{ }
+
+/** @private Current time and counter of generator, and blocks of counters of all threads. */
+class generator_state
+{
+public:
+
+    generator_state () : last(0), counter(0), reserved(0), local(generator_block_cleanup) { }
+
+    boost::mutex                            mutex;      /**< Guards all the fields below.                   */
+    uint64_t                                last;       /**< Millisecond of the last taken block.           */
+    uint32_t                                counter;    /**< Next free counter of the millisecond.          */
+    uint64_t                                reserved;   /**< Millisecond, IDs are persistently reserved up to. */
+    thread_specific_ptr <generator_block>   local;      /**< Block of current thread.                       */
+    vector <generator_block *>              all;        /**< Blocks of all threads.                         */
+};
+
+/**
+ * @private Returns current time in milliseconds since epoch of generated IDs (2020-01-01 UTC).
+ */
+static uint64_t generator_time ()
+{
+    static const boost::posix_time::ptime epoch(boost::gregorian::date(2020, 1, 1));
+
+    boost::posix_time::time_duration elapsed = boost::get_system_time() - epoch;
+
+    return (elapsed.is_negative() ? 0 : (uint64_t) elapsed.total_milliseconds());
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens the generator, so its IDs continue after the time, reserved before it was closed.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - invalid node, or unknown error.
+ */
+id_generator::id_generator (database     * db,      /**< [in] Database of the generator.  */
+                            const char   * name,    /**< [in] Name of the generator.      */
+                            unsigned int   node)    /**< [in] Number of the node (0-1023). */
+  : m_database(db),
+    m_key(string(GENERATOR_PREFIX) + name),
+    m_node(node),
+    m_state(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::id_generator::id_generator] ENTER");
+
+    if (node >= ((unsigned int) 1 << GENERATOR_NODE_BITS))
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::id_generator::id_generator] Number of the node is out of range.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    DBT key, data;
+
+    memset(&key,  0, sizeof(DBT));
+    memset(&data, 0, sizeof(DBT));
+
+    unsigned char value[8];
+
+    key.data   = (void *) m_key.data();
+    key.size   = (u_int32_t) m_key.size();
+    data.data  = value;
+    data.ulen  = sizeof(value);
+    data.flags = DB_DBT_USERMEM;
+
+    int res = db->m_seqc->get(db->m_seqc, NULL, &key, &data, 0);
+
+    if (res != 0 && res != DB_NOTFOUND)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::id_generator::id_generator] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    m_state = new generator_state;
+    assert(m_state != NULL);
+
+    // IDs continue after the reserved time, so they are never repeated even if the clock is set back
+    if (res == 0 && data.size == sizeof(value))
+    {
+        for (size_t i = 0; i < sizeof(value); i++)
+        {
+            m_state->last = (m_state->last << 8) | value[i];
+        }
+
+        m_state->reserved = m_state->last;
+    }
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::id_generator::id_generator] reserved = " << m_state->reserved);
+    LOG4CPLUS_TRACE(logger, "[bdb::id_generator::id_generator] EXIT");
+}
+
+/**
+ * Closes the generator.
+ */
+id_generator::~id_generator () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::id_generator::~id_generator] ENTER");
+
+    for (size_t i = 0; i < m_state->all.size(); i++)
+    {
+        delete m_state->all[i];
+    }
+
+    m_state->local.release();
+    delete m_state;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::id_generator::~id_generator] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Generates next unique ID and returns it. IDs are generated from counters of the thread, so threads
+ * don't contend for them, and the database is written only when reserved time is over.
+ *
+ * @return 64-bit integer value.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+int64_t id_generator::id ()
+{
+    generator_block * block = m_state->local.get();
+
+    if (block == NULL)
+    {
+        block = new generator_block;
+        assert(block != NULL);
+
+        boost::mutex::scoped_lock lock(m_state->mutex);
+        m_state->all.push_back(block);
+        m_state->local.reset(block);
+    }
+
+    if (block->next == block->end)
+    {
+        int res = take_block(block);
+
+        if (res != 0)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::id_generator::id] " << db_strerror(res));
+            throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    uint64_t id = (block->time << (GENERATOR_NODE_BITS + GENERATOR_COUNTER_BITS))
+                | ((uint64_t) m_node << GENERATOR_COUNTER_BITS)
+                | block->next++;
+
+    return (int64_t) id;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Takes the next block of counters for the thread. When counters of current millisecond are over,
+ * the next millisecond is taken, so IDs keep growing even if they are generated faster than the clock goes.
+ * Returns error code of Berkeley DB.
+ */
+int id_generator::take_block (generator_block * block)  /**< [out] Block of the thread. */
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    uint64_t now = generator_time();
+
+    // time never goes back, even if the clock does
+    if (now > m_state->last)
+    {
+        m_state->last    = now;
+        m_state->counter = 0;
+    }
+    else if (m_state->counter == GENERATOR_COUNTERS)
+    {
+        m_state->last++;
+        m_state->counter = 0;
+    }
+
+    if (m_state->last >= m_state->reserved)
+    {
+        int res = reserve(m_state->last + GENERATOR_RESERVE);
+        if (res != 0) return res;
+    }
+
+    block->time = m_state->last;
+    block->next = m_state->counter;
+    block->end  = std::min(m_state->counter + GENERATOR_BLOCK, GENERATOR_COUNTERS);
+
+    m_state->counter = block->end;
+
+    return 0;
+}
+
+/**
+ * Persistently reserves IDs up to specified millisecond (in its own transaction, with the log flushed).
+ * Returns error code of Berkeley DB.
+ */
+int id_generator::reserve (uint64_t until)  /**< [in] Millisecond, IDs are reserved up to. */
+{
+    LOG4CPLUS_DEBUG(logger, "[bdb::id_generator::reserve] until = " << until);
+
+    unsigned char value[8];
+
+    for (size_t i = 0; i < sizeof(value); i++)
+    {
+        value[i] = (unsigned char) (until >> (8 * (sizeof(value) - 1 - i)));
+    }
+
+    DBT key, data;
+
+    memset(&key,  0, sizeof(DBT));
+    memset(&data, 0, sizeof(DBT));
+
+    key.data  = (void *) m_key.data();
+    key.size  = (u_int32_t) m_key.size();
+    data.data = value;
+    data.size = sizeof(value);
+
+    int res = m_database->m_seqc->put(m_database->m_seqc, NULL, &key, &data, 0);
+
+    if (res == 0) m_state->reserved = until;
+
+    return res;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,382 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/geo.cc
+ * Contains implementation of geospatial indexes of class "bdb::table" by Z-order keys of locations.
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of geospatial indexes.
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::pair;
+using std::vector;
+
+/** @private Wire types of fixed-size fields (see "google::protobuf::internal::WireFormatLite"). */
+enum { GEO_WIRETYPE_FIXED64 = 1, GEO_WIRETYPE_FIXED32 = 5 };
+
+/** @private Cell of the grid of quantized coordinates, which side has "2^(32 - level)" points. */
+struct geo_cell
+{
+    uint64_t     x;         /**< The least quantized longitude of the cell. */
+    uint64_t     y;         /**< The least quantized latitude of the cell.  */
+    unsigned int level;     /**< Level of the cell ("0" - the whole grid).  */
+};
+
+/**
+ * @private Quantizes coordinate into 32 bits (values out of range are clamped).
+ */
+static uint32_t quantize (double value,     /**< [in] Coordinate, in degrees.     */
+                          double low,       /**< [in] The least coordinate.       */
+                          double range)     /**< [in] Range of coordinates.       */
+{
+    double q = (value - low) / range * 4294967296.0;
+
+    if (!(q > 0)) return 0;
+    if (q >= 4294967295.0) return 0xFFFFFFFF;
+
+    return (uint32_t) q;
+}
+
+/**
+ * @private Spreads bits of 32-bit number into even bits of 64-bit one.
+ */
+static uint64_t spread_bits (uint32_t value)
+{
+    static const uint64_t masks[] =
+    {
+        ((uint64_t) 0x0000FFFF << 32) | 0x0000FFFF,
+        ((uint64_t) 0x00FF00FF << 32) | 0x00FF00FF,
+        ((uint64_t) 0x0F0F0F0F << 32) | 0x0F0F0F0F,
+        ((uint64_t) 0x33333333 << 32) | 0x33333333,
+        ((uint64_t) 0x55555555 << 32) | 0x55555555
+    };
+
+    uint64_t x = value;
+
+    x = (x | (x << 16)) & masks[0];
+    x = (x | (x << 8))  & masks[1];
+    x = (x | (x << 4))  & masks[2];
+    x = (x | (x << 2))  & masks[3];
+    x = (x | (x << 1))  & masks[4];
+
+    return x;
+}
+
+/**
+ * @private Gathers even bits of 64-bit number into 32-bit one (see "spread_bits").
+ */
+static uint32_t gather_bits (uint64_t x)
+{
+    static const uint64_t masks[] =
+    {
+        ((uint64_t) 0x55555555 << 32) | 0x55555555,
+        ((uint64_t) 0x33333333 << 32) | 0x33333333,
+        ((uint64_t) 0x0F0F0F0F << 32) | 0x0F0F0F0F,
+        ((uint64_t) 0x00FF00FF << 32) | 0x00FF00FF,
+        ((uint64_t) 0x0000FFFF << 32) | 0x0000FFFF,
+        (uint64_t) 0xFFFFFFFF
+    };
+
+    x &= masks[0];
+    x = (x | (x >> 1))  & masks[1];
+    x = (x | (x >> 2))  & masks[2];
+    x = (x | (x >> 4))  & masks[3];
+    x = (x | (x >> 8))  & masks[4];
+    x = (x | (x >> 16)) & masks[5];
+
+    return (uint32_t) x;
+}
+
+/**
+ * @private Returns Z-order key of quantized coordinates (bits of longitude are odd bits of the key).
+ */
+static uint64_t interleave (uint64_t x,     /**< [in] Quantized longitude. */
+                            uint64_t y)     /**< [in] Quantized latitude.  */
+{
+    return (spread_bits((uint32_t) x) << 1) | spread_bits((uint32_t) y);
+}
+
+/**
+ * @private Decodes coordinate from raw value of "double" or "float" field.
+ *
+ * @return true  - the coordinate is decoded.
+ * @return false - the field is of another type, or is not a number.
+ */
+static bool decode_coordinate (const field_value & value,   /**< [in]  Raw value of the field. */
+                               double            * result)  /**< [out] Coordinate.             */
+{
+    const unsigned char * raw = (const unsigned char *) value.data;
+
+    uint64_t bits = 0;
+
+    for (size_t i = value.size; i > 0; i--) bits = (bits << 8) | raw[i - 1];
+
+    if (value.wiretype == GEO_WIRETYPE_FIXED64 && value.size == 8)
+    {
+        memcpy(result, &bits, sizeof(double));
+    }
+    else if (value.wiretype == GEO_WIRETYPE_FIXED32 && value.size == 4)
+    {
+        uint32_t bits32 = (uint32_t) bits;
+        float    f;
+
+        memcpy(&f, &bits32, sizeof(float));
+        *result = f;
+    }
+    else
+    {
+        return false;
+    }
+
+    return (*result == *result);
+}
+
+/**
+ * @private Returns Z-order key of location (see "bdb::table::add_geo_index"): latitude and longitude are
+ * quantized into 32 bits each, and their bits are interleaved, so near locations mostly have near keys.
+ */
+uint64_t geo_key (double lat,   /**< [in] Latitude, in degrees.  */
+                  double lon)   /**< [in] Longitude, in degrees. */
+{
+    return interleave(quantize(lon, -180.0, 360.0), quantize(lat, -90.0, 180.0));
+}
+
+/**
+ * @private Checks whether location of Z-order key is in the cells of the box (coordinates of the key are
+ * quantized, so the check is not exact on bounds of the box, but it never rejects locations in the box).
+ */
+bool geo_contains (const geo_box & box,     /**< [in] Bounding box.   */
+                   uint64_t        key)     /**< [in] Z-order key.    */
+{
+    uint32_t x = gather_bits(key >> 1);
+    uint32_t y = gather_bits(key);
+
+    return (x >= quantize(box.min_lon, -180.0, 360.0) && x <= quantize(box.max_lon, -180.0, 360.0) &&
+            y >= quantize(box.min_lat,  -90.0, 180.0) && y <= quantize(box.max_lat,  -90.0, 180.0));
+}
+
+/**
+ * @private Decomposes bounding box into sorted disjoint ranges of Z-order keys, which cover it. Cells of
+ * the grid, which are partly in the box, are split into quarters level by level, while the number of
+ * ranges is within the limit, so the ranges cover a bit more than the box (the rest is filtered out).
+ */
+void geo_ranges (const geo_box                          & box,      /**< [in]  Bounding box.                */
+                 size_t                                   max,      /**< [in]  Maximum number of ranges.    */
+                 vector <pair <uint64_t, uint64_t> >    * ranges)   /**< [out] Ranges "[low, high]" of keys. */
+{
+    uint64_t x0 = quantize(box.min_lon, -180.0, 360.0);
+    uint64_t x1 = quantize(box.max_lon, -180.0, 360.0);
+    uint64_t y0 = quantize(box.min_lat,  -90.0, 180.0);
+    uint64_t y1 = quantize(box.max_lat,  -90.0, 180.0);
+
+    ranges->clear();
+
+    if (x0 > x1 || y0 > y1) return;
+
+    if (max < 4) max = 4;
+
+    vector <geo_cell> partial, next;
+
+    geo_cell root = { 0, 0, 0 };
+    partial.push_back(root);
+
+    while (!partial.empty())
+    {
+        // cells, which are not split anymore, are covered as a whole
+        if (partial[0].level == 32 || ranges->size() + partial.size() * 4 > max)
+        {
+            for (size_t i = 0; i < partial.size(); i++)
+            {
+                const geo_cell & c = partial[i];
+
+                uint64_t low  = interleave(c.x, c.y);
+                uint64_t span = (c.level == 0 ? ~(uint64_t) 0 : ((uint64_t) 1 << (64 - 2 * c.level)) - 1);
+
+                ranges->push_back(std::make_pair(low, low + span));
+            }
+
+            break;
+        }
+
+        next.clear();
+
+        for (size_t i = 0; i < partial.size(); i++)
+        {
+            const geo_cell & c = partial[i];
+            uint64_t side = (uint64_t) 1 << (32 - c.level - 1);
+
+            for (int q = 0; q < 4; q++)
+            {
+                geo_cell child = { c.x + ((q & 1) != 0 ? side : 0), c.y + ((q & 2) != 0 ? side : 0), c.level + 1 };
+
+                uint64_t cx1 = child.x + side - 1;
+                uint64_t cy1 = child.y + side - 1;
+
+                if (child.x > x1 || cx1 < x0 || child.y > y1 || cy1 < y0) continue;
+
+                if (child.x >= x0 && cx1 <= x1 && child.y >= y0 && cy1 <= y1)
+                {
+                    uint64_t low = interleave(child.x, child.y);
+                    ranges->push_back(std::make_pair(low, low + (((uint64_t) 1 << (64 - 2 * child.level)) - 1)));
+                }
+                else
+                {
+                    next.push_back(child);
+                }
+            }
+        }
+
+        partial.swap(next);
+    }
+
+    std::sort(ranges->begin(), ranges->end());
+
+    // adjacent ranges are scanned as one
+    size_t n = 0;
+
+    for (size_t i = 0; i < ranges->size(); i++)
+    {
+        if (n != 0 && (*ranges)[n - 1].second != ~(uint64_t) 0 && (*ranges)[n - 1].second + 1 == (*ranges)[i].first)
+        {
+            (*ranges)[n - 1].second = (*ranges)[i].second;
+        }
+        else
+        {
+            (*ranges)[n++] = (*ranges)[i];
+        }
+    }
+
+    ranges->resize(n);
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Geospatial indexes of class "bdb::table".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds new geospatial index of locations, kept by "double" (or "float") fields of latitude and longitude of
+ * primary data, to the table, and opens the index. Records are indexed by Z-order keys of their locations
+ * (see "bdb::geo_box"), which are in order-preserving format and need no comparison function, so records
+ * in a bounding box are found by a few ranges of the index (see "bdb::recordset" of geospatial index)
+ * instead of scanning the table. Records without location are not indexed.
+ * If index doesn't exist yet, then creates it.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+index * table::add_geo_index (const char * name,        /**< [in] Name of the index.                    */
+                              int          lat_field,   /**< [in] Field of latitude of primary data.    */
+                              int          lon_field,   /**< [in] Field of longitude of primary data.   */
+                              int          type)        /**< [in] Type of the fields ("BDB_FIELD_DOUBLE" or "BDB_FIELD_FLOAT"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_geo_index] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_geo_index] name = " << name);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_geo_index] lat_field = " << lat_field << ", lon_field = " << lon_field);
+
+    if (type != BDB_FIELD_DOUBLE && type != BDB_FIELD_FLOAT)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::add_geo_index] Coordinates must be of floating-point type.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    check_open();
+
+    // the index is composite one of the coordinates, so its keys are ordered (and the fields are filtered by type)
+    const int fields[] = { lat_field, lon_field };
+    const int types[]  = { type, type };
+
+    index * i = new index(this, name, index::index_by_location, NULL, m_callback, false, NULL, 0, 0, false, NULL, false, fields, types, 2);
+    assert(i != NULL);
+    m_indexes.push_back(i);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_geo_index] EXIT");
+
+    return i;
+}
+
+/**
+ * Indexing callback of geospatial indexes (see "table::add_geo_index"), which indexes the record
+ * by big-endian Z-order key of its location (see "bdb::geo_key").
+ */
+int index::index_by_location (DB        * sec,     /**< [in]  Database of the index.    */
+                              const DBT *,         /**< [in]  Primary key (unused).     */
+                              const DBT * data,    /**< [in]  Serialized primary data.  */
+                              DBT       * result)  /**< [out] Serialized index key.     */
+{
+    index * idx = (index *) sec->app_private;
+
+    field_value values[2];
+
+    if (extract_fields(data, &idx->m_columns[0], 2, values) != 2) return DB_DONOTINDEX;
+
+    double lat, lon;
+
+    if (!decode_coordinate(values[0], &lat) || !decode_coordinate(values[1], &lon)) return DB_DONOTINDEX;
+
+    uint64_t key = geo_key(lat, lon);
+
+    unsigned char * raw = (unsigned char *) malloc(sizeof(uint64_t));
+
+    for (int i = sizeof(uint64_t) - 1; i >= 0; i--)
+    {
+        raw[i] = (unsigned char) key;
+        key >>= 8;
+    }
+
+    memset(result, 0, sizeof(DBT));
+
+    result->data  = raw;
+    result->size  = sizeof(uint64_t);
+    result->flags = DB_DBT_APPMALLOC;
+
+    return 0;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,384 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+
+/** @file bdb/src/histogram.cc
+ * Contains implementation of histograms of keys of class "bdb::table".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+// Boost C++ Libraries
+#include <boost/thread/mutex.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of histograms of keys of class "bdb::table".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::string;
+using std::vector;
+
+/** @private Lock of loading, building and using of histograms of all tables. */
+static boost::mutex histogram_mutex;
+
+/** @private Lock of opening of the database of histograms (it's shared with sketches of indexes). */
+static boost::mutex stats_mutex;
+
+/**
+ * @private Appends integer of specified size to serialized histogram.
+ */
+static void append_uint (string & buf, uint64_t value, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        buf += (char) ((value >> (i * 8)) & 0xFF);
+    }
+}
+
+/**
+ * @private Reads integer of specified size from serialized histogram.
+ * Returns "false" if the histogram is truncated.
+ */
+static bool read_uint (const unsigned char *& ptr, const unsigned char * end, uint64_t * value, size_t size)
+{
+    if ((size_t) (end - ptr) < size) return false;
+
+    *value = 0;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        *value |= (uint64_t) ptr[i] << (i * 8);
+    }
+
+    ptr += size;
+
+    return true;
+}
+
+/**
+ * @private Serializes histogram (number of records, time, number of bounds, and the bounds, prefixed by their sizes).
+ */
+static void encode_histogram (const key_histogram & hist, string & buf)
+{
+    buf.clear();
+
+    append_uint(buf, hist.records, 8);
+    append_uint(buf, hist.time, 8);
+    append_uint(buf, hist.bounds.size(), 4);
+
+    for (size_t i = 0; i < hist.bounds.size(); i++)
+    {
+        append_uint(buf, hist.bounds[i].size(), 4);
+        buf += hist.bounds[i];
+    }
+}
+
+/**
+ * @private Deserializes histogram (see "encode_histogram"). Returns "false" if the histogram is corrupted.
+ */
+static bool decode_histogram (const DBT * data, key_histogram * hist)
+{
+    const unsigned char * ptr = (const unsigned char *) data->data;
+    const unsigned char * end = ptr + data->size;
+
+    uint64_t count = 0;
+
+    if (!read_uint(ptr, end, &hist->records, 8) ||
+        !read_uint(ptr, end, &hist->time, 8) ||
+        !read_uint(ptr, end, &count, 4))
+    {
+        return false;
+    }
+
+    hist->modified = 0;
+    hist->bounds.clear();
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+        uint64_t size = 0;
+
+        if (!read_uint(ptr, end, &size, 4) || (uint64_t) (end - ptr) < size) return false;
+
+        hist->bounds.push_back(string((const char *) ptr, (size_t) size));
+        ptr += size;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Private interface of class "bdb::database".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * @private Opens database of histograms of keys of tables (see "bdb::table::analyze") and sketches of keys
+ * of indexes (see "bdb::index::estimate_distinct"), if it's not opened yet.
+ */
+int database::open_histograms ()
+{
+    boost::mutex::scoped_lock lock(stats_mutex);
+
+    if (m_histograms != NULL) return 0;
+
+    int res = db_create(&m_histograms, m_env, 0);
+    if (res == 0) res = open_file(m_histograms, NULL, "__stats.db", "__stats", DB_BTREE, DB_THREAD | DB_CREATE | DB_AUTO_COMMIT);
+
+    if (res != 0)
+    {
+        if (m_histograms != NULL) m_histograms->close(m_histograms, 0);
+        m_histograms = NULL;
+    }
+
+    return res;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface of class "bdb::table".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Builds equi-depth histogram of keys of Btree table with specified number of buckets, and persists it
+ * in the database, so planning of ranges (e.g. "bdb::table::parallel_scan") takes its bounds at once.
+ * If "staleness" is not zero, existing histogram with the same number of buckets is kept, unless more
+ * than specified part of its records (e.g. "0.1") has been inserted or removed by this process since then.
+ * Returns "true" if the histogram has been (re)built.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown Berkeley DB error, or the table is not a Btree one.
+ */
+bool table::analyze (unsigned int buckets,      /**< [in] Number of buckets of the histogram.           */
+                     double       staleness)    /**< [in] Allowed part of modified records ("0" - rebuild always). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::analyze] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::analyze] buckets = "   << buckets);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::analyze] staleness = " << staleness);
+
+    check_open();
+
+    check_ordered("table::analyze");
+
+    if (buckets < 2) buckets = 2;
+
+    boost::mutex::scoped_lock lock(histogram_mutex);
+
+    int res = load_histogram();
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (res == 0 && m_histogram != NULL && staleness > 0.0 &&
+        m_histogram->bounds.size() + 1 == buckets &&
+        (double) m_modified <= staleness * (double) m_histogram->records)
+    {
+        LOG4CPLUS_TRACE(logger, "[bdb::table::analyze] EXIT = false");
+        return false;
+    }
+
+    key_histogram hist;
+    vector <string> bounds;
+
+    if (res == 0) res = find_bounds(buckets, &bounds, false);
+
+    if (res == 0)
+    {
+        // the first and the last bounds of ranges are always empty
+        if (bounds.size() > 2) hist.bounds.assign(bounds.begin() + 1, bounds.end() - 1);
+
+        hist.records  = count(true);
+        hist.time     = (uint64_t) ::time(NULL);
+        hist.modified = 0;
+
+        string buf;
+        encode_histogram(hist, buf);
+
+        DBT k, d;
+
+        memset(&k, 0, sizeof(k));
+        memset(&d, 0, sizeof(d));
+
+        k.data = (void *) m_name.data();
+        k.size = (u_int32_t) m_name.size();
+        d.data = (void *) buf.data();
+        d.size = (u_int32_t) buf.size();
+
+        res = m_database->m_histograms->put(m_database->m_histograms, NULL, &k, &d, 0);
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::analyze] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    if (m_histogram == NULL)
+    {
+        m_histogram = new key_histogram;
+        assert(m_histogram != NULL);
+    }
+
+    *m_histogram = hist;
+    m_modified   = 0;
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::analyze] bounds = "  << hist.bounds.size());
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::analyze] records = " << hist.records);
+    LOG4CPLUS_TRACE(logger, "[bdb::table::analyze] EXIT = true");
+
+    return true;
+}
+
+/**
+ * Returns histogram of keys of the table, built by "bdb::table::analyze" (by this or any previous process).
+ * Returns "false" if the table has not been analyzed yet.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown Berkeley DB error.
+ */
+bool table::get_histogram (key_histogram * result)  /**< [out] Histogram of keys. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::get_histogram] ENTER");
+
+    check_open();
+
+    boost::mutex::scoped_lock lock(histogram_mutex);
+
+    int res = load_histogram();
+
+    if (res == DB_NOTFOUND)
+    {
+        LOG4CPLUS_TRACE(logger, "[bdb::table::get_histogram] EXIT = false");
+        return false;
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::get_histogram] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    *result = *m_histogram;
+    result->modified = m_modified;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::get_histogram] EXIT = true");
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Private interface of class "bdb::table".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * @private Loads persisted histogram of keys of the table, if it's not loaded yet ("histogram_mutex" must be locked).
+ * Returns "DB_NOTFOUND" if the table has not been analyzed.
+ */
+int table::load_histogram ()
+{
+    if (m_histogram != NULL) return 0;
+
+    int res = m_database->open_histograms();
+    if (res != 0) return res;
+
+    DBT k, d;
+
+    memset(&k, 0, sizeof(k));
+    memset(&d, 0, sizeof(d));
+
+    k.data  = (void *) m_name.data();
+    k.size  = (u_int32_t) m_name.size();
+    d.flags = DB_DBT_MALLOC;
+
+    res = m_database->m_histograms->get(m_database->m_histograms, NULL, &k, &d, 0);
+    if (res != 0) return res;
+
+    key_histogram * hist = new key_histogram;
+    assert(hist != NULL);
+
+    if (!decode_histogram(&d, hist))
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::load_histogram] Histogram of table \"" << m_name << "\" is corrupted.");
+        delete hist;
+        res = DB_NOTFOUND;
+    }
+    else
+    {
+        m_histogram = hist;
+        m_modified  = 0;
+    }
+
+    free(d.data);
+
+    return res;
+}
+
+/**
+ * @private Splits key space of the table into specified number of ranges by its histogram of keys
+ * (see "bdb::table::find_bounds"). Returns "false" if the table has no histogram with enough buckets.
+ */
+bool table::histogram_bounds (unsigned int      nthreads,   /**< [in]  Number of ranges.  */
+                              vector <string> * bounds)     /**< [out] Bounds of ranges.  */
+{
+    boost::mutex::scoped_lock lock(histogram_mutex);
+
+    if (load_histogram() != 0) return false;
+
+    const vector <string> & hb = m_histogram->bounds;
+    size_t m = hb.size();
+
+    if (m + 1 < nthreads) return false;
+
+    bounds->clear();
+    bounds->push_back(string());
+
+    for (unsigned int i = 1; i < nthreads; i++)
+    {
+        bounds->push_back(hb[i * (m + 1) / nthreads - 1]);
+    }
+
+    bounds->push_back(string());
+
+    return true;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,331 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/hotkeys.cc
+ * Contains implementation of class "bdb::hot_sampler", and of sampling of accessed keys of class "bdb::table".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <string>
+#include <vector>
+
+// Boost C++ Libraries
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::hot_sampler".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::map;
+using std::string;
+using std::vector;
+
+/** @private Number of counters of heavy-hitter summary of a thread. */
+static const size_t HOT_COUNTERS = 64;
+
+/** @private Lock of creation of samplers on demand (see "bdb::table::set_hot_sampling"). */
+static boost::mutex sampler_mutex;
+
+/** @private Counter of sampled key. */
+struct hot_counter
+{
+    uint64_t count;     /**< Number of sampled accesses.               */
+    uint64_t error;     /**< Count, inherited from a replaced key.     */
+};
+
+/** @private Heavy-hitter summary of sampled keys of one thread. */
+class hot_summary
+{
+public:
+
+    hot_summary () : skip(0) { }
+
+    boost::mutex                mutex;      /**< Guards the counters (contended by merges only). */
+    unsigned int                skip;       /**< Number of accesses since the last sampled one (used by the thread only). */
+    map <string, hot_counter>   counters;   /**< Counters by serialized keys.                    */
+};
+
+/**
+ * @private Cleanup function for thread-specific pointer.
+ * Does nothing, since all summaries are owned by the sampler, and are kept after their threads exit.
+ */
+static void hot_summary_cleanup (hot_summary *)
+{ }
+
+/** @private Order of hot keys by their counts (the most accessed first). */
+static bool hotter (const hot_key & k1, const hot_key & k2)
+{
+    return k1.count > k2.count;
+}
+
+/** @private Summaries of all threads of a sampler. */
+class sampler_state
+{
+public:
+
+    sampler_state (unsigned int p) : period(p), local(hot_summary_cleanup) { }
+
+    ~sampler_state ()
+    {
+        for (size_t i = 0; i < summaries.size(); i++) delete summaries[i];
+    }
+
+    volatile unsigned int                   period;     /**< Period of sampling ("0" - no sampling).    */
+    boost::mutex                            mutex;      /**< Guards the list of summaries.             */
+    vector <hot_summary *>                  summaries;  /**< Summaries of all threads.                 */
+    boost::thread_specific_ptr <hot_summary> local;     /**< Summary of current thread.                */
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Creates sampler, which has not sampled anything yet.
+ */
+hot_sampler::hot_sampler (unsigned int period)      /**< [in] Period of sampling. */
+{
+    m_state = new sampler_state(period);
+    assert(m_state != NULL);
+}
+
+/**
+ * Destroys summaries of all threads.
+ */
+hot_sampler::~hot_sampler () throw ()
+{
+    delete m_state;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Changes period of sampling ("0" stops sampling, keeping the counters).
+ */
+void hot_sampler::set_period (unsigned int period)  /**< [in] Period of sampling. */
+{
+    m_state->period = period;
+}
+
+/**
+ * Counts the key, if it's the N-th key accessed by current thread since its previous sampled one.
+ * Unknown key takes a free counter, or replaces the least counted key of the summary.
+ */
+void hot_sampler::sample (const DBT * key)  /**< [in] Accessed key. */
+{
+    unsigned int period = m_state->period;
+    if (period == 0) return;
+
+    hot_summary * summary = m_state->local.get();
+
+    if (summary == NULL)
+    {
+        summary = new hot_summary;
+
+        boost::mutex::scoped_lock lock(m_state->mutex);
+        m_state->summaries.push_back(summary);
+        m_state->local.reset(summary);
+    }
+
+    if (++summary->skip < period) return;
+
+    summary->skip = 0;
+
+    string k((const char *) key->data, key->size);
+
+    boost::mutex::scoped_lock lock(summary->mutex);
+
+    map <string, hot_counter>::iterator i = summary->counters.find(k);
+
+    if (i != summary->counters.end())
+    {
+        i->second.count++;
+        return;
+    }
+
+    hot_counter counter = { 1, 0 };
+
+    if (summary->counters.size() >= HOT_COUNTERS)
+    {
+        map <string, hot_counter>::iterator least = summary->counters.begin();
+
+        for (i = summary->counters.begin(); i != summary->counters.end(); i++)
+        {
+            if (i->second.count < least->second.count) least = i;
+        }
+
+        counter.count = least->second.count + 1;
+        counter.error = least->second.count;
+
+        summary->counters.erase(least);
+    }
+
+    summary->counters[k] = counter;
+}
+
+/**
+ * Returns the most accessed keys of all threads, by merged summaries.
+ */
+void hot_sampler::top (unsigned int      count,     /**< [in]  Maximum number of keys.          */
+                       vector <hot_key> * keys)     /**< [out] Keys, the most accessed first.   */
+{
+    map <string, hot_counter> merged;
+
+    {
+        boost::mutex::scoped_lock lock(m_state->mutex);
+
+        for (size_t i = 0; i < m_state->summaries.size(); i++)
+        {
+            hot_summary * summary = m_state->summaries[i];
+
+            boost::mutex::scoped_lock guard(summary->mutex);
+
+            for (map <string, hot_counter>::const_iterator j = summary->counters.begin(); j != summary->counters.end(); j++)
+            {
+                hot_counter & total = merged[j->first];
+
+                total.count += j->second.count;
+                total.error += j->second.error;
+            }
+        }
+    }
+
+    uint64_t period = m_state->period;
+    if (period == 0) period = 1;
+
+    keys->clear();
+    keys->reserve(merged.size());
+
+    for (map <string, hot_counter>::const_iterator i = merged.begin(); i != merged.end(); i++)
+    {
+        hot_key hot;
+
+        hot.key   = i->first;
+        hot.count = i->second.count * period;
+        hot.error = i->second.error * period;
+
+        keys->push_back(hot);
+    }
+
+    std::stable_sort(keys->begin(), keys->end(), hotter);
+
+    if (keys->size() > count) keys->resize(count);
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of sampling of accessed keys of class "bdb::table".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * @private Counts accessed key by the sampler of the table (see "bdb::table::sample_key").
+ */
+void table::sample_hot (const DBT * key)    /**< [in] Serialized key. */
+{
+    m_sampler->sample(key);
+}
+
+/**
+ * Starts (or stops, if "period" is "0") sampling of keys, accessed by the table's operations and positioned
+ * recordsets (see "bdb::table_options::hot_sampling"). Sampler, created by the first call, is kept until
+ * the table is closed, so the first call should precede concurrent use of the table.
+ */
+void table::set_hot_sampling (unsigned int period)  /**< [in] Period of sampling (every N-th key). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::set_hot_sampling] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::set_hot_sampling] period = " << period);
+
+    boost::mutex::scoped_lock lock(sampler_mutex);
+
+    if (m_sampler != NULL)
+    {
+        m_sampler->set_period(period);
+    }
+    else if (period != 0)
+    {
+        m_sampler = new hot_sampler(period);
+        assert(m_sampler != NULL);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::set_hot_sampling] EXIT");
+}
+
+/**
+ * Returns the most frequently accessed keys of the table, as sampled since sampling has been started.
+ * There are no keys, if keys are not sampled.
+ */
+void table::hot_keys (vector <hot_key> * keys,      /**< [out] Keys, the most accessed first. */
+                      unsigned int       count)     /**< [in]  Maximum number of keys.        */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::hot_keys] ENTER");
+
+    keys->clear();
+
+    if (m_sampler != NULL) m_sampler->top(count, keys);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::hot_keys] EXIT = " << keys->size());
+}
+
+/**
+ * Starts (or stops) sampling of keys, accessed by keyed recordsets of the index (see "bdb::table::set_hot_sampling").
+ */
+void index::set_hot_sampling (unsigned int period)  /**< [in] Period of sampling (every N-th key). */
+{
+    table::set_hot_sampling(period);
+}
+
+/**
+ * Returns the most frequently accessed keys of the index (see "bdb::table::hot_keys").
+ */
+void index::hot_keys (vector <hot_key> * keys,      /**< [out] Keys, the most accessed first. */
+                      unsigned int       count)     /**< [in]  Maximum number of keys.        */
+{
+    table::hot_keys(keys, count);
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
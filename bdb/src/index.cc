@@ -30,8 +30,13 @@
 #include <bdb.h>
 
 // Standard C/C++ Libraries
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <string>
+#include <utility>
+#include <vector>
 
 // Protocol Buffers
 #include <google/protobuf/message.h>
@@ -44,6 +49,14 @@
 #error Berkeley DB 4.7 or later is required.
 #endif
 
+// Directories of new files of databases are available since Berkeley DB 4.8
+#if (DB_VERSION_MAJOR > 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR >= 8)
+#define BDB_CREATE_DIR
+#endif
+
+// Boost C++ Libraries
+#include <boost/thread/tss.hpp>
+
 // C++ Logging Library
 #include <log4cplus/logger.h>
 
@@ -56,14 +69,83 @@ namespace bdb
 
 using std::string;
 
+using std::pair;
+using std::string;
+using std::vector;
+
 using google::protobuf::Message;
 
+/** @private Number of index entries, loaded per committed transaction by bulk build of index. */
+static const size_t BUILD_CHUNK_SIZE = 10000;
+
+/** @private Fields of primary data, extracted for all field indexes of a table in one pass. */
+struct field_extraction
+{
+    const table         * tbl;      /**< Table of the data.                       */
+    const void          * data;     /**< Primary data ("NULL" if not extracted). */
+    u_int32_t             size;     /**< Size of primary data.                    */
+    vector <field_value>  values;   /**< Values of "table::m_fields".             */
+};
+
+/** @private Per-thread extraction of indexed fields. */
+static boost::thread_specific_ptr <field_extraction> extractions;
+
+/** @private Entry of index (pair of index key and primary key), made by bulk build of index. */
+typedef pair <string, string> build_entry;
+
+/**
+ * @private Orders entries of bulk build by index keys, and by primary keys within the same index key.
+ */
+class build_less
+{
+public:
+
+    build_less (DB * db, compare_callback fn_cmp, compare_callback fn_dup)
+      : m_db(db),
+        m_cmp(fn_cmp),
+        m_dup(fn_dup)
+    { }
+
+    bool operator () (const build_entry & e1, const build_entry & e2) const
+    {
+        int res = compare(m_cmp, e1.first, e2.first);
+        return (res != 0 ? res < 0 : compare(m_dup, e1.second, e2.second) < 0);
+    }
+
+protected:
+
+    int compare (compare_callback fn, const string & s1, const string & s2) const
+    {
+        if (fn == NULL) return s1.compare(s2);
+
+        DBT k1, k2;
+
+        memset(&k1, 0, sizeof(DBT));
+        memset(&k2, 0, sizeof(DBT));
+
+        k1.data = (void *) s1.data();
+        k1.size = (u_int32_t) s1.size();
+        k2.data = (void *) s2.data();
+        k2.size = (u_int32_t) s2.size();
+
+        return fn(m_db, &k1, &k2);
+    }
+
+protected:
+
+    DB               * m_db;
+    compare_callback   m_cmp;
+    compare_callback   m_dup;
+};
+
 //--------------------------------------------------------------------------------------------------
 //  Constructors/destructors.
 //--------------------------------------------------------------------------------------------------
 
 /**
  * Opens the index, automatically creating it if required.
+ * The index uses the same tuning options as its master table.
+ * When new index is added to a populated table, the index is built in bulk (see "index::build_index").
  *
  * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
  */
@@ -72,27 +154,91 @@ index::index (table            * tbl,       /**< [in] Master table.
               index_callback     fn_idx,    /**< [in] Indexing function (see "Db::associate()").                     */
               compare_callback   fn_cmp,    /**< [in] Index comparision function (see "Db::set_bt_compare()").       */
               compare_callback   fn_dup,    /**< [in] Duplicates comparision function (see "Db::set_dup_compare()"). */
-              bool               unique)    /**< [in] Whether the index should contain unique keys only.             */
-  : table(name)
+              bool               unique,    /**< [in] Whether the index should contain unique keys only.             */
+              project_callback   fn_proj,   /**< [in] Projection function of covering index ("NULL" if not covering). */
+              int                field,     /**< [in] Indexed field of primary data ("0" if not field index).        */
+              int                key_field, /**< [in] Field of index key (for field index).                          */
+              bool               immutable, /**< [in] Whether index keys of a record never change on update.         */
+              const message_layout * layout, /**< [in] Layout of index keys, compared by reflection ("NULL" if not). */
+              bool               deferred,  /**< [in] Whether changes are applied to the index in background.        */
+              const int        * fields,    /**< [in] Indexed fields of composite index ("NULL" if not composite).   */
+              const int        * types,     /**< [in] Types of fields of composite index ("BDB_FIELD_STRING").       */
+              int                count)     /**< [in] Number of fields of composite index.                           */
+  : table(name),
+    m_indexer(count != 0 && fn_idx == NULL ? index_by_fields : (field != 0 && fn_idx == NULL ? index_by_field : fn_idx)),
+    m_projector(fn_proj),
+    m_cover(NULL),
+    m_master(tbl),
+    m_field(field),
+    m_keyfield(key_field),
+    m_columns(fields, fields + count),
+    m_types(types, types + count),
+    m_slot(tbl->m_fields.size()),
+    m_immutable(immutable),
+    m_plain(NULL),
+    m_position(NULL),
+    m_applied(0),
+    m_foreign(NULL),
+    m_sketch(NULL)
 {
     LOG4CPLUS_TRACE(logger, "[bdb::index::index] ENTER");
     LOG4CPLUS_DEBUG(logger, "[bdb::index::index] name = " << name);
     LOG4CPLUS_DEBUG(logger, "[bdb::index::index] unique = " << unique);
 
     m_database = tbl->m_database;
+    m_callback = fn_cmp;
+    m_options  = tbl->m_options;
+    m_upgrades = tbl->m_upgrades;
+    m_layout   = layout;
+
+    // duplicate sets need some consistent order of primary keys only, which can be cheaper than the keys order
+    if (tbl->m_options.dup_bytewise)               fn_dup = NULL;
+    else if (tbl->m_options.fn_dup_compare != NULL) fn_dup = tbl->m_options.fn_dup_compare;
+
+    // primary keys of types, known at run time only, are compared by layout of the master table
+    if (fn_dup == table::compare_dynamic) fn_dup = dup_dynamic;
+
+    // indexes are always sorted, and their keys are messages even if primary keys are record numbers (or raw)
+    m_options.access_method = BDB_ACCESS_BTREE;
+    if (m_options.key_format == BDB_KEY_RECNO || m_options.key_format == BDB_KEY_RID || m_options.key_format == BDB_KEY_RAW) m_options.key_format = BDB_KEY_PROTOBUF;
+
+    // keys of composite index are sorted by Berkeley DB itself, whatever format of primary keys is
+    m_pkformat = m_options.key_format;
+    if (count != 0) m_options.key_format = BDB_KEY_ORDERED;
 
     int res = db_create(&m_db, tbl->m_db->get_env(tbl->m_db), 0);
 
+    // indexing callback of field index finds the index by its database
+    if (res == 0) m_db->app_private = this;
+
+    if (m_options.page_size != 0)
+    {
+        if (res == 0) res = m_db->set_pagesize(m_db, m_options.page_size);
+    }
+
+    if (m_options.encrypted)
+    {
+        if (res == 0) res = m_db->set_flags(m_db, DB_ENCRYPT);
+    }
+
+#ifdef BDB_CREATE_DIR
+    // index is placed with its table
+    if (m_options.data_dir != NULL && !m_database->m_memory && res == 0) res = m_db->set_create_dir(m_db, m_options.data_dir);
+#endif
+
+    // callbacks of indexes of profiled table are counted by the table
+    bool profiled = (tbl->m_counters != NULL);
+
     if (fn_cmp != NULL)
     {
-        if (res == 0) res = m_db->set_bt_compare(m_db, fn_cmp);
+        if (res == 0) res = m_db->set_bt_compare(m_db, (profiled ? compare_profiled : fn_cmp));
     }
 
     if (!unique)
     {
         if (fn_dup != NULL)
         {
-            if (res == 0) res = m_db->set_dup_compare(m_db, fn_dup);
+            if (res == 0) res = m_db->set_dup_compare(m_db, (profiled ? dup_profiled : fn_dup));
         }
 
         if (res == 0) res = m_db->set_flags(m_db, DB_DUPSORT);
@@ -100,27 +246,73 @@ index::index (table            * tbl,       /**< [in] Master table.
 
     if (res == 0)
     {
-        res = m_db->open(m_db,
-                         m_database->m_txns.top(),
-                         get_filename().c_str(),
-                         m_name.c_str(),
-                         DB_BTREE,
-                         DB_THREAD | DB_CREATE,
-                         0);
+        res = m_database->open_file(m_db,
+                                    m_database->get_transaction(),
+                                    get_filename(),
+                                    m_name,
+                                    DB_BTREE,
+                                    DB_THREAD | DB_CREATE | (m_options.multiversion ? DB_MULTIVERSION : 0));
     }
 
-    if (res == 0) res = tbl->m_db->associate(tbl->m_db, m_database->m_txns.top(), m_db, fn_idx, DB_CREATE);
+    if (res == 0) res = build_index(tbl, unique, fn_dup);
+
+    // keys of deferred index are not sketched, since Berkeley DB doesn't index them
+    bool sketched = (m_options.distinct_sketch && !deferred);
+
+    // deferred index is associated for reading only, and Berkeley DB doesn't change it
+    if (res == 0) res = tbl->m_db->associate(tbl->m_db, m_database->get_transaction(), m_db, (deferred ? index_deferred : (sketched ? index_sketched : (profiled ? index_profiled : m_indexer))), (immutable ? DB_IMMUTABLE_KEY : 0));
+
+    if (res == 0)                    res = open_plain(tbl, unique, fn_dup);
+    if (res == 0 && fn_proj != NULL) res = open_cover(tbl);
+    if (res == 0 && deferred)        res = open_deferred(tbl);
+    if (res == 0 && sketched)        res = open_sketch();
 
     if (res != 0)
     {
         LOG4CPLUS_WARN(logger, "[bdb::index::index] " << db_strerror(res));
-        if (m_db != NULL) m_db->close(m_db, 0);
+        if (m_position != NULL) m_position->close(m_position, 0);
+        if (m_plain != NULL) m_plain->close(m_plain, 0);
+        if (m_cover != NULL) m_cover->close(m_cover, 0);
+        if (m_db    != NULL) m_db->close(m_db, 0);
         throw exception(BDB_ERROR_UNKNOWN);
     }
 
+    if (field != 0 && fn_idx == NULL) tbl->m_fields.push_back(field);
+
     LOG4CPLUS_TRACE(logger, "[bdb::index::index] EXIT");
 }
 
+/**
+ * Closes projections of covering index and plain handle of the index (the index itself is closed by
+ * the table destructor), stops applying changes to deferred index, and persists sketch of its keys.
+ */
+index::~index () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::index::~index] ENTER");
+
+    // the sketch is persisted while the plain handle is still opened
+    close_sketch();
+
+    if (m_position != NULL)
+    {
+        if (m_database->m_applier != NULL) m_database->m_applier->remove(this);
+
+        m_position->close(m_position, m_database->m_close_flags);
+    }
+
+    if (m_plain != NULL)
+    {
+        m_plain->close(m_plain, m_database->m_close_flags);
+    }
+
+    if (m_cover != NULL)
+    {
+        m_cover->close(m_cover, m_database->m_close_flags);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::index::~index] EXIT");
+}
+
 //--------------------------------------------------------------------------------------------------
 //  Public interface.
 //--------------------------------------------------------------------------------------------------
@@ -150,6 +342,8 @@ void index::add_foreign (table * foreign,   /**< [in] Master table. */
         throw exception(BDB_ERROR_UNKNOWN);
     }
 
+    m_foreign = foreign;
+
     LOG4CPLUS_TRACE(logger, "[bdb::index::add_foreign] EXIT");
 }
 
@@ -173,6 +367,8 @@ void index::add_foreign (table            * foreign,    /**< [in] Master table.
         throw exception(BDB_ERROR_UNKNOWN);
     }
 
+    m_foreign = foreign;
+
     LOG4CPLUS_TRACE(logger, "[bdb::index::add_foreign] EXIT");
 }
 
@@ -183,15 +379,1005 @@ void index::add_foreign (table            * foreign,    /**< [in] Master table.
  * @return true  - at least one record exists.
  * @return false - no record is found.
  */
-bool index::exists (const Message * key)    /**< [in] Key of the record to be checked. */
+bool index::exists (key_ref         key,    /**< [in] Key of the record to be checked.             */
+                    transaction   * txn)    /**< [in] Transaction to use (current one, if "NULL"). */
 {
     LOG4CPLUS_TRACE(logger, "[bdb::index::exists] ENTER");
-    bool res = table::exists(key);
+    bool res = table::exists(key, txn);
     LOG4CPLUS_TRACE(logger, "[bdb::index::exists] EXIT = " << res);
 
     return res;
 }
 
+/**
+ * Returns number of records with specified key in the index ("DBcursor->count").
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+unsigned int index::count (key_ref         key,    /**< [in] Key of the records to be counted.            */
+                           transaction   * txn)    /**< [in] Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::index::count] ENTER");
+
+    DBC * cursor = NULL;
+
+    int res = m_db->cursor(m_db, m_database->get_transaction(txn), &cursor, m_database->read_flags(txn));
+
+    db_recno_t count = 0;
+
+    if (res == 0)
+    {
+        scratch_scope scope;
+        DBT k, d;
+
+        encode_key(key, &k, &scope);
+
+        // only position the cursor, primary key is not needed
+        memset(&d, 0, sizeof(DBT));
+        d.flags = DB_DBT_PARTIAL;
+
+        res = cursor->get(cursor, &k, &d, DB_SET);
+        release(&k);
+
+        if      (res == 0)           res = cursor->count(cursor, &count, 0);
+        else if (res == DB_NOTFOUND) res = 0;
+    }
+
+    if (cursor != NULL)
+    {
+        cursor->close(cursor);
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::index::count] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::index::count] EXIT = " << count);
+
+    return count;
+}
+
+/**
+ * Returns all distinct keys of the index in their order (serialized in format of the index), skipping
+ * duplicates of each key at once ("DB_NEXT_NODUP"), and number of records with each of them, if required.
+ * Primary records are not read.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return Number of distinct keys.
+ */
+unsigned int index::distinct_keys (vector <string>       * keys,    /**< [out] Serialized distinct keys.                       */
+                                   vector <unsigned int> * counts,  /**< [out] Numbers of records with the keys (can be "NULL"). */
+                                   transaction           * txn)     /**< [in]  Transaction to use (current one, if "NULL").    */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::index::distinct_keys] ENTER");
+
+    keys->clear();
+    if (counts != NULL) counts->clear();
+
+    DBC * cursor = NULL;
+
+    int res = m_plain->cursor(m_plain, m_database->get_transaction(txn), &cursor, m_database->read_flags(txn));
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.flags = DB_DBT_REALLOC;
+
+    // only keys are read
+    d.flags = DB_DBT_PARTIAL;
+
+    while (res == 0 && (res = cursor->get(cursor, &k, &d, DB_NEXT_NODUP)) == 0)
+    {
+        keys->push_back(string((const char *) k.data, k.size));
+
+        if (counts != NULL)
+        {
+            db_recno_t count = 0;
+            res = cursor->count(cursor, &count, 0);
+            counts->push_back(count);
+        }
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    free(k.data);
+
+    if (cursor != NULL)
+    {
+        cursor->close(cursor);
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::index::distinct_keys] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::index::distinct_keys] EXIT = " << keys->size());
+
+    return (unsigned int) keys->size();
+}
+
+/**
+ * Estimates proportions of records with index keys before, within, and after specified range.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @see table::estimate_range
+ */
+void index::estimate_range (const Message * lower,      /**< [in]  Lower bound (can be "NULL").                 */
+                            const Message * upper,      /**< [in]  Upper bound (can be "NULL").                 */
+                            key_estimate  * result,     /**< [out] Estimated proportions.                       */
+                            transaction   * txn)        /**< [in]  Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::index::estimate_range] ENTER");
+    table::estimate_range(lower, upper, result, txn);
+    LOG4CPLUS_TRACE(logger, "[bdb::index::estimate_range] EXIT");
+}
+
+/**
+ * Sets priority of pages of the index in the shared cache, with projections of covering index
+ * (see "bdb::table::set_cache_priority"), e.g. to keep a hot index cached while large tables are scanned.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void index::set_cache_priority (int priority)   /**< [in] Priority of pages. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::index::set_cache_priority] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::index::set_cache_priority] priority = " << priority);
+
+    int res = set_priority(m_db, priority);
+
+    if (res == 0 && m_cover != NULL) res = set_priority(m_cover, priority);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::index::set_cache_priority] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::index::set_cache_priority] EXIT");
+}
+
+/**
+ * Returns size of the index on disk and in memory, with projections of covering index (see "bdb::table::footprint").
+ * Both databases share the file of the index, so their pages and sampled records are added together.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void index::footprint (table_footprint * result,    /**< [out] Footprint of the index.           */
+                       unsigned int      samples)   /**< [in]  Maximum number of sampled records. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::index::footprint] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::index::footprint] samples = " << samples);
+
+    memset(result, 0, sizeof(table_footprint));
+
+    int res = measure_file(m_db, samples, result);
+
+    if (res == 0 && m_cover != NULL) res = measure_file(m_cover, samples, result);
+    if (res == 0) res = measure_cache(get_filename(), result);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::index::footprint] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    if (result->sampled != 0)
+    {
+        result->key_bytes   /= result->sampled;
+        result->value_bytes /= result->sampled;
+    }
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::index::footprint] pages = " << result->pages << ", cached = " << result->cached_pages);
+    LOG4CPLUS_TRACE(logger, "[bdb::index::footprint] EXIT");
+}
+
+/**
+ * Compacts the index online, with projections of covering index (see "bdb::table::compact").
+ * Results of both files are added together.
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - a step is repeatedly rolled back by deadlocks.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+void index::compact (const compact_options & options,   /**< [in]  Options of the compaction.          */
+                     compact_result        * result)    /**< [out] Results of the compaction (can be "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::index::compact] ENTER");
+
+    compact_result total;
+    memset(&total, 0, sizeof(compact_result));
+
+    uint64_t deadline = (options.timeout != 0 ? monotonic_time() + (uint64_t) options.timeout * 1000000 : 0);
+
+    int res = compact_file(m_db, options, deadline, &total);
+
+    // budgets are shared by both files (results are cumulative)
+    if (res == 0 && m_cover != NULL && total.completed)
+    {
+        res = compact_file(m_cover, options, deadline, &total);
+    }
+
+    if (result != NULL) *result = total;
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::index::compact] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::index::compact] EXIT = " << total.completed);
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Covering indexes.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * @private Frees result of application callback, if it was allocated by the callback.
+ */
+static void release_result (DBT * dbt)
+{
+    // keys of multi-key result are allocated by the callback each on its own
+    if (dbt->flags & DB_DBT_MULTIPLE)
+    {
+        DBT * keys = (DBT *) dbt->data;
+
+        for (u_int32_t i = 0; i < dbt->size; i++)
+        {
+            if (keys[i].flags & DB_DBT_APPMALLOC) free(keys[i].data);
+        }
+    }
+
+    if (dbt->flags & DB_DBT_APPMALLOC) free(dbt->data);
+    memset(dbt, 0, sizeof(DBT));
+}
+
+/**
+ * Builds empty index of populated table in bulk.
+ * Index keys of all records are made at once and sorted, and then are loaded in order of the index by
+ * chunks, each committed in its own nested transaction, so the index pages are filled sequentially and
+ * number of locks remains bounded. Nothing is done if the index already contains any entries.
+ * Returns error code of Berkeley DB.
+ */
+int index::build_index (table            * tbl,     /**< [in] Master table.                        */
+                        bool               unique,  /**< [in] Whether the index is unique.         */
+                        compare_callback   fn_dup)  /**< [in] Duplicates comparision function.     */
+{
+    DB_TXN * parent = m_database->get_transaction();
+
+    DBC * cursor = NULL;
+
+    DBT k, d;
+
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    d.flags = DB_DBT_PARTIAL;
+
+    // the index is built only if it's empty
+    int res = m_db->cursor(m_db, parent, &cursor, m_database->read_flags());
+
+    if (res == 0) res = cursor->get(cursor, &k, &d, DB_FIRST);
+
+    if (cursor != NULL) cursor->close(cursor);
+
+    if (res != DB_NOTFOUND)
+    {
+        return (res == 0 ? 0 : res);
+    }
+
+    // make index keys of all records
+    vector <build_entry> entries;
+
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.flags = DB_DBT_REALLOC;
+    d.flags = DB_DBT_REALLOC;
+
+    cursor = NULL;
+    res = tbl->m_db->cursor(tbl->m_db, parent, &cursor, m_database->read_flags());
+
+    while (res == 0 && (res = cursor->get(cursor, &k, &d, DB_NEXT)) == 0)
+    {
+        DBT r;
+        memset(&r, 0, sizeof(DBT));
+
+        res = m_indexer(m_db, &k, &d, &r);
+
+        if (res == DB_DONOTINDEX)
+        {
+            res = 0;
+            continue;
+        }
+
+        if (res != 0) break;
+
+        string pkey((const char *) k.data, k.size);
+
+        if (r.flags & DB_DBT_MULTIPLE)
+        {
+            DBT * keys = (DBT *) r.data;
+
+            for (u_int32_t i = 0; i < r.size; i++)
+            {
+                entries.push_back(build_entry(string((const char *) keys[i].data, keys[i].size), pkey));
+            }
+        }
+        else
+        {
+            entries.push_back(build_entry(string((const char *) r.data, r.size), pkey));
+        }
+
+        release_result(&r);
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL) cursor->close(cursor);
+
+    free(k.data);
+    free(d.data);
+
+    std::sort(entries.begin(), entries.end(), build_less(m_db, m_callback, fn_dup));
+
+    // load sorted index keys by chunks
+    for (size_t first = 0; first < entries.size() && res == 0; first += BUILD_CHUNK_SIZE)
+    {
+        size_t last = std::min(first + BUILD_CHUNK_SIZE, entries.size());
+
+        DB_TXN * ctxn = NULL;
+        res = m_database->begin_txn(parent, &ctxn, BDB_DURABILITY_DEFAULT);
+
+        for (size_t i = first; i < last && res == 0; i++)
+        {
+            DBT sk, pk;
+
+            memset(&sk, 0, sizeof(DBT));
+            memset(&pk, 0, sizeof(DBT));
+
+            sk.data = (void *) entries[i].first.data();
+            sk.size = (u_int32_t) entries[i].first.size();
+            pk.data = (void *) entries[i].second.data();
+            pk.size = (u_int32_t) entries[i].second.size();
+
+            res = m_db->put(m_db, ctxn, &sk, &pk, (unique ? DB_NOOVERWRITE : 0));
+        }
+
+        if (res == 0)
+        {
+            res = m_database->commit_txn(ctxn, BDB_DURABILITY_DEFAULT, parent != NULL);
+        }
+        else if (ctxn != NULL)
+        {
+            m_database->abort_txn(ctxn);
+        }
+    }
+
+    // partially loaded index must not be mistaken for built one
+    if (res != 0 && !entries.empty())
+    {
+        u_int32_t count = 0;
+        m_db->truncate(m_db, parent, &count, 0);
+    }
+
+    return res;
+}
+
+/**
+ * Indexing callback of field indexes (see "table::add_index").
+ * When fields of the data are already extracted for all field indexes of the table (see "index::begin_extract"),
+ * the index key is made from the extracted value, otherwise the field is looked up in the data.
+ */
+int index::index_by_field (DB        * sec,     /**< [in]  Database of the index.    */
+                           const DBT *,         /**< [in]  Primary key (unused).     */
+                           const DBT * data,    /**< [in]  Serialized primary data.  */
+                           DBT       * result)  /**< [out] Serialized index key.     */
+{
+    index * idx = (index *) sec->app_private;
+
+    field_extraction * x = extractions.get();
+
+    if (x != NULL && x->tbl == idx->m_master && x->data == data->data && x->size == data->size)
+    {
+        return index_value(&x->values[idx->m_slot], idx->m_keyfield, result);
+    }
+
+    field_value value;
+    extract_field(data, idx->m_field, &value);
+
+    return index_value(&value, idx->m_keyfield, result);
+}
+
+/**
+ * Indexing callback of field indexes over repeated fields (see "table::add_index"),
+ * which indexes the record by each value of the field (see "bdb::index_repeated").
+ */
+int index::index_by_repeated (DB        * sec,     /**< [in]  Database of the index.    */
+                              const DBT *,         /**< [in]  Primary key (unused).     */
+                              const DBT * data,    /**< [in]  Serialized primary data.  */
+                              DBT       * result)  /**< [out] Serialized index keys.    */
+{
+    index * idx = (index *) sec->app_private;
+
+    return index_repeated(data, idx->m_field, idx->m_keyfield, result);
+}
+
+/**
+ * Indexing callback of composite indexes (see "table::add_index"), which makes keys in order-preserving
+ * format from several fields of primary data (see "bdb::index_fields").
+ */
+int index::index_by_fields (DB        * sec,     /**< [in]  Database of the index.    */
+                            const DBT *,         /**< [in]  Primary key (unused).     */
+                            const DBT * data,    /**< [in]  Serialized primary data.  */
+                            DBT       * result)  /**< [out] Serialized index key.     */
+{
+    index * idx = (index *) sec->app_private;
+
+    return index_fields(data, &idx->m_columns[0], &idx->m_types[0], (int) idx->m_columns.size(), result);
+}
+
+/**
+ * Indexing callback of full-text indexes (see "table::add_text_index"), which indexes the record
+ * by each word of the field (see "bdb::index_words").
+ */
+int index::index_by_words (DB        * sec,     /**< [in]  Database of the index.    */
+                           const DBT *,         /**< [in]  Primary key (unused).     */
+                           const DBT * data,    /**< [in]  Serialized primary data.  */
+                           DBT       * result)  /**< [out] Serialized index keys.    */
+{
+    index * idx = (index *) sec->app_private;
+
+    return index_words(data, idx->m_field, result);
+}
+
+/**
+ * Trampoline of indexing function of profiled table (see "bdb::table_options::profile_callbacks").
+ */
+int index::index_profiled (DB        * sec,     /**< [in]  Database of the index.    */
+                           const DBT * key,     /**< [in]  Primary key.              */
+                           const DBT * data,    /**< [in]  Serialized primary data.  */
+                           DBT       * result)  /**< [out] Serialized index key.     */
+{
+    index * idx = (index *) sec->app_private;
+
+    uint64_t start = monotonic_time();
+    int res = idx->m_indexer(sec, key, data, result);
+    idx->m_master->count_callback(BDB_CALLBACK_INDEX, start);
+
+    return res;
+}
+
+/**
+ * Trampoline of comparison function of index (and its projections) of profiled table.
+ */
+int index::compare_profiled (DB        * db,    /**< [in] Database of the index. */
+                             const DBT * dbt1,  /**< [in] First key.             */
+                             const DBT * dbt2)  /**< [in] Second key.            */
+{
+    index * idx = (index *) db->app_private;
+
+    uint64_t start = monotonic_time();
+    int res = idx->m_callback(db, dbt1, dbt2);
+    idx->m_master->count_callback(BDB_CALLBACK_INDEX_COMPARE, start);
+
+    return res;
+}
+
+/**
+ * Trampoline of duplicates comparison function of index of profiled table (primary keys are compared
+ * by duplicates comparison function of the table, or by its keys comparison function).
+ */
+int index::dup_profiled (DB        * db,    /**< [in] Database of the index. */
+                         const DBT * dbt1,  /**< [in] First primary key.     */
+                         const DBT * dbt2)  /**< [in] Second primary key.    */
+{
+    index * idx = (index *) db->app_private;
+
+    uint64_t start = monotonic_time();
+    compare_callback fn_dup = idx->m_master->m_options.fn_dup_compare;
+
+    int res = (fn_dup != NULL ? fn_dup(db, dbt1, dbt2) :
+              (idx->m_master->m_layout != NULL ? dup_dynamic(db, dbt1, dbt2) : idx->m_master->m_callback(db, dbt1, dbt2)));
+    idx->m_master->count_callback(BDB_CALLBACK_INDEX_COMPARE, start);
+
+    return res;
+}
+
+/**
+ * Comparison function of index with keys of type, known at run time only (see "table::add_index").
+ */
+int index::compare_dynamic (DB        * db,     /**< [in] Database of the index. */
+                            const DBT * dbt1,   /**< [in] First key.             */
+                            const DBT * dbt2)   /**< [in] Second key.            */
+{
+    index * idx = (index *) db->app_private;
+
+    return idx->m_layout->compare(dbt1, dbt2);
+}
+
+/**
+ * Duplicates comparison function of index of table with keys of type, known at run time only
+ * (primary keys are compared by layout of the master table).
+ */
+int index::dup_dynamic (DB        * db,     /**< [in] Database of the index. */
+                        const DBT * dbt1,   /**< [in] First primary key.     */
+                        const DBT * dbt2)   /**< [in] Second primary key.    */
+{
+    index * idx = (index *) db->app_private;
+
+    return idx->m_master->m_layout->compare(dbt1, dbt2);
+}
+
+/**
+ * Extracts all fields, indexed by field indexes of specified table, from specified data in one pass,
+ * so indexing callbacks of the indexes don't look the fields up one by one while the data is being put.
+ */
+void index::begin_extract (table     * tbl,     /**< [in] Table of the data.        */
+                           const DBT * data)    /**< [in] Serialized primary data.  */
+{
+    // a single field is found as fast by its index
+    if (tbl->m_fields.size() < 2) return;
+
+    field_extraction * x = extractions.get();
+
+    if (x == NULL)
+    {
+        x = new field_extraction;
+        extractions.reset(x);
+    }
+
+    x->tbl  = tbl;
+    x->data = data->data;
+    x->size = data->size;
+
+    x->values.resize(tbl->m_fields.size());
+    extract_fields(data, &tbl->m_fields[0], (int) tbl->m_fields.size(), &x->values[0]);
+}
+
+/**
+ * Discards fields, extracted by "index::begin_extract".
+ */
+void index::end_extract ()
+{
+    field_extraction * x = extractions.get();
+    if (x != NULL) x->data = NULL;
+}
+
+/**
+ * Opens plain handle of the index, which is not associated with the master table, so its cursors read
+ * primary keys as data without looking up primary records, and its duplicates can be read in bulk
+ * ("DB_MULTIPLE"). Changes of deferred index are written through this handle as well.
+ * Returns error code of Berkeley DB.
+ */
+int index::open_plain (table            * tbl,      /**< [in] Master table.                       */
+                       bool               unique,   /**< [in] Whether the index has unique keys.  */
+                       compare_callback   fn_dup)   /**< [in] Duplicates comparision function.    */
+{
+    int res = db_create(&m_plain, tbl->m_db->get_env(tbl->m_db), 0);
+
+    if (res == 0) m_plain->app_private = this;
+
+    if (m_options.page_size != 0)
+    {
+        if (res == 0) res = m_plain->set_pagesize(m_plain, m_options.page_size);
+    }
+
+    if (m_options.encrypted)
+    {
+        if (res == 0) res = m_plain->set_flags(m_plain, DB_ENCRYPT);
+    }
+
+    if (m_callback != NULL)
+    {
+        if (res == 0) res = m_plain->set_bt_compare(m_plain, m_callback);
+    }
+
+    if (!unique)
+    {
+        if (fn_dup != NULL)
+        {
+            if (res == 0) res = m_plain->set_dup_compare(m_plain, fn_dup);
+        }
+
+        if (res == 0) res = m_plain->set_flags(m_plain, DB_DUPSORT);
+    }
+
+    if (res == 0)
+    {
+        res = m_database->open_file(m_plain,
+                                    m_database->get_transaction(),
+                                    get_filename(),
+                                    m_name,
+                                    DB_BTREE,
+                                    DB_THREAD | (m_options.multiversion ? DB_MULTIVERSION : 0));
+    }
+
+    return res;
+}
+
+/**
+ * Opens projections of covering index, which are stored in the same file as the index.
+ * Each projection is a duplicate of index key, which is made of primary key and projected primary data,
+ * so recordsets of the index can be served without reading the table.
+ * When the projections are empty (e.g. they are just created), they are made from all records of the table.
+ */
+int index::open_cover (table * tbl)     /**< [in] Master table. */
+{
+    DB_TXN * txn = m_database->get_transaction();
+
+    int res = db_create(&m_cover, tbl->m_db->get_env(tbl->m_db), 0);
+
+    if (res == 0) m_cover->app_private = this;
+
+    if (m_options.page_size != 0)
+    {
+        if (res == 0) res = m_cover->set_pagesize(m_cover, m_options.page_size);
+    }
+
+    if (m_options.encrypted)
+    {
+        if (res == 0) res = m_cover->set_flags(m_cover, DB_ENCRYPT);
+    }
+
+#ifdef BDB_CREATE_DIR
+    if (m_options.data_dir != NULL && !m_database->m_memory && res == 0) res = m_cover->set_create_dir(m_cover, m_options.data_dir);
+#endif
+
+    if (m_callback != NULL)
+    {
+        if (res == 0) res = m_cover->set_bt_compare(m_cover, (tbl->m_counters != NULL ? compare_profiled : m_callback));
+    }
+
+    if (res == 0) res = m_cover->set_flags(m_cover, DB_DUPSORT);
+
+    if (res == 0)
+    {
+        res = m_database->open_file(m_cover,
+                                    txn,
+                                    get_filename(),
+                                    m_name + ".cover",
+                                    DB_BTREE,
+                                    DB_THREAD | DB_CREATE | (m_options.multiversion ? DB_MULTIVERSION : 0));
+    }
+
+    DBC * cursor = NULL;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    if (res == 0) res = m_cover->cursor(m_cover, txn, &cursor, 0);
+
+    if (res == 0)
+    {
+        k.flags = DB_DBT_PARTIAL;
+        d.flags = DB_DBT_PARTIAL;
+
+        res = cursor->get(cursor, &k, &d, DB_FIRST);
+        cursor->close(cursor);
+        cursor = NULL;
+
+        if (res == DB_NOTFOUND)
+        {
+            LOG4CPLUS_DEBUG(logger, "[bdb::index::index] filling covering index");
+
+            res = tbl->m_db->cursor(tbl->m_db, txn, &cursor, 0);
+
+            k.flags = DB_DBT_REALLOC;
+            d.flags = DB_DBT_REALLOC;
+
+            while (res == 0 && (res = cursor->get(cursor, &k, &d, DB_NEXT)) == 0)
+            {
+                res = put_cover(txn, &k, &d);
+            }
+
+            if (res == DB_NOTFOUND) res = 0;
+
+            if (cursor != NULL) cursor->close(cursor);
+
+            free(k.data);
+            free(d.data);
+        }
+    }
+
+    return res;
+}
+
+/**
+ * @private Makes own copy of specified index key.
+ */
+static void copy_key (const DBT * from, DBT * to)
+{
+    memset(to, 0, sizeof(DBT));
+
+    to->data  = malloc(from->size == 0 ? 1 : from->size);
+    to->flags = DB_DBT_USERMEM | DB_DBT_APPMALLOC;
+    to->ulen  = from->size;
+    to->size  = from->size;
+    memcpy(to->data, from->data, from->size);
+}
+
+/**
+ * @private Checks whether specified index keys (either single, or multi-key ones) are the same.
+ */
+static bool same_keys (const DBT * k1, const DBT * k2)
+{
+    if ((k1->flags & DB_DBT_MULTIPLE) != (k2->flags & DB_DBT_MULTIPLE) || k1->size != k2->size)
+    {
+        return false;
+    }
+
+    if ((k1->flags & DB_DBT_MULTIPLE) == 0)
+    {
+        return memcmp(k1->data, k2->data, k1->size) == 0;
+    }
+
+    const DBT * keys1 = (const DBT *) k1->data;
+    const DBT * keys2 = (const DBT *) k2->data;
+
+    for (u_int32_t i = 0; i < k1->size; i++)
+    {
+        if (keys1[i].size != keys2[i].size || memcmp(keys1[i].data, keys2[i].data, keys1[i].size) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Makes index key and entry of covering index for specified primary record.
+ * When the indexing function returns several keys ("DB_DBT_MULTIPLE"), the entry is stored by each of them.
+ * Returns "DB_DONOTINDEX" if the record is not indexed.
+ */
+int index::make_cover (const DBT * pkey,    /**< [in]  Primary key.                                 */
+                       const DBT * pdata,   /**< [in]  Primary data.                                */
+                       DBT       * skey,    /**< [out] Index key (to be freed by "release_result"). */
+                       DBT       * entry)   /**< [out] Entry (to be freed by "bdb::release").       */
+{
+    DBT proj;
+
+    memset(skey,  0, sizeof(DBT));
+    memset(entry, 0, sizeof(DBT));
+    memset(&proj, 0, sizeof(DBT));
+
+    DBT key;
+    int res = m_indexer(m_db, pkey, pdata, &key);
+
+    if (res != 0)
+    {
+        return res;
+    }
+
+    res = m_projector(m_db, pkey, pdata, &proj);
+
+    if (res != 0)
+    {
+        release_result(&key);
+        return res;
+    }
+
+    // own copy of the key, so it doesn't depend on how the callback allocated it
+    if (key.flags & DB_DBT_MULTIPLE)
+    {
+        DBT * keys = (DBT *) key.data;
+        DBT * copy = (DBT *) malloc(key.size * sizeof(DBT));
+
+        for (u_int32_t i = 0; i < key.size; i++)
+        {
+            copy_key(&keys[i], &copy[i]);
+        }
+
+        skey->data  = copy;
+        skey->flags = DB_DBT_MULTIPLE | DB_DBT_APPMALLOC;
+        skey->size  = key.size;
+    }
+    else
+    {
+        copy_key(&key, skey);
+    }
+
+    // entry is [size of primary key][primary key][projection]
+    u_int32_t size = sizeof(u_int32_t) + pkey->size + proj.size;
+
+    entry->data  = malloc(size);
+    entry->flags = DB_DBT_USERMEM | DB_DBT_APPMALLOC;
+    entry->ulen  = size;
+    entry->size  = size;
+
+    uint8_t * ptr = (uint8_t *) entry->data;
+
+    memcpy(ptr, &pkey->size, sizeof(u_int32_t));
+    memcpy(ptr + sizeof(u_int32_t), pkey->data, pkey->size);
+    memcpy(ptr + sizeof(u_int32_t) + pkey->size, proj.data, proj.size);
+
+    release_result(&key);
+    release_result(&proj);
+
+    return 0;
+}
+
+/**
+ * Adds entry of specified primary record into covering index.
+ */
+int index::put_cover (DB_TXN    * txn,      /**< [in] Transaction to use. */
+                      const DBT * pkey,     /**< [in] Primary key.        */
+                      const DBT * pdata)    /**< [in] Primary data.       */
+{
+    DBT k, e;
+
+    int res = make_cover(pkey, pdata, &k, &e);
+
+    if (res == DB_DONOTINDEX)
+    {
+        return 0;
+    }
+
+    if (res == 0)
+    {
+        res = put_entry(txn, &k, &e);
+
+        release_result(&k);
+        release(&e);
+    }
+
+    return res;
+}
+
+/**
+ * Removes entry of specified primary record from covering index.
+ */
+int index::del_cover (DB_TXN    * txn,      /**< [in] Transaction to use. */
+                      const DBT * pkey,     /**< [in] Primary key.        */
+                      const DBT * pdata)    /**< [in] Old primary data.   */
+{
+    DBT k, e;
+
+    int res = make_cover(pkey, pdata, &k, &e);
+
+    if (res == DB_DONOTINDEX)
+    {
+        return 0;
+    }
+
+    if (res == 0)
+    {
+        res = del_entry(txn, &k, &e);
+
+        release_result(&k);
+        release(&e);
+    }
+
+    return res;
+}
+
+/**
+ * Replaces entry of updated primary record in covering index.
+ * When neither index key nor projection of the record is changed, the covering index is not written at all.
+ */
+int index::move_cover (DB_TXN    * txn,         /**< [in] Transaction to use.  */
+                       const DBT * pkey,        /**< [in] Primary key.         */
+                       const DBT * olddata,     /**< [in] Old primary data.    */
+                       const DBT * newdata)     /**< [in] New primary data.    */
+{
+    DBT ok, oe, nk, ne;
+
+    int ores = make_cover(pkey, olddata, &ok, &oe);
+
+    if (ores != 0 && ores != DB_DONOTINDEX)
+    {
+        return ores;
+    }
+
+    int nres = make_cover(pkey, newdata, &nk, &ne);
+
+    if (nres != 0 && nres != DB_DONOTINDEX)
+    {
+        if (ores == 0)
+        {
+            release_result(&ok);
+            release(&oe);
+        }
+
+        return nres;
+    }
+
+    int res = 0;
+
+    bool same = (ores == 0 && nres == 0 &&
+                 same_keys(&ok, &nk) &&
+                 oe.size == ne.size && memcmp(oe.data, ne.data, oe.size) == 0);
+
+    if (!same)
+    {
+        if (ores == 0)             res = del_entry(txn, &ok, &oe);
+        if (nres == 0 && res == 0) res = put_entry(txn, &nk, &ne);
+    }
+
+    if (ores == 0)
+    {
+        release_result(&ok);
+        release(&oe);
+    }
+
+    if (nres == 0)
+    {
+        release_result(&nk);
+        release(&ne);
+    }
+
+    return res;
+}
+
+/**
+ * Adds specified entry into covering index.
+ */
+int index::put_entry (DB_TXN * txn,     /**< [in] Transaction to use. */
+                      DBT    * skey,    /**< [in] Index key.          */
+                      DBT    * entry)   /**< [in] Entry.              */
+{
+    // record of multi-key index has the entry by each of its keys
+    if (skey->flags & DB_DBT_MULTIPLE)
+    {
+        DBT * keys = (DBT *) skey->data;
+        int   res  = 0;
+
+        for (u_int32_t i = 0; i < skey->size && res == 0; i++) res = put_entry(txn, &keys[i], entry);
+
+        return res;
+    }
+
+    int res = m_cover->put(m_cover, txn, skey, entry, DB_NODUPDATA);
+    if (res == DB_KEYEXIST) res = 0;
+
+    return res;
+}
+
+/**
+ * Removes specified entry from covering index.
+ */
+int index::del_entry (DB_TXN * txn,     /**< [in] Transaction to use. */
+                      DBT    * skey,    /**< [in] Index key.          */
+                      DBT    * entry)   /**< [in] Entry.              */
+{
+    if (skey->flags & DB_DBT_MULTIPLE)
+    {
+        DBT * keys = (DBT *) skey->data;
+        int   res  = 0;
+
+        for (u_int32_t i = 0; i < skey->size && res == 0; i++) res = del_entry(txn, &keys[i], entry);
+
+        return res;
+    }
+
+    DBC * cursor = NULL;
+
+    int res = m_cover->cursor(m_cover, txn, &cursor, m_database->write_flags());
+
+    if (res == 0) res = cursor->get(cursor, skey, entry, DB_GET_BOTH);
+    if (res == 0) res = cursor->del(cursor, 0);
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL) cursor->close(cursor);
+
+    return res;
+}
+
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -0,0 +1,969 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+
+/** @file bdb/src/join.cc
+ * Contains implementation of class "bdb::table_join".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Protocol Buffers
+#include <google/protobuf/message.h>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::table_join".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::string;
+using std::vector;
+
+using google::protobuf::Message;
+using google::protobuf::uint8;
+
+/** @private Size of blocks of the arena of hashed records. */
+static const size_t JOIN_BLOCK_SIZE = 64 * 1024;
+
+/** @private Alignment of records in the arena. */
+static const size_t JOIN_ALIGNMENT = 8;
+
+/** @private Record of the build side of hash join, kept in the arena (serialized key and data follow). */
+struct join_row
+{
+    u_int32_t   ksize;      /**< Size of serialized key.   */
+    u_int32_t   dsize;      /**< Size of serialized data.  */
+};
+
+/** @private Join key of hashed record, kept in the arena (raw join key follows). */
+struct join_entry
+{
+    join_entry      * next;     /**< Next entry of the same bucket.    */
+    const join_row  * row;      /**< Record of the join key.           */
+    uint64_t          hash;     /**< Hash of the join key.             */
+    u_int32_t         size;     /**< Size of the join key.             */
+};
+
+/** @private Hashes raw join key (FNV-1a). */
+static uint64_t join_hash (const void * data, size_t size)
+{
+    const uint8 * p = (const uint8 *) data;
+    uint64_t h = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+
+    return h;
+}
+
+/** @private Splits record, copied from a recordset (size of key, key and data), into its key and data. */
+static void split_record (const string & record, DBT * key, DBT * data)
+{
+    u_int32_t ksize;
+    memcpy(&ksize, record.data(), sizeof(ksize));
+
+    key->data  = (void *) (record.data() + sizeof(ksize));
+    key->size  = ksize;
+    data->data = (void *) (record.data() + sizeof(ksize) + ksize);
+    data->size = (u_int32_t) (record.size() - sizeof(ksize) - ksize);
+}
+
+/** @private Copies record of a recordset into a string (see "split_record"). */
+static void copy_record (const DBT * key, const DBT * data, string * record)
+{
+    u_int32_t ksize = key->size;
+
+    record->assign((const char *) &ksize, sizeof(ksize));
+    record->append((const char *) key->data, key->size);
+    record->append((const char *) data->data, data->size);
+}
+
+/** @private Join key of outer record of index join. */
+struct join_probe
+{
+    string      key;    /**< Raw join key.                          */
+    size_t      row;    /**< Position of outer record in the batch. */
+};
+
+/** @private Orders join keys of a batch the way the probed index (or table) sorts them. */
+class join_less
+{
+public:
+
+    join_less (table * tbl) : m_table(tbl) { }
+
+    bool operator () (const join_probe & p1, const join_probe & p2) const
+    {
+        DBT d1, d2;
+
+        memset(&d1, 0, sizeof(DBT));
+        memset(&d2, 0, sizeof(DBT));
+
+        d1.data = (void *) p1.key.data();
+        d1.size = (u_int32_t) p1.key.size();
+        d2.data = (void *) p2.key.data();
+        d2.size = (u_int32_t) p2.key.size();
+
+        return m_table->compare_keys(&d1, &d2) < 0;
+    }
+
+protected:
+
+    table * m_table;    /**< Probed index (or table). */
+};
+
+/** @private Current record of a side of the join. */
+struct join_side
+{
+    join_side () : valid(false)
+    {
+        memset(&key,  0, sizeof(DBT));
+        memset(&data, 0, sizeof(DBT));
+    }
+
+    DBT                 key;    /**< Current key (references fetch buffer of the recordset).  */
+    DBT                 data;   /**< Current data (references fetch buffer of the recordset). */
+    vector <string>     keys;   /**< Join keys of the current record.                         */
+    bool                valid;  /**< Whether the side has current record.                     */
+};
+
+/** @private Hash of the build side of hash join, or records of equal join keys of sort-merge one. */
+class join_state
+{
+public:
+
+    join_state () : build(0), built(false), started(false), next(0), match(NULL), hash(0), used(JOIN_BLOCK_SIZE),
+                    cursor(NULL), probe(0), positioned(false), exhausted(false)
+    {
+        memset(&ikey,  0, sizeof(DBT));
+        memset(&ipkey, 0, sizeof(DBT));
+        memset(&idata, 0, sizeof(DBT));
+
+        ikey.flags  = DB_DBT_REALLOC;
+        ipkey.flags = DB_DBT_REALLOC;
+        idata.flags = DB_DBT_REALLOC;
+    }
+
+    ~join_state ()
+    {
+        reset();
+
+        free(ikey.data);
+        free(ipkey.data);
+        free(idata.data);
+    }
+
+    /** Allocates memory of specified size in the arena. */
+    void * alloc (size_t size)
+    {
+        size = (size + JOIN_ALIGNMENT - 1) & ~(size_t) (JOIN_ALIGNMENT - 1);
+
+        // large records take blocks of their own
+        if (size > JOIN_BLOCK_SIZE / 4)
+        {
+            void * ptr = malloc(size);
+            assert(ptr != NULL);
+
+            blocks.insert(blocks.begin(), (uint8 *) ptr);
+            return ptr;
+        }
+
+        if (used + size > JOIN_BLOCK_SIZE)
+        {
+            uint8 * block = (uint8 *) malloc(JOIN_BLOCK_SIZE);
+            assert(block != NULL);
+
+            blocks.push_back(block);
+            used = 0;
+        }
+
+        void * ptr = blocks.back() + used;
+        used += size;
+
+        return ptr;
+    }
+
+    /** Frees the arena and the hash, and forgets current records. */
+    void reset ()
+    {
+        for (size_t i = 0; i < blocks.size(); i++) free(blocks[i]);
+
+        blocks.clear();
+        buckets.clear();
+        group.clear();
+        probes.clear();
+
+        used       = JOIN_BLOCK_SIZE;
+        built      = false;
+        started    = false;
+        next       = 0;
+        match      = NULL;
+        probe      = 0;
+        positioned = false;
+        exhausted  = false;
+
+        sides[0].valid = false;
+        sides[1].valid = false;
+    }
+
+    size_t                  build;      /**< Build side of hash join ("0" - left, "1" - right).        */
+    bool                    built;      /**< Whether the build side is hashed.                        */
+    bool                    started;    /**< Whether current records of sort-merge join are read.     */
+    join_side               sides[2];   /**< Current records of both sides (probe side of hash join). */
+    size_t                  next;       /**< Next join key of probe record, or next record of group.  */
+    const join_entry      * match;      /**< Next candidate of hash chain of current join key.        */
+    uint64_t                hash;       /**< Hash of current join key of probe record.                */
+    vector <join_entry *>   buckets;    /**< Hash chains (number of buckets is a power of two).       */
+    vector <string>         group;      /**< Left records with equal join keys, or outer records of the batch of index join. */
+    string                  gkey;       /**< Join key of the group.                                   */
+    vector <uint8 *>        blocks;     /**< Blocks of the arena (the last one is being filled).      */
+    size_t                  used;       /**< Used part of the last block.                             */
+    DBC                   * cursor;     /**< Cursor of probed index (or table), "NULL" if not opened. */
+    vector <join_probe>     probes;     /**< Sorted join keys of the batch of index join.             */
+    size_t                  probe;      /**< Current join key of the batch.                           */
+    bool                    positioned; /**< Whether the cursor is on a record of current join key.   */
+    bool                    exhausted;  /**< Whether all outer records are read.                      */
+    DBT                     ikey;       /**< Key of probed record.                                    */
+    DBT                     ipkey;      /**< Primary key of probed record (index only).               */
+    DBT                     idata;      /**< Data of probed record.                                   */
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Joins specified recordsets by specified method. Records of the recordsets are read by the first fetch,
+ * so recordsets should be configured (e.g. by "bdb::recordset::set_bulk" or filters) beforehand.
+ * Join keys are compared bytewise by hash join, so both callbacks must serialize equal keys equally.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown method of the join.
+ */
+table_join::table_join (recordset      * left,      /**< [in] Left recordset.                                        */
+                        index_callback   fn_left,   /**< [in] Extractor of join keys of left records ("NULL" - primary keys).  */
+                        recordset      * right,     /**< [in] Right recordset.                                       */
+                        index_callback   fn_right,  /**< [in] Extractor of join keys of right records ("NULL" - primary keys). */
+                        int              method,    /**< [in] Method of the join (see @ref joinmethods "methods").   */
+                        compare_callback fn_cmp)    /**< [in] Comparison of join keys of sort-merge join ("NULL" - bytewise). */
+  : m_method(method),
+    m_compare(fn_cmp),
+    m_inner(NULL),
+    m_primary(NULL),
+    m_batch(0),
+    m_txn(NULL),
+    m_state(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table_join::table_join] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table_join::table_join] method = " << method);
+
+    if (method != BDB_JOIN_HASH && method != BDB_JOIN_MERGE)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table_join::table_join] Unknown method of the join.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    m_rs[0] = left;
+    m_rs[1] = right;
+    m_fn[0] = fn_left;
+    m_fn[1] = fn_right;
+
+    m_state = new join_state;
+    assert(m_state != NULL);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table_join::table_join] EXIT");
+}
+
+/**
+ * Joins records of specified recordset with records of specified table by index nested-loop join,
+ * probing primary keys of the table by join keys of the outer records.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+table_join::table_join (recordset      * outer,     /**< [in] Outer (left) recordset.                                  */
+                        index_callback   fn_outer,  /**< [in] Extractor of join keys of outer records ("NULL" - primary keys). */
+                        table          * inner,     /**< [in] Probed table.                                            */
+                        unsigned int     batch,     /**< [in] Number of outer records, whose join keys are sorted at once. */
+                        transaction    * txn)       /**< [in] Transaction of probes ("NULL" - current one).             */
+  : m_method(BDB_JOIN_INDEX),
+    m_compare(NULL),
+    m_inner(NULL),
+    m_primary(NULL),
+    m_batch(batch != 0 ? batch : 1),
+    m_txn(txn),
+    m_state(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table_join::table_join] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table_join::table_join] method = BDB_JOIN_INDEX, batch = " << batch);
+
+    m_rs[0] = outer;
+    m_rs[1] = NULL;
+    m_fn[0] = fn_outer;
+    m_fn[1] = NULL;
+
+    open_inner(inner, inner);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table_join::table_join] EXIT");
+}
+
+/**
+ * Joins records of specified recordset with records of specified index by index nested-loop join,
+ * probing keys of the index by join keys of the outer records.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+table_join::table_join (recordset      * outer,     /**< [in] Outer (left) recordset.                                  */
+                        index_callback   fn_outer,  /**< [in] Extractor of join keys of outer records ("NULL" - primary keys). */
+                        index          * inner,     /**< [in] Probed index.                                            */
+                        unsigned int     batch,     /**< [in] Number of outer records, whose join keys are sorted at once. */
+                        transaction    * txn)       /**< [in] Transaction of probes ("NULL" - current one).             */
+  : m_method(BDB_JOIN_INDEX),
+    m_compare(NULL),
+    m_inner(NULL),
+    m_primary(NULL),
+    m_batch(batch != 0 ? batch : 1),
+    m_txn(txn),
+    m_state(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table_join::table_join] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table_join::table_join] method = BDB_JOIN_INDEX, batch = " << batch);
+
+    m_rs[0] = outer;
+    m_rs[1] = NULL;
+    m_fn[0] = fn_outer;
+    m_fn[1] = NULL;
+
+    open_inner(inner, inner->m_master);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table_join::table_join] EXIT");
+}
+
+/**
+ * Frees hashed records, and closes cursor of probed index. Joined recordsets are not closed.
+ */
+table_join::~table_join () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table_join::~table_join] ENTER");
+
+    if (m_state->cursor != NULL) m_state->cursor->close(m_state->cursor);
+
+    delete m_state;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table_join::~table_join] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Fetches the next pair of joined records. The first fetch of hash join reads whole build side,
+ * and fetches of index join read the next batch of outer records, when probes of previous one are done.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - records of sort-merge join are not ordered by join keys, or unknown error.
+ *
+ * @return true  - pair of records is successfully fetched.
+ * @return false - no more pairs to fetch.
+ */
+bool table_join::fetch (Message * lkey,     /**< [out] Key of left record ("NULL" - not needed).   */
+                        Message * ldata,    /**< [out] Data of left record ("NULL" - not needed).  */
+                        Message * rkey,     /**< [out] Key of right record ("NULL" - not needed).  */
+                        Message * rdata)    /**< [out] Data of right record ("NULL" - not needed). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table_join::fetch] ENTER");
+
+    DBT k[2], d[2];
+    memset(k, 0, sizeof(k));
+    memset(d, 0, sizeof(d));
+
+    bool found;
+
+    if (m_method == BDB_JOIN_HASH)
+    {
+        found = fetch_hash();
+
+        if (found)
+        {
+            size_t build = m_state->build;
+            size_t probe = 1 - build;
+
+            const join_row * row = m_state->match->row;
+
+            k[build].data = (void *) (row + 1);
+            k[build].size = row->ksize;
+            d[build].data = (uint8 *) (row + 1) + row->ksize;
+            d[build].size = row->dsize;
+
+            k[probe] = m_state->sides[probe].key;
+            d[probe] = m_state->sides[probe].data;
+
+            m_state->match = m_state->match->next;
+        }
+    }
+    else if (m_method == BDB_JOIN_MERGE)
+    {
+        found = fetch_merge();
+
+        if (found)
+        {
+            split_record(m_state->group[m_state->next++], &k[0], &d[0]);
+
+            k[1] = m_state->sides[1].key;
+            d[1] = m_state->sides[1].data;
+        }
+    }
+    else
+    {
+        found = fetch_index();
+
+        if (found)
+        {
+            split_record(m_state->group[m_state->probes[m_state->probe].row], &k[0], &d[0]);
+
+            k[1] = (m_inner != m_primary ? m_state->ipkey : m_state->ikey);
+            d[1] = m_state->idata;
+        }
+    }
+
+    if (found)
+    {
+        if (lkey  != NULL) m_rs[0]->decode_key(&k[0], lkey);
+        if (ldata != NULL) m_rs[0]->m_table->unserialize_data(&d[0], ldata);
+        if (rdata != NULL) (m_rs[1] != NULL ? m_rs[1]->m_table : m_primary)->unserialize_data(&d[1], rdata);
+
+        if (rkey != NULL)
+        {
+            if (m_inner != NULL) m_primary->decode_key(&k[1], rkey);
+            else m_rs[1]->decode_key(&k[1], rkey);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table_join::fetch] EXIT = " << found);
+
+    return found;
+}
+
+/**
+ * Rewinds both recordsets (or the outer one of index join), so the join is fetched from its beginning
+ * (hash join reads its build side again).
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void table_join::rewind ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table_join::rewind] ENTER");
+
+    m_rs[0]->rewind();
+    if (m_rs[1] != NULL) m_rs[1]->rewind();
+
+    m_state->reset();
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table_join::rewind] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Finds the next hashed record, which has the same join key as current probe record,
+ * reading the next probe records when join keys of current one have no more matches.
+ * The found entry is left in "match" of the state.
+ */
+bool table_join::fetch_hash ()
+{
+    if (!m_state->built) build();
+
+    join_side & probe = m_state->sides[1 - m_state->build];
+    size_t mask = m_state->buckets.size() - 1;
+
+    for (;;)
+    {
+        while (m_state->match != NULL)
+        {
+            const join_entry * entry = m_state->match;
+            const string & jkey = probe.keys[m_state->next - 1];
+
+            if (entry->hash == m_state->hash &&
+                entry->size == jkey.size() &&
+                memcmp(entry + 1, jkey.data(), jkey.size()) == 0)
+            {
+                return true;
+            }
+
+            m_state->match = entry->next;
+        }
+
+        if (probe.valid && m_state->next < probe.keys.size())
+        {
+            const string & jkey = probe.keys[m_state->next++];
+
+            m_state->hash  = join_hash(jkey.data(), jkey.size());
+            m_state->match = m_state->buckets[m_state->hash & mask];
+
+            continue;
+        }
+
+        if (!advance(1 - m_state->build)) return false;
+
+        m_state->next = 0;
+    }
+}
+
+/**
+ * Makes the next pair of sort-merge join current: the next left record of the group of left records
+ * with equal join keys, and right record with the same join key. The group is collected again,
+ * when right records of its join key end.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - records are not ordered by join keys.
+ */
+bool table_join::fetch_merge ()
+{
+    join_side & left  = m_state->sides[0];
+    join_side & right = m_state->sides[1];
+
+    if (!m_state->started)
+    {
+        advance(0);
+        advance(1);
+
+        m_state->started = true;
+    }
+
+    for (;;)
+    {
+        if (!m_state->group.empty() && right.valid && compare(right.keys[0], m_state->gkey) == 0)
+        {
+            if (m_state->next < m_state->group.size()) return true;
+
+            advance(1);
+            m_state->next = 0;
+
+            continue;
+        }
+
+        m_state->group.clear();
+
+        if (!left.valid || !right.valid) return false;
+
+        int res = compare(left.keys[0], right.keys[0]);
+
+        if (res < 0)
+        {
+            advance(0);
+        }
+        else if (res > 0)
+        {
+            advance(1);
+        }
+        else
+        {
+            m_state->gkey = left.keys[0];
+
+            while (left.valid && compare(left.keys[0], m_state->gkey) == 0)
+            {
+                m_state->group.push_back(string());
+                copy_record(&left.key, &left.data, &m_state->group.back());
+
+                advance(0);
+            }
+
+            m_state->next = 0;
+        }
+    }
+}
+
+/**
+ * Makes the next pair of index join current: outer record of current join key of the batch, and the next
+ * probed record with equal key. Join keys of the batch are probed in sorted order, so the cursor moves
+ * forward through the index (or table), and the next batch is read, when probes of the batch are done.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+bool table_join::fetch_index ()
+{
+    for (;;)
+    {
+        int res;
+
+        if (m_state->positioned)
+        {
+            res = probe(DB_NEXT_DUP);
+        }
+        else
+        {
+            if (m_state->probe >= m_state->probes.size() && !fill_batch()) return false;
+
+            res = probe(DB_SET_RANGE);
+        }
+
+        if (res == 0)
+        {
+            m_state->positioned = true;
+            return true;
+        }
+
+        if (res != DB_NOTFOUND && res != DB_KEYEMPTY)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::table_join::fetch] " << db_strerror(res));
+            throw exception(BDB_ERROR_UNKNOWN);
+        }
+
+        m_state->positioned = false;
+        m_state->probe++;
+    }
+}
+
+/**
+ * Reads the next batch of outer records of index join, and sorts their join keys by the comparison
+ * function of the probed index (or table).
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return true  - the batch has join keys to probe.
+ * @return false - no more outer records.
+ */
+bool table_join::fill_batch ()
+{
+    m_state->group.clear();
+    m_state->probes.clear();
+    m_state->probe = 0;
+
+    vector <string> keys;
+    DBT k, d;
+
+    while (!m_state->exhausted && m_state->group.size() < m_batch)
+    {
+        if (!m_rs[0]->read_next(&k, &d))
+        {
+            m_state->exhausted = true;
+            break;
+        }
+
+        keys.clear();
+        join_keys(0, &k, &d, &keys);
+
+        if (keys.empty()) continue;
+
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            join_probe p;
+
+            p.row = m_state->group.size();
+            m_state->probes.push_back(p);
+            m_state->probes.back().key.swap(keys[i]);
+        }
+
+        m_state->group.push_back(string());
+        copy_record(&k, &d, &m_state->group.back());
+    }
+
+    // equal join keys are probed in order of outer records
+    std::stable_sort(m_state->probes.begin(), m_state->probes.end(), join_less(m_inner));
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::table_join::fetch] batch = " << m_state->group.size() << ", probes = " << m_state->probes.size());
+
+    return !m_state->probes.empty();
+}
+
+/**
+ * Positions the cursor of probed index (or table) on the record of current join key of the batch:
+ * on the first record not less than the join key ("DB_SET_RANGE"), or on the next duplicate ("DB_NEXT_DUP").
+ *
+ * @return "DB_NOTFOUND" if there are no (more) records with the join key.
+ */
+int table_join::probe (int op)  /**< [in] Movement of the cursor. */
+{
+    const string & jkey = m_state->probes[m_state->probe].key;
+
+    DBT * key = &m_state->ikey;
+
+    if (op == DB_SET_RANGE)
+    {
+        // the buffer is given to Berkeley DB, which reallocates it for the found key
+        key->data = realloc(key->data, jkey.size() != 0 ? jkey.size() : 1);
+        assert(key->data != NULL);
+
+        memcpy(key->data, jkey.data(), jkey.size());
+        key->size = (u_int32_t) jkey.size();
+    }
+
+    DBC * cursor = m_state->cursor;
+
+    int res = (m_inner != m_primary ? cursor->pget(cursor, key, &m_state->ipkey, &m_state->idata, op)
+                                    : cursor->get(cursor, key, &m_state->idata, op));
+
+    if (res == 0 && op == DB_SET_RANGE)
+    {
+        DBT probed;
+        memset(&probed, 0, sizeof(DBT));
+
+        probed.data = (void *) jkey.data();
+        probed.size = (u_int32_t) jkey.size();
+
+        if (m_inner->compare_keys(key, &probed) != 0) res = DB_NOTFOUND;
+    }
+
+    return res;
+}
+
+/**
+ * Opens cursor of probed index (or table) of index join.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void table_join::open_inner (table * inner,     /**< [in] Probed index (or table).           */
+                             table * primary)   /**< [in] Table of the index (or the table). */
+{
+    inner->check_open();
+
+    m_inner   = inner;
+    m_primary = primary;
+
+    m_state = new join_state;
+    assert(m_state != NULL);
+
+    int res = inner->m_database->open_cursor(inner->m_db, m_txn, &m_state->cursor);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table_join::table_join] " << db_strerror(res));
+        if (m_state->cursor != NULL) m_state->cursor->close(m_state->cursor);
+        delete m_state;
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+}
+
+/**
+ * Reads whole build side (the side with less records by fast count) into the arena,
+ * and hashes its records by their join keys.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void table_join::build ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table_join::build] ENTER");
+
+    unsigned int lcount = m_rs[0]->m_table->count(true);
+    unsigned int rcount = m_rs[1]->m_table->count(true);
+
+    size_t side = m_state->build = (rcount < lcount ? 1 : 0);
+
+    vector <join_entry *> entries;
+    vector <string> keys;
+
+    DBT k, d;
+
+    while (m_rs[side]->read_next(&k, &d))
+    {
+        keys.clear();
+        join_keys(side, &k, &d, &keys);
+
+        if (keys.empty()) continue;
+
+        join_row * row = (join_row *) m_state->alloc(sizeof(join_row) + k.size + d.size);
+
+        row->ksize = k.size;
+        row->dsize = d.size;
+
+        memcpy(row + 1, k.data, k.size);
+        memcpy((uint8 *) (row + 1) + k.size, d.data, d.size);
+
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            join_entry * entry = (join_entry *) m_state->alloc(sizeof(join_entry) + keys[i].size());
+
+            entry->next = NULL;
+            entry->row  = row;
+            entry->hash = join_hash(keys[i].data(), keys[i].size());
+            entry->size = (u_int32_t) keys[i].size();
+
+            memcpy(entry + 1, keys[i].data(), keys[i].size());
+
+            entries.push_back(entry);
+        }
+    }
+
+    // the hash is sized once, when the number of join keys is known
+    size_t nbuckets = 16;
+    while (nbuckets < entries.size()) nbuckets <<= 1;
+
+    m_state->buckets.assign(nbuckets, (join_entry *) NULL);
+
+    for (size_t i = entries.size(); i > 0; i--)
+    {
+        join_entry * entry = entries[i - 1];
+        join_entry ** bucket = &m_state->buckets[entry->hash & (nbuckets - 1)];
+
+        // chains keep order of the build side
+        entry->next = *bucket;
+        *bucket = entry;
+    }
+
+    m_state->built = true;
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::table_join::build] side = " << side << ", keys = " << entries.size() << ", buckets = " << nbuckets);
+    LOG4CPLUS_TRACE(logger, "[bdb::table_join::build] EXIT");
+}
+
+/**
+ * Reads the next record of specified side with join keys, skipping records without them.
+ * Records of sort-merge join must have one join key, not less than the one of the previous record.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - records are not ordered by join keys, or unknown error.
+ *
+ * @return true  - current record of the side is read.
+ * @return false - no more records of the side.
+ */
+bool table_join::advance (size_t side)  /**< [in] Side of the join ("0" - left, "1" - right). */
+{
+    join_side & current = m_state->sides[side];
+
+    string previous;
+    if (m_method == BDB_JOIN_MERGE && current.valid) previous.swap(current.keys[0]);
+
+    current.valid = false;
+
+    while (m_rs[side]->read_next(&current.key, &current.data))
+    {
+        current.keys.clear();
+        join_keys(side, &current.key, &current.data, &current.keys);
+
+        if (current.keys.empty()) continue;
+
+        if (m_method == BDB_JOIN_MERGE)
+        {
+            if (current.keys.size() != 1 || (!previous.empty() && compare(previous, current.keys[0]) > 0))
+            {
+                LOG4CPLUS_WARN(logger, "[bdb::table_join::fetch] Records of sort-merge join must be ordered by single join keys.");
+                throw exception(BDB_ERROR_UNKNOWN);
+            }
+        }
+
+        current.valid = true;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Extracts join keys of the record by callback of specified side (primary key, if there is no callback).
+ * There are no keys, if the callback doesn't index the record.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the callback has failed.
+ */
+void table_join::join_keys (size_t            side,     /**< [in]  Side of the join.        */
+                            const DBT       * key,      /**< [in]  Serialized primary key.  */
+                            const DBT       * data,     /**< [in]  Serialized data.         */
+                            vector <string> * keys)     /**< [out] Raw join keys.           */
+{
+    if (m_fn[side] == NULL)
+    {
+        keys->push_back(string((const char *) key->data, key->size));
+        return;
+    }
+
+    DBT r;
+    memset(&r, 0, sizeof(DBT));
+
+    int res = m_fn[side](m_rs[side]->m_table->m_db, key, data, &r);
+
+    if (res == DB_DONOTINDEX) return;
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table_join::fetch] Callback of join keys has failed with error " << res << ".");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    if (r.flags & DB_DBT_MULTIPLE)
+    {
+        DBT * all = (DBT *) r.data;
+
+        for (u_int32_t i = 0; i < r.size; i++)
+        {
+            keys->push_back(string((const char *) all[i].data, all[i].size));
+            if (all[i].flags & DB_DBT_APPMALLOC) free(all[i].data);
+        }
+    }
+    else
+    {
+        keys->push_back(string((const char *) r.data, r.size));
+    }
+
+    if (r.flags & DB_DBT_APPMALLOC) free(r.data);
+}
+
+/**
+ * Compares join keys of sort-merge join by the comparison function, or bytewise (shorter prefix is less).
+ */
+int table_join::compare (const string & key1,   /**< [in] Raw join key. */
+                         const string & key2)   /**< [in] Raw join key. */
+    const
+{
+    if (m_compare != NULL)
+    {
+        DBT k1, k2;
+        memset(&k1, 0, sizeof(DBT));
+        memset(&k2, 0, sizeof(DBT));
+
+        k1.data = (void *) key1.data();
+        k1.size = (u_int32_t) key1.size();
+        k2.data = (void *) key2.data();
+        k2.size = (u_int32_t) key2.size();
+
+        return m_compare(m_rs[0]->m_table->m_db, &k1, &k2);
+    }
+
+    return key1.compare(key2);
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
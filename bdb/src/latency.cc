@@ -0,0 +1,325 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/latency.cc
+ * Contains implementation of latency histograms.
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Boost C++ Libraries
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of latency histograms.
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::vector;
+
+/**
+ * @private Histograms of all operations, recorded by one thread.
+ * Each thread records into its own histograms without any locks, and histograms of all threads
+ * are merged on demand, so concurrent reading may miss a few latest measurements.
+ */
+struct latency_set
+{
+    latency_histogram histograms[BDB_LATENCY_OPERATIONS];   /**< Histograms by operations. */
+};
+
+/**
+ * @private Cleanup function for thread-specific pointer.
+ * Does nothing, since all sets are owned by the registry below, and are kept after their threads exit.
+ */
+static void latency_set_cleanup (latency_set *)
+{ }
+
+/** @private Whether latencies are measured. */
+static volatile bool latency_enabled = false;
+
+/** @private Lock of the registry of histograms. */
+static boost::mutex latency_mutex;
+
+/** @private Histograms of all threads. */
+static vector <latency_set*> latency_sets;
+
+/** @private Histograms of current thread. */
+static boost::thread_specific_ptr <latency_set> latency_local(latency_set_cleanup);
+
+/**
+ * @private Returns current time of monotonic clock, in nanoseconds.
+ */
+uint64_t monotonic_time ()
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+
+    return (uint64_t) ((double) counter.QuadPart * 1000000000.0 / (double) frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+/**
+ * @private Returns bucket of specified latency. Latencies below 4 ns have a bucket each, and each next
+ * power of two is split into four buckets, so relative error of a bucket is at most 25%.
+ */
+static int latency_bucket (uint64_t latency)    /**< [in] Latency, in nanoseconds. */
+{
+    if (latency < 4) return (int) latency;
+
+    int exponent = 0;
+
+    for (uint64_t v = latency; v > 1; v >>= 1) exponent++;
+
+    int bucket = (exponent - 1) * 4 + (int) ((latency >> (exponent - 2)) & 3);
+
+    return (bucket < BDB_LATENCY_BUCKETS ? bucket : BDB_LATENCY_BUCKETS - 1);
+}
+
+/**
+ * @private Records latency of an operation into histograms of current thread.
+ */
+static void record_latency (int      operation,     /**< [in] Measured operation.        */
+                            uint64_t latency)       /**< [in] Latency, in nanoseconds.   */
+{
+    latency_set * set = latency_local.get();
+
+    if (set == NULL)
+    {
+        set = new latency_set;
+        memset(set, 0, sizeof(latency_set));
+
+        boost::mutex::scoped_lock lock(latency_mutex);
+        latency_sets.push_back(set);
+        latency_local.reset(set);
+    }
+
+    latency_histogram & h = set->histograms[operation];
+
+    h.count++;
+    h.total += latency;
+    if (h.max < latency) h.max = latency;
+    h.buckets[latency_bucket(latency)]++;
+}
+
+/**
+ * Enables or disables latency histograms of operations, and resets the histograms.
+ * The histograms are recorded per thread without locks, but measurement costs two clock reads
+ * per operation and phase, so the histograms are disabled by default.
+ *
+ * @see get_latency_stats
+ */
+void set_latency_stats (bool enable)    /**< [in] Whether to measure latencies. */
+{
+    boost::mutex::scoped_lock lock(latency_mutex);
+
+    for (size_t i = 0; i < latency_sets.size(); i++)
+    {
+        memset(latency_sets[i], 0, sizeof(latency_set));
+    }
+
+    latency_enabled = enable;
+}
+
+/**
+ * Returns histogram of latencies of specified operation or phase, merged from histograms of all threads,
+ * since the histograms were enabled. Phases are measured inside of the operations, so their time is a part
+ * of the operations time (e.g. time of Berkeley DB calls includes unserialization by comparison functions).
+ *
+ * @see set_latency_stats
+ */
+void get_latency_stats (int                 operation,  /**< [in]  Operation (see @ref latencyops "operations"). */
+                        latency_histogram * stats)      /**< [out] Histogram of latencies.                       */
+{
+    memset(stats, 0, sizeof(latency_histogram));
+
+    if (operation < 0 || operation >= BDB_LATENCY_OPERATIONS) return;
+
+    boost::mutex::scoped_lock lock(latency_mutex);
+
+    for (size_t i = 0; i < latency_sets.size(); i++)
+    {
+        const latency_histogram & h = latency_sets[i]->histograms[operation];
+
+        stats->count += h.count;
+        stats->total += h.total;
+        if (stats->max < h.max) stats->max = h.max;
+
+        for (int j = 0; j < BDB_LATENCY_BUCKETS; j++)
+        {
+            stats->buckets[j] += h.buckets[j];
+        }
+    }
+}
+
+/**
+ * Returns the lowest latency of specified bucket of latency histogram, in nanoseconds.
+ */
+uint64_t latency_bound (int bucket)     /**< [in] Bucket of the histogram. */
+{
+    if (bucket < 4) return (uint64_t) bucket;
+
+    int exponent = bucket / 4 + 1;
+
+    return (uint64_t) (4 + bucket % 4) << (exponent - 2);
+}
+
+/**
+ * Returns latency of specified percentile (e.g. "99.9") by histogram, in nanoseconds.
+ * The latency is the upper bound of the bucket, which contains the percentile, but not more than the maximum one.
+ */
+uint64_t latency_percentile (const latency_histogram * stats,       /**< [in] Histogram of latencies.  */
+                             double                    percentile)  /**< [in] Percentile (0 - 100).    */
+{
+    uint64_t rank = (uint64_t) ((double) stats->count * percentile / 100.0);
+    uint64_t seen = 0;
+
+    for (int i = 0; i < BDB_LATENCY_BUCKETS; i++)
+    {
+        seen += stats->buckets[i];
+
+        if (seen > rank || seen == stats->count)
+        {
+            uint64_t bound = latency_bound(i + 1);
+            return (bound < stats->max ? bound : stats->max);
+        }
+    }
+
+    return stats->max;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::latency_scope".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Starts measurement of specified operation, if latency histograms are enabled.
+ */
+latency_scope::latency_scope (int operation)    /**< [in] Measured operation (see @ref latencyops "operations"). */
+  : m_operation(operation),
+    m_start(latency_enabled ? monotonic_time() : 0)
+{ }
+
+/**
+ * Records latency of the operation.
+ */
+latency_scope::~latency_scope ()
+{
+    if (m_start != 0 && latency_enabled)
+    {
+        record_latency(m_operation, monotonic_time() - m_start);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::slow_scope".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * @private Names of traced operations, used in log records of slow operations.
+ */
+static const char * slow_names[BDB_LATENCY_OPERATIONS] =
+{
+    "insert", "update", "select", "exists", "remove", "upsert", "fetch", "sequence",
+    "commit", "serialize", "unserialize", "berkeley", "callback"
+};
+
+/**
+ * Starts tracing of specified operation, if the database has threshold of slow operations.
+ */
+slow_scope::slow_scope (database   * db,            /**< [in] Database of the operation.                           */
+                        int          operation,     /**< [in] Traced operation (see @ref latencyops "operations"). */
+                        const char * name)          /**< [in] Name of the table ("" - none).                       */
+  : m_database(db),
+    m_operation(operation),
+    m_name(name),
+    m_key(0),
+    m_value(0),
+    m_start(db->m_slow != 0 ? monotonic_time() : 0)
+{ }
+
+/**
+ * Reports the operation, if it has taken longer than the threshold.
+ */
+slow_scope::~slow_scope ()
+{
+    if (m_start == 0) return;
+
+    uint64_t duration  = monotonic_time() - m_start;
+    uint64_t threshold = m_database->m_slow;
+
+    if (threshold == 0 || duration < threshold) return;
+
+    slow_operation op;
+
+    op.operation  = m_operation;
+    op.name       = m_name;
+    op.key_size   = m_key;
+    op.value_size = m_value;
+    op.txn_depth  = m_database->txn_depth();
+    op.duration   = duration;
+
+    if (m_database->m_slow_callback != NULL)
+    {
+        m_database->m_slow_callback(&op, m_database->m_slow_param);
+        return;
+    }
+
+    log4cplus::Logger slow = log4cplus::Logger::getInstance(BDB_SLOW_LOGGER_PORT);
+
+    LOG4CPLUS_WARN(slow, "op="           << slow_names[op.operation]
+                      << " table="       << op.name
+                      << " key="         << op.key_size
+                      << " value="       << op.value_size
+                      << " depth="       << op.txn_depth
+                      << " duration_us=" << op.duration / 1000);
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,291 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/layout.cc
+ * Contains implementation of class "bdb::message_layout".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <map>
+#include <vector>
+
+// Protocol Buffers
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format.h>
+#include <google/protobuf/wire_format_lite.h>
+
+// Boost C++ Libraries
+#include <boost/thread/mutex.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+#if DB_VERSION_MAJOR < 4 || (DB_VERSION_MAJOR == 4 && DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::message_layout".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using google::protobuf::uint8;
+using google::protobuf::uint32;
+using google::protobuf::uint64;
+using google::protobuf::io::CodedInputStream;
+using google::protobuf::internal::WireFormat;
+using google::protobuf::internal::WireFormatLite;
+
+/** @private Number of fields, whose values are decoded on the stack (keys of more fields use heap). */
+#define LAYOUT_STACK_FIELDS     8
+
+/** @private Layouts of all types, made so far (they are never freed, as descriptors they refer to). */
+static std::map <const Descriptor *, message_layout *> layouts;
+
+/** @private Lock of "layouts". */
+static boost::mutex layouts_mutex;
+
+/**
+ * @private Returns "bdb::compare_field" type of specified field, or "0" if the field can't be compared.
+ */
+static int field_type (const FieldDescriptor * field)
+{
+    if (field->is_repeated()) return 0;
+
+    switch (field->type())
+    {
+        case FieldDescriptor::TYPE_STRING:
+        case FieldDescriptor::TYPE_BYTES:       return BDB_FIELD_STRING;
+        case FieldDescriptor::TYPE_INT32:
+        case FieldDescriptor::TYPE_ENUM:        return BDB_FIELD_INT32;
+        case FieldDescriptor::TYPE_INT64:       return BDB_FIELD_INT64;
+        case FieldDescriptor::TYPE_UINT32:
+        case FieldDescriptor::TYPE_BOOL:        return BDB_FIELD_UINT32;
+        case FieldDescriptor::TYPE_UINT64:      return BDB_FIELD_UINT64;
+        case FieldDescriptor::TYPE_SINT32:      return BDB_FIELD_SINT32;
+        case FieldDescriptor::TYPE_SINT64:      return BDB_FIELD_SINT64;
+        case FieldDescriptor::TYPE_FIXED32:     return BDB_FIELD_FIXED32;
+        case FieldDescriptor::TYPE_FIXED64:     return BDB_FIELD_FIXED64;
+        case FieldDescriptor::TYPE_SFIXED32:    return BDB_FIELD_SFIXED32;
+        case FieldDescriptor::TYPE_SFIXED64:    return BDB_FIELD_SFIXED64;
+        case FieldDescriptor::TYPE_FLOAT:       return BDB_FIELD_FLOAT;
+        case FieldDescriptor::TYPE_DOUBLE:      return BDB_FIELD_DOUBLE;
+        default:                                return 0;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Makes layout of specified message type.
+ */
+message_layout::message_layout (const Descriptor * type)    /**< [in] Message type. */
+{
+    std::map <int, layout_field> fields;
+
+    for (int i = 0; i < type->field_count(); i++)
+    {
+        const FieldDescriptor * field = type->field(i);
+
+        layout_field f;
+
+        f.number = field->number();
+        f.type   = field_type(field);
+        f.tag    = WireFormat::MakeTag(field);
+
+        if (f.type != 0) fields[f.number] = f;
+    }
+
+    for (std::map <int, layout_field>::const_iterator i = fields.begin(); i != fields.end(); ++i)
+    {
+        m_fields.push_back(i->second);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns layout of specified message type, making it on first request.
+ */
+const message_layout * message_layout::get (const Descriptor * type)    /**< [in] Message type. */
+{
+    boost::mutex::scoped_lock lock(layouts_mutex);
+
+    message_layout *& layout = layouts[type];
+
+    if (layout == NULL)
+    {
+        layout = new message_layout(type);
+        assert(layout != NULL);
+    }
+
+    return layout;
+}
+
+/**
+ * Compares two serialized messages by fields of the layout, as "bdb::compare_field" compares them by one field.
+ *
+ * @return 0 if the messages are equal.
+ * @return -1 if dbt1 is less than dbt2.
+ * @return +1 if dbt1 is greater than dbt2.
+ */
+int message_layout::compare (const DBT * dbt1,      /**< [in] First serialized message.  */
+                             const DBT * dbt2)      /**< [in] Second serialized message. */
+    const
+{
+    size_t count = m_fields.size();
+
+    decoded_field          stack[2 * LAYOUT_STACK_FIELDS];
+    vector <decoded_field> heap;
+
+    decoded_field * values = stack;
+
+    if (count > LAYOUT_STACK_FIELDS)
+    {
+        heap.resize(2 * count);
+        values = &heap[0];
+    }
+
+    decode(dbt1, values);
+    decode(dbt2, values + count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        int res = compare_decoded(&values[i], &values[count + i], m_fields[i].type);
+        if (res != 0) return res;
+    }
+
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Decodes values of all fields of the layout from serialized message in one pass.
+ * Messages are serialized in order of field numbers, so the tag of each field is first compared with
+ * precomputed tag of the field, which is expected next, and other fields are looked up only if it differs.
+ * If a field occurs several times, the first occurrence is decoded.
+ */
+void message_layout::decode (const DBT     * dbt,       /**< [in]  Serialized message.                  */
+                             decoded_field * values)    /**< [out] Values of the fields of the layout.  */
+    const
+{
+    size_t count = m_fields.size();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        values[i].found = false;
+        values[i].value = 0;
+        values[i].data  = NULL;
+    }
+
+    CodedInputStream input((const uint8 *) dbt->data, (int) dbt->size);
+
+    size_t next  = 0;
+    size_t found = 0;
+
+    while (found < count)
+    {
+        uint32 tag = input.ReadTag();
+        if (tag == 0) break;
+
+        size_t i = next;
+
+        if (i == count || m_fields[i].tag != tag)
+        {
+            for (i = 0; i < count && m_fields[i].tag != tag; i++) {}
+        }
+
+        if (i == count || values[i].found)
+        {
+            if (!WireFormatLite::SkipField(&input, tag)) break;
+            continue;
+        }
+
+        uint64 value = 0;
+        bool   res;
+
+        switch (WireFormatLite::GetTagWireType(tag))
+        {
+            case WireFormatLite::WIRETYPE_VARINT:
+                res = input.ReadVarint64(&value);
+                break;
+
+            case WireFormatLite::WIRETYPE_FIXED64:
+                res = input.ReadLittleEndian64(&value);
+                break;
+
+            case WireFormatLite::WIRETYPE_FIXED32:
+            {
+                uint32 fixed = 0;
+                res   = input.ReadLittleEndian32(&fixed);
+                value = fixed;
+                break;
+            }
+
+            default:    // length-delimited
+            {
+                uint32       size = 0;
+                const void * data = NULL;
+                int          left = 0;
+
+                res = input.ReadVarint32(&size);
+
+                if (res)
+                {
+                    input.GetDirectBufferPointerInline(&data, &left);
+                    res = (size <= (uint32) left && input.Skip((int) size));
+                }
+
+                value = size;
+                values[i].data = data;
+                break;
+            }
+        }
+
+        if (!res) break;
+
+        values[i].found = true;
+        values[i].value = value;
+
+        found++;
+        next = i + 1;
+    }
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
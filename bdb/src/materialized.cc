@@ -0,0 +1,532 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/materialized.cc
+ * Contains implementation of class "bdb::materialized_aggregate".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <string>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::materialized_aggregate".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::string;
+
+/** @private Aggregated values of a group, as they are stored. */
+struct stored_group
+{
+    uint64_t count;     /**< Number of records in the group.                        */
+    uint64_t values;    /**< Number of records, which contain the aggregated value. */
+    int64_t  sum;       /**< Sum of the values.                                     */
+};
+
+/**
+ * @private Converts stored values of a group into aggregated ones.
+ */
+static void load_group (const stored_group & from,      /**< [in]  Stored values.     */
+                        aggregate_value    * to)        /**< [out] Aggregated values. */
+{
+    memset(to, 0, sizeof(aggregate_value));
+
+    to->count  = from.count;
+    to->values = from.values;
+    to->sum    = from.sum;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens materialized aggregate of specified table, which is made either by delta function, or of
+ * integer field of records (optionally grouped by raw value of another field, see "bdb::aggregation").
+ * If the aggregate doesn't exist yet (or is empty), then creates it from all records of the table.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+materialized_aggregate::materialized_aggregate (table              * tbl,       /**< [in] Master table.                                        */
+                                                const char         * name,      /**< [in] Name of the aggregate.                               */
+                                                aggregate_callback   fn_agg,    /**< [in] Delta function ("NULL" for aggregate of a field).    */
+                                                int                  field,     /**< [in] Aggregated field ("0" - records are counted only).   */
+                                                int                  type,      /**< [in] Type of the field (see @ref fieldtypes "types").     */
+                                                int                  group)     /**< [in] Grouping field ("0" - all records are in one group). */
+  : m_table(tbl),
+    m_name(string(name)),
+    m_db(NULL),
+    m_callback(fn_agg),
+    m_decoder(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::materialized_aggregate::materialized_aggregate] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::materialized_aggregate::materialized_aggregate] name = " << name);
+
+    // type of the field is checked by the decoder
+    if (fn_agg == NULL)
+    {
+        m_decoder = new aggregation(field, type, group);
+        assert(m_decoder != NULL);
+    }
+
+    int res = db_create(&m_db, tbl->m_db->get_env(tbl->m_db), 0);
+
+    if (res == 0) m_db->app_private = this;
+
+    if (tbl->m_options.page_size != 0)
+    {
+        if (res == 0) res = m_db->set_pagesize(m_db, tbl->m_options.page_size);
+    }
+
+    if (tbl->m_options.encrypted)
+    {
+        if (res == 0) res = m_db->set_flags(m_db, DB_ENCRYPT);
+    }
+
+    if (res == 0)
+    {
+        res = tbl->m_database->open_file(m_db,
+                                         tbl->m_database->get_transaction(),
+                                         get_filename(),
+                                         m_name,
+                                         DB_BTREE,
+                                         DB_THREAD | DB_CREATE | (tbl->m_options.multiversion ? DB_MULTIVERSION : 0));
+    }
+
+    if (res == 0) res = build();
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::materialized_aggregate::materialized_aggregate] " << db_strerror(res));
+        if (m_db != NULL) m_db->close(m_db, 0);
+        delete m_decoder;
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::materialized_aggregate::materialized_aggregate] EXIT");
+}
+
+/**
+ * Closes the aggregate.
+ */
+materialized_aggregate::~materialized_aggregate () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::materialized_aggregate::~materialized_aggregate] ENTER");
+
+    if (m_db != NULL) m_db->close(m_db, m_table->m_database->m_close_flags);
+
+    delete m_decoder;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::materialized_aggregate::~materialized_aggregate] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Reads aggregated values of specified group by a single lookup.
+ *
+ * @return true  - the group is found.
+ * @return false - the group has no records.
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+bool materialized_aggregate::select (const string    & group,   /**< [in]  Key of the group (raw value of grouping field). */
+                                     aggregate_value * result,  /**< [out] Aggregated values of the group.                */
+                                     transaction     * txn)     /**< [in]  Transaction to use.                            */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::materialized_aggregate::select] ENTER");
+
+    database * db = m_table->m_database;
+
+    stored_group value;
+    memset(&value, 0, sizeof(stored_group));
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.data  = (void *) group.data();
+    k.size  = (u_int32_t) group.size();
+    d.data  = &value;
+    d.ulen  = sizeof(stored_group);
+    d.flags = DB_DBT_USERMEM;
+
+    int res = m_db->get(m_db, db->get_transaction(txn), &k, &d, db->read_flags(txn));
+
+    if (res == 0 && d.size != sizeof(stored_group)) res = EINVAL;
+
+    if (res != 0 && res != DB_NOTFOUND)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::materialized_aggregate::select] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    load_group(value, result);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::materialized_aggregate::select] EXIT");
+
+    return (res == 0);
+}
+
+/**
+ * Reads aggregated values of all groups.
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+void materialized_aggregate::groups (aggregate_groups * result,     /**< [out] Aggregated values by groups. */
+                                     transaction      * txn)        /**< [in]  Transaction to use.          */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::materialized_aggregate::groups] ENTER");
+
+    database * db = m_table->m_database;
+
+    result->clear();
+
+    int res = read_groups(db->get_transaction(txn), db->read_flags(txn), result);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::materialized_aggregate::groups] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::materialized_aggregate::groups] EXIT = " << result->size());
+}
+
+/**
+ * Returns aggregated values of all records, regardless of groups (reading all groups).
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+aggregate_value materialized_aggregate::total (transaction * txn)   /**< [in] Transaction to use. */
+{
+    aggregate_groups all;
+    groups(&all, txn);
+
+    aggregate_value total;
+    memset(&total, 0, sizeof(aggregate_value));
+
+    for (aggregate_groups::const_iterator i = all.begin(); i != all.end(); ++i)
+    {
+        total.count  += i->second.count;
+        total.values += i->second.values;
+        total.sum    += i->second.sum;
+    }
+
+    return total;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Makes group of specified record and its contribution to the sum of the group.
+ * Returns error code of Berkeley DB ("DB_DONOTINDEX" if the record is not aggregated).
+ */
+int materialized_aggregate::make_delta (const DBT * key,    /**< [in]  Primary key.                          */
+                                        const DBT * data,   /**< [in]  Primary data.                         */
+                                        string    * group,  /**< [out] Key of the group.                     */
+                                        int64_t   * value,  /**< [out] Contribution of the record.           */
+                                        bool      * found)  /**< [out] Whether the record has a value.       */
+{
+    *value = 0;
+    *found = false;
+    group->clear();
+
+    if (m_callback != NULL)
+    {
+        DBT g;
+        memset(&g, 0, sizeof(DBT));
+
+        int res = m_callback(m_db, key, data, &g, value);
+
+        if (res != 0) return res;
+
+        if (g.size != 0) group->assign((const char *) g.data, g.size);
+        if (g.flags & DB_DBT_APPMALLOC) free(g.data);
+
+        *found = true;
+
+        return 0;
+    }
+
+    if (m_decoder->m_group != 0)
+    {
+        field_value raw;
+
+        if (extract_field(data, m_decoder->m_group, &raw))
+        {
+            group->assign((const char *) raw.data, raw.size);
+        }
+    }
+
+    *found = (m_decoder->m_field != 0 && m_decoder->decode(data, value));
+
+    return 0;
+}
+
+/**
+ * Applies change of specified record to its old and new groups.
+ * Returns error code of Berkeley DB.
+ */
+int materialized_aggregate::apply_change (DB_TXN    * txn,      /**< [in] Transaction to use.                       */
+                                          const DBT * key,      /**< [in] Primary key.                              */
+                                          const DBT * olddata,  /**< [in] Old primary data ("NULL" for new record). */
+                                          const DBT * newdata)  /**< [in] New primary data ("NULL" for removed one). */
+{
+    string  oldgroup, newgroup;
+    int64_t oldvalue = 0, newvalue = 0;
+    bool    oldfound = false, newfound = false;
+
+    int oldres = (olddata != NULL ? make_delta(key, olddata, &oldgroup, &oldvalue, &oldfound) : DB_DONOTINDEX);
+    int newres = (newdata != NULL ? make_delta(key, newdata, &newgroup, &newvalue, &newfound) : DB_DONOTINDEX);
+
+    if (oldres != 0 && oldres != DB_DONOTINDEX) return oldres;
+    if (newres != 0 && newres != DB_DONOTINDEX) return newres;
+
+    if (oldres == 0 && newres == 0 && oldgroup == newgroup)
+    {
+        int64_t values = (newfound ? 1 : 0) - (oldfound ? 1 : 0);
+        int64_t sum    = (newfound ? newvalue : 0) - (oldfound ? oldvalue : 0);
+
+        // the record stays in the same group
+        return (values != 0 || sum != 0 ? update_group(txn, newgroup, 0, values, sum) : 0);
+    }
+
+    int res = 0;
+
+    if (oldres == 0)             res = update_group(txn, oldgroup, -1, (oldfound ? -1 : 0), (oldfound ? -oldvalue : 0));
+    if (newres == 0 && res == 0) res = update_group(txn, newgroup,  1, (newfound ?  1 : 0), (newfound ?  newvalue : 0));
+
+    return res;
+}
+
+/**
+ * Adds specified deltas to aggregated values of specified group.
+ * The group is removed, when it has no records left.
+ * Returns error code of Berkeley DB.
+ */
+int materialized_aggregate::update_group (DB_TXN       * txn,       /**< [in] Transaction to use.      */
+                                          const string & group,     /**< [in] Key of the group.        */
+                                          int64_t        count,     /**< [in] Delta of count.          */
+                                          int64_t        values,    /**< [in] Delta of number of values. */
+                                          int64_t        sum)       /**< [in] Delta of sum.            */
+{
+    stored_group value;
+    memset(&value, 0, sizeof(stored_group));
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.data  = (void *) group.data();
+    k.size  = (u_int32_t) group.size();
+    d.data  = &value;
+    d.ulen  = sizeof(stored_group);
+    d.flags = DB_DBT_USERMEM;
+
+    int res = m_db->get(m_db, txn, &k, &d, (txn != NULL ? DB_RMW : 0));
+
+    if (res == 0 && d.size != sizeof(stored_group)) res = EINVAL;
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (res != 0) return res;
+
+    value.count  += count;
+    value.values += values;
+    value.sum    += sum;
+
+    if (value.count == 0)
+    {
+        res = m_db->del(m_db, txn, &k, 0);
+        return (res == DB_NOTFOUND ? 0 : res);
+    }
+
+    d.size = sizeof(stored_group);
+
+    return m_db->put(m_db, txn, &k, &d, 0);
+}
+
+/**
+ * Makes aggregated values of all records of the table, if the aggregate is empty (e.g. it's just created).
+ * Returns error code of Berkeley DB.
+ */
+int materialized_aggregate::build ()
+{
+    DB_TXN * parent = m_table->m_database->get_transaction();
+
+    aggregate_groups all;
+
+    // the aggregate is built only if it's empty
+    int res = read_groups(parent, 0, &all);
+
+    if (res != 0 || !all.empty()) return res;
+
+    DBC * cursor = NULL;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.flags = DB_DBT_REALLOC;
+    d.flags = DB_DBT_REALLOC;
+
+    res = m_table->m_db->cursor(m_table->m_db, parent, &cursor, m_table->m_database->read_flags());
+
+    while (res == 0 && (res = cursor->get(cursor, &k, &d, DB_NEXT)) == 0)
+    {
+        string  group;
+        int64_t value = 0;
+        bool    found = false;
+
+        res = make_delta(&k, &d, &group, &value, &found);
+
+        if (res == DB_DONOTINDEX)
+        {
+            res = 0;
+            continue;
+        }
+
+        if (res != 0) break;
+
+        aggregate_value & sums = all[group];
+
+        sums.count++;
+
+        if (found)
+        {
+            sums.values++;
+            sums.sum += value;
+        }
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL) cursor->close(cursor);
+
+    free(k.data);
+    free(d.data);
+
+    // the groups are written in one transaction (if the table is transactional)
+    DB_TXN * txn = parent;
+    DB_TXN * own = NULL;
+
+    if (res == 0 && !all.empty()) res = m_table->m_database->begin_auto(&txn, &own);
+
+    for (aggregate_groups::const_iterator i = all.begin(); i != all.end() && res == 0; ++i)
+    {
+        res = update_group(txn, i->first, i->second.count, i->second.values, i->second.sum);
+    }
+
+    return m_table->m_database->end_auto(own, res);
+}
+
+/**
+ * Reads aggregated values of all groups.
+ * Returns error code of Berkeley DB.
+ */
+int materialized_aggregate::read_groups (DB_TXN           * txn,    /**< [in]  Transaction to use.          */
+                                         u_int32_t          flags,  /**< [in]  Flags of the cursor.         */
+                                         aggregate_groups * result) /**< [out] Aggregated values by groups. */
+{
+    DBC * cursor = NULL;
+
+    stored_group value;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.flags = DB_DBT_REALLOC;
+    d.data  = &value;
+    d.ulen  = sizeof(stored_group);
+    d.flags = DB_DBT_USERMEM;
+
+    int res = m_db->cursor(m_db, txn, &cursor, flags);
+
+    while (res == 0 && (res = cursor->get(cursor, &k, &d, DB_NEXT)) == 0)
+    {
+        if (d.size != sizeof(stored_group))
+        {
+            res = EINVAL;
+            break;
+        }
+
+        load_group(value, &(*result)[string((const char *) k.data, k.size)]);
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    free(k.data);
+
+    return res;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
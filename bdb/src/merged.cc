@@ -0,0 +1,471 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/merged.cc
+ * Contains implementation of class "bdb::merged_recordset".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Protocol Buffers
+#include <google/protobuf/message.h>
+
+// Boost C++ Libraries
+#include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::merged_recordset".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::deque;
+using std::pair;
+using std::string;
+using std::vector;
+
+using google::protobuf::Message;
+
+/** @private Maximum number of records, read ahead from each recordset by prefetching thread. */
+static const size_t MERGE_PREFETCH_DEPTH = 64;
+
+/** @private Merged recordset with its current (not fetched yet) record. */
+class merge_input
+{
+public:
+
+    merge_input () : rs(NULL), eof(false), stop(false), error(0)
+    {
+        memset(&key,  0, sizeof(DBT));
+        memset(&data, 0, sizeof(DBT));
+    }
+
+    recordset                         * rs;         /**< Merged recordset.                                       */
+    DBT                                 key;        /**< Current key (references fetch buffer or "current").     */
+    DBT                                 data;       /**< Current data (references fetch buffer or "current").    */
+
+    boost::mutex                        mutex;      /**< Guards all the fields below.                            */
+    boost::condition_variable           cond;       /**< Signals of read and consumed records.                   */
+    deque <pair <string, string> >      queue;      /**< Records, read ahead by prefetching thread.              */
+    pair <string, string>               current;    /**< Current record, taken from the queue.                   */
+    bool                                eof;        /**< Whether prefetching thread has read all records.        */
+    bool                                stop;       /**< Whether prefetching thread should stop.                 */
+    int                                 error;      /**< Error of prefetching thread ("0" if none).              */
+
+    /**
+     * Reads ahead records of the recordset into the queue, until the end of the recordset,
+     * or until it's asked to stop. Body of prefetching thread.
+     */
+    void prefetch ()
+    {
+        try
+        {
+            for (;;)
+            {
+                {
+                    boost::mutex::scoped_lock lock(mutex);
+
+                    while (queue.size() >= MERGE_PREFETCH_DEPTH && !stop)
+                    {
+                        cond.wait(lock);
+                    }
+
+                    if (stop) return;
+                }
+
+                DBT k, d;
+                bool found = rs->read_next(&k, &d);
+
+                boost::mutex::scoped_lock lock(mutex);
+
+                if (!found)
+                {
+                    eof = true;
+                    cond.notify_all();
+                    return;
+                }
+
+                queue.push_back(pair <string, string> (string((const char *) k.data, k.size),
+                                                       string((const char *) d.data, d.size)));
+                cond.notify_all();
+            }
+        }
+        catch (exception & e)
+        {
+            boost::mutex::scoped_lock lock(mutex);
+
+            error = e.error();
+            eof   = true;
+            cond.notify_all();
+        }
+    }
+};
+
+/** @private Orders positions of inputs in heap, so the input with the least key is on top. */
+class merge_greater
+{
+public:
+
+    merge_greater (table * tbl, const vector <merge_input *> * inputs) : m_table(tbl), m_inputs(inputs) { }
+
+    bool operator () (size_t i1, size_t i2) const
+    {
+        int res = m_table->compare_keys(&(*m_inputs)[i1]->key, &(*m_inputs)[i2]->key);
+
+        // records with equal keys are fetched in order of the recordsets
+        return (res != 0 ? res > 0 : i1 > i2);
+    }
+
+protected:
+
+    table                        * m_table;    /**< Table, which compares the keys. */
+    const vector <merge_input *> * m_inputs;   /**< Merged inputs.                  */
+};
+
+/** @private Heap of current records of merged recordsets, and prefetching threads. */
+class merge_state
+{
+public:
+
+    merge_state () : threads(NULL), last(0), started(false) { }
+
+    vector <merge_input *>      inputs;     /**< Inputs, in order of the recordsets.                    */
+    vector <size_t>             heap;       /**< Positions of inputs, which have current records.       */
+    boost::thread_group       * threads;    /**< Prefetching threads ("NULL" if not running).           */
+    size_t                      last;       /**< Input of the last fetched record.                      */
+    bool                        started;    /**< Whether the heap is filled by the first fetch.         */
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Merges specified recordsets of tables (or ranges of tables) with compatible keys.
+ * Records of the recordsets are read by the first fetch, so recordsets should be configured
+ * (e.g. by "bdb::recordset::set_bulk" or filters) beforehand.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - a recordset is not ordered by primary keys.
+ */
+merged_recordset::merged_recordset (const joinlist & list,      /**< [in] Recordsets to merge.                            */
+                                    bool             prefetch)  /**< [in] Whether to read ahead records by threads.       */
+  : m_list(list),
+    m_table(NULL),
+    m_prefetch(prefetch),
+    m_state(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::merged_recordset::merged_recordset] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::merged_recordset::merged_recordset] size = " << list.size() << ", prefetch = " << prefetch);
+
+    for (size_t i = 0; i < list.size(); i++)
+    {
+        if (!list[i]->is_ordered())
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::merged_recordset::merged_recordset] Only recordsets of tables and their ranges can be merged.");
+            throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    // empty merged recordset has no records, and compares no keys
+    if (!list.empty()) m_table = list[0]->m_table;
+
+    m_state = new merge_state;
+    assert(m_state != NULL);
+
+    for (size_t i = 0; i < list.size(); i++)
+    {
+        merge_input * input = new merge_input;
+        assert(input != NULL);
+
+        input->rs = list[i];
+        m_state->inputs.push_back(input);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::merged_recordset::merged_recordset] EXIT");
+}
+
+/**
+ * Stops prefetching threads. Merged recordsets are not closed.
+ */
+merged_recordset::~merged_recordset () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::merged_recordset::~merged_recordset] ENTER");
+
+    stop();
+
+    for (size_t i = 0; i < m_state->inputs.size(); i++)
+    {
+        delete m_state->inputs[i];
+    }
+
+    delete m_state;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::merged_recordset::~merged_recordset] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Fetches the next record in key order from all merged recordsets.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return true  - record is successfully fetched.
+ * @return false - no more records to fetch.
+ */
+bool merged_recordset::fetch (Message * key,    /**< [out] Key of fetched record.  */
+                              Message * data)   /**< [out] Data of fetched record. */
+{
+    return fetch_record(key, data);
+}
+
+/**
+ * Fetches key of the next record in key order from all merged recordsets.
+ * Data of records are read anyway, since the next record of each recordset is read ahead for merging.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return true  - record is successfully fetched.
+ * @return false - no more records to fetch.
+ */
+bool merged_recordset::fetch_key (Message * key)    /**< [out] Key of fetched record. */
+{
+    return fetch_record(key, NULL);
+}
+
+/**
+ * Rewinds all merged recordsets to their first records.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void merged_recordset::rewind ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::merged_recordset::rewind] ENTER");
+
+    stop();
+
+    for (size_t i = 0; i < m_list.size(); i++)
+    {
+        m_list[i]->rewind();
+    }
+
+    m_state->heap.clear();
+    m_state->started = false;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::merged_recordset::rewind] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Fetches the least of current records of merged recordsets, and replaces it in the heap by the next record
+ * of its recordset on the next fetch, so the fetched record stays in fetch buffers until it's decoded.
+ * Implements "bdb::merged_recordset::fetch" and "bdb::merged_recordset::fetch_key".
+ */
+bool merged_recordset::fetch_record (Message * key,     /**< [out] Key of fetched record.              */
+                                     Message * data)    /**< [out] Data of fetched record (or "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::merged_recordset::fetch] ENTER");
+
+    vector <size_t> & heap = m_state->heap;
+    merge_greater greater(m_table, &m_state->inputs);
+
+    if (!m_state->started)
+    {
+        start();
+
+        for (size_t i = 0; i < m_state->inputs.size(); i++)
+        {
+            if (advance(i)) heap.push_back(i);
+        }
+
+        std::make_heap(heap.begin(), heap.end(), greater);
+        m_state->started = true;
+    }
+    else if (advance(m_state->last))
+    {
+        heap.push_back(m_state->last);
+        std::push_heap(heap.begin(), heap.end(), greater);
+    }
+
+    if (heap.empty())
+    {
+        LOG4CPLUS_TRACE(logger, "[bdb::merged_recordset::fetch] EXIT = false");
+        return false;
+    }
+
+    std::pop_heap(heap.begin(), heap.end(), greater);
+
+    m_state->last = heap.back();
+    heap.pop_back();
+
+    merge_input * input = m_state->inputs[m_state->last];
+
+    if (key  != NULL) input->rs->decode_key(&input->key, key);
+    if (data != NULL) input->rs->m_table->unserialize_data(&input->data, data);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::merged_recordset::fetch] EXIT = true");
+
+    return true;
+}
+
+/**
+ * Makes the next record of specified recordset current, reading it from the recordset,
+ * or taking it from the queue of prefetching thread.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return true  - the record is current.
+ * @return false - no more records in the recordset.
+ */
+bool merged_recordset::advance (size_t position)    /**< [in] Position of the recordset in the list. */
+{
+    merge_input * input = m_state->inputs[position];
+
+    if (!m_prefetch)
+    {
+        return input->rs->read_next(&input->key, &input->data);
+    }
+
+    boost::mutex::scoped_lock lock(input->mutex);
+
+    while (input->queue.empty() && !input->eof)
+    {
+        input->cond.wait(lock);
+    }
+
+    if (input->queue.empty())
+    {
+        if (input->error != 0)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::merged_recordset::fetch] Prefetching failed with error " << input->error << ".");
+            throw exception(input->error);
+        }
+
+        return false;
+    }
+
+    input->current.first.swap(input->queue.front().first);
+    input->current.second.swap(input->queue.front().second);
+    input->queue.pop_front();
+    input->cond.notify_all();
+
+    input->key.data  = (void *) input->current.first.data();
+    input->key.size  = (u_int32_t) input->current.first.size();
+    input->data.data = (void *) input->current.second.data();
+    input->data.size = (u_int32_t) input->current.second.size();
+
+    return true;
+}
+
+/**
+ * Starts prefetching threads, one for each merged recordset (if prefetching is enabled).
+ */
+void merged_recordset::start ()
+{
+    if (!m_prefetch || m_state->threads != NULL) return;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::merged_recordset::start] ENTER");
+
+    m_state->threads = new boost::thread_group;
+    assert(m_state->threads != NULL);
+
+    for (size_t i = 0; i < m_state->inputs.size(); i++)
+    {
+        m_state->threads->create_thread(boost::bind(&merge_input::prefetch, m_state->inputs[i]));
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::merged_recordset::start] EXIT");
+}
+
+/**
+ * Stops prefetching threads (if running), and discards records, read ahead by them.
+ */
+void merged_recordset::stop ()
+{
+    if (m_state->threads == NULL) return;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::merged_recordset::stop] ENTER");
+
+    for (size_t i = 0; i < m_state->inputs.size(); i++)
+    {
+        boost::mutex::scoped_lock lock(m_state->inputs[i]->mutex);
+
+        m_state->inputs[i]->stop = true;
+        m_state->inputs[i]->cond.notify_all();
+    }
+
+    m_state->threads->join_all();
+
+    delete m_state->threads;
+    m_state->threads = NULL;
+
+    for (size_t i = 0; i < m_state->inputs.size(); i++)
+    {
+        merge_input * input = m_state->inputs[i];
+
+        input->queue.clear();
+        input->eof   = false;
+        input->stop  = false;
+        input->error = 0;
+    }
+
+    m_state->heap.clear();
+    m_state->started = false;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::merged_recordset::stop] EXIT");
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,544 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/notify.cc
+ * Contains implementation of class "bdb::notifier", and of change notifications of class "bdb::table".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cassert>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Boost C++ Libraries
+#include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::notifier".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::deque;
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+/** @private Changes of records of one table, coalesced by serialized keys. */
+typedef map <string, change_notice> notice_map;
+
+/** @private Changes of one transaction, by changed tables. */
+typedef map <table *, notice_map> table_changes;
+
+/** @private Subscription to change notifications of a table. */
+class subscription
+{
+public:
+
+    subscription (table * sub_tbl, notify_callback sub_fn, void * sub_param, bool sub_values)
+      : tbl(sub_tbl), fn_notify(sub_fn), param(sub_param), values(sub_values) { }
+
+    table           * tbl;          /**< Subscribed table.                          */
+    notify_callback   fn_notify;    /**< Handler of notifications.                  */
+    void            * param;        /**< Parameter of the handler.                  */
+    bool              values;       /**< Whether the handler needs new values of records. */
+};
+
+/** @private Queued changes of active transaction. */
+class pending_changes
+{
+public:
+
+    pending_changes () : parent(NULL) { }
+
+    DB_TXN        * parent;     /**< Parent transaction ("NULL" - top-level, or unknown). */
+    table_changes   changes;    /**< Changes of the transaction (and of its committed children). */
+};
+
+/** @private Committed changes of one table, waiting for delivery. */
+class committed_changes
+{
+public:
+
+    table                  * tbl;       /**< Changed table.       */
+    vector <change_notice>   notices;   /**< Changed records.     */
+};
+
+/** @private Subscriptions, queued changes, and delivering thread of notifier. */
+class notify_state
+{
+public:
+
+    notify_state () : enabled(false), stop(false), delivering(NULL), thread(NULL) { }
+
+    volatile bool                       enabled;        /**< Whether anything was subscribed (changes are queued since then). */
+
+    boost::mutex                        mutex;          /**< Guards all the fields below.                           */
+    boost::condition_variable           cond;           /**< Signals committed changes, stop, and completed deliveries. */
+    bool                                stop;           /**< Whether the delivering thread should stop.             */
+    vector <subscription>               subscriptions;  /**< Subscriptions of all tables.                           */
+    map <DB_TXN *, pending_changes>     pending;        /**< Changes of active transactions.                        */
+    deque <committed_changes>           committed;      /**< Committed changes, in order of commits.                */
+    table                             * delivering;     /**< Table, whose changes are being delivered ("NULL" if none). */
+    boost::thread                     * thread;         /**< Delivering thread ("NULL" if not started).             */
+
+    /** Queues committed changes of a transaction for delivery (the mutex is locked). */
+    void queue (table_changes & changes)
+    {
+        for (table_changes::iterator i = changes.begin(); i != changes.end(); ++i)
+        {
+            committed.push_back(committed_changes());
+            committed.back().tbl = i->first;
+            committed.back().notices.reserve(i->second.size());
+
+            for (notice_map::iterator j = i->second.begin(); j != i->second.end(); ++j)
+            {
+                committed.back().notices.push_back(j->second);
+            }
+        }
+
+        if (!changes.empty()) cond.notify_all();
+    }
+
+    /** Body of delivering thread. */
+    void run ()
+    {
+        boost::mutex::scoped_lock lock(mutex);
+
+        for (;;)
+        {
+            while (!stop && committed.empty()) cond.wait(lock);
+
+            if (stop) break;
+
+            committed_changes batch;
+            batch.tbl = committed.front().tbl;
+            batch.notices.swap(committed.front().notices);
+            committed.pop_front();
+
+            vector <subscription> handlers;
+
+            for (size_t i = 0; i < subscriptions.size(); i++)
+            {
+                if (subscriptions[i].tbl == batch.tbl) handlers.push_back(subscriptions[i]);
+            }
+
+            delivering = batch.tbl;
+            lock.unlock();
+
+            vector <change_notice> keys;
+
+            for (size_t i = 0; i < handlers.size(); i++)
+            {
+                // handlers, which don't need values, are given keys only
+                if (!handlers[i].values && keys.empty())
+                {
+                    keys = batch.notices;
+
+                    for (size_t j = 0; j < keys.size(); j++)
+                    {
+                        string().swap(keys[j].data);
+                    }
+                }
+
+                try
+                {
+                    handlers[i].fn_notify(batch.tbl, (handlers[i].values ? batch.notices : keys), handlers[i].param);
+                }
+                catch (...)
+                {
+                    LOG4CPLUS_WARN(logger, "[bdb::notifier::run] Handler of change notifications has thrown an exception.");
+                }
+            }
+
+            lock.lock();
+            delivering = NULL;
+            cond.notify_all();
+        }
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Creates notifier with no subscriptions.
+ */
+notifier::notifier ()
+{
+    m_state = new notify_state;
+    assert(m_state != NULL);
+}
+
+/**
+ * Stops delivering thread (if it's running), dropping undelivered changes.
+ */
+notifier::~notifier () throw ()
+{
+    shutdown();
+    delete m_state;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds subscription to changes of specified table, and starts delivering thread, if it's not running.
+ */
+void notifier::subscribe (table           * tbl,        /**< [in] Subscribed table.                          */
+                          notify_callback   fn_notify,  /**< [in] Handler of notifications.                  */
+                          void            * param,      /**< [in] Parameter of the handler.                  */
+                          bool              values)     /**< [in] Whether the handler needs new values of records. */
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    m_state->subscriptions.push_back(subscription(tbl, fn_notify, param, values));
+    m_state->enabled = true;
+
+    if (m_state->thread == NULL && !m_state->stop)
+    {
+        m_state->thread = new boost::thread(boost::bind(&notify_state::run, m_state));
+    }
+
+    tbl->m_notified      = true;
+    tbl->m_notify_values = tbl->m_notify_values || values;
+}
+
+/**
+ * Removes subscription to changes of specified table.
+ * Changes of the table are not queued any longer, when it has no subscriptions left.
+ */
+void notifier::unsubscribe (table           * tbl,          /**< [in] Subscribed table.          */
+                            notify_callback   fn_notify,    /**< [in] Handler of notifications.  */
+                            void            * param)        /**< [in] Parameter of the handler.  */
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    bool notified = false;
+    bool values   = false;
+
+    for (size_t i = 0; i < m_state->subscriptions.size(); )
+    {
+        subscription & sub = m_state->subscriptions[i];
+
+        if (sub.tbl == tbl && sub.fn_notify == fn_notify && sub.param == param)
+        {
+            m_state->subscriptions.erase(m_state->subscriptions.begin() + i);
+            continue;
+        }
+
+        if (sub.tbl == tbl)
+        {
+            notified = true;
+            values   = values || sub.values;
+        }
+
+        i++;
+    }
+
+    tbl->m_notified      = notified;
+    tbl->m_notify_values = values;
+}
+
+/**
+ * Removes all subscriptions to changes of specified table, and drops its queued changes.
+ * Waits for completion of delivery of its changes, if they are being delivered.
+ */
+void notifier::forget (table * tbl)     /**< [in] Closed table. */
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    for (size_t i = 0; i < m_state->subscriptions.size(); )
+    {
+        if (m_state->subscriptions[i].tbl == tbl) m_state->subscriptions.erase(m_state->subscriptions.begin() + i);
+        else i++;
+    }
+
+    for (map <DB_TXN *, pending_changes>::iterator i = m_state->pending.begin(); i != m_state->pending.end(); ++i)
+    {
+        i->second.changes.erase(tbl);
+    }
+
+    for (size_t i = 0; i < m_state->committed.size(); )
+    {
+        if (m_state->committed[i].tbl == tbl) m_state->committed.erase(m_state->committed.begin() + i);
+        else i++;
+    }
+
+    while (m_state->delivering == tbl) m_state->cond.wait(lock);
+
+    tbl->m_notified      = false;
+    tbl->m_notify_values = false;
+}
+
+/**
+ * Waits for delivery of all committed changes.
+ */
+void notifier::drain ()
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    while (!m_state->stop && (!m_state->committed.empty() || m_state->delivering != NULL)) m_state->cond.wait(lock);
+}
+
+/**
+ * Stops delivering thread (if it's running), dropping undelivered changes.
+ * Changes can't be delivered any longer.
+ */
+void notifier::shutdown ()
+{
+    boost::thread * thread = NULL;
+
+    {
+        boost::mutex::scoped_lock lock(m_state->mutex);
+
+        m_state->stop = true;
+        m_state->committed.clear();
+        m_state->cond.notify_all();
+
+        thread = m_state->thread;
+        m_state->thread = NULL;
+    }
+
+    if (thread != NULL)
+    {
+        thread->join();
+        delete thread;
+    }
+}
+
+/**
+ * Checks whether changes are queued (since the first subscription).
+ */
+bool notifier::active () const
+{
+    return m_state->enabled;
+}
+
+/**
+ * Queues change of specified record in specified transaction, replacing previous change of the record
+ * in the same transaction. Change without transaction is committed already, and is queued for delivery.
+ */
+void notifier::add (DB_TXN      * txn,      /**< [in] Transaction of the change ("NULL" - committed).  */
+                    table       * tbl,      /**< [in] Changed table.                                   */
+                    const DBT   * key,      /**< [in] Primary key.                                     */
+                    const DBT   * data,     /**< [in] New primary data ("NULL" for removed record).    */
+                    bool          values)   /**< [in] Whether new data are kept.                       */
+{
+    string k((const char *) key->data, key->size);
+
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    table_changes   committed;
+    table_changes & changes = (txn != NULL ? m_state->pending[txn].changes : committed);
+
+    change_notice & notice = changes[tbl][k];
+
+    notice.key     = k;
+    notice.removed = (data == NULL);
+
+    if (data != NULL && values) notice.data.assign((const char *) data->data, data->size);
+    else notice.data.clear();
+
+    if (txn == NULL) m_state->queue(committed);
+}
+
+/**
+ * Registers new transaction with its parent, so changes of the transaction are merged into the parent on commit.
+ */
+void notifier::begin (DB_TXN * txn,     /**< [in] New transaction.                      */
+                      DB_TXN * parent)  /**< [in] Parent transaction ("NULL" - top-level). */
+{
+    if (parent == NULL) return;
+
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    m_state->pending[txn].parent = parent;
+}
+
+/**
+ * Completes committed transaction: its changes are merged into its parent, or are queued for delivery,
+ * if it's top-level (or its parent is the root transaction of the database, which lasts until it's closed).
+ */
+void notifier::commit (DB_TXN * txn,    /**< [in] Committed transaction.                        */
+                       DB_TXN * root)   /**< [in] Top-level transaction of the database (or "NULL"). */
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    map <DB_TXN *, pending_changes>::iterator i = m_state->pending.find(txn);
+
+    if (i == m_state->pending.end()) return;
+
+    if (i->second.parent != NULL && i->second.parent != root)
+    {
+        table_changes & parent = m_state->pending[i->second.parent].changes;
+
+        // later changes of the child replace changes of the parent
+        for (table_changes::iterator j = i->second.changes.begin(); j != i->second.changes.end(); ++j)
+        {
+            notice_map & notices = parent[j->first];
+
+            for (notice_map::iterator n = j->second.begin(); n != j->second.end(); ++n)
+            {
+                notices[n->first] = n->second;
+            }
+        }
+    }
+    else
+    {
+        m_state->queue(i->second.changes);
+    }
+
+    m_state->pending.erase(i);
+}
+
+/**
+ * Completes aborted transaction: its changes, and changes of its active children, are dropped.
+ */
+void notifier::abort (DB_TXN * txn)     /**< [in] Aborted transaction. */
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    if (m_state->pending.empty()) return;
+
+    set <DB_TXN *> aborted;
+    aborted.insert(txn);
+
+    m_state->pending.erase(txn);
+
+    // children are aborted with their parent (and their children with them)
+    for (bool found = true; found; )
+    {
+        found = false;
+
+        for (map <DB_TXN *, pending_changes>::iterator i = m_state->pending.begin(); i != m_state->pending.end(); )
+        {
+            if (aborted.count(i->second.parent) != 0)
+            {
+                aborted.insert(i->first);
+                m_state->pending.erase(i++);
+                found = true;
+            }
+            else ++i;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of change notifications of class "bdb::table".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Subscribes specified handler to notifications of committed changes of the table.
+ * Changes are delivered by notification thread of the database, after their transactions are committed
+ * (changes of rolled back transactions are dropped): one notification per committed transaction, which has
+ * changed the table, with the last change of each changed record. New values of records are delivered,
+ * if they are requested (by any subscription of the table). Changes are queued since the first subscription
+ * of the database, so changes of transactions, which are begun before, may be delivered on commit of their
+ * nested transactions already.
+ */
+void table::subscribe (notify_callback   fn_notify,     /**< [in] Handler of notifications.                  */
+                       void            * param,         /**< [in] Parameter of the handler.                  */
+                       bool              values)        /**< [in] Whether the handler needs new values of records. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::subscribe] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::subscribe] values = " << values);
+
+    m_database->m_notifier->subscribe(this, fn_notify, param, values);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::subscribe] EXIT");
+}
+
+/**
+ * Unsubscribes specified handler (with specified parameter) from notifications of changes of the table.
+ * Notifications, which are being delivered to the handler, may still be completed after that.
+ */
+void table::unsubscribe (notify_callback   fn_notify,   /**< [in] Handler of notifications.  */
+                         void            * param)       /**< [in] Parameter of the handler.  */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::unsubscribe] ENTER");
+
+    m_database->m_notifier->unsubscribe(this, fn_notify, param);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::unsubscribe] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of change notifications of class "bdb::database".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Waits until change notifications of all committed transactions are delivered to subscribers of tables
+ * (see "bdb::table::subscribe"). Handlers of notifications must not call the function.
+ */
+void database::wait_notifications ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::wait_notifications] ENTER");
+
+    m_notifier->drain();
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::wait_notifications] EXIT");
+}
+
+/**
+ * Aborts specified transaction, dropping its queued change notifications.
+ * Returns error code of Berkeley DB.
+ */
+int database::abort_txn (DB_TXN * txn)  /**< [in] Transaction to be aborted. */
+{
+    if (m_notifier != NULL && m_notifier->active()) m_notifier->abort(txn);
+
+    // cursors must be closed before the transaction is resolved
+    if (m_cursors != NULL) m_cursors->release(txn);
+
+    return txn->abort(txn);
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
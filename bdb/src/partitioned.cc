@@ -0,0 +1,623 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/partitioned.cc
+ * Contains implementation of classes "bdb::partitioned_table" and "bdb::partitioned_recordset".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Protocol Buffers
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+
+// Boost C++ Libraries
+#include <boost/thread/mutex.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::partitioned_table".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::map;
+using std::string;
+using std::vector;
+
+using google::protobuf::FieldDescriptor;
+using google::protobuf::Message;
+using google::protobuf::Reflection;
+
+/** @private Open partitions of partitioned table. */
+class partition_map
+{
+public:
+
+    boost::mutex                mutex;      /**< Guards the partitions.            */
+    map <int64_t, table *>      tables;     /**< Partitions by their numbers.      */
+};
+
+/**
+ * @private Makes "DBT" object, which references specified number of partition (key of the catalog).
+ */
+static void make_dbt (const int64_t * number,   /**< [in]  Number of partition.       */
+                      DBT           * to)       /**< [out] Resulted "DBT" object.     */
+{
+    memset(to, 0, sizeof(DBT));
+
+    to->data = (void *) number;
+    to->size = sizeof(int64_t);
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens partitioned table, and all its partitions, listed in its catalog.
+ * Records are partitioned by specified field of keys, so each partition holds records with values of the field
+ * in its range "[number * width, (number + 1) * width)". The field must be a non-repeated field of integer type
+ * ("int32", "int64", "uint32", "uint64" and their "sint"/"fixed" variants).
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the table is not found.
+ * @throw bdb::exception BDB_ERROR_EXISTS    - the table already exists (cannot be created).
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+partitioned_table::partitioned_table (database            * db,         /**< [in] Database of the table.                               */
+                                      const char          * name,       /**< [in] Name of the table (partitions are "<name>.<number>"). */
+                                      compare_callback      fn_cmp,     /**< [in] Keys comparision function.                           */
+                                      int                   field,      /**< [in] Partitioning field of keys.                          */
+                                      int64_t               width,      /**< [in] Width of the range of field values per partition.   */
+                                      bool                  create,     /**< [in] Whether to create the table if it doesn't exist.   */
+                                      const table_options & options)    /**< [in] Tuning options of partitions.                        */
+  : m_database(db),
+    m_name(name),
+    m_callback(fn_cmp),
+    m_field(field),
+    m_width(width),
+    m_options(options),
+    m_catalog(NULL),
+    m_map(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::partitioned_table::partitioned_table] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::partitioned_table::partitioned_table] name = " << name << ", field = " << field << ", width = " << width);
+    LOG4CPLUS_DEBUG(logger, "[bdb::partitioned_table::partitioned_table] create = " << create);
+
+    if (width <= 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::partitioned_table::partitioned_table] Width of partitions must be positive.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    u_int32_t flags = DB_THREAD;
+    if (create) flags |= DB_CREATE | DB_EXCL;
+
+    int res = db_create(&m_catalog, db->m_env, 0);
+    if (res == 0) res = db->open_file(m_catalog, db->get_transaction(), m_name + ".parts", "partitions", DB_BTREE, flags);
+
+    vector <int64_t> numbers;
+
+    DBC * cursor = NULL;
+
+    if (res == 0) res = m_catalog->cursor(m_catalog, db->get_transaction(), &cursor, 0);
+
+    while (res == 0)
+    {
+        int64_t number;
+
+        DBT k, d;
+        memset(&k, 0, sizeof(DBT));
+        memset(&d, 0, sizeof(DBT));
+
+        k.data  = &number;
+        k.ulen  = sizeof(int64_t);
+        k.flags = DB_DBT_USERMEM;
+
+        res = cursor->get(cursor, &k, &d, DB_NEXT);
+        if (res == 0) numbers.push_back(number);
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::partitioned_table::partitioned_table] " << db_strerror(res));
+
+        if (m_catalog != NULL) m_catalog->close(m_catalog, 0);
+
+        switch (res)
+        {
+            case ENOENT:    throw exception(BDB_ERROR_NOT_FOUND);
+            case EEXIST:    throw exception(BDB_ERROR_EXISTS);
+            default:        throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    m_map = new partition_map;
+    assert(m_map != NULL);
+
+    try
+    {
+        for (size_t i = 0; i < numbers.size(); i++)
+        {
+            m_map->tables[numbers[i]] = open_partition(numbers[i], false);
+        }
+    }
+    catch (...)
+    {
+        delete m_map;
+        m_catalog->close(m_catalog, 0);
+        throw;
+    }
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::partitioned_table::partitioned_table] partitions = " << numbers.size());
+    LOG4CPLUS_TRACE(logger, "[bdb::partitioned_table::partitioned_table] EXIT");
+}
+
+/**
+ * Closes catalog of the table. Partitions are closed with their database.
+ */
+partitioned_table::~partitioned_table () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::partitioned_table::~partitioned_table] ENTER");
+
+    delete m_map;
+    m_catalog->close(m_catalog, 0);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::partitioned_table::~partitioned_table] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Checks whether the record with specified key exists in its partition.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+bool partitioned_table::exists (const Message * key,    /**< [in] Key of the record.                  */
+                                transaction   * txn)    /**< [in] Transaction (can be "NULL").        */
+{
+    table * t = find_partition(key, false);
+    return (t != NULL && t->exists(key, txn));
+}
+
+/**
+ * Removes the record with specified key from its partition.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the record is not found.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void partitioned_table::remove (const Message * key,    /**< [in] Key of the record.                  */
+                                transaction   * txn)    /**< [in] Transaction (can be "NULL").        */
+{
+    table * t = find_partition(key, false);
+
+    if (t == NULL) throw exception(BDB_ERROR_NOT_FOUND);
+
+    t->remove(key, txn);
+}
+
+/**
+ * Inserts new record into its partition, creating the partition if it doesn't exist yet.
+ *
+ * @throw bdb::exception BDB_ERROR_EXISTS  - the record already exists.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void partitioned_table::insert (const Message * key,    /**< [in] Key of new record.                  */
+                                const Message * data,   /**< [in] Data of new record.                 */
+                                transaction   * txn)    /**< [in] Transaction (can be "NULL").        */
+{
+    find_partition(key, true)->insert(key, data, txn);
+}
+
+/**
+ * Updates the record with specified key in its partition.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the record is not found.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void partitioned_table::update (const Message * key,    /**< [in] Key of the record.                  */
+                                const Message * data,   /**< [in] New data of the record.             */
+                                transaction   * txn)    /**< [in] Transaction (can be "NULL").        */
+{
+    table * t = find_partition(key, false);
+
+    if (t == NULL) throw exception(BDB_ERROR_NOT_FOUND);
+
+    t->update(key, data, txn);
+}
+
+/**
+ * Inserts new record into its partition, or updates existing one (see "bdb::table::upsert").
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return true  - new record is inserted.
+ * @return false - existing record is updated.
+ */
+bool partitioned_table::upsert (const Message * key,    /**< [in] Key of the record.                  */
+                                const Message * data,   /**< [in] Data of the record.                 */
+                                transaction   * txn)    /**< [in] Transaction (can be "NULL").        */
+{
+    return find_partition(key, true)->upsert(key, data, txn);
+}
+
+/**
+ * Selects the record with specified key from its partition.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the record is not found.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void partitioned_table::select (const Message * key,    /**< [in]  Key of the record.                 */
+                                Message       * data,   /**< [out] Data of found record.              */
+                                transaction   * txn)    /**< [in]  Transaction (can be "NULL").       */
+{
+    table * t = find_partition(key, false);
+
+    if (t == NULL) throw exception(BDB_ERROR_NOT_FOUND);
+
+    t->select(key, data, txn);
+}
+
+/**
+ * Finds the record with specified key in its partition, without throwing if it's missing (see "bdb::table::find").
+ *
+ * @return true  - the record is found.
+ * @return false - the record is not found.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+bool partitioned_table::find (const Message * key,      /**< [in]  Key of the record.                 */
+                              Message       * data,     /**< [out] Data of found record.              */
+                              transaction   * txn)      /**< [in]  Transaction (can be "NULL").       */
+{
+    table * t = find_partition(key, false);
+    return (t != NULL && t->find(key, data, txn));
+}
+
+/**
+ * Returns total number of records in all partitions (see "bdb::table::count").
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+unsigned int partitioned_table::count (bool          fast,  /**< [in] Whether to return possibly stale count, not traversing the tables. */
+                                       transaction * txn)   /**< [in] Transaction (can be "NULL").                                       */
+{
+    vector <int64_t> list;
+    partitions(&list);
+
+    unsigned int total = 0;
+
+    for (size_t i = 0; i < list.size(); i++)
+    {
+        total += partition(list[i])->count(fast, txn);
+    }
+
+    return total;
+}
+
+/**
+ * Returns number of partition of specified key (values of partitioning field are rounded down).
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the key has no partitioning field of integer type.
+ */
+int64_t partitioned_table::partition_of (const Message * key)   /**< [in] Key of a record. */
+{
+    const FieldDescriptor * field = key->GetDescriptor()->FindFieldByNumber(m_field);
+    const Reflection      * refl  = key->GetReflection();
+
+    if (field == NULL || field->is_repeated())
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::partitioned_table::partition_of] The key has no partitioning field " << m_field << ".");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    int64_t value;
+
+    switch (field->cpp_type())
+    {
+        case FieldDescriptor::CPPTYPE_INT32:    value = refl->GetInt32 (*key, field);             break;
+        case FieldDescriptor::CPPTYPE_INT64:    value = refl->GetInt64 (*key, field);             break;
+        case FieldDescriptor::CPPTYPE_UINT32:   value = refl->GetUInt32(*key, field);             break;
+        case FieldDescriptor::CPPTYPE_UINT64:   value = (int64_t) refl->GetUInt64(*key, field);   break;
+
+        default:
+            LOG4CPLUS_WARN(logger, "[bdb::partitioned_table::partition_of] Partitioning field must be of integer type.");
+            throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    int64_t number = value / m_width;
+
+    // round down negative values
+    if (value % m_width != 0 && value < 0) number--;
+
+    return number;
+}
+
+/**
+ * Returns numbers of all partitions in ascending order.
+ */
+void partitioned_table::partitions (vector <int64_t> * list)    /**< [out] Numbers of partitions. */
+{
+    boost::mutex::scoped_lock lock(m_map->mutex);
+
+    list->clear();
+
+    for (map <int64_t, table *>::const_iterator i = m_map->tables.begin(); i != m_map->tables.end(); ++i)
+    {
+        list->push_back(i->first);
+    }
+}
+
+/**
+ * Returns table of specified partition ("NULL" if it doesn't exist), e.g. to add indexes, or to scan it.
+ */
+table * partitioned_table::partition (int64_t number)   /**< [in] Number of the partition. */
+{
+    boost::mutex::scoped_lock lock(m_map->mutex);
+
+    map <int64_t, table *>::const_iterator i = m_map->tables.find(number);
+
+    return (i == m_map->tables.end() ? NULL : i->second);
+}
+
+/**
+ * Drops specified partition with all its records at once, removing its table files
+ * (in implicit transaction, if there is no one).
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the partition doesn't exist.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void partitioned_table::drop_partition (int64_t number)     /**< [in] Number of the partition. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::partitioned_table::drop_partition] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::partitioned_table::drop_partition] number = " << number);
+
+    boost::mutex::scoped_lock lock(m_map->mutex);
+
+    map <int64_t, table *>::iterator i = m_map->tables.find(number);
+
+    if (i == m_map->tables.end())
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::partitioned_table::drop_partition] The partition doesn't exist.");
+        throw exception(BDB_ERROR_NOT_FOUND);
+    }
+
+    DBT k;
+    make_dbt(&number, &k);
+
+    int res = m_catalog->del(m_catalog, m_database->get_transaction(), &k, 0);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::partitioned_table::drop_partition] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    table * t = i->second;
+    m_map->tables.erase(i);
+
+    m_database->remove_table(t);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::partitioned_table::drop_partition] EXIT");
+}
+
+/**
+ * Drops all partitions, which hold values of partitioning field less than specified one only
+ * (e.g. records, older than retention period).
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return Number of dropped partitions.
+ */
+unsigned int partitioned_table::drop_before (int64_t value)     /**< [in] The least value to keep. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::partitioned_table::drop_before] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::partitioned_table::drop_before] value = " << value);
+
+    vector <int64_t> list;
+    partitions(&list);
+
+    unsigned int dropped = 0;
+
+    // the last value of partition "n" is "(n + 1) * width - 1"
+    for (size_t i = 0; i < list.size() && (list[i] + 1) * m_width <= value; i++)
+    {
+        drop_partition(list[i]);
+        dropped++;
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::partitioned_table::drop_before] EXIT = " << dropped);
+
+    return dropped;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns table of the partition of specified key, creating it if requested ("NULL" if it doesn't exist).
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+table * partitioned_table::find_partition (const Message * key,     /**< [in] Key of a record.                              */
+                                           bool            create)  /**< [in] Whether to create absent partition.           */
+{
+    int64_t number = partition_of(key);
+
+    boost::mutex::scoped_lock lock(m_map->mutex);
+
+    map <int64_t, table *>::const_iterator i = m_map->tables.find(number);
+
+    if (i != m_map->tables.end()) return i->second;
+    if (!create) return NULL;
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::partitioned_table::find_partition] new partition = " << number);
+
+    table * t = open_partition(number, true);
+
+    DBT k, d;
+    make_dbt(&number, &k);
+    memset(&d, 0, sizeof(DBT));
+
+    int res = m_catalog->put(m_catalog, m_database->get_transaction(), &k, &d, 0);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::partitioned_table::find_partition] " << db_strerror(res));
+
+        m_database->remove_table(t);
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    m_map->tables[number] = t;
+
+    return t;
+}
+
+/**
+ * Opens (or creates) table of specified partition.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the partition is not found.
+ * @throw bdb::exception BDB_ERROR_EXISTS    - the partition already exists (cannot be created).
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+table * partitioned_table::open_partition (int64_t number,  /**< [in] Number of the partition.           */
+                                           bool    create)  /**< [in] Whether to create the partition.   */
+{
+    std::ostringstream name;
+    name << m_name << "." << number;
+
+    return m_database->add_table(name.str().c_str(), m_callback, create, m_options);
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::partitioned_recordset".
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens recordsets of all current partitions of the table, and merges them (see "bdb::merged_recordset").
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+partitioned_recordset::partitioned_recordset (partitioned_table * tbl,          /**< [in] Partitioned table.                           */
+                                              transaction       * txn,          /**< [in] Transaction (can be "NULL").                 */
+                                              bool                prefetch)     /**< [in] Whether to read ahead records of partitions. */
+  : merged_recordset(open_partitions(tbl, txn), prefetch)
+{
+}
+
+/**
+ * Closes recordsets of the partitions.
+ */
+partitioned_recordset::~partitioned_recordset () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::partitioned_recordset::~partitioned_recordset] ENTER");
+
+    // prefetching threads use the recordsets
+    stop();
+
+    for (size_t i = 0; i < m_list.size(); i++)
+    {
+        delete m_list[i];
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::partitioned_recordset::~partitioned_recordset] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens recordsets of all partitions of specified table.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+joinlist partitioned_recordset::open_partitions (partitioned_table * tbl,   /**< [in] Partitioned table.           */
+                                                 transaction       * txn)   /**< [in] Transaction (can be "NULL"). */
+{
+    vector <int64_t> numbers;
+    tbl->partitions(&numbers);
+
+    joinlist list;
+
+    try
+    {
+        for (size_t i = 0; i < numbers.size(); i++)
+        {
+            list.push_back(new recordset(tbl->partition(numbers[i]), txn));
+        }
+    }
+    catch (...)
+    {
+        for (size_t i = 0; i < list.size(); i++)
+        {
+            delete list[i];
+        }
+
+        throw;
+    }
+
+    return list;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,463 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/pool.cc
+ * Contains implementation of classes "bdb::work_pool" and "bdb::task_group".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cassert>
+#include <deque>
+#include <vector>
+
+// Boost C++ Libraries
+#include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/thread/tss.hpp>
+
+// CPU affinity of threads is set by "pthread_setaffinity_np" on Linux only
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#define BDB_THREAD_AFFINITY
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of classes "bdb::work_pool" and "bdb::task_group".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::deque;
+using std::vector;
+
+using boost::thread_specific_ptr;
+using boost::get_system_time;
+using boost::posix_time::milliseconds;
+
+/** @private Period, a waiting thread of task group checks for queued tasks, when there are none (in milliseconds). */
+static const long GROUP_WAIT_PERIOD = 1;
+
+/** @private Queued task. */
+class pool_task
+{
+public:
+
+    pool_task (task_callback task_fn = NULL, void * task_param = NULL) : fn_task(task_fn), param(task_param) { }
+
+    task_callback   fn_task;    /**< Function of the task.       */
+    void          * param;      /**< Parameter of the function.  */
+};
+
+/** @private Deque of tasks of one worker. */
+class worker_deque
+{
+public:
+
+    boost::mutex        mutex;      /**< Guards the tasks.                                          */
+    deque <pool_task>   tasks;      /**< Tasks; the owner takes the newest, thieves take the oldest. */
+};
+
+/** @private Worker of a pool, which the current thread is ("NULL" if the thread is not a worker). */
+class worker_slot
+{
+public:
+
+    worker_slot (const pool_state * slot_pool, size_t slot_index) : pool(slot_pool), index(slot_index) { }
+
+    const pool_state  * pool;   /**< Pool of the worker.           */
+    size_t              index;  /**< Index of the worker's deque.  */
+};
+
+/** @private Worker, which the current thread is. */
+static thread_specific_ptr <worker_slot> current_worker;
+
+/** @private Deques of tasks and worker threads of pool. */
+class pool_state
+{
+public:
+
+    pool_state (unsigned int nthreads, bool bind, unsigned int cpu)
+      : affinity(bind),
+        first_cpu(cpu),
+        queued(0),
+        next(0),
+        started(false),
+        stop(false)
+    {
+        if (nthreads == 0) nthreads = boost::thread::hardware_concurrency();
+        if (nthreads == 0) nthreads = 1;
+
+        for (unsigned int i = 0; i < nthreads; i++)
+        {
+            deques.push_back(new worker_deque);
+        }
+    }
+
+    ~pool_state ()
+    {
+        for (size_t i = 0; i < deques.size(); i++)
+        {
+            delete deques[i];
+        }
+    }
+
+    bool                        affinity;   /**< Whether each worker is bound to its own CPU.                   */
+    unsigned int                first_cpu;  /**< CPU of the first worker.                                       */
+    vector <worker_deque *>     deques;     /**< Deques of the workers (one per worker).                        */
+
+    boost::mutex                mutex;      /**< Guards all the fields below.                                   */
+    boost::condition_variable   work;       /**< Signals queued tasks (and stop) to idle workers.               */
+    long                        queued;     /**< Number of queued tasks (may be momentarily overestimated).     */
+    size_t                      next;       /**< Deque of the next task, submitted by a thread, which is not a worker. */
+    bool                        started;    /**< Whether the workers are started.                              */
+    bool                        stop;       /**< Whether the workers should stop, when no tasks are queued.     */
+    boost::thread_group         threads;    /**< Worker threads.                                                */
+
+    /** Returns deque of the current thread, if it's a worker of the pool, or number of deques otherwise. */
+    size_t own_deque () const
+    {
+        worker_slot * slot = current_worker.get();
+        return (slot != NULL && slot->pool == this ? slot->index : deques.size());
+    }
+
+    /** Takes the newest task of own deque, or steals the oldest task of another one. */
+    bool take (size_t own, pool_task * task)
+    {
+        bool found = false;
+
+        if (own < deques.size())
+        {
+            boost::mutex::scoped_lock lock(deques[own]->mutex);
+
+            if (!deques[own]->tasks.empty())
+            {
+                *task = deques[own]->tasks.back();
+                deques[own]->tasks.pop_back();
+                found = true;
+            }
+        }
+
+        for (size_t i = 1; !found && i <= deques.size(); i++)
+        {
+            worker_deque * victim = deques[(own + i) % deques.size()];
+
+            boost::mutex::scoped_lock lock(victim->mutex);
+
+            if (!victim->tasks.empty())
+            {
+                *task = victim->tasks.front();
+                victim->tasks.pop_front();
+                found = true;
+            }
+        }
+
+        if (found)
+        {
+            boost::mutex::scoped_lock lock(mutex);
+            queued--;
+        }
+
+        return found;
+    }
+
+    /** Runs the task, keeping the worker alive if it throws. */
+    static void execute (const pool_task & task)
+    {
+        try
+        {
+            task.fn_task(task.param);
+        }
+        catch (...)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::work_pool] Task failed with exception.");
+        }
+    }
+
+    /** Binds the current thread to CPU of specified worker. */
+    void bind (size_t index)
+    {
+#ifdef BDB_THREAD_AFFINITY
+        unsigned int ncpus = boost::thread::hardware_concurrency();
+        if (ncpus == 0) return;
+
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET((first_cpu + index) % ncpus, &cpus);
+
+        int res = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus);
+
+        if (res != 0)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::work_pool] CPU affinity of worker " << index << " is not set (error " << res << ").");
+        }
+#else
+        (void) index;
+#endif
+    }
+
+    /** Body of worker thread. */
+    void run (size_t index)
+    {
+        current_worker.reset(new worker_slot(this, index));
+
+        if (affinity) bind(index);
+
+        pool_task task;
+
+        for (;;)
+        {
+            if (take(index, &task))
+            {
+                execute(task);
+                continue;
+            }
+
+            boost::mutex::scoped_lock lock(mutex);
+
+            while (queued <= 0 && !stop)
+            {
+                work.wait(lock);
+            }
+
+            if (queued <= 0) return;
+        }
+    }
+};
+
+/** @private Number of incomplete tasks of task group, and its condition. */
+class group_state
+{
+public:
+
+    group_state () : pending(0) { }
+
+    boost::mutex                mutex;      /**< Guards the number of tasks.                */
+    boost::condition_variable   done;       /**< Signals completion of a task.              */
+    size_t                      pending;    /**< Number of submitted, but incomplete tasks. */
+};
+
+/** @private Task of task group. */
+class group_task
+{
+public:
+
+    group_task (task_callback task_fn, void * task_param, group_state * task_group)
+      : fn_task(task_fn), param(task_param), group(task_group)
+    {
+    }
+
+    task_callback   fn_task;    /**< Function of the task.       */
+    void          * param;      /**< Parameter of the function.  */
+    group_state   * group;      /**< State of the group.         */
+
+    /** Runs the task, and completes it in its group. */
+    static void run (void * arg)
+    {
+        group_task * task = static_cast <group_task *> (arg);
+
+        pool_state::execute(pool_task(task->fn_task, task->param));
+
+        {
+            boost::mutex::scoped_lock lock(task->group->mutex);
+
+            task->group->pending--;
+            task->group->done.notify_all();
+        }
+
+        delete task;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Work pool.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Makes pool with specified number of workers (the threads are started on first submitted task).
+ */
+work_pool::work_pool (unsigned int nthreads,    /**< [in] Number of worker threads ("0" - one per core). */
+                      bool         affinity,    /**< [in] Whether each worker is bound to its own CPU.   */
+                      unsigned int first_cpu)   /**< [in] CPU of the first worker.                       */
+  : m_state(new pool_state(nthreads, affinity, first_cpu))
+{
+    assert(m_state != NULL);
+}
+
+/**
+ * Runs all queued tasks, and stops the workers.
+ */
+work_pool::~work_pool () throw ()
+{
+    {
+        boost::mutex::scoped_lock lock(m_state->mutex);
+
+        m_state->stop = true;
+        m_state->work.notify_all();
+    }
+
+    m_state->threads.join_all();
+
+    delete m_state;
+}
+
+/**
+ * Queues the task into deque of the current worker, or (if the thread is not a worker) into deque of the next worker.
+ */
+void work_pool::submit (task_callback   fn_task,    /**< [in] Function of the task.       */
+                        void          * param)      /**< [in] Parameter of the function.  */
+{
+    size_t own = m_state->own_deque();
+
+    {
+        boost::mutex::scoped_lock lock(m_state->mutex);
+
+        if (!m_state->started)
+        {
+            for (size_t i = 0; i < m_state->deques.size(); i++)
+            {
+                m_state->threads.create_thread(boost::bind(&pool_state::run, m_state, i));
+            }
+
+            m_state->started = true;
+        }
+
+        if (own == m_state->deques.size())
+        {
+            own = m_state->next++ % m_state->deques.size();
+        }
+    }
+
+    {
+        boost::mutex::scoped_lock lock(m_state->deques[own]->mutex);
+        m_state->deques[own]->tasks.push_back(pool_task(fn_task, param));
+    }
+
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    m_state->queued++;
+    m_state->work.notify_one();
+}
+
+/**
+ * Runs one queued task by the current thread, if there is any.
+ *
+ * @return Whether a task is run.
+ */
+bool work_pool::run_one ()
+{
+    pool_task task;
+
+    if (!m_state->take(m_state->own_deque(), &task)) return false;
+
+    pool_state::execute(task);
+
+    return true;
+}
+
+/**
+ * Returns number of worker threads.
+ */
+unsigned int work_pool::size () const
+{
+    return (unsigned int) m_state->deques.size();
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Task group.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Makes empty group of tasks of the pool.
+ */
+task_group::task_group (work_pool * pool)   /**< [in] Pool, which runs the tasks. */
+  : m_pool(pool),
+    m_state(new group_state)
+{
+    assert(m_state != NULL);
+}
+
+/**
+ * Waits for all tasks of the group.
+ */
+task_group::~task_group () throw ()
+{
+    wait();
+    delete m_state;
+}
+
+/**
+ * Submits the task to the pool as a task of the group.
+ */
+void task_group::run (task_callback   fn_task,  /**< [in] Function of the task.       */
+                      void          * param)    /**< [in] Parameter of the function.  */
+{
+    group_task * task = new group_task(fn_task, param, m_state);
+    assert(task != NULL);
+
+    {
+        boost::mutex::scoped_lock lock(m_state->mutex);
+        m_state->pending++;
+    }
+
+    m_pool->submit(group_task::run, task);
+}
+
+/**
+ * Waits until all tasks of the group are completed, running queued tasks of the pool meanwhile.
+ */
+void task_group::wait ()
+{
+    for (;;)
+    {
+        {
+            boost::mutex::scoped_lock lock(m_state->mutex);
+            if (m_state->pending == 0) return;
+        }
+
+        if (m_pool->run_one()) continue;
+
+        // the remaining tasks are running by other threads
+        boost::mutex::scoped_lock lock(m_state->mutex);
+
+        if (m_state->pending != 0)
+        {
+            m_state->done.timed_wait(lock, get_system_time() + milliseconds(GROUP_WAIT_PERIOD));
+        }
+    }
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
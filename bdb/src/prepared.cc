@@ -0,0 +1,120 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/prepared.cc
+ * Contains implementation of class "bdb::prepared_key".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <string>
+
+// Protocol Buffers
+#include <google/protobuf/message.h>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::prepared_key".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::string;
+
+using google::protobuf::Message;
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Serializes specified key of the table.
+ */
+prepared_key::prepared_key (table             * tbl,    /**< [in] Table of the key.  */
+                            const MessageLite * key)    /**< [in] Key to serialize.  */
+  : m_table(tbl)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::prepared_key::prepared_key] ENTER");
+    prepare(key);
+    LOG4CPLUS_TRACE(logger, "[bdb::prepared_key::prepared_key] EXIT");
+}
+
+/**
+ * Serializes specified key of the index.
+ */
+prepared_key::prepared_key (index             * idx,    /**< [in] Index of the key.  */
+                            const MessageLite * key)    /**< [in] Key to serialize.  */
+  : m_table(static_cast<table *>(idx))
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::prepared_key::prepared_key] ENTER");
+    prepare(key);
+    LOG4CPLUS_TRACE(logger, "[bdb::prepared_key::prepared_key] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Replaces the key by another one of the same table (or index), reusing memory of the key.
+ */
+void prepared_key::reset (const MessageLite * key)  /**< [in] Key to serialize. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::prepared_key::reset] ENTER");
+    prepare(key);
+    LOG4CPLUS_TRACE(logger, "[bdb::prepared_key::reset] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Serializes specified key in format of the table.
+ */
+void prepared_key::prepare (const MessageLite * key)    /**< [in] Key to serialize. */
+{
+    DBT k;
+
+    m_table->encode_key(key, &k);
+    m_key.assign((const char *) k.data, k.size);
+    release(&k);
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -30,12 +30,25 @@
 #include <bdb.h>
 
 // Standard C/C++ Libraries
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
+#include <iterator>
+#include <string>
+#include <utility>
 #include <vector>
 
 // Protocol Buffers
 #include <google/protobuf/message.h>
 
+// Boost C++ Libraries
+#include <boost/bind.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
 // Berkeley DB
 #include <db.h>
 
@@ -57,33 +70,521 @@
 #define BDB_RS_DUPLICATES   2   /**< Contains all records from specified index.                     */
 #define BDB_RS_UNIQUE       3   /**< Contains all records with particular key from specified index. */
 #define BDB_RS_JOIN         4   /**< Contains all records from natural join of several indexes.     */
+#define BDB_RS_RANGE        5   /**< Contains records with keys in specified range from specified table. */
+#define BDB_RS_INDEX_RANGE  6   /**< Contains records with keys in specified range from specified index. */
+#define BDB_RS_COMBINED     7   /**< Contains records from intersection or union of several recordsets.  */
+#define BDB_RS_SAMPLE       8   /**< Contains random sample of records from specified table.        */
+#define BDB_RS_INDEX_SAMPLE 9   /**< Contains random sample of records from specified index.        */
+//@}
+
+/** @private Positions of recordset, set by seeks. */
+//@{
+#define BDB_SEEK_NONE       0   /**< Cursor is at the last fetched record.                          */
+#define BDB_SEEK_FOUND      1   /**< Record is read by seek, and will be returned by next fetch.    */
+#define BDB_SEEK_END        2   /**< Cursor is past the last record.                                */
 //@}
 
+/** @private Kinds of position tokens (see "bdb::recordset::position"). */
+//@{
+#define BDB_TOKEN_NONE      0   /**< Index key of the record is unknown (index recordset in read-ahead mode). */
+#define BDB_TOKEN_TABLE     1   /**< Primary key of record of table.                                */
+#define BDB_TOKEN_INDEX     2   /**< Primary key and index key of record of index.                  */
+//@}
+
+/** @private ProtoBuf wire type of strings, bytes and nested messages (see "bdb::record_view::get"). */
+#define WIRETYPE_LENGTH_DELIMITED   2
+
 namespace bdb
 {
 
+using std::pair;
+using std::string;
 using std::vector;
 
 using google::protobuf::Message;
 
+/** @private Bulk buffers must be a multiple of this size (see "DB_MULTIPLE_KEY"). */
+static const unsigned int BULK_ALIGNMENT = 1024;
+
+/** @private Initial size of fetch buffers. */
+static const u_int32_t FETCH_BUFFER_SIZE = 256;
+
+/**
+ * @private Allocates new fetch buffer.
+ */
+static DBT * new_buffer ()
+{
+    DBT * dbt = new DBT;
+    assert(dbt != NULL);
+    memset(dbt, 0, sizeof(DBT));
+
+    dbt->data  = malloc(FETCH_BUFFER_SIZE);
+    dbt->ulen  = FETCH_BUFFER_SIZE;
+    dbt->flags = DB_DBT_USERMEM;
+    assert(dbt->data != NULL);
+
+    return dbt;
+}
+
+/**
+ * @private Frees specified fetch buffer.
+ */
+static void delete_buffer (DBT * dbt)
+{
+    if (dbt != NULL)
+    {
+        free(dbt->data);
+        delete dbt;
+    }
+}
+
+/**
+ * @private Enlarges specified fetch buffer, if it's too small for the last requested item.
+ * Returns "true" if the buffer was enlarged.
+ */
+static bool grow_buffer (DBT * dbt)
+{
+    if (dbt == NULL || dbt->size <= dbt->ulen)
+    {
+        return false;
+    }
+
+    u_int32_t size = dbt->ulen * 2;
+    if (size < dbt->size) size = dbt->size;
+
+    free(dbt->data);
+    dbt->data = malloc(size);
+    dbt->ulen = size;
+    assert(dbt->data != NULL);
+
+    return true;
+}
+
+/** @private Cursor of joined recordset with number of its records. */
+typedef std::pair <db_recno_t, DBC *> join_cursor;
+
+/**
+ * @private Orders cursors of joined recordsets by number of their records.
+ */
+static bool less_records (const join_cursor & c1, const join_cursor & c2)
+{
+    return c1.first < c2.first;
+}
+
+/** @private Orders raw primary keys the way the table sorts them. */
+class key_less
+{
+public:
+
+    key_less (table * tbl)
+      : m_table(tbl)
+    { }
+
+    bool operator () (const string & k1, const string & k2) const
+    {
+        DBT d1, d2;
+
+        memset(&d1, 0, sizeof(DBT));
+        memset(&d2, 0, sizeof(DBT));
+
+        d1.data = (void *) k1.data();
+        d1.size = (u_int32_t) k1.size();
+        d2.data = (void *) k2.data();
+        d2.size = (u_int32_t) k2.size();
+
+        return m_table->compare_keys(&d1, &d2) < 0;
+    }
+
+protected:
+
+    table * m_table;
+};
+
+/**
+ * @private Ring buffer of raw rows of recordset, kept filled ahead of fetches by background thread, so reads of
+ * the next rows overlap with processing of the current one. The thread reads rows with the cursor of the recordset
+ * ("bdb::recordset::read_cursor"), and fetches take them from the ring. Strings of the ring are reused, so rows
+ * are copied without allocations once the ring is warmed up.
+ */
+class read_ahead
+{
+public:
+
+    read_ahead (recordset * source, size_t capacity)
+      : rs(source),
+        ring(capacity),
+        head(0),
+        count(0),
+        eof(false),
+        stop(false),
+        error(0),
+        thread(NULL)
+    {
+    }
+
+    ~read_ahead ()
+    {
+        halt();
+    }
+
+    recordset                         * rs;         /**< Recordset, which rows are read.                          */
+    pair <string, string>               current;    /**< Row, taken by the last fetch (referenced by its result).  */
+
+    boost::mutex                        mutex;      /**< Guards all the fields below.                             */
+    boost::condition_variable           cond;       /**< Signals of read and consumed rows.                       */
+    vector <pair <string, string> >     ring;       /**< Read rows (key, data), starting from "head".            */
+    size_t                              head;       /**< Position of the oldest row in the ring.                  */
+    size_t                              count;      /**< Number of read, but not fetched rows.                    */
+    bool                                eof;        /**< Whether the thread has read all rows.                    */
+    bool                                stop;       /**< Whether the thread should stop.                          */
+    int                                 error;      /**< Error of the thread ("0" if none).                       */
+    boost::thread                     * thread;     /**< Reading thread ("NULL" if not running).                  */
+
+    /**
+     * Takes the next row of the ring, starting the thread if it's not running.
+     *
+     * @throw bdb::exception Error of the thread.
+     */
+    bool take (DBT * key, DBT * data)
+    {
+        boost::mutex::scoped_lock lock(mutex);
+
+        if (thread == NULL && !eof)
+        {
+            stop   = false;
+            thread = new boost::thread(boost::bind(&read_ahead::run, this));
+        }
+
+        while (count == 0 && !eof)
+        {
+            cond.wait(lock);
+        }
+
+        if (count == 0)
+        {
+            if (error != 0)
+            {
+                LOG4CPLUS_WARN(logger, "[bdb::recordset::fetch] Read-ahead failed with error " << error);
+                throw exception(error);
+            }
+
+            return false;
+        }
+
+        current.first.swap(ring[head].first);
+        current.second.swap(ring[head].second);
+
+        head = (head + 1) % ring.size();
+        count--;
+
+        cond.notify_all();
+
+        memset(key,  0, sizeof(DBT));
+        memset(data, 0, sizeof(DBT));
+
+        key->data  = (void *) current.first.data();
+        key->size  = (u_int32_t) current.first.size();
+        data->data = (void *) current.second.data();
+        data->size = (u_int32_t) current.second.size();
+
+        return true;
+    }
+
+    /**
+     * Stops the thread, keeping (or discarding) rows, which are already read.
+     * Kept rows are fetched first, and the thread continues after them when it's restarted.
+     */
+    void halt (bool discard = false)
+    {
+        boost::thread * running = NULL;
+
+        {
+            boost::mutex::scoped_lock lock(mutex);
+
+            stop = true;
+            cond.notify_all();
+
+            running = thread;
+            thread  = NULL;
+        }
+
+        if (running != NULL)
+        {
+            running->join();
+            delete running;
+        }
+
+        if (discard)
+        {
+            head  = 0;
+            count = 0;
+            eof   = false;
+            error = 0;
+        }
+    }
+
+    /**
+     * Reads rows into the ring, until the end of the recordset, or until it's asked to stop. Body of reading thread.
+     */
+    void run ()
+    {
+        try
+        {
+            for (;;)
+            {
+                size_t tail;
+
+                {
+                    boost::mutex::scoped_lock lock(mutex);
+
+                    while (count == ring.size() && !stop)
+                    {
+                        cond.wait(lock);
+                    }
+
+                    if (stop) return;
+
+                    tail = (head + count) % ring.size();
+                }
+
+                // only the thread writes free slots of the ring
+                DBT k, d;
+                bool found = rs->read_cursor(false, &k, &d);
+
+                if (found)
+                {
+                    ring[tail].first.assign((const char *) k.data, k.size);
+                    ring[tail].second.assign((const char *) d.data, d.size);
+                }
+
+                boost::mutex::scoped_lock lock(mutex);
+
+                if (!found)
+                {
+                    eof = true;
+                    cond.notify_all();
+                    return;
+                }
+
+                count++;
+                cond.notify_all();
+            }
+        }
+        catch (exception & e)
+        {
+            boost::mutex::scoped_lock lock(mutex);
+
+            error = e.error();
+            eof   = true;
+            cond.notify_all();
+        }
+    }
+};
+
+/**
+ * @private Checks whether specified serialized key starts with specified prefix.
+ */
+static bool starts_with (const DBT * key, const DBT * prefix)
+{
+    return (key->size >= prefix->size && memcmp(key->data, prefix->data, prefix->size) == 0);
+}
+
+/** @private Number of bisection steps of a sampled position by "DB->key_range" (see "bdb::recordset::seek_sample"). */
+static const int SAMPLE_BISECTION_STEPS = 48;
+
+/** @private Maximum number of ranges of keys of a bounding box (see "bdb::geo_ranges"). */
+static const size_t GEO_MAX_RANGES = 32;
+
+/**
+ * @private Returns next pseudo-random fraction in range [0, 1) ("xorshift64*").
+ */
+static double random_fraction (uint64_t & state)    /**< [in/out] State of the generator (never zero). */
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+
+    return (double) ((state * 2685821657736338717ULL) >> 11) / 9007199254740992.0;
+}
+
+/**
+ * @private Random positions of sampling recordset (see "bdb::sample_options"), as fractions of ranks of records,
+ * and the current position. Keys, sorted by Berkeley DB itself, are found by bisection of their bytes by "DB->key_range".
+ * Keys, sorted by comparison callbacks, can't be bisected, so records are walked to their ranks, jumping over
+ * buckets of histogram of keys (see "bdb::table::analyze").
+ */
+class sample_state
+{
+public:
+
+    sample_state () : next(0), bytewise(false), common(0), lo(0), hi(0), records(0), rank(0), bucket(0), positioned(false) { }
+
+    vector <double>  targets;   /**< Fractions of ranks of sampled records, in ascending order.     */
+    size_t           next;      /**< Next sampled record.                                           */
+    bool             bytewise;  /**< Whether keys are sorted by their bytes.                        */
+    string           first;     /**< The first key (of bytewise sorted keys).                       */
+    size_t           common;    /**< Size of common prefix of the first and the last keys.          */
+    uint64_t         lo;        /**< 8 bytes of the first key after the common prefix.              */
+    uint64_t         hi;        /**< 8 bytes of the last key after the common prefix.               */
+    uint64_t         records;   /**< Number of records (of walked keys).                            */
+    vector <string>  bounds;    /**< Bounds of buckets of histogram of keys (of walked keys).       */
+    uint64_t         rank;      /**< Rank of the current record (of walked keys, approximate).      */
+    size_t           bucket;    /**< Bucket of the current record (of walked keys).                 */
+    bool             positioned;    /**< Whether the cursor is positioned by a sample.              */
+};
+
+/** @private Counters of profiled recordset (see "bdb::recordset::set_profiling"). */
+class profile_state
+{
+public:
+
+    profile_state () : examined(0), returned(0), calls(0), bytes(0), filter_time(0), pages(0), callback_time(0) { }
+
+    uint64_t    examined;       /**< Records read from the cursor (or read-ahead ring).                  */
+    uint64_t    returned;       /**< Records accepted and returned by fetches.                           */
+    uint64_t    calls;          /**< Calls of Berkeley DB cursors.                                       */
+    uint64_t    bytes;          /**< Bytes of keys and data, unserialized by fetches.                    */
+    uint64_t    filter_time;    /**< Time of filter callback, in nanoseconds.                            */
+    uint64_t    pages;          /**< Pages, read into the cache of the environment, when profiling started. */
+    uint64_t    callback_time;  /**< Time of profiled callbacks of the table, when profiling started.    */
+};
+
+/**
+ * @private Returns number of pages, read into the cache of the environment since it's opened.
+ */
+static uint64_t pages_read (DB_ENV * env)   /**< [in] Environment of the database. */
+{
+    DB_MPOOL_STAT * gsp = NULL;
+
+    if (env->memp_stat(env, &gsp, NULL, 0) != 0) return 0;
+
+    uint64_t pages = gsp->st_page_in;
+    bdb::free(gsp);
+
+    return pages;
+}
+
+/** @private Record of top-N recordset with raw value of its ordering field. */
+struct top_entry
+{
+    string      value;      /**< Serialized message with the field only (see "bdb::index_value").  */
+    string      record;     /**< Size of primary key, primary key and data of the record.          */
+    uint64_t    seq;        /**< Number of the record in order of reading.                         */
+};
+
+/**
+ * @private Orders records of top-N recordset by the field, so the first fetched record is the least one
+ * (the greatest one in descending order); records with equal values are fetched in order of reading.
+ */
+class top_less
+{
+public:
+
+    top_less (int field, int type, bool descending) : m_field(field), m_type(type), m_descending(descending) { }
+
+    bool operator () (const top_entry & e1, const top_entry & e2) const
+    {
+        DBT v1, v2;
+
+        memset(&v1, 0, sizeof(DBT));
+        memset(&v2, 0, sizeof(DBT));
+
+        v1.data = (void *) e1.value.data();
+        v1.size = (u_int32_t) e1.value.size();
+        v2.data = (void *) e2.value.data();
+        v2.size = (u_int32_t) e2.value.size();
+
+        int res = compare_field(&v1, &v2, m_field, m_type);
+
+        if (res != 0) return (m_descending ? res > 0 : res < 0);
+
+        return e1.seq < e2.seq;
+    }
+
+protected:
+
+    int     m_field;        /**< Field number.                          */
+    int     m_type;         /**< Field type (see @ref fieldtypes "types"). */
+    bool    m_descending;   /**< Whether the greatest values are the top. */
+};
+
+/**
+ * @private Top records of top-N recordset. While records are read, they are kept in bounded heap with the
+ * last of the top records on top, so a record, which doesn't beat it, is dropped without being copied.
+ */
+class top_state
+{
+public:
+
+    top_state (int f, int t, bool d) : field(f), type(t), descending(d), filled(false), next(0) { }
+
+    int                 field;      /**< Ordering field.                                        */
+    int                 type;       /**< Type of the field (see @ref fieldtypes "types").       */
+    bool                descending; /**< Whether records are ordered by descending values.      */
+    bool                filled;     /**< Whether all records are read, and the top is sorted.   */
+    vector <top_entry>  top;        /**< Heap of the top records, or the sorted top.            */
+    size_t              next;       /**< Next fetched record of the sorted top.                 */
+};
+
 //--------------------------------------------------------------------------------------------------
 //  Constructors/destructors.
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Default sampling options: ten samples, not stratified, random seed.
+ */
+sample_options::sample_options ()
+  : count(10),
+    strata(0),
+    seed(0)
+{
+    // do nothing
+}
+
 /**
  * Opens the recordset, which contains all records from specified table.
  *
  * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
  */
-recordset::recordset (table * tbl)      /**< [in] Table with source data. */
+recordset::recordset (table       * tbl,     /**< [in] Table with source data.                      */
+                      transaction * txn)     /**< [in] Transaction to use (current one, if "NULL"). */
   : m_cursor(NULL),
+    m_ccursor(NULL),
+    m_dcursor(NULL),
     m_key(NULL),
     m_type(BDB_RS_TABLE),
-    m_isset(false)
+    m_isset(false),
+    m_bulk(NULL),
+    m_bulkptr(NULL),
+    m_kbuf(NULL),
+    m_dbuf(NULL),
+    m_sbuf(NULL),
+    m_format(tbl->m_options.key_format),
+    m_table(tbl),
+    m_lower(NULL),
+    m_upper(NULL),
+    m_flags(0),
+    m_keyonly(false),
+    m_seek(BDB_SEEK_NONE),
+    m_keys(NULL),
+    m_next(0),
+    m_recno(0),
+    m_filter(NULL),
+    m_param(NULL),
+    m_conditions(NULL),
+    m_ahead(NULL),
+    m_sample(NULL),
+    m_limit(0),
+    m_offset(0),
+    m_passed(0),
+    m_top(NULL),
+    m_profile(NULL)
 {
     LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] ENTER = BDB_RS_TABLE");
 
-    int res = tbl->m_db->cursor(tbl->m_db, tbl->m_database->m_txns.top(), &m_cursor, DB_READ_COMMITTED);
+    tbl->check_open();
+
+    int res = tbl->m_database->open_cursor(tbl->m_db, txn, &m_cursor);
 
     if (res != 0)
     {
@@ -100,20 +601,55 @@ recordset::recordset (table * tbl)      /**< [in] Table with source data. */
  *
  * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
  */
-recordset::recordset (index * idx)      /**< [in] Index with source data. */
+recordset::recordset (index       * idx,     /**< [in] Index with source data.                      */
+                      transaction * txn)     /**< [in] Transaction to use (current one, if "NULL"). */
   : m_cursor(NULL),
+    m_ccursor(NULL),
+    m_dcursor(NULL),
     m_key(NULL),
     m_type(BDB_RS_DUPLICATES),
-    m_isset(false)
+    m_isset(false),
+    m_bulk(NULL),
+    m_bulkptr(NULL),
+    m_kbuf(NULL),
+    m_dbuf(NULL),
+    m_sbuf(NULL),
+    m_format(idx->m_pkformat),
+    m_table(idx),
+    m_lower(NULL),
+    m_upper(NULL),
+    m_flags(0),
+    m_keyonly(false),
+    m_seek(BDB_SEEK_NONE),
+    m_keys(NULL),
+    m_next(0),
+    m_recno(0),
+    m_filter(NULL),
+    m_param(NULL),
+    m_conditions(NULL),
+    m_ahead(NULL),
+    m_sample(NULL),
+    m_limit(0),
+    m_offset(0),
+    m_passed(0),
+    m_top(NULL),
+    m_profile(NULL)
 {
     LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] ENTER = BDB_RS_DUPLICATES");
 
-    int res = idx->m_db->cursor(idx->m_db, idx->m_database->m_txns.top(), &m_cursor, DB_READ_COMMITTED);
+    int res = idx->m_database->open_cursor(idx->m_db, txn, &m_cursor);
+
+    // projections of covering index are read by separate cursor
+    if (res == 0 && idx->m_cover != NULL)
+    {
+        res = idx->m_database->open_cursor(idx->m_cover, txn, &m_ccursor);
+    }
 
     if (res != 0)
     {
         LOG4CPLUS_WARN(logger, "[bdb::recordset::recordset] " << db_strerror(res));
-        if (m_cursor != NULL) m_cursor->close(m_cursor);
+        if (m_ccursor != NULL) m_ccursor->close(m_ccursor);
+        if (m_cursor  != NULL) m_cursor->close(m_cursor);
         throw exception(BDB_ERROR_UNKNOWN);
     }
 
@@ -121,208 +657,3145 @@ recordset::recordset (index * idx)      /**< [in] Index with source data. */
 }
 
 /**
- * Opens the recordset, which contains all records with particular key from specified index.
+ * Opens the recordset, which contains records of master table of specified full-text index
+ * (see "bdb::table::add_text_index"), which contain all words of the text ("BDB_JOIN_INTERSECT"),
+ * or any of them ("BDB_JOIN_UNION"). The text is split into words the same way as indexed fields,
+ * and records are fetched in order of the table (see "BDB_JOIN_INTERSECT"). "BDB_JOIN_KEYS" can be
+ * specified as well.
  *
  * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
  */
-recordset::recordset (index         * idx,      /**< [in] Index with source data. */
-                      const Message * key)      /**< [in] Required index key.     */
+recordset::recordset (index         * idx,      /**< [in] Full-text index.                             */
+                      const string  & text,     /**< [in] Words to search for.                         */
+                      int             flags,    /**< [in] Flags (see @ref joinflags "flags").          */
+                      transaction   * txn)      /**< [in] Transaction to use (current one, if "NULL"). */
   : m_cursor(NULL),
+    m_ccursor(NULL),
+    m_dcursor(NULL),
     m_key(NULL),
-    m_type(BDB_RS_UNIQUE),
-    m_isset(false)
+    m_type(BDB_RS_COMBINED),
+    m_isset(false),
+    m_bulk(NULL),
+    m_bulkptr(NULL),
+    m_kbuf(NULL),
+    m_dbuf(NULL),
+    m_sbuf(NULL),
+    m_format(idx->m_master->m_options.key_format),
+    m_table(idx->m_master),
+    m_lower(NULL),
+    m_upper(NULL),
+    m_flags(flags & BDB_JOIN_KEYS),
+    m_keyonly(false),
+    m_seek(BDB_SEEK_NONE),
+    m_keys(NULL),
+    m_next(0),
+    m_recno(0),
+    m_filter(NULL),
+    m_param(NULL),
+    m_conditions(NULL),
+    m_ahead(NULL),
+    m_sample(NULL),
+    m_limit(0),
+    m_offset(0),
+    m_passed(0),
+    m_top(NULL),
+    m_profile(NULL)
 {
-    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] ENTER = BDB_RS_UNIQUE");
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] ENTER = BDB_RS_COMBINED");
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::recordset] text = " << text);
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::recordset] flags = " << flags);
 
-    int res = idx->m_db->cursor(idx->m_db, idx->m_database->m_txns.top(), &m_cursor, DB_READ_COMMITTED);
+    vector <string> words;
+    split_words(text.data(), text.size(), &words);
 
-    if (res != 0)
+    // each word is looked up by its own recordset, and their primary keys are combined at once
+    joinlist list;
+    string   key;
+
+    try
     {
-        LOG4CPLUS_WARN(logger, "[bdb::recordset::recordset] " << db_strerror(res));
-        if (m_cursor != NULL) m_cursor->close(m_cursor);
-        throw exception(BDB_ERROR_UNKNOWN);
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            encode_word(words[i], &key);
+            list.push_back(new recordset(idx, key_ref(key.data(), key.size()), txn));
+        }
+
+        combine(list, ((flags & BDB_JOIN_UNION) != 0 ? BDB_JOIN_UNION : BDB_JOIN_INTERSECT));
+    }
+    catch (...)
+    {
+        for (size_t i = 0; i < list.size(); i++) delete list[i];
+        throw;
     }
 
-    m_key = new DBT;
-    assert(m_key != NULL);
-    serialize(key, m_key);
+    for (size_t i = 0; i < list.size(); i++) delete list[i];
 
     LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] EXIT");
 }
 
 /**
- * Opens the recordset, which is a natural join of all recordsets, provided in the specified list.
- * All provided recordsets must be gained from indexes, which belong to the same table.
+ * Opens the recordset, which contains records of master table of specified geospatial index
+ * (see "bdb::table::add_geo_index"), which locations are in the bounding box. The box is decomposed into
+ * a few ranges of Z-order keys, which are scanned by the index, and their primary keys are collected and
+ * sorted, so records are fetched in order of the table. Since the ranges cover a bit more than the box,
+ * the records are checked by exact conditions on their fields of latitude and longitude as well.
  *
  * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
  */
-recordset::recordset (table          * tbl,     /**< [in] Table with source data.     */
-                      const joinlist & list)    /**< [in] List of recordsets to join. */
+recordset::recordset (index         * idx,      /**< [in] Geospatial index.                            */
+                      const geo_box & box,      /**< [in] Bounding box of locations.                   */
+                      transaction   * txn)      /**< [in] Transaction to use (current one, if "NULL"). */
   : m_cursor(NULL),
+    m_ccursor(NULL),
+    m_dcursor(NULL),
     m_key(NULL),
-    m_type(BDB_RS_JOIN),
-    m_isset(true)
+    m_type(BDB_RS_COMBINED),
+    m_isset(false),
+    m_bulk(NULL),
+    m_bulkptr(NULL),
+    m_kbuf(NULL),
+    m_dbuf(NULL),
+    m_sbuf(NULL),
+    m_format(idx->m_master->m_options.key_format),
+    m_table(idx->m_master),
+    m_lower(NULL),
+    m_upper(NULL),
+    m_flags(0),
+    m_keyonly(false),
+    m_seek(BDB_SEEK_NONE),
+    m_keys(NULL),
+    m_next(0),
+    m_recno(0),
+    m_filter(NULL),
+    m_param(NULL),
+    m_conditions(NULL),
+    m_ahead(NULL),
+    m_sample(NULL),
+    m_limit(0),
+    m_offset(0),
+    m_passed(0),
+    m_top(NULL),
+    m_profile(NULL)
 {
-    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] ENTER = BDB_RS_JOIN");
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] ENTER = BDB_RS_COMBINED");
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::recordset] box = (" << box.min_lat << ", " << box.min_lon << ") - ("
+                                                                  << box.max_lat << ", " << box.max_lon << ")");
 
-    DBC ** curslist = NULL;
+    vector <pair <uint64_t, uint64_t> > ranges;
+    geo_ranges(box, GEO_MAX_RANGES, &ranges);
 
-    int count = (int) list.size();
-    curslist = (DBC **) malloc((count + 1) * sizeof(DBC));
-    assert(curslist != NULL);
-    curslist[count] = NULL;
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::recordset] ranges = " << ranges.size());
 
-    for (int i = 0; i < count; i++)
-    {
-        recordset * rs = list[i];
+    DBC * cursor = NULL;
 
-        if (rs->m_key == NULL)
-        {
-            LOG4CPLUS_WARN(logger, "[bdb::recordset::recordset] Source index is not unique.");
-            free((void *) curslist);
-            throw exception(BDB_ERROR_UNKNOWN);
-        }
+    int res = m_table->m_database->open_cursor(m_table->m_db, txn, &m_cursor);
 
-        DBT k, d;
+    if (res == 0) res = idx->m_plain->cursor(idx->m_plain, idx->m_database->get_transaction(txn), &cursor, idx->m_database->read_flags(txn));
 
-        memset(&k, 0, sizeof(DBT));
-        memset(&d, 0, sizeof(DBT));
+    m_keys = new vector <string>;
+    assert(m_keys != NULL);
 
-        if (rs->m_cursor->pget(rs->m_cursor, rs->m_key, &k, &d, DB_SET) == 0)
+    unsigned char raw[sizeof(uint64_t)];
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.data  = raw;
+    k.ulen  = sizeof(raw);
+    k.flags = DB_DBT_USERMEM;
+    d.flags = DB_DBT_REALLOC;
+
+    // primary keys of each range are read as data of plain handle of the index
+    for (size_t i = 0; res == 0 && i < ranges.size(); i++)
+    {
+        uint64_t low = ranges[i].first;
+
+        for (int j = sizeof(raw) - 1; j >= 0; j--)
         {
-            rs->m_isset = true;
+            raw[j] = (unsigned char) low;
+            low >>= 8;
         }
-        else
+
+        k.size = sizeof(raw);
+
+        for (res = cursor->get(cursor, &k, &d, DB_SET_RANGE); res == 0; res = cursor->get(cursor, &k, &d, DB_NEXT))
         {
-            m_isset = false;
+            uint64_t key = 0;
+            for (size_t j = 0; j < sizeof(raw); j++) key = (key << 8) | raw[j];
+
+            if (key > ranges[i].second) break;
+
+            // the cells of the box are checked by the key, the box itself - by conditions on fields
+            if (geo_contains(box, key)) m_keys->push_back(string((const char *) d.data, d.size));
         }
 
-        curslist[i] = rs->m_cursor;
+        if (res == DB_NOTFOUND) res = 0;
     }
 
-    int res = tbl->m_db->join(tbl->m_db, curslist, &m_cursor, 0);
+    free(d.data);
 
-    free((void *) curslist);
+    if (cursor != NULL)
+    {
+        cursor->close(cursor);
+    }
 
     if (res != 0)
     {
         LOG4CPLUS_WARN(logger, "[bdb::recordset::recordset] " << db_strerror(res));
+        delete m_keys;
+        if (m_cursor != NULL) m_cursor->close(m_cursor);
         throw exception(BDB_ERROR_UNKNOWN);
     }
 
-    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] EXIT");
-}
+    key_less less(m_table);
 
-/**
- * Closes the recordset.
- */
-recordset::~recordset () throw ()
-{
-    LOG4CPLUS_TRACE(logger, "[bdb::recordset::~recordset] ENTER");
+    std::sort(m_keys->begin(), m_keys->end(), less);
+    m_keys->erase(std::unique(m_keys->begin(), m_keys->end()), m_keys->end());
 
-    if (m_key != NULL)
-    {
-        release(m_key);
-        delete m_key;
-    }
+    // exact conditions are serialized straight, since fields of coordinates are fixed-size ones
+    m_conditions = new vector <filter_condition>;
+    assert(m_conditions != NULL);
 
-    if (m_cursor != NULL)
+    const double bounds[] = { box.min_lat, box.max_lat, box.min_lon, box.max_lon };
+
+    for (int i = 0; i < 4; i++)
     {
-        m_cursor->close(m_cursor);
+        filter_condition condition;
+
+        condition.field = idx->m_columns[i / 2];
+        condition.type  = idx->m_types[i / 2];
+        condition.op    = ((i % 2) == 0 ? BDB_FILTER_GE : BDB_FILTER_LE);
+
+        uint64_t bits = 0;
+        size_t   size;
+
+        if (condition.type == BDB_FIELD_FLOAT)
+        {
+            float    f = (float) bounds[i];
+            uint32_t b;
+
+            memcpy(&b, &f, sizeof(float));
+            bits = b;
+            size = sizeof(float);
+        }
+        else
+        {
+            memcpy(&bits, &bounds[i], sizeof(double));
+            size = sizeof(double);
+        }
+
+        for (uint64_t t = ((uint64_t) condition.field << 3) | (size == sizeof(double) ? 1 : 5); ; t >>= 7)
+        {
+            condition.value.push_back((char) ((t & 0x7F) | (t >= 0x80 ? 0x80 : 0)));
+            if (t < 0x80) break;
+        }
+
+        for (size_t j = 0; j < size; j++, bits >>= 8) condition.value.push_back((char) (bits & 0xFF));
+
+        m_conditions->push_back(condition);
     }
 
-    LOG4CPLUS_TRACE(logger, "[bdb::recordset::~recordset] EXIT");
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] EXIT = " << m_keys->size());
 }
 
-//--------------------------------------------------------------------------------------------------
-//  Public interface.
-//--------------------------------------------------------------------------------------------------
-
 /**
- * Fetches the next record from the recordset.
+ * Opens the recordset, which contains all records with particular key from specified index.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+recordset::recordset (index         * idx,      /**< [in] Index with source data.                      */
+                      key_ref         key,      /**< [in] Required index key.                          */
+                      transaction   * txn)      /**< [in] Transaction to use (current one, if "NULL"). */
+  : m_cursor(NULL),
+    m_ccursor(NULL),
+    m_dcursor(NULL),
+    m_key(NULL),
+    m_type(BDB_RS_UNIQUE),
+    m_isset(false),
+    m_bulk(NULL),
+    m_bulkptr(NULL),
+    m_kbuf(NULL),
+    m_dbuf(NULL),
+    m_sbuf(NULL),
+    m_format(idx->m_pkformat),
+    m_table(idx),
+    m_lower(NULL),
+    m_upper(NULL),
+    m_flags(0),
+    m_keyonly(false),
+    m_seek(BDB_SEEK_NONE),
+    m_keys(NULL),
+    m_next(0),
+    m_recno(0),
+    m_filter(NULL),
+    m_param(NULL),
+    m_conditions(NULL),
+    m_ahead(NULL),
+    m_sample(NULL),
+    m_limit(0),
+    m_offset(0),
+    m_passed(0),
+    m_top(NULL),
+    m_profile(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] ENTER = BDB_RS_UNIQUE");
+
+    // prepared (or raw) key is checked before the cursors are opened
+    DBT prepared;
+    if (key.m_message == NULL) static_cast<table *>(idx)->encode_key(key, &prepared);
+
+    int res = idx->m_database->open_cursor(idx->m_db, txn, &m_cursor);
+
+    // projections of covering index are read by separate cursor
+    if (res == 0 && idx->m_cover != NULL)
+    {
+        res = idx->m_database->open_cursor(idx->m_cover, txn, &m_ccursor);
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::recordset] " << db_strerror(res));
+        if (m_ccursor != NULL) m_ccursor->close(m_ccursor);
+        if (m_cursor  != NULL) m_cursor->close(m_cursor);
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    // the key is kept in the recordset itself, so short keys need no memory
+    BOOST_STATIC_ASSERT(sizeof(DBT) <= sizeof(m_keystore));
+
+    m_key = reinterpret_cast <DBT *> (m_keystore);
+    memset(m_key, 0, sizeof(DBT));
+
+    if (key.m_message == NULL)
+    {
+        // prepared (or raw) key is copied, so it can be changed while the recordset is open
+        copy_key(prepared.data, prepared.size);
+    }
+    else if (m_table->m_options.key_format == BDB_KEY_ORDERED)
+    {
+        DBT encoded;
+        serialize_key(reflected(key.m_message), &encoded);
+
+        copy_key(encoded.data, encoded.size);
+        release(&encoded);
+    }
+    else if ((size_t) key.m_message->ByteSize() <= sizeof(m_keybuf))
+    {
+        serialize(key.m_message, m_key, m_keybuf, sizeof(m_keybuf), false);
+    }
+    else
+    {
+        // long key is serialized into recycled buffer of the thread, if it fits
+        size_t size   = 0;
+        void * buffer = idx->m_database->take_buffer(&size);
+
+        serialize(key.m_message, m_key, buffer, size, false);
+
+        if (buffer != NULL && m_key->data != buffer) free(buffer);
+    }
+
+    m_table->sample_key(m_key);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] EXIT");
+}
+
+/**
+ * Opens the recordset, which is a natural join of all recordsets, provided in the specified list.
+ * All provided recordsets must be gained from indexes, which belong to the same table.
+ * Berkeley DB iterates the first recordset and probes the rest, so recordsets are ordered by number
+ * of their records ("DBcursor->count") unless "BDB_JOIN_NOSORT" is specified.
+ *
+ * If "BDB_JOIN_INTERSECT" or "BDB_JOIN_UNION" is specified, the recordset is an intersection (or union)
+ * of provided recordsets by primary keys instead. In this case provided recordsets can be of any kind
+ * (e.g. ranges of indexes), they are read at once (in regular mode), and records are fetched in order of the table.
+ *
+ * If "BDB_JOIN_KEYS" is specified, the recordset fetches primary keys only ("DB_JOIN_ITEM"), and records
+ * of the table are never read (fetched data are empty, so filters can't be used), e.g. to count or remove joined records.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+recordset::recordset (table          * tbl,     /**< [in] Table with source data.                */
+                      const joinlist & list,    /**< [in] List of recordsets to join.            */
+                      int              flags)   /**< [in] Flags (see @ref joinflags "flags").    */
+  : m_cursor(NULL),
+    m_ccursor(NULL),
+    m_dcursor(NULL),
+    m_key(NULL),
+    m_type(BDB_RS_JOIN),
+    m_isset(true),
+    m_bulk(NULL),
+    m_bulkptr(NULL),
+    m_kbuf(NULL),
+    m_dbuf(NULL),
+    m_sbuf(NULL),
+    m_format(tbl->m_options.key_format),
+    m_table(tbl),
+    m_lower(NULL),
+    m_upper(NULL),
+    m_flags(0),
+    m_keyonly(false),
+    m_seek(BDB_SEEK_NONE),
+    m_keys(NULL),
+    m_next(0),
+    m_recno(0),
+    m_filter(NULL),
+    m_param(NULL),
+    m_conditions(NULL),
+    m_ahead(NULL),
+    m_sample(NULL),
+    m_limit(0),
+    m_offset(0),
+    m_passed(0),
+    m_top(NULL),
+    m_profile(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] ENTER = BDB_RS_JOIN");
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::recordset] flags = " << flags);
+
+    m_flags = (flags & BDB_JOIN_KEYS);
+
+    if ((flags & (BDB_JOIN_INTERSECT | BDB_JOIN_UNION)) != 0)
+    {
+        combine(list, flags);
+        LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] EXIT");
+        return;
+    }
+
+    DBC ** curslist = NULL;
+
+    int count = (int) list.size();
+    curslist = (DBC **) malloc((count + 1) * sizeof(DBC));
+    assert(curslist != NULL);
+    curslist[count] = NULL;
+
+    vector <join_cursor> cursors;
+
+    for (int i = 0; i < count; i++)
+    {
+        recordset * rs = list[i];
+
+        if (rs->m_key == NULL)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::recordset::recordset] Source index is not unique.");
+            free((void *) curslist);
+            throw exception(BDB_ERROR_UNKNOWN);
+        }
+
+        DBT k, d;
+
+        memset(&k, 0, sizeof(DBT));
+        memset(&d, 0, sizeof(DBT));
+
+        db_recno_t records = 0;
+
+        if (rs->m_cursor->pget(rs->m_cursor, rs->m_key, &k, &d, DB_SET) == 0)
+        {
+            rs->m_isset = true;
+            rs->m_cursor->count(rs->m_cursor, &records, 0);
+        }
+        else
+        {
+            m_isset = false;
+        }
+
+        LOG4CPLUS_DEBUG(logger, "[bdb::recordset::recordset] records[" << i << "] = " << records);
+
+        cursors.push_back(join_cursor(records, rs->m_cursor));
+    }
+
+    if ((flags & BDB_JOIN_NOSORT) == 0)
+    {
+        std::stable_sort(cursors.begin(), cursors.end(), less_records);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        curslist[i] = cursors[i].second;
+
+        for (int j = 0; j < count; j++)
+        {
+            if (list[j]->m_cursor == cursors[i].second) m_order.push_back(list[j]->m_table->m_name);
+        }
+    }
+
+    // the cursors are already in required order
+    int res = tbl->m_db->join(tbl->m_db, curslist, &m_cursor, DB_JOIN_NOSORT);
+
+    free((void *) curslist);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::recordset] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] EXIT");
+}
+
+/**
+ * Opens the recordset, which contains all records from specified table with keys in specified range.
+ * Records are fetched in order of the table (or in reverse order, if "BDB_RANGE_REVERSE" is specified).
+ * The lower bound is inclusive, the upper one is inclusive unless "BDB_RANGE_EXCLUSIVE" is specified.
+ * If "BDB_RANGE_PREFIX" is specified, bounds are partial keys with leading fields only, and the range
+ * includes all keys starting with them (e.g. pass the same partial key as both bounds to get all its keys).
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+recordset::recordset (table         * tbl,      /**< [in] Table with source data.                      */
+                      const Message * lower,    /**< [in] Lower bound ("NULL" - from the first record). */
+                      const Message * upper,    /**< [in] Upper bound ("NULL" - up to the last record). */
+                      int             flags,    /**< [in] Flags (see @ref rangeflags "flags").          */
+                      transaction   * txn)      /**< [in] Transaction to use (current one, if "NULL"). */
+  : m_cursor(NULL),
+    m_ccursor(NULL),
+    m_dcursor(NULL),
+    m_key(NULL),
+    m_type(BDB_RS_RANGE),
+    m_isset(false),
+    m_bulk(NULL),
+    m_bulkptr(NULL),
+    m_kbuf(NULL),
+    m_dbuf(NULL),
+    m_sbuf(NULL),
+    m_format(tbl->m_options.key_format),
+    m_table(tbl),
+    m_lower(NULL),
+    m_upper(NULL),
+    m_flags(flags),
+    m_keyonly(false),
+    m_seek(BDB_SEEK_NONE),
+    m_keys(NULL),
+    m_next(0),
+    m_recno(0),
+    m_filter(NULL),
+    m_param(NULL),
+    m_conditions(NULL),
+    m_ahead(NULL),
+    m_sample(NULL),
+    m_limit(0),
+    m_offset(0),
+    m_passed(0),
+    m_top(NULL),
+    m_profile(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] ENTER = BDB_RS_RANGE");
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::recordset] flags = " << flags);
+
+    tbl->check_open();
+    tbl->check_ordered("recordset::recordset");
+
+    int res = tbl->m_database->open_cursor(tbl->m_db, txn, &m_cursor);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::recordset] " << db_strerror(res));
+        if (m_cursor != NULL) m_cursor->close(m_cursor);
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    set_bounds(lower, upper);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] EXIT");
+}
+
+/**
+ * Opens the recordset, which contains all records from specified index with index keys in specified range.
+ * Records are fetched in order of the index (or in reverse order, if "BDB_RANGE_REVERSE" is specified).
+ * The lower bound is inclusive, the upper one is inclusive unless "BDB_RANGE_EXCLUSIVE" is specified.
+ * If "BDB_RANGE_PREFIX" is specified, bounds are partial keys with leading fields only, and the range
+ * includes all keys starting with them (e.g. pass the same partial key as both bounds to get all its keys).
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+recordset::recordset (index         * idx,      /**< [in] Index with source data.                      */
+                      const Message * lower,    /**< [in] Lower bound ("NULL" - from the first record). */
+                      const Message * upper,    /**< [in] Upper bound ("NULL" - up to the last record). */
+                      int             flags,    /**< [in] Flags (see @ref rangeflags "flags").          */
+                      transaction   * txn)      /**< [in] Transaction to use (current one, if "NULL"). */
+  : m_cursor(NULL),
+    m_ccursor(NULL),
+    m_dcursor(NULL),
+    m_key(NULL),
+    m_type(BDB_RS_INDEX_RANGE),
+    m_isset(false),
+    m_bulk(NULL),
+    m_bulkptr(NULL),
+    m_kbuf(NULL),
+    m_dbuf(NULL),
+    m_sbuf(NULL),
+    m_format(idx->m_pkformat),
+    m_table(idx),
+    m_lower(NULL),
+    m_upper(NULL),
+    m_flags(flags),
+    m_keyonly(false),
+    m_seek(BDB_SEEK_NONE),
+    m_keys(NULL),
+    m_next(0),
+    m_recno(0),
+    m_filter(NULL),
+    m_param(NULL),
+    m_conditions(NULL),
+    m_ahead(NULL),
+    m_sample(NULL),
+    m_limit(0),
+    m_offset(0),
+    m_passed(0),
+    m_top(NULL),
+    m_profile(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] ENTER = BDB_RS_INDEX_RANGE");
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::recordset] flags = " << flags);
+
+    int res = idx->m_database->open_cursor(idx->m_db, txn, &m_cursor);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::recordset] " << db_strerror(res));
+        if (m_cursor != NULL) m_cursor->close(m_cursor);
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    set_bounds(lower, upper);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] EXIT");
+}
+
+/**
+ * Opens the recordset, which contains random sample of records from specified table (with replacement,
+ * so a record can be sampled more than once), fetched in order of the table. Each sample is found by
+ * a cursor search of its random position, so the cost doesn't depend on size of the table (see "bdb::sample_options").
+ * Keys, sorted by comparison callbacks, are walked to their positions within buckets of histogram of keys,
+ * so such tables should be analyzed first with enough buckets (see "bdb::table::analyze").
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+recordset::recordset (table                * tbl,      /**< [in] Table with source data.                      */
+                      const sample_options & options,  /**< [in] Options of sampling.                          */
+                      transaction          * txn)      /**< [in] Transaction to use (current one, if "NULL"). */
+  : m_cursor(NULL),
+    m_ccursor(NULL),
+    m_dcursor(NULL),
+    m_key(NULL),
+    m_type(BDB_RS_SAMPLE),
+    m_isset(false),
+    m_bulk(NULL),
+    m_bulkptr(NULL),
+    m_kbuf(NULL),
+    m_dbuf(NULL),
+    m_sbuf(NULL),
+    m_format(tbl->m_options.key_format),
+    m_table(tbl),
+    m_lower(NULL),
+    m_upper(NULL),
+    m_flags(0),
+    m_keyonly(false),
+    m_seek(BDB_SEEK_NONE),
+    m_keys(NULL),
+    m_next(0),
+    m_recno(0),
+    m_filter(NULL),
+    m_param(NULL),
+    m_conditions(NULL),
+    m_ahead(NULL),
+    m_sample(NULL),
+    m_limit(0),
+    m_offset(0),
+    m_passed(0),
+    m_top(NULL),
+    m_profile(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] ENTER = BDB_RS_SAMPLE");
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::recordset] count = "  << options.count);
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::recordset] strata = " << options.strata);
+
+    tbl->check_open();
+    tbl->check_ordered("recordset::recordset");
+
+    init_sample(options);
+
+    int res = tbl->m_database->open_cursor(tbl->m_db, txn, &m_cursor);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::recordset] " << db_strerror(res));
+        if (m_cursor != NULL) m_cursor->close(m_cursor);
+        delete m_sample;
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] EXIT");
+}
+
+/**
+ * Opens the recordset, which contains random sample of records from specified index (with replacement,
+ * so a record can be sampled more than once), fetched in order of the index. Each sample is found by
+ * a cursor search of its random position, so the cost doesn't depend on size of the index (see "bdb::sample_options").
+ * Indexes have no histograms of keys, so keys, sorted by comparison callbacks, are walked to their positions
+ * from the first one (one pass over keys of the index for all samples, without reading primary records).
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+recordset::recordset (index                * idx,      /**< [in] Index with source data.                      */
+                      const sample_options & options,  /**< [in] Options of sampling.                          */
+                      transaction          * txn)      /**< [in] Transaction to use (current one, if "NULL"). */
+  : m_cursor(NULL),
+    m_ccursor(NULL),
+    m_dcursor(NULL),
+    m_key(NULL),
+    m_type(BDB_RS_INDEX_SAMPLE),
+    m_isset(false),
+    m_bulk(NULL),
+    m_bulkptr(NULL),
+    m_kbuf(NULL),
+    m_dbuf(NULL),
+    m_sbuf(NULL),
+    m_format(idx->m_pkformat),
+    m_table(idx),
+    m_lower(NULL),
+    m_upper(NULL),
+    m_flags(0),
+    m_keyonly(false),
+    m_seek(BDB_SEEK_NONE),
+    m_keys(NULL),
+    m_next(0),
+    m_recno(0),
+    m_filter(NULL),
+    m_param(NULL),
+    m_conditions(NULL),
+    m_ahead(NULL),
+    m_sample(NULL),
+    m_limit(0),
+    m_offset(0),
+    m_passed(0),
+    m_top(NULL),
+    m_profile(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] ENTER = BDB_RS_INDEX_SAMPLE");
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::recordset] count = "  << options.count);
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::recordset] strata = " << options.strata);
+
+    init_sample(options);
+
+    int res = idx->m_database->open_cursor(idx->m_db, txn, &m_cursor);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::recordset] " << db_strerror(res));
+        if (m_cursor != NULL) m_cursor->close(m_cursor);
+        delete m_sample;
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::recordset] EXIT");
+}
+
+/**
+ * Closes the recordset.
+ */
+recordset::~recordset () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::~recordset] ENTER");
+
+    // reading thread uses the cursor and all the buffers
+    delete m_ahead;
+
+    // memory of long key is recycled by the next keyed recordset of the thread
+    if (m_key != NULL && m_key->data != m_keybuf)
+    {
+        if (!m_table->m_database->give_buffer(m_key)) release(m_key);
+    }
+
+    if (m_lower != NULL)
+    {
+        release(m_lower);
+        delete m_lower;
+    }
+
+    if (m_upper != NULL)
+    {
+        release(m_upper);
+        delete m_upper;
+    }
+
+    if (m_bulk != NULL)
+    {
+        free(m_bulk->data);
+        delete m_bulk;
+    }
+
+    delete m_keys;
+    delete m_conditions;
+    delete m_sample;
+    delete m_top;
+    delete m_profile;
+
+    delete_buffer(m_kbuf);
+    delete_buffer(m_dbuf);
+    delete_buffer(m_sbuf);
+
+    if (m_dcursor != NULL)
+    {
+        m_dcursor->close(m_dcursor);
+    }
+
+    if (m_ccursor != NULL)
+    {
+        m_table->m_database->close_cursor(m_ccursor);
+    }
+
+    // join cursors are never cached
+    if (m_cursor != NULL)
+    {
+        if (m_type == BDB_RS_JOIN) m_cursor->close(m_cursor);
+        else m_table->m_database->close_cursor(m_cursor);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::~recordset] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Fetches the next record from the recordset.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return true  - record is successfully fetched.
+ * @return false - no more records to fetch.
+ */
+bool recordset::fetch (MessageLite * key,       /**< [out] Key of fetched record.  */
+                       MessageLite * data)      /**< [out] Data of fetched record. */
+{
+    return fetch_record(key, data);
+}
+
+/**
+ * Fetches key of the next record from the recordset, skipping its data.
+ * Data pages are not read ("DB_DBT_PARTIAL" with zero length), and recordsets of indexes
+ * don't look up primary records at all, so it's much cheaper than "bdb::recordset::fetch".
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return true  - record is successfully fetched.
+ * @return false - no more records to fetch.
+ */
+bool recordset::fetch_key (MessageLite * key)   /**< [out] Key of fetched record. */
+{
+    return fetch_record(key, NULL);
+}
+
+/**
+ * Fetches the next record from the recordset as a view of its serialized data (see "bdb::record_view"),
+ * without unserializing the data. Fields of the record are decoded by the view on demand, so rows
+ * can be filtered by a few fields, and only accepted ones are parsed into messages.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return true  - record is successfully fetched.
+ * @return false - no more records to fetch.
+ */
+bool recordset::fetch_view (MessageLite * key,      /**< [out] Key of fetched record (or "NULL"). */
+                            record_view * view)     /**< [out] View of fetched data.              */
+{
+    return fetch_record(key, NULL, view);
+}
+
+/**
+ * Fetches the next record from the recordset with raw bytes of its primary key, as they are stored
+ * in the table (e.g. keys of "bdb::typed_table", decoded by "bdb::raw_key").
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return true  - record is successfully fetched.
+ * @return false - no more records to fetch.
+ */
+bool recordset::fetch_raw (string      * key,       /**< [out] Raw key of fetched record.            */
+                           MessageLite * data)      /**< [out] Data of fetched record (or "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::fetch_raw] ENTER");
+
+    latency_scope latency(BDB_LATENCY_FETCH);
+    slow_scope    slow(m_table->m_database, BDB_LATENCY_FETCH, m_table->m_name.c_str());
+
+    DBT k, d;
+
+    if (read_accepted(data == NULL, &k, &d))
+    {
+        slow.set_sizes(k.size, d.size);
+
+        key->assign((const char *) k.data, k.size);
+        if (data != NULL) m_table->unserialize_data(&d, data);
+
+        if (m_profile != NULL && data != NULL) m_profile->bytes += d.size;
+
+        LOG4CPLUS_TRACE(logger, "[bdb::recordset::fetch_raw] EXIT = true");
+
+        return true;
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::fetch_raw] EXIT = false");
+
+    return false;
+}
+
+/**
+ * Fetches the next record from the recordset ("data" is "NULL" to fetch the key only, and
+ * "key" is "NULL" to skip the record without unserializing it).
+ * Implements "bdb::recordset::fetch", "bdb::recordset::fetch_key" and "bdb::recordset::fetch_view".
+ */
+bool recordset::fetch_record (MessageLite * key,    /**< [out] Key of fetched record (or "NULL").  */
+                              MessageLite * data,   /**< [out] Data of fetched record (or "NULL"). */
+                              record_view * view)   /**< [out] View of fetched data (or "NULL").   */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::fetch] ENTER");
+
+    latency_scope latency(BDB_LATENCY_FETCH);
+    slow_scope    slow(m_table->m_database, BDB_LATENCY_FETCH, m_table->m_name.c_str());
+
+    DBT k, d;
+
+    if (read_accepted(data == NULL && view == NULL, &k, &d))
+    {
+        slow.set_sizes(k.size, d.size);
+
+        if (key  != NULL) decode_key(&k, key);
+        if (data != NULL) m_table->unserialize_data(&d, data);
+        if (view != NULL) view->set(&d);
+
+        if (m_profile != NULL) m_profile->bytes += (key != NULL ? k.size : 0) + (data != NULL ? d.size : 0);
+
+        LOG4CPLUS_TRACE(logger, "[bdb::recordset::fetch] EXIT = true");
+
+        return true;
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::fetch] EXIT = false");
+
+    return false;
+}
+
+/**
+ * Reads the next record of the recordset (or takes it from read-ahead ring), without decoding it.
+ * Implements "bdb::recordset::fetch_record".
+ *
+ * @return true  - record is successfully read.
+ * @return false - no more records to read.
+ */
+bool recordset::read_record (bool  keyonly,     /**< [in]  Whether data should be skipped. */
+                             DBT * key,         /**< [out] Key of read record.             */
+                             DBT * data)        /**< [out] Data of read record.            */
+{
+    bool res = (m_ahead != NULL ? m_ahead->take(key, data) : read_cursor(keyonly, key, data));
+
+    if (res) remember(key);
+    if (res && m_profile != NULL) m_profile->examined++;
+
+    return res;
+}
+
+/**
+ * Reads the next record of the recordset into fetch buffers (or takes it from bulk buffer),
+ * without decoding it. Implements "bdb::recordset::read_record".
+ *
+ * @return true  - record is successfully read.
+ * @return false - no more records to read.
+ */
+bool recordset::read_cursor (bool  keyonly,     /**< [in]  Whether data should be skipped. */
+                             DBT * key,         /**< [out] Key of read record.             */
+                             DBT * data)        /**< [out] Data of read record.            */
+{
+    latency_scope berkeley(BDB_LATENCY_BERKELEY);
+
+    int res = DB_NOTFOUND;
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::fetch] type = " << m_type);
+
+    if (m_seek != BDB_SEEK_NONE)
+    {
+        // the record is already read by seek (or the recordset is past the last record)
+        res = (m_seek == BDB_SEEK_FOUND ? 0 : DB_NOTFOUND);
+        if (m_seek == BDB_SEEK_FOUND) m_seek = BDB_SEEK_NONE;
+    }
+    else if (m_type == BDB_RS_TABLE && m_bulk != NULL)
+    {
+        return read_bulk(key, data);
+    }
+    else if (m_type == BDB_RS_UNIQUE && m_bulk != NULL)
+    {
+        return read_dups(keyonly, key, data);
+    }
+    else
+    {
+        // keys-only joins never read records of the table
+        if ((m_type == BDB_RS_JOIN || m_type == BDB_RS_COMBINED) && (m_flags & BDB_JOIN_KEYS) != 0) keyonly = true;
+
+        prepare(keyonly);
+
+        if (m_type == BDB_RS_RANGE || m_type == BDB_RS_INDEX_RANGE)
+        {
+            res = fetch_range();
+        }
+        else if (m_type == BDB_RS_COMBINED)
+        {
+            res = fetch_combined();
+        }
+        else if (m_type == BDB_RS_SAMPLE || m_type == BDB_RS_INDEX_SAMPLE)
+        {
+            res = fetch_sample();
+        }
+        else do
+        {
+            if (m_profile != NULL) m_profile->calls++;
+
+            switch (m_type)
+            {
+                case BDB_RS_TABLE:
+                    res = m_cursor->get(m_cursor, m_kbuf, m_dbuf, (!m_isset ? DB_FIRST : DB_NEXT));
+                    break;
+
+                // data of secondary cursor is a primary key, so "get" doesn't look up primary record
+                case BDB_RS_DUPLICATES:
+                    res = (m_keyonly
+                           ? m_cursor->get (m_cursor, m_sbuf, m_kbuf,         (!m_isset ? DB_FIRST : DB_NEXT))
+                           : m_cursor->pget(m_cursor, m_sbuf, m_kbuf, m_dbuf, (!m_isset ? DB_FIRST : DB_NEXT)));
+                    break;
+
+                case BDB_RS_UNIQUE:
+                    res = (m_keyonly
+                           ? m_cursor->get (m_cursor, m_key, m_kbuf,         (!m_isset ? DB_SET : DB_NEXT_DUP))
+                           : m_cursor->pget(m_cursor, m_key, m_kbuf, m_dbuf, (!m_isset ? DB_SET : DB_NEXT_DUP)));
+                    break;
+
+                case BDB_RS_JOIN:
+                    if (m_isset) res = m_cursor->get(m_cursor, m_kbuf, m_dbuf, (m_keyonly ? DB_JOIN_ITEM : 0));
+                    break;
+
+                default:
+                    throw exception(BDB_ERROR_UNKNOWN);
+            }
+        }
+        // entries of deferred index, which primary records are already removed, are skipped
+        while ((res == DB_BUFFER_SMALL && (grow_buffer(m_kbuf) | grow_buffer(m_dbuf) | grow_buffer(m_sbuf))) ||
+               (res == DB_SECONDARY_BAD && (m_isset = true)));
+    }
+
+    if (res == 0)
+    {
+        m_isset = true;
+
+        *key  = *m_kbuf;
+        *data = *m_dbuf;
+
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Reads the next record of the recordset with its data, accepted by filters of the recordset,
+ * without decoding it (see "bdb::recordset::read_record").
+ *
+ * @return true  - record is successfully read.
+ * @return false - no more records to read.
+ */
+bool recordset::read_next (DBT * key,   /**< [out] Key of read record.  */
+                           DBT * data)  /**< [out] Data of read record. */
+{
+    return read_accepted(false, key, data);
+}
+
+/**
+ * Reads the next record, accepted by filters of the recordset, within its limit (see "bdb::recordset::set_limit"),
+ * or takes the next record of the top (see "bdb::recordset::set_top"), without decoding it.
+ * Implements "bdb::recordset::fetch_record", "bdb::recordset::fetch_raw" and "bdb::recordset::read_next".
+ *
+ * @return true  - record is successfully read.
+ * @return false - no more records to read.
+ */
+bool recordset::read_accepted (bool  keyonly,   /**< [in]  Whether data are not needed. */
+                               DBT * key,       /**< [out] Key of read record.          */
+                               DBT * data)      /**< [out] Data of read record.         */
+{
+    if (m_top != NULL) return read_top(key, data);
+
+    // the cursor is not moved past the limit
+    if (m_limit != 0 && m_passed >= m_offset && m_passed - m_offset >= m_limit) return false;
+
+    // filters need data of each record, even when only its key is fetched
+    bool filtered = is_filtered();
+
+    while (read_record(keyonly && !filtered, key, data))
+    {
+        if (filtered && !accept(data)) continue;
+
+        if (m_passed++ < m_offset) continue;
+
+        if (m_profile != NULL) m_profile->returned++;
+
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Takes the next record of the top of top-N recordset. The first call reads all accepted records,
+ * keeping the top ones only (limit and offset of the recordset, or all records, if there is no limit).
+ *
+ * @return true  - record is successfully taken.
+ * @return false - no more records in the top.
+ */
+bool recordset::read_top (DBT * key,    /**< [out] Key of the record.  */
+                          DBT * data)   /**< [out] Data of the record. */
+{
+    vector <top_entry> & top = m_top->top;
+
+    if (!m_top->filled)
+    {
+        top_less less(m_top->field, m_top->type, m_top->descending);
+
+        bool     filtered = is_filtered();
+        size_t   bound    = (m_limit != 0 ? (size_t) m_offset + m_limit : 0);
+        uint64_t seq      = 0;
+
+        top.clear();
+
+        DBT k, d;
+
+        while (read_record(false, &k, &d))
+        {
+            if (filtered && !accept(&d)) continue;
+
+            top_entry entry;
+            entry.seq = seq++;
+
+            field_value value;
+            extract_field(&d, m_top->field, &value);
+
+            // missing field is kept as empty message, which is less than any value
+            DBT v;
+
+            if (index_value(&value, m_top->field, &v) == 0)
+            {
+                entry.value.assign((const char *) v.data, v.size);
+                release(&v);
+            }
+
+            bool full = (bound != 0 && top.size() >= bound);
+
+            if (full && !less(entry, top.front())) continue;
+
+            u_int32_t ksize = k.size;
+
+            entry.record.assign((const char *) &ksize, sizeof(ksize));
+            entry.record.append((const char *) k.data, k.size);
+            entry.record.append((const char *) d.data, d.size);
+
+            if (full)
+            {
+                std::pop_heap(top.begin(), top.end(), less);
+                top.back().value.swap(entry.value);
+                top.back().record.swap(entry.record);
+                top.back().seq = entry.seq;
+            }
+            else
+            {
+                top.push_back(top_entry());
+                top.back().value.swap(entry.value);
+                top.back().record.swap(entry.record);
+                top.back().seq = entry.seq;
+            }
+
+            std::push_heap(top.begin(), top.end(), less);
+        }
+
+        std::sort_heap(top.begin(), top.end(), less);
+
+        m_top->filled = true;
+        m_top->next   = m_offset;
+
+        LOG4CPLUS_DEBUG(logger, "[bdb::recordset::fetch] read = " << seq << ", top = " << top.size());
+    }
+
+    if (m_top->next >= top.size()) return false;
+
+    if (m_profile != NULL) m_profile->returned++;
+
+    const string & record = top[m_top->next++].record;
+
+    u_int32_t ksize;
+    memcpy(&ksize, record.data(), sizeof(ksize));
+
+    memset(key,  0, sizeof(DBT));
+    memset(data, 0, sizeof(DBT));
+
+    key->data  = (void *) (record.data() + sizeof(ksize));
+    key->size  = ksize;
+    data->data = (void *) (record.data() + sizeof(ksize) + ksize);
+    data->size = (u_int32_t) (record.size() - sizeof(ksize) - ksize);
+
+    return true;
+}
+
+/**
+ * Checks whether records of the recordset are read in order of their primary keys
+ * (recordsets of whole tables and their ranges).
+ */
+bool recordset::is_ordered () const
+{
+    return (m_type == BDB_RS_TABLE || m_type == BDB_RS_RANGE);
+}
+
+/**
+ * Fetches the previous record from the recordset.
+ * When the recordset is not fetched yet (or is positioned by "bdb::recordset::seek_last"),
+ * fetches the last record, so the recordset can be iterated in reverse order from its end.
+ * Can be used on recordsets of whole tables and indexes only, not in bulk mode.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return true  - record is successfully fetched.
+ * @return false - no more records to fetch.
+ */
+bool recordset::fetch_prev (Message * key,      /**< [out] Key of fetched record.  */
+                            Message * data)     /**< [out] Data of fetched record. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::fetch_prev] ENTER");
+
+    check_seekable("fetch_prev");
+
+    // the cursor is ahead of fetched records
+    if (m_ahead != NULL)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::fetch_prev] Backward fetches cannot be used with read-ahead.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    bool filtered = is_filtered();
+    int  res;
+
+    do
+    {
+        prepare(data == NULL && !filtered);
+
+        res = move((!m_isset || m_seek == BDB_SEEK_END) ? DB_LAST : DB_PREV, NULL);
+
+        m_seek = BDB_SEEK_NONE;
+        if (res == 0) m_isset = true;
+    }
+    while (res == 0 && filtered && !accept(m_dbuf));
+
+    if (res == 0)
+    {
+        decode_key(m_kbuf, key);
+        if (data != NULL) m_table->unserialize_data(m_dbuf, data);
+
+        LOG4CPLUS_TRACE(logger, "[bdb::recordset::fetch_prev] EXIT = true");
+
+        return true;
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::fetch_prev] EXIT = false");
+
+    return false;
+}
+
+/**
+ * Fetches primary key and projection of the next record from the recordset of covering index
+ * (see "bdb::table::add_index"), reading the index only. Projection is a message of the same type as
+ * the data, which contains projected fields only. Can be used on recordsets of whole covering indexes,
+ * and of particular keys in them. Projections are iterated by their own cursor, so they shouldn't be
+ * fetched from the same recordset together with records, unless the recordset is rewound.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return true  - record is successfully fetched.
+ * @return false - no more records to fetch.
+ */
+bool recordset::fetch_projection (Message * key,            /**< [out] Key of fetched record.        */
+                                  Message * projection)     /**< [out] Projection of fetched record. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::fetch_projection] ENTER");
+
+    if (m_ccursor == NULL)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::fetch_projection] Source index is not covering.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    // projections are read into the same fetch buffers
+    halt_read_ahead(false);
+
+    prepare(false);
+
+    int res;
+
+    do
+    {
+        if (m_profile != NULL) m_profile->calls++;
+
+        if (m_type == BDB_RS_UNIQUE)
+        {
+            res = m_ccursor->get(m_ccursor, m_key, m_dbuf, (!m_isset ? DB_SET : DB_NEXT_DUP));
+        }
+        else
+        {
+            res = m_ccursor->get(m_ccursor, m_sbuf, m_dbuf, (!m_isset ? DB_FIRST : DB_NEXT));
+        }
+    }
+    while (res == DB_BUFFER_SMALL && (grow_buffer(m_dbuf) | grow_buffer(m_sbuf)));
+
+    if (res == 0 && m_dbuf->size >= sizeof(u_int32_t))
+    {
+        m_isset = true;
+
+        // entry is [size of primary key][primary key][projection]
+        const uint8_t * ptr = (const uint8_t *) m_dbuf->data;
+
+        DBT k, p;
+        memset(&k, 0, sizeof(DBT));
+        memset(&p, 0, sizeof(DBT));
+
+        memcpy(&k.size, ptr, sizeof(u_int32_t));
+
+        k.data = (void *) (ptr + sizeof(u_int32_t));
+        p.data = (void *) (ptr + sizeof(u_int32_t) + k.size);
+        p.size = m_dbuf->size - sizeof(u_int32_t) - k.size;
+
+        // primary key is in format of master table
+        static_cast <index *> (m_table)->m_master->decode_key(&k, key);
+
+        // projection lacks the rest of (maybe required) fields
+        projection->ParsePartialFromArray(p.data, (int) p.size);
+
+        LOG4CPLUS_TRACE(logger, "[bdb::recordset::fetch_projection] EXIT = true");
+
+        return true;
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::fetch_projection] EXIT = false");
+
+    return false;
+}
+
+/**
+ * Positions the recordset at the first record with key equal or greater than specified one ("DB_SET_RANGE"),
+ * so next "bdb::recordset::fetch" returns this record, and next "bdb::recordset::fetch_prev" returns previous one.
+ * Keys of index recordsets are keys of the index.
+ * Can be used on recordsets of whole tables and indexes only, not in bulk mode.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return true  - the record is found.
+ * @return false - all keys are less than specified one (recordset is positioned past the last record).
+ */
+bool recordset::seek (key_ref key)  /**< [in] Key to seek. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::seek] ENTER");
+
+    check_seekable("seek");
+    m_table->check_ordered("recordset::seek");
+    halt_read_ahead(true);
+    prepare(false);
+
+    DBT k;
+
+    m_table->encode_key(key, &k);
+    m_table->sample_key(&k);
+    int res = move(DB_SET_RANGE, &k);
+    release(&k);
+
+    m_isset = true;
+    m_seek  = (res == 0 ? BDB_SEEK_FOUND : BDB_SEEK_END);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::seek] EXIT = " << (res == 0));
+
+    return (res == 0);
+}
+
+/**
+ * Positions the recordset past the last record, so next "bdb::recordset::fetch_prev" returns the last record ("DB_LAST").
+ * Can be used on recordsets of whole tables and indexes only, not in bulk mode.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void recordset::seek_last ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::seek_last] ENTER");
+
+    check_seekable("seek_last");
+    halt_read_ahead(true);
+
+    m_isset = true;
+    m_seek  = BDB_SEEK_END;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::seek_last] EXIT");
+}
+
+/**
+ * Returns opaque position token of the last record, fetched by forward fetches, so next page of records
+ * after it can be read by another recordset of the same table (or index), and of the same range
+ * (see "bdb::recordset::resume"). The token is the serialized primary key of the record, and the index key
+ * as well for recordsets of indexes (as position among duplicates of the key). Index recordsets in read-ahead
+ * mode have no tokens.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - index recordset in read-ahead mode.
+ *
+ * @return true  - the token is returned.
+ * @return false - no records have been fetched yet.
+ */
+bool recordset::position (string * token)   /**< [out] Position token. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::position] ENTER");
+
+    if (!m_last.empty() && m_last[0] == BDB_TOKEN_NONE)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::position] Index recordsets in read-ahead mode have no positions.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    *token = m_last;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::position] EXIT = " << !m_last.empty());
+
+    return !m_last.empty();
+}
+
+/**
+ * Positions the recordset right after the record of specified token (see "bdb::recordset::position"),
+ * so next fetch returns the next record in order of the recordset, even if the record of the token
+ * has been removed since then. Every page of a paginated scan is read at the same cost, by a single
+ * cursor search ("DB_SET_RANGE" by the primary key, or "DB_GET_BOTH_RANGE" by keys of index record).
+ * Can be used on recordsets of whole tables and indexes, of their ranges, and of keys of indexes,
+ * not in bulk mode. Tables must be Btree ones.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - invalid token, the recordset doesn't support it, or unknown error.
+ */
+void recordset::resume (const string & token)   /**< [in] Position token. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::resume] ENTER");
+
+    bool ranged = (m_type == BDB_RS_RANGE || m_type == BDB_RS_INDEX_RANGE);
+
+    if ((m_type != BDB_RS_TABLE && m_type != BDB_RS_DUPLICATES && m_type != BDB_RS_UNIQUE && !ranged) || m_bulk != NULL)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::resume] Only tables and indexes, their ranges and keys can be resumed, not in bulk mode.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    m_table->check_ordered("recordset::resume");
+
+    // kind, size of primary key, primary key, and then index key
+    bool secondary = is_secondary();
+
+    uint32_t size = 0;
+
+    if (token.size() >= 5)
+    {
+        for (int i = 0; i < 4; i++) size |= (uint32_t) (unsigned char) token[1 + i] << (i * 8);
+    }
+
+    if (token.size() < 5 || size > token.size() - 5 || token[0] != (secondary ? BDB_TOKEN_INDEX : BDB_TOKEN_TABLE))
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::resume] Invalid position token.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    DBT pkey, skey;
+
+    memset(&pkey, 0, sizeof(DBT));
+    memset(&skey, 0, sizeof(DBT));
+
+    pkey.data = (void *) (token.data() + 5);
+    pkey.size = size;
+    skey.data = (void *) (token.data() + 5 + size);
+    skey.size = (u_int32_t) (token.size() - 5 - size);
+
+    halt_read_ahead(true);
+    prepare(false);
+
+    bool reverse = ranged && (m_flags & BDB_RANGE_REVERSE) != 0;
+
+    int res = locate(&pkey, &skey);
+
+    // the found record is the one of the token, if both its keys are the same
+    bool exact = (res == 0 &&
+                  m_kbuf->size == pkey.size && memcmp(m_kbuf->data, pkey.data, pkey.size) == 0 &&
+                  (m_type == BDB_RS_UNIQUE || !secondary ||
+                   (m_sbuf->size == skey.size && memcmp(m_sbuf->data, skey.data, skey.size) == 0)));
+
+    m_seek = BDB_SEEK_NONE;
+
+    if (res == 0 && (exact || reverse))
+    {
+        // next fetch steps over the record of the token (or back from the record after it)
+        m_isset = true;
+    }
+    else if (res == 0 && !ranged)
+    {
+        // the record after the token is returned by next fetch
+        m_isset = true;
+        m_seek  = BDB_SEEK_FOUND;
+    }
+    else if (res == 0)
+    {
+        // the record after the token is read again by next fetch, so it's checked against the range
+        res = move(DB_PREV, NULL);
+        m_isset = (res == 0);
+
+        // no records before the token, so the range is read from its beginning
+        if (res == DB_NOTFOUND) res = 0;
+    }
+    else if (res == DB_NOTFOUND)
+    {
+        // all records are before the token, which is the end of the recordset, or its beginning in reverse order
+        m_isset = !reverse;
+        m_seek  = (reverse ? BDB_SEEK_NONE : BDB_SEEK_END);
+        res     = 0;
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::resume] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::resume] EXIT");
+}
+
+/**
+ * Counts records of the recordset, without unserializing them, and rewinds the recordset.
+ * Joins cannot be rewound, so the rest of their records is counted (and consumed) instead.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+unsigned int recordset::count ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::count] ENTER");
+
+    if (m_type != BDB_RS_JOIN) rewind();
+
+    unsigned int count = 0;
+
+    if (m_type == BDB_RS_UNIQUE && !is_filtered() && m_limit == 0 && m_offset == 0 && m_top == NULL)
+    {
+        // the whole set of duplicates is counted by Berkeley DB itself
+        if (fetch_record(NULL, NULL))
+        {
+            db_recno_t n = 0;
+            int res = m_cursor->count(m_cursor, &n, 0);
+
+            if (res != 0)
+            {
+                LOG4CPLUS_WARN(logger, "[bdb::recordset::count] " << db_strerror(res));
+                throw exception(BDB_ERROR_UNKNOWN);
+            }
+
+            count = n;
+        }
+    }
+    else
+    {
+        while (fetch_record(NULL, NULL))
+        {
+            count++;
+        }
+    }
+
+    if (m_type != BDB_RS_JOIN) rewind();
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::count] EXIT = " << count);
+
+    return count;
+}
+
+/**
+ * Rewinds cursor of the recordset to the first record.
+ * Cannot be used on joins (always throws an exception there).
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - invalid recordset.
+ */
+void recordset::rewind ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::rewind] ENTER");
+
+    if (m_type == BDB_RS_JOIN)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::rewind] Rewind cannot be used on joins.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    halt_read_ahead(true);
+
+    m_isset   = false;
+    m_bulkptr = NULL;
+    m_seek    = BDB_SEEK_NONE;
+    m_passed  = 0;
+
+    if (m_top != NULL) m_top->filled = false;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::rewind] EXIT");
+}
+
+/**
+ * Switches the recordset to bulk mode, or back to regular mode if "size" is zero.
+ * In bulk mode the records are read from the table into a buffer of specified size ("DB_MULTIPLE_KEY"),
+ * and then are fetched from the buffer locally, so per-record overhead is much lower for sequential scans.
+ * The buffer is rounded up to a multiple of 1 KB, and is enlarged when a single record doesn't fit into it.
+ *
+ * Berkeley DB doesn't support bulk reads of secondary indexes together with primary keys ("DBcursor->pget"),
+ * so recordsets of all records with particular key of an index read primary keys of the duplicates in bulk
+ * through plain handle of the index ("DB_MULTIPLE"), and look up primary records one by one (keys only
+ * are fetched without any lookups). Other recordsets ignore bulk mode.
+ */
+void recordset::set_bulk (unsigned int size)    /**< [in] Size of bulk buffer, in bytes ("0" - disable bulk mode). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::set_bulk] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::set_bulk] size = " << size);
+
+    halt_read_ahead(false);
+
+    if (m_bulk != NULL)
+    {
+        free(m_bulk->data);
+        delete m_bulk;
+        m_bulk = NULL;
+    }
+
+    // the rest of current buffer is lost, so the cursor starts over from the last fetched record
+    m_bulkptr = NULL;
+
+    // bulk cursor of duplicates is reopened (and positioned) on the next fetch in bulk mode
+    if (m_dcursor != NULL)
+    {
+        m_dcursor->close(m_dcursor);
+        m_dcursor = NULL;
+    }
+
+    if (size != 0)
+    {
+        size = (size + BULK_ALIGNMENT - 1) / BULK_ALIGNMENT * BULK_ALIGNMENT;
+
+        m_bulk = new DBT;
+        assert(m_bulk != NULL);
+        memset(m_bulk, 0, sizeof(DBT));
+
+        m_bulk->data  = malloc(size);
+        m_bulk->ulen  = size;
+        m_bulk->flags = DB_DBT_USERMEM;
+        assert(m_bulk->data != NULL);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::set_bulk] EXIT");
+}
+
+/**
+ * Switches the recordset to read-ahead mode, or back to regular mode if "rows" is zero.
+ * In read-ahead mode a background thread keeps up to specified number of next rows read (as raw bytes)
+ * into a ring buffer, while the application processes the current one, so disk reads of scans of tables,
+ * larger than the cache, overlap with unserializing and filtering of records. The thread starts on first fetch.
+ *
+ * Rows are always read with their data (key-only fetches don't save reads), and filters are evaluated by fetches.
+ * Rewinds and seeks discard read rows; backward fetches cannot be used. The recordset must not be used
+ * by several threads, and its transaction must not be committed while the recordset is open.
+ */
+void recordset::set_read_ahead (unsigned int rows)  /**< [in] Number of rows to read ahead ("0" - disable read-ahead). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::set_read_ahead] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::set_read_ahead] rows = " << rows);
+
+    read_ahead * ahead = NULL;
+
+    if (rows != 0)
+    {
+        ahead = new read_ahead(this, rows);
+        assert(ahead != NULL);
+    }
+
+    // rows, which are already read, are fetched first
+    if (m_ahead != NULL)
+    {
+        m_ahead->halt();
+
+        if (ahead != NULL)
+        {
+            for (size_t i = 0; i < m_ahead->count && i < rows; i++)
+            {
+                pair <string, string> & row = m_ahead->ring[(m_ahead->head + i) % m_ahead->ring.size()];
+
+                ahead->ring[i].first.swap(row.first);
+                ahead->ring[i].second.swap(row.second);
+            }
+
+            ahead->count = (m_ahead->count < rows ? m_ahead->count : rows);
+            ahead->eof   = (m_ahead->eof && m_ahead->count <= rows);
+            ahead->error = m_ahead->error;
+        }
+
+        delete m_ahead;
+    }
+
+    m_ahead = ahead;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::set_read_ahead] EXIT");
+}
+
+/**
+ * Switches the recordset to scan-resistant mode, or back to regular mode. In scan-resistant mode pages,
+ * read by the recordset, get the lowest priority in the cache, so large scans (e.g. of reports) evict
+ * their own pages first, instead of the working set of other tables and indexes.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void recordset::set_scan_resistant (bool resistant)     /**< [in] Whether the recordset is scan-resistant. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::set_scan_resistant] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::set_scan_resistant] resistant = " << resistant);
+
+    DB_CACHE_PRIORITY priority = (resistant ? DB_PRIORITY_VERY_LOW : DB_PRIORITY_UNCHANGED);
+
+    int res = 0;
+
+    if (m_cursor  != NULL && res == 0) res = m_cursor->set_priority(m_cursor, priority);
+    if (m_ccursor != NULL && res == 0) res = m_ccursor->set_priority(m_ccursor, priority);
+    if (m_dcursor != NULL && res == 0) res = m_dcursor->set_priority(m_dcursor, priority);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::set_scan_resistant] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::set_scan_resistant] EXIT");
+}
+
+/**
+ * Sets function to filter records of the recordset, or removes it if "fn" is "NULL".
+ * The function is evaluated inside of fetches on serialized data of each record (see "bdb::record_view"),
+ * and records it rejects are skipped without being unserialized. Seeks position the recordset regardless of filters.
+ */
+void recordset::set_filter (filter_callback fn,         /**< [in] Filter function ("NULL" - no function). */
+                            void          * param)      /**< [in] Parameter of the function.              */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::set_filter] ENTER");
+
+    m_filter = fn;
+    m_param  = param;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::set_filter] EXIT");
+}
+
+/**
+ * Adds condition to filter records of the recordset by value of specified field, e.g. to skip all months,
+ * which have less than 31 days:
+ *
+ * month::data value;
+ * value.set_days(31);
+ * rs->add_filter(month::data::kDaysFieldNumber, BDB_FIELD_INT32, BDB_FILTER_GE, &value);
+ *
+ * The field is compared straight in serialized data (see "bdb::compare_field"), and a record without
+ * the field is less than any value. All conditions (and the filter function, if any) must be met.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown operator.
+ */
+void recordset::add_filter (int             field,      /**< [in] Field number.                                  */
+                            int             type,       /**< [in] Field type (see @ref fieldtypes "types").      */
+                            int             op,         /**< [in] Operator (see @ref filterops "operators").     */
+                            const Message * value)      /**< [in] Message of record type, which contains the value. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::add_filter] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::add_filter] field = " << field << ", op = " << op);
+
+    if (op < BDB_FILTER_EQ || op > BDB_FILTER_GE)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::add_filter] Unknown operator.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    if (m_conditions == NULL)
+    {
+        m_conditions = new vector <filter_condition>;
+        assert(m_conditions != NULL);
+    }
+
+    filter_condition condition;
+
+    condition.field = field;
+    condition.type  = type;
+    condition.op    = op;
+    value->SerializeToString(&condition.value);
+
+    m_conditions->push_back(condition);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::add_filter] EXIT");
+}
+
+/**
+ * Limits number of fetched records: records, accepted by filters, are skipped until "offset" ones are passed,
+ * and no more than "limit" ones are fetched then, so the cursor stops at the limit, not reading further
+ * records (e.g. of joins). Records are counted from the next fetch, and again after each rewind.
+ * Fetches of previous records ("bdb::recordset::fetch_prev") are not limited.
+ */
+void recordset::set_limit (unsigned int limit,      /**< [in] Maximum number of fetched records ("0" - unlimited). */
+                           unsigned int offset)     /**< [in] Number of skipped records.                           */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::set_limit] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::set_limit] limit = " << limit << ", offset = " << offset);
+
+    m_limit  = limit;
+    m_offset = offset;
+    m_passed = 0;
+
+    if (m_top != NULL) m_top->filled = false;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::set_limit] EXIT");
+}
+
+/**
+ * Starts (or stops) profiling of the recordset: its counters are reset, and baselines of statistics
+ * of the cache of the environment and of profiled callbacks of the table are taken
+ * (see "bdb::recordset::profile").
+ */
+void recordset::set_profiling (bool enable)     /**< [in] Whether to profile the recordset. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::set_profiling] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::set_profiling] enable = " << enable);
+
+    delete m_profile;
+    m_profile = NULL;
+
+    if (enable)
+    {
+        m_profile = new profile_state;
+        assert(m_profile != NULL);
+
+        m_profile->pages         = pages_read(m_table->m_database->m_env);
+        m_profile->callback_time = m_table->callback_time();
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::set_profiling] EXIT");
+}
+
+/**
+ * Returns what the recordset has done since profiling started (see "bdb::recordset::set_profiling"):
+ * records read and returned, calls of cursors, bytes of unserialized records, time of filter callback
+ * and of profiled callbacks of the table (see "bdb::table_options::profile_callbacks"), and order of
+ * indexes of natural join. Pages are read into the cache of the environment by all its users, so they
+ * reflect the recordset only when it's the only reader meanwhile. Counters are zero, if the recordset
+ * is not profiled.
+ */
+void recordset::profile (recordset_profile * result)    /**< [out] Profile of the recordset. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::profile] ENTER");
+
+    result->examined           = 0;
+    result->returned           = 0;
+    result->cursor_calls       = 0;
+    result->pages_read         = 0;
+    result->bytes_unserialized = 0;
+    result->callback_time      = 0;
+    result->join_order         = m_order;
+
+    if (m_profile != NULL)
+    {
+        uint64_t pages = pages_read(m_table->m_database->m_env);
+        uint64_t time  = m_table->callback_time();
+
+        result->examined           = m_profile->examined;
+        result->returned           = m_profile->returned;
+        result->cursor_calls       = m_profile->calls;
+        result->pages_read         = (pages > m_profile->pages ? pages - m_profile->pages : 0);
+        result->bytes_unserialized = m_profile->bytes;
+        result->callback_time      = m_profile->filter_time + (time > m_profile->callback_time ? time - m_profile->callback_time : 0);
+    }
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::profile] examined = " << result->examined << ", returned = " << result->returned << ", calls = " << result->cursor_calls);
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::profile] EXIT");
+}
+
+/**
+ * Makes top-N recordset, which fetches its records in order of specified field (see "bdb::compare_field"),
+ * limited by limit and offset of the recordset (see "bdb::recordset::set_limit"). The first fetch reads
+ * all accepted records, keeping raw values of the field and serialized records of the top ones only,
+ * so just the fetched records are unserialized, and memory is bounded by the limit. Records with equal
+ * values are fetched in order of the recordset, and records without the field are the least ones.
+ * Field number "0" makes the recordset ordinary one again.
+ */
+void recordset::set_top (int  field,        /**< [in] Field number ("0" - no ordering).            */
+                         int  type,         /**< [in] Field type (see @ref fieldtypes "types").    */
+                         bool descending)   /**< [in] Whether the greatest values are fetched first. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::set_top] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::set_top] field = " << field << ", type = " << type << ", descending = " << descending);
+
+    delete m_top;
+    m_top = NULL;
+
+    if (field != 0)
+    {
+        m_top = new top_state(field, type, descending);
+        assert(m_top != NULL);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::set_top] EXIT");
+}
+
+/**
+ * Removes all filters of the recordset (see "bdb::recordset::set_filter" and "bdb::recordset::add_filter").
+ */
+void recordset::clear_filter ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::clear_filter] ENTER");
+
+    delete m_conditions;
+
+    m_conditions = NULL;
+    m_filter     = NULL;
+    m_param      = NULL;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::clear_filter] EXIT");
+}
+
+/**
+ * Exchanges contents of two recordsets (e.g. to move an opened recordset into a member of another object),
+ * including their cursors, positions, modes and filters. Reading threads of read-ahead mode are stopped,
+ * and continue with the new owners on their next fetches.
+ */
+void recordset::swap (recordset & other)    /**< [in/out] Recordset to exchange contents with. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::swap] ENTER");
+
+    halt_read_ahead(false);
+    other.halt_read_ahead(false);
+
+    // short keys reference buffers of their recordsets, which are exchanged by contents
+    bool mine   = (m_key != NULL && m_key->data == m_keybuf);
+    bool theirs = (other.m_key != NULL && other.m_key->data == other.m_keybuf);
+
+    std::swap_ranges(m_keystore, m_keystore + sizeof(m_keystore) / sizeof(m_keystore[0]), other.m_keystore);
+    std::swap_ranges(m_keybuf,   m_keybuf   + sizeof(m_keybuf),                            other.m_keybuf);
+
+    DBT * key = (other.m_key != NULL ? reinterpret_cast <DBT *> (m_keystore) : NULL);
+    other.m_key = (m_key != NULL ? reinterpret_cast <DBT *> (other.m_keystore) : NULL);
+    m_key = key;
+
+    if (theirs) m_key->data = m_keybuf;
+    if (mine)   other.m_key->data = other.m_keybuf;
+
+    std::swap(m_cursor,     other.m_cursor);
+    std::swap(m_ccursor,    other.m_ccursor);
+    std::swap(m_dcursor,    other.m_dcursor);
+    std::swap(m_type,       other.m_type);
+    std::swap(m_isset,      other.m_isset);
+    std::swap(m_bulk,       other.m_bulk);
+    std::swap(m_bulkptr,    other.m_bulkptr);
+    std::swap(m_kbuf,       other.m_kbuf);
+    std::swap(m_dbuf,       other.m_dbuf);
+    std::swap(m_sbuf,       other.m_sbuf);
+    std::swap(m_format,     other.m_format);
+    std::swap(m_table,      other.m_table);
+    std::swap(m_lower,      other.m_lower);
+    std::swap(m_upper,      other.m_upper);
+    std::swap(m_flags,      other.m_flags);
+    std::swap(m_keyonly,    other.m_keyonly);
+    std::swap(m_seek,       other.m_seek);
+    std::swap(m_keys,       other.m_keys);
+    std::swap(m_next,       other.m_next);
+    std::swap(m_recno,      other.m_recno);
+    std::swap(m_filter,     other.m_filter);
+    std::swap(m_param,      other.m_param);
+    std::swap(m_conditions, other.m_conditions);
+    std::swap(m_ahead,      other.m_ahead);
+    std::swap(m_sample,     other.m_sample);
+    std::swap(m_limit,      other.m_limit);
+    std::swap(m_offset,     other.m_offset);
+    std::swap(m_passed,     other.m_passed);
+    std::swap(m_top,        other.m_top);
+    std::swap(m_profile,    other.m_profile);
+
+    m_last.swap(other.m_last);
+    m_order.swap(other.m_order);
+
+    if (m_ahead != NULL)       m_ahead->rs = this;
+    if (other.m_ahead != NULL) other.m_ahead->rs = &other;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::recordset::swap] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Checks whether records of the recordset are read by index, so their positions include index keys.
+ */
+bool recordset::is_secondary () const
+{
+    return (m_type == BDB_RS_DUPLICATES || m_type == BDB_RS_UNIQUE || m_type == BDB_RS_INDEX_RANGE || m_type == BDB_RS_INDEX_SAMPLE);
+}
+
+/**
+ * Keeps position of fetched record (see "bdb::recordset::position"). Fetch buffers are overwritten
+ * by reads past the end of ranges, so the keys are copied (the string keeps its memory between fetches).
+ */
+void recordset::remember (const DBT * key)  /**< [in] Primary key of fetched record. */
+{
+    bool secondary = is_secondary();
+
+    // index keys of rows, read ahead, are not kept
+    const DBT * skey = (m_type == BDB_RS_UNIQUE ? m_key : m_sbuf);
+
+    m_last.assign(1, (char) (!secondary ? BDB_TOKEN_TABLE : (m_ahead != NULL ? BDB_TOKEN_NONE : BDB_TOKEN_INDEX)));
+
+    for (int i = 0; i < 4; i++) m_last += (char) ((key->size >> (i * 8)) & 0xFF);
+
+    m_last.append((const char *) key->data, key->size);
+
+    if (secondary && m_ahead == NULL) m_last.append((const char *) skey->data, skey->size);
+}
+
+/**
+ * Positions cursor of the recordset at the record with specified keys, or at the first record after it
+ * in order of the table (or index). Returns "DB_NOTFOUND" if there are no such records.
+ */
+int recordset::locate (const DBT * pkey,    /**< [in] Primary key.                          */
+                       const DBT * skey)    /**< [in] Index key (ignored for tables).       */
+{
+    if (!is_secondary())
+    {
+        return move(DB_SET_RANGE, pkey);
+    }
+
+    // recordset of a key of index keeps the key as its search key
+    DBT * sbuf = (m_type == BDB_RS_UNIQUE ? m_key : m_sbuf);
+
+    int res;
+
+    do
+    {
+        // both search keys are overwritten by found ones, and are lost when the buffers are enlarged
+        if (sbuf == m_sbuf)
+        {
+            if (m_sbuf->ulen < skey->size)
+            {
+                m_sbuf->size = skey->size;
+                grow_buffer(m_sbuf);
+            }
+
+            memcpy(m_sbuf->data, skey->data, skey->size);
+            m_sbuf->size = skey->size;
+        }
+
+        if (m_kbuf->ulen < pkey->size)
+        {
+            m_kbuf->size = pkey->size;
+            grow_buffer(m_kbuf);
+        }
+
+        memcpy(m_kbuf->data, pkey->data, pkey->size);
+        m_kbuf->size = pkey->size;
+
+        res = m_cursor->pget(m_cursor, sbuf, m_kbuf, m_dbuf, DB_GET_BOTH_RANGE);
+    }
+    while (res == DB_BUFFER_SMALL && (grow_buffer(m_kbuf) | grow_buffer(m_dbuf) | grow_buffer(m_sbuf)));
+
+    if (res == DB_NOTFOUND && m_type != BDB_RS_UNIQUE)
+    {
+        // all duplicates of the key are before the token (or the key is gone), so the next key is after it
+        res = move(DB_SET_RANGE, skey);
+
+        if (res == 0 && m_table->compare_keys(m_sbuf, skey) == 0) res = move(DB_NEXT_NODUP, NULL);
+    }
+
+    return res;
+}
+
+/**
+ * Copies specified key into search key of the recordset (into its own buffer, if the key is short).
+ */
+void recordset::copy_key (const void * data,    /**< [in] Serialized key.  */
+                          u_int32_t    size)    /**< [in] Size of the key. */
+{
+    memset(m_key, 0, sizeof(DBT));
+
+    if (size <= sizeof(m_keybuf))
+    {
+        m_key->data  = m_keybuf;
+        m_key->ulen  = sizeof(m_keybuf);
+        m_key->flags = DB_DBT_USERMEM;
+    }
+    else
+    {
+        m_key->data  = malloc(size);
+        m_key->ulen  = size;
+        m_key->flags = DB_DBT_USERMEM | DB_DBT_APPMALLOC;
+        assert(m_key->data != NULL);
+    }
+
+    m_key->size = size;
+    memcpy(m_key->data, data, size);
+}
+
+/**
+ * Unserializes specified primary key in format of the source table.
+ */
+void recordset::decode_key (const DBT   * dbt,    /**< [in]  Serialized key.   */
+                            MessageLite * key)    /**< [out] Unserialized key. */
+{
+    if (m_format == BDB_KEY_ORDERED)
+    {
+        unserialize_key(dbt, reflected(key));
+    }
+    else if (m_format == BDB_KEY_RECNO)
+    {
+        unserialize_recno(dbt, reflected(key));
+    }
+    else if (m_format == BDB_KEY_RID)
+    {
+        unserialize_rid(dbt, reflected(key));
+    }
+    else if (m_format == BDB_KEY_RAW)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::fetch] Keys of the table are raw, not messages (see \"bdb::recordset::fetch_raw\").");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+    else
+    {
+        unserialize(dbt, key);
+    }
+}
+
+/**
+ * Collects primary keys of specified recordsets, and intersects (or unites) them.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void recordset::combine (const joinlist & list,     /**< [in] List of recordsets to combine.      */
+                         int              flags)    /**< [in] Flags (see @ref joinflags "flags"). */
+{
+    m_type  = BDB_RS_COMBINED;
+    m_isset = false;
+
+    int res = m_table->m_database->open_cursor(m_table->m_db, NULL, &m_cursor);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::recordset] " << db_strerror(res));
+        if (m_cursor != NULL) m_cursor->close(m_cursor);
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    bool     intersect = ((flags & BDB_JOIN_INTERSECT) != 0);
+    key_less less(m_table);
+
+    m_keys = new vector <string>;
+    assert(m_keys != NULL);
+
+    try
+    {
+        vector <vector <string> > lists(list.size());
+
+        size_t smallest = 0;
+
+        for (size_t i = 0; i < list.size(); i++)
+        {
+            recordset * rs = list[i];
+
+            // primary keys are read from fetch buffer, which is not used in bulk mode
+            if (rs->m_bulk != NULL) rs->set_bulk(0);
+            if (rs->m_type != BDB_RS_JOIN) rs->rewind();
+
+            vector <string> & keys = lists[i];
+
+            while (rs->fetch_record(NULL, NULL))
+            {
+                keys.push_back(string((const char *) rs->m_kbuf->data, rs->m_kbuf->size));
+            }
+
+            std::sort(keys.begin(), keys.end(), less);
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+            LOG4CPLUS_DEBUG(logger, "[bdb::recordset::recordset] keys[" << i << "] = " << keys.size());
+
+            if (keys.size() < lists[smallest].size()) smallest = i;
+
+            // empty intersection cannot grow anymore
+            if (intersect && keys.empty()) break;
+        }
+
+        if (intersect)
+        {
+            if (!lists.empty()) intersect_keys(lists, smallest);
+        }
+        else
+        {
+            for (size_t i = 0; i < lists.size(); i++)
+            {
+                vector <string> result;
+                std::set_union(m_keys->begin(), m_keys->end(), lists[i].begin(), lists[i].end(), std::back_inserter(result), less);
+                m_keys->swap(result);
+            }
+        }
+    }
+    catch (...)
+    {
+        delete m_keys;
+        m_cursor->close(m_cursor);
+        throw;
+    }
+}
+
+/**
+ * Intersects sorted lists of primary keys.
+ * Keys of the smallest list are numbered, and each other list is turned into a bitmap of these numbers
+ * by single merge pass; the bitmaps are intersected by 64-bit words, so no intermediate lists are built.
+ */
+void recordset::intersect_keys (vector <vector <string> > & lists,      /**< [in] Sorted lists of primary keys. */
+                                size_t                      smallest)   /**< [in] Index of the smallest list.   */
+{
+    key_less less(m_table);
+
+    const vector <string> & base = lists[smallest];
+
+    size_t words = (base.size() + 63) / 64;
+
+    // all keys of the smallest list are candidates
+    vector <uint64_t> result(words, ~(uint64_t) 0);
+    if (base.size() % 64 != 0) result[words - 1] = ((uint64_t) 1 << (base.size() % 64)) - 1;
+
+    bool any = !base.empty();
+
+    for (size_t i = 0; i < lists.size() && any; i++)
+    {
+        if (i == smallest) continue;
+
+        const vector <string> & keys = lists[i];
+
+        vector <uint64_t> bitmap(words, 0);
+
+        size_t b = 0, k = 0;
+
+        while (b < base.size() && k < keys.size())
+        {
+            if      (less(base[b], keys[k])) b++;
+            else if (less(keys[k], base[b])) k++;
+            else
+            {
+                bitmap[b / 64] |= (uint64_t) 1 << (b % 64);
+                b++;
+                k++;
+            }
+        }
+
+        any = false;
+
+        for (size_t w = 0; w < words; w++)
+        {
+            result[w] &= bitmap[w];
+            any = any || (result[w] != 0);
+        }
+    }
+
+    m_keys->clear();
+
+    for (size_t b = 0; b < base.size() && any; b++)
+    {
+        if ((result[b / 64] >> (b % 64)) & 1) m_keys->push_back(base[b]);
+    }
+}
+
+/**
+ * Moves cursor of combined recordset to the record with the next collected primary key.
+ * Records, which were removed after the recordset had been opened, are skipped.
+ */
+int recordset::fetch_combined ()
+{
+    if (!m_isset) m_next = 0;
+
+    int res = DB_NOTFOUND;
+
+    while (m_next < m_keys->size())
+    {
+        const string & key = (*m_keys)[m_next++];
+
+        // keys are read from source recordsets, so the table isn't probed in keys-only mode
+        if ((m_flags & BDB_JOIN_KEYS) != 0)
+        {
+            m_kbuf->size = (u_int32_t) key.size();
+            grow_buffer(m_kbuf);
+            memcpy(m_kbuf->data, key.data(), key.size());
+            m_dbuf->size = 0;
+            return 0;
+        }
+
+        DBT k;
+        memset(&k, 0, sizeof(DBT));
+        k.data = (void *) key.data();
+        k.size = (u_int32_t) key.size();
+
+        res = move(DB_SET, &k);
+        if (res != DB_NOTFOUND) break;
+    }
+
+    return res;
+}
+
+/**
+ * Makes random positions of samples, split equally between strata (see "bdb::sample_options"),
+ * and finds out how positions of the table (or index) are searched.
+ */
+void recordset::init_sample (const sample_options & options)    /**< [in] Options of sampling. */
+{
+    m_sample = new sample_state;
+    assert(m_sample != NULL);
+
+    uint64_t state = (options.seed != 0 ? options.seed : monotonic_time() ^ (uint64_t) (size_t) this);
+    if (state == 0) state = 0x9E3779B97F4A7C15ULL;
+
+    unsigned int strata = (options.strata > 1 ? options.strata : 1);
+
+    m_sample->targets.reserve(options.count);
+
+    for (unsigned int i = 0; i < options.count; i++)
+    {
+        m_sample->targets.push_back(((i % strata) + random_fraction(state)) / strata);
+    }
+
+    std::sort(m_sample->targets.begin(), m_sample->targets.end());
+
+    m_sample->bytewise = (m_table->m_callback == NULL);
+
+    if (!m_sample->bytewise)
+    {
+        try
+        {
+            key_histogram hist;
+
+            if (m_table->get_histogram(&hist))
+            {
+                m_sample->bounds.swap(hist.bounds);
+                m_sample->records = hist.records;
+            }
+
+            // fast count is the last saved one, and may be zero
+            if (m_sample->records == 0) m_sample->records = m_table->count(true);
+            if (m_sample->records == 0) m_sample->records = m_table->count(false);
+        }
+        catch (...)
+        {
+            delete m_sample;
+            m_sample = NULL;
+            throw;
+        }
+    }
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::recordset] bytewise = " << m_sample->bytewise);
+}
+
+/**
+ * Moves cursor of sampling recordset to the next sampled record.
+ * Returns "DB_NOTFOUND" when all samples are fetched (or the table is empty).
+ */
+int recordset::fetch_sample ()
+{
+    // rewound recordset fetches the same samples again
+    if (!m_isset)
+    {
+        m_sample->next       = 0;
+        m_sample->positioned = false;
+    }
+
+    if (m_sample->next >= m_sample->targets.size()) return DB_NOTFOUND;
+
+    double fraction = m_sample->targets[m_sample->next++];
+
+    int res = (m_sample->bytewise ? seek_sample(fraction) : walk_sample(fraction));
+
+    if (res != 0) m_sample->next = m_sample->targets.size();
+
+    return res;
+}
+
+/**
+ * Positions cursor of sampling recordset of bytewise sorted keys at the first record with the key,
+ * found by bisection of bytes of the first and the last keys, so specified part of records is below it
+ * (see "bdb::table::find_bounds").
+ */
+int recordset::seek_sample (double fraction)    /**< [in] Fraction of rank of the record. */
+{
+    bool secondary = (m_type == BDB_RS_INDEX_SAMPLE);
+
+    int res = 0;
+
+    if (!m_sample->positioned)
+    {
+        string last;
+
+        res = move(DB_FIRST, NULL);
+        if (res == 0) m_sample->first.assign((const char *) (secondary ? m_sbuf : m_kbuf)->data, (secondary ? m_sbuf : m_kbuf)->size);
+
+        if (res == 0) res = move(DB_LAST, NULL);
+        if (res == 0) last.assign((const char *) (secondary ? m_sbuf : m_kbuf)->data, (secondary ? m_sbuf : m_kbuf)->size);
+
+        if (res != 0) return res;
+
+        const string & first = m_sample->first;
+
+        size_t common = 0;
+        while (common < first.size() && common < last.size() && first[common] == last[common]) common++;
+
+        uint64_t lo = 0, hi = 0;
+
+        for (size_t j = common; j < common + 8; j++)
+        {
+            lo = (lo << 8) | (j < first.size() ? (uint8_t) first[j] : 0);
+            hi = (hi << 8) | (j < last.size()  ? (uint8_t) last[j]  : 0);
+        }
+
+        m_sample->common     = common;
+        m_sample->lo         = lo;
+        m_sample->hi         = hi;
+        m_sample->positioned = true;
+    }
+
+    uint64_t a = m_sample->lo, b = m_sample->hi;
+    string   bound;
+
+    DBT key;
+    memset(&key, 0, sizeof(DBT));
+
+    for (int step = 0; step < SAMPLE_BISECTION_STEPS && a < b; step++)
+    {
+        uint64_t middle = a + (b - a) / 2;
+
+        bound = m_sample->first.substr(0, m_sample->common);
+        for (int j = 7; j >= 0; j--) bound.push_back((char) (uint8_t) (middle >> (j * 8)));
+
+        key.data = (void *) bound.data();
+        key.size = (u_int32_t) bound.size();
+
+        DB_KEY_RANGE range;
+        res = m_table->m_db->key_range(m_table->m_db, NULL, &key, &range, 0);
+        if (res != 0) return res;
+
+        if (range.less < fraction) a = middle + 1;
+        else                       b = middle;
+    }
+
+    bound = m_sample->first.substr(0, m_sample->common);
+    for (int j = 7; j >= 0; j--) bound.push_back((char) (uint8_t) (a >> (j * 8)));
+
+    key.data = (void *) bound.data();
+    key.size = (u_int32_t) bound.size();
+
+    // positions after the last key belong to the last record
+    res = move(DB_SET_RANGE, &key);
+    if (res == DB_NOTFOUND) res = move(DB_LAST, NULL);
+
+    return res;
+}
+
+/**
+ * Positions cursor of sampling recordset of keys, sorted by comparison callback, at the record of specified
+ * rank: jumps to the first record of its bucket of histogram of keys by the bound of the bucket (if the cursor
+ * is before the bucket), and walks the rest of records within the bucket without reading their data.
+ */
+int recordset::walk_sample (double fraction)    /**< [in] Fraction of rank of the record. */
+{
+    size_t   buckets = m_sample->bounds.size() + 1;
+    size_t   bucket  = (size_t) (fraction * buckets);
+    uint64_t target  = (uint64_t) (fraction * m_sample->records);
+
+    if (bucket >= buckets) bucket = buckets - 1;
+
+    int res = 0;
+
+    if (!m_sample->positioned || bucket > m_sample->bucket)
+    {
+        if (bucket == 0)
+        {
+            res = move(DB_FIRST, NULL);
+        }
+        else
+        {
+            const string & bound = m_sample->bounds[bucket - 1];
+
+            DBT key;
+            memset(&key, 0, sizeof(DBT));
+            key.data = (void *) bound.data();
+            key.size = (u_int32_t) bound.size();
+
+            res = move(DB_SET_RANGE, &key);
+        }
+
+        m_sample->rank       = bucket * m_sample->records / buckets;
+        m_sample->bucket     = bucket;
+        m_sample->positioned = true;
+    }
+
+    // the first record of the bucket (or the previous sample again) is already read
+    if (res != 0 || m_sample->rank >= target) return res;
+
+    // skipped records are read by partial reads of zero length
+    bool keyonly = m_keyonly;
+    prepare(true);
+
+    while (res == 0 && m_sample->rank < target)
+    {
+        res = move(DB_NEXT, NULL);
+        m_sample->rank++;
+    }
+
+    prepare(keyonly);
+
+    if (res == 0 && !keyonly) res = move(DB_CURRENT, NULL);
+
+    return res;
+}
+
+/**
+ * Allocates fetch buffers on first use, and prepares buffer of data for next fetch.
+ */
+void recordset::prepare (bool keyonly)  /**< [in] Whether data should be skipped. */
+{
+    // fetch buffers are reused by all fetches, and are enlarged on demand
+    if (m_kbuf == NULL) m_kbuf = new_buffer();
+    if (m_dbuf == NULL) m_dbuf = new_buffer();
+
+    if ((m_type == BDB_RS_DUPLICATES || m_type == BDB_RS_INDEX_RANGE || m_type == BDB_RS_INDEX_SAMPLE) && m_sbuf == NULL) m_sbuf = new_buffer();
+
+    // data are skipped by partial read of zero length
+    m_keyonly      = keyonly;
+    m_dbuf->flags  = DB_DBT_USERMEM | (m_keyonly ? DB_DBT_PARTIAL : 0);
+    m_dbuf->dlen   = 0;
+    m_dbuf->doff   = 0;
+}
+
+/**
+ * Stops reading thread of read-ahead mode (if any) before the cursor is used directly.
+ * The thread is restarted by the next fetch.
+ */
+void recordset::halt_read_ahead (bool discard)  /**< [in] Whether read rows are discarded (the recordset is repositioned). */
+{
+    if (m_ahead != NULL) m_ahead->halt(discard);
+}
+
+/**
+ * Checks that the recordset can be repositioned by seeks and backward fetches.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the recordset doesn't support it.
+ */
+void recordset::check_seekable (const char * operation)     /**< [in] Name of the operation (for logging). */
+{
+    if ((m_type != BDB_RS_TABLE && m_type != BDB_RS_DUPLICATES) || m_bulk != NULL)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::" << operation << "] Only whole tables and indexes can be repositioned, not in bulk mode.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+}
+
+/**
+ * Takes the next record from bulk buffer, read by "DB_MULTIPLE_KEY".
+ * Records of recno and queue tables are read by their numbers. When the buffer is over, "m_bulkptr" is set to "NULL".
+ */
+void recordset::next_bulk (DBT * key,   /**< [out] Key of the record.  */
+                           DBT * data)  /**< [out] Data of the record. */
+{
+    if (m_format == BDB_KEY_RECNO)
+    {
+        DB_MULTIPLE_RECNO_NEXT(m_bulkptr, m_bulk, m_recno, data->data, data->size);
+
+        key->data = &m_recno;
+        key->size = sizeof(db_recno_t);
+    }
+    else
+    {
+        DB_MULTIPLE_KEY_NEXT(m_bulkptr, m_bulk, key->data, key->size, data->data, data->size);
+    }
+}
+
+/**
+ * Takes the next duplicate of the key of keyed recordset of index from bulk buffer, reading next portion
+ * of primary keys into the buffer if required ("DB_MULTIPLE"), and looks up its primary record.
+ * Entries of deferred index, which primary records are already removed, are skipped.
  *
  * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
  *
- * @return true  - record is successfully fetched.
- * @return false - no more records to fetch.
+ * @return true  - record is successfully read.
+ * @return false - no more records to read.
  */
-bool recordset::fetch (Message * key,       /**< [out] Key of fetched record.  */
-                       Message * data)      /**< [out] Data of fetched record. */
+bool recordset::read_dups (bool  keyonly,   /**< [in]  Whether data should be skipped. */
+                           DBT * key,       /**< [out] Primary key of read record.     */
+                           DBT * data)      /**< [out] Data of read record.            */
 {
-    LOG4CPLUS_TRACE(logger, "[bdb::recordset::fetch] ENTER");
+    index * idx = static_cast <index *> (m_table);
 
-    int res = DB_NOTFOUND;
+    prepare(keyonly);
 
-    DBT k, d, sk;
+    int res = 0;
 
-    k.flags = DB_DBT_MALLOC;
-    d.flags = DB_DBT_MALLOC;
+    if (m_dcursor == NULL)
+    {
+        res = idx->m_plain->cursor(idx->m_plain, m_cursor->txn, &m_dcursor, idx->m_database->read_flags());
 
-    LOG4CPLUS_DEBUG(logger, "[bdb::recordset::fetch] type = " << m_type);
+        // duplicates are read with priority of the recordset (see "set_scan_resistant")
+        DB_CACHE_PRIORITY priority;
+
+        if (res == 0) res = m_cursor->get_priority(m_cursor, &priority);
+        if (res == 0) res = m_dcursor->set_priority(m_dcursor, priority);
+
+        // duplicates, already fetched in regular mode, are skipped
+        if (res == 0 && m_isset)
+        {
+            DBT k, d;
+            memset(&k, 0, sizeof(DBT));
+            memset(&d, 0, sizeof(DBT));
+
+            k.data = m_key->data;
+            k.size = m_key->size;
+            d.data = m_kbuf->data;
+            d.size = m_kbuf->size;
+
+            res = m_dcursor->get(m_dcursor, &k, &d, DB_GET_BOTH);
+        }
+    }
 
-    switch (m_type)
+    for (;;)
     {
-        case BDB_RS_TABLE:
-            res = m_cursor->get(m_cursor, &k, &d, (!m_isset ? DB_FIRST : DB_NEXT));
-            break;
+        memset(key,  0, sizeof(DBT));
+        memset(data, 0, sizeof(DBT));
+
+        if (res == 0 && m_bulkptr != NULL)
+        {
+            DB_MULTIPLE_NEXT(m_bulkptr, m_bulk, key->data, key->size);
+        }
 
-        case BDB_RS_DUPLICATES:
-            sk.flags = DB_DBT_MALLOC;
-            res = m_cursor->pget(m_cursor, &sk, &k, &d, (!m_isset ? DB_FIRST : DB_NEXT));
-            if (res == 0) release(&sk);
-            break;
+        if (res == 0 && m_bulkptr == NULL)
+        {
+            // the search key is not changed by the cursor, so it's passed as is
+            DBT k;
+            memset(&k, 0, sizeof(DBT));
 
-        case BDB_RS_UNIQUE:
-            res = m_cursor->pget(m_cursor, m_key, &k, &d, (!m_isset ? DB_SET : DB_NEXT_DUP));
-            break;
+            k.data = m_key->data;
+            k.size = m_key->size;
 
-        case BDB_RS_JOIN:
-            if (m_isset) res = m_cursor->get(m_cursor, &k, &d, 0);
-            break;
+            if (m_profile != NULL) m_profile->calls++;
 
-        default:
-            throw exception(BDB_ERROR_UNKNOWN);
+            res = m_dcursor->get(m_dcursor, &k, m_bulk, (!m_isset ? DB_SET : DB_NEXT_DUP) | DB_MULTIPLE);
+
+            if (res == DB_BUFFER_SMALL)
+            {
+                // a single primary key doesn't fit into the buffer - enlarge it, and try again
+                u_int32_t size = (m_bulk->size + BULK_ALIGNMENT - 1) / BULK_ALIGNMENT * BULK_ALIGNMENT;
+
+                LOG4CPLUS_DEBUG(logger, "[bdb::recordset::read_dups] enlarging buffer to " << size);
+
+                free(m_bulk->data);
+                m_bulk->data = malloc(size);
+                m_bulk->ulen = size;
+                assert(m_bulk->data != NULL);
+
+                res = m_dcursor->get(m_dcursor, &k, m_bulk, (!m_isset ? DB_SET : DB_NEXT_DUP) | DB_MULTIPLE);
+            }
+
+            if (res == 0)
+            {
+                m_isset = true;
+
+                DB_MULTIPLE_INIT(m_bulkptr, m_bulk);
+                DB_MULTIPLE_NEXT(m_bulkptr, m_bulk, key->data, key->size);
+
+                if (m_bulkptr == NULL) res = DB_NOTFOUND;
+            }
+        }
+
+        if (res != 0 || keyonly) break;
+
+        DB * master = idx->m_master->m_db;
+
+        do
+        {
+            res = master->get(master, m_dcursor->txn, key, m_dbuf, 0);
+        }
+        while (res == DB_BUFFER_SMALL && grow_buffer(m_dbuf));
+
+        // stale entry of deferred index
+        if (res == DB_NOTFOUND || res == DB_KEYEMPTY)
+        {
+            res = 0;
+            continue;
+        }
+
+        if (res == 0) *data = *m_dbuf;
+
+        break;
     }
 
-    if (res == 0)
+    if (res == DB_NOTFOUND)
+    {
+        return false;
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::recordset::read_dups] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    return true;
+}
+
+/**
+ * Serializes bounds of range recordset in format of the source.
+ */
+void recordset::set_bounds (const Message * lower,  /**< [in] Lower bound (can be "NULL"). */
+                            const Message * upper)  /**< [in] Upper bound (can be "NULL"). */
+{
+    // partial keys in ProtoBuf wire format are prefixes of complete ones already
+    bool prefix = ((m_flags & BDB_RANGE_PREFIX) != 0 && m_table->m_options.key_format == BDB_KEY_ORDERED);
+
+    if (lower != NULL)
+    {
+        m_lower = new DBT;
+        assert(m_lower != NULL);
+
+        if (prefix) serialize_key_prefix(lower, m_lower);
+        else        m_table->encode_key(lower, m_lower);
+    }
+
+    if (upper != NULL)
+    {
+        m_upper = new DBT;
+        assert(m_upper != NULL);
+
+        if (prefix) serialize_key_prefix(upper, m_upper);
+        else        m_table->encode_key(upper, m_upper);
+    }
+}
+
+
+/**
+ * Moves cursor of range recordset to the next record within the range.
+ * Returns "DB_NOTFOUND" when the range is over.
+ */
+int recordset::fetch_range ()
+{
+    bool reverse   = (m_flags & BDB_RANGE_REVERSE)   != 0;
+    bool exclusive = (m_flags & BDB_RANGE_EXCLUSIVE) != 0;
+    bool prefix    = (m_flags & BDB_RANGE_PREFIX)    != 0;
+
+    // key, which the range is checked against
+    const DBT * key = (m_type == BDB_RS_INDEX_RANGE ? m_sbuf : m_kbuf);
+
+    int res;
+
+    if (m_isset)
+    {
+        res = move(reverse ? DB_PREV : DB_NEXT, NULL);
+    }
+    else if (!reverse)
+    {
+        res = (m_lower != NULL ? move(DB_SET_RANGE, m_lower) : move(DB_FIRST, NULL));
+    }
+    else
+    {
+        // position right after the range (skipping all duplicates of inclusive bound), and step back
+        res = DB_NOTFOUND;
+
+        if (m_upper != NULL)
+        {
+            res = move(DB_SET_RANGE, m_upper);
+
+            if (prefix && !exclusive)
+            {
+                while (res == 0 && starts_with(key, m_upper))
+                {
+                    res = move(DB_NEXT, NULL);
+                }
+            }
+            else if (res == 0 && !exclusive && m_table->compare_keys(key, m_upper) == 0)
+            {
+                res = move(DB_NEXT_NODUP, NULL);
+            }
+        }
+
+        if      (res == 0)           res = move(DB_PREV, NULL);
+        else if (res == DB_NOTFOUND) res = move(DB_LAST, NULL);
+    }
+
+    if (res != 0)
+    {
+        return res;
+    }
+
+    if (!reverse && m_upper != NULL)
+    {
+        // partial key is less than any complete key it's a prefix of
+        int cmp = m_table->compare_keys(key, m_upper);
+        if (cmp > 0 && prefix && !exclusive && starts_with(key, m_upper)) cmp = 0;
+        if (cmp > 0 || (cmp == 0 && exclusive)) return DB_NOTFOUND;
+    }
+
+    if (reverse && m_lower != NULL)
+    {
+        if (m_table->compare_keys(key, m_lower) < 0) return DB_NOTFOUND;
+    }
+
+    return 0;
+}
+
+/**
+ * Performs specified cursor operation, enlarging fetch buffers on demand.
+ * If "key" is specified, it's copied into the key buffer as the search key (e.g. for "DB_SET_RANGE").
+ */
+int recordset::move (int         op,    /**< [in] Cursor operation.                     */
+                     const DBT * key)   /**< [in] Search key (can be "NULL").           */
+{
+    bool secondary = (m_type == BDB_RS_INDEX_RANGE || m_type == BDB_RS_DUPLICATES || m_type == BDB_RS_INDEX_SAMPLE);
+
+    DBT * kbuf = (secondary ? m_sbuf : m_kbuf);
+
+    int res;
+
+    for (;;)
+    {
+        do
+        {
+            if (key != NULL)
+            {
+                // the search key is overwritten by found one, and is lost when the buffer is enlarged
+                if (kbuf->ulen < key->size)
+                {
+                    kbuf->size = key->size;
+                    grow_buffer(kbuf);
+                }
+
+                memcpy(kbuf->data, key->data, key->size);
+                kbuf->size = key->size;
+            }
+
+            if (m_profile != NULL) m_profile->calls++;
+
+            if (secondary)
+            {
+                res = (m_keyonly
+                       ? m_cursor->get (m_cursor, m_sbuf, m_kbuf,         op)
+                       : m_cursor->pget(m_cursor, m_sbuf, m_kbuf, m_dbuf, op));
+            }
+            else
+            {
+                res = m_cursor->get(m_cursor, m_kbuf, m_dbuf, op);
+            }
+        }
+        while (res == DB_BUFFER_SMALL && (grow_buffer(m_kbuf) | grow_buffer(m_dbuf) | grow_buffer(m_sbuf)));
+
+        if (res != DB_SECONDARY_BAD || !secondary) break;
+
+        // entries of deferred index, which primary records are already removed, are skipped in the same direction
+        switch (op)
+        {
+            case DB_LAST:
+            case DB_PREV:       op = DB_PREV;       break;
+            case DB_PREV_DUP:   op = DB_PREV_DUP;   break;
+            case DB_SET:
+            case DB_NEXT_DUP:   op = DB_NEXT_DUP;   break;
+            default:            op = DB_NEXT;       break;
+        }
+
+        key = NULL;
+    }
+
+    return res;
+}
+
+/**
+ * Takes the next record from bulk buffer, reading next portion of records into the buffer if required.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return true  - record is successfully read.
+ * @return false - no more records to read.
+ */
+bool recordset::read_bulk (DBT * key,    /**< [out] Key of read record.  */
+                           DBT * data)   /**< [out] Data of read record. */
+{
+    memset(key,  0, sizeof(DBT));
+    memset(data, 0, sizeof(DBT));
+
+    if (m_bulkptr != NULL)
+    {
+        next_bulk(key, data);
+    }
+
+    if (m_bulkptr == NULL)
     {
+        DBT dummy;
+        memset(&dummy, 0, sizeof(DBT));
+        dummy.flags = DB_DBT_MALLOC;
+
+        if (m_profile != NULL) m_profile->calls++;
+
+        int res = m_cursor->get(m_cursor, &dummy, m_bulk, (!m_isset ? DB_FIRST : DB_NEXT) | DB_MULTIPLE_KEY);
+
+        if (res == DB_BUFFER_SMALL)
+        {
+            // a single record doesn't fit into the buffer - enlarge it, and try again
+            u_int32_t size = (m_bulk->size + BULK_ALIGNMENT - 1) / BULK_ALIGNMENT * BULK_ALIGNMENT;
+
+            LOG4CPLUS_DEBUG(logger, "[bdb::recordset::read_bulk] enlarging buffer to " << size);
+
+            free(m_bulk->data);
+            m_bulk->data = malloc(size);
+            m_bulk->ulen = size;
+            assert(m_bulk->data != NULL);
+
+            res = m_cursor->get(m_cursor, &dummy, m_bulk, (!m_isset ? DB_FIRST : DB_NEXT) | DB_MULTIPLE_KEY);
+        }
+
+        release(&dummy);
+
+        if (res == DB_NOTFOUND)
+        {
+            return false;
+        }
+
+        if (res != 0)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::recordset::read_bulk] " << db_strerror(res));
+            throw exception(BDB_ERROR_UNKNOWN);
+        }
+
         m_isset = true;
 
-        unserialize(&k, key);
-        unserialize(&d, data);
+        DB_MULTIPLE_INIT(m_bulkptr, m_bulk);
+        next_bulk(key, data);
 
-        release(&k);
-        release(&d);
+        if (m_bulkptr == NULL)
+        {
+            return false;
+        }
+    }
 
-        LOG4CPLUS_TRACE(logger, "[bdb::recordset::fetch] EXIT = true");
+    return true;
+}
 
-        return true;
+/**
+ * Checks whether records of the recordset are checked by "bdb::recordset::accept" (the recordset has filters,
+ * or records of the table expire).
+ */
+bool recordset::is_filtered () const
+{
+    return (m_filter != NULL || m_conditions != NULL || m_table->m_options.ttl_field != 0);
+}
+
+/**
+ * Checks whether serialized data of a record are not expired, and meet all conditions and the function of recordset filter.
+ */
+bool recordset::accept (const DBT * data) const     /**< [in] Data of the record. */
+{
+    if (m_table->is_expired(data)) return false;
+
+    if (m_conditions != NULL)
+    {
+        for (vector <filter_condition>::const_iterator i = m_conditions->begin(); i != m_conditions->end(); ++i)
+        {
+            DBT value;
+
+            memset(&value, 0, sizeof(DBT));
+            value.data = const_cast<char *>(i->value.data());
+            value.size = (u_int32_t) i->value.size();
+
+            int res = compare_field(data, &value, i->field, i->type);
+
+            switch (i->op)
+            {
+                case BDB_FILTER_EQ: if (res != 0) return false; break;
+                case BDB_FILTER_NE: if (res == 0) return false; break;
+                case BDB_FILTER_LT: if (res >= 0) return false; break;
+                case BDB_FILTER_LE: if (res >  0) return false; break;
+                case BDB_FILTER_GT: if (res <= 0) return false; break;
+                case BDB_FILTER_GE: if (res <  0) return false; break;
+            }
+        }
     }
 
-    LOG4CPLUS_TRACE(logger, "[bdb::recordset::fetch] EXIT = false");
+    if (m_filter != NULL)
+    {
+        record_view view;
+        view.set(data);
 
-    return false;
+        if (m_profile == NULL) return m_filter(&view, m_param);
+
+        uint64_t start = monotonic_time();
+        bool accepted = m_filter(&view, m_param);
+        m_profile->filter_time += monotonic_time() - start;
+
+        return accepted;
+    }
+
+    return true;
 }
 
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::record_view".
+//--------------------------------------------------------------------------------------------------
+
 /**
- * Rewinds cursor of the recordset to the first record.
- * Cannot be used on joins (always throws an exception there).
+ * Makes empty view (see "bdb::recordset::fetch_view").
+ */
+record_view::record_view ()
+  : m_data(NULL),
+    m_size(0)
+{
+}
+
+/**
+ * Extracts raw value of specified field (see "bdb::extract_field").
  *
- * @throw bdb::exception BDB_ERROR_UNKNOWN - invalid recordset.
+ * @return true  - the field is found.
+ * @return false - the record doesn't contain the field.
  */
-void recordset::rewind ()
+bool record_view::get (int           field,     /**< [in]  Field number.           */
+                       field_value * value)     /**< [out] Raw value of the field. */
+    const
 {
-    LOG4CPLUS_TRACE(logger, "[bdb::recordset::rewind] ENTER");
+    DBT dbt;
+    make(&dbt);
 
-    if (m_type == BDB_RS_JOIN)
+    return extract_field(&dbt, field, value);
+}
+
+/**
+ * Extracts value of specified integer field (see "bdb::extract_field").
+ *
+ * @return true  - the field is found.
+ * @return false - the record doesn't contain the field, or it's not an integer one.
+ */
+bool record_view::get (int       field,     /**< [in]  Field number.       */
+                       int64_t * value)     /**< [out] Value of the field. */
+    const
+{
+    DBT dbt;
+    make(&dbt);
+
+    return extract_field(&dbt, field, value);
+}
+
+/**
+ * Extracts value of specified string (or bytes) field.
+ *
+ * @return true  - the field is found.
+ * @return false - the record doesn't contain the field, or it's not a length-delimited one.
+ */
+bool record_view::get (int      field,      /**< [in]  Field number.       */
+                       string * value)      /**< [out] Value of the field. */
+    const
+{
+    field_value raw;
+
+    if (!get(field, &raw) || raw.wiretype != WIRETYPE_LENGTH_DELIMITED)
     {
-        LOG4CPLUS_WARN(logger, "[bdb::recordset::rewind] Rewind cannot be used on joins.");
-        throw exception(BDB_ERROR_UNKNOWN);
+        return false;
     }
 
-    m_isset = false;
+    value->assign((const char *) raw.data, raw.size);
 
-    LOG4CPLUS_TRACE(logger, "[bdb::recordset::rewind] EXIT");
+    return true;
+}
+
+/**
+ * Refers to value of specified string (or bytes) field in serialized data of the record, without copying it.
+ * The reference is valid as long as the view is.
+ *
+ * @return true  - the field is found.
+ * @return false - the record doesn't contain the field, or it's not a length-delimited one.
+ */
+bool record_view::get (int          field,  /**< [in]  Field number.                     */
+                       string_ref * value)  /**< [out] Reference to value of the field.  */
+    const
+{
+    field_value raw;
+
+    if (!get(field, &raw) || raw.wiretype != WIRETYPE_LENGTH_DELIMITED)
+    {
+        return false;
+    }
+
+    *value = string_ref((const char *) raw.data, raw.size);
+
+    return true;
+}
+
+/**
+ * Makes view of specified nested message field in serialized data of the record, so its fields are read
+ * without parsing of the message. The nested view is valid as long as the view is.
+ *
+ * @return true  - the field is found.
+ * @return false - the record doesn't contain the field, or it's not a length-delimited one.
+ */
+bool record_view::get (int           field,     /**< [in]  Field number.                   */
+                       record_view * nested)    /**< [out] View of the nested message.     */
+    const
+{
+    field_value raw;
+
+    if (!get(field, &raw) || raw.wiretype != WIRETYPE_LENGTH_DELIMITED)
+    {
+        return false;
+    }
+
+    nested->m_data = raw.data;
+    nested->m_size = raw.size;
+
+    return true;
+}
+
+/**
+ * Unserializes whole data of the record.
+ */
+void record_view::parse (MessageLite * data)    /**< [out] Data of the record. */
+    const
+{
+    DBT dbt;
+    make(&dbt);
+
+    unserialize(&dbt, data);
+}
+
+/**
+ * Returns size of serialized data of the record, in bytes.
+ */
+size_t record_view::size () const
+{
+    return m_size;
+}
+
+/**
+ * Makes the view to reference specified serialized data.
+ */
+void record_view::set (const DBT * dbt)     /**< [in] Fetched data. */
+{
+    m_data = dbt->data;
+    m_size = dbt->size;
+}
+
+/**
+ * Makes "DBT" object, which references data of the view (the object should not be released).
+ */
+void record_view::make (DBT * dbt)          /**< [out] Referencing "DBT" object. */
+    const
+{
+    memset(dbt, 0, sizeof(DBT));
+
+    dbt->data  = const_cast<void *>(m_data);
+    dbt->size  = (u_int32_t) m_size;
+    dbt->flags = DB_DBT_USERMEM;
 }
 
 }
@@ -0,0 +1,458 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/regions.cc
+ * Contains implementation of placement of shared regions of class "bdb::database" into huge pages and on NUMA nodes.
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+// Boost C++ Libraries
+#include <boost/thread/mutex.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// Regions are mapped by the library on Linux, using Berkeley DB 4.8 or later
+#if defined(__linux__) && ((DB_VERSION_MAJOR > 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR >= 8))
+#define BDB_REGION_MAP
+#endif
+
+#ifdef BDB_REGION_MAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/mman.h>
+#include <sys/shm.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of placement of shared regions of class "bdb::database".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+#ifdef BDB_REGION_MAP
+
+using std::map;
+
+#ifndef SHM_HUGETLB
+#define SHM_HUGETLB     04000
+#endif
+
+/** @private Memory policies of "mbind" system call (see "linux/mempolicy.h"). */
+static const int MPOL_PREFERRED_MODE  = 1;
+static const int MPOL_INTERLEAVE_MODE = 3;
+
+/** @private Maximum number of NUMA nodes, the regions are placed on. */
+static const unsigned int MAX_NUMA_NODES = 1024;
+
+/** @private Default size of huge page, if it's not reported by the system (in bytes). */
+static const size_t DEFAULT_HUGE_PAGE = 2 * 1024 * 1024;
+
+/** @private Size of zeroes, new region files are filled with at once (in bytes). */
+static const size_t ZERO_FILL = 64 * 1024;
+
+/** @private Placement of regions of one environment. */
+struct region_placement
+{
+    bool huge;      /**< Whether regions in system shared memory are backed by huge pages. */
+    int  numa;      /**< Placement of regions on NUMA nodes (see @ref numapolicies "policies"). */
+};
+
+/** @private Region, mapped into memory of the process. */
+struct region_mapping
+{
+    size_t size;    /**< Size of the mapping (in bytes).                        */
+    bool   shm;     /**< Whether the region is a segment of system shared memory. */
+};
+
+/** @private Placements of environments, and all regions, mapped by the library. */
+class region_state
+{
+public:
+
+    region_state () : hooked(false) { }
+
+    boost::mutex                        mutex;      /**< Guards all the fields below.                               */
+    bool                                hooked;     /**< Whether the regions are mapped by the library (for the whole process). */
+    map <DB_ENV *, region_placement>    envs;       /**< Placements of opened environments.                         */
+    map <void *, region_mapping>        regions;    /**< Mapped regions by their addresses.                         */
+};
+
+/** @private The only state of the process, since Berkeley DB maps regions of all environments the same way. */
+static region_state regions;
+
+/**
+ * @private Returns size of huge pages of the system.
+ */
+static size_t huge_page_size ()
+{
+    size_t size = DEFAULT_HUGE_PAGE;
+
+    FILE * file = fopen("/proc/meminfo", "r");
+    if (file == NULL) return size;
+
+    char line[256];
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        unsigned long kbytes;
+
+        if (sscanf(line, "Hugepagesize: %lu kB", &kbytes) == 1)
+        {
+            size = (size_t) kbytes * 1024;
+            break;
+        }
+    }
+
+    fclose(file);
+
+    return size;
+}
+
+/**
+ * @private Returns number of NUMA nodes of the system ("1" if it's unknown).
+ */
+static unsigned int numa_nodes ()
+{
+    unsigned int count = 0;
+
+    while (count < MAX_NUMA_NODES)
+    {
+        char path[64];
+        sprintf(path, "/sys/devices/system/node/node%u", count);
+
+        if (access(path, F_OK) != 0) break;
+
+        count++;
+    }
+
+    return (count == 0 ? 1 : count);
+}
+
+/**
+ * @private Returns identifier of region by its file name ("__db.001" is the first one).
+ */
+static int region_id (const char * path)    /**< [in] Path of the region file. */
+{
+    const char * dot = strrchr(path, '.');
+
+    return (dot != NULL ? atoi(dot + 1) : 1);
+}
+
+/**
+ * @private Places pages of mapped region on NUMA nodes. The pages are not touched yet, so they are taken
+ * from the nodes as soon as Berkeley DB initializes the region. Regions, which cannot be placed, stay
+ * where the system puts them.
+ */
+static void place_region (void * addr,      /**< [in] Address of the region.                                  */
+                          size_t size,      /**< [in] Size of the region.                                     */
+                          int    policy,    /**< [in] Placement of the region (see @ref numapolicies "policies"). */
+                          int    id)        /**< [in] Identifier of the region.                               */
+{
+    unsigned int nodes = numa_nodes();
+    if (nodes < 2) return;
+
+    const unsigned int bits = sizeof(unsigned long) * 8;
+
+    unsigned long mask[MAX_NUMA_NODES / (sizeof(unsigned long) * 8)];
+    memset(mask, 0, sizeof(mask));
+
+    int mode = MPOL_INTERLEAVE_MODE;
+
+    if (policy == BDB_NUMA_INTERLEAVE)
+    {
+        for (unsigned int i = 0; i < nodes; i++) mask[i / bits] |= 1UL << (i % bits);
+    }
+    else
+    {
+        unsigned int node = (unsigned int) (id > 0 ? id - 1 : 0) % nodes;
+
+        mode = MPOL_PREFERRED_MODE;
+        mask[node / bits] |= 1UL << (node % bits);
+    }
+
+    if (syscall(SYS_mbind, addr, size, mode, mask, (unsigned long) MAX_NUMA_NODES + 1, 0) != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::place_region] " << strerror(errno));
+    }
+}
+
+/**
+ * @private Maps region in system shared memory, creating it if required. The region, which is left
+ * by previous run, is removed on creation, the way Berkeley DB does it. Returns system error code.
+ */
+static int map_segment (key_t    key,       /**< [in]     Key of the segment.                  */
+                        size_t * size,      /**< [in,out] Size of the region (rounded up for huge pages). */
+                        bool     huge,      /**< [in]     Whether to back the region by huge pages.  */
+                        int    * is_create, /**< [in,out] Whether the region is created.       */
+                        void  ** addr)      /**< [out]    Address of the region.               */
+{
+    int id = -1;
+
+    if (*is_create)
+    {
+        id = shmget(key, 0, 0);
+
+        if (id != -1) shmctl(id, IPC_RMID, NULL);
+
+        if (huge)
+        {
+            size_t page = huge_page_size();
+            size_t huge_size = (*size + page - 1) / page * page;
+
+            id = shmget(key, huge_size, IPC_CREAT | IPC_EXCL | SHM_HUGETLB | 0660);
+
+            if (id != -1)
+            {
+                *size = huge_size;
+            }
+            else
+            {
+                LOG4CPLUS_WARN(logger, "[bdb::database::map_segment] No huge pages (" << strerror(errno) << "), the region is backed by normal ones.");
+            }
+        }
+
+        if (id == -1) id = shmget(key, *size, IPC_CREAT | IPC_EXCL | 0660);
+    }
+    else
+    {
+        id = shmget(key, 0, 0);
+    }
+
+    if (id == -1) return errno;
+
+    *addr = shmat(id, NULL, 0);
+
+    if (*addr == (void *) -1) return errno;
+
+    return 0;
+}
+
+/**
+ * @private Maps region file in the home, creating it if required. New files are filled with zeroes,
+ * so the regions don't fail on full devices when they are touched. Returns system error code.
+ */
+static int map_file (const char * path,         /**< [in]     Path of the region file.  */
+                     size_t       size,         /**< [in]     Size of the region.       */
+                     int        * is_create,    /**< [in,out] Whether the region is created. */
+                     void      ** addr)         /**< [out]    Address of the region.    */
+{
+    int fd = open(path, (*is_create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR), 0660);
+
+    if (fd == -1) return errno;
+
+    int res = 0;
+
+    if (*is_create)
+    {
+        char zeroes[ZERO_FILL];
+        memset(zeroes, 0, sizeof(zeroes));
+
+        for (size_t written = 0; written < size && res == 0; )
+        {
+            ssize_t n = write(fd, zeroes, (size - written < sizeof(zeroes) ? size - written : sizeof(zeroes)));
+
+            if (n > 0)  written += (size_t) n;
+            if (n < 0 && errno != EINTR) res = errno;
+        }
+    }
+
+    if (res == 0)
+    {
+        *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        if (*addr == MAP_FAILED) res = errno;
+    }
+
+    close(fd);
+
+    return res;
+}
+
+/**
+ * @private Maps region of any environment of the process, in place of Berkeley DB. Regions are files
+ * in the home, or segments of system shared memory ("DB_SYSTEM_MEM"), numbered from the base key in
+ * order of region files. Returns system error code.
+ */
+static int region_map (DB_ENV * env,        /**< [in]     Environment of the region.     */
+                       char   * path,       /**< [in]     Path of the region file.       */
+                       size_t   size,       /**< [in]     Size of the region.            */
+                       int    * is_create,  /**< [in,out] Whether the region is created. */
+                       void  ** addr)       /**< [out]    Address of the region.         */
+{
+    region_placement placement = { false, BDB_NUMA_DEFAULT };
+
+    {
+        boost::mutex::scoped_lock lock(regions.mutex);
+
+        map <DB_ENV *, region_placement>::const_iterator i = regions.envs.find(env);
+
+        if (i != regions.envs.end()) placement = i->second;
+    }
+
+    u_int32_t flags = 0;
+    env->get_open_flags(env, &flags);
+
+    region_mapping mapping = { size, (flags & DB_SYSTEM_MEM) != 0 };
+
+    int res;
+
+    if (mapping.shm)
+    {
+        long key = 0;
+        env->get_shm_key(env, &key);
+
+        res = map_segment((key_t) (key + region_id(path) - 1), &mapping.size, placement.huge, is_create, addr);
+    }
+    else
+    {
+        res = map_file(path, size, is_create, addr);
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::region_map] " << path << ": " << strerror(res));
+        return res;
+    }
+
+    // existing regions are placed by the process, which has created them
+    if (placement.numa != BDB_NUMA_DEFAULT && *is_create) place_region(*addr, mapping.size, placement.numa, region_id(path));
+
+    boost::mutex::scoped_lock lock(regions.mutex);
+
+    regions.regions[*addr] = mapping;
+
+    return 0;
+}
+
+/**
+ * @private Unmaps region of any environment of the process. Returns system error code.
+ */
+static int region_unmap (DB_ENV *,              /**< [in] Environment of the region. */
+                         void   * addr)         /**< [in] Address of the region.     */
+{
+    region_mapping mapping;
+
+    {
+        boost::mutex::scoped_lock lock(regions.mutex);
+
+        map <void *, region_mapping>::iterator i = regions.regions.find(addr);
+
+        if (i == regions.regions.end()) return EINVAL;
+
+        mapping = i->second;
+        regions.regions.erase(i);
+    }
+
+    int res = (mapping.shm ? shmdt(addr) : munmap(addr, mapping.size));
+
+    return (res == 0 ? 0 : errno);
+}
+
+#endif
+
+/**
+ * @private Registers placement of shared regions of the environment before it's opened. Once any
+ * environment has the placement, Berkeley DB maps regions of all environments of the process via
+ * the library. Returns error code of Berkeley DB.
+ */
+int database::place_regions (const database_options & options)  /**< [in] Tuning options of the environment. */
+{
+    if (!options.huge_pages && options.numa_policy == BDB_NUMA_DEFAULT) return 0;
+
+    // private regions are allocated in the heap of the process
+    if (m_memory || m_readonly)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::place_regions] Private regions are placed by the system.");
+        return 0;
+    }
+
+#ifdef BDB_REGION_MAP
+
+    if (options.huge_pages && options.shm_key == 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::database::place_regions] Only regions in system shared memory are backed by huge pages.");
+    }
+
+    region_placement placement = { options.huge_pages, options.numa_policy };
+
+    boost::mutex::scoped_lock lock(regions.mutex);
+
+    if (!regions.hooked)
+    {
+        int res = db_env_set_func_region_map(region_map, region_unmap);
+        if (res != 0) return res;
+
+        regions.hooked = true;
+    }
+
+    regions.envs[m_env] = placement;
+
+#else
+
+    LOG4CPLUS_WARN(logger, "[bdb::database::place_regions] Placement of regions is not supported.");
+
+#endif
+
+    return 0;
+}
+
+/**
+ * @private Forgets placement of shared regions of the environment after it's closed.
+ */
+void database::release_regions ()
+{
+#ifdef BDB_REGION_MAP
+
+    boost::mutex::scoped_lock lock(regions.mutex);
+
+    regions.envs.erase(m_env);
+
+#endif
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,358 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+
+/** @file bdb/src/schema.cc
+ * Contains implementation of versions of schema of class "bdb::table", and of upgrades of its data.
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Boost C++ Libraries
+#include <boost/thread/thread.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of versions of schema of class "bdb::table".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::pair;
+using std::string;
+using std::vector;
+
+/** @private Maximum size of header of versioned value (marker and version). */
+static const size_t VERSION_HEADER_SIZE = 1 + 5;
+
+/**
+ * @private Makes "DBT" object, which references specified string.
+ */
+static void make_dbt (const string & from,  /**< [in]  Source string.       */
+                      DBT          * to)    /**< [out] Resulted "DBT" object. */
+{
+    memset(to, 0, sizeof(DBT));
+
+    to->data = (void *) from.data();
+    to->size = (u_int32_t) from.size();
+}
+
+/**
+ * Registers function, which upgrades data of records from specified version of schema of the table to the
+ * next one (see "bdb::table_options::schema_version"). Written values are tagged by current version of
+ * schema, values of older versions (untagged values are of version "0") are upgraded by the functions in
+ * turn, when they are read by the table and its recordsets ("bdb::table::select", "bdb::recordset::fetch",
+ * and so on), and are written back by migration (see "bdb::table::migrate"). So changed schema needs
+ * neither downtime nor rewrite of all records at once. Indexing functions, filters and other callbacks
+ * get stored data as they are, so they should accept all versions, which are not migrated yet.
+ * Upgrades should be registered before the table is used concurrently.
+ */
+void table::add_upgrade (unsigned int       version,    /**< [in] Version of schema of upgraded data. */
+                         upgrade_callback   fn_upgrade) /**< [in] Function to upgrade the data.       */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_upgrade] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_upgrade] version = " << version);
+
+    if (m_upgrades.size() <= version) m_upgrades.resize(version + 1, NULL);
+
+    m_upgrades[version] = fn_upgrade;
+
+    // recordsets of indexes fetch data of the table as well
+    for (size_t i = 0; i < m_indexes.size(); i++) m_indexes[i]->add_upgrade(version, fn_upgrade);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_upgrade] EXIT");
+}
+
+/**
+ * Rewrites records, which data are of older versions of schema, with upgraded data, reading all records of
+ * the table by batches in their own transactions, and sleeping between the batches, so migration can run
+ * in a background thread without storm of writes. Records are updated the same way as by "bdb::table::update".
+ * Returns number of migrated records.
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - deadlock, or lock is not granted (migration can be restarted).
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - data cannot be upgraded, or unknown error.
+ */
+uint64_t table::migrate (unsigned int batch,    /**< [in] Number of records, read by a transaction.    */
+                         unsigned int pause)    /**< [in] Pause between transactions, in milliseconds.  */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::migrate] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::migrate] batch = " << batch << ", pause = " << pause);
+
+    check_open();
+
+    if (batch == 0) batch = 1;
+
+    uint64_t migrated = 0;
+    string   last;
+    bool     started = false;
+    bool     done    = (m_options.schema_version == 0);
+
+    int res = 0;
+
+    while (res == 0 && !done)
+    {
+        DB_TXN * txn = NULL;
+        DB_TXN * own = NULL;
+
+        res = m_database->begin_auto(&txn, &own);
+
+        DBC * cursor = NULL;
+
+        DBT k, d;
+        memset(&k, 0, sizeof(DBT));
+        memset(&d, 0, sizeof(DBT));
+
+        k.flags = DB_DBT_REALLOC;
+        d.flags = DB_DBT_REALLOC;
+
+        if (res == 0) res = m_db->cursor(m_db, txn, &cursor, m_database->write_flags());
+
+        if (res == 0)
+        {
+            if (!started)
+            {
+                res = cursor->get(cursor, &k, &d, DB_FIRST);
+            }
+            else
+            {
+                k.data = malloc(last.size() + 1);
+                k.size = (u_int32_t) last.size();
+                memcpy(k.data, last.data(), last.size());
+
+                res = cursor->get(cursor, &k, &d, DB_SET_RANGE);
+
+                DBT prev;
+                make_dbt(last, &prev);
+
+                // the last record of previous batch is skipped
+                if (res == 0 && compare_keys(&k, &prev) == 0) res = cursor->get(cursor, &k, &d, DB_NEXT);
+            }
+        }
+
+        // stale records of the batch are upgraded, and are written when the cursor is closed
+        vector < pair <string, string> > stale;
+        unsigned int read = 0;
+
+        while (res == 0)
+        {
+            started = true;
+            last.assign((const char *) k.data, k.size);
+
+            if (value_version(&d) < m_options.schema_version)
+            {
+                string buffer;
+                DBT    upgraded;
+
+                res = upgrade_value(&d, &buffer, &upgraded);
+
+                if (res == 0) stale.push_back(std::make_pair(last, buffer));
+            }
+
+            if (res != 0 || ++read >= batch) break;
+
+            res = cursor->get(cursor, &k, &d, DB_NEXT);
+        }
+
+        if (res == DB_NOTFOUND)
+        {
+            done = true;
+            res  = 0;
+        }
+
+        if (cursor != NULL)
+        {
+            int err = cursor->close(cursor);
+            if (res == 0) res = err;
+        }
+
+        free(k.data);
+        free(d.data);
+
+        for (size_t i = 0; i < stale.size() && res == 0; i++)
+        {
+            scratch_scope scope;
+            DBT key, data;
+
+            make_dbt(stale[i].first,  &key);
+            make_dbt(stale[i].second, &data);
+
+            data.flags = DB_DBT_USERMEM;
+            stamp_value(&data, &scope);
+
+            res = update_record(txn, &key, &data);
+        }
+
+        if (res == 0) migrated += stale.size();
+
+        res = m_database->end_auto(own, res);
+
+        if (res == 0 && !done && pause != 0) boost::this_thread::sleep(boost::posix_time::milliseconds(pause));
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::migrate] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::migrate] EXIT = " << migrated);
+
+    return migrated;
+}
+
+/**
+ * @private Tags serialized data by current version of schema of the table, if the table has versions.
+ * Tagged data are allocated in the scope.
+ */
+void table::stamp_value (DBT           * data,  /**< [in/out] Serialized data. */
+                         scratch_scope * scope) /**< [in]     Scope of buffers. */
+{
+    stamp_value(data, m_options.schema_version, scope);
+}
+
+/**
+ * @private Tags serialized data by specified version of schema (data of version "0" are not tagged).
+ * Tagged data are allocated in the scope.
+ */
+void table::stamp_value (DBT           * data,      /**< [in/out] Serialized data.      */
+                         unsigned int    version,   /**< [in]     Version of the data.  */
+                         scratch_scope * scope)     /**< [in]     Scope of buffers.     */
+{
+    if (version == 0) return;
+
+    char * tagged = (char *) scope->alloc(data->size + VERSION_HEADER_SIZE);
+    size_t header = version_header(version, tagged);
+
+    if (data->size != 0) memcpy(tagged + header, data->data, data->size);
+
+    u_int32_t size = data->size;
+
+    release(data);
+
+    data->data  = tagged;
+    data->size  = (u_int32_t) (size + header);
+    data->ulen  = data->size;
+    data->flags = DB_DBT_USERMEM;
+}
+
+/**
+ * @private Upgrades serialized data of older version of schema to current one, by upgrades of the table in turn.
+ * Upgraded data (or the data itself, if it needs no upgrade) are referenced by "result".
+ * Returns error code of Berkeley DB ("EINVAL" - there is no upgrade of a version).
+ */
+int table::upgrade_value (const DBT * data,     /**< [in]  Serialized data.               */
+                          string    * buffer,   /**< [out] Buffer of upgraded data.       */
+                          DBT       * result)   /**< [out] Data of current version.       */
+{
+    *result = *data;
+
+    unsigned int version = value_version(data);
+
+    while (version < m_options.schema_version)
+    {
+        if (version >= m_upgrades.size() || m_upgrades[version] == NULL)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::table::upgrade_value] Table " << m_name << " has no upgrade of version " << version << ".");
+            return EINVAL;
+        }
+
+        DBT next;
+        memset(&next, 0, sizeof(DBT));
+
+        int res;
+
+        {
+            latency_scope callback(BDB_LATENCY_CALLBACK);
+            res = m_upgrades[version](m_db, version, plain_value(result), &next);
+        }
+
+        if (res != 0) return res;
+
+        buffer->assign((const char *) next.data, next.size);
+        if (next.flags & DB_DBT_APPMALLOC) free(next.data);
+
+        make_dbt(*buffer, result);
+
+        version++;
+    }
+
+    return 0;
+}
+
+/**
+ * @private Unserializes data of a record, upgrading them to current version of schema of the table.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the data cannot be upgraded.
+ */
+void table::unserialize_data (const DBT   * from,   /**< [in]  Serialized data.   */
+                              MessageLite * to)     /**< [out] Resulted message.  */
+{
+    if (m_options.schema_version == 0)
+    {
+        unserialize(from, to);
+        return;
+    }
+
+    string buffer;
+    DBT    upgraded;
+
+    int res = upgrade_value(from, &buffer, &upgraded);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::unserialize_data] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    unserialize(&upgraded, to);
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
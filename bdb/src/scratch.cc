@@ -0,0 +1,265 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/scratch.cc
+ * Contains implementation of class "bdb::scratch_scope".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// Boost C++ Libraries
+#include <boost/thread/tss.hpp>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::scratch_scope".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::vector;
+
+using google::protobuf::uint8;
+
+/** @private Initial size of scratch arena. */
+static const size_t SCRATCH_MIN_SIZE = 4 * 1024;
+
+/** @private Maximum size of scratch arena (larger buffers are allocated separately). */
+static const size_t SCRATCH_MAX_SIZE = 1024 * 1024;
+
+/** @private Alignment of buffers in scratch arena. */
+static const size_t SCRATCH_ALIGNMENT = 8;
+
+/**
+ * @private Per-thread arena of temporary buffers.
+ * Buffers are allocated by bumping a pointer, and are never freed one by one - the whole arena is reset
+ * at once. Buffers, which don't fit into the arena, are allocated separately, and the arena is enlarged
+ * on reset to fit them next time.
+ */
+class scratch_arena
+{
+public:
+
+    scratch_arena ()
+      : m_data(NULL),
+        m_size(0),
+        m_used(0),
+        m_overflow(0),
+        m_depth(0)
+    { }
+
+    ~scratch_arena ()
+    {
+        reset();
+        free(m_data);
+    }
+
+    /** Allocates buffer of specified size. */
+    void * alloc (size_t size)
+    {
+        size = (size + SCRATCH_ALIGNMENT - 1) & ~(size_t) (SCRATCH_ALIGNMENT - 1);
+
+        if (m_used + size <= m_size)
+        {
+            void * ptr = m_data + m_used;
+            m_used += size;
+            return ptr;
+        }
+
+        void * ptr = malloc(size);
+        assert(ptr != NULL);
+
+        m_spare.push_back(ptr);
+        m_overflow += size;
+
+        return ptr;
+    }
+
+    /** Enters new scope. */
+    inline void enter ()
+    {
+        m_depth++;
+    }
+
+    /** Leaves current scope, and resets the arena if the scope was outermost. */
+    inline void leave ()
+    {
+        if (--m_depth == 0)
+        {
+            reset();
+        }
+    }
+
+protected:
+
+    /** Frees all buffers. */
+    void reset ()
+    {
+        for (size_t i = 0; i < m_spare.size(); i++)
+        {
+            free(m_spare[i]);
+        }
+
+        m_spare.clear();
+
+        if (m_overflow != 0 && m_size < SCRATCH_MAX_SIZE)
+        {
+            size_t size = m_size + m_overflow;
+
+            if (size < SCRATCH_MIN_SIZE) size = SCRATCH_MIN_SIZE;
+            if (size > SCRATCH_MAX_SIZE) size = SCRATCH_MAX_SIZE;
+
+            free(m_data);
+            m_data = (uint8 *) malloc(size);
+            assert(m_data != NULL);
+            m_size = size;
+        }
+
+        m_used     = 0;
+        m_overflow = 0;
+    }
+
+protected:
+
+    uint8            * m_data;      /**< Memory of the arena.                      */
+    size_t             m_size;      /**< Size of the arena.                        */
+    size_t             m_used;      /**< Used part of the arena.                   */
+    size_t             m_overflow;  /**< Total size of separately allocated buffers. */
+    vector <void *>    m_spare;     /**< Separately allocated buffers.             */
+    int                m_depth;     /**< Depth of nested scopes.                   */
+};
+
+/** @private Arenas of all threads. */
+static boost::thread_specific_ptr <scratch_arena> arenas;
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Enters scope of temporary buffers.
+ */
+scratch_scope::scratch_scope ()
+{
+    m_arena = arenas.get();
+
+    if (m_arena == NULL)
+    {
+        m_arena = new scratch_arena();
+        arenas.reset(m_arena);
+    }
+
+    m_arena->enter();
+}
+
+/**
+ * Leaves scope of temporary buffers.
+ * All buffers are freed when the outermost scope of the thread is left.
+ */
+scratch_scope::~scratch_scope () throw ()
+{
+    m_arena->leave();
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Allocates temporary buffer, which lives until the outermost scope of the thread is left.
+ */
+void * scratch_scope::alloc (size_t size)   /**< [in] Size of the buffer in bytes. */
+{
+    return m_arena->alloc(size == 0 ? 1 : size);
+}
+
+/**
+ * Serializes specified "google::protobuf::Message" into temporary buffer.
+ * The "DBT" object is marked as "DB_DBT_USERMEM", so "bdb::release" doesn't free it.
+ * Large value is compressed, if allowed and a codec is set (see "bdb::set_codec"), and then is encrypted
+ * the same way, if a cipher is set (see "bdb::set_cipher").
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the value cannot be encrypted.
+ */
+void scratch_scope::serialize (const MessageLite * from,        /**< [in]  Source ProtoBuf message.                    */
+                               DBT               * to,          /**< [out] Resulted "DBT" object.                      */
+                               bool                compress)    /**< [in]  Whether the value can be compressed and encrypted. */
+{
+    latency_scope latency(BDB_LATENCY_SERIALIZE);
+
+    size_t bytes = (size_t) from->ByteSize();
+
+    memset(to, 0, sizeof(DBT));
+
+    to->data  = alloc(bytes);
+    to->flags = DB_DBT_USERMEM;
+    to->ulen  = (u_int32_t) bytes;
+    to->size  = (u_int32_t) bytes;
+
+    from->SerializeWithCachedSizesToArray((uint8 *) to->data);
+
+    if (compress && should_compress(bytes))
+    {
+        // compressed value replaces raw one, which stays in the arena until the scope ends
+        void * packed = alloc(bytes);
+        size_t size   = compress_value(to->data, bytes, packed);
+
+        if (size != 0)
+        {
+            to->data = packed;
+            to->ulen = (u_int32_t) bytes;
+            to->size = (u_int32_t) size;
+        }
+    }
+
+    if (compress && should_encrypt())
+    {
+        void * sealed = alloc(sealed_size(to->size));
+        size_t size   = encrypt_value(to->data, to->size, sealed);
+
+        if (size == 0) throw exception(BDB_ERROR_UNKNOWN);
+
+        to->data = sealed;
+        to->ulen = (u_int32_t) sealed_size(to->size);
+        to->size = (u_int32_t) size;
+    }
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
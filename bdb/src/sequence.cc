@@ -66,18 +66,24 @@ namespace bdb
  */
 sequence::sequence (database   * db,        /**< [in] Database of the sequence.                           */
                     const char * name,      /**< [in] Name of the sequence.                               */
-                    bool         create)    /**< [in] Whether to create the sequence if it doesn't exist. */
+                    bool         create,    /**< [in] Whether to create the sequence if it doesn't exist. */
+                    int          cache,     /**< [in] Number of identifiers to cache ("0" - no cache).    */
+                    bool         autonomous)    /**< [in] Whether identifiers are allocated outside of transactions. */
   : m_database(db),
-    m_seq(NULL)
+    m_seq(NULL),
+    m_cache(cache),
+    m_autonomous(cache != 0 || autonomous)
 {
     LOG4CPLUS_TRACE(logger, "[bdb::sequence::sequence] ENTER");
     LOG4CPLUS_DEBUG(logger, "[bdb::sequence::sequence] name = " << name);
     LOG4CPLUS_DEBUG(logger, "[bdb::sequence::sequence] create = " << create);
+    LOG4CPLUS_DEBUG(logger, "[bdb::sequence::sequence] cache = " << cache);
+    LOG4CPLUS_DEBUG(logger, "[bdb::sequence::sequence] autonomous = " << autonomous);
 
-    int res = db_sequence_create(&m_seq, m_database->m_seq, 0);
+    int res = db_sequence_create(&m_seq, (m_autonomous ? m_database->m_seqc : m_database->m_seq), 0);
 
     if (res == 0) res = m_seq->set_flags(m_seq, DB_SEQ_INC);
-    if (res == 0) res = m_seq->set_cachesize(m_seq, 0);
+    if (res == 0) res = m_seq->set_cachesize(m_seq, m_cache);
     if (res == 0) res = m_seq->initial_value(m_seq, 1);
 
     u_int32_t flags = DB_THREAD;
@@ -93,7 +99,7 @@ sequence::sequence (database   * db,        /**< [in] Database of the sequence.
     key.data = (void *) name;
     key.size = (u_int32_t) strlen(name);
 
-    if (res == 0) res = m_seq->open(m_seq, m_database->m_txns.top(), &key, flags);
+    if (res == 0) res = m_seq->open(m_seq, (m_autonomous ? NULL : m_database->get_transaction()), &key, flags);
 
     if (res != 0)
     {
@@ -133,17 +139,18 @@ sequence::~sequence () throw ()
 
 /**
  * Generates next unique identifier and returns it.
+ * Cached and autonomous sequences ignore specified transaction.
  *
  * @return 64-bit integer value.
  *
  * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
  */
-int64_t sequence::id ()
+int64_t sequence::id (transaction * txn)   /**< [in] Transaction to use (current one, if "NULL"). */
 {
     LOG4CPLUS_TRACE(logger, "[bdb::sequence::id] ENTER");
 
-    db_seq_t id;
-    int res = m_seq->get(m_seq, m_database->m_txns.top(), 1, &id, 0);
+    int64_t id;
+    int res = get(1, &id, txn);
 
     if (res != 0)
     {
@@ -153,7 +160,67 @@ int64_t sequence::id ()
 
     LOG4CPLUS_TRACE(logger, "[bdb::sequence::id] EXIT = " << id);
 
-    return (int64_t)id;
+    return id;
+}
+
+/**
+ * Generates a contiguous range of "n" unique identifiers and returns the first of them.
+ * For cached sequences "n" must not be greater than the cache size. Cached and autonomous sequences ignore specified transaction.
+ *
+ * @return 64-bit integer value.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+int64_t sequence::ids (int           n,     /**< [in] Number of identifiers to generate.           */
+                       transaction * txn)   /**< [in] Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::sequence::ids] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::sequence::ids] n = " << n);
+
+    int64_t id = 0;
+    int res = (n > 0 ? get(n, &id, txn) : EINVAL);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::sequence::ids] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::sequence::ids] EXIT = " << id);
+
+    return id;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Generates "delta" identifiers, returning the first of them.
+ * Cached and autonomous sequences are updated in their own auto-committed transactions (without flushing the log).
+ * Returns error code of Berkeley DB.
+ */
+int sequence::get (int           delta,     /**< [in]  Number of identifiers to generate.           */
+                   int64_t     * id,        /**< [out] First generated identifier.                  */
+                   transaction * txn)       /**< [in]  Transaction to use (current one, if "NULL"). */
+{
+    latency_scope latency(BDB_LATENCY_SEQUENCE);
+
+    db_seq_t value = 0;
+    int res;
+
+    if (m_autonomous)
+    {
+        res = m_seq->get(m_seq, NULL, delta, &value, DB_TXN_NOSYNC);
+    }
+    else
+    {
+        res = m_seq->get(m_seq, m_database->get_transaction(txn), delta, &value, 0);
+    }
+
+    *id = (int64_t) value;
+
+    return res;
 }
 
 }
@@ -0,0 +1,936 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/series.cc
+ * Contains implementation of class "bdb::series_table".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// Boost C++ Libraries
+#include <boost/thread/mutex.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::series_table".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::map;
+using std::string;
+using std::vector;
+
+/** @private Default size of buffered points, which triggers a flush, in bytes. */
+static const size_t SERIES_MEMORY = 4 * 1024 * 1024;
+
+/** @private Memory, which the buffer needs per block, besides its key and points (approximately). */
+static const size_t SERIES_BLOCK_OVERHEAD = 64;
+
+/** @private Size of key of block: identifier of series and start of the block (both big-endian). */
+static const size_t BLOCK_KEY_SIZE = 16;
+
+/** @private Marker of encoded block (so it's never taken for a compressed or versioned value). */
+static const unsigned char BLOCK_MARKER = 'G';
+
+/** @private Buffered points of series table. */
+class series_state
+{
+public:
+
+    series_state () : points(0), bytes(0) { }
+
+    boost::mutex                            mutex;      /**< Guards all the fields below.                         */
+    map <string, vector <series_point> >    blocks;     /**< Added points (in order of addition), by keys of blocks. */
+    size_t                                  points;     /**< Number of buffered points.                           */
+    size_t                                  bytes;      /**< Size of buffered points, in bytes.                   */
+};
+
+/**
+ * @private Returns mask of "count" lowest bits.
+ */
+static inline uint64_t low_mask (unsigned int count)    /**< [in] Number of bits (up to 64). */
+{
+    return (count >= 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << count) - 1);
+}
+
+/** @private Writer of bits, the highest bit of a byte first. */
+class bit_writer
+{
+public:
+
+    bit_writer (string * out) : m_out(out), m_acc(0), m_bits(0) { }
+
+    /** Writes "count" lowest bits of the value (up to 64), the highest first. */
+    void write (uint64_t value, unsigned int count)
+    {
+        if (count > 32)
+        {
+            write(value >> 32, count - 32);
+            count = 32;
+        }
+
+        m_acc   = (m_acc << count) | (value & low_mask(count));
+        m_bits += count;
+
+        while (m_bits >= 8)
+        {
+            m_bits -= 8;
+            m_out->push_back((char) (unsigned char) (m_acc >> m_bits));
+        }
+
+        m_acc &= low_mask(m_bits);
+    }
+
+    /** Writes the last incomplete byte, padded by zero bits. */
+    void finish ()
+    {
+        if (m_bits != 0) m_out->push_back((char) (unsigned char) (m_acc << (8 - m_bits)));
+
+        m_acc  = 0;
+        m_bits = 0;
+    }
+
+protected:
+
+    string       * m_out;   /**< Written bytes.                     */
+    uint64_t       m_acc;   /**< Bits, which are not written yet.   */
+    unsigned int   m_bits;  /**< Number of the bits (less than 8).  */
+};
+
+/** @private Reader of bits, written by "bit_writer", which refills its word by as many bytes as fit. */
+class bit_reader
+{
+public:
+
+    bit_reader (const unsigned char * data, size_t size) : m_pos(data), m_end(data + size), m_acc(0), m_bits(0), m_overrun(false) { }
+
+    /** Reads "count" bits (up to 64), the highest first. */
+    uint64_t read (unsigned int count)
+    {
+        if (count > 32)
+        {
+            uint64_t high = read(count - 32);
+            return (high << 32) | read(32);
+        }
+
+        if (m_bits < count)
+        {
+            while (m_bits <= 56 && m_pos < m_end)
+            {
+                m_acc   = (m_acc << 8) | *m_pos++;
+                m_bits += 8;
+            }
+
+            // bits beyond the end are zeros
+            while (m_bits < count)
+            {
+                m_acc   <<= 8;
+                m_bits   += 8;
+                m_overrun = true;
+            }
+        }
+
+        m_bits -= count;
+
+        uint64_t value = (m_acc >> m_bits) & low_mask(count);
+        m_acc &= low_mask(m_bits);
+
+        return value;
+    }
+
+    /** Returns whether bits beyond the end have been read. */
+    bool overrun () const { return m_overrun; }
+
+protected:
+
+    const unsigned char * m_pos;        /**< Next unread byte.                      */
+    const unsigned char * m_end;        /**< End of the bytes.                      */
+    uint64_t              m_acc;        /**< Read bytes, which bits are not taken.  */
+    unsigned int          m_bits;       /**< Number of the bits.                    */
+    bool                  m_overrun;    /**< Whether the end has been passed.       */
+};
+
+/**
+ * @private Returns number of leading zero bits of non-zero number.
+ */
+static unsigned int leading_zeros (uint64_t x)  /**< [in] Non-zero number. */
+{
+    unsigned int n = 0;
+
+    if ((x >> 32) == 0) { n += 32; x <<= 32; }
+    if ((x >> 48) == 0) { n += 16; x <<= 16; }
+    if ((x >> 56) == 0) { n += 8;  x <<= 8;  }
+    if ((x >> 60) == 0) { n += 4;  x <<= 4;  }
+    if ((x >> 62) == 0) { n += 2;  x <<= 2;  }
+    if ((x >> 63) == 0) { n += 1; }
+
+    return n;
+}
+
+/**
+ * @private Returns number of trailing zero bits of non-zero number.
+ */
+static unsigned int trailing_zeros (uint64_t x) /**< [in] Non-zero number. */
+{
+    unsigned int n = 0;
+
+    if ((x & low_mask(32)) == 0) { n += 32; x >>= 32; }
+    if ((x & low_mask(16)) == 0) { n += 16; x >>= 16; }
+    if ((x & low_mask(8))  == 0) { n += 8;  x >>= 8;  }
+    if ((x & low_mask(4))  == 0) { n += 4;  x >>= 4;  }
+    if ((x & low_mask(2))  == 0) { n += 2;  x >>= 2;  }
+    if ((x & 1) == 0)            { n += 1; }
+
+    return n;
+}
+
+/**
+ * @private Returns "count" bits of the value as a signed number.
+ */
+static inline int64_t signed_bits (uint64_t value, unsigned int count)
+{
+    return (value >= ((uint64_t) 1 << (count - 1)) ? (int64_t) value - ((int64_t) 1 << count) : (int64_t) value);
+}
+
+/** @private Returns bits of floating-point number. */
+static inline uint64_t double_bits (double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/** @private Returns floating-point number by its bits. */
+static inline double bits_double (uint64_t bits)
+{
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/** @private Order of points by their times. */
+static bool earlier (const series_point & p1, const series_point & p2)
+{
+    return p1.time < p2.time;
+}
+
+/** @private Whether the point precedes the time (see "std::lower_bound"). */
+static bool before_time (const series_point & p, int64_t time)
+{
+    return p.time < time;
+}
+
+/** @private Whether the time precedes the point (see "std::upper_bound"). */
+static bool after_time (int64_t time, const series_point & p)
+{
+    return time < p.time;
+}
+
+/**
+ * @private Sorts points by their times, leaving the last added point of each time.
+ */
+static void normalize (vector <series_point> * points)  /**< [in/out] Points in order of addition. */
+{
+    std::stable_sort(points->begin(), points->end(), earlier);
+
+    size_t n = 0;
+
+    for (size_t i = 0; i < points->size(); i++)
+    {
+        if (n != 0 && (*points)[n - 1].time == (*points)[i].time) n--;
+        (*points)[n++] = (*points)[i];
+    }
+
+    points->resize(n);
+}
+
+/**
+ * @private Merges two sorted lists of points, newer points replace older ones of the same time.
+ */
+static void merge_points (const vector <series_point> & older,  /**< [in]  Older points.  */
+                          const vector <series_point> & newer,  /**< [in]  Newer points.  */
+                          vector <series_point>       * result) /**< [out] Merged points. */
+{
+    result->clear();
+    result->reserve(older.size() + newer.size());
+
+    size_t i = 0, j = 0;
+
+    while (i < older.size() || j < newer.size())
+    {
+        if (j == newer.size() || (i < older.size() && older[i].time < newer[j].time))
+        {
+            result->push_back(older[i++]);
+        }
+        else
+        {
+            if (i < older.size() && older[i].time == newer[j].time) i++;
+            result->push_back(newer[j++]);
+        }
+    }
+}
+
+/**
+ * @private Writes 64-bit number in big-endian order.
+ */
+static void put_uint64 (uint64_t        value,  /**< [in]  Number.              */
+                        unsigned char * dest)   /**< [out] Buffer of 8 bytes.   */
+{
+    for (int i = 7; i >= 0; i--)
+    {
+        dest[i] = (unsigned char) value;
+        value >>= 8;
+    }
+}
+
+/**
+ * @private Makes key of block: identifier of series, and start of the block with flipped sign bit
+ * (so keys are sorted by Berkeley DB itself by series, and then by time, see "bdb::raw_key").
+ */
+static void block_key (uint64_t   series,   /**< [in]  Identifier of series.   */
+                       int64_t    start,    /**< [in]  Start of the block.     */
+                       string   * key)      /**< [out] Raw key of the block.   */
+{
+    unsigned char raw[BLOCK_KEY_SIZE];
+
+    put_uint64(series, raw);
+    put_uint64((uint64_t) start ^ ((uint64_t) 1 << 63), raw + 8);
+
+    key->assign((const char *) raw, sizeof(raw));
+}
+
+/**
+ * @private Returns start of the block, which contains specified time.
+ */
+static int64_t block_start (int64_t time,   /**< [in] Timestamp.          */
+                            int64_t width)  /**< [in] Width of blocks.    */
+{
+    int64_t rem = time % width;
+    if (rem < 0) rem += width;
+
+    return time - rem;
+}
+
+/**
+ * @private Encodes sorted points of a block: marker, varint number of points, then bits of the first time and
+ * value as is, and of other points - deltas of deltas of times ("0", "10" + 7 bits, "110" + 9 bits, "1110" +
+ * 12 bits, or "1111" + 64 bits), and XORs of values with previous ones ("0" - the same value, "10" + meaningful
+ * bits in the window of the previous XOR, or "11" + 5 bits of leading zeros, 6 bits of length, and the bits).
+ */
+static void encode_block (const vector <series_point> & points, /**< [in]  Sorted points.  */
+                          string                      * block)  /**< [out] Encoded block.  */
+{
+    block->clear();
+    block->push_back((char) BLOCK_MARKER);
+
+    uint64_t n = points.size();
+
+    do
+    {
+        unsigned char byte = (unsigned char) (n & 0x7F);
+        n >>= 7;
+        block->push_back((char) (n != 0 ? byte | 0x80 : byte));
+    }
+    while (n != 0);
+
+    if (points.empty()) return;
+
+    bit_writer out(block);
+
+    int64_t  prev_time  = points[0].time;
+    int64_t  prev_delta = 0;
+    uint64_t prev_bits  = double_bits(points[0].value);
+
+    out.write((uint64_t) prev_time, 64);
+    out.write(prev_bits, 64);
+
+    // window of meaningful bits of the previous XOR ("lead" is 65 - there is no window yet)
+    unsigned int lead  = 65;
+    unsigned int trail = 0;
+
+    for (size_t i = 1; i < points.size(); i++)
+    {
+        int64_t delta = points[i].time - prev_time;
+        int64_t dod   = delta - prev_delta;
+
+        if (dod == 0)                           { out.write(0, 1); }
+        else if (dod >= -64   && dod <= 63)     { out.write(2,  2); out.write((uint64_t) dod, 7);  }
+        else if (dod >= -256  && dod <= 255)    { out.write(6,  3); out.write((uint64_t) dod, 9);  }
+        else if (dod >= -2048 && dod <= 2047)   { out.write(14, 4); out.write((uint64_t) dod, 12); }
+        else                                    { out.write(15, 4); out.write((uint64_t) dod, 64); }
+
+        prev_time  = points[i].time;
+        prev_delta = delta;
+
+        uint64_t bits = double_bits(points[i].value);
+        uint64_t x    = bits ^ prev_bits;
+
+        prev_bits = bits;
+
+        if (x == 0)
+        {
+            out.write(0, 1);
+            continue;
+        }
+
+        unsigned int lz = leading_zeros(x);
+        unsigned int tz = trailing_zeros(x);
+
+        if (lz > 31) lz = 31;
+
+        if (lead <= 64 && lz >= lead && tz >= trail)
+        {
+            out.write(2, 2);
+            out.write(x >> trail, 64 - lead - trail);
+        }
+        else
+        {
+            unsigned int meaningful = 64 - lz - tz;
+
+            out.write(3, 2);
+            out.write(lz, 5);
+            out.write(meaningful - 1, 6);
+            out.write(x >> tz, meaningful);
+
+            lead  = lz;
+            trail = tz;
+        }
+    }
+
+    out.finish();
+}
+
+/**
+ * @private Decodes all points of a block (see "encode_block") in one pass.
+ *
+ * @return true  - the block is decoded.
+ * @return false - the block is malformed.
+ */
+static bool decode_block (const DBT             * block,    /**< [in]  Encoded block.    */
+                          vector <series_point> * points)   /**< [out] Sorted points.    */
+{
+    const unsigned char * pos = (const unsigned char *) block->data;
+    const unsigned char * end = pos + block->size;
+
+    points->clear();
+
+    if (pos == end || *pos++ != BLOCK_MARKER) return false;
+
+    uint64_t count = 0;
+
+    for (unsigned int shift = 0; ; shift += 7)
+    {
+        if (pos == end || shift > 63) return false;
+
+        count |= (uint64_t) (*pos & 0x7F) << shift;
+
+        if ((*pos++ & 0x80) == 0) break;
+    }
+
+    if (count == 0) return true;
+
+    // each point besides the first one takes two bits at least
+    if (count - 1 > (uint64_t) (end - pos) * 4) return false;
+
+    points->resize((size_t) count);
+
+    bit_reader in(pos, end - pos);
+
+    int64_t  time  = (int64_t) in.read(64);
+    int64_t  delta = 0;
+    uint64_t bits  = in.read(64);
+
+    (*points)[0].time  = time;
+    (*points)[0].value = bits_double(bits);
+
+    unsigned int lead  = 0;
+    unsigned int trail = 0;
+
+    for (size_t i = 1; i < points->size(); i++)
+    {
+        int64_t dod = 0;
+
+        if (in.read(1) != 0)
+        {
+            if (in.read(1) == 0)        dod = signed_bits(in.read(7), 7);
+            else if (in.read(1) == 0)   dod = signed_bits(in.read(9), 9);
+            else if (in.read(1) == 0)   dod = signed_bits(in.read(12), 12);
+            else                        dod = (int64_t) in.read(64);
+        }
+
+        delta += dod;
+        time  += delta;
+
+        if (in.read(1) != 0)
+        {
+            if (in.read(1) != 0)
+            {
+                lead = (unsigned int) in.read(5);
+
+                unsigned int meaningful = (unsigned int) in.read(6) + 1;
+                if (lead + meaningful > 64) return false;
+
+                trail = 64 - lead - meaningful;
+            }
+
+            bits ^= in.read(64 - lead - trail) << trail;
+        }
+
+        (*points)[i].time  = time;
+        (*points)[i].value = bits_double(bits);
+    }
+
+    return !in.overrun();
+}
+
+/**
+ * @private Merge function of blocks (see "bdb::merge_callback"): points of buffered block replace
+ * stored points of the same time.
+ */
+static bool merge_blocks (const DBT * data,     /**< [in]  Stored block ("NULL" - there is no block). */
+                          const DBT * delta,    /**< [in]  Block of buffered points.                   */
+                          string    * result,   /**< [out] Merged block.                               */
+                          void      *)
+{
+    if (data == NULL)
+    {
+        result->assign((const char *) delta->data, delta->size);
+        return true;
+    }
+
+    vector <series_point> older, newer, merged;
+
+    if (!decode_block(data, &older) || !decode_block(delta, &newer))
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::merge_blocks] Block of series is malformed.");
+        return false;
+    }
+
+    merge_points(older, newer, &merged);
+    encode_block(merged, result);
+
+    return true;
+}
+
+/**
+ * @private Makes "DBT" object, which references specified string.
+ */
+static void make_dbt (const string & from,  /**< [in]  Source string.       */
+                      DBT          * to)    /**< [out] Resulted "DBT" object. */
+{
+    memset(to, 0, sizeof(DBT));
+
+    to->data = (void *) from.data();
+    to->size = (u_int32_t) from.size();
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens underlying table of blocks in "BDB_KEY_RAW" format. Width of blocks defines keys of blocks,
+ * so it must be the same on each opening of the table.
+ * If "create" is "true" and table doesn't exist, then creates it.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the table is not found.
+ * @throw bdb::exception BDB_ERROR_EXISTS    - the table already exists.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+series_table::series_table (database            * db,       /**< [in] Database of the table.                                  */
+                            const char          * name,     /**< [in] Name of the table.                                      */
+                            bool                  create,   /**< [in] Whether to create the table if it doesn't exist.        */
+                            int64_t               width,    /**< [in] Width of blocks, in units of timestamps.                */
+                            const table_options & options,  /**< [in] Tuning options of the table.                            */
+                            size_t                memory)   /**< [in] Size of buffered points, which triggers a flush ("0" - default). */
+  : m_database(db),
+    m_table(NULL),
+    m_width(width > 0 ? width : 1),
+    m_memory(memory != 0 ? memory : SERIES_MEMORY),
+    m_state(NULL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::series_table::series_table] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::series_table::series_table] name = " << name);
+    LOG4CPLUS_DEBUG(logger, "[bdb::series_table::series_table] width = " << m_width << ", memory = " << m_memory);
+
+    table_options raw = options;
+    raw.key_format = BDB_KEY_RAW;
+
+    // the table is closed with its database
+    m_table = db->add_table(name, NULL, create, raw);
+
+    m_table->check_open();
+
+    m_state = new series_state;
+    assert(m_state != NULL);
+
+    // the buffer reserves its memory in the budget of the database
+    if (db->m_governor != NULL) db->m_governor->reserve((int64_t) m_memory);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::series_table::series_table] EXIT");
+}
+
+/**
+ * Flushes buffered points. Points, which cannot be flushed, are lost.
+ */
+series_table::~series_table () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::series_table::~series_table] ENTER");
+
+    {
+        boost::mutex::scoped_lock lock(m_state->mutex);
+
+        int res = write_blocks();
+
+        if (res != 0)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::series_table::~series_table] " << db_strerror(res) << ", " << m_state->points << " points are lost.");
+        }
+    }
+
+    delete m_state;
+
+    if (m_database->m_governor != NULL) m_database->m_governor->reserve(-(int64_t) m_memory);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::series_table::~series_table] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Buffers point of specified series, which is merged into its block by the next flush (it replaces stored
+ * point of the same time). When the buffer is full, flushes it.
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - deadlock, or lock is not granted (on flush).
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+void series_table::add (uint64_t series,    /**< [in] Identifier of the series.  */
+                        int64_t  time,      /**< [in] Timestamp of the point.    */
+                        double   value)     /**< [in] Value of the point.        */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::series_table::add] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::series_table::add] series = " << series << ", time = " << time);
+
+    string key;
+    block_key(series, block_start(time, m_width), &key);
+
+    series_point point = { time, value };
+
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    vector <series_point> & points = m_state->blocks[key];
+
+    if (points.empty()) m_state->bytes += key.size() + SERIES_BLOCK_OVERHEAD;
+
+    points.push_back(point);
+
+    m_state->points++;
+    m_state->bytes += sizeof(series_point);
+
+    int res = (m_state->bytes >= m_memory ? write_blocks() : 0);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::series_table::add] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::series_table::add] EXIT");
+}
+
+/**
+ * Merges all buffered points into their blocks in order of keys of the blocks, in one transaction
+ * (current one, if any). When an error occurs, the points stay buffered.
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+void series_table::flush ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::series_table::flush] ENTER");
+
+    boost::mutex::scoped_lock lock(m_state->mutex);
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::series_table::flush] size = " << m_state->points);
+
+    int res = write_blocks();
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::series_table::flush] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::series_table::flush] EXIT");
+}
+
+/**
+ * Reads points of specified series with times in range "[from, to]", in order of their times, decoding
+ * only blocks of the range, and taking buffered points into account. Returns number of read points.
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - a block is malformed, or unknown error.
+ */
+uint64_t series_table::range (uint64_t                series,   /**< [in]  Identifier of the series.            */
+                              int64_t                 from,     /**< [in]  The earliest time.                   */
+                              int64_t                 to,       /**< [in]  The latest time.                     */
+                              vector <series_point> * points,   /**< [out] Points, the earliest first.          */
+                              transaction           * txn)      /**< [in]  Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::series_table::range] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::series_table::range] series = " << series << ", from = " << from << ", to = " << to);
+
+    m_table->check_open();
+
+    points->clear();
+
+    if (from > to)
+    {
+        LOG4CPLUS_TRACE(logger, "[bdb::series_table::range] EXIT = 0");
+        return 0;
+    }
+
+    int res = read_blocks(m_database->get_transaction(txn), m_database->read_flags(txn), series, from, to, points);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::series_table::range] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    vector <series_point> buffered;
+
+    {
+        string low, high;
+
+        block_key(series, block_start(from, m_width), &low);
+        block_key(series, block_start(to,   m_width), &high);
+
+        boost::mutex::scoped_lock lock(m_state->mutex);
+
+        for (map <string, vector <series_point> >::const_iterator i = m_state->blocks.lower_bound(low);
+             i != m_state->blocks.end() && i->first <= high;
+             ++i)
+        {
+            for (size_t j = 0; j < i->second.size(); j++)
+            {
+                if (i->second[j].time >= from && i->second[j].time <= to) buffered.push_back(i->second[j]);
+            }
+        }
+    }
+
+    // buffered points replace stored points of the same time
+    if (!buffered.empty())
+    {
+        vector <series_point> merged;
+
+        normalize(&buffered);
+        merge_points(*points, buffered, &merged);
+
+        points->swap(merged);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::series_table::range] EXIT = " << points->size());
+
+    return points->size();
+}
+
+/**
+ * Returns number of buffered points.
+ */
+size_t series_table::size () const
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+    return m_state->points;
+}
+
+/**
+ * Returns underlying table of blocks (e.g. to get its statistics).
+ */
+table * series_table::get () const
+{
+    return m_table;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * @private Merges all buffered points into their blocks in one transaction (the buffer must be locked),
+ * and clears the buffer (see "bdb::table::merge_record"). Returns error code of Berkeley DB.
+ */
+int series_table::write_blocks ()
+{
+    if (m_state->blocks.empty()) return 0;
+
+    DB_TXN * txn = m_database->get_transaction();
+    DB_TXN * own = NULL;
+
+    int res = m_database->begin_auto(&txn, &own);
+
+    string block;
+
+    for (map <string, vector <series_point> >::iterator i = m_state->blocks.begin(); i != m_state->blocks.end() && res == 0; ++i)
+    {
+        normalize(&i->second);
+        encode_block(i->second, &block);
+
+        DBT k, d;
+
+        make_dbt(i->first, &k);
+        make_dbt(block, &d);
+
+        bool created = false;
+
+        res = m_table->merge_record(txn, &k, &d, merge_blocks, NULL, &created);
+    }
+
+    res = m_database->end_auto(own, res);
+
+    if (res == 0)
+    {
+        m_state->blocks.clear();
+        m_state->points = 0;
+        m_state->bytes  = 0;
+    }
+
+    return res;
+}
+
+/**
+ * @private Appends stored points of specified series with times in range "[from, to]" to the list, reading
+ * blocks of the range by a cursor. Returns error code of Berkeley DB ("EINVAL" - a block is malformed).
+ */
+int series_table::read_blocks (DB_TXN                * txn,     /**< [in]  Transaction to use.          */
+                               u_int32_t               flags,   /**< [in]  Flags of the cursor.         */
+                               uint64_t                series,  /**< [in]  Identifier of the series.    */
+                               int64_t                 from,    /**< [in]  The earliest time.           */
+                               int64_t                 to,      /**< [in]  The latest time.             */
+                               vector <series_point> * points)  /**< [out] Points, the earliest first.  */
+{
+    DB * db = m_table->m_db;
+
+    string low, high;
+
+    block_key(series, block_start(from, m_width), &low);
+    block_key(series, block_start(to,   m_width), &high);
+
+    unsigned char raw[BLOCK_KEY_SIZE];
+    memcpy(raw, low.data(), sizeof(raw));
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.data  = raw;
+    k.size  = sizeof(raw);
+    k.ulen  = sizeof(raw);
+    k.flags = DB_DBT_USERMEM;
+    d.flags = DB_DBT_REALLOC;
+
+    vector <series_point> block;
+
+    DBC * cursor = NULL;
+    int res = db->cursor(db, txn, &cursor, flags);
+
+    u_int32_t op = DB_SET_RANGE;
+
+    while (res == 0 && (res = cursor->get(cursor, &k, &d, op)) == 0)
+    {
+        op = DB_NEXT;
+
+        if (k.size != sizeof(raw) || memcmp(raw, high.data(), sizeof(raw)) > 0) break;
+
+        if (!decode_block(plain_value(&d), &block))
+        {
+            res = EINVAL;
+            break;
+        }
+
+        // points of a block are sorted, so points of the range are found by binary search
+        vector <series_point>::iterator first = std::lower_bound(block.begin(), block.end(), from, before_time);
+        vector <series_point>::iterator last  = std::upper_bound(first, block.end(), to, after_time);
+
+        points->insert(points->end(), first, last);
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    free(d.data);
+
+    return res;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
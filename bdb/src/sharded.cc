@@ -0,0 +1,322 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/sharded.cc
+ * Contains implementation of classes "bdb::sharded_table" and "bdb::sharded_recordset".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cassert>
+#include <vector>
+
+// Protocol Buffers
+#include <google/protobuf/message.h>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::sharded_table".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::vector;
+
+using google::protobuf::Message;
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens the table of specified name in each database of the list (see "bdb::database::add_table").
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the list of databases is empty.
+ */
+sharded_table::sharded_table (const vector <database *> & shards,   /**< [in] Databases of the shards.                           */
+                              const char          * name,           /**< [in] Name of the table.                                 */
+                              compare_callback      fn_cmp,         /**< [in] Keys comparision function.                         */
+                              bool                  create,         /**< [in] Whether to create the tables if they don't exist.  */
+                              const table_options & options)        /**< [in] Tuning options of the tables.                      */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::sharded_table::sharded_table] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::sharded_table::sharded_table] name = " << name << ", shards = " << shards.size());
+
+    if (shards.empty())
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::sharded_table::sharded_table] No databases of shards are specified.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    for (size_t i = 0; i < shards.size(); i++)
+    {
+        m_shards.push_back(shards[i]->add_table(name, fn_cmp, create, options));
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::sharded_table::sharded_table] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Checks whether the record with specified key exists in its shard.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+bool sharded_table::exists (const Message * key)    /**< [in] Key of the record. */
+{
+    return m_shards[shard_of(key)]->exists(key);
+}
+
+/**
+ * Removes the record with specified key from its shard.
+ *
+ * @throw bdb::exception BDB_ERROR_NOTFOUND - record is not found.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+void sharded_table::remove (const Message * key)    /**< [in] Key of the record. */
+{
+    m_shards[shard_of(key)]->remove(key);
+}
+
+/**
+ * Inserts new record into the shard of its key.
+ *
+ * @throw bdb::exception BDB_ERROR_KEYEXIST - record with the same key already exists.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+void sharded_table::insert (const Message * key,    /**< [in] Key of new record.  */
+                            const Message * data)   /**< [in] Data of new record. */
+{
+    m_shards[shard_of(key)]->insert(key, data);
+}
+
+/**
+ * Updates the record with specified key in its shard.
+ *
+ * @throw bdb::exception BDB_ERROR_NOTFOUND - record is not found.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+void sharded_table::update (const Message * key,    /**< [in] Key of the record.  */
+                            const Message * data)   /**< [in] New data of record. */
+{
+    m_shards[shard_of(key)]->update(key, data);
+}
+
+/**
+ * Inserts new record into the shard of its key, or updates existing one (see "bdb::table::upsert").
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return true  - new record is inserted.
+ * @return false - existing record is updated.
+ */
+bool sharded_table::upsert (const Message * key,    /**< [in] Key of the record.  */
+                            const Message * data)   /**< [in] Data of the record. */
+{
+    return m_shards[shard_of(key)]->upsert(key, data);
+}
+
+/**
+ * Selects the record with specified key from its shard.
+ *
+ * @throw bdb::exception BDB_ERROR_NOTFOUND - record is not found.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+void sharded_table::select (const Message * key,    /**< [in]  Key of the record.       */
+                            Message       * data)   /**< [out] Data of found record.    */
+{
+    m_shards[shard_of(key)]->select(key, data);
+}
+
+/**
+ * Returns total number of records in all shards (see "bdb::table::count").
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+unsigned int sharded_table::count (bool fast)   /**< [in] Whether to return possibly stale count, not traversing the tables. */
+{
+    unsigned int total = 0;
+
+    for (size_t i = 0; i < m_shards.size(); i++)
+    {
+        total += m_shards[i]->count(fast);
+    }
+
+    return total;
+}
+
+/**
+ * Returns position of the shard of specified key in the list of databases (FNV-1a hash of serialized key),
+ * e.g. to change the record in a transaction of the shard database, using the table of the shard.
+ */
+size_t sharded_table::shard_of (const Message * key)    /**< [in] Key of a record. */
+{
+    if (m_shards.size() == 1) return 0;
+
+    DBT k;
+    m_shards[0]->encode_key(key, &k);
+
+    const unsigned char * p = (const unsigned char *) k.data;
+
+    uint32_t hash = 2166136261U;
+
+    for (u_int32_t i = 0; i < k.size; i++)
+    {
+        hash = (hash ^ p[i]) * 16777619U;
+    }
+
+    release(&k);
+
+    return hash % m_shards.size();
+}
+
+/**
+ * Returns number of shards.
+ */
+size_t sharded_table::size () const
+{
+    return m_shards.size();
+}
+
+/**
+ * Returns table of specified shard.
+ */
+table * sharded_table::shard (size_t n)     /**< [in] Position of the shard in the list of databases. */
+{
+    assert(n < m_shards.size());
+    return m_shards[n];
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::sharded_recordset".
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens recordsets of all shards of the table (in implicit transactions of their databases),
+ * and merges them (see "bdb::merged_recordset").
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+sharded_recordset::sharded_recordset (sharded_table * tbl,          /**< [in] Sharded table.                           */
+                                      bool            prefetch)     /**< [in] Whether to read ahead records of shards. */
+  : merged_recordset(open_shards(tbl), prefetch)
+{
+}
+
+/**
+ * Closes recordsets of the shards.
+ */
+sharded_recordset::~sharded_recordset () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::sharded_recordset::~sharded_recordset] ENTER");
+
+    // prefetching threads use the recordsets
+    stop();
+
+    for (size_t i = 0; i < m_list.size(); i++)
+    {
+        delete m_list[i];
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::sharded_recordset::~sharded_recordset] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Enables bulk mode of recordsets of all the shards (see "bdb::recordset::set_bulk"),
+ * and rewinds the recordset.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void sharded_recordset::set_bulk (unsigned int size)    /**< [in] Size of bulk buffer of each shard, in bytes ("0" - disable bulk mode). */
+{
+    stop();
+
+    for (size_t i = 0; i < m_list.size(); i++)
+    {
+        m_list[i]->set_bulk(size);
+    }
+
+    rewind();
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens recordsets of all shards of specified table.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+joinlist sharded_recordset::open_shards (sharded_table * tbl)  /**< [in] Sharded table. */
+{
+    joinlist list;
+
+    try
+    {
+        for (size_t i = 0; i < tbl->m_shards.size(); i++)
+        {
+            list.push_back(new recordset(tbl->m_shards[i]));
+        }
+    }
+    catch (...)
+    {
+        for (size_t i = 0; i < list.size(); i++)
+        {
+            delete list[i];
+        }
+
+        throw;
+    }
+
+    return list;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,412 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+
+/** @file bdb/src/sketch.cc
+ * Contains implementation of sketches of distinct keys of class "bdb::index".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Boost C++ Libraries
+#include <boost/thread/mutex.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::key_sketch".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::string;
+using std::vector;
+
+/** @private Number of bits of hash, which select a register of sketch (standard error is about 1.6%). */
+static const unsigned int SKETCH_PRECISION = 12;
+
+/** @private Number of registers of sketch. */
+static const size_t SKETCH_REGISTERS = (size_t) 1 << SKETCH_PRECISION;
+
+/**
+ * @private HyperLogLog sketch of distinct keys of index. Each key is hashed, and a register, selected by
+ * the first bits of the hash, keeps the longest run of leading zeros in the rest of bits among its keys.
+ * Keys are never removed from the sketch, so it's rebuilt by a pass over the index to forget removed keys.
+ */
+class key_sketch
+{
+public:
+
+    key_sketch () : registers(SKETCH_REGISTERS, 0), removed(0) { }
+
+    /**
+     * Returns 64-bit hash of serialized key (FNV-1a, with bits mixed by finalizer of MurmurHash3).
+     */
+    static uint64_t hash (const DBT * key)
+    {
+        const unsigned char * p = (const unsigned char *) key->data;
+
+        uint64_t h = 14695981039346656037ULL;
+
+        for (u_int32_t i = 0; i < key->size; i++)
+        {
+            h = (h ^ p[i]) * 1099511628211ULL;
+        }
+
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+
+        return h;
+    }
+
+    /**
+     * Adds specified key to the sketch.
+     */
+    void add (const DBT * key)
+    {
+        uint64_t h = hash(key);
+
+        size_t   reg  = (size_t) (h >> (64 - SKETCH_PRECISION));
+        uint64_t rest = h << SKETCH_PRECISION;
+
+        unsigned char rank = 1;
+
+        while (rank <= 64 - SKETCH_PRECISION && (rest & ((uint64_t) 1 << 63)) == 0)
+        {
+            rest <<= 1;
+            rank++;
+        }
+
+        boost::mutex::scoped_lock lock(mutex);
+
+        if (registers[reg] < rank) registers[reg] = rank;
+    }
+
+    /**
+     * Returns estimated number of distinct keys, added to the sketch (with correction of small numbers by linear counting).
+     */
+    uint64_t estimate ()
+    {
+        boost::mutex::scoped_lock lock(mutex);
+
+        double m     = (double) SKETCH_REGISTERS;
+        double sum   = 0.0;
+        size_t zeros = 0;
+
+        for (size_t i = 0; i < SKETCH_REGISTERS; i++)
+        {
+            sum += ldexp(1.0, -registers[i]);
+            if (registers[i] == 0) zeros++;
+        }
+
+        double e = 0.7213 / (1.0 + 1.079 / m) * m * m / sum;
+
+        if (e <= 2.5 * m && zeros != 0) e = m * log(m / (double) zeros);
+
+        return (uint64_t) (e + 0.5);
+    }
+
+    boost::mutex            mutex;      /**< Guards the registers.                                          */
+    vector <unsigned char>  registers;  /**< Longest runs of leading zeros of hashes of keys by registers. */
+    uint64_t                removed;    /**< Number of removed records of the master table, when the sketch was built. */
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface of class "bdb::index".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns estimated number of distinct keys of the index by its sketch (see "bdb::table_options::distinct_sketch"),
+ * which is kept up to date on inserts and updates of records. Keys of removed records stay in the sketch,
+ * so if "staleness" is not zero, the sketch is rebuilt first, when more than specified part of estimated
+ * number of keys (e.g. "0.1") has been removed by this process since the sketch was built. Updates, which
+ * change keys, are not counted. Index without sketch counts its distinct keys by a pass over them.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+uint64_t index::estimate_distinct (double staleness)    /**< [in] Allowed part of removed keys ("0" - never rebuild). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::index::estimate_distinct] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::index::estimate_distinct] staleness = " << staleness);
+
+    if (m_sketch == NULL)
+    {
+        vector <string> keys;
+        uint64_t count = distinct_keys(&keys);
+
+        LOG4CPLUS_TRACE(logger, "[bdb::index::estimate_distinct] EXIT = " << count << " (exact)");
+        return count;
+    }
+
+    uint64_t estimate = m_sketch->estimate();
+
+    if (staleness > 0.0 && (double) (m_master->m_removed - m_sketch->removed) > staleness * (double) estimate)
+    {
+        rebuild_sketch();
+        estimate = m_sketch->estimate();
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::index::estimate_distinct] EXIT = " << estimate);
+
+    return estimate;
+}
+
+/**
+ * Rebuilds sketch of distinct keys of the index by a pass over its keys (so keys of removed records are
+ * forgotten), and persists it in the database. Does nothing if the index has no sketch.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void index::rebuild_sketch ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::index::rebuild_sketch] ENTER");
+
+    if (m_sketch != NULL)
+    {
+        key_sketch sketch;
+
+        sketch.removed = m_master->m_removed;
+
+        int res = scan_sketch(&sketch);
+
+        if (res == 0)
+        {
+            boost::mutex::scoped_lock lock(m_sketch->mutex);
+
+            // keys of records, inserted behind the cursor during the pass, may be missed until the next rebuild
+            m_sketch->registers.swap(sketch.registers);
+            m_sketch->removed = sketch.removed;
+        }
+
+        if (res == 0) res = save_sketch();
+
+        if (res != 0)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::index::rebuild_sketch] " << db_strerror(res));
+            throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::index::rebuild_sketch] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Private interface of class "bdb::index".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * @private Loads persisted sketch of distinct keys of the index, or builds it by a pass over the keys,
+ * if the index has no valid persisted sketch yet (e.g. it has just been created).
+ */
+int index::open_sketch ()
+{
+    key_sketch * sketch = new key_sketch;
+    assert(sketch != NULL);
+
+    sketch->removed = m_master->m_removed;
+
+    bool loaded = false;
+
+    if (m_database->open_histograms() == 0)
+    {
+        string name = get_filename();
+
+        DBT k, d;
+
+        memset(&k, 0, sizeof(k));
+        memset(&d, 0, sizeof(d));
+
+        k.data  = (void *) name.data();
+        k.size  = (u_int32_t) name.size();
+        d.flags = DB_DBT_MALLOC;
+
+        if (m_database->m_histograms->get(m_database->m_histograms, NULL, &k, &d, 0) == 0)
+        {
+            const unsigned char * p = (const unsigned char *) d.data;
+
+            // the first byte is precision of the sketch
+            if (d.size == SKETCH_REGISTERS + 1 && p[0] == SKETCH_PRECISION)
+            {
+                sketch->registers.assign(p + 1, p + d.size);
+                loaded = true;
+            }
+
+            free(d.data);
+        }
+    }
+
+    int res = (loaded ? 0 : scan_sketch(sketch));
+
+    if (res != 0)
+    {
+        delete sketch;
+        return res;
+    }
+
+    m_sketch = sketch;
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::index::open_sketch] loaded = " << loaded);
+
+    return 0;
+}
+
+/**
+ * @private Adds all distinct keys of the index to specified sketch ("DB_NEXT_NODUP", primary keys are not read).
+ */
+int index::scan_sketch (key_sketch * sketch)   /**< [in] Sketch to build. */
+{
+    DBC * cursor = NULL;
+
+    int res = m_plain->cursor(m_plain, m_database->get_transaction(), &cursor, m_database->read_flags());
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.flags = DB_DBT_REALLOC;
+    d.flags = DB_DBT_PARTIAL;
+
+    while (res == 0 && (res = cursor->get(cursor, &k, &d, DB_NEXT_NODUP)) == 0)
+    {
+        sketch->add(&k);
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    free(k.data);
+
+    if (cursor != NULL)
+    {
+        cursor->close(cursor);
+    }
+
+    return res;
+}
+
+/**
+ * @private Persists sketch of distinct keys of the index into database of statistics of the database.
+ */
+int index::save_sketch ()
+{
+    int res = m_database->open_histograms();
+    if (res != 0) return res;
+
+    string name = get_filename();
+    string buf(1, (char) SKETCH_PRECISION);
+
+    {
+        boost::mutex::scoped_lock lock(m_sketch->mutex);
+        buf.append(m_sketch->registers.begin(), m_sketch->registers.end());
+    }
+
+    DBT k, d;
+
+    memset(&k, 0, sizeof(k));
+    memset(&d, 0, sizeof(d));
+
+    k.data = (void *) name.data();
+    k.size = (u_int32_t) name.size();
+    d.data = (void *) buf.data();
+    d.size = (u_int32_t) buf.size();
+
+    return m_database->m_histograms->put(m_database->m_histograms, NULL, &k, &d, 0);
+}
+
+/**
+ * @private Persists sketch of distinct keys of the index (failure just makes the next opening rebuild it),
+ * and destroys the sketch.
+ */
+void index::close_sketch ()
+{
+    if (m_sketch == NULL) return;
+
+    int res = save_sketch();
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::index::close_sketch] " << db_strerror(res));
+    }
+
+    delete m_sketch;
+    m_sketch = NULL;
+}
+
+/**
+ * @private Trampoline of indexing function of index with sketch of distinct keys, which adds keys
+ * of the record (one or several) to the sketch.
+ */
+int index::index_sketched (DB        * sec,     /**< [in]  Database of the index.    */
+                           const DBT * key,     /**< [in]  Primary key.              */
+                           const DBT * data,    /**< [in]  Serialized primary data.  */
+                           DBT       * result)  /**< [out] Serialized index key(s).  */
+{
+    index * idx = (index *) sec->app_private;
+
+    int res = (idx->m_master->m_counters != NULL ? index_profiled(sec, key, data, result) : idx->m_indexer(sec, key, data, result));
+
+    if (res == 0 && idx->m_sketch != NULL)
+    {
+        if ((result->flags & DB_DBT_MULTIPLE) != 0)
+        {
+            const DBT * keys = (const DBT *) result->data;
+
+            for (u_int32_t i = 0; i < result->size; i++)
+            {
+                idx->m_sketch->add(&keys[i]);
+            }
+        }
+        else
+        {
+            idx->m_sketch->add(result);
+        }
+    }
+
+    return res;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
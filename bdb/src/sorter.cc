@@ -0,0 +1,721 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/sorter.cc
+ * Contains implementation of class "bdb::external_sorter".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <queue>
+#include <vector>
+
+// Boost C++ Libraries
+#include <boost/thread/mutex.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::external_sorter".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::priority_queue;
+using std::vector;
+
+/** @private Size of blocks of sorted runs (before compression), in bytes. */
+static const size_t SORT_BLOCK_SIZE = 256 * 1024;
+
+/** @private Maximum number of buffers, which are filled and spilled at once. */
+static const unsigned int SORT_MAX_BUFFERS = 4;
+
+/** @private Size of header of a record in buffers and blocks (sizes of key and data). */
+static const size_t SORT_RECORD_HEADER = 2 * sizeof(u_int32_t);
+
+/** @private Size of header of a block in files of runs (original and stored sizes). */
+static const size_t SORT_BLOCK_HEADER = 2 * sizeof(u_int32_t);
+
+/**
+ * @private Parses serialized record at specified position of a buffer.
+ * Returns position of the next record.
+ */
+static size_t parse_record (const vector <char> & bytes,    /**< [in]  Buffer of records.   */
+                            size_t                pos,      /**< [in]  Position of the record. */
+                            DBT                 * key,      /**< [out] Key of the record.   */
+                            DBT                 * data)     /**< [out] Data of the record.  */
+{
+    u_int32_t sizes[2];
+    memcpy(sizes, &bytes[pos], sizeof(sizes));
+
+    memset(key,  0, sizeof(DBT));
+    memset(data, 0, sizeof(DBT));
+
+    key->data  = (void *) &bytes[pos + SORT_RECORD_HEADER];
+    key->size  = sizes[0];
+    data->data = (void *) &bytes[pos + SORT_RECORD_HEADER + sizes[0]];
+    data->size = sizes[1];
+
+    return pos + SORT_RECORD_HEADER + sizes[0] + sizes[1];
+}
+
+/**
+ * @private Appends specified record to a buffer of records.
+ */
+static void append_record (vector <char> & bytes,   /**< [in/out] Buffer of records. */
+                           const DBT     * key,     /**< [in]     Key of the record.  */
+                           const DBT     * data)    /**< [in]     Data of the record. */
+{
+    u_int32_t sizes[2] = { key->size, data->size };
+
+    size_t pos = bytes.size();
+    bytes.resize(pos + SORT_RECORD_HEADER + key->size + data->size);
+
+    memcpy(&bytes[pos], sizes, sizeof(sizes));
+    if (key->size  != 0) memcpy(&bytes[pos + SORT_RECORD_HEADER], key->data, key->size);
+    if (data->size != 0) memcpy(&bytes[pos + SORT_RECORD_HEADER + key->size], data->data, data->size);
+}
+
+/** @private Buffer of added records, which are sorted in memory. */
+class sort_buffer
+{
+public:
+
+    sort_buffer (size_t limit) { bytes.reserve(limit); }
+
+    vector <char>   bytes;      /**< Serialized records.                    */
+    vector <size_t> offsets;    /**< Positions of records (in sorted order, once sorted). */
+
+    /** Returns memory, taken by the records. */
+    size_t memory () const { return bytes.size() + offsets.size() * sizeof(size_t); }
+};
+
+/** @private Order of records of sort buffer, by their positions. */
+class sort_order
+{
+public:
+
+    sort_order (table * tbl, const vector <char> & bytes)
+      : m_table(tbl),
+        m_bytes(bytes)
+    { }
+
+    bool operator () (size_t pos1, size_t pos2) const
+    {
+        DBT k1, k2, d;
+
+        parse_record(m_bytes, pos1, &k1, &d);
+        parse_record(m_bytes, pos2, &k2, &d);
+
+        return m_table->compare_keys(&k1, &k2) < 0;
+    }
+
+protected:
+
+    table               * m_table;
+    const vector <char> & m_bytes;
+};
+
+/** @private Sorted run of records in temporary file, which is written and read by blocks. */
+class sort_run
+{
+public:
+
+    sort_run (const value_codec * run_codec)
+      : file(NULL),
+        codec(run_codec),
+        pos(0)
+    {
+        memset(&key,  0, sizeof(key));
+        memset(&data, 0, sizeof(data));
+    }
+
+    ~sort_run ()
+    {
+        if (file != NULL) fclose(file);
+    }
+
+    FILE                * file;     /**< Temporary file (removed on closing).       */
+    const value_codec   * codec;    /**< Codec of blocks ("NULL" - not compressed). */
+    vector <char>         block;    /**< Current block (being written or read).     */
+    vector <char>         packed;   /**< Compressed block.                          */
+    size_t                pos;      /**< Position of the next record in current block. */
+    DBT                   key;      /**< Key of current record (references the block).  */
+    DBT                   data;     /**< Data of current record (references the block). */
+
+    /** Creates the file. */
+    int open ()
+    {
+        errno = 0;
+        file  = tmpfile();
+
+        return (file != NULL ? 0 : (errno != 0 ? errno : EIO));
+    }
+
+    /** Appends specified record to the run. */
+    int write (const DBT * k, const DBT * d)
+    {
+        append_record(block, k, d);
+        return (block.size() >= SORT_BLOCK_SIZE ? flush() : 0);
+    }
+
+    /** Writes current block into the file (compressed, if it's smaller then). */
+    int flush ()
+    {
+        if (block.empty()) return 0;
+
+        u_int32_t sizes[2] = { (u_int32_t) block.size(), (u_int32_t) block.size() };
+        const char * stored = &block[0];
+
+        if (codec != NULL && codec->fn_compress != NULL && block.size() >= codec->threshold)
+        {
+            packed.resize(block.size());
+
+            size_t size = codec->fn_compress(&block[0], block.size(), &packed[0], packed.size() - 1);
+
+            if (size != 0)
+            {
+                sizes[1] = (u_int32_t) size;
+                stored   = &packed[0];
+            }
+        }
+
+        if (fwrite(sizes, sizeof(sizes), 1, file) != 1) return EIO;
+        if (fwrite(stored, sizes[1], 1, file) != 1)     return EIO;
+
+        block.clear();
+
+        return 0;
+    }
+
+    /** Prepares written run for reading from the beginning. */
+    int rewind ()
+    {
+        int res = flush();
+
+        if (res == 0 && fflush(file) != 0) res = EIO;
+        if (res == 0) ::rewind(file);
+
+        block.clear();
+        pos = 0;
+
+        return res;
+    }
+
+    /** Reads next record of the run into current one ("DB_NOTFOUND" at the end of the run). */
+    int next ()
+    {
+        if (pos >= block.size())
+        {
+            int res = read_block();
+            if (res != 0) return res;
+        }
+
+        pos = parse_record(block, pos, &key, &data);
+
+        return 0;
+    }
+
+protected:
+
+    /** Reads next block of the file. */
+    int read_block ()
+    {
+        u_int32_t sizes[2];
+
+        if (fread(sizes, sizeof(sizes), 1, file) != 1) return (feof(file) ? DB_NOTFOUND : EIO);
+
+        block.resize(sizes[0]);
+        pos = 0;
+
+        if (sizes[1] == sizes[0])
+        {
+            return (fread(&block[0], sizes[1], 1, file) == 1 ? 0 : EIO);
+        }
+
+        packed.resize(sizes[1]);
+
+        if (fread(&packed[0], sizes[1], 1, file) != 1) return EIO;
+
+        if (codec == NULL || codec->fn_decompress == NULL ||
+            !codec->fn_decompress(&packed[0], sizes[1], &block[0], sizes[0]))
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::sort_run::read_block] Block of sorted run cannot be decompressed.");
+            return EIO;
+        }
+
+        return 0;
+    }
+};
+
+/** @private Reverse order of runs by their current records (so the least one is on top of the heap). */
+class sort_greater
+{
+public:
+
+    sort_greater (table * tbl)
+      : m_table(tbl)
+    { }
+
+    bool operator () (const sort_run * r1, const sort_run * r2) const
+    {
+        return m_table->compare_keys(&r1->key, &r2->key) > 0;
+    }
+
+protected:
+
+    table * m_table;
+};
+
+/** @private K-way merge of sorted runs. */
+class sort_merge
+{
+public:
+
+    sort_merge (table * tbl)
+      : heap((sort_greater(tbl))),
+        last(NULL)
+    { }
+
+    priority_queue <sort_run*, vector <sort_run*>, sort_greater> heap;  /**< Runs by their current records. */
+    sort_run * last;    /**< Run of the last returned record ("NULL" if none). */
+
+    /** Starts merge of specified runs. */
+    int start (const vector <sort_run*> & runs, size_t first, size_t count)
+    {
+        int res = 0;
+
+        for (size_t i = first; i < first + count && res == 0; i++)
+        {
+            res = runs[i]->rewind();
+
+            if (res == 0) res = runs[i]->next();
+            if (res == 0) heap.push(runs[i]);
+            if (res == DB_NOTFOUND) res = 0;
+        }
+
+        return res;
+    }
+
+    /** Returns the next record in order ("DB_NOTFOUND" at the end). */
+    int next (DBT * key, DBT * data)
+    {
+        if (last != NULL)
+        {
+            int res = last->next();
+
+            if (res == 0) heap.push(last);
+            if (res != 0 && res != DB_NOTFOUND) return res;
+
+            last = NULL;
+        }
+
+        if (heap.empty()) return DB_NOTFOUND;
+
+        last = heap.top();
+        heap.pop();
+
+        *key  = last->key;
+        *data = last->data;
+
+        return 0;
+    }
+};
+
+/** @private State of external sort. */
+class sort_state
+{
+public:
+
+    sort_state ()
+      : tbl(NULL),
+        codec(NULL),
+        limit(0),
+        fanin(0),
+        buffers(0),
+        current(NULL),
+        group(NULL),
+        spilling(0),
+        error(0),
+        count(0),
+        finished(false),
+        index(0),
+        merge(NULL)
+    { }
+
+    table                 * tbl;        /**< Table, which orders the records.           */
+    const value_codec     * codec;      /**< Codec of blocks ("NULL" - not compressed). */
+    size_t                  limit;      /**< Memory of one buffer, in bytes.            */
+    size_t                  fanin;      /**< Maximum number of runs, merged at once.    */
+    unsigned int            buffers;    /**< Number of buffers (filled and spilled at once). */
+    sort_buffer           * current;    /**< Buffer being filled.                       */
+    vector <sort_run*>      runs;       /**< Spilled runs.                              */
+    task_group            * group;      /**< Tasks of spilling.                         */
+    boost::mutex            mutex;      /**< Mutex of the runs and the error.           */
+    unsigned int            spilling;   /**< Number of buffers being spilled.           */
+    int                     error;      /**< First error of spilling ("0" - none).      */
+    uint64_t                count;      /**< Number of added records.                   */
+    bool                    finished;   /**< Whether all records are added.             */
+    size_t                  index;      /**< Next record of sorted buffer (if there are no runs). */
+    sort_merge            * merge;      /**< Merge of the runs ("NULL" if there are no runs). */
+};
+
+/** @private Spilling of a full buffer in the work pool. */
+class spill_task
+{
+public:
+
+    sort_state  * state;    /**< State of the sort.   */
+    sort_buffer * buffer;   /**< Buffer to be spilled. */
+};
+
+/**
+ * @private Sorts specified buffer in memory.
+ */
+static void sort_records (sort_state  * state,      /**< [in]     State of the sort. */
+                          sort_buffer * buffer)     /**< [in/out] Sorted buffer.     */
+{
+    std::sort(buffer->offsets.begin(), buffer->offsets.end(), sort_order(state->tbl, buffer->bytes));
+}
+
+/**
+ * @private Sorts specified buffer, and writes it into new run.
+ * Returns error code of the system.
+ */
+static int spill_buffer (sort_state  * state,   /**< [in] State of the sort.   */
+                         sort_buffer * buffer)  /**< [in] Buffer to be spilled. */
+{
+    sort_records(state, buffer);
+
+    sort_run * run = new sort_run(state->codec);
+    assert(run != NULL);
+
+    int res = run->open();
+
+    for (size_t i = 0; i < buffer->offsets.size() && res == 0; i++)
+    {
+        DBT k, d;
+
+        parse_record(buffer->bytes, buffer->offsets[i], &k, &d);
+        res = run->write(&k, &d);
+    }
+
+    if (res == 0) res = run->flush();
+
+    boost::mutex::scoped_lock lock(state->mutex);
+
+    if (res == 0)
+    {
+        state->runs.push_back(run);
+    }
+    else
+    {
+        delete run;
+        if (state->error == 0) state->error = res;
+    }
+
+    return res;
+}
+
+/**
+ * @private Spills a buffer as task of the work pool.
+ */
+static void run_spill (void * param)    /**< [in] Spilling task ("bdb::spill_task"). */
+{
+    spill_task * task = (spill_task *) param;
+
+    spill_buffer(task->state, task->buffer);
+
+    delete task->buffer;
+
+    {
+        boost::mutex::scoped_lock lock(task->state->mutex);
+        task->state->spilling--;
+    }
+
+    delete task;
+}
+
+/**
+ * @private Merges runs, until they can be merged at once (each merged run needs its own block in memory).
+ * Returns error code of the system.
+ */
+static int reduce_runs (sort_state * state)     /**< [in] State of the sort. */
+{
+    vector <sort_run*> & runs = state->runs;
+
+    int res = 0;
+
+    while (runs.size() > state->fanin && res == 0)
+    {
+        LOG4CPLUS_DEBUG(logger, "[bdb::external_sorter::finish] runs = " << runs.size());
+
+        sort_run * run = new sort_run(state->codec);
+        assert(run != NULL);
+
+        res = run->open();
+
+        {
+            sort_merge merge(state->tbl);
+
+            if (res == 0) res = merge.start(runs, 0, state->fanin);
+
+            DBT k, d;
+
+            while (res == 0 && (res = merge.next(&k, &d)) == 0)
+            {
+                res = run->write(&k, &d);
+            }
+
+            if (res == DB_NOTFOUND) res = 0;
+        }
+
+        if (res == 0) res = run->flush();
+
+        if (res != 0)
+        {
+            delete run;
+            break;
+        }
+
+        for (size_t i = 0; i < state->fanin; i++)
+        {
+            delete runs[i];
+        }
+
+        runs.erase(runs.begin(), runs.begin() + state->fanin);
+        runs.push_back(run);
+    }
+
+    return res;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Creates empty sort of records in order of keys of specified table.
+ * The memory is shared by buffers, which are filled and spilled at once (up to one per worker of the pool),
+ * and bounds number of runs, merged at once (runs are merged by several passes, if there are more).
+ */
+external_sorter::external_sorter (table             * tbl,      /**< [in] Table, which orders the records.            */
+                                  size_t              memory,   /**< [in] Memory budget, in bytes.                    */
+                                  const value_codec * codec)    /**< [in] Codec of spilled blocks ("NULL" - no compression). */
+  : m_state(new sort_state)
+{
+    assert(m_state != NULL);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::external_sorter::external_sorter] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::external_sorter::external_sorter] memory = " << memory);
+
+    work_pool * pool = tbl->m_database->m_pool;
+
+    m_state->tbl     = tbl;
+    m_state->codec   = codec;
+    m_state->buffers = std::min(pool->size() + 1, SORT_MAX_BUFFERS);
+    m_state->limit   = std::max(memory / m_state->buffers, SORT_BLOCK_SIZE);
+    m_state->fanin   = std::max(memory / (2 * SORT_BLOCK_SIZE), (size_t) 2);
+    m_state->current = new sort_buffer(m_state->limit);
+    m_state->group   = new task_group(pool);
+
+    assert(m_state->current != NULL);
+    assert(m_state->group   != NULL);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::external_sorter::external_sorter] EXIT");
+}
+
+/**
+ * Waits for spilling buffers, and removes all runs.
+ */
+external_sorter::~external_sorter () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::external_sorter::~external_sorter] ENTER");
+
+    delete m_state->group;
+    delete m_state->merge;
+    delete m_state->current;
+
+    for (size_t i = 0; i < m_state->runs.size(); i++)
+    {
+        delete m_state->runs[i];
+    }
+
+    delete m_state;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::external_sorter::~external_sorter] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds specified record to the sort. When current buffer is full, it's spilled in the work pool,
+ * and new buffer is filled meanwhile (waiting for spilling ones, if all buffers are taken).
+ * Returns error code of the system (e.g. of previous spilling).
+ */
+int external_sorter::add (const DBT * key,      /**< [in] Serialized key.  */
+                          const DBT * data)     /**< [in] Serialized data. */
+{
+    assert(!m_state->finished);
+
+    sort_buffer * buffer = m_state->current;
+
+    buffer->offsets.push_back(buffer->bytes.size());
+    append_record(buffer->bytes, key, data);
+
+    m_state->count++;
+
+    if (buffer->memory() < m_state->limit) return 0;
+
+    // all buffers are taken
+    bool full;
+
+    {
+        boost::mutex::scoped_lock lock(m_state->mutex);
+        full = (m_state->spilling + 1 >= m_state->buffers);
+    }
+
+    if (full) m_state->group->wait();
+
+    {
+        boost::mutex::scoped_lock lock(m_state->mutex);
+
+        if (m_state->error != 0) return m_state->error;
+
+        m_state->spilling++;
+    }
+
+    spill_task * task = new spill_task;
+    assert(task != NULL);
+
+    task->state  = m_state;
+    task->buffer = buffer;
+
+    m_state->current = new sort_buffer(m_state->limit);
+    assert(m_state->current != NULL);
+
+    m_state->group->run(run_spill, task);
+
+    return 0;
+}
+
+/**
+ * Completes adding of records: waits for spilling buffers, and prepares merge of the runs.
+ * If nothing is spilled, the records are sorted in memory.
+ * Returns error code of the system.
+ */
+int external_sorter::finish ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::external_sorter::finish] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::external_sorter::finish] records = " << m_state->count);
+
+    assert(!m_state->finished);
+
+    m_state->group->wait();
+    m_state->finished = true;
+
+    int res = m_state->error;
+
+    if (res == 0)
+    {
+        if (m_state->runs.empty())
+        {
+            sort_records(m_state, m_state->current);
+        }
+        else
+        {
+            if (!m_state->current->offsets.empty()) res = spill_buffer(m_state, m_state->current);
+
+            delete m_state->current;
+            m_state->current = NULL;
+
+            if (res == 0) res = reduce_runs(m_state);
+
+            m_state->merge = new sort_merge(m_state->tbl);
+            assert(m_state->merge != NULL);
+
+            if (res == 0) res = m_state->merge->start(m_state->runs, 0, m_state->runs.size());
+        }
+    }
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::external_sorter::finish] runs = " << m_state->runs.size());
+    LOG4CPLUS_TRACE(logger, "[bdb::external_sorter::finish] EXIT");
+
+    return res;
+}
+
+/**
+ * Returns the next record in order of keys ("DB_NOTFOUND" after the last one).
+ * The record is referenced till the next call.
+ * Returns error code of the system.
+ */
+int external_sorter::next (DBT * key,   /**< [out] Serialized key.  */
+                           DBT * data)  /**< [out] Serialized data. */
+{
+    assert(m_state->finished);
+
+    if (m_state->merge != NULL)
+    {
+        return m_state->merge->next(key, data);
+    }
+
+    sort_buffer * buffer = m_state->current;
+
+    if (buffer == NULL || m_state->index >= buffer->offsets.size()) return DB_NOTFOUND;
+
+    parse_record(buffer->bytes, buffer->offsets[m_state->index++], key, data);
+
+    return 0;
+}
+
+/**
+ * Returns number of added records.
+ */
+uint64_t external_sorter::size () const
+{
+    return m_state->count;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
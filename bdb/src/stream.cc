@@ -0,0 +1,382 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/stream.cc
+ * Contains implementation of class "bdb::value_stream".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// External files of large data are available since Berkeley DB 6.0
+#if (DB_VERSION_MAJOR >= 6)
+#define BDB_EXT_FILE
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::value_stream".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::vector;
+
+using google::protobuf::Message;
+using google::protobuf::int64;
+
+/** @private Default size of chunks, read by streams. */
+static const unsigned int STREAM_CHUNK_SIZE = 64 * 1024;
+
+/**
+ * @private Converts error code of Berkeley DB into code of "bdb::exception".
+ */
+static int stream_error (int res)
+{
+    switch (res)
+    {
+        case DB_NOTFOUND:           return BDB_ERROR_NOT_FOUND;
+        case DB_KEYEMPTY:           return BDB_ERROR_NOT_FOUND;
+        case DB_LOCK_DEADLOCK:      return BDB_ERROR_DEADLOCK;
+        case DB_LOCK_NOTGRANTED:    return BDB_ERROR_DEADLOCK;
+        default:                    return BDB_ERROR_UNKNOWN;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Locates the record with specified key and reads the first chunk of its data.
+ * Only one chunk is kept in memory at a time, unless the data are compressed (see "bdb::set_codec"),
+ * which are read and decompressed entirely. Data, stored in external file (see "bdb::table_options::blob_threshold"),
+ * are read by stream of the file, so their chunks never enter the cache.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the record is not found.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK  - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+value_stream::value_stream (table         * tbl,    /**< [in] Table of the record.                          */
+                            key_ref         key,    /**< [in] Key of the record.                            */
+                            transaction   * txn,    /**< [in] Transaction to use (current one, if "NULL").  */
+                            unsigned int    chunk)  /**< [in] Size of chunks in bytes ("0" - default).      */
+  : m_cursor(NULL),
+    m_stream(NULL),
+    m_length(0),
+    m_chunk(chunk == 0 ? STREAM_CHUNK_SIZE : chunk),
+    m_offset(0),
+    m_pos(0),
+    m_size(0),
+    m_count(0),
+    m_eof(false),
+    m_error(0)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::value_stream::value_stream] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::value_stream::value_stream] chunk = " << m_chunk.size());
+
+    tbl->check_open();
+
+    scratch_scope scope;
+    DBT k, d;
+
+    tbl->encode_key(key, &k, &scope);
+
+    memset(&d, 0, sizeof(DBT));
+    d.data  = &m_chunk[0];
+    d.ulen  = (u_int32_t) m_chunk.size();
+    d.dlen  = (u_int32_t) m_chunk.size();
+    d.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
+
+    // the cursor keeps the record locked, while its chunks are read
+    int res = tbl->m_db->cursor(tbl->m_db, tbl->m_database->get_transaction(txn), &m_cursor, tbl->m_database->read_flags(txn));
+
+    if (res == 0) res = m_cursor->get(m_cursor, &k, &d, DB_SET);
+
+    if (res == 0)
+    {
+        m_size   = d.size;
+        m_offset = d.size;
+        m_eof    = (d.size < m_chunk.size());
+    }
+
+    release(&k);
+
+#ifdef BDB_EXT_FILE
+
+    // data in pages have no stream, and are read by partial gets
+    if (res == 0 && !m_eof && tbl->m_options.blob_threshold != 0)
+    {
+        DB_STREAM * stream = NULL;
+
+        if (m_cursor->db_stream(m_cursor, &stream, DB_STREAM_READ) == 0)
+        {
+            db_off_t length = 0;
+
+            if (stream->size(stream, &length, 0) == 0)
+            {
+                m_stream = stream;
+                m_length = (uint64_t) length;
+            }
+            else
+            {
+                stream->close(stream, 0);
+            }
+        }
+    }
+
+#endif
+
+    // compressed data cannot be parsed by parts
+    if (res == 0 && m_size != 0 && m_chunk[0] == 0)
+    {
+        vector <char> packed(m_chunk.begin(), m_chunk.begin() + m_size);
+
+        while (res == 0 && !m_eof)
+        {
+            res = fill();
+            packed.insert(packed.end(), m_chunk.begin(), m_chunk.begin() + m_size);
+        }
+
+        if (res == 0)
+        {
+            DBT p;
+            memset(&p, 0, sizeof(DBT));
+            p.data = &packed[0];
+            p.size = (u_int32_t) packed.size();
+
+            const DBT * plain = plain_value(&p);
+
+            m_chunk.assign((const char *) plain->data, (const char *) plain->data + plain->size);
+            m_size = m_chunk.size();
+        }
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::value_stream::value_stream] " << db_strerror(res));
+
+#ifdef BDB_EXT_FILE
+        if (m_stream != NULL) ((DB_STREAM *) m_stream)->close((DB_STREAM *) m_stream, 0);
+#endif
+
+        if (m_cursor != NULL) m_cursor->close(m_cursor);
+
+        throw exception(stream_error(res));
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::value_stream::value_stream] EXIT");
+}
+
+/**
+ * Closes the stream, and releases the record.
+ */
+value_stream::~value_stream () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::value_stream::~value_stream] ENTER");
+
+#ifdef BDB_EXT_FILE
+    if (m_stream != NULL) ((DB_STREAM *) m_stream)->close((DB_STREAM *) m_stream, 0);
+#endif
+
+    m_cursor->close(m_cursor);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::value_stream::~value_stream] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns unread bytes of current chunk, reading the next chunk when current one is over
+ * (see "google::protobuf::io::ZeroCopyInputStream::Next").
+ *
+ * @return true  - the bytes are returned.
+ * @return false - the end of the data is reached, or an error occurred (see "bdb::value_stream::error").
+ */
+bool value_stream::Next (const void ** data,    /**< [out] Unread bytes.          */
+                         int         * size)    /**< [out] Number of the bytes.   */
+{
+    if (m_pos == m_size)
+    {
+        if (m_eof || m_error != 0) return false;
+
+        int res = fill();
+
+        if (res != 0)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::value_stream::Next] " << db_strerror(res));
+            m_error = stream_error(res);
+            return false;
+        }
+
+        if (m_size == 0) return false;
+    }
+
+    *data = &m_chunk[m_pos];
+    *size = (int) (m_size - m_pos);
+
+    m_count += m_size - m_pos;
+    m_pos    = m_size;
+
+    return true;
+}
+
+/**
+ * Returns specified number of bytes, returned by the last "Next", back to the stream.
+ */
+void value_stream::BackUp (int count)   /**< [in] Number of bytes. */
+{
+    m_pos   -= count;
+    m_count -= count;
+}
+
+/**
+ * Skips specified number of bytes.
+ *
+ * @return true  - the bytes are skipped.
+ * @return false - the end of the data is reached, or an error occurred.
+ */
+bool value_stream::Skip (int count)     /**< [in] Number of bytes. */
+{
+    while (count > 0)
+    {
+        const void * data;
+        int          size;
+
+        if (!Next(&data, &size)) return false;
+
+        if (size > count)
+        {
+            BackUp(size - count);
+            break;
+        }
+
+        count -= size;
+    }
+
+    return true;
+}
+
+/**
+ * Returns total number of bytes, read from the stream.
+ */
+int64 value_stream::ByteCount () const
+{
+    return m_count;
+}
+
+/**
+ * Returns error, occurred while the data were read (see @ref errcodes "codes"), or "0" if none.
+ */
+int value_stream::error () const
+{
+    return m_error;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Reads the next chunk of the data into the buffer ("DB_DBT_PARTIAL", or stream of external file).
+ * Returns error code of Berkeley DB.
+ */
+int value_stream::fill ()
+{
+    DBT k, d;
+
+#ifdef BDB_EXT_FILE
+
+    if (m_stream != NULL)
+    {
+        DB_STREAM * stream = (DB_STREAM *) m_stream;
+
+        uint64_t rest = (m_length > m_offset ? m_length - m_offset : 0);
+        u_int32_t size = (u_int32_t) std::min((uint64_t) m_chunk.size(), rest);
+
+        memset(&d, 0, sizeof(DBT));
+        d.data  = &m_chunk[0];
+        d.ulen  = (u_int32_t) m_chunk.size();
+        d.flags = DB_DBT_USERMEM;
+
+        int res = (size != 0 ? stream->read(stream, &d, (db_off_t) m_offset, size, 0) : 0);
+
+        if (res == 0)
+        {
+            m_pos     = 0;
+            m_size    = (size != 0 ? d.size : 0);
+            m_offset += (u_int32_t) m_size;
+            m_eof     = (m_offset >= m_length);
+        }
+
+        return res;
+    }
+
+#endif
+
+    // key is not needed, the cursor stays at the record
+    memset(&k, 0, sizeof(DBT));
+    k.flags = DB_DBT_PARTIAL;
+
+    memset(&d, 0, sizeof(DBT));
+    d.data  = &m_chunk[0];
+    d.ulen  = (u_int32_t) m_chunk.size();
+    d.doff  = m_offset;
+    d.dlen  = (u_int32_t) m_chunk.size();
+    d.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
+
+    int res = m_cursor->get(m_cursor, &k, &d, DB_CURRENT);
+
+    if (res == 0)
+    {
+        m_pos     = 0;
+        m_size    = d.size;
+        m_offset += d.size;
+        m_eof     = (d.size < m_chunk.size());
+    }
+
+    return res;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
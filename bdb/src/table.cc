@@ -30,14 +30,25 @@
 #include <bdb.h>
 
 // Standard C/C++ Libraries
+#include <algorithm>
 #include <cerrno>
+#include <cstring>
 #include <exception>
+#include <list>
+#include <map>
 #include <string>
 #include <vector>
 
 // Protocol Buffers
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
 #include <google/protobuf/message.h>
 
+// Boost C++ Libraries
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
 // Berkeley DB
 #include <db.h>
 
@@ -46,6 +57,36 @@
 #error Berkeley DB 4.7 or later is required.
 #endif
 
+// Bulk puts are available since Berkeley DB 4.8
+#if (DB_VERSION_MAJOR > 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR >= 8)
+#define BDB_BULK_PUT
+#endif
+
+// Compression of Btree tables is available since Berkeley DB 4.8
+#if (DB_VERSION_MAJOR > 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR >= 8)
+#define BDB_BT_COMPRESS
+#endif
+
+// Partitioning of databases is available since Berkeley DB 4.8
+#if (DB_VERSION_MAJOR > 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR >= 8)
+#define BDB_PARTITION
+#endif
+
+// Directories of new files of databases are available since Berkeley DB 4.8
+#if (DB_VERSION_MAJOR > 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR >= 8)
+#define BDB_CREATE_DIR
+#endif
+
+// Heap databases are available since Berkeley DB 5.2
+#if (DB_VERSION_MAJOR > 5) || (DB_VERSION_MAJOR == 5) && (DB_VERSION_MINOR >= 2)
+#define BDB_HEAP
+#endif
+
+// External files of large data are available since Berkeley DB 6.0 (as blobs, renamed in Berkeley DB 6.2)
+#if (DB_VERSION_MAJOR >= 6)
+#define BDB_EXT_FILE
+#endif
+
 // C++ Logging Library
 #include <log4cplus/logger.h>
 
@@ -59,321 +100,4667 @@ namespace bdb
 using std::string;
 using std::vector;
 
+using google::protobuf::FieldDescriptor;
 using google::protobuf::Message;
+using google::protobuf::Reflection;
 
-//--------------------------------------------------------------------------------------------------
-//  Constructors/destructors.
-//--------------------------------------------------------------------------------------------------
+/** @private Initial size of buffer for bulk inserts. */
+static const size_t BULK_BUFFER_SIZE = 1024 * 1024;
+
+/** @private Size of service data, which the bulk buffer needs per record, besides key and data. */
+static const size_t BULK_RECORD_OVERHEAD = 8 * sizeof(u_int32_t);
+
+/** @private Initial size of buffer for selected data (enlarged if the record doesn't fit). */
+static const u_int32_t SELECT_BUFFER_SIZE = 1024;
+
+/** @private Maximum number of retries of deadlocked modification. */
+static const int MODIFY_MAX_RETRIES = 8;
+
+/** @private Maximum number of retries of step of compaction, rolled back by deadlocks. */
+static const int COMPACT_MAX_RETRIES = 8;
+
+/** @private Initial and maximum delays (in milliseconds) before retry of deadlocked modification. */
+static const long MODIFY_BACKOFF_MIN = 1;
+static const long MODIFY_BACKOFF_MAX = 64;
+
+/** @private Number of bisection steps to find a bound of parallel scan. */
+static const int SCAN_BISECTION_STEPS = 48;
+
+/** @private Number of independently locked shards of records cache. */
+static const size_t CACHE_SHARDS = 16;
+
+/** @private Estimated memory of a cached record besides its key and data (nodes of the list and the map, in bytes). */
+static const size_t CACHE_RECORD_OVERHEAD = 128;
+
+/** @private Number of records, evicted by a shard of records cache for lack of memory, which asks for more memory. */
+static const unsigned long CACHE_PRESSURE_EVICTIONS = 1024;
+
+/** @private Minimal number of keys, the Bloom filter of keys is sized for. */
+static const size_t BLOOM_MIN_KEYS = 1024;
+
+/** @private Growth of table, the Bloom filter of keys is sized for on rebuild (in times). */
+static const size_t BLOOM_GROWTH = 2;
+
+/** @private Lock of lazy opening of tables. */
+static boost::mutex lazy_mutex;
 
 /**
- * Default empty constructor - does nothing.
- * Purposed for usage in a child class, if one needs to rewrite
- * main parent constructor (see below) from scratch.
+ * @private Returns Berkeley DB type of database for specified access method.
  */
-table::table (const char * name)    /**< [in] Name of the table. */
-  : m_name(string(name)),
-    m_db(NULL)
+static DBTYPE access_type (int method)
 {
-    // do nothing
+    switch (method)
+    {
+        case BDB_ACCESS_HASH:               return DB_HASH;
+        case BDB_ACCESS_RECNO:              return DB_RECNO;
+        case BDB_ACCESS_QUEUE:              return DB_QUEUE;
+#ifdef BDB_HEAP
+        case BDB_ACCESS_HEAP:               return DB_HEAP;
+#endif
+        default:                            return DB_BTREE;
+    }
 }
 
 /**
- * Opens the table.
- * If "create" is "true" and table doesn't exist, then creates it.
- *
- * @throw bdb::exception BDB_ERROR_NOT_FOUND - the table is not found.
- * @throw bdb::exception BDB_ERROR_EXISTS    - the table already exists.
- * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ * @private Sets single integer field of generated key to specified id (see "bdb::table::insert_auto").
  */
-table::table (database         * db,        /**< [in] Database of the table.                                  */
-              const char       * name,      /**< [in] Name of the table.                                      */
-              compare_callback   fn_cmp,    /**< [in] Keys comparision function (see "Db::set_bt_compare()"). */
-              bool               create)    /**< [in] Whether to create the table if it doesn't exist.        */
-  : m_name(string(name)),
-    m_db(NULL),
-    m_database(db),
-    m_callback(fn_cmp)
+static void set_id (Message * key, uint64_t id)
 {
-    LOG4CPLUS_TRACE(logger, "[bdb::table::table] ENTER");
-    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] name = " << name);
-    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] create = " << create);
+    key->Clear();
 
-    int res = db_create(&m_db, db->m_env, 0);
+    const FieldDescriptor * f = key->GetDescriptor()->field(0);
+    const Reflection      * r = key->GetReflection();
 
-    if (fn_cmp != NULL)
+    switch (f->cpp_type())
     {
-        if (res == 0) res = m_db->set_bt_compare(m_db, fn_cmp);
+        case FieldDescriptor::CPPTYPE_INT32:    r->SetInt32(key, f, (int32_t) id);   break;
+        case FieldDescriptor::CPPTYPE_INT64:    r->SetInt64(key, f, (int64_t) id);   break;
+        case FieldDescriptor::CPPTYPE_UINT32:   r->SetUInt32(key, f, (uint32_t) id); break;
+        case FieldDescriptor::CPPTYPE_UINT64:   r->SetUInt64(key, f, id);            break;
+        default:                                LOG4CPLUS_WARN(logger, "[bdb::set_id] key is not an integer");
     }
+}
 
-    if (res == 0)
+/** @private State of parallel scan, shared by its workers. */
+struct scan_state
+{
+    DB               * db;          /**< Scanned table.                                      */
+    compare_callback   fn_cmp;      /**< Keys comparison function ("NULL" - bytewise).       */
+    scan_callback      fn_scan;     /**< Application callback.                               */
+    void             * param;       /**< Parameter of application callback.                  */
+    vector <string>    bounds;      /**< Bounds of ranges (empty - from the first or to the last record). */
+    boost::mutex       mutex;       /**< Guards "error".                                     */
+    volatile bool      stop;        /**< Whether the scan should be stopped.                 */
+    int                error;       /**< First error of the workers.                         */
+    bool               transactional;   /**< Whether the workers read in transactions.       */
+};
+
+/** @private Range of parallel scan, scanned by a task of work pool of the database. */
+struct scan_task
+{
+    scan_state * state;     /**< State of the scan. */
+    int          worker;    /**< Number of worker.  */
+};
+
+/**
+ * @private In-process cache of serialized records, read by "bdb::table::select" outside of transactions.
+ * The cache is split into shards by hash of serialized keys, and each shard is a list of records in order of
+ * their usage, so the least recently used record is evicted first. Each invalidation increments generation
+ * of the shard, so records, which are read concurrently with their changes, are never put into the cache.
+ * Besides the number of records, the cache may be limited by memory of its records (see "bdb::memory_governor").
+ */
+class row_cache
+{
+public:
+
+    explicit row_cache (size_t capacity)
+    {
+        for (size_t i = 0; i < CACHE_SHARDS; i++)
+        {
+            m_shards[i].capacity   = (capacity + CACHE_SHARDS - 1) / CACHE_SHARDS;
+            m_shards[i].generation = 0;
+            m_shards[i].bytes      = 0;
+            m_shards[i].limit      = (size_t) -1;
+            m_shards[i].evictions  = 0;
+        }
+    }
+
+    /**
+     * Finds serialized data of specified record, and marks the record as the most recently used one.
+     */
+    bool get (const DBT * key, string * data)
     {
-        u_int32_t flags = DB_THREAD;
-        if (create) flags |= DB_CREATE | DB_EXCL;
+        shard & sh = shard_of(key);
+        boost::mutex::scoped_lock lock(sh.mutex);
+
+        record_map::iterator i = sh.lookup.find(string((const char *) key->data, key->size));
+        if (i == sh.lookup.end()) return false;
 
-        res = m_db->open(m_db,
-                         m_database->m_txns.top(),
-                         get_filename().c_str(),
-                         m_name.c_str(),
-                         DB_BTREE,
-                         flags,
-                         0);
+        sh.records.splice(sh.records.begin(), sh.records, i->second);
+        *data = i->second->second;
+
+        return true;
     }
 
-    if (res != 0)
+    /**
+     * Returns current generation of the shard of specified record (taken before the record is read).
+     */
+    unsigned long generation (const DBT * key)
     {
-        LOG4CPLUS_WARN(logger, "[bdb::table::table] " << db_strerror(res));
+        shard & sh = shard_of(key);
+        boost::mutex::scoped_lock lock(sh.mutex);
 
-        if (m_db != NULL) m_db->close(m_db, 0);
+        return sh.generation;
+    }
 
-        switch (res)
+    /**
+     * Puts serialized data of specified record, unless the shard has been invalidated since "generation".
+     * Returns "true", if the shard has evicted another portion of records for lack of memory.
+     */
+    bool put (const DBT * key, const DBT * data, unsigned long generation)
+    {
+        shard & sh = shard_of(key);
+        boost::mutex::scoped_lock lock(sh.mutex);
+
+        if (sh.generation != generation || sh.capacity == 0) return false;
+
+        string k((const char *) key->data, key->size);
+
+        if (sh.lookup.find(k) != sh.lookup.end()) return false;
+
+        sh.records.push_front(record(k, string((const char *) data->data, data->size)));
+        sh.lookup[k] = sh.records.begin();
+        sh.bytes += footprint(sh.records.front());
+
+        if (sh.records.size() > sh.capacity)
         {
-            case ENOENT:    throw exception(BDB_ERROR_NOT_FOUND);
-            case EEXIST:    throw exception(BDB_ERROR_EXISTS);
-            default:        throw exception(BDB_ERROR_UNKNOWN);
+            evict(sh);
         }
-    }
 
-    LOG4CPLUS_TRACE(logger, "[bdb::table::table] EXIT");
-}
+        bool pressure = false;
 
-/**
- * Closes the table and all associated indexes.
- */
-table::~table () throw ()
-{
-    LOG4CPLUS_TRACE(logger, "[bdb::table::~table] ENTER");
+        while (!sh.records.empty() && sh.bytes > sh.limit)
+        {
+            evict(sh);
 
-    // close all associated indexes
-    for (unsigned int i = 0; i < m_indexes.size(); i++)
-    {
-        delete m_indexes[i];
-    }
+            pressure = pressure || (++sh.evictions % CACHE_PRESSURE_EVICTIONS == 0);
+        }
 
-    m_db->close(m_db, 0);
+        return pressure;
+    }
 
-    LOG4CPLUS_TRACE(logger, "[bdb::table::~table] EXIT");
-}
+    /**
+     * Removes specified record from the cache (the record is being changed).
+     */
+    void invalidate (const DBT * key)
+    {
+        shard & sh = shard_of(key);
+        boost::mutex::scoped_lock lock(sh.mutex);
 
-//--------------------------------------------------------------------------------------------------
-//  Public interface.
-//--------------------------------------------------------------------------------------------------
+        sh.generation++;
 
-/**
- * Adds specified index to the table and opens the index.
- * If index doesn't exist yet, then creates it.
- *
- * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
- */
-index * table::add_index (const char       * name,      /**< [in] Name of the index.                                       */
-                          index_callback     fn_idx,    /**< [in] Indexing function (see "Db::associate()").               */
-                          compare_callback   fn_cmp,    /**< [in] Index comparision function (see "Db::set_bt_compare()"). */
-                          bool               unique)    /**< [in] Whether new index should contain unique keys only.       */
-{
-    LOG4CPLUS_TRACE(logger, "[bdb::table::add_index] ENTER");
-    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] name = " << name);
-    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] unique = " << unique);
+        record_map::iterator i = sh.lookup.find(string((const char *) key->data, key->size));
+        if (i == sh.lookup.end()) return;
 
-    index * i = NULL;
+        sh.bytes -= footprint(*i->second);
+        sh.records.erase(i->second);
+        sh.lookup.erase(i);
+    }
 
-    try
+    /**
+     * Removes all records from the cache.
+     */
+    void clear ()
     {
-        i = new index(this, name, fn_idx, fn_cmp, m_callback, unique);
-        assert(i != NULL);
-        m_indexes.push_back(i);
+        for (size_t i = 0; i < CACHE_SHARDS; i++)
+        {
+            boost::mutex::scoped_lock lock(m_shards[i].mutex);
+
+            m_shards[i].generation++;
+            m_shards[i].records.clear();
+            m_shards[i].lookup.clear();
+            m_shards[i].bytes = 0;
+        }
     }
-    catch (...)
+
+    /**
+     * Limits memory of cached records, evicting the least recently used ones, which don't fit the limit.
+     */
+    void set_limit (uint64_t bytes)
     {
-        throw;
+        for (size_t i = 0; i < CACHE_SHARDS; i++)
+        {
+            boost::mutex::scoped_lock lock(m_shards[i].mutex);
+
+            m_shards[i].limit = (size_t) (bytes / CACHE_SHARDS);
+
+            while (!m_shards[i].records.empty() && m_shards[i].bytes > m_shards[i].limit)
+            {
+                evict(m_shards[i]);
+            }
+        }
     }
 
-    LOG4CPLUS_TRACE(logger, "[bdb::table::add_index] EXIT");
+    /**
+     * Returns memory of cached records.
+     */
+    uint64_t bytes ()
+    {
+        uint64_t total = 0;
 
-    return i;
-}
+        for (size_t i = 0; i < CACHE_SHARDS; i++)
+        {
+            boost::mutex::scoped_lock lock(m_shards[i].mutex);
+            total += m_shards[i].bytes;
+        }
 
-/**
- * Checks whether a record with specified key exists in the table.
- * <strong>NOTE:</strong> all keys in the table are unique.
- *
- * @return true  - the record exists.
- * @return false - the record is not found.
- */
-bool table::exists (const Message * key)    /**< [in] Key of the record to be checked. */
-{
-    LOG4CPLUS_TRACE(logger, "[bdb::table::exists] ENTER");
+        return total;
+    }
 
-    DBT k;
+    /**
+     * Returns number of records, evicted for lack of memory since the previous call.
+     */
+    uint64_t take_evictions ()
+    {
+        uint64_t total = 0;
 
-    serialize(key, &k);
-    int res = m_db->exists(m_db, m_database->m_txns.top(), &k, DB_READ_COMMITTED);
-    release(&k);
+        for (size_t i = 0; i < CACHE_SHARDS; i++)
+        {
+            boost::mutex::scoped_lock lock(m_shards[i].mutex);
 
-    LOG4CPLUS_TRACE(logger, "[bdb::table::exists] EXIT = " << (res == 0));
+            total += m_shards[i].evictions;
+            m_shards[i].evictions = 0;
+        }
 
-    return (res == 0);
-}
+        return total;
+    }
 
-/**
- * Deletes specified existing record.
- * <strong>NOTE:</strong> all keys in the table are unique.
- *
- * @throw bdb::exception BDB_ERROR_NOT_FOUND   - the record is not found.
- * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - this table has a foreign constraint to another one,
- *                                               and slave table contains specified key.
- * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
- */
-void table::remove (const Message * key)    /**< [in] Key of the record to be deleted. */
-{
-    LOG4CPLUS_TRACE(logger, "[bdb::table::remove] ENTER");
+protected:
 
-    DBT k;
+    typedef std::pair <string, string>              record;         /**< Serialized key and data. */
+    typedef std::list <record>                      record_list;    /**< Records by recent usage. */
+    typedef std::map  <string, record_list::iterator> record_map;   /**< Records by their keys.   */
 
-    serialize(key, &k);
-    int res = m_db->del(m_db, m_database->m_txns.top(), &k, 0);
-    release(&k);
+    /** Independently locked part of the cache. */
+    struct shard
+    {
+        boost::mutex    mutex;          /**< Guards all the fields below.       */
+        record_list     records;        /**< Cached records.                    */
+        record_map      lookup;         /**< Positions of the cached records.   */
+        size_t          capacity;       /**< Maximum number of cached records.  */
+        unsigned long   generation;     /**< Number of invalidations.           */
+        size_t          bytes;          /**< Memory of cached records.          */
+        size_t          limit;          /**< Maximum memory of cached records.  */
+        unsigned long   evictions;      /**< Number of records, evicted for lack of memory. */
+    };
 
-    if (res != 0)
+    /** Returns estimated memory of cached record. */
+    static size_t footprint (const record & rec)
     {
-        LOG4CPLUS_WARN(logger, "[bdb::table::remove] " << db_strerror(res));
+        return rec.first.size() * 2 + rec.second.size() + CACHE_RECORD_OVERHEAD;
+    }
 
-        switch (res)
+    /** Evicts the least recently used record of the shard. */
+    static void evict (shard & sh)
+    {
+        sh.bytes -= footprint(sh.records.back());
+        sh.lookup.erase(sh.records.back().first);
+        sh.records.pop_back();
+    }
+
+    /** Returns the shard of specified key (FNV-1a hash). */
+    shard & shard_of (const DBT * key)
+    {
+        const unsigned char * p = (const unsigned char *) key->data;
+        uint32_t hash = 2166136261U;
+
+        for (u_int32_t i = 0; i < key->size; i++)
         {
-            case DB_NOTFOUND:           throw exception(BDB_ERROR_NOT_FOUND);
-            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
-            default:                    throw exception(BDB_ERROR_UNKNOWN);
+            hash = (hash ^ p[i]) * 16777619U;
         }
+
+        return m_shards[hash % CACHE_SHARDS];
     }
 
-    LOG4CPLUS_TRACE(logger, "[bdb::table::remove] EXIT");
-}
+    shard m_shards[CACHE_SHARDS];   /**< Shards of the cache. */
+};
 
 /**
- * Inserts specified new record into the table.
- * <strong>NOTE:</strong> all keys in the table are unique.
- *
- * @throw bdb::exception BDB_ERROR_EXISTS      - a record with specified key already exists,
- *                                               or unique index already contains specified value.
- * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - this table has a foreign constraint to another one,
- *                                               and master table doesn't contain specified key.
- * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ * @private Bloom filter of keys of a table, which tells that a key is definitely absent from the table.
+ * Keys are added before they are written (even if the write is rolled back then), and are never removed,
+ * so the filter may only give false positives. Bits of a key are found by double hashing of the key.
  */
-void table::insert (const Message * key,    /**< [in] Key of new record.  */
-                    const Message * data)   /**< [in] Data of new record. */
+class key_filter
 {
-    LOG4CPLUS_TRACE(logger, "[bdb::table::insert] ENTER");
+public:
 
-    DBT k, d;
+    key_filter (const vector <uint64_t> & hashes, unsigned int bits_per_key)
+    {
+        size_t keys = hashes.size() * BLOOM_GROWTH;
+        if (keys < BLOOM_MIN_KEYS) keys = BLOOM_MIN_KEYS;
 
-    serialize(key,  &k);
-    serialize(data, &d);
+        // optimal number of hash functions is ln(2) * bits per key
+        m_probes = (int) (bits_per_key * 69 / 100);
+        if (m_probes < 1)  m_probes = 1;
+        if (m_probes > 16) m_probes = 16;
 
-    int res = m_db->put(m_db, m_database->m_txns.top(), &k, &d, DB_NOOVERWRITE);
+        m_bits.resize((keys * bits_per_key + 63) / 64);
 
-    release(&k);
-    release(&d);
+        for (size_t i = 0; i < hashes.size(); i++)
+        {
+            set(hashes[i]);
+        }
+    }
 
-    if (res != 0)
+    /**
+     * Returns hash of serialized key (two FNV-1a variants, combined into one value).
+     */
+    static uint64_t hash (const DBT * key)
     {
-        LOG4CPLUS_WARN(logger, "[bdb::table::insert] " << db_strerror(res));
+        const unsigned char * p = (const unsigned char *) key->data;
 
-        switch (res)
+        uint32_t h1 = 2166136261U;
+        uint32_t h2 = 0x9E3779B9U;
+
+        for (u_int32_t i = 0; i < key->size; i++)
         {
-            case EINVAL:                throw exception(BDB_ERROR_EXISTS);
-            case DB_KEYEXIST:           throw exception(BDB_ERROR_EXISTS);
-            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
-            default:                    throw exception(BDB_ERROR_UNKNOWN);
+            h1 = (h1 ^ p[i]) * 16777619U;
+            h2 = (h2 ^ p[i]) * 0x01000193U + (h2 >> 15);
         }
-    }
 
-    LOG4CPLUS_TRACE(logger, "[bdb::table::insert] EXIT");
-}
+        return ((uint64_t) h1 << 32) | (h2 | 1);
+    }
 
-/**
- * Updates specified existing record.
- * <strong>NOTE:</strong> all keys in the table are unique.
- *
- * @throw bdb::exception BDB_ERROR_NOT_FOUND   - the record is not found.
- * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - this table has a foreign constraint to another one,
- *                                               and master table doesn't contain specified new key.
- * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
- */
-void table::update (const Message * key,    /**< [in] Key of the record to be updated. */
-                    const Message * data)   /**< [in] New data of the record.          */
-{
-    LOG4CPLUS_TRACE(logger, "[bdb::table::update] ENTER");
+    /**
+     * Adds specified key to the filter.
+     */
+    void add (const DBT * key)
+    {
+        uint64_t h = hash(key);
 
-    DBT k, d;
+        boost::mutex::scoped_lock lock(m_mutex);
+        set(h);
+    }
 
-    serialize(key,  &k);
-    serialize(data, &d);
+    /**
+     * Checks whether specified key can be in the table ("false" - the key is definitely absent).
+     */
+    bool may_contain (const DBT * key)
+    {
+        uint64_t h  = hash(key);
+        uint32_t h1 = (uint32_t) (h >> 32);
+        uint32_t h2 = (uint32_t) h;
 
-    int res = m_db->exists(m_db, m_database->m_txns.top(), &k, DB_READ_COMMITTED);
+        size_t size = m_bits.size() * 64;
 
-    if (res != 0)
-    {
-        LOG4CPLUS_WARN(logger, "[bdb::table::update] " << db_strerror(res));
+        boost::mutex::scoped_lock lock(m_mutex);
 
-        release(&k);
-        release(&d);
+        for (int i = 0; i < m_probes; i++)
+        {
+            size_t bit = (size_t) ((h1 + i * h2) % size);
+            if ((m_bits[bit / 64] & ((uint64_t) 1 << (bit % 64))) == 0) return false;
+        }
 
-        throw exception(BDB_ERROR_NOT_FOUND);
+        return true;
     }
 
-    res = m_db->put(m_db, m_database->m_txns.top(), &k, &d, 0);
+    /**
+     * Returns memory of the bits of the filter.
+     */
+    uint64_t bytes () const
+    {
+        return m_bits.size() * sizeof(uint64_t);
+    }
 
-    release(&k);
-    release(&d);
+protected:
 
-    if (res != 0)
+    /** Sets bits of specified hash. */
+    void set (uint64_t h)
     {
-        LOG4CPLUS_WARN(logger, "[bdb::table::update] " << db_strerror(res));
+        uint32_t h1 = (uint32_t) (h >> 32);
+        uint32_t h2 = (uint32_t) h;
 
-        switch (res)
+        size_t size = m_bits.size() * 64;
+
+        for (int i = 0; i < m_probes; i++)
         {
-            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
-            default:                    throw exception(BDB_ERROR_UNKNOWN);
+            size_t bit = (size_t) ((h1 + i * h2) % size);
+            m_bits[bit / 64] |= ((uint64_t) 1 << (bit % 64));
         }
     }
 
-    LOG4CPLUS_TRACE(logger, "[bdb::table::update] EXIT");
-}
+    boost::mutex        m_mutex;    /**< Guards the bits.                   */
+    vector <uint64_t>   m_bits;     /**< Bits of the filter.                */
+    int                 m_probes;   /**< Number of bits per key.            */
+};
 
 /**
- * Finds a record with specified key and returns its data.
- * <strong>NOTE:</strong> all keys in the table are unique.
- *
- * @throw bdb::exception BDB_ERROR_NOT_FOUND - the record is not found.
- * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ * @private Counters of calls and time of profiled application callbacks of a table and its indexes
+ * (see "bdb::table_options::profile_callbacks"), by kinds of the callbacks.
  */
-void table::select (const Message * key,    /**< [in]  Key of the record to be retrieved. */
-                    Message       * data)   /**< [out] Data of the found record.          */
+class callback_counters
 {
-    LOG4CPLUS_TRACE(logger, "[bdb::table::select] ENTER");
+public:
 
-    DBT k, d;
+    callback_counters ()
+    {
+        memset(calls, 0, sizeof(calls));
+        memset(time,  0, sizeof(time));
+    }
+
+    boost::mutex    mutex;                          /**< Guards the counters.              */
+    uint64_t        calls[BDB_CALLBACK_KINDS];      /**< Number of calls.                  */
+    uint64_t        time[BDB_CALLBACK_KINDS];       /**< Total time of calls, in nanoseconds. */
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of struct "bdb::table_options".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Sets all options to Berkeley DB defaults.
+ */
+table_options::table_options ()
+  : page_size(0),
+    key_format(BDB_KEY_PROTOBUF),
+    multiversion(false),
+    access_method(BDB_ACCESS_BTREE),
+    record_length(0),
+    compression(false),
+    fn_compress(NULL),
+    fn_decompress(NULL),
+    cache_records(0),
+    bloom_bits(0),
+    partitions(0),
+    partition_keys(NULL),
+    fn_partition(NULL),
+    partition_dirs(NULL),
+    lazy_open(false),
+    profile_callbacks(false),
+    key_type(NULL),
+    read_only(false),
+    capture_changes(false),
+    fn_dup_compare(NULL),
+    dup_bytewise(false),
+    ttl_field(0),
+    ttl(0),
+    cache_priority(BDB_PRIORITY_DEFAULT),
+    hot_sampling(0),
+    distinct_sketch(false),
+    data_dir(NULL),
+    schema_version(0),
+    encrypted(false),
+    blob_threshold(0)
+{
+    // do nothing
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of struct "bdb::compact_options".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Sets Berkeley DB default fill factor, and steps of 64 pages without budgets.
+ */
+compact_options::compact_options ()
+  : fill_percent(0),
+    step_pages(64),
+    max_pages(0),
+    timeout(0),
+    free_space(false)
+{
+    // do nothing
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Default empty constructor - does nothing.
+ * Purposed for usage in a child class, if one needs to rewrite
+ * main parent constructor (see below) from scratch.
+ */
+table::table (const char * name)    /**< [in] Name of the table. */
+  : m_name(string(name)),
+    m_db(NULL),
+    m_database(NULL),
+    m_callback(NULL),
+    m_cache(NULL),
+    m_bloom(NULL),
+    m_lazy(false),
+    m_counters(NULL),
+    m_layout(NULL),
+    m_notified(false),
+    m_notify_values(false),
+    m_expiry(NULL),
+    m_sampler(NULL),
+    m_histogram(NULL),
+    m_modified(0),
+    m_removed(0)
+{
+    // do nothing
+}
+
+/**
+ * Opens the table.
+ * If "create" is "true" and table doesn't exist, then creates it.
+ * Page size is used on creation only, and is ignored for existing tables.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the table is not found.
+ * @throw bdb::exception BDB_ERROR_EXISTS    - the table already exists.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+table::table (database            * db,      /**< [in] Database of the table.                                  */
+              const char          * name,    /**< [in] Name of the table.                                      */
+              compare_callback      fn_cmp,  /**< [in] Keys comparision function (see "Db::set_bt_compare()"). */
+              bool                  create,  /**< [in] Whether to create the table if it doesn't exist.        */
+              const table_options & options) /**< [in] Tuning options of the table.                            */
+  : m_name(string(name)),
+    m_db(NULL),
+    m_database(db),
+    m_callback(fn_cmp),
+    m_options(options),
+    m_cache(NULL),
+    m_bloom(NULL),
+    m_lazy(false),
+    m_counters(NULL),
+    m_layout(NULL),
+    m_notified(false),
+    m_notify_values(false),
+    m_expiry(NULL),
+    m_sampler(NULL),
+    m_histogram(NULL),
+    m_modified(0),
+    m_removed(0)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::table] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] name = " << name);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] create = " << create);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] page size = " << options.page_size);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] multiversion = " << options.multiversion);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] access method = " << options.access_method);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] compression = " << options.compression);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] cache records = " << options.cache_records);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] bloom bits = " << options.bloom_bits);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] partitions = " << options.partitions);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] lazy open = " << options.lazy_open);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] profile callbacks = " << options.profile_callbacks);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] capture changes = " << options.capture_changes);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] ttl field = " << options.ttl_field);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] ttl = " << options.ttl);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] cache priority = " << options.cache_priority);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] hot sampling = " << options.hot_sampling);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] distinct sketch = " << options.distinct_sketch);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] blob threshold = " << options.blob_threshold);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::table] data dir = " << (options.data_dir != NULL ? options.data_dir : ""));
+
+    // keys of types, known at run time only, are compared by reflection
+    if (m_callback == NULL && options.key_type != NULL)
+    {
+        LOG4CPLUS_DEBUG(logger, "[bdb::table::table] key type = " << options.key_type->full_name());
+
+        m_layout   = message_layout::get(options.key_type);
+        m_callback = compare_dynamic;
+    }
+
+    // record numbers are the only keys of recno and queue tables
+    if (is_numbered())
+    {
+        m_options.key_format = (options.access_method == BDB_ACCESS_HEAP ? BDB_KEY_RID : BDB_KEY_RECNO);
+        m_callback = NULL;
+    }
+
+    // hash tables need no order of keys
+    if (options.access_method == BDB_ACCESS_HASH)
+    {
+        m_callback = NULL;
+    }
+
+    // profiled callbacks are called through trampolines, which find the table by its database
+    if (options.profile_callbacks)
+    {
+        m_counters = new callback_counters;
+        assert(m_counters != NULL);
+    }
+
+    if (options.hot_sampling != 0)
+    {
+        m_sampler = new hot_sampler(options.hot_sampling);
+        assert(m_sampler != NULL);
+    }
+
+    int res = db_create(&m_db, db->m_env, 0);
+
+    if (res == 0) m_db->app_private = this;
+
+    if (options.page_size != 0)
+    {
+        if (res == 0) res = m_db->set_pagesize(m_db, options.page_size);
+    }
+
+    if (options.encrypted)
+    {
+        if (res == 0) res = m_db->set_flags(m_db, DB_ENCRYPT);
+    }
+
+    if (m_callback != NULL)
+    {
+        if (res == 0) res = m_db->set_bt_compare(m_db, (m_counters != NULL ? compare_profiled : m_callback));
+    }
+
+    if (options.compression && options.access_method == BDB_ACCESS_BTREE)
+    {
+#ifdef BDB_BT_COMPRESS
+        if (res == 0) res = m_db->set_bt_compress(m_db, options.fn_compress, options.fn_decompress);
+#else
+        LOG4CPLUS_WARN(logger, "[bdb::table::table] Compression requires Berkeley DB 4.8 or later, and is ignored.");
+#endif
+    }
+
+    if (options.partitions > 1 && res == 0)
+    {
+#ifdef BDB_PARTITION
+        res = set_partition(options);
+#else
+        LOG4CPLUS_WARN(logger, "[bdb::table::table] Partitioning requires Berkeley DB 4.8 or later, and is ignored.");
+#endif
+    }
+
+    if (options.data_dir != NULL && !db->m_memory && res == 0)
+    {
+#ifdef BDB_CREATE_DIR
+        res = m_db->set_create_dir(m_db, options.data_dir);
+#else
+        LOG4CPLUS_WARN(logger, "[bdb::table::table] Placement of tables requires Berkeley DB 4.8 or later, and is ignored.");
+#endif
+    }
+
+    if (options.access_method == BDB_ACCESS_QUEUE)
+    {
+        // padding stops parsing of ProtoBuf data, like the end of the data
+        if (res == 0 && options.record_length != 0) res = m_db->set_re_len(m_db, options.record_length);
+        if (res == 0) res = m_db->set_re_pad(m_db, 0);
+    }
+
+    if (options.blob_threshold != 0 && res == 0)
+    {
+#if (DB_VERSION_MAJOR > 6) || (DB_VERSION_MAJOR == 6) && (DB_VERSION_MINOR >= 2)
+        res = m_db->set_ext_file_threshold(m_db, options.blob_threshold, 0);
+#elif defined(BDB_EXT_FILE)
+        res = m_db->set_blob_threshold(m_db, options.blob_threshold, 0);
+#else
+        LOG4CPLUS_WARN(logger, "[bdb::table::table] External files require Berkeley DB 6.0 or later, and are ignored.");
+#endif
+    }
+
+    if (options.access_method == BDB_ACCESS_HEAP)
+    {
+#ifndef BDB_HEAP
+        LOG4CPLUS_WARN(logger, "[bdb::table::table] Heap tables require Berkeley DB 5.2 or later.");
+        res = EINVAL;
+#endif
+    }
+
+    if (options.capture_changes && res == 0) res = db->open_changes();
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::table] " << db_strerror(res));
+
+        if (m_db != NULL) m_db->close(m_db, 0);
+
+        delete m_counters;
+
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    // existing table is opened on first use (see "bdb::table::check_open")
+    if (options.lazy_open && !create)
+    {
+        m_lazy = true;
+    }
+    else
+    {
+        open_db(create, m_database->get_transaction());
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::table] EXIT");
+}
+
+/**
+ * Closes the table and all associated indexes.
+ */
+table::~table () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::~table] ENTER");
+
+    // undelivered notifications of the table are dropped
+    if (m_notified) m_database->m_notifier->forget(this);
+
+    // expired records are not removed any longer, once the table is closed
+    if (m_expiry != NULL)
+    {
+        if (m_database->m_reaper != NULL) m_database->m_reaper->remove(this);
+
+        delete m_expiry;
+    }
+
+    // close all associated indexes
+    for (unsigned int i = 0; i < m_indexes.size(); i++)
+    {
+        delete m_indexes[i];
+    }
+
+    // close all materialized aggregates
+    for (unsigned int i = 0; i < m_aggregates.size(); i++)
+    {
+        delete m_aggregates[i];
+    }
+
+    // close all column stores
+    for (unsigned int i = 0; i < m_columns.size(); i++)
+    {
+        delete m_columns[i];
+    }
+
+    if (m_db != NULL) m_db->close(m_db, m_database->m_close_flags);
+
+    // memory of the cache and the filter goes back to the budget
+    if (m_database->m_governor != NULL) m_database->m_governor->remove(this);
+
+    delete m_cache;
+    delete m_bloom;
+    delete m_counters;
+    delete m_sampler;
+    delete m_histogram;
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::~table] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds specified index to the table and opens the index.
+ * If index doesn't exist yet, then creates it.
+ * Keys of immutable index are not rewritten when a record is updated ("DB_IMMUTABLE_KEY"),
+ * so the index must be declared immutable only if updates never change indexed fields.
+ * The indexing function may return several keys of a record ("DB_DBT_MULTIPLE"), e.g. to index
+ * each value of a repeated field (see "bdb::index_repeated").
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+index * table::add_index (const char       * name,      /**< [in] Name of the index.                                       */
+                          index_callback     fn_idx,    /**< [in] Indexing function (see "Db::associate()").               */
+                          compare_callback   fn_cmp,    /**< [in] Index comparision function (see "Db::set_bt_compare()"). */
+                          bool               unique,    /**< [in] Whether new index should contain unique keys only.       */
+                          bool               immutable) /**< [in] Whether index keys of a record never change on update.   */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_index] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] name = " << name);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] unique = " << unique);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] immutable = " << immutable);
+
+    check_open();
+
+    index * i = NULL;
+
+    try
+    {
+        i = new index(this, name, fn_idx, fn_cmp, m_callback, unique, NULL, 0, 0, immutable);
+        assert(i != NULL);
+        m_indexes.push_back(i);
+    }
+    catch (...)
+    {
+        throw;
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_index] EXIT");
+
+    return i;
+}
+
+/**
+ * Adds specified covering index to the table and opens the index.
+ * Besides index keys, covering index stores projections of primary data, made by "fn_proj"
+ * (see "bdb::project_fields"), so they can be fetched without reading the table
+ * (see "bdb::recordset::fetch_projection"). Projections are maintained by the table on every change,
+ * so all changes should be done through the table, and in transactions to keep projections consistent.
+ * If index doesn't exist yet, then creates it.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+index * table::add_index (const char       * name,      /**< [in] Name of the index.                                       */
+                          index_callback     fn_idx,    /**< [in] Indexing function (see "Db::associate()").               */
+                          compare_callback   fn_cmp,    /**< [in] Index comparision function (see "Db::set_bt_compare()"). */
+                          project_callback   fn_proj,   /**< [in] Projection function.                                     */
+                          bool               unique,    /**< [in] Whether new index should contain unique keys only.       */
+                          bool               immutable) /**< [in] Whether index keys of a record never change on update.   */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_index] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] name = " << name);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] unique = " << unique);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] immutable = " << immutable);
+
+    check_open();
+
+    index * i = new index(this, name, fn_idx, fn_cmp, m_callback, unique, fn_proj, 0, 0, immutable);
+    assert(i != NULL);
+    m_indexes.push_back(i);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_index] EXIT");
+
+    return i;
+}
+
+/**
+ * Adds new field index to the table, and opens the index.
+ * The index key is a message of the only field "key_field", copied from field "field" of primary data,
+ * like one made by "bdb::index_field". When the table has several field indexes, all indexed fields are
+ * extracted from the data in one pass per change, which is shared by the indexes.
+ * Index of repeated (not packed) field has a key by each value of the field (see "bdb::index_repeated").
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+index * table::add_index (const char       * name,      /**< [in] Name of the index.                                       */
+                          int                field,     /**< [in] Indexed field of primary data.                           */
+                          int                key_field, /**< [in] Field number in index key.                               */
+                          compare_callback   fn_cmp,    /**< [in] Index comparision function (see "Db::set_bt_compare()"). */
+                          bool               unique,    /**< [in] Whether new index should contain unique keys only.       */
+                          bool               immutable, /**< [in] Whether index keys of a record never change on update.   */
+                          bool               repeated)  /**< [in] Whether indexed field is repeated.                       */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_index] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] name = " << name);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] field = " << field);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] unique = " << unique);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] immutable = " << immutable);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] repeated = " << repeated);
+
+    check_open();
+
+    index * i = new index(this, name, (repeated ? index::index_by_repeated : NULL), fn_cmp, m_callback, unique, NULL, field, key_field, immutable);
+    assert(i != NULL);
+    m_indexes.push_back(i);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_index] EXIT");
+
+    return i;
+}
+
+/**
+ * Adds new composite index to the table, and opens the index.
+ * The index key is made from specified fields of primary data (see "bdb::index_fields") in order-preserving
+ * format, so the keys are sorted by Berkeley DB itself, and neither key messages nor comparison function are
+ * needed to maintain the index. The index can be read by any key message, which fields match the leading
+ * indexed fields by types and order (e.g. by range recordset with "BDB_RANGE_PREFIX").
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - no fields are specified.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+index * table::add_index (const char       * name,      /**< [in] Name of the index.                                       */
+                          const int        * fields,    /**< [in] Indexed fields of primary data, in order of the key.     */
+                          const int        * types,     /**< [in] Types of the fields ("BDB_FIELD_STRING").               */
+                          int                count,     /**< [in] Number of the fields.                                    */
+                          bool               unique,    /**< [in] Whether new index should contain unique keys only.       */
+                          bool               immutable) /**< [in] Whether index keys of a record never change on update.   */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_index] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] name = " << name);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] count = " << count);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] unique = " << unique);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] immutable = " << immutable);
+
+    if (count <= 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::add_index] Composite index \"" << name << "\" has no fields.");
+        throw exception(BDB_ERROR_NOT_FOUND);
+    }
+
+    check_open();
+
+    index * i = new index(this, name, NULL, NULL, m_callback, unique, NULL, 0, 0, immutable, NULL, false, fields, types, count);
+    assert(i != NULL);
+    m_indexes.push_back(i);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_index] EXIT");
+
+    return i;
+}
+
+/**
+ * Adds new field index of message types, known at run time only (e.g. parsed from ".proto" files, with
+ * messages made by "google::protobuf::DynamicMessageFactory"), to the table, and opens the index.
+ * The index key is a message of "key_type", which has the field of the same name and type as "field"
+ * of primary data (or the only field of the same type), and index keys are compared by reflection
+ * (see "bdb::table_options::key_type"); otherwise it's the same as the field index above.
+ * Index of repeated field is found by its descriptor.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - index key has no matching field.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+index * table::add_index (const char            * name,         /**< [in] Name of the index.                                    */
+                          const FieldDescriptor * field,        /**< [in] Indexed field of primary data.                        */
+                          const Descriptor      * key_type,     /**< [in] Type of index keys.                                   */
+                          bool                    unique,       /**< [in] Whether new index should contain unique keys only.    */
+                          bool                    immutable)    /**< [in] Whether index keys of a record never change on update. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_index] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] name = " << name);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] field = " << field->full_name());
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] key type = " << key_type->full_name());
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] unique = " << unique);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_index] immutable = " << immutable);
+
+    const FieldDescriptor * key_field = key_type->FindFieldByName(field->name());
+
+    if (key_field == NULL && key_type->field_count() == 1)
+    {
+        key_field = key_type->field(0);
+    }
+
+    if (key_field == NULL || key_field->type() != field->type() || key_field->is_repeated() || field->options().packed())
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::add_index] Index key \"" << key_type->full_name() << "\" has no matching field.");
+        throw exception(BDB_ERROR_NOT_FOUND);
+    }
+
+    check_open();
+
+    index * i = new index(this, name, (field->is_repeated() ? index::index_by_repeated : NULL), index::compare_dynamic, m_callback, unique, NULL,
+                          field->number(), key_field->number(), immutable, message_layout::get(key_type));
+    assert(i != NULL);
+    m_indexes.push_back(i);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_index] EXIT");
+
+    return i;
+}
+
+/**
+ * Adds new full-text index of specified string field to the table, and opens the index.
+ * The record is indexed by each distinct word of the field (see "bdb::index_words"), so records, which
+ * contain some words, are found by the index instead of scanning the table (see "bdb::recordset" of
+ * full-text index). Keys of the index are in order-preserving format, and need no comparison function;
+ * single word can be looked up by any key message with the only string field (e.g. "month::season_ix").
+ * If index doesn't exist yet, then creates it.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+index * table::add_text_index (const char * name,   /**< [in] Name of the index.                    */
+                               int          field)  /**< [in] Indexed string field of primary data. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_text_index] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_text_index] name = " << name);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_text_index] field = " << field);
+
+    check_open();
+
+    // the index is composite one of the only string field, so its keys are ordered strings
+    static const int types[] = { BDB_FIELD_STRING };
+
+    index * i = new index(this, name, index::index_by_words, NULL, m_callback, false, NULL, field, 0, false, NULL, false, &field, types, 1);
+    assert(i != NULL);
+    m_indexes.push_back(i);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_text_index] EXIT");
+
+    return i;
+}
+
+/**
+ * Adds new deferred index to the table, and opens the index.
+ * Changes of the table are not applied to deferred index in transactions of the changes, but are captured
+ * into change log of the database (see "bdb::table_options::capture_changes"), and are applied by background
+ * worker of the database in batches, sorted by index keys. So updates of the table don't wait for the index,
+ * but the index lags behind the table, and reads of the index, which need it fresh, should wait for it
+ * (see "bdb::index::wait_applied"). Deferred index can't be unique.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+index * table::add_deferred_index (const char       * name,     /**< [in] Name of the index.                                       */
+                                   index_callback     fn_idx,   /**< [in] Indexing function (see "Db::associate()").               */
+                                   compare_callback   fn_cmp)   /**< [in] Index comparision function (see "Db::set_bt_compare()"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_deferred_index] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_deferred_index] name = " << name);
+
+    check_open();
+
+    index * i = new index(this, name, fn_idx, fn_cmp, m_callback, false, NULL, 0, 0, false, NULL, true);
+    assert(i != NULL);
+    m_indexes.push_back(i);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_deferred_index] EXIT");
+
+    return i;
+}
+
+/**
+ * Adds materialized aggregate of the table, which is made by specified delta function, and opens it.
+ * The aggregate is maintained by the table on every change of its records, in the same transaction,
+ * so all changes should be done through the table. If the aggregate doesn't exist yet, then creates it
+ * from all records of the table.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+materialized_aggregate * table::add_aggregate (const char         * name,       /**< [in] Name of the aggregate. */
+                                               aggregate_callback   fn_agg)     /**< [in] Delta function.        */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_aggregate] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_aggregate] name = " << name);
+
+    check_open();
+
+    materialized_aggregate * a = new materialized_aggregate(this, name, fn_agg, 0, BDB_FIELD_INT64, 0);
+    assert(a != NULL);
+    m_aggregates.push_back(a);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_aggregate] EXIT");
+
+    return a;
+}
+
+/**
+ * Adds materialized aggregate of integer field of records (count and sum, optionally grouped by raw value
+ * of another field, like "bdb::aggregation"), and opens it; otherwise it's the same as the aggregate above.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error, or the field type is not supported.
+ */
+materialized_aggregate * table::add_aggregate (const char * name,   /**< [in] Name of the aggregate.                               */
+                                               int          field,  /**< [in] Aggregated field ("0" - records are counted only).   */
+                                               int          type,   /**< [in] Type of the field (see @ref fieldtypes "types").     */
+                                               int          group)  /**< [in] Grouping field ("0" - all records are in one group). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_aggregate] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_aggregate] name = " << name);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_aggregate] field = " << field << ", type = " << type << ", group = " << group);
+
+    check_open();
+
+    materialized_aggregate * a = new materialized_aggregate(this, name, NULL, field, type, group);
+    assert(a != NULL);
+    m_aggregates.push_back(a);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_aggregate] EXIT");
+
+    return a;
+}
+
+/**
+ * Adds column store of specified integer fields of records, and opens it (see "bdb::column_store").
+ * The store is maintained by the table on every change of its records, in the same transaction,
+ * so all changes should be done through the table. If the store doesn't exist yet, then creates it
+ * from all records of the table.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error, or type of a field is not supported.
+ */
+column_store * table::add_columns (const char   * name,     /**< [in] Name of the store.                                 */
+                                   const int    * fields,   /**< [in] Projected fields.                                  */
+                                   const int    * types,    /**< [in] Types of the fields (see @ref fieldtypes "types"). */
+                                   int            count,    /**< [in] Number of the fields.                              */
+                                   unsigned int   rows)     /**< [in] Maximum number of rows of a chunk.                 */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_columns] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::add_columns] name = " << name << ", count = " << count << ", rows = " << rows);
+
+    check_open();
+
+    column_store * c = new column_store(this, name, fields, types, count, rows);
+    assert(c != NULL);
+    m_columns.push_back(c);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::add_columns] EXIT");
+
+    return c;
+}
+
+/**
+ * Checks whether a record with specified key exists in the table.
+ * If the table has Bloom filter of keys (see "bdb::table_options"), keys which were never written through
+ * this object are reported missing without lookup, so the table shouldn't be changed by other processes then.
+ * <strong>NOTE:</strong> all keys in the table are unique.
+ *
+ * @return true  - the record exists.
+ * @return false - the record is not found.
+ */
+bool table::exists (key_ref         key,    /**< [in] Key of the record to be checked.             */
+                    transaction   * txn)    /**< [in] Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::exists] ENTER");
+
+    latency_scope latency(BDB_LATENCY_EXISTS);
+    slow_scope    slow(m_database, BDB_LATENCY_EXISTS, m_name.c_str());
+
+    check_open();
+
+    scratch_scope scope;
+    DBT k;
+
+    encode_key(key, &k, &scope);
+    sample_key(&k);
+    slow.set_sizes(k.size, 0);
+
+    // definitely absent keys are not looked up in the table
+    int res = DB_NOTFOUND;
+
+    if (m_bloom == NULL || m_bloom->may_contain(&k))
+    {
+        latency_scope berkeley(BDB_LATENCY_BERKELEY);
+        res = m_db->exists(m_db, m_database->get_transaction(txn), &k, m_database->read_flags(txn));
+    }
+
+    release(&k);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::exists] EXIT = " << (res == 0));
+
+    return (res == 0);
+}
+
+/**
+ * Deletes specified existing record.
+ * <strong>NOTE:</strong> all keys in the table are unique.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND   - the record is not found.
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - this table has a foreign constraint to another one,
+ *                                               and slave table contains specified key.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ */
+void table::remove (key_ref         key,    /**< [in] Key of the record to be deleted.             */
+                    transaction   * txn)    /**< [in] Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::remove] ENTER");
+
+    int res = remove_key(key, txn);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::remove] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_NOTFOUND:           throw exception(BDB_ERROR_NOT_FOUND);
+            case DB_KEYEMPTY:           throw exception(BDB_ERROR_NOT_FOUND);
+            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::remove] EXIT");
+}
+
+/**
+ * Deletes specified existing record, like "remove", but reports the outcome instead of throwing,
+ * and logs unexpected errors only (e.g. to remove records, which are often missing, in a hot path).
+ *
+ * @return 0                     - the record is deleted.
+ * @return BDB_ERROR_NOT_FOUND   - the record is not found.
+ * @return BDB_ERROR_FOREIGN_KEY - this table has a foreign constraint to another one,
+ *                                 and slave table contains specified key.
+ * @return BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @return BDB_ERROR_UNKNOWN     - unknown error.
+ */
+int table::try_remove (key_ref         key,     /**< [in] Key of the record to be deleted.             */
+                       transaction   * txn)     /**< [in] Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::try_remove] ENTER");
+
+    int res = remove_key(key, txn);
+
+    switch (res)
+    {
+        case 0:                     break;
+        case DB_NOTFOUND:           res = BDB_ERROR_NOT_FOUND;      break;
+        case DB_KEYEMPTY:           res = BDB_ERROR_NOT_FOUND;      break;
+        case DB_FOREIGN_CONFLICT:   res = BDB_ERROR_FOREIGN_KEY;    break;
+        case DB_LOCK_DEADLOCK:      res = BDB_ERROR_DEADLOCK;       break;
+        case DB_LOCK_NOTGRANTED:    res = BDB_ERROR_DEADLOCK;       break;
+        default:
+            LOG4CPLUS_WARN(logger, "[bdb::table::try_remove] " << db_strerror(res));
+            res = BDB_ERROR_UNKNOWN;
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::try_remove] EXIT = " << res);
+
+    return res;
+}
+
+/**
+ * Inserts specified new record into the table.
+ * <strong>NOTE:</strong> all keys in the table are unique.
+ *
+ * @throw bdb::exception BDB_ERROR_EXISTS      - a record with specified key already exists,
+ *                                               or unique index already contains specified value.
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - this table has a foreign constraint to another one,
+ *                                               and master table doesn't contain specified key.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ */
+void table::insert (key_ref             key,    /**< [in] Key of new record.                           */
+                    const MessageLite * data,   /**< [in] Data of new record.                          */
+                    transaction       * txn)    /**< [in] Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::insert] ENTER");
+
+    int res = insert_key(key, data, txn);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::insert] " << db_strerror(res));
+
+        switch (res)
+        {
+            case EINVAL:                throw exception(BDB_ERROR_EXISTS);
+            case DB_KEYEXIST:           throw exception(BDB_ERROR_EXISTS);
+            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::insert] EXIT");
+}
+
+/**
+ * Inserts specified new record into the table, like "insert", but reports the outcome instead of throwing,
+ * and logs unexpected errors only (e.g. to fill a cache, when the record may be inserted by others meanwhile).
+ *
+ * @return 0                     - the record is inserted.
+ * @return BDB_ERROR_EXISTS      - a record with specified key already exists,
+ *                                 or unique index already contains specified value.
+ * @return BDB_ERROR_FOREIGN_KEY - this table has a foreign constraint to another one,
+ *                                 and master table doesn't contain specified key.
+ * @return BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @return BDB_ERROR_UNKNOWN     - unknown error.
+ */
+int table::try_insert (key_ref             key,     /**< [in] Key of new record.                           */
+                       const MessageLite * data,    /**< [in] Data of new record.                          */
+                       transaction       * txn)     /**< [in] Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::try_insert] ENTER");
+
+    int res = insert_key(key, data, txn);
+
+    switch (res)
+    {
+        case 0:                     break;
+        case EINVAL:                res = BDB_ERROR_EXISTS;         break;
+        case DB_KEYEXIST:           res = BDB_ERROR_EXISTS;         break;
+        case DB_FOREIGN_CONFLICT:   res = BDB_ERROR_FOREIGN_KEY;    break;
+        case DB_LOCK_DEADLOCK:      res = BDB_ERROR_DEADLOCK;       break;
+        case DB_LOCK_NOTGRANTED:    res = BDB_ERROR_DEADLOCK;       break;
+        default:
+            LOG4CPLUS_WARN(logger, "[bdb::table::try_insert] " << db_strerror(res));
+            res = BDB_ERROR_UNKNOWN;
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::try_insert] EXIT = " << res);
+
+    return res;
+}
+
+/**
+ * Inserts specified new record into heap table (see "BDB_ACCESS_HEAP"), and returns its generated id.
+ * Later the record is accessed by key of single integer field, which value is the id (see "bdb::serialize_rid"),
+ * and its id is never changed. Ids of removed records may be reused by new ones.
+ * Records of recno and queue tables are appended to their ends, and their ids are their record numbers.
+ *
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - this table has a foreign constraint to another one,
+ *                                               and master table doesn't contain specified key.
+ * @throw bdb::exception BDB_ERROR_EXISTS      - unique index already contains specified value.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - the table is not a heap (recno, queue) one, or unknown error.
+ */
+uint64_t table::insert (const MessageLite * data,   /**< [in] Data of new record.                          */
+                        transaction       * txn)    /**< [in] Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::insert] ENTER");
+
+    if (!is_numbered())
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::insert] Ids of records are generated by heap, recno and queue tables only.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    latency_scope latency(BDB_LATENCY_INSERT);
+    slow_scope    slow(m_database, BDB_LATENCY_INSERT, m_name.c_str());
+
+    check_open();
+
+    scratch_scope scope;
+    DBT k, d;
+
+    // generated key is either a record number, or a record id ("DB_HEAP_RID")
+    uint64_t generated[2] = { 0, 0 };
+
+    memset(&k, 0, sizeof(DBT));
+    k.flags = DB_DBT_USERMEM;
+    k.data  = generated;
+    k.ulen  = sizeof(generated);
+
+    scope.serialize(data, &d);
+    stamp_value(&d, &scope);
+    slow.set_sizes(sizeof(generated), d.size);
+
+    DB_TXN * t   = m_database->get_transaction(txn);
+    DB_TXN * own = NULL;
+
+    int res = m_database->begin_auto(&t, &own);
+
+    if (res == 0) res = append_new(t, &k, &d);
+
+    res = m_database->end_auto(own, res);
+
+    release(&d);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::insert] " << db_strerror(res));
+
+        switch (res)
+        {
+            case EINVAL:                throw exception(BDB_ERROR_EXISTS);
+            case DB_KEYEXIST:           throw exception(BDB_ERROR_EXISTS);
+            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    uint64_t id = 0;
+
+    if (m_options.access_method != BDB_ACCESS_HEAP)
+    {
+        db_recno_t recno;
+        memcpy(&recno, generated, sizeof(db_recno_t));
+
+        id = recno;
+    }
+    else
+    {
+#ifdef BDB_HEAP
+        DB_HEAP_RID rid;
+        memcpy(&rid, generated, sizeof(DB_HEAP_RID));
+
+        id = ((uint64_t) rid.pgno << 16) | rid.indx;
+#endif
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::insert] EXIT = " << id);
+
+    return id;
+}
+
+/**
+ * Inserts specified new record with generated key, and returns the key and its id.
+ * The key consists of a single integer field, which value is the id. Records of heap, recno and queue tables
+ * get their ids from Berkeley DB ("DB_APPEND", see "bdb::table::insert"), and the sequence is not used (may be
+ * "NULL"). Ids of other tables are allocated by the sequence in the same transaction, so keys of new records
+ * grow, and new records are appended to the right edge of Btree table.
+ *
+ * @throw bdb::exception BDB_ERROR_EXISTS      - a record with generated key already exists,
+ *                                               or unique index already contains specified value.
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - this table has a foreign constraint to another one,
+ *                                               and master table doesn't contain specified key.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - no sequence is specified for the table, or unknown error.
+ */
+uint64_t table::insert_auto (sequence          * seq,       /**< [in]  Sequence of the ids ("NULL" - ids are generated by Berkeley DB). */
+                             const MessageLite * data,      /**< [in]  Data of new record.                          */
+                             Message           * key,       /**< [out] Generated key of new record.                 */
+                             transaction       * txn)       /**< [in]  Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::insert_auto] ENTER");
+
+    uint64_t id;
+
+    if (is_numbered())
+    {
+        id = insert(data, txn);
+        set_id(key, id);
+    }
+    else if (seq != NULL)
+    {
+        id = (uint64_t) seq->id(txn);
+        set_id(key, id);
+        insert(key, data, txn);
+    }
+    else
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::insert_auto] Ids of records of the table are allocated by sequence only.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::insert_auto] EXIT = " << id);
+
+    return id;
+}
+
+/**
+ * Updates specified existing record.
+ * <strong>NOTE:</strong> all keys in the table are unique.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND   - the record is not found.
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - this table has a foreign constraint to another one,
+ *                                               and master table doesn't contain specified new key.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ */
+void table::update (key_ref             key,    /**< [in] Key of the record to be updated.             */
+                    const MessageLite * data,   /**< [in] New data of the record.                      */
+                    transaction       * txn)    /**< [in] Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::update] ENTER");
+
+    latency_scope latency(BDB_LATENCY_UPDATE);
+    slow_scope    slow(m_database, BDB_LATENCY_UPDATE, m_name.c_str());
+
+    check_open();
+
+    scratch_scope scope;
+    DBT k, d;
+
+    encode_key(key, &k, &scope);
+    sample_key(&k);
+    scope.serialize(data, &d);
+    stamp_value(&d, &scope);
+    slow.set_sizes(k.size, d.size);
+
+    DB_TXN * t   = m_database->get_transaction(txn);
+    DB_TXN * own = NULL;
+
+    int res = m_database->begin_auto(&t, &own);
+
+    if (res == 0) res = update_record(t, &k, &d);
+
+    res = m_database->end_auto(own, res);
+
+    release(&k);
+    release(&d);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::update] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_NOTFOUND:           throw exception(BDB_ERROR_NOT_FOUND);
+            case DB_KEYEMPTY:           throw exception(BDB_ERROR_NOT_FOUND);
+            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::update] EXIT");
+}
+
+/**
+ * Appends specified fragment to data of specified existing record, e.g. new entries of its repeated fields,
+ * since concatenated ProtoBuf messages are parsed as one merged message. The fragment is written at the end
+ * of the stored value ("DB_DBT_PARTIAL"), so the write and its log take the size of the fragment, not of the
+ * whole record. Compressed records, and records of tables with covering indexes, materialized aggregates or
+ * captured changes are rewritten as a whole (see "bdb::table::merge"), since they need the whole data.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND   - the record is not found.
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - foreign constraint violation.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ */
+void table::append_bytes (key_ref             key,      /**< [in] Key of the record to be appended.            */
+                          const MessageLite * fragment, /**< [in] Fragment of data to append.                  */
+                          transaction       * txn)      /**< [in] Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::append_bytes] ENTER");
+
+    latency_scope latency(BDB_LATENCY_UPDATE);
+    slow_scope    slow(m_database, BDB_LATENCY_UPDATE, m_name.c_str());
+
+    check_open();
+
+    scratch_scope scope;
+    DBT k, d;
+
+    // the fragment is appended as it is, so it's never compressed
+    encode_key(key, &k, &scope);
+    sample_key(&k);
+    scope.serialize(fragment, &d, false);
+    slow.set_sizes(k.size, d.size);
+
+    DB_TXN * t   = m_database->get_transaction(txn);
+    DB_TXN * own = NULL;
+
+    int res = m_database->begin_auto(&t, &own);
+
+    if (res == 0) res = append_record(t, &k, &d);
+
+    res = m_database->end_auto(own, res);
+
+    release(&k);
+    release(&d);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::append_bytes] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_NOTFOUND:           throw exception(BDB_ERROR_NOT_FOUND);
+            case DB_KEYEMPTY:           throw exception(BDB_ERROR_NOT_FOUND);
+            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::append_bytes] EXIT");
+}
+
+/**
+ * Inserts new record, or updates existing one with the same key.
+ * <strong>NOTE:</strong> all keys in the table are unique.
+ *
+ * @return true  - new record is created.
+ * @return false - existing record is updated.
+ *
+ * @throw bdb::exception BDB_ERROR_EXISTS      - the same key already exists in a unique index.
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - foreign constraint violation.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ */
+bool table::upsert (key_ref             key,    /**< [in] Key of the record.                           */
+                    const MessageLite * data,   /**< [in] Data of the record.                          */
+                    transaction       * txn)    /**< [in] Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::upsert] ENTER");
+
+    latency_scope latency(BDB_LATENCY_UPSERT);
+    slow_scope    slow(m_database, BDB_LATENCY_UPSERT, m_name.c_str());
+
+    check_open();
+
+    scratch_scope scope;
+    DBT k, d;
+
+    encode_key(key, &k, &scope);
+    sample_key(&k);
+    scope.serialize(data, &d);
+    stamp_value(&d, &scope);
+    slow.set_sizes(k.size, d.size);
+
+    DB_TXN * t   = m_database->get_transaction(txn);
+    DB_TXN * own = NULL;
+
+    DBT old;
+    memset(&old, 0, sizeof(DBT));
+    old.flags = (is_tracked() ? DB_DBT_MALLOC : DB_DBT_PARTIAL);
+
+    int res = m_database->begin_auto(&t, &own);
+
+    // the record is located and locked for writing once, and then is either overwritten or added
+    DBC * cursor = NULL;
+
+    if (res == 0) res = m_db->cursor(m_db, t, &cursor, m_database->write_flags());
+
+    bool created = false;
+
+    if (res == 0)
+    {
+        res = cursor->get(cursor, &k, &old, DB_SET | DB_RMW);
+
+        // record numbers of removed records are kept empty
+        if (res == DB_NOTFOUND || res == DB_KEYEMPTY)
+        {
+            created = true;
+            if (m_bloom != NULL) m_bloom->add(&k);
+            res = (is_numbered() ? m_db->put(m_db, t, &k, &d, 0) : cursor->put(cursor, &k, &d, DB_KEYFIRST));
+        }
+        else if (res == 0)
+        {
+            res = cursor->put(cursor, &k, &d, DB_CURRENT);
+        }
+    }
+
+    if (res == 0 && is_tracked()) res = track_change(t, &k, (created ? NULL : &old), &d);
+
+    // the record is locked, so concurrent readers can't cache it until the transaction is resolved
+    if (res == 0 && m_cache != NULL) m_cache->invalidate(&k);
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    res = m_database->end_auto(own, res);
+
+    release(&k);
+    release(&d);
+
+    if (is_tracked()) free(old.data);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::upsert] " << db_strerror(res));
+
+        switch (res)
+        {
+            case EINVAL:                throw exception(BDB_ERROR_EXISTS);
+            case DB_KEYEXIST:           throw exception(BDB_ERROR_EXISTS);
+            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::upsert] EXIT = " << created);
+
+    return created;
+}
+
+/**
+ * Modifies specified existing record in place.
+ * The record is locked for writing before it's read, so concurrent modifications of the same record never
+ * upgrade read locks. Each attempt runs in its own nested transaction, which is retried (with exponential
+ * backoff) when it's chosen as a deadlock victim.
+ * <strong>NOTE:</strong> all keys in the table are unique.
+ *
+ * @return true  - the record is changed.
+ * @return false - the callback function left the record unchanged.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND   - the record is not found.
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - foreign constraint violation.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ */
+bool table::modify (key_ref           key,      /**< [in]  Key of the record to be modified.              */
+                    Message         * data,     /**< [out] Reusable message for data of the record.       */
+                    modify_callback   fn_mod,   /**< [in]  Modification function.                         */
+                    void            * param,    /**< [in]  Parameter to pass to the modification function. */
+                    transaction     * txn)      /**< [in]  Transaction to use (current one, if "NULL").   */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::modify] ENTER");
+
+    check_open();
+
+    scratch_scope scope;
+    DBT k;
+
+    encode_key(key, &k, &scope);
+    sample_key(&k);
+
+    DB_TXN * parent = m_database->get_transaction(txn);
+
+    bool changed = false;
+    long backoff = MODIFY_BACKOFF_MIN;
+
+    int res = 0;
+
+    for (int attempt = 0; ; attempt++)
+    {
+        DB_TXN * ctxn = NULL;
+
+        res = m_database->begin_txn(parent, &ctxn, BDB_DURABILITY_DEFAULT);
+
+        if (res == 0) res = modify_once(ctxn, &k, data, fn_mod, param, &changed);
+
+        if (res == 0)
+        {
+            res = m_database->commit_txn(ctxn, BDB_DURABILITY_DEFAULT, parent != NULL);
+        }
+        else if (ctxn != NULL)
+        {
+            m_database->abort_txn(ctxn);
+        }
+
+        if (res != DB_LOCK_DEADLOCK || attempt == MODIFY_MAX_RETRIES)
+        {
+            break;
+        }
+
+        LOG4CPLUS_DEBUG(logger, "[bdb::table::modify] retry = " << attempt + 1);
+
+        boost::this_thread::sleep(boost::posix_time::milliseconds(backoff));
+
+        if (backoff < MODIFY_BACKOFF_MAX) backoff *= 2;
+    }
+
+    release(&k);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::modify] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_NOTFOUND:           throw exception(BDB_ERROR_NOT_FOUND);
+            case DB_KEYEMPTY:           throw exception(BDB_ERROR_NOT_FOUND);
+            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::modify] EXIT = " << changed);
+
+    return changed;
+}
+
+/**
+ * Merges specified delta into the record with specified key by merge function (see "merge_callback"), e.g.
+ * increments a counter ("bdb::merge_add") or appends to repeated fields ("bdb::merge_append"), without
+ * reading the record by the application: the record is located and locked for writing once ("DB_RMW"),
+ * and the function merges serialized messages, so neither the record nor the delta is parsed. Missing record
+ * is created by merging the delta into no data. Keys of immutable indexes are not rewritten.
+ * Like "modify", each attempt runs in its own nested transaction, which is retried on deadlock.
+ *
+ * @return true  - new record is created.
+ * @return false - existing record is merged (or the function left it as it is).
+ *
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - foreign constraint violation.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ */
+bool table::merge (key_ref             key,         /**< [in] Key of the record.                        */
+                   const MessageLite * delta,       /**< [in] Delta to merge into the record.           */
+                   merge_callback      fn_merge,    /**< [in] Merge function.                           */
+                   void              * param,       /**< [in] Parameter to pass to the merge function.  */
+                   transaction       * txn)         /**< [in] Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::merge] ENTER");
+
+    latency_scope latency(BDB_LATENCY_UPSERT);
+    slow_scope    slow(m_database, BDB_LATENCY_UPSERT, m_name.c_str());
+
+    check_open();
+
+    scratch_scope scope;
+    DBT k, d;
+
+    // the delta is merged as it is, so it's never compressed
+    encode_key(key, &k, &scope);
+    sample_key(&k);
+    scope.serialize(delta, &d, false);
+    slow.set_sizes(k.size, d.size);
+
+    DB_TXN * parent = m_database->get_transaction(txn);
+
+    bool created = false;
+    long backoff = MODIFY_BACKOFF_MIN;
+
+    int res = 0;
+
+    for (int attempt = 0; ; attempt++)
+    {
+        DB_TXN * ctxn = NULL;
+
+        res = m_database->begin_txn(parent, &ctxn, BDB_DURABILITY_DEFAULT);
+
+        if (res == 0) res = merge_record(ctxn, &k, &d, fn_merge, param, &created);
+
+        if (res == 0)
+        {
+            res = m_database->commit_txn(ctxn, BDB_DURABILITY_DEFAULT, parent != NULL);
+        }
+        else if (ctxn != NULL)
+        {
+            m_database->abort_txn(ctxn);
+        }
+
+        if (res != DB_LOCK_DEADLOCK || attempt == MODIFY_MAX_RETRIES)
+        {
+            break;
+        }
+
+        LOG4CPLUS_DEBUG(logger, "[bdb::table::merge] retry = " << attempt + 1);
+
+        boost::this_thread::sleep(boost::posix_time::milliseconds(backoff));
+
+        if (backoff < MODIFY_BACKOFF_MAX) backoff *= 2;
+    }
+
+    release(&k);
+    release(&d);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::merge] " << db_strerror(res));
+
+        switch (res)
+        {
+            case EINVAL:                throw exception(BDB_ERROR_EXISTS);
+            case DB_KEYEXIST:           throw exception(BDB_ERROR_EXISTS);
+            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::merge] EXIT = " << created);
+
+    return created;
+}
+
+/**
+ * Inserts specified records into the table.
+ * Records are serialized into a single bulk buffer, which is put into the table at once ("DB_MULTIPLE_KEY"),
+ * so per-record overhead is much lower than for separate inserts. With Berkeley DB prior to 4.8 the records
+ * are inserted one by one.
+ *
+ * If "chunk" is not zero, each "chunk" of records is inserted and committed in its own nested transaction.
+ * When an error occurs, the failed chunk is rolled back, while previous chunks remain committed.
+ *
+ * @throw bdb::exception BDB_ERROR_EXISTS      - the same key already exists.
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - foreign constraint violation.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ */
+void table::insert_bulk (const bulklist & records,  /**< [in] List of records to insert.                       */
+                         transaction    * txn,      /**< [in] Transaction to use (current one, if "NULL").    */
+                         unsigned int     chunk)    /**< [in] Number of records per committed chunk ("0" - all). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::insert_bulk] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::insert_bulk] records = " << records.size());
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::insert_bulk] chunk = " << chunk);
+
+    check_open();
+
+    DB_TXN * parent = m_database->get_transaction(txn);
+    DB_TXN * ctxn   = NULL;
+    DB_TXN * own    = NULL;
+
+    // all records are inserted at once, unless they are committed by chunks
+    int res = (chunk == 0 ? m_database->begin_auto(&parent, &own) : 0);
+
+    unsigned int count = 0;     // records in current chunk
+
+#ifdef BDB_BULK_PUT
+
+    vector <char> buffer(BULK_BUFFER_SIZE);
+
+    DBT bulk, empty;
+    memset(&bulk,  0, sizeof(bulk));
+    memset(&empty, 0, sizeof(empty));
+
+    bulk.data  = &buffer[0];
+    bulk.ulen  = buffer.size();
+    bulk.flags = DB_DBT_USERMEM | DB_DBT_BULK;
+
+    void * ptr = NULL;
+    DB_MULTIPLE_WRITE_INIT(ptr, &bulk);
+
+    unsigned int buffered = 0;  // records in bulk buffer
+
+#endif
+
+    for (unsigned int i = 0; i < records.size() && res == 0; i++)
+    {
+        if (chunk != 0 && ctxn == NULL)
+        {
+            res = m_database->begin_txn(parent, &ctxn, BDB_DURABILITY_DEFAULT);
+            if (res != 0) break;
+        }
+
+        DB_TXN * t = (ctxn != NULL ? ctxn : parent);
+
+        scratch_scope scope;
+        DBT k, d;
+
+        encode_key(records[i].first, &k, &scope);
+        scope.serialize(records[i].second, &d);
+        stamp_value(&d, &scope);
+
+#ifdef BDB_BULK_PUT
+
+        write_bulk(ptr, &bulk, &k, &d);
+
+        if (ptr == NULL)
+        {
+            // the buffer is full - flush it, and try again
+            if (buffered != 0)
+            {
+                res = m_db->put(m_db, t, &bulk, &empty, DB_MULTIPLE_KEY | DB_NOOVERWRITE);
+                buffered = 0;
+            }
+
+            // the record doesn't fit into empty buffer - enlarge the buffer
+            size_t needed = k.size + d.size + BULK_RECORD_OVERHEAD;
+
+            if (buffer.size() < needed)
+            {
+                buffer.resize(needed);
+                bulk.data = &buffer[0];
+                bulk.ulen = buffer.size();
+            }
+
+            DB_MULTIPLE_WRITE_INIT(ptr, &bulk);
+            write_bulk(ptr, &bulk, &k, &d);
+            assert(ptr != NULL);
+        }
+
+        buffered++;
+
+#else
+
+        if (m_bloom != NULL) m_bloom->add(&k);
+        res = m_db->put(m_db, t, &k, &d, DB_NOOVERWRITE);
+
+#endif
+
+        // projections and captured changes are added ahead of buffered records, the chunk is rolled back on error anyway
+        if (res == 0 && is_tracked()) res = track_change(t, &k, NULL, &d);
+
+        release(&k);
+        release(&d);
+
+        if (res == 0 && chunk != 0 && ++count == chunk)
+        {
+#ifdef BDB_BULK_PUT
+            if (buffered != 0)
+            {
+                res = m_db->put(m_db, t, &bulk, &empty, DB_MULTIPLE_KEY | DB_NOOVERWRITE);
+                buffered = 0;
+                DB_MULTIPLE_WRITE_INIT(ptr, &bulk);
+            }
+#endif
+
+            if (res == 0)
+            {
+                DB_TXN * committed = ctxn;
+                ctxn  = NULL;
+                count = 0;
+                res = m_database->commit_txn(committed, BDB_DURABILITY_DEFAULT, parent != NULL);
+            }
+        }
+    }
+
+#ifdef BDB_BULK_PUT
+    if (res == 0 && buffered != 0)
+    {
+        res = m_db->put(m_db, (ctxn != NULL ? ctxn : parent), &bulk, &empty, DB_MULTIPLE_KEY | DB_NOOVERWRITE);
+    }
+#endif
+
+    if (res == 0 && ctxn != NULL)
+    {
+        DB_TXN * committed = ctxn;
+        ctxn = NULL;
+        res = m_database->commit_txn(committed, BDB_DURABILITY_DEFAULT, parent != NULL);
+    }
+
+    res = m_database->end_auto(own, res);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::insert_bulk] " << db_strerror(res));
+
+        if (ctxn != NULL) m_database->abort_txn(ctxn);
+
+        switch (res)
+        {
+            case EINVAL:                throw exception(BDB_ERROR_EXISTS);
+            case DB_KEYEXIST:           throw exception(BDB_ERROR_EXISTS);
+            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::insert_bulk] EXIT");
+}
+
+/**
+ * Finds a record with specified key and returns its data.
+ * If the table has cache of records (see "bdb::table_options"), records are read through the cache outside
+ * of transactions, while reads in transactions always go to the table.
+ * <strong>NOTE:</strong> all keys in the table are unique.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the record is not found.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK  - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void table::select (key_ref         key,    /**< [in]  Key of the record to be retrieved.          */
+                    MessageLite   * data,   /**< [out] Data of the found record.                   */
+                    transaction   * txn)    /**< [in]  Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::select] ENTER");
+
+    int res = select_key(key, data, txn, false);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::select] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_NOTFOUND:           throw exception(BDB_ERROR_NOT_FOUND);
+            case DB_KEYEMPTY:           throw exception(BDB_ERROR_NOT_FOUND);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::select] EXIT");
+}
+
+/**
+ * Finds a record with specified key and returns its data, like "select", but reports missing record
+ * without an exception and without logging, so frequent misses (e.g. of a cache-fill path) are cheap.
+ * If the table has Bloom filter of keys (see "bdb::table_options"), definitely absent keys are not
+ * looked up, as by "exists".
+ *
+ * @return true  - the record is found.
+ * @return false - the record is not found ("data" is not changed).
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error.
+ */
+bool table::find (key_ref         key,      /**< [in]  Key of the record to be retrieved.          */
+                  MessageLite   * data,     /**< [out] Data of the found record.                   */
+                  transaction   * txn)      /**< [in]  Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::find] ENTER");
+
+    int res = select_key(key, data, txn, true);
+
+    if (res == DB_NOTFOUND || res == DB_KEYEMPTY)
+    {
+        LOG4CPLUS_TRACE(logger, "[bdb::table::find] EXIT = false");
+        return false;
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::find] " << db_strerror(res));
+
+        switch (res)
+        {
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::find] EXIT = true");
+
+    return true;
+}
+
+/**
+ * @private Deletes specified existing record (see "remove").
+ *
+ * @return Berkeley DB error code.
+ */
+int table::remove_key (key_ref       key,   /**< [in] Key of the record to be deleted. */
+                       transaction * txn)   /**< [in] Transaction to use.              */
+{
+    latency_scope latency(BDB_LATENCY_REMOVE);
+    slow_scope    slow(m_database, BDB_LATENCY_REMOVE, m_name.c_str());
+
+    check_open();
+
+    scratch_scope scope;
+    DBT k;
+
+    DB_TXN * t   = m_database->get_transaction(txn);
+    DB_TXN * own = NULL;
+
+    encode_key(key, &k, &scope);
+    sample_key(&k);
+    slow.set_sizes(k.size, 0);
+
+    int res = m_database->begin_auto(&t, &own);
+
+    if (res == 0) res = remove_record(t, &k);
+
+    res = m_database->end_auto(own, res);
+
+    release(&k);
+
+    return res;
+}
+
+/**
+ * @private Inserts specified new record (see "insert").
+ *
+ * @return Berkeley DB error code.
+ */
+int table::insert_key (key_ref             key,     /**< [in] Key of new record.  */
+                       const MessageLite * data,    /**< [in] Data of new record. */
+                       transaction       * txn)     /**< [in] Transaction to use. */
+{
+    latency_scope latency(BDB_LATENCY_INSERT);
+    slow_scope    slow(m_database, BDB_LATENCY_INSERT, m_name.c_str());
+
+    check_open();
+
+    scratch_scope scope;
+    DBT k, d;
+
+    encode_key(key, &k, &scope);
+    sample_key(&k);
+    scope.serialize(data, &d);
+    stamp_value(&d, &scope);
+    slow.set_sizes(k.size, d.size);
+
+    DB_TXN * t   = m_database->get_transaction(txn);
+    DB_TXN * own = NULL;
+
+    int res = m_database->begin_auto(&t, &own);
+
+    if (res == 0) res = insert_record(t, &k, &d);
+
+    res = m_database->end_auto(own, res);
+
+    release(&k);
+    release(&d);
+
+    return res;
+}
+
+/**
+ * @private Finds a record with specified key and returns its data (see "select").
+ *
+ * @return Berkeley DB error code.
+ */
+int table::select_key (key_ref         key,     /**< [in]  Key of the record to be retrieved.          */
+                       MessageLite   * data,    /**< [out] Data of the found record.                   */
+                       transaction   * txn,     /**< [in]  Transaction to use.                         */
+                       bool            filter)  /**< [in]  Whether to check Bloom filter of keys first. */
+{
+    latency_scope latency(BDB_LATENCY_SELECT);
+    slow_scope    slow(m_database, BDB_LATENCY_SELECT, m_name.c_str());
+
+    check_open();
+
+    scratch_scope scope;
+    DBT k, d;
+
+    memset(&d, 0, sizeof(DBT));
+    d.flags = DB_DBT_USERMEM;
+    d.ulen  = SELECT_BUFFER_SIZE;
+    d.data  = scope.alloc(d.ulen);
+
+    encode_key(key, &k, &scope);
+    sample_key(&k);
+
+    // definitely absent keys are not looked up in the table
+    if (filter && m_bloom != NULL && !m_bloom->may_contain(&k))
+    {
+        slow.set_sizes(k.size, 0);
+        release(&k);
+
+        return DB_NOTFOUND;
+    }
+
+    // uncommitted changes are never cached, since the cache is used outside of transactions only
+    bool cached = (m_cache != NULL && m_database->get_transaction(txn) == NULL);
+
+    string value;
+
+    if (cached && m_cache->get(&k, &value))
+    {
+        slow.set_sizes(k.size, value.size());
+        release(&k);
+
+        d.data = (void *) value.data();
+        d.size = (u_int32_t) value.size();
+
+        // expired record is missing, even if it's not removed yet
+        if (is_expired(&d)) return DB_NOTFOUND;
+
+        unserialize_data(&d, data);
+
+        return 0;
+    }
+
+    unsigned long generation = (cached ? m_cache->generation(&k) : 0);
+
+    int res;
+
+    {
+        latency_scope berkeley(BDB_LATENCY_BERKELEY);
+
+        res = m_db->get(m_db, m_database->get_transaction(txn), &k, &d, m_database->read_flags(txn));
+
+        if (res == DB_BUFFER_SMALL)
+        {
+            d.ulen = d.size;
+            d.data = scope.alloc(d.ulen);
+            res = m_db->get(m_db, m_database->get_transaction(txn), &k, &d, m_database->read_flags(txn));
+        }
+    }
+
+    // data of external files are too large to be cached
+    if (m_options.blob_threshold != 0 && d.size >= m_options.blob_threshold) cached = false;
+
+    // the cache, which evicts records for lack of memory, asks the budget for more
+    if (res == 0 && cached && m_cache->put(&k, &d, generation) && m_database->m_governor != NULL) m_database->m_governor->rebalance();
+
+    slow.set_sizes(k.size, (res == 0 ? d.size : 0));
+    release(&k);
+
+    if (res == 0 && is_expired(&d)) res = DB_NOTFOUND;
+
+    if (res == 0) unserialize_data(&d, data);
+    release(&d);
+
+    return res;
+}
+
+/**
+ * Finds record with specified key and parses its data incrementally, reading them by chunks ("DB_DBT_PARTIAL"),
+ * so only one chunk of large data is in memory at a time besides the parsed message (see "bdb::value_stream").
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the record is not found.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK  - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void table::select_stream (key_ref         key,    /**< [in]  Key of the record to be retrieved.          */
+                           Message       * data,   /**< [out] Found data.                                 */
+                           transaction   * txn,    /**< [in]  Transaction to use (current one, if "NULL"). */
+                           unsigned int    chunk)  /**< [in]  Size of chunks in bytes ("0" - default).     */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::select_stream] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::select_stream] chunk = " << chunk);
+
+    check_open();
+
+    value_stream stream(this, key, txn, chunk);
+
+    data->ParseFromZeroCopyStream(&stream);
+
+    if (stream.error() != 0)
+    {
+        throw exception(stream.error());
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::select_stream] EXIT");
+}
+
+/** @private Orders serialized keys (given by their positions) the way the table sorts them. */
+class key_order
+{
+public:
+
+    key_order (table * tbl, const vector <DBT> & keys)
+      : m_table(tbl),
+        m_keys(keys)
+    { }
+
+    bool operator () (size_t i1, size_t i2) const
+    {
+        return m_table->compare_keys(&m_keys[i1], &m_keys[i2]) < 0;
+    }
+
+protected:
+
+    table               * m_table;
+    const vector <DBT>  & m_keys;
+};
+
+/**
+ * Finds records with specified keys and returns their data.
+ * The keys are sorted in order of the table, and the records are retrieved by single cursor, moving forward,
+ * so neighbouring records are read from the same pages. Results are returned in original order of the keys.
+ * <strong>NOTE:</strong> all keys in the table are unique.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void table::select_many (const keylist   & keys,    /**< [in]  Keys of the records to be retrieved.                  */
+                         const datalist  & data,    /**< [out] Data of the found records (one message per key).     */
+                         vector <bool>   * found,   /**< [out] Whether record of each key is found.                 */
+                         transaction     * txn)     /**< [in]  Transaction to use (current one, if "NULL").         */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::select_many] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::select_many] keys = " << keys.size());
+
+    check_open();
+
+    assert(data.size() >= keys.size());
+
+    found->assign(keys.size(), false);
+
+    scratch_scope   scope;
+    vector <DBT>    k(keys.size());
+    vector <size_t> order(keys.size());
+
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        encode_key(keys[i], &k[i], &scope);
+        sample_key(&k[i]);
+        order[i] = i;
+    }
+
+    std::sort(order.begin(), order.end(), key_order(this, k));
+
+    DBC * cursor = NULL;
+    int   res    = m_db->cursor(m_db, m_database->get_transaction(txn), &cursor, m_database->read_flags(txn));
+
+    DBT d;
+
+    memset(&d, 0, sizeof(DBT));
+    d.flags = DB_DBT_USERMEM;
+    d.ulen  = SELECT_BUFFER_SIZE;
+    d.data  = scope.alloc(d.ulen);
+
+    for (size_t i = 0; i < order.size() && res == 0; i++)
+    {
+        size_t n = order[i];
+
+        res = cursor->get(cursor, &k[n], &d, DB_SET);
+
+        if (res == DB_BUFFER_SMALL)
+        {
+            // the buffer is reused for next records
+            d.ulen = d.size;
+            d.data = scope.alloc(d.ulen);
+            res = cursor->get(cursor, &k[n], &d, DB_SET);
+        }
+
+        if (res == 0)
+        {
+            unserialize_data(&d, data[n]);
+            (*found)[n] = true;
+        }
+        else if (res == DB_NOTFOUND || res == DB_KEYEMPTY)
+        {
+            res = 0;
+        }
+    }
+
+    if (cursor != NULL)
+    {
+        cursor->close(cursor);
+    }
+
+    for (size_t i = 0; i < k.size(); i++)
+    {
+        release(&k[i]);
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::select_many] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::select_many] EXIT");
+}
+
+/**
+ * Deletes existing records with specified keys.
+ * The keys are sorted in order of the table, and are deleted at once ("DB_MULTIPLE"), if the table has no
+ * covering indexes. With Berkeley DB prior to 4.8 the records are deleted one by one.
+ *
+ * If "chunk" is not zero, each "chunk" of records is deleted and committed in its own nested transaction,
+ * so number of locks remains bounded. When an error occurs, the failed chunk is rolled back, while previous
+ * chunks remain committed.
+ * <strong>NOTE:</strong> all keys in the table are unique.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND   - some record is not found.
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - this table has a foreign constraint to another one,
+ *                                               and slave table contains some of specified keys.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ */
+void table::remove_many (const keylist & keys,  /**< [in] Keys of the records to be deleted.              */
+                         transaction   * txn,   /**< [in] Transaction to use (current one, if "NULL").    */
+                         unsigned int    chunk) /**< [in] Number of records per committed chunk ("0" - all). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::remove_many] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::remove_many] keys = " << keys.size());
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::remove_many] chunk = " << chunk);
+
+    check_open();
+
+    scratch_scope   scope;
+    vector <DBT>    k(keys.size());
+    vector <size_t> order(keys.size());
+
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        encode_key(keys[i], &k[i], &scope);
+        sample_key(&k[i]);
+        order[i] = i;
+    }
+
+    std::sort(order.begin(), order.end(), key_order(this, k));
+
+    DB_TXN * parent = m_database->get_transaction(txn);
+    DB_TXN * ctxn   = NULL;
+    DB_TXN * own    = NULL;
+
+    // all records are deleted at once, unless they are committed by chunks
+    int res = (chunk == 0 ? m_database->begin_auto(&parent, &own) : 0);
+
+    size_t step = (chunk == 0 ? keys.size() : chunk);
+
+    for (size_t first = 0; first < keys.size() && res == 0; first += step)
+    {
+        size_t last = std::min(first + step, keys.size());
+
+        if (chunk != 0) res = m_database->begin_txn(parent, &ctxn, BDB_DURABILITY_DEFAULT);
+
+        if (res == 0) res = remove_keys((ctxn != NULL ? ctxn : parent), k, order, first, last);
+
+        if (res == 0 && ctxn != NULL)
+        {
+            DB_TXN * committed = ctxn;
+            ctxn = NULL;
+            res = m_database->commit_txn(committed, BDB_DURABILITY_DEFAULT, parent != NULL);
+        }
+    }
+
+    res = m_database->end_auto(own, res);
+
+    for (size_t i = 0; i < k.size(); i++)
+    {
+        release(&k[i]);
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::remove_many] " << db_strerror(res));
+
+        if (ctxn != NULL) m_database->abort_txn(ctxn);
+
+        switch (res)
+        {
+            case DB_NOTFOUND:           throw exception(BDB_ERROR_NOT_FOUND);
+            case DB_KEYEMPTY:           throw exception(BDB_ERROR_NOT_FOUND);
+            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::remove_many] EXIT");
+}
+
+/**
+ * Deletes all records with keys in specified range, and returns number of deleted records.
+ * Both bounds are inclusive; "NULL" bound means the first (or the last) record of the table.
+ * The records are deleted by single cursor, moving forward.
+ *
+ * If "chunk" is not zero, each "chunk" of records is deleted and committed in its own nested transaction,
+ * so number of locks remains bounded. When an error occurs, the failed chunk is rolled back, while previous
+ * chunks remain committed.
+ *
+ * @throw bdb::exception BDB_ERROR_FOREIGN_KEY - this table has a foreign constraint to another one,
+ *                                               and slave table contains some of deleted keys.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK    - deadlock, or lock is not granted.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN     - unknown error.
+ */
+unsigned int table::remove_range (const Message * lower,    /**< [in] Lower bound (can be "NULL").                    */
+                                  const Message * upper,    /**< [in] Upper bound (can be "NULL").                    */
+                                  transaction   * txn,      /**< [in] Transaction to use (current one, if "NULL").    */
+                                  unsigned int    chunk)    /**< [in] Number of records per committed chunk ("0" - all). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::remove_range] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::remove_range] chunk = " << chunk);
+
+    check_open();
+
+    check_ordered("table::remove_range");
+
+    scratch_scope scope;
+
+    // current position of the range ("NULL" data - the first record)
+    DBT pos, hi;
+
+    memset(&pos, 0, sizeof(DBT));
+    memset(&hi,  0, sizeof(DBT));
+
+    if (lower != NULL) encode_key(lower, &pos, &scope);
+    if (upper != NULL) encode_key(upper, &hi,  &scope);
+
+    DB_TXN * parent = m_database->get_transaction(txn);
+    DB_TXN * ctxn   = NULL;
+    DB_TXN * own    = NULL;
+
+    // all records are deleted at once, unless they are committed by chunks
+    int res = (chunk == 0 ? m_database->begin_auto(&parent, &own) : 0);
+
+    unsigned int count = 0;
+    unsigned int done  = chunk;
+
+    // each chunk stops at the next record after the last deleted one
+    while (res == 0 && done == chunk)
+    {
+        if (chunk != 0) res = m_database->begin_txn(parent, &ctxn, BDB_DURABILITY_DEFAULT);
+
+        done = 0;
+
+        if (res == 0) res = remove_chunk((ctxn != NULL ? ctxn : parent), &pos, (upper != NULL ? &hi : NULL), chunk, &done);
+
+        count += done;
+
+        if (res == 0 && ctxn != NULL)
+        {
+            DB_TXN * committed = ctxn;
+            ctxn = NULL;
+            res = m_database->commit_txn(committed, BDB_DURABILITY_DEFAULT, parent != NULL);
+        }
+
+        if (chunk == 0) break;
+    }
+
+    res = m_database->end_auto(own, res);
+
+    release(&pos);
+    release(&hi);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::remove_range] " << db_strerror(res));
+
+        if (ctxn != NULL) m_database->abort_txn(ctxn);
+
+        switch (res)
+        {
+            case DB_FOREIGN_CONFLICT:   throw exception(BDB_ERROR_FOREIGN_KEY);
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::remove_range] EXIT = " << count);
+
+    return count;
+}
+
+/**
+ * Returns number of records in the table.
+ * Fast count is taken from statistics of the table ("DB_FAST_STAT") without traversing it,
+ * so it can be inexact, e.g. when the table has been modified by other processes.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+unsigned int table::count (bool          fast,  /**< [in] Whether to use fast (approximate) count.     */
+                           transaction * txn)   /**< [in] Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::count] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::count] fast = " << fast);
+
+    check_open();
+
+    void * stat = NULL;
+
+    int res = m_db->stat(m_db, m_database->get_transaction(txn), &stat, (fast ? DB_FAST_STAT : 0) | m_database->read_flags(txn));
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::count] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    unsigned int count;
+
+    // statistics differ by access method (recno tables share Btree ones)
+    switch (m_options.access_method)
+    {
+        case BDB_ACCESS_HASH:   count = ((DB_HASH_STAT *)  stat)->hash_ndata; break;
+        case BDB_ACCESS_QUEUE:  count = ((DB_QUEUE_STAT *) stat)->qs_ndata;   break;
+#ifdef BDB_HEAP
+        case BDB_ACCESS_HEAP:   count = ((DB_HEAP_STAT *)  stat)->heap_nrecs; break;
+#endif
+        default:                count = ((DB_BTREE_STAT *) stat)->bt_ndata;   break;
+    }
+
+    free(stat);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::count] EXIT = " << count);
+
+    return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Protected interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Opens configured Berkeley DB database of the table, and makes its cache and Bloom filter.
+ * The database handle is closed on failure.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the table is not found.
+ * @throw bdb::exception BDB_ERROR_EXISTS    - the table already exists.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void table::open_db (bool     create,   /**< [in] Whether to create the table. */
+                     DB_TXN * txn)      /**< [in] Transaction to use.          */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::open_db] ENTER");
+
+    u_int32_t flags = DB_THREAD;
+    if (create) flags |= DB_CREATE | DB_EXCL;
+    if (m_options.multiversion) flags |= DB_MULTIVERSION;
+
+    // new table is written, so it's opened read-only on the next opening
+    if (m_options.read_only && !create) flags |= DB_RDONLY;
+
+    int res = m_database->open_file(m_db, txn, get_filename(), m_name, access_type(m_options.access_method), flags);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::open_db] " << db_strerror(res));
+
+        m_db->close(m_db, 0);
+        m_db = NULL;
+
+        switch (res)
+        {
+            case ENOENT:    throw exception(BDB_ERROR_NOT_FOUND);
+            case EEXIST:    throw exception(BDB_ERROR_EXISTS);
+            default:        throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    // the priority is kept by the shared cache, so it's applied on each opening
+    if (m_options.cache_priority != BDB_PRIORITY_DEFAULT)
+    {
+        res = set_priority(m_db, m_options.cache_priority);
+
+        if (res != 0)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::table::open_db] " << db_strerror(res));
+        }
+    }
+
+    if (m_options.cache_records != 0)
+    {
+        m_cache = new row_cache(m_options.cache_records);
+        assert(m_cache != NULL);
+    }
+
+    if (m_options.bloom_bits != 0)
+    {
+        res = build_filter();
+
+        if (res != 0)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::table::open_db] " << db_strerror(res));
+
+            delete m_cache;
+            m_cache = NULL;
+
+            m_db->close(m_db, 0);
+            m_db = NULL;
+
+            throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    if (m_options.ttl_field != 0)
+    {
+        try
+        {
+            open_expiry();
+        }
+        catch (...)
+        {
+            delete m_cache;
+            m_cache = NULL;
+
+            m_db->close(m_db, 0);
+            m_db = NULL;
+
+            throw;
+        }
+    }
+
+    // the cache and the filter take their memory from the budget
+    if ((m_cache != NULL || m_bloom != NULL) && m_database->m_governor != NULL) m_database->m_governor->add(this);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::open_db] EXIT");
+}
+
+/**
+ * Opens lazily opened table on its first use, once for all threads.
+ * The table is opened in top-level transaction of the database, if there is one.
+ * If the opening fails, the table stays unusable.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the table is not found.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void table::open_lazy ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::open_lazy] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::open_lazy] name = " << m_name);
+
+    boost::mutex::scoped_lock lock(lazy_mutex);
+
+    if (m_lazy)
+    {
+        if (m_db == NULL)
+        {
+            LOG4CPLUS_WARN(logger, "[bdb::table::open_lazy] The table has failed to open.");
+            throw exception(BDB_ERROR_UNKNOWN);
+        }
+
+        open_db(false, m_database->m_txn);
+        m_lazy = false;
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::open_lazy] EXIT");
+}
+
+/**
+ * Serializes specified key in format of the table.
+ * If "scope" is specified, the key is serialized into temporary buffer of the scope (if the format allows).
+ */
+void table::encode_key (const MessageLite * key,    /**< [in]  Key to be serialized.                                */
+                        DBT               * dbt,    /**< [out] Serialized key.                                      */
+                        scratch_scope     * scope)  /**< [in]  Scope of temporary buffer ("NULL" - allocate memory). */
+{
+    if (m_options.key_format == BDB_KEY_ORDERED)
+    {
+        serialize_key(reflected(key), dbt);
+    }
+    else if (m_options.key_format == BDB_KEY_RECNO)
+    {
+        serialize_recno(reflected(key), dbt);
+    }
+    else if (m_options.key_format == BDB_KEY_RID)
+    {
+        serialize_rid(reflected(key), dbt);
+    }
+    else if (m_options.key_format == BDB_KEY_RAW)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::encode_key] Keys of the table are raw, not messages (see \"bdb::typed_table\").");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+    else if (scope != NULL)
+    {
+        scope->serialize(key, dbt, false);
+    }
+    else
+    {
+        serialize(key, dbt, NULL, 0, false);
+    }
+}
+
+/**
+ * Serializes specified key in format of the table, or references serialized one, if the key is prepared (or raw).
+ * Prepared (and raw) key is not copied, so the "DBT" object is valid while the key is unchanged.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the key is prepared for another table.
+ */
+void table::encode_key (const key_ref & key,    /**< [in]  Key to be serialized.                                */
+                        DBT           * dbt,    /**< [out] Serialized key.                                      */
+                        scratch_scope * scope)  /**< [in]  Scope of temporary buffer ("NULL" - allocate memory). */
+{
+    if (key.m_data != NULL)
+    {
+        // caller-supplied memory is never freed by "bdb::release"
+        memset(dbt, 0, sizeof(DBT));
+
+        dbt->data  = (void *) key.m_data;
+        dbt->size  = (u_int32_t) key.m_size;
+        dbt->ulen  = (u_int32_t) key.m_size;
+        dbt->flags = DB_DBT_USERMEM;
+
+        return;
+    }
+
+    if (key.m_prepared == NULL)
+    {
+        encode_key(key.m_message, dbt, scope);
+        return;
+    }
+
+    if (key.m_prepared->m_table != this)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::encode_key] The key is prepared for another table.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    const string & prepared = key.m_prepared->m_key;
+
+    // caller-supplied memory is never freed by "bdb::release"
+    memset(dbt, 0, sizeof(DBT));
+
+    dbt->data  = (void *) prepared.data();
+    dbt->size  = (u_int32_t) prepared.size();
+    dbt->ulen  = (u_int32_t) prepared.size();
+    dbt->flags = DB_DBT_USERMEM;
+}
+
+/**
+ * Estimates proportions of records with keys before, within, and after specified range ("DB->key_range"),
+ * without reading the records. Both bounds are inclusive; "NULL" bound means the first (or the last) record.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void table::estimate_range (const Message * lower,      /**< [in]  Lower bound (can be "NULL").                 */
+                            const Message * upper,      /**< [in]  Upper bound (can be "NULL").                 */
+                            key_estimate  * result,     /**< [out] Estimated proportions.                       */
+                            transaction   * txn)        /**< [in]  Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::estimate_range] ENTER");
+
+    check_open();
+
+    check_ordered("table::estimate_range");
+
+    DB_TXN * t = m_database->get_transaction(txn);
+
+    DB_KEY_RANGE lo, hi;
+
+    memset(&lo, 0, sizeof(lo));
+    memset(&hi, 0, sizeof(hi));
+
+    hi.less = 1.0;
+
+    int res = 0;
+
+    if (lower != NULL)
+    {
+        scratch_scope scope;
+        DBT k;
+
+        encode_key(lower, &k, &scope);
+        res = m_db->key_range(m_db, t, &k, &lo, 0);
+        release(&k);
+    }
+
+    if (res == 0 && upper != NULL)
+    {
+        scratch_scope scope;
+        DBT k;
+
+        encode_key(upper, &k, &scope);
+        res = m_db->key_range(m_db, t, &k, &hi, 0);
+        release(&k);
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::estimate_range] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    double below = lo.less;
+    double above = 1.0 - hi.less - hi.equal;
+
+    result->less    = below;
+    result->greater = (above > 0.0 ? above : 0.0);
+    result->equal   = 1.0 - result->less - result->greater;
+
+    if (result->equal < 0.0) result->equal = 0.0;
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::estimate_range] less = "    << result->less);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::estimate_range] equal = "   << result->equal);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::estimate_range] greater = " << result->greater);
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::estimate_range] EXIT");
+}
+
+/**
+ * Returns statistics of the table ("DB->stat"). Fast statistics don't traverse the table,
+ * so they are cheap to get, but omit the values, which are noted in "bdb::table_stats".
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void table::stats (table_stats * result,    /**< [out] Statistics of the table.                      */
+                   bool          fast,      /**< [in]  Whether to get fast statistics only.          */
+                   transaction * txn)       /**< [in]  Transaction to use (current one, if "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::stats] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::stats] fast = " << fast);
+
+    check_open();
+
+    void * stat = NULL;
+
+    int res = m_db->stat(m_db, m_database->get_transaction(txn), &stat, (fast ? DB_FAST_STAT : 0) | m_database->read_flags(txn));
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::stats] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    memset(result, 0, sizeof(table_stats));
+
+    // statistics differ by access method (recno tables share Btree ones)
+    switch (m_options.access_method)
+    {
+        case BDB_ACCESS_HASH:
+        {
+            DB_HASH_STAT * hs = (DB_HASH_STAT *) stat;
+
+            result->keys       = hs->hash_nkeys;
+            result->records    = hs->hash_ndata;
+            result->page_size  = hs->hash_pagesize;
+            result->pages      = hs->hash_pagecnt;
+            result->free_pages = hs->hash_free;
+            break;
+        }
+
+        case BDB_ACCESS_QUEUE:
+        {
+            DB_QUEUE_STAT * qs = (DB_QUEUE_STAT *) stat;
+
+            result->keys       = qs->qs_nkeys;
+            result->records    = qs->qs_ndata;
+            result->page_size  = qs->qs_pagesize;
+            result->pages      = qs->qs_pages;
+            break;
+        }
+
+#ifdef BDB_HEAP
+        case BDB_ACCESS_HEAP:
+        {
+            DB_HEAP_STAT * ps = (DB_HEAP_STAT *) stat;
+
+            result->keys       = ps->heap_nrecs;
+            result->records    = ps->heap_nrecs;
+            result->page_size  = ps->heap_pagesize;
+            result->pages      = ps->heap_pagecnt;
+            break;
+        }
+#endif
+
+        default:
+        {
+            DB_BTREE_STAT * bs = (DB_BTREE_STAT *) stat;
+
+            result->keys       = bs->bt_nkeys;
+            result->records    = bs->bt_ndata;
+            result->page_size  = bs->bt_pagesize;
+            result->pages      = bs->bt_pagecnt;
+            result->free_pages = bs->bt_free;
+            result->levels     = bs->bt_levels;
+            break;
+        }
+    }
+
+    free(stat);
+
+    if (m_counters != NULL)
+    {
+        boost::mutex::scoped_lock lock(m_counters->mutex);
+
+        result->compare_calls       = m_counters->calls[BDB_CALLBACK_COMPARE];
+        result->compare_time        = m_counters->time[BDB_CALLBACK_COMPARE];
+        result->index_compare_calls = m_counters->calls[BDB_CALLBACK_INDEX_COMPARE];
+        result->index_compare_time  = m_counters->time[BDB_CALLBACK_INDEX_COMPARE];
+        result->index_calls         = m_counters->calls[BDB_CALLBACK_INDEX];
+        result->index_time          = m_counters->time[BDB_CALLBACK_INDEX];
+    }
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::stats] keys = " << result->keys << ", records = " << result->records << ", pages = " << result->pages);
+    LOG4CPLUS_TRACE(logger, "[bdb::table::stats] EXIT");
+}
+
+/**
+ * Returns size of the table on disk and in memory: pages of its file (from fast statistics), pages of the file,
+ * resident in the cache, average sizes of keys and values of sampled records, and memory of the cache of records
+ * and Bloom filter of the table. Records are sampled at both ends of the table (half of them at each end),
+ * so the footprint is cheap enough to be taken periodically.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void table::footprint (table_footprint * result,    /**< [out] Footprint of the table.           */
+                       unsigned int      samples)   /**< [in]  Maximum number of sampled records. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::footprint] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::footprint] samples = " << samples);
+
+    check_open();
+
+    memset(result, 0, sizeof(table_footprint));
+
+    int res = measure_file(m_db, samples, result);
+
+    if (res == 0) res = measure_cache(get_filename(), result);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::footprint] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    if (result->sampled != 0)
+    {
+        result->key_bytes   /= result->sampled;
+        result->value_bytes /= result->sampled;
+    }
+
+    result->row_cache_bytes = cache_bytes();
+    result->filter_bytes    = filter_bytes();
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::footprint] pages = " << result->pages << ", cached = " << result->cached_pages);
+    LOG4CPLUS_TRACE(logger, "[bdb::table::footprint] EXIT");
+}
+
+/**
+ * @private Adds pages and records of specified database (from fast statistics) to the footprint, and sizes
+ * of its sampled records (sums of sizes, which are averaged by the caller). Returns error code of Berkeley DB.
+ */
+int table::measure_file (DB              * db,          /**< [in]     Database of the table or index. */
+                         unsigned int      samples,     /**< [in]     Maximum number of sampled records. */
+                         table_footprint * result)      /**< [in,out] Footprint of the table.         */
+{
+    DBTYPE type;
+
+    void * stat = NULL;
+
+    int res = db->get_type(db, &type);
+
+    if (res == 0) res = db->stat(db, NULL, &stat, DB_FAST_STAT | m_database->read_flags());
+
+    if (res == 0)
+    {
+        switch (type)
+        {
+            case DB_HASH:
+            {
+                DB_HASH_STAT * hs = (DB_HASH_STAT *) stat;
+
+                result->records  += hs->hash_ndata;
+                result->pages    += hs->hash_pagecnt;
+                result->page_size = hs->hash_pagesize;
+                break;
+            }
+
+            case DB_QUEUE:
+            {
+                DB_QUEUE_STAT * qs = (DB_QUEUE_STAT *) stat;
+
+                result->records  += qs->qs_ndata;
+                result->pages    += qs->qs_pages;
+                result->page_size = qs->qs_pagesize;
+                break;
+            }
+
+#ifdef BDB_HEAP
+            case DB_HEAP:
+            {
+                DB_HEAP_STAT * ps = (DB_HEAP_STAT *) stat;
+
+                result->records  += ps->heap_nrecs;
+                result->pages    += ps->heap_pagecnt;
+                result->page_size = ps->heap_pagesize;
+                break;
+            }
+#endif
+
+            default:
+            {
+                DB_BTREE_STAT * bs = (DB_BTREE_STAT *) stat;
+
+                result->records  += bs->bt_ndata;
+                result->pages    += bs->bt_pagecnt;
+                result->page_size = bs->bt_pagesize;
+                break;
+            }
+        }
+
+        result->file_bytes = result->pages * result->page_size;
+    }
+
+    free(stat);
+
+    DBC * cursor = NULL;
+
+    if (res == 0 && samples != 0) res = db->cursor(db, NULL, &cursor, m_database->read_flags());
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+    k.flags = DB_DBT_REALLOC;
+    d.flags = DB_DBT_REALLOC;
+
+    unsigned int taken = 0;
+    string last;
+
+    // the first half is sampled forwards from the first record
+    while (cursor != NULL && res == 0 && taken < (samples + 1) / 2 && (res = cursor->get(cursor, &k, &d, DB_NEXT)) == 0)
+    {
+        result->key_bytes   += k.size;
+        result->value_bytes += d.size;
+        taken++;
+
+        last.assign((const char *) k.data, k.size);
+    }
+
+    // and the second one backwards from the last record, until the samples meet
+    if (cursor != NULL && res == 0)
+    {
+        res = cursor->close(cursor);
+        cursor = NULL;
+
+        if (res == 0) res = db->cursor(db, NULL, &cursor, m_database->read_flags());
+
+        while (res == 0 && taken < samples && (res = cursor->get(cursor, &k, &d, DB_PREV)) == 0)
+        {
+            if (k.size == last.size() && memcmp(k.data, last.data(), k.size) == 0) break;
+
+            result->key_bytes   += k.size;
+            result->value_bytes += d.size;
+            taken++;
+        }
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    free(k.data);
+    free(d.data);
+
+    result->sampled += taken;
+
+    return res;
+}
+
+/**
+ * @private Adds cache statistics of specified file to the footprint. Pages of the file, resident in the cache,
+ * are estimated as share of the file among pages, read into the cache (or created in it), of all files.
+ * Returns error code of Berkeley DB.
+ */
+int table::measure_cache (const string    & file,       /**< [in]     Name of the file.       */
+                          table_footprint * result)     /**< [in,out] Footprint of the table. */
+{
+    DB_MPOOL_STAT   *  gsp = NULL;
+    DB_MPOOL_FSTAT  ** fsp = NULL;
+
+    int res = m_database->m_env->memp_stat(m_database->m_env, &gsp, &fsp, 0);
+
+    if (res == 0)
+    {
+        uint64_t fetched = 0;
+        uint64_t total   = 0;
+
+        for (DB_MPOOL_FSTAT ** f = fsp; f != NULL && *f != NULL; f++)
+        {
+            uint64_t n = (uint64_t) (*f)->st_page_in + (*f)->st_page_create;
+
+            total += n;
+
+            const char * name = (*f)->file_name;
+
+            // databases of in-memory database are named by their files (see "bdb::database::open_file")
+            if (name == NULL || strncmp(name, file.c_str(), file.size()) != 0)  continue;
+            if (name[file.size()] != '\0' && name[file.size()] != '/')         continue;
+
+            fetched += n;
+
+            result->cache_hits   += (*f)->st_cache_hit;
+            result->cache_misses += (*f)->st_cache_miss;
+        }
+
+        uint64_t pages = (total != 0 ? (uint64_t) ((double) gsp->st_pages * fetched / total) : 0);
+
+        // pages are fetched into the cache in its entirety until anything is evicted
+        if (gsp->st_ro_evict + gsp->st_rw_evict == 0) pages = fetched;
+
+        result->cached_pages = (pages < result->pages ? pages : result->pages);
+        result->cached_bytes = result->cached_pages * result->page_size;
+    }
+
+    bdb::free(gsp);
+    bdb::free(fsp);
+
+    return res;
+}
+
+/**
+ * @private Splits the table into partitions by keys or by partitioning function (see "bdb::table_options").
+ * Returns error code of Berkeley DB.
+ */
+int table::set_partition (const table_options & options)    /**< [in] Tuning options of the table. */
+{
+    int res = 0;
+
+#ifdef BDB_PARTITION
+
+    const keylist * keys = options.partition_keys;
+
+    if ((keys == NULL && options.fn_partition == NULL) || (keys != NULL && keys->size() + 1 != options.partitions))
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::set_partition] Partitions need either " << options.partitions - 1 << " partition keys, or partitioning function.");
+        return EINVAL;
+    }
+
+    vector <DBT> bounds(keys != NULL ? keys->size() : 0);
+
+    for (size_t i = 0; i < bounds.size(); i++)
+    {
+        encode_key((*keys)[i], &bounds[i]);
+    }
+
+    res = m_db->set_partition(m_db, options.partitions, (keys != NULL ? &bounds[0] : NULL), (keys != NULL ? NULL : options.fn_partition));
+
+    if (res == 0 && options.partition_dirs != NULL) res = m_db->set_partition_dirs(m_db, options.partition_dirs);
+
+    // partition keys are copied by Berkeley DB
+    for (size_t i = 0; i < bounds.size(); i++)
+    {
+        release(&bounds[i]);
+    }
+
+#endif
+
+    return res;
+}
+
+/**
+ * @private Builds Bloom filter of keys by key-only scan of the table (see "bdb::table_options").
+ * Returns error code of Berkeley DB.
+ */
+int table::build_filter ()
+{
+    vector <uint64_t> hashes;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.flags = DB_DBT_REALLOC;
+    d.flags = DB_DBT_PARTIAL;
+
+    DBC * cursor = NULL;
+    int res = m_db->cursor(m_db, m_database->get_transaction(), &cursor, 0);
+
+    while (res == 0 && (res = cursor->get(cursor, &k, &d, DB_NEXT)) == 0)
+    {
+        hashes.push_back(key_filter::hash(&k));
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    free(k.data);
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::build_filter] keys = " << hashes.size());
+
+    if (res == 0)
+    {
+        m_bloom = new key_filter(hashes, m_options.bloom_bits);
+        assert(m_bloom != NULL);
+    }
+
+    return res;
+}
+
+/**
+ * @private Inserts new record with specified serialized key and data, and updates covering indexes.
+ * Returns error code of Berkeley DB.
+ */
+int table::insert_record (DB_TXN * txn,     /**< [in] Transaction to use.    */
+                          DBT    * key,     /**< [in] Serialized key.        */
+                          DBT    * data)    /**< [in] Serialized data.       */
+{
+    latency_scope berkeley(BDB_LATENCY_BERKELEY);
+
+    if (m_bloom != NULL) m_bloom->add(key);
+
+    index::begin_extract(this, data);
+    int res = m_db->put(m_db, txn, key, data, DB_NOOVERWRITE);
+    index::end_extract();
+    if (res == 0 && is_tracked()) res = track_change(txn, key, NULL, data);
+
+    // keys move between buckets of the histogram (see "bdb::table::analyze")
+    if (res == 0) m_modified++;
+
+    return res;
+}
+
+/**
+ * @private Appends new record with specified serialized data to heap, recno or queue table, and updates covering indexes.
+ * Generated record id (or number) is returned into the key. Returns error code of Berkeley DB.
+ */
+int table::append_new (DB_TXN * txn,    /**< [in]  Transaction to use.              */
+                       DBT    * key,    /**< [out] Generated record id (or number). */
+                       DBT    * data)   /**< [in]  Serialized data.                 */
+{
+    latency_scope berkeley(BDB_LATENCY_BERKELEY);
+
+    index::begin_extract(this, data);
+    int res = m_db->put(m_db, txn, key, data, DB_APPEND);
+    index::end_extract();
+
+    // ids are known to the Bloom filter once they are generated
+    if (res == 0 && m_bloom != NULL) m_bloom->add(key);
+    if (res == 0 && is_tracked()) res = track_change(txn, key, NULL, data);
+    if (res == 0) m_modified++;
+
+    return res;
+}
+
+/**
+ * @private Overwrites existing record with specified serialized key and data, and updates covering indexes.
+ * Returns error code of Berkeley DB.
+ */
+int table::update_record (DB_TXN * txn,     /**< [in] Transaction to use.    */
+                          DBT    * key,     /**< [in] Serialized key.        */
+                          DBT    * data)    /**< [in] Serialized new data.   */
+{
+    latency_scope berkeley(BDB_LATENCY_BERKELEY);
+
+    DBT old;
+    memset(&old, 0, sizeof(DBT));
+
+    // projections of covering indexes are replaced by old data (captured as well), otherwise only the key is looked up
+    old.flags = (is_tracked() ? DB_DBT_MALLOC : DB_DBT_PARTIAL);
+
+    // the record is located and locked for writing once, and then is overwritten in place
+    DBC * cursor = NULL;
+    int res = m_db->cursor(m_db, txn, &cursor, m_database->write_flags());
+
+    if (res == 0) res = cursor->get(cursor, key, &old, DB_SET | DB_RMW);
+
+    if (res == 0)
+    {
+        index::begin_extract(this, data);
+        res = cursor->put(cursor, key, data, DB_CURRENT);
+        index::end_extract();
+    }
+
+    if (res == 0 && is_tracked()) res = track_change(txn, key, &old, data);
+    if (res == 0 && m_cache != NULL) m_cache->invalidate(key);
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    if (is_tracked()) free(old.data);
+
+    return res;
+}
+
+/**
+ * @private Deletes existing record with specified serialized key, and updates covering indexes.
+ * Returns error code of Berkeley DB.
+ */
+int table::remove_record (DB_TXN * txn,     /**< [in] Transaction to use.    */
+                          DBT    * key)     /**< [in] Serialized key.        */
+{
+    latency_scope berkeley(BDB_LATENCY_BERKELEY);
+
+    DBT old;
+    memset(&old, 0, sizeof(DBT));
+    old.flags = DB_DBT_MALLOC;
+
+    // projections of covering indexes are removed by old data (captured as well)
+    int res = (is_tracked() ? m_db->get(m_db, txn, key, &old, 0) : 0);
+
+    if (res == 0) res = m_db->del(m_db, txn, key, 0);
+    if (res == 0 && is_tracked()) res = track_change(txn, key, &old, NULL);
+    if (res == 0 && m_cache != NULL) m_cache->invalidate(key);
+    if (res == 0) m_modified++;
+
+    // keys of removed records stay in sketches of indexes (see "bdb::index::estimate_distinct")
+    if (res == 0) m_removed++;
+
+    free(old.data);
+
+    return res;
+}
+
+/**
+ * @private Writes record with specified serialized key and data, overwriting existing one (if any),
+ * and updates covering indexes. Returns error code of Berkeley DB.
+ */
+int table::put_record (DB_TXN * txn,    /**< [in] Transaction to use.    */
+                       DBT    * key,    /**< [in] Serialized key.        */
+                       DBT    * data)   /**< [in] Serialized data.       */
+{
+    latency_scope berkeley(BDB_LATENCY_BERKELEY);
+
+    DBT old;
+    memset(&old, 0, sizeof(DBT));
+    old.flags = DB_DBT_MALLOC;
+
+    // projections of covering indexes are replaced by old data (captured as well)
+    int res = (is_tracked() ? m_db->get(m_db, txn, key, &old, DB_RMW) : 0);
+
+    bool created = (res == DB_NOTFOUND || res == DB_KEYEMPTY);
+    if (created) res = 0;
+
+    if (res == 0)
+    {
+        if (m_bloom != NULL) m_bloom->add(key);
+
+        index::begin_extract(this, data);
+        res = m_db->put(m_db, txn, key, data, 0);
+        index::end_extract();
+    }
+
+    if (res == 0 && is_tracked()) res = track_change(txn, key, (created ? NULL : &old), data);
+    if (res == 0 && m_cache != NULL) m_cache->invalidate(key);
+
+    free(old.data);
+
+    return res;
+}
+
+/**
+ * @private Writes records with specified sorted keys, overwriting existing ones (see "table::put_record").
+ * Records of a table without covering indexes are put at once ("DB_MULTIPLE_KEY").
+ * Returns error code of Berkeley DB.
+ */
+int table::put_records (DB_TXN       * txn,     /**< [in] Transaction to use.   */
+                        vector <DBT> & keys,    /**< [in] Serialized keys.      */
+                        vector <DBT> & data)    /**< [in] Serialized data.      */
+{
+    int res = 0;
+
+#ifdef BDB_BULK_PUT
+
+    if (!is_tracked() && keys.size() > 1)
+    {
+        size_t bytes = 0;
+
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            bytes += keys[i].size + data[i].size + BULK_RECORD_OVERHEAD;
+        }
+
+        vector <char> buffer(bytes + BULK_RECORD_OVERHEAD);
+
+        DBT bulk, empty;
+        memset(&bulk,  0, sizeof(bulk));
+        memset(&empty, 0, sizeof(empty));
+
+        bulk.data  = &buffer[0];
+        bulk.ulen  = buffer.size();
+        bulk.flags = DB_DBT_USERMEM | DB_DBT_BULK;
+
+        void * ptr = NULL;
+        DB_MULTIPLE_WRITE_INIT(ptr, &bulk);
+
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            write_bulk(ptr, &bulk, &keys[i], &data[i]);
+            assert(ptr != NULL);
+        }
+
+        {
+            latency_scope berkeley(BDB_LATENCY_BERKELEY);
+            res = m_db->put(m_db, txn, &bulk, &empty, DB_MULTIPLE_KEY);
+        }
+
+        for (size_t i = 0; i < keys.size() && res == 0 && m_cache != NULL; i++)
+        {
+            m_cache->invalidate(&keys[i]);
+        }
+
+        return res;
+    }
+
+#endif
+
+    for (size_t i = 0; i < keys.size() && res == 0; i++)
+    {
+        res = put_record(txn, &keys[i], &data[i]);
+    }
+
+    return res;
+}
+
+/**
+ * @private Deletes records with specified range of sorted keys (see "table::remove_many").
+ * Returns error code of Berkeley DB.
+ */
+int table::remove_keys (DB_TXN                * txn,    /**< [in] Transaction to use.                  */
+                        vector <DBT>          & keys,   /**< [in] Serialized keys.                     */
+                        const vector <size_t> & order,  /**< [in] Indexes of the keys in sorted order. */
+                        size_t                  first,  /**< [in] First key of the range (in "order"). */
+                        size_t                  last)   /**< [in] Next after last key of the range.    */
+{
+    int res = 0;
+
+#ifdef BDB_BULK_PUT
+
+    if (!is_tracked())
+    {
+        size_t bytes = 0;
+
+        for (size_t i = first; i < last; i++)
+        {
+            bytes += keys[order[i]].size + BULK_RECORD_OVERHEAD;
+        }
+
+        vector <char> buffer(bytes + BULK_RECORD_OVERHEAD);
+
+        DBT bulk;
+        memset(&bulk, 0, sizeof(bulk));
+
+        bulk.data  = &buffer[0];
+        bulk.ulen  = buffer.size();
+        bulk.flags = DB_DBT_USERMEM | DB_DBT_BULK;
+
+        void * ptr = NULL;
+        DB_MULTIPLE_WRITE_INIT(ptr, &bulk);
+
+        for (size_t i = first; i < last; i++)
+        {
+            DBT & k = keys[order[i]];
+
+            write_bulk(ptr, &bulk, &k, NULL);
+            assert(ptr != NULL);
+        }
+
+        res = m_db->del(m_db, txn, &bulk, DB_MULTIPLE);
+
+        for (size_t i = first; i < last && res == 0 && m_cache != NULL; i++)
+        {
+            m_cache->invalidate(&keys[order[i]]);
+        }
+
+        return res;
+    }
+
+#endif
+
+    for (size_t i = first; i < last && res == 0; i++)
+    {
+        res = remove_record(txn, &keys[order[i]]);
+    }
+
+    return res;
+}
+
+/**
+ * @private Deletes next chunk of records, starting from specified key (see "table::remove_range").
+ * When the chunk is full, the key is replaced by the next record after the deleted ones (its memory is
+ * allocated by Berkeley DB, so "bdb::release" frees it).
+ * Returns error code of Berkeley DB.
+ */
+int table::remove_chunk (DB_TXN       * txn,    /**< [in]     Transaction to use.                          */
+                         DBT          * key,    /**< [in/out] First key ("NULL" data - the first record).  */
+                         const DBT    * upper,  /**< [in]     Upper bound (can be "NULL").                 */
+                         unsigned int   chunk,  /**< [in]     Maximum number of records ("0" - unlimited). */
+                         unsigned int * count)  /**< [out]    Number of deleted records.                   */
+{
+    DBT k, d;
+
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+
+    k.flags = DB_DBT_MALLOC;
+
+    // projections of covering indexes are removed by old data (captured as well), otherwise only keys are read
+    d.flags = (is_tracked() ? DB_DBT_MALLOC : DB_DBT_PARTIAL);
+
+    DBC * cursor = NULL;
+    int res = m_db->cursor(m_db, txn, &cursor, m_database->write_flags());
+
+    if (res == 0)
+    {
+        if (key->data == NULL)
+        {
+            res = cursor->get(cursor, &k, &d, DB_FIRST | DB_RMW);
+        }
+        else
+        {
+            // the found key is returned in new memory, so the search key remains intact
+            k.data = key->data;
+            k.size = key->size;
+
+            res = cursor->get(cursor, &k, &d, DB_SET_RANGE | DB_RMW);
+            if (res != 0) k.data = NULL;
+        }
+    }
+
+    while (res == 0)
+    {
+        if (upper != NULL && compare_keys(&k, upper) > 0)
+        {
+            res = DB_NOTFOUND;
+            break;
+        }
+
+        if (chunk != 0 && *count == chunk)
+        {
+            // the range continues from this record
+            release(key);
+
+            *key = k;
+            key->flags = DB_DBT_MALLOC;
+            k.data = NULL;
+            break;
+        }
+
+        res = cursor->del(cursor, 0);
+
+        if (res == 0 && is_tracked()) res = track_change(txn, &k, &d, NULL);
+        if (res == 0 && m_cache != NULL) m_cache->invalidate(&k);
+        if (res == 0) (*count)++;
+
+        if (is_tracked())
+        {
+            free(d.data);
+            d.data = NULL;
+        }
+
+        free(k.data);
+        k.data = NULL;
+
+        if (res == 0) res = cursor->get(cursor, &k, &d, DB_NEXT | DB_RMW);
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    free(k.data);
+    if (is_tracked()) free(d.data);
+
+    return res;
+}
+
+/**
+ * @private Makes single attempt to modify specified record (see "table::modify").
+ * Returns error code of Berkeley DB.
+ */
+int table::modify_once (DB_TXN          * txn,      /**< [in]  Transaction to use.                             */
+                        DBT             * key,      /**< [in]  Serialized key of the record.                   */
+                        Message         * data,     /**< [out] Reusable message for data of the record.        */
+                        modify_callback   fn_mod,   /**< [in]  Modification function.                          */
+                        void            * param,    /**< [in]  Parameter to pass to the modification function. */
+                        bool            * changed)  /**< [out] Whether the record is changed.                  */
+{
+    DBT old, d;
+    memset(&old, 0, sizeof(DBT));
+    memset(&d,   0, sizeof(DBT));
+
+    old.flags = DB_DBT_MALLOC;
+
+    *changed = false;
+
+    DBC * cursor = NULL;
+    int res = m_db->cursor(m_db, txn, &cursor, m_database->write_flags());
+
+    if (res == 0) res = cursor->get(cursor, key, &old, DB_SET | DB_RMW);
+
+    if (res == 0)
+    {
+        data->Clear();
+        unserialize_data(&old, data);
+
+        {
+            latency_scope callback(BDB_LATENCY_CALLBACK);
+            *changed = fn_mod(data, param);
+        }
+
+        if (*changed)
+        {
+            scratch_scope scope;
+
+            scope.serialize(data, &d);
+            stamp_value(&d, &scope);
+
+            res = cursor->put(cursor, key, &d, DB_CURRENT);
+            if (res == 0 && is_tracked()) res = track_change(txn, key, &old, &d);
+            if (res == 0 && m_cache != NULL) m_cache->invalidate(key);
+        }
+    }
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    free(old.data);
+
+    return res;
+}
+
+/**
+ * @private Merges specified delta into the record with specified key (see "table::merge"), and creates missing record.
+ * Returns error code of Berkeley DB.
+ */
+int table::merge_record (DB_TXN          * txn,         /**< [in]  Transaction to use.                         */
+                         DBT             * key,         /**< [in]  Serialized key of the record.               */
+                         const DBT       * delta,       /**< [in]  Serialized delta.                           */
+                         merge_callback    fn_merge,    /**< [in]  Merge function.                             */
+                         void            * param,       /**< [in]  Parameter to pass to the merge function.    */
+                         bool            * created)     /**< [out] Whether the record is created.              */
+{
+    latency_scope berkeley(BDB_LATENCY_BERKELEY);
+
+    DBT old;
+    memset(&old, 0, sizeof(DBT));
+
+    old.flags = DB_DBT_MALLOC;
+
+    *created = false;
+
+    DBC * cursor = NULL;
+    int res = m_db->cursor(m_db, txn, &cursor, m_database->write_flags());
+
+    if (res == 0) res = cursor->get(cursor, key, &old, DB_SET | DB_RMW);
+
+    // record numbers of removed records are kept empty
+    bool missing = (res == DB_NOTFOUND || res == DB_KEYEMPTY);
+    if (missing) res = 0;
+
+    string merged;
+    bool   changed = false;
+
+    if (res == 0)
+    {
+        latency_scope callback(BDB_LATENCY_CALLBACK);
+        changed = fn_merge((missing ? NULL : plain_value(&old)), delta, &merged, param);
+    }
+
+    if (res == 0 && changed)
+    {
+        DBT d;
+        memset(&d, 0, sizeof(DBT));
+
+        d.data  = (void *) merged.data();
+        d.size  = (u_int32_t) merged.size();
+        d.flags = DB_DBT_USERMEM;
+
+        // merged data are compressed the way "bdb::serialize" does it
+        vector <char> packed;
+
+        if (should_compress(merged.size()))
+        {
+            packed.resize(merged.size());
+            size_t size = compress_value(merged.data(), merged.size(), &packed[0]);
+
+            if (size != 0)
+            {
+                d.data = &packed[0];
+                d.size = (u_int32_t) size;
+            }
+        }
+
+        vector <char> sealed;
+
+        if (should_encrypt())
+        {
+            sealed.resize(sealed_size(d.size));
+
+            size_t size = encrypt_value(d.data, d.size, &sealed[0]);
+            if (size == 0) res = EINVAL;
+
+            d.data = &sealed[0];
+            d.size = (u_int32_t) size;
+        }
+
+        // merge functions get stored data as they are, so merged data keep version of merged record
+        scratch_scope scope;
+        stamp_value(&d, (missing ? m_options.schema_version : value_version(&old)), &scope);
+
+        if (res == 0)
+        {
+            if (missing && m_bloom != NULL) m_bloom->add(key);
+
+            index::begin_extract(this, &d);
+
+            if (!missing)          res = cursor->put(cursor, key, &d, DB_CURRENT);
+            else if (is_numbered()) res = m_db->put(m_db, txn, key, &d, 0);
+            else                   res = cursor->put(cursor, key, &d, DB_KEYFIRST);
+
+            index::end_extract();
+
+            if (res == 0 && is_tracked()) res = track_change(txn, key, (missing ? NULL : &old), &d);
+            if (res == 0 && m_cache != NULL) m_cache->invalidate(key);
+
+            *created = missing;
+        }
+    }
+
+    if (cursor != NULL)
+    {
+        int err = cursor->close(cursor);
+        if (res == 0) res = err;
+    }
+
+    free(old.data);
+
+    return res;
+}
+
+/**
+ * @private Appends specified serialized fragment to data of existing record with specified key (see "table::append_bytes").
+ * Returns error code of Berkeley DB.
+ */
+int table::append_record (DB_TXN      * txn,        /**< [in] Transaction to use.       */
+                          DBT         * key,        /**< [in] Serialized key.           */
+                          const DBT   * fragment)   /**< [in] Serialized fragment.      */
+{
+    latency_scope berkeley(BDB_LATENCY_BERKELEY);
+
+    // empty user buffer gets the size of the stored value only, and locks the record for writing
+    DBT old;
+    memset(&old, 0, sizeof(DBT));
+    old.flags = DB_DBT_USERMEM;
+    old.ulen  = 0;
+
+    int res = m_db->get(m_db, txn, key, &old, DB_RMW);
+    if (res == DB_BUFFER_SMALL) res = 0;
+
+    if (res != 0) return res;
+
+    u_int32_t size = old.size;
+
+    // compressed values start with zero byte, which is never a tag of ProtoBuf field
+    char marker = 1;
+
+    if (size != 0)
+    {
+        DBT head;
+        memset(&head, 0, sizeof(DBT));
+
+        head.data  = &marker;
+        head.ulen  = sizeof(marker);
+        head.dlen  = sizeof(marker);
+        head.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
+
+        res = m_db->get(m_db, txn, key, &head, DB_RMW);
+        if (res != 0) return res;
+    }
+
+    if (marker == 0 || is_tracked())
+    {
+        bool created = false;
+        return merge_record(txn, key, fragment, merge_append, NULL, &created);
+    }
+
+    DBT d;
+    memset(&d, 0, sizeof(DBT));
+
+    d.data  = fragment->data;
+    d.size  = fragment->size;
+    d.doff  = size;
+    d.dlen  = 0;
+    d.flags = DB_DBT_PARTIAL;
+
+    // indexes get the whole new data from Berkeley DB itself
+    res = m_db->put(m_db, txn, key, &d, 0);
+
+    if (res == 0 && m_cache != NULL) m_cache->invalidate(key);
+
+    return res;
+}
+
+/**
+ * @private Compares specified key with bound of parallel scan.
+ */
+static int compare_bound (const scan_state * state, const DBT * key, const string & bound)
+{
+    DBT b;
+    memset(&b, 0, sizeof(DBT));
+    b.data = (void *) bound.data();
+    b.size = (u_int32_t) bound.size();
+
+    if (state->fn_cmp != NULL)
+    {
+        return state->fn_cmp(state->db, key, &b);
+    }
+
+    int res = memcmp(key->data, b.data, (key->size < b.size ? key->size : b.size));
+    return (res != 0 ? res : (int) key->size - (int) b.size);
+}
+
+/**
+ * @private Scans one range of parallel scan in its own read-committed transaction.
+ */
+static void scan_range (scan_state * state,     /**< [in] State of the scan. */
+                        int          worker)    /**< [in] Number of worker.  */
+{
+    DB     * db  = state->db;
+    DB_ENV * env = db->get_env(db);
+    DB_TXN * txn = NULL;
+    DBC    * cursor = NULL;
+
+    const string & lower = state->bounds[worker];
+    const string & upper = state->bounds[worker + 1];
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+    k.flags = DB_DBT_REALLOC;
+    d.flags = DB_DBT_REALLOC;
+
+    // concurrent data store has no transactions
+    int res = (state->transactional ? env->txn_begin(env, NULL, &txn, DB_READ_COMMITTED) : 0);
+
+    if (res == 0) res = db->cursor(db, txn, &cursor, (state->transactional ? DB_READ_COMMITTED : 0));
+
+    if (res == 0)
+    {
+        if (lower.empty())
+        {
+            res = cursor->get(cursor, &k, &d, DB_FIRST);
+        }
+        else
+        {
+            k.data = malloc(lower.size());
+            k.size = (u_int32_t) lower.size();
+            memcpy(k.data, lower.data(), lower.size());
+
+            res = cursor->get(cursor, &k, &d, DB_SET_RANGE);
+        }
+    }
+
+    while (res == 0 && !state->stop)
+    {
+        if (!upper.empty() && compare_bound(state, &k, upper) >= 0)
+        {
+            break;
+        }
+
+        int stop;
+
+        {
+            latency_scope callback(BDB_LATENCY_CALLBACK);
+            stop = state->fn_scan(worker, &k, &d, state->param);
+        }
+
+        if (stop != 0)
+        {
+            state->stop = true;
+            break;
+        }
+
+        res = cursor->get(cursor, &k, &d, DB_NEXT);
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL) cursor->close(cursor);
+
+    if (txn != NULL)
+    {
+        // nothing is changed, but commit releases read locks the same way
+        if (res == 0) res = txn->commit(txn, 0);
+        else          txn->abort(txn);
+    }
+
+    free(k.data);
+    free(d.data);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::parallel_scan] " << db_strerror(res));
+
+        boost::mutex::scoped_lock lock(state->mutex);
+        if (state->error == 0) state->error = res;
+        state->stop = true;
+    }
+}
+
+/**
+ * @private Body of task of parallel scan.
+ */
+static void run_scan_task (void * param)    /**< [in] Range of the scan ("bdb::scan_task"). */
+{
+    scan_task * task = static_cast <scan_task *> (param);
+    scan_range(task->state, task->worker);
+}
+
+/**
+ * Scans all records of the table by several threads, passing the records to specified callback.
+ * Key space of the table is split into ranges of roughly equal size, and each range is scanned
+ * by its own task of shared work pool of the database with its own cursor and read-committed transaction.
+ * For tables, sorted by Berkeley DB itself (e.g. with order-preserving keys), bounds of ranges are found
+ * by bisection with "DB->key_range"; for tables with comparison function keys are sampled by extra pass.
+ * The callback is called concurrently, and can stop the whole scan by returning non-zero value.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void table::parallel_scan (unsigned int    nthreads,    /**< [in] Number of ranges (tasks).              */
+                           scan_callback   fn_scan,     /**< [in] Callback to process records.          */
+                           void          * param)       /**< [in] Parameter to pass to the callback.    */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::parallel_scan] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::parallel_scan] nthreads = " << nthreads);
+
+    check_open();
+
+    check_ordered("table::parallel_scan");
+
+    if (nthreads == 0) nthreads = 1;
+
+    scan_state state;
+
+    state.db      = m_db;
+    state.fn_cmp  = m_callback;
+    state.fn_scan = fn_scan;
+    state.param   = param;
+    state.stop    = false;
+    state.error   = 0;
+    state.transactional = (m_database->read_flags() != 0);
+
+    int res = find_bounds(nthreads, &state.bounds);
+
+    if (res == 0)
+    {
+        vector <scan_task> tasks(state.bounds.size() - 1);
+
+        {
+            task_group workers(m_database->m_pool);
+
+            for (unsigned int i = 0; i < tasks.size(); i++)
+            {
+                tasks[i].state  = &state;
+                tasks[i].worker = (int) i;
+                workers.run(run_scan_task, &tasks[i]);
+            }
+        }
+
+        res = state.error;
+    }
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::parallel_scan] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::parallel_scan] EXIT");
+}
+
+/**
+ * Compacts the table online: half-empty pages of Btree are merged (up to specified fill factor), emptied ones are
+ * put into the free list, and (with "free_space") free pages at the end of the file are returned to the file system
+ * ("DB->compact"). Compaction runs by small steps, each freeing up to "step_pages" pages in its own transaction
+ * (nested into the current one, if any), so locks are held briefly and traffic isn't blocked. A step, rolled back
+ * by a deadlock, is retried. Compaction stops when the whole file is compacted, or when a budget is exhausted;
+ * the next compaction starts over from the beginning of the file. Indexes are compacted by their own calls.
+ *
+ * @throw bdb::exception BDB_ERROR_DEADLOCK - a step is repeatedly rolled back by deadlocks.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN  - unknown error (e.g. the access method doesn't support compaction).
+ */
+void table::compact (const compact_options & options,   /**< [in]  Options of the compaction.          */
+                     compact_result        * result)    /**< [out] Results of the compaction (can be "NULL"). */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::compact] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::compact] fill = " << options.fill_percent << "%, step = " << options.step_pages << ", pages = " << options.max_pages << ", timeout = " << options.timeout << ", free space = " << options.free_space);
+
+    check_open();
+
+    compact_result total;
+    memset(&total, 0, sizeof(compact_result));
+
+    uint64_t deadline = (options.timeout != 0 ? monotonic_time() + (uint64_t) options.timeout * 1000000 : 0);
+
+    int res = compact_file(m_db, options, deadline, &total);
+
+    if (result != NULL) *result = total;
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::compact] " << db_strerror(res));
 
-    memset(&d, 0, sizeof(DBT));
-    d.flags = DB_DBT_MALLOC;
+        switch (res)
+        {
+            case DB_LOCK_DEADLOCK:      throw exception(BDB_ERROR_DEADLOCK);
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
 
-    serialize(key, &k);
-    int res = m_db->get(m_db, m_database->m_txns.top(), &k, &d, DB_READ_COMMITTED);
-    release(&k);
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::compact] examined = " << total.pages_examined << ", freed = " << total.pages_freed << ", truncated = " << total.pages_truncated << ", steps = " << total.steps);
+    LOG4CPLUS_TRACE(logger, "[bdb::table::compact] EXIT = " << total.completed);
+}
+
+/**
+ * @private Sets priority of pages of specified file of the table in the cache (see "bdb::table::set_cache_priority").
+ * Returns error code of Berkeley DB.
+ */
+int table::set_priority (DB  * db,          /**< [in] File of the table.   */
+                         int   priority)    /**< [in] Priority of pages.   */
+{
+    DB_CACHE_PRIORITY p;
+
+    switch (priority)
+    {
+        case BDB_PRIORITY_VERY_LOW:     p = DB_PRIORITY_VERY_LOW;   break;
+        case BDB_PRIORITY_LOW:          p = DB_PRIORITY_LOW;        break;
+        case BDB_PRIORITY_HIGH:         p = DB_PRIORITY_HIGH;       break;
+        case BDB_PRIORITY_VERY_HIGH:    p = DB_PRIORITY_VERY_HIGH;  break;
+        default:                        p = DB_PRIORITY_DEFAULT;    break;
+    }
+
+    DB_MPOOLFILE * mpf = db->get_mpf(db);
+
+    return mpf->set_priority(mpf, p);
+}
+
+/**
+ * Compacts specified file of the table by steps (see "bdb::table::compact"), adding results of the steps.
+ * Returns error code of Berkeley DB.
+ */
+int table::compact_file (DB                    * db,        /**< [in]     Compacted file.                          */
+                         const compact_options & options,   /**< [in]     Options of the compaction.               */
+                         uint64_t                deadline,  /**< [in]     Deadline of monotonic clock ("0" - none). */
+                         compact_result        * result)    /**< [in,out] Results of the compaction.               */
+{
+    DB_TXN * parent = (m_database->m_concurrent ? NULL : m_database->get_transaction());
+
+    // start of the next step ("NULL" data - the beginning of the file)
+    DBT start, end;
+    memset(&start, 0, sizeof(DBT));
+
+    int res     = 0;
+    int retries = 0;
+
+    result->completed = false;
+
+    while (res == 0)
+    {
+        if (deadline != 0 && monotonic_time() >= deadline) break;
+        if (options.max_pages != 0 && result->pages_freed >= options.max_pages) break;
+
+        DB_COMPACT c;
+        memset(&c, 0, sizeof(DB_COMPACT));
+
+        c.compact_fillpercent = options.fill_percent;
+        c.compact_pages       = options.step_pages;
+
+        // the last step doesn't exceed the budget
+        if (options.max_pages != 0 && (c.compact_pages == 0 || c.compact_pages > options.max_pages - result->pages_freed))
+        {
+            c.compact_pages = (u_int32_t) (options.max_pages - result->pages_freed);
+        }
+
+        memset(&end, 0, sizeof(DBT));
+        end.flags = DB_DBT_MALLOC;
+
+        DB_TXN * txn = NULL;
+
+        if (!m_database->m_concurrent) res = m_database->begin_txn(parent, &txn, BDB_DURABILITY_DEFAULT);
+
+        if (res == 0) res = db->compact(db, txn, (start.data != NULL ? &start : NULL), NULL, &c, (options.free_space ? DB_FREE_SPACE : 0), &end);
+
+        if (res == 0 && txn != NULL)
+        {
+            DB_TXN * committed = txn;
+            txn = NULL;
+            res = m_database->commit_txn(committed, BDB_DURABILITY_DEFAULT, parent != NULL);
+        }
+
+        if (txn != NULL) m_database->abort_txn(txn);
+
+        // rolled back step is retried from the same start
+        if ((res == DB_LOCK_DEADLOCK || res == DB_LOCK_NOTGRANTED) && retries < COMPACT_MAX_RETRIES)
+        {
+            free(end.data);
+
+            result->deadlocks++;
+            retries++;
+            res = 0;
+            continue;
+        }
+
+        if (res != 0)
+        {
+            free(end.data);
+            break;
+        }
+
+        retries = 0;
+
+        result->pages_examined  += c.compact_pages_examine;
+        result->pages_freed     += c.compact_pages_free;
+        result->pages_truncated += c.compact_pages_truncated;
+        result->levels          += c.compact_levels;
+        result->deadlocks       += c.compact_deadlock;
+        result->steps++;
+
+        // the step has reached the end of the file
+        bool done = (end.size == 0 || (options.step_pages == 0 && options.max_pages == 0) ||
+                     (c.compact_pages_free == 0 && start.data != NULL && end.size == start.size && memcmp(end.data, start.data, end.size) == 0));
+
+        free(start.data);
+        start = end;
+
+        if (done)
+        {
+            result->completed = true;
+            break;
+        }
+    }
+
+    free(start.data);
+
+    return res;
+}
+
+/**
+ * Sets priority of pages of the table in the shared cache (see @ref cachepriorities "priorities"), so pages
+ * of a small hot table are not evicted by scans of large ones. The priority lasts until the table is closed.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+void table::set_cache_priority (int priority)  /**< [in] Priority of pages. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::set_cache_priority] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::set_cache_priority] priority = " << priority);
+
+    check_open();
+
+    int res = set_priority(m_db, priority);
 
     if (res != 0)
     {
-        LOG4CPLUS_WARN(logger, "[bdb::table::select] " << db_strerror(res));
+        LOG4CPLUS_WARN(logger, "[bdb::table::set_cache_priority] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
 
-        switch (res)
+    LOG4CPLUS_TRACE(logger, "[bdb::table::set_cache_priority] EXIT");
+}
+
+/**
+ * Removes all records from the cache of the table (see "bdb::table_options"), e.g. when the table is changed
+ * not through this object (by another process, or by cascading foreign keys of another table).
+ */
+void table::clear_cache ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::table::clear_cache] ENTER");
+
+    if (m_cache != NULL) m_cache->clear();
+
+    LOG4CPLUS_TRACE(logger, "[bdb::table::clear_cache] EXIT");
+}
+
+/**
+ * @private Returns memory of Bloom filter of keys of the table ("0" if it has no filter).
+ */
+uint64_t table::filter_bytes ()
+{
+    return (m_bloom != NULL ? m_bloom->bytes() : 0);
+}
+
+/**
+ * @private Returns memory of records in the cache of the table ("0" if it has no cache).
+ */
+uint64_t table::cache_bytes ()
+{
+    return (m_cache != NULL ? m_cache->bytes() : 0);
+}
+
+/**
+ * @private Returns number of records, evicted from the cache of the table for lack of memory since the previous call.
+ */
+uint64_t table::cache_evictions ()
+{
+    return (m_cache != NULL ? m_cache->take_evictions() : 0);
+}
+
+/**
+ * @private Limits memory of records in the cache of the table (see "bdb::memory_governor").
+ */
+void table::limit_cache (uint64_t bytes)    /**< [in] Maximum memory of cached records. */
+{
+    if (m_cache != NULL) m_cache->set_limit(bytes);
+}
+
+/**
+ * Splits key space of the table into specified number of ranges of roughly equal size.
+ * The first and the last bounds are always empty (from the first record, and up to the last one).
+ */
+int table::find_bounds (unsigned int      nthreads,     /**< [in]  Number of ranges.  */
+                        vector <string> * bounds,       /**< [out] Bounds of ranges.  */
+                        bool              analyzed)     /**< [in]  Whether histogram of keys may be used. */
+{
+    // analyzed table is split by buckets of its histogram at once
+    if (analyzed && nthreads > 1 && histogram_bounds(nthreads, bounds)) return 0;
+
+    bounds->assign(1, string());
+
+    DBC * cursor = NULL;
+
+    DBT k, d;
+    memset(&k, 0, sizeof(DBT));
+    memset(&d, 0, sizeof(DBT));
+    k.flags = DB_DBT_REALLOC;
+    d.flags = DB_DBT_PARTIAL;
+
+    int res = (nthreads > 1 ? m_db->cursor(m_db, NULL, &cursor, m_database->read_flags()) : 0);
+
+    if (res == 0 && cursor != NULL && m_callback != NULL)
+    {
+        // keys are sampled by a pass over them, data are not read
+        unsigned int records = count(true);
+        unsigned int step    = records / nthreads;
+
+        unsigned int i = 0;
+
+        while (step != 0 && bounds->size() < nthreads && (res = cursor->get(cursor, &k, &d, DB_NEXT)) == 0)
         {
-            case DB_NOTFOUND:   throw exception(BDB_ERROR_NOT_FOUND);
-            default:            throw exception(BDB_ERROR_UNKNOWN);
+            if (++i % step == 0) bounds->push_back(string((const char *) k.data, k.size));
         }
     }
+    else if (res == 0 && cursor != NULL)
+    {
+        string first, last;
 
-    unserialize(&d, data);
-    release(&d);
+        res = cursor->get(cursor, &k, &d, DB_FIRST);
+        if (res == 0) first.assign((const char *) k.data, k.size);
 
-    LOG4CPLUS_TRACE(logger, "[bdb::table::select] EXIT");
+        if (res == 0) res = cursor->get(cursor, &k, &d, DB_LAST);
+        if (res == 0) last.assign((const char *) k.data, k.size);
+
+        // bounds differ in 8 bytes after common prefix of the first and the last keys
+        size_t common = 0;
+        while (common < first.size() && common < last.size() && first[common] == last[common]) common++;
+
+        uint64_t lo = 0, hi = 0;
+
+        for (size_t j = common; j < common + 8; j++)
+        {
+            lo = (lo << 8) | (j < first.size() ? (uint8_t) first[j] : 0);
+            hi = (hi << 8) | (j < last.size()  ? (uint8_t) last[j]  : 0);
+        }
+
+        for (unsigned int i = 1; res == 0 && i < nthreads && lo < hi; i++)
+        {
+            double target = (double) i / nthreads;
+
+            uint64_t a = lo, b = hi;
+            string   bound;
+
+            for (int step = 0; step < SCAN_BISECTION_STEPS && a < b; step++)
+            {
+                uint64_t middle = a + (b - a) / 2;
+
+                bound = first.substr(0, common);
+                for (int j = 7; j >= 0; j--) bound.push_back((char) (uint8_t) (middle >> (j * 8)));
+
+                DBT key;
+                memset(&key, 0, sizeof(DBT));
+                key.data = (void *) bound.data();
+                key.size = (u_int32_t) bound.size();
+
+                DB_KEY_RANGE range;
+                res = m_db->key_range(m_db, NULL, &key, &range, 0);
+                if (res != 0) break;
+
+                if (range.less < target) a = middle + 1;
+                else                     b = middle;
+            }
+
+            bound = first.substr(0, common);
+            for (int j = 7; j >= 0; j--) bound.push_back((char) (uint8_t) (a >> (j * 8)));
+
+            bounds->push_back(bound);
+        }
+    }
+
+    if (res == DB_NOTFOUND) res = 0;
+
+    if (cursor != NULL) cursor->close(cursor);
+
+    free(k.data);
+
+    bounds->push_back(string());
+
+    LOG4CPLUS_DEBUG(logger, "[bdb::table::parallel_scan] ranges = " << bounds->size() - 1);
+
+    return res;
+}
+
+/**
+ * Checks whether each change of records is tracked, by covering indexes, by materialized aggregates,
+ * by column stores, by change capture, or by subscribers of change notifications.
+ */
+bool table::is_tracked ()
+{
+    if (m_options.capture_changes || m_notified || !m_aggregates.empty() || !m_columns.empty()) return true;
+
+    for (unsigned int i = 0; i < m_indexes.size(); i++)
+    {
+        if (m_indexes[i]->m_cover != NULL) return true;
+    }
+
+    return false;
+}
+
+/**
+ * Updates projections of covering indexes, materialized aggregates and column stores on change of specified record,
+ * captures the change into change log of the database (see "bdb::table_options::capture_changes"),
+ * and queues notification of the change until its transaction is committed (see "bdb::table::subscribe").
+ */
+int table::track_change (DB_TXN    * txn,       /**< [in] Transaction to use.                       */
+                         const DBT * key,       /**< [in] Primary key.                              */
+                         const DBT * olddata,   /**< [in] Old primary data ("NULL" for new record). */
+                         const DBT * newdata)   /**< [in] New primary data ("NULL" for removed one). */
+{
+    int res = 0;
+
+    if (m_options.capture_changes) res = m_database->append_change(txn, m_name, key, olddata, newdata);
+
+    for (unsigned int i = 0; i < m_aggregates.size() && res == 0; i++)
+    {
+        res = m_aggregates[i]->apply_change(txn, key, olddata, newdata);
+    }
+
+    for (unsigned int i = 0; i < m_columns.size() && res == 0; i++)
+    {
+        res = m_columns[i]->apply_change(txn, key, olddata, newdata);
+    }
+
+    if (m_notified && res == 0) m_database->m_notifier->add(txn != m_database->m_txn ? txn : NULL, this, key, newdata, m_notify_values);
+
+    for (unsigned int i = 0; i < m_indexes.size() && res == 0; i++)
+    {
+        index * idx = m_indexes[i];
+
+        if (idx->m_cover == NULL) continue;
+
+        if (olddata != NULL && newdata != NULL)
+        {
+            res = idx->move_cover(txn, key, olddata, newdata);
+            continue;
+        }
+
+        if (olddata != NULL)             res = idx->del_cover(txn, key, olddata);
+        if (newdata != NULL && res == 0) res = idx->put_cover(txn, key, newdata);
+    }
+
+    return res;
+}
+
+/**
+ * Counts a call of profiled callback of specified kind, which has started at specified time.
+ */
+void table::count_callback (int      kind,      /**< [in] Kind of the callback (see "BDB_CALLBACK_COMPARE"). */
+                            uint64_t start)     /**< [in] Start time of the call (see "monotonic_time").     */
+{
+    uint64_t time = monotonic_time() - start;
+
+    boost::mutex::scoped_lock lock(m_counters->mutex);
+
+    m_counters->calls[kind]++;
+    m_counters->time[kind] += time;
+}
+
+/**
+ * @private Returns total time of profiled callbacks of the table, in nanoseconds ("0" if not profiled).
+ */
+uint64_t table::callback_time ()
+{
+    if (m_counters == NULL) return 0;
+
+    boost::mutex::scoped_lock lock(m_counters->mutex);
+
+    uint64_t time = 0;
+    for (int i = 0; i < BDB_CALLBACK_KINDS; i++) time += m_counters->time[i];
+
+    return time;
+}
+
+/**
+ * Trampoline of keys comparison function of profiled table (see "bdb::table_options::profile_callbacks").
+ */
+int table::compare_profiled (DB        * db,    /**< [in] Database of the table. */
+                             const DBT * dbt1,  /**< [in] First key.             */
+                             const DBT * dbt2)  /**< [in] Second key.            */
+{
+    table * tbl = (table *) db->app_private;
+
+    uint64_t start = monotonic_time();
+    int res = tbl->m_callback(db, dbt1, dbt2);
+    tbl->count_callback(BDB_CALLBACK_COMPARE, start);
+
+    return res;
+}
+
+/**
+ * Keys comparison function of table with keys of type, known at run time only (see "bdb::table_options::key_type").
+ */
+int table::compare_dynamic (DB        * db,     /**< [in] Database of the table. */
+                            const DBT * dbt1,   /**< [in] First key.             */
+                            const DBT * dbt2)   /**< [in] Second key.            */
+{
+    table * tbl = (table *) db->app_private;
+
+    return tbl->m_layout->compare(dbt1, dbt2);
+}
+
+/**
+ * Compares two serialized keys the way the table sorts them.
+ */
+int table::compare_keys (const DBT * k1,    /**< [in] First key.  */
+                         const DBT * k2)    /**< [in] Second key. */
+{
+    if (m_callback != NULL)
+    {
+        return m_callback(m_db, k1, k2);
+    }
+
+    // default order of Berkeley DB
+    int res = memcmp(k1->data, k2->data, (k1->size < k2->size ? k1->size : k2->size));
+
+    if (res != 0)
+    {
+        return res;
+    }
+
+    return (k1->size < k2->size ? -1 : (k1->size > k2->size ? +1 : 0));
+}
+
+/**
+ * Unserializes specified key in format of the table.
+ */
+void table::decode_key (const DBT   * dbt,    /**< [in]  Serialized key.   */
+                        MessageLite * key)    /**< [out] Unserialized key. */
+{
+    if (m_options.key_format == BDB_KEY_ORDERED)
+    {
+        unserialize_key(dbt, reflected(key));
+    }
+    else if (m_options.key_format == BDB_KEY_RECNO)
+    {
+        unserialize_recno(dbt, reflected(key));
+    }
+    else if (m_options.key_format == BDB_KEY_RID)
+    {
+        unserialize_rid(dbt, reflected(key));
+    }
+    else if (m_options.key_format == BDB_KEY_RAW)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::table::decode_key] Keys of the table are raw, not messages (see \"bdb::typed_table\").");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+    else
+    {
+        unserialize(dbt, key);
+    }
+}
+
+/**
+ * Checks whether the table is a recno, queue or heap one, which keys are record numbers (or ids).
+ */
+bool table::is_numbered ()
+{
+    return (m_options.access_method == BDB_ACCESS_RECNO || m_options.access_method == BDB_ACCESS_QUEUE || m_options.access_method == BDB_ACCESS_HEAP);
+}
+
+/**
+ * Checks whether the table is sorted by its keys, so ranges of keys can be used.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - the table is not a Btree one.
+ */
+void table::check_ordered (const char * operation)    /**< [in] Name of the operation (for logging). */
+{
+    if (m_options.access_method != BDB_ACCESS_BTREE)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::" << operation << "] Ranges of keys are supported by Btree tables only.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+}
+
+/**
+ * Appends specified record (or key only, if "data" is "NULL") to bulk buffer, built by "DB_MULTIPLE_WRITE_INIT".
+ * Records of recno and queue tables are appended by their numbers. If the buffer is full, "ptr" is set to "NULL".
+ */
+void table::write_bulk (void      *& ptr,   /**< [in/out] Current position in the buffer. */
+                        DBT        * bulk,  /**< [in]     Bulk buffer.                    */
+                        const DBT  * key,   /**< [in]     Serialized key.                 */
+                        const DBT  * data)  /**< [in]     Serialized data (or "NULL").    */
+{
+#ifdef BDB_BULK_PUT
+
+    // keys of inserted records are known to the Bloom filter before they are written
+    if (data != NULL && m_bloom != NULL) m_bloom->add(key);
+
+    if (m_options.key_format == BDB_KEY_RECNO)
+    {
+        db_recno_t recno;
+        memcpy(&recno, key->data, sizeof(db_recno_t));
+
+        DB_MULTIPLE_RECNO_WRITE_NEXT(ptr, bulk, recno, (data != NULL ? data->data : key->data), (data != NULL ? data->size : 0));
+    }
+    else if (data != NULL)
+    {
+        DB_MULTIPLE_KEY_WRITE_NEXT(ptr, bulk, key->data, key->size, data->data, data->size);
+    }
+    else
+    {
+        DB_MULTIPLE_WRITE_NEXT(ptr, bulk, key->data, key->size);
+    }
+
+#else
+
+    ptr = NULL;
+
+#endif
 }
 
 }
@@ -0,0 +1,291 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file bdb/src/transaction.cc
+ * Contains implementation of classes "bdb::transaction" and "bdb::snapshot".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cstring>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// Commit tokens are available since Berkeley DB 5.2
+#if (DB_VERSION_MAJOR > 5) || (DB_VERSION_MAJOR == 5) && (DB_VERSION_MINOR >= 2)
+#define BDB_TXN_TOKEN
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::transaction".
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+//--------------------------------------------------------------------------------------------------
+//  Constructors/destructors.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Begins new transaction.
+ * The durability policy takes effect when a top-level transaction is committed; committing of a nested
+ * transaction only passes its changes to the parent one.
+ *
+ * If "parent" is "NULL", the transaction becomes a child of current transaction of the calling thread
+ * (see "database::begin_transaction"), so it can see all changes made there.
+ *
+ * Unlike transactions started by "database::begin_transaction", this one is not bound to the thread,
+ * and can be explicitly passed to operations of tables and recordsets. Several transactions can be
+ * active at the same time, but each of them must not be used by several threads simultaneously.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+transaction::transaction (database    * db,         /**< [in] Database of the transaction.                     */
+                          transaction * parent,     /**< [in] Parent transaction (can be "NULL").              */
+                          int           durability, /**< [in] Durability policy (see @ref durability "codes"). */
+                          int           flags)      /**< [in] Flags of the transaction (see @ref txnflags "flags"). */
+  : m_database(db),
+    m_txn(NULL),
+    m_durability(durability),
+    m_flags(flags),
+    m_nested(true)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::transaction::transaction] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::transaction::transaction] durability = " << durability);
+    LOG4CPLUS_DEBUG(logger, "[bdb::transaction::transaction] flags = " << flags);
+
+    DB_TXN * ptxn = (flags & BDB_TXN_TOPLEVEL) ? NULL : m_database->get_transaction(parent);
+    m_nested = (ptxn != NULL);
+
+    int res = m_database->begin_txn(ptxn, &m_txn, m_durability, flags);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::transaction::transaction] " << db_strerror(res));
+        if (m_txn != NULL) m_database->abort_txn(m_txn);
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::transaction::transaction] EXIT");
+}
+
+/**
+ * Rolls back the transaction, if it's still active.
+ */
+transaction::~transaction () throw ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::transaction::~transaction] ENTER");
+
+    if (m_txn != NULL)
+    {
+        LOG4CPLUS_DEBUG(logger, "[bdb::transaction::~transaction] rolling back active transaction");
+        m_database->abort_txn(m_txn);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::transaction::~transaction] EXIT");
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Public interface.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Commits the transaction.
+ * All recordsets, opened in the transaction, must be closed before.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the transaction is already completed.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK  - the transaction is deadlocked.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void transaction::commit ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::transaction::commit] ENTER");
+
+    if (m_txn == NULL)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::transaction::commit] the transaction is already completed");
+        throw exception(BDB_ERROR_NOT_FOUND);
+    }
+
+    DB_TXN * txn = m_txn;
+    m_txn = NULL;
+
+    int res = m_database->commit_txn(txn, m_durability, m_nested);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::transaction::commit] " << db_strerror(res));
+        throw exception(res == DB_LOCK_DEADLOCK ? BDB_ERROR_DEADLOCK : BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::transaction::commit] EXIT");
+}
+
+/**
+ * Commits the transaction, and returns its token, by which replicas of the database can wait until
+ * the transaction is applied (see "bdb::database::wait_applied"), e.g. to read own writes from a replica.
+ * Only top-level transactions have tokens (the database should auto-commit, or the transaction
+ * should be begun with "BDB_TXN_TOPLEVEL"). Requires Berkeley DB 5.2 or later.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the transaction is already completed.
+ * @throw bdb::exception BDB_ERROR_DEADLOCK  - the transaction is deadlocked.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - the transaction is nested, or unknown error.
+ */
+void transaction::commit (commit_token * token)     /**< [out] Token of committed transaction. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::transaction::commit] ENTER");
+
+    if (m_txn == NULL)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::transaction::commit] the transaction is already completed");
+        throw exception(BDB_ERROR_NOT_FOUND);
+    }
+
+    if (m_nested)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::transaction::commit] Only top-level transactions have commit tokens.");
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+#ifdef BDB_TXN_TOKEN
+    // the token is filled by the commit
+    DB_TXN_TOKEN t;
+
+    int res = m_txn->set_commit_token(m_txn, &t);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::transaction::commit] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    commit();
+
+    memcpy(token->data, &t, sizeof(token->data));
+#else
+    LOG4CPLUS_WARN(logger, "[bdb::transaction::commit] Commit tokens require Berkeley DB 5.2 or later.");
+    throw exception(BDB_ERROR_UNKNOWN);
+#endif
+
+    LOG4CPLUS_TRACE(logger, "[bdb::transaction::commit] EXIT");
+}
+
+/**
+ * Rolls back the transaction.
+ * All recordsets, opened in the transaction, must be closed before.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the transaction is already completed.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void transaction::rollback ()
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::transaction::rollback] ENTER");
+
+    if (m_txn == NULL)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::transaction::rollback] the transaction is already completed");
+        throw exception(BDB_ERROR_NOT_FOUND);
+    }
+
+    DB_TXN * txn = m_txn;
+    m_txn = NULL;
+
+    int res = m_database->abort_txn(txn);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::transaction::rollback] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::transaction::rollback] EXIT");
+}
+
+/**
+ * Sets timeouts of the transaction, in microseconds.
+ * When a lock can't be acquired during "lock_timeout", or the transaction lasts longer than "txn_timeout",
+ * the operation fails with BDB_ERROR_DEADLOCK. Zero value means no timeout.
+ *
+ * @throw bdb::exception BDB_ERROR_NOT_FOUND - the transaction is already completed.
+ * @throw bdb::exception BDB_ERROR_UNKNOWN   - unknown error.
+ */
+void transaction::set_timeout (unsigned int lock_timeout,   /**< [in] Timeout of lock requests.    */
+                               unsigned int txn_timeout)    /**< [in] Timeout of whole transaction. */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::transaction::set_timeout] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::transaction::set_timeout] lock_timeout = " << lock_timeout);
+    LOG4CPLUS_DEBUG(logger, "[bdb::transaction::set_timeout] txn_timeout = " << txn_timeout);
+
+    if (m_txn == NULL)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::transaction::set_timeout] the transaction is already completed");
+        throw exception(BDB_ERROR_NOT_FOUND);
+    }
+
+    int res = m_txn->set_timeout(m_txn, lock_timeout, DB_SET_LOCK_TIMEOUT);
+
+    if (res == 0) res = m_txn->set_timeout(m_txn, txn_timeout, DB_SET_TXN_TIMEOUT);
+
+    if (res != 0)
+    {
+        LOG4CPLUS_WARN(logger, "[bdb::transaction::set_timeout] " << db_strerror(res));
+        throw exception(BDB_ERROR_UNKNOWN);
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::transaction::set_timeout] EXIT");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "bdb::snapshot".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Takes new snapshot of committed data.
+ * Uncommitted changes of current transactions (including ones of the calling thread) are not visible.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ */
+snapshot::snapshot (database * db)  /**< [in] Database of the snapshot. */
+  : transaction(db, NULL, BDB_DURABILITY_NOSYNC, BDB_TXN_SNAPSHOT | BDB_TXN_TOPLEVEL)
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::snapshot::snapshot] ENTER");
+    LOG4CPLUS_TRACE(logger, "[bdb::snapshot::snapshot] EXIT");
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
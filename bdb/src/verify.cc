@@ -0,0 +1,441 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+
+/** @file bdb/src/verify.cc
+ * Contains implementation of parallel verification of class "bdb::database".
+ * @author Artem Rodygin
+ */
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Boost C++ Libraries
+#include <boost/thread/mutex.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// Check for Berkeley DB version
+#if (DB_VERSION_MAJOR < 4) || (DB_VERSION_MAJOR == 4) && (DB_VERSION_MINOR < 7)
+#error Berkeley DB 4.7 or later is required.
+#endif
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of parallel verification.
+//--------------------------------------------------------------------------------------------------
+
+namespace bdb
+{
+
+using std::string;
+using std::vector;
+
+/** @private Maximum number of issues, reported by a verification (all of them are counted). */
+static const size_t VERIFY_MAX_ISSUES = 1000;
+
+/** @private Item of verification: a file to verify, or an index to cross-check against its table. */
+struct verify_item
+{
+    string   file;          /**< File of table or index.                              */
+    bool     encrypted;     /**< Whether the file is encrypted by Berkeley DB.        */
+    index  * idx;           /**< Index to cross-check ("NULL" - the file is verified). */
+};
+
+/**
+ * @private Returns 64-bit hash of index entry (FNV-1a of both keys, with bits mixed by finalizer of MurmurHash3).
+ */
+static uint64_t entry_hash (const void * key,       /**< [in] Index key.         */
+                            size_t       ksize,     /**< [in] Size of index key. */
+                            const void * primary,   /**< [in] Primary key.       */
+                            size_t       psize)     /**< [in] Size of primary key. */
+{
+    uint64_t h = 14695981039346656037ULL;
+
+    const unsigned char * p = (const unsigned char *) key;
+    for (size_t i = 0; i < ksize; i++) h = (h ^ p[i]) * 1099511628211ULL;
+
+    // size of index key separates the keys, so entries with a shifted boundary are different
+    h = (h ^ ksize) * 1099511628211ULL;
+
+    p = (const unsigned char *) primary;
+    for (size_t i = 0; i < psize; i++) h = (h ^ p[i]) * 1099511628211ULL;
+
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+/**
+ * @private Verification of database by tasks of the shared work pool. Each task takes the next item, until
+ * all items are done. An index is cross-checked by hashes of its entries: entries, made by its indexing
+ * function from all records of the table, and entries, stored by the index, are scanned in order, sorted,
+ * and merged, so nothing is looked up at random, and only differing entries are read again to report them.
+ */
+class verify_job
+{
+public:
+
+    verify_job (database * d, vector <verify_issue> * list) : db(d), next(0), count(0), error(0), issues(list) { }
+
+    database                * db;       /**< Verified database.                             */
+    vector <verify_item>      items;    /**< Items of verification (filled before the tasks start). */
+    boost::mutex              mutex;    /**< Guards all the fields below.                   */
+    size_t                    next;     /**< Index of the next item.                        */
+    uint64_t                  count;    /**< Number of found issues.                        */
+    int                       error;    /**< The first error of Berkeley DB ("0" - none).   */
+    vector <verify_issue>   * issues;   /**< Reported issues ("NULL" - issues are counted only). */
+
+    /**
+     * Body of verification task.
+     */
+    static void run (void * param)
+    {
+        static_cast <verify_job *> (param)->process();
+    }
+
+    /**
+     * Processes the next items, until all of them are done.
+     */
+    void process ()
+    {
+        for (;;)
+        {
+            const verify_item * item = NULL;
+
+            {
+                boost::mutex::scoped_lock lock(mutex);
+                if (next == items.size()) return;
+                item = &items[next++];
+            }
+
+            int res = (item->idx != NULL ? check_index(*item) : check_file(*item));
+
+            if (res != 0)
+            {
+                LOG4CPLUS_WARN(logger, "[bdb::database::verify] " << item->file << ": " << db_strerror(res));
+
+                boost::mutex::scoped_lock lock(mutex);
+                if (error == 0) error = res;
+            }
+        }
+    }
+
+    /**
+     * Adds issue of specified kind.
+     */
+    void report (int kind, const string & file, const DBT * key, const DBT * primary)
+    {
+        boost::mutex::scoped_lock lock(mutex);
+
+        count++;
+
+        if (issues == NULL || issues->size() >= VERIFY_MAX_ISSUES) return;
+
+        verify_issue issue;
+
+        issue.kind = kind;
+        issue.file = file;
+
+        if (key     != NULL) issue.key.assign((const char *) key->data, key->size);
+        if (primary != NULL) issue.primary.assign((const char *) primary->data, primary->size);
+
+        issues->push_back(issue);
+    }
+
+    /**
+     * Verifies structure of the file by Berkeley DB (order of keys is not checked, since it's defined by
+     * comparison functions of the application). Missing file (of table, which is not created yet) is skipped.
+     * Returns error code of Berkeley DB.
+     */
+    int check_file (const verify_item & item)
+    {
+        DB * handle = NULL;
+
+        int res = db_create(&handle, db->m_env, 0);
+
+        if (res == 0 && item.encrypted) res = handle->set_flags(handle, DB_ENCRYPT);
+
+        if (res != 0)
+        {
+            if (handle != NULL) handle->close(handle, 0);
+            return res;
+        }
+
+        // the handle is destroyed by verification itself, whatever its result is
+        res = handle->verify(handle, item.file.c_str(), NULL, NULL, DB_NOORDERCHK);
+
+        if (res == DB_VERIFY_BAD)
+        {
+            report(BDB_VERIFY_CORRUPTED, item.file, NULL, NULL);
+            res = 0;
+        }
+
+        return (res == ENOENT ? 0 : res);
+    }
+
+    /**
+     * Collects hashes of entries, which the indexing function of the index makes from records of its table.
+     * If the list of hashes to report is specified, then reports entries with these hashes instead.
+     * Returns error code of Berkeley DB.
+     */
+    int expected_entries (const verify_item        & item,      /**< [in]  Index to cross-check.                   */
+                          vector <uint64_t>        * hashes,    /**< [out] Hashes of entries.                      */
+                          const vector <uint64_t>  * wanted)    /**< [in]  Hashes of entries to report (or "NULL"). */
+    {
+        index * idx = item.idx;
+        table * tbl = idx->m_master;
+
+        DBC * cursor = NULL;
+
+        DBT k, d;
+
+        memset(&k, 0, sizeof(DBT));
+        memset(&d, 0, sizeof(DBT));
+
+        k.flags = DB_DBT_REALLOC;
+        d.flags = DB_DBT_REALLOC;
+
+        int res = tbl->m_db->cursor(tbl->m_db, NULL, &cursor, db->read_flags());
+
+        while (res == 0 && (res = cursor->get(cursor, &k, &d, DB_NEXT)) == 0)
+        {
+            DBT r;
+            memset(&r, 0, sizeof(DBT));
+
+            res = idx->m_indexer(idx->m_db, &k, &d, &r);
+
+            if (res == DB_DONOTINDEX)
+            {
+                res = 0;
+                continue;
+            }
+
+            if (res != 0) break;
+
+            // single key is handled as a list of one key
+            DBT     * keys  = ((r.flags & DB_DBT_MULTIPLE) != 0 ? (DBT *) r.data : &r);
+            u_int32_t nkeys = ((r.flags & DB_DBT_MULTIPLE) != 0 ? r.size : 1);
+
+            for (u_int32_t i = 0; i < nkeys; i++)
+            {
+                uint64_t h = entry_hash(keys[i].data, keys[i].size, k.data, k.size);
+
+                if (wanted == NULL)
+                {
+                    hashes->push_back(h);
+                }
+                else if (std::binary_search(wanted->begin(), wanted->end(), h))
+                {
+                    report(BDB_VERIFY_MISSING, item.file, &keys[i], &k);
+                }
+
+                if ((r.flags & DB_DBT_MULTIPLE) != 0 && (keys[i].flags & DB_DBT_APPMALLOC) != 0) free(keys[i].data);
+            }
+
+            if (r.flags & DB_DBT_APPMALLOC) free(r.data);
+        }
+
+        if (res == DB_NOTFOUND) res = 0;
+
+        if (cursor != NULL) cursor->close(cursor);
+
+        free(k.data);
+        free(d.data);
+
+        return res;
+    }
+
+    /**
+     * Collects hashes of entries, stored by the index (see "bdb::verify_job::expected_entries").
+     * Returns error code of Berkeley DB.
+     */
+    int stored_entries (const verify_item        & item,      /**< [in]  Index to cross-check.                   */
+                        vector <uint64_t>        * hashes,    /**< [out] Hashes of entries.                      */
+                        const vector <uint64_t>  * wanted)    /**< [in]  Hashes of entries to report (or "NULL"). */
+    {
+        index * idx = item.idx;
+
+        DBC * cursor = NULL;
+
+        DBT k, d;
+
+        memset(&k, 0, sizeof(DBT));
+        memset(&d, 0, sizeof(DBT));
+
+        k.flags = DB_DBT_REALLOC;
+        d.flags = DB_DBT_REALLOC;
+
+        // primary keys are read as data of plain handle, without lookups of primary records
+        int res = idx->m_plain->cursor(idx->m_plain, NULL, &cursor, db->read_flags());
+
+        while (res == 0 && (res = cursor->get(cursor, &k, &d, DB_NEXT)) == 0)
+        {
+            uint64_t h = entry_hash(k.data, k.size, d.data, d.size);
+
+            if (wanted == NULL)
+            {
+                hashes->push_back(h);
+            }
+            else if (std::binary_search(wanted->begin(), wanted->end(), h))
+            {
+                report(BDB_VERIFY_DANGLING, item.file, &k, &d);
+            }
+        }
+
+        if (res == DB_NOTFOUND) res = 0;
+
+        if (cursor != NULL) cursor->close(cursor);
+
+        free(k.data);
+        free(d.data);
+
+        return res;
+    }
+
+    /**
+     * Cross-checks the index against its table by merge of sorted hashes of their entries.
+     * Returns error code of Berkeley DB.
+     */
+    int check_index (const verify_item & item)
+    {
+        vector <uint64_t> expected, stored;
+
+        int res = expected_entries(item, &expected, NULL);
+        if (res == 0) res = stored_entries(item, &stored, NULL);
+
+        if (res != 0) return res;
+
+        std::sort(expected.begin(), expected.end());
+        std::sort(stored.begin(), stored.end());
+
+        vector <uint64_t> missing, dangling;
+
+        std::set_difference(expected.begin(), expected.end(), stored.begin(), stored.end(), std::back_inserter(missing));
+        std::set_difference(stored.begin(), stored.end(), expected.begin(), expected.end(), std::back_inserter(dangling));
+
+        LOG4CPLUS_DEBUG(logger, "[bdb::database::verify] " << item.file << ": entries = " << stored.size()
+                                << ", missing = " << missing.size() << ", dangling = " << dangling.size());
+
+        // only differing entries are read again
+        if (!missing.empty())  res = expected_entries(item, NULL, &missing);
+        if (!dangling.empty() && res == 0) res = stored_entries(item, NULL, &dangling);
+
+        return res;
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Verification of class "bdb::database".
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Verifies the database by several tasks of the shared work pool at once: files of all tables and indexes
+ * are verified by Berkeley DB, and each index (except deferred ones, and indexes of lazy tables, which are
+ * not opened yet) is cross-checked against its table (see @ref verifyissues "issues"). Cross-check keeps
+ * 16 bytes per entry of the index in memory. The database should not be modified during verification,
+ * otherwise concurrent changes can be reported as issues.
+ *
+ * @throw bdb::exception BDB_ERROR_UNKNOWN - unknown error.
+ *
+ * @return Number of found issues (at most 1000 of them are reported).
+ */
+uint64_t database::verify (unsigned int            nthreads,    /**< [in]  Number of parallel tasks.                  */
+                           vector <verify_issue> * issues)      /**< [out] Found issues (can be "NULL").              */
+{
+    LOG4CPLUS_TRACE(logger, "[bdb::database::verify] ENTER");
+    LOG4CPLUS_DEBUG(logger, "[bdb::database::verify] nthreads = " << nthreads);
+
+    if (issues != NULL) issues->clear();
+
+    verify_job job(this, issues);
+
+    vector <verify_item> files;
+
+    for (size_t i = 0; i < m_tables.size(); i++)
+    {
+        table * tbl = m_tables[i];
+
+        // files of partitioned tables are not verified one by one, and in-memory tables have no files
+        bool structure = (!m_memory && tbl->m_options.partitions == 0);
+
+        verify_item item = { tbl->get_filename(), tbl->m_options.encrypted, NULL };
+        if (structure) files.push_back(item);
+
+        for (size_t j = 0; j < tbl->m_indexes.size(); j++)
+        {
+            index * idx = tbl->m_indexes[j];
+
+            verify_item entry = { idx->get_filename(), tbl->m_options.encrypted, NULL };
+            if (structure) files.push_back(entry);
+
+            // cross-checks take longer, so they are started first
+            entry.idx = idx;
+            if (!tbl->m_lazy && idx->m_position == NULL) job.items.push_back(entry);
+        }
+    }
+
+    job.items.insert(job.items.end(), files.begin(), files.end());
+
+    {
+        task_group tasks(m_pool);
+
+        for (unsigned int i = 0; i < std::max(nthreads, 1U); i++)
+        {
+            tasks.run(verify_job::run, &job);
+        }
+    }
+
+    if (job.error != 0)
+    {
+        switch (job.error)
+        {
+            case DB_LOCK_DEADLOCK:
+            case DB_LOCK_NOTGRANTED:    throw exception(BDB_ERROR_DEADLOCK);
+            default:                    throw exception(BDB_ERROR_UNKNOWN);
+        }
+    }
+
+    LOG4CPLUS_TRACE(logger, "[bdb::database::verify] EXIT = " << job.count);
+
+    return job.count;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
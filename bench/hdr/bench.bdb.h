@@ -0,0 +1,19 @@
+// Generated by the BDB code generator.  DO NOT EDIT!
+// source: bench.proto
+
+#ifndef BDB_bench_INCLUDED
+#define BDB_bench_INCLUDED
+
+#include <bdb.h>
+
+namespace bench {
+
+int key_id_compare (DB *, const DBT * dbt1, const DBT * dbt2);
+int data_bucket_index (DB *, const DBT * key, const DBT * data, DBT * result);
+int data_color_index (DB *, const DBT * key, const DBT * data, DBT * result);
+int bucket_ix_bucket_compare (DB *, const DBT * dbt1, const DBT * dbt2);
+int color_ix_color_compare (DB *, const DBT * dbt1, const DBT * dbt2);
+
+}  // namespace bench
+
+#endif  // BDB_bench_INCLUDED
@@ -0,0 +1,605 @@
+// Generated by the protocol buffer compiler.  DO NOT EDIT!
+// source: bench.proto
+
+#ifndef PROTOBUF_bench_2eproto__INCLUDED
+#define PROTOBUF_bench_2eproto__INCLUDED
+
+#include <string>
+
+#include <google/protobuf/stubs/common.h>
+
+#if GOOGLE_PROTOBUF_VERSION < 2004000
+#error This file was generated by a newer version of protoc which is
+#error incompatible with your Protocol Buffer headers.  Please update
+#error your headers.
+#endif
+#if 2004001 < GOOGLE_PROTOBUF_MIN_PROTOC_VERSION
+#error This file was generated by an older version of protoc which is
+#error incompatible with your Protocol Buffer headers.  Please
+#error regenerate this file with a newer version of protoc.
+#endif
+
+#include <google/protobuf/generated_message_util.h>
+#include <google/protobuf/repeated_field.h>
+#include <google/protobuf/extension_set.h>
+#include <google/protobuf/generated_message_reflection.h>
+#include "bdb.pb.h"
+// @@protoc_insertion_point(includes)
+
+namespace bench {
+
+// Internal implementation detail -- do not call these.
+void  protobuf_AddDesc_bench_2eproto();
+void protobuf_AssignDesc_bench_2eproto();
+void protobuf_ShutdownFile_bench_2eproto();
+
+class key;
+class data;
+class bucket_ix;
+class color_ix;
+
+// ===================================================================
+
+class key : public ::google::protobuf::Message {
+ public:
+  key();
+  virtual ~key();
+  
+  key(const key& from);
+  
+  inline key& operator=(const key& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+  
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+  
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const key& default_instance();
+  
+  // Maximum size of the serialized message (fixed layout).
+  static const int kMaxByteSize = 11;
+  
+  void Swap(key* other);
+  
+  // implements Message ----------------------------------------------
+  
+  key* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const key& from);
+  void MergeFrom(const key& from);
+  void Clear();
+  bool IsInitialized() const;
+  
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+  
+  ::google::protobuf::Metadata GetMetadata() const;
+  
+  // nested types ----------------------------------------------------
+  
+  // accessors -------------------------------------------------------
+  
+  // required int64 id = 1;
+  inline bool has_id() const;
+  inline void clear_id();
+  static const int kIdFieldNumber = 1;
+  inline ::google::protobuf::int64 id() const;
+  inline void set_id(::google::protobuf::int64 value);
+  
+  // @@protoc_insertion_point(class_scope:bench.key)
+ private:
+  inline void set_has_id();
+  inline void clear_has_id();
+  
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+  
+  ::google::protobuf::int64 id_;
+  
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(1 + 31) / 32];
+  
+  friend void  protobuf_AddDesc_bench_2eproto();
+  friend void protobuf_AssignDesc_bench_2eproto();
+  friend void protobuf_ShutdownFile_bench_2eproto();
+  
+  void InitAsDefaultInstance();
+  static key* default_instance_;
+};
+// -------------------------------------------------------------------
+
+class data : public ::google::protobuf::Message {
+ public:
+  data();
+  virtual ~data();
+  
+  data(const data& from);
+  
+  inline data& operator=(const data& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+  
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+  
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const data& default_instance();
+  
+  void Swap(data* other);
+  
+  // implements Message ----------------------------------------------
+  
+  data* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const data& from);
+  void MergeFrom(const data& from);
+  void Clear();
+  bool IsInitialized() const;
+  
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+  
+  ::google::protobuf::Metadata GetMetadata() const;
+  
+  // nested types ----------------------------------------------------
+  
+  // accessors -------------------------------------------------------
+  
+  // required int64 bucket = 1;
+  inline bool has_bucket() const;
+  inline void clear_bucket();
+  static const int kBucketFieldNumber = 1;
+  inline ::google::protobuf::int64 bucket() const;
+  inline void set_bucket(::google::protobuf::int64 value);
+  
+  // required int64 color = 2;
+  inline bool has_color() const;
+  inline void clear_color();
+  static const int kColorFieldNumber = 2;
+  inline ::google::protobuf::int64 color() const;
+  inline void set_color(::google::protobuf::int64 value);
+  
+  // required bytes payload = 3;
+  inline bool has_payload() const;
+  inline void clear_payload();
+  static const int kPayloadFieldNumber = 3;
+  inline const ::std::string& payload() const;
+  inline void set_payload(const ::std::string& value);
+  inline void set_payload(const char* value);
+  inline void set_payload(const void* value, size_t size);
+  inline ::std::string* mutable_payload();
+  inline ::std::string* release_payload();
+  
+  // @@protoc_insertion_point(class_scope:bench.data)
+ private:
+  inline void set_has_bucket();
+  inline void clear_has_bucket();
+  inline void set_has_color();
+  inline void clear_has_color();
+  inline void set_has_payload();
+  inline void clear_has_payload();
+  
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+  
+  ::google::protobuf::int64 bucket_;
+  ::google::protobuf::int64 color_;
+  ::std::string* payload_;
+  
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(3 + 31) / 32];
+  
+  friend void  protobuf_AddDesc_bench_2eproto();
+  friend void protobuf_AssignDesc_bench_2eproto();
+  friend void protobuf_ShutdownFile_bench_2eproto();
+  
+  void InitAsDefaultInstance();
+  static data* default_instance_;
+};
+// -------------------------------------------------------------------
+
+class bucket_ix : public ::google::protobuf::Message {
+ public:
+  bucket_ix();
+  virtual ~bucket_ix();
+  
+  bucket_ix(const bucket_ix& from);
+  
+  inline bucket_ix& operator=(const bucket_ix& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+  
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+  
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const bucket_ix& default_instance();
+  
+  // Maximum size of the serialized message (fixed layout).
+  static const int kMaxByteSize = 11;
+  
+  void Swap(bucket_ix* other);
+  
+  // implements Message ----------------------------------------------
+  
+  bucket_ix* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const bucket_ix& from);
+  void MergeFrom(const bucket_ix& from);
+  void Clear();
+  bool IsInitialized() const;
+  
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+  
+  ::google::protobuf::Metadata GetMetadata() const;
+  
+  // nested types ----------------------------------------------------
+  
+  // accessors -------------------------------------------------------
+  
+  // required int64 bucket = 1;
+  inline bool has_bucket() const;
+  inline void clear_bucket();
+  static const int kBucketFieldNumber = 1;
+  inline ::google::protobuf::int64 bucket() const;
+  inline void set_bucket(::google::protobuf::int64 value);
+  
+  // @@protoc_insertion_point(class_scope:bench.bucket_ix)
+ private:
+  inline void set_has_bucket();
+  inline void clear_has_bucket();
+  
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+  
+  ::google::protobuf::int64 bucket_;
+  
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(1 + 31) / 32];
+  
+  friend void  protobuf_AddDesc_bench_2eproto();
+  friend void protobuf_AssignDesc_bench_2eproto();
+  friend void protobuf_ShutdownFile_bench_2eproto();
+  
+  void InitAsDefaultInstance();
+  static bucket_ix* default_instance_;
+};
+// -------------------------------------------------------------------
+
+class color_ix : public ::google::protobuf::Message {
+ public:
+  color_ix();
+  virtual ~color_ix();
+  
+  color_ix(const color_ix& from);
+  
+  inline color_ix& operator=(const color_ix& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+  
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+  
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const color_ix& default_instance();
+  
+  // Maximum size of the serialized message (fixed layout).
+  static const int kMaxByteSize = 11;
+  
+  void Swap(color_ix* other);
+  
+  // implements Message ----------------------------------------------
+  
+  color_ix* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const color_ix& from);
+  void MergeFrom(const color_ix& from);
+  void Clear();
+  bool IsInitialized() const;
+  
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+  
+  ::google::protobuf::Metadata GetMetadata() const;
+  
+  // nested types ----------------------------------------------------
+  
+  // accessors -------------------------------------------------------
+  
+  // required int64 color = 1;
+  inline bool has_color() const;
+  inline void clear_color();
+  static const int kColorFieldNumber = 1;
+  inline ::google::protobuf::int64 color() const;
+  inline void set_color(::google::protobuf::int64 value);
+  
+  // @@protoc_insertion_point(class_scope:bench.color_ix)
+ private:
+  inline void set_has_color();
+  inline void clear_has_color();
+  
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+  
+  ::google::protobuf::int64 color_;
+  
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(1 + 31) / 32];
+  
+  friend void  protobuf_AddDesc_bench_2eproto();
+  friend void protobuf_AssignDesc_bench_2eproto();
+  friend void protobuf_ShutdownFile_bench_2eproto();
+  
+  void InitAsDefaultInstance();
+  static color_ix* default_instance_;
+};
+// ===================================================================
+
+
+// ===================================================================
+
+// key
+
+// required int64 id = 1;
+inline bool key::has_id() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void key::set_has_id() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void key::clear_has_id() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void key::clear_id() {
+  id_ = GOOGLE_LONGLONG(0);
+  clear_has_id();
+}
+inline ::google::protobuf::int64 key::id() const {
+  return id_;
+}
+inline void key::set_id(::google::protobuf::int64 value) {
+  set_has_id();
+  id_ = value;
+}
+
+// -------------------------------------------------------------------
+
+// data
+
+// required int64 bucket = 1;
+inline bool data::has_bucket() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void data::set_has_bucket() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void data::clear_has_bucket() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void data::clear_bucket() {
+  bucket_ = GOOGLE_LONGLONG(0);
+  clear_has_bucket();
+}
+inline ::google::protobuf::int64 data::bucket() const {
+  return bucket_;
+}
+inline void data::set_bucket(::google::protobuf::int64 value) {
+  set_has_bucket();
+  bucket_ = value;
+}
+
+// required int64 color = 2;
+inline bool data::has_color() const {
+  return (_has_bits_[0] & 0x00000002u) != 0;
+}
+inline void data::set_has_color() {
+  _has_bits_[0] |= 0x00000002u;
+}
+inline void data::clear_has_color() {
+  _has_bits_[0] &= ~0x00000002u;
+}
+inline void data::clear_color() {
+  color_ = GOOGLE_LONGLONG(0);
+  clear_has_color();
+}
+inline ::google::protobuf::int64 data::color() const {
+  return color_;
+}
+inline void data::set_color(::google::protobuf::int64 value) {
+  set_has_color();
+  color_ = value;
+}
+
+// required bytes payload = 3;
+inline bool data::has_payload() const {
+  return (_has_bits_[0] & 0x00000004u) != 0;
+}
+inline void data::set_has_payload() {
+  _has_bits_[0] |= 0x00000004u;
+}
+inline void data::clear_has_payload() {
+  _has_bits_[0] &= ~0x00000004u;
+}
+inline void data::clear_payload() {
+  if (payload_ != &::google::protobuf::internal::kEmptyString) {
+    payload_->clear();
+  }
+  clear_has_payload();
+}
+inline const ::std::string& data::payload() const {
+  return *payload_;
+}
+inline void data::set_payload(const ::std::string& value) {
+  set_has_payload();
+  if (payload_ == &::google::protobuf::internal::kEmptyString) {
+    payload_ = new ::std::string;
+  }
+  payload_->assign(value);
+}
+inline void data::set_payload(const char* value) {
+  set_has_payload();
+  if (payload_ == &::google::protobuf::internal::kEmptyString) {
+    payload_ = new ::std::string;
+  }
+  payload_->assign(value);
+}
+inline void data::set_payload(const void* value, size_t size) {
+  set_has_payload();
+  if (payload_ == &::google::protobuf::internal::kEmptyString) {
+    payload_ = new ::std::string;
+  }
+  payload_->assign(reinterpret_cast<const char*>(value), size);
+}
+inline ::std::string* data::mutable_payload() {
+  set_has_payload();
+  if (payload_ == &::google::protobuf::internal::kEmptyString) {
+    payload_ = new ::std::string;
+  }
+  return payload_;
+}
+inline ::std::string* data::release_payload() {
+  clear_has_payload();
+  if (payload_ == &::google::protobuf::internal::kEmptyString) {
+    return NULL;
+  } else {
+    ::std::string* temp = payload_;
+    payload_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+    return temp;
+  }
+}
+
+// -------------------------------------------------------------------
+
+// bucket_ix
+
+// required int64 bucket = 1;
+inline bool bucket_ix::has_bucket() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void bucket_ix::set_has_bucket() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void bucket_ix::clear_has_bucket() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void bucket_ix::clear_bucket() {
+  bucket_ = GOOGLE_LONGLONG(0);
+  clear_has_bucket();
+}
+inline ::google::protobuf::int64 bucket_ix::bucket() const {
+  return bucket_;
+}
+inline void bucket_ix::set_bucket(::google::protobuf::int64 value) {
+  set_has_bucket();
+  bucket_ = value;
+}
+
+// -------------------------------------------------------------------
+
+// color_ix
+
+// required int64 color = 1;
+inline bool color_ix::has_color() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void color_ix::set_has_color() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void color_ix::clear_has_color() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void color_ix::clear_color() {
+  color_ = GOOGLE_LONGLONG(0);
+  clear_has_color();
+}
+inline ::google::protobuf::int64 color_ix::color() const {
+  return color_;
+}
+inline void color_ix::set_color(::google::protobuf::int64 value) {
+  set_has_color();
+  color_ = value;
+}
+
+
+// @@protoc_insertion_point(namespace_scope)
+
+}  // namespace bench
+
+#ifndef SWIG
+namespace google {
+namespace protobuf {
+
+
+}  // namespace google
+}  // namespace protobuf
+#endif  // SWIG
+
+// @@protoc_insertion_point(global_scope)
+
+#endif  // PROTOBUF_bench_2eproto__INCLUDED
@@ -0,0 +1,33 @@
+// Generated by the BDB code generator.  DO NOT EDIT!
+// source: bench.proto
+
+#include "bench.bdb.h"
+
+namespace bench {
+
+int key_id_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    return bdb::compare_field(dbt1, dbt2, 1, BDB_FIELD_INT64);
+}
+
+int data_bucket_index (DB *, const DBT *, const DBT * data, DBT * result)
+{
+    return bdb::index_field(data, 1, 1, result);
+}
+
+int data_color_index (DB *, const DBT *, const DBT * data, DBT * result)
+{
+    return bdb::index_field(data, 2, 1, result);
+}
+
+int bucket_ix_bucket_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    return bdb::compare_field(dbt1, dbt2, 1, BDB_FIELD_INT64);
+}
+
+int color_ix_color_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    return bdb::compare_field(dbt1, dbt2, 1, BDB_FIELD_INT64);
+}
+
+}  // namespace bench
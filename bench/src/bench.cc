@@ -0,0 +1,940 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#ifdef WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Boost C++ Libraries
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread.hpp>
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+#include <log4cplus/configurator.h>
+
+// Namespaces in use.
+using namespace std;
+
+// Data schema.
+#include <bench.pb.h>
+#include <bench.bdb.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Definitions.
+//--------------------------------------------------------------------------------------------------
+
+// Benchmarked operations.
+#define OP_INSERT       0
+#define OP_UPDATE       1
+#define OP_SELECT       2
+#define OP_EXISTS       3
+#define OP_SCAN         4
+#define OP_INDEX_SCAN   5
+#define OP_JOIN         6
+#define OP_MIXED        7
+#define OP_REMOVE       8
+#define OP_COUNT        9
+
+// Distributions of keys.
+#define DIST_SEQUENTIAL 0
+#define DIST_UNIFORM    1
+#define DIST_ZIPFIAN    2
+
+// Number of records in one bucket (see "bucket_ix" index).
+#define BUCKET_SIZE     16
+
+// Number of different colors (see "color_ix" index).
+#define COLORS          4
+
+// Skew of zipfian distribution.
+#define ZIPF_THETA      0.99
+
+// Maximum number of retries of deadlocked transaction.
+#define MAX_RETRIES     10
+
+// Names of operations.
+static const char * op_names[OP_COUNT] =
+{
+    "insert", "update", "select", "exists", "scan", "index_scan", "join", "mixed", "remove"
+};
+
+// Names of distributions.
+static const char * dist_names[] = { "sequential", "uniform", "zipfian" };
+
+// Names of durability policies (indexed by policy codes).
+static const char * durability_names[] = { "default", "sync", "write_nosync", "nosync", "group" };
+
+//--------------------------------------------------------------------------------------------------
+//  Settings.
+//--------------------------------------------------------------------------------------------------
+
+// Benchmark settings.
+struct settings
+{
+    string          home;           // Parent directory of benchmark databases.
+    int             records;        // Number of records in table.
+    unsigned int    window;         // Group commit window, in microseconds.
+    int             writes;         // Percentage of updates of mixed workload.
+    bool            json;           // Whether to output results in JSON (otherwise CSV).
+    vector <int>    threads;        // Numbers of threads to run.
+    vector <int>    sizes;          // Sizes of record payloads.
+    vector <int>    dists;          // Key distributions.
+    vector <int>    durabilities;   // Durability policies.
+    vector <bool>   ops;            // Operations to measure.
+};
+
+// Splits comma-separated list.
+static vector <string> split (const string & list)
+{
+    vector <string> items;
+    stringstream    ss(list);
+    string          item;
+
+    while (getline(ss, item, ','))
+    {
+        if (!item.empty()) items.push_back(item);
+    }
+
+    return items;
+}
+
+// Finds specified name in the list of names, returns its index, or "-1".
+static int find_name (const string & name, const char ** names, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (name == names[i]) return i;
+    }
+
+    return -1;
+}
+
+// Parses list of names into list of their indexes.
+static bool parse_names (const string & list, const char ** names, int first, int count, vector <int> * result)
+{
+    vector <string> items = split(list);
+    result->clear();
+
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        int n = find_name(items[i], names, count);
+        if (n < first) return false;
+        result->push_back(n);
+    }
+
+    return !result->empty();
+}
+
+// Parses list of positive numbers, or of ranges of them ("1..8" is "1,2,3,4,5,6,7,8").
+static bool parse_numbers (const string & list, vector <int> * result)
+{
+    vector <string> items = split(list);
+    result->clear();
+
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        size_t pos = items[i].find("..");
+
+        int first = atoi(items[i].c_str());
+        int last  = (pos == string::npos ? first : atoi(items[i].c_str() + pos + 2));
+
+        if (first <= 0 || last < first) return false;
+
+        for (int n = first; n <= last; n++)
+        {
+            result->push_back(n);
+        }
+    }
+
+    return !result->empty();
+}
+
+// Prints usage.
+static void usage ()
+{
+    cerr << "Usage: bench [options]\n"
+         << "\n"
+         << "  --home=DIR               parent directory of benchmark databases (\"benchdb\")\n"
+         << "  --records=N              number of records in table (10000)\n"
+         << "  --threads=N[,N...]       numbers of threads, or ranges of them, e.g. 1..8 (1)\n"
+         << "  --size=N[,N...]          sizes of record payloads, in bytes (100)\n"
+         << "  --distribution=D[,D...]  key distributions: sequential, uniform, zipfian (uniform)\n"
+         << "  --durability=P[,P...]    durability policies: sync, write_nosync, nosync, group (nosync)\n"
+         << "  --window=USEC            group commit window, in microseconds (1000)\n"
+         << "  --writes=PCT             percentage of updates of mixed workload, the rest are selects (20)\n"
+         << "  --ops=OP[,OP...]         operations: insert, update, select, exists, scan, index_scan, join, mixed,\n"
+         << "                           remove (all)\n"
+         << "  --format=F               output format: csv, json (csv)\n"
+         << "\n"
+         << "Each combination of threads, size, distribution, and durability is run against a new\n"
+         << "database, created in a subdirectory of the home directory, which should be empty.\n"
+         << "Deadlocked transactions are retried, and are reported along with contention for locks,\n"
+         << "hit rate of the cache, and speedup against the first number of threads.\n";
+}
+
+// Parses command line.
+static bool parse_settings (int argc, char ** argv, settings * s)
+{
+    s->home    = "benchdb";
+    s->records = 10000;
+    s->window  = 1000;
+    s->writes  = 20;
+    s->json    = false;
+
+    s->threads.assign(1, 1);
+    s->sizes.assign(1, 100);
+    s->dists.assign(1, DIST_UNIFORM);
+    s->durabilities.assign(1, BDB_DURABILITY_NOSYNC);
+    s->ops.assign(OP_COUNT, true);
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        size_t pos = arg.find('=');
+
+        if (arg.compare(0, 2, "--") != 0 || pos == string::npos)
+        {
+            return false;
+        }
+
+        string name  = arg.substr(2, pos - 2);
+        string value = arg.substr(pos + 1);
+
+        bool res = true;
+
+        if (name == "home")
+        {
+            s->home = value;
+        }
+        else if (name == "records")
+        {
+            s->records = atoi(value.c_str());
+            res = (s->records > 0);
+        }
+        else if (name == "threads")
+        {
+            res = parse_numbers(value, &s->threads);
+        }
+        else if (name == "size")
+        {
+            res = parse_numbers(value, &s->sizes);
+        }
+        else if (name == "distribution")
+        {
+            res = parse_names(value, dist_names, DIST_SEQUENTIAL, 3, &s->dists);
+        }
+        else if (name == "durability")
+        {
+            res = parse_names(value, durability_names, BDB_DURABILITY_SYNC, 5, &s->durabilities);
+        }
+        else if (name == "window")
+        {
+            s->window = (unsigned int) atoi(value.c_str());
+        }
+        else if (name == "writes")
+        {
+            s->writes = atoi(value.c_str());
+            res = (s->writes >= 0 && s->writes <= 100);
+        }
+        else if (name == "ops")
+        {
+            vector <int> ops;
+            res = parse_names(value, op_names, OP_INSERT, OP_COUNT, &ops);
+
+            s->ops.assign(OP_COUNT, false);
+
+            for (size_t j = 0; j < ops.size(); j++)
+            {
+                s->ops[ops[j]] = true;
+            }
+        }
+        else if (name == "format")
+        {
+            s->json = (value == "json");
+            res = (value == "json" || value == "csv");
+        }
+        else
+        {
+            res = false;
+        }
+
+        if (!res)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Keys generation.
+//--------------------------------------------------------------------------------------------------
+
+// Computes zeta function of zipfian distribution.
+static double zeta (int64_t n, double theta)
+{
+    double sum = 0;
+
+    for (int64_t i = 1; i <= n; i++)
+    {
+        sum += 1.0 / pow((double) i, theta);
+    }
+
+    return sum;
+}
+
+// Generator of keys from [0, n) with specified distribution.
+class generator
+{
+public:
+
+    generator (int dist, int64_t n, double zetan, uint64_t seed, int64_t start, int64_t step)
+      : m_dist(dist),
+        m_n(n),
+        m_next(start),
+        m_step(step),
+        m_state(seed * 0x9E3779B97F4A7C15ULL + 1),
+        m_zetan(zetan)
+    {
+        if (m_dist == DIST_ZIPFIAN)
+        {
+            m_alpha = 1.0 / (1.0 - ZIPF_THETA);
+            m_eta   = (1.0 - pow(2.0 / n, 1.0 - ZIPF_THETA)) / (1.0 - zeta(2, ZIPF_THETA) / m_zetan);
+        }
+    }
+
+    // Returns next key.
+    int64_t next ()
+    {
+        int64_t key;
+
+        switch (m_dist)
+        {
+            case DIST_SEQUENTIAL:
+                key    = m_next % m_n;
+                m_next = m_next + m_step;
+                return key;
+
+            case DIST_ZIPFIAN:
+            {
+                double u  = uniform();
+                double uz = u * m_zetan;
+
+                if (uz < 1.0) return 0;
+                if (uz < 1.0 + pow(0.5, ZIPF_THETA)) return (m_n > 1 ? 1 : 0);
+
+                key = (int64_t) (m_n * pow(m_eta * u - m_eta + 1.0, m_alpha));
+                return (key < m_n ? key : m_n - 1);
+            }
+
+            default:
+                return (int64_t) (random() % (uint64_t) m_n);
+        }
+    }
+
+    // Returns next pseudo-random number (xorshift64*).
+    uint64_t random ()
+    {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+
+        return m_state * 2685821657736338717ULL;
+    }
+
+protected:
+
+    // Returns next pseudo-random number from [0, 1).
+    double uniform ()
+    {
+        return (double) (random() >> 11) / 9007199254740992.0;
+    }
+
+protected:
+
+    int      m_dist;    // Distribution.
+    int64_t  m_n;       // Number of keys.
+    int64_t  m_next;    // Next sequential key.
+    int64_t  m_step;    // Step of sequential keys.
+    uint64_t m_state;   // State of pseudo-random generator.
+    double   m_zetan;   // Zeta(n) of zipfian distribution.
+    double   m_alpha;   // Parameters of zipfian distribution.
+    double   m_eta;
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Benchmark run.
+//--------------------------------------------------------------------------------------------------
+
+// Parameters of one benchmark run.
+struct run
+{
+    bdb::database * db;
+    bdb::table    * tbl;
+    bdb::index    * ibucket;
+    bdb::index    * icolor;
+    int             records;
+    int             threads;
+    int             size;
+    int             dist;
+    int             durability;
+    int             writes;
+    double          zetan;
+};
+
+// Results of one thread.
+struct thread_result
+{
+    vector <double> latencies;  // Latencies of operations, in microseconds.
+    int             errors;     // Number of failed operations.
+    int             retries;    // Number of retries of deadlocked transactions.
+};
+
+// Makes a record with specified ID.
+static void make_record (const run * r, int64_t id, bench::key * key, bench::data * data)
+{
+    key->set_id(id);
+    data->set_bucket(id / BUCKET_SIZE);
+    data->set_color(id % COLORS);
+
+    if ((int) data->payload().size() != r->size)
+    {
+        data->set_payload(string(r->size, 'x'));
+    }
+}
+
+// Current time.
+static inline boost::posix_time::ptime now ()
+{
+    return boost::posix_time::microsec_clock::universal_time();
+}
+
+// Microseconds elapsed since specified time.
+static inline double elapsed (const boost::posix_time::ptime & start)
+{
+    return (double) (now() - start).total_microseconds();
+}
+
+// Modification of a record in a transaction (see "write_record").
+struct write_op
+{
+    const run   * r;        // Parameters of the run.
+    int           op;       // Operation ("OP_INSERT", "OP_UPDATE", or "OP_REMOVE").
+    bench::key  * key;      // Key of the record.
+    bench::data * data;     // Data of the record.
+    int           calls;    // Number of attempts of the transaction.
+};
+
+// Modifies the record, called by "bdb::database::run_in_transaction" (once per attempt).
+static void write_record (bdb::transaction * txn, void * param)
+{
+    write_op * w = (write_op *) param;
+    w->calls++;
+
+    if (w->op == OP_INSERT) w->r->tbl->insert(w->key, w->data, txn);
+    if (w->op == OP_UPDATE) w->r->tbl->update(w->key, w->data, txn);
+    if (w->op == OP_REMOVE) w->r->tbl->remove(w->key, txn);
+}
+
+// Runs one operation (may consist of several fetches), returns its latency.
+static double execute (const run * r, int op, generator * gen, int64_t id, int * retries)
+{
+    bench::key  key;
+    bench::data data;
+
+    boost::posix_time::ptime start = now();
+
+    // Mixed workload updates or selects the record.
+    if (op == OP_MIXED)
+    {
+        op = ((int) (gen->random() % 100) < r->writes ? OP_UPDATE : OP_SELECT);
+    }
+
+    switch (op)
+    {
+        case OP_INSERT:
+        case OP_UPDATE:
+        case OP_REMOVE:
+        {
+            make_record(r, id, &key, &data);
+
+            write_op w = { r, op, &key, &data, 0 };
+
+            try
+            {
+                r->db->run_in_transaction(write_record, &w, MAX_RETRIES);
+            }
+            catch (bdb::exception &)
+            {
+                *retries += w.calls - 1;
+                throw;
+            }
+
+            *retries += w.calls - 1;
+            break;
+        }
+
+        case OP_SELECT:
+            key.set_id(id);
+            r->tbl->select(&key, &data);
+            break;
+
+        case OP_EXISTS:
+            key.set_id(id);
+            r->tbl->exists(&key);
+            break;
+
+        case OP_INDEX_SCAN:
+        {
+            bench::bucket_ix bkey;
+            bkey.set_bucket(id / BUCKET_SIZE);
+
+            bdb::recordset rs(r->ibucket, &bkey);
+            while (rs.fetch(&key, &data)) {}
+            break;
+        }
+
+        case OP_JOIN:
+        {
+            bench::bucket_ix bkey;
+            bench::color_ix  ckey;
+
+            bkey.set_bucket(id / BUCKET_SIZE);
+            ckey.set_color(gen->random() % COLORS);
+
+            bdb::recordset rsb(r->ibucket, &bkey);
+            bdb::recordset rsc(r->icolor,  &ckey);
+
+            bdb::joinlist list;
+            list.push_back(&rsb);
+            list.push_back(&rsc);
+
+            bdb::recordset rs(r->tbl, list);
+            while (rs.fetch(&key, &data)) {}
+            break;
+        }
+    }
+
+    return elapsed(start);
+}
+
+// Thread of benchmark run.
+static void worker (const run     * r,          // Parameters of the run.
+                    int             op,         // Operation to measure.
+                    int             thread,     // Number of the thread.
+                    boost::barrier * sync,      // Start barrier.
+                    thread_result * result)     // Results of the thread.
+{
+    generator gen(r->dist, r->records, r->zetan, thread + 1, thread, r->threads);
+
+    result->latencies.clear();
+    result->errors  = 0;
+    result->retries = 0;
+
+    // Insertions and removals visit each key of the thread once.
+    vector <int64_t> ids;
+
+    if (op == OP_INSERT || op == OP_REMOVE)
+    {
+        for (int64_t id = thread; id < r->records; id += r->threads)
+        {
+            ids.push_back(id);
+        }
+
+        if (r->dist != DIST_SEQUENTIAL)
+        {
+            for (size_t i = ids.size(); i > 1; i--)
+            {
+                swap(ids[i - 1], ids[gen.random() % i]);
+            }
+        }
+    }
+    else
+    {
+        int count = r->records / r->threads;
+
+        // Each index scan or join fetches a bucket of records.
+        if (op == OP_INDEX_SCAN || op == OP_JOIN)
+        {
+            count /= BUCKET_SIZE;
+        }
+
+        for (int i = 0; i < max(count, 1); i++)
+        {
+            ids.push_back(gen.next());
+        }
+    }
+
+    result->latencies.reserve(op == OP_SCAN ? r->records : ids.size());
+
+    sync->wait();
+
+    if (op == OP_SCAN)
+    {
+        // Each fetch of a full table scan is measured.
+        try
+        {
+            bench::key  key;
+            bench::data data;
+
+            bdb::recordset rs(r->tbl);
+
+            for (;;)
+            {
+                boost::posix_time::ptime start = now();
+                if (!rs.fetch(&key, &data)) break;
+                result->latencies.push_back(elapsed(start));
+            }
+        }
+        catch (bdb::exception &)
+        {
+            result->errors++;
+        }
+
+        return;
+    }
+
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        try
+        {
+            result->latencies.push_back(execute(r, op, &gen, ids[i], &result->retries));
+        }
+        catch (bdb::exception &)
+        {
+            result->errors++;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Results.
+//--------------------------------------------------------------------------------------------------
+
+// Measured performance of one operation.
+struct measure
+{
+    int     op;
+    int     threads;
+    int     size;
+    int     dist;
+    int     durability;
+    size_t  ops;
+    int     errors;
+    int     retries;
+    double  seconds;
+    double  p50;
+    double  p99;
+    double  p999;
+    double  speedup;            // Throughput against the first number of threads.
+    bdb::database_stats stats;  // Statistics of the environment during the operation.
+};
+
+// Returns specified percentile of sorted latencies.
+static double percentile (const vector <double> & sorted, double p)
+{
+    if (sorted.empty()) return 0;
+
+    size_t n = (size_t) ceil(p * sorted.size());
+    return sorted[(n > 0 ? n - 1 : 0)];
+}
+
+// Returns percentage of part of total ("0" if total is "0").
+static double percentage (uint64_t part, uint64_t total)
+{
+    return (total > 0 ? 100.0 * part / total : 0);
+}
+
+// Prints header of results.
+static void print_header (const settings & s)
+{
+    if (s.json)
+    {
+        cout << "[";
+    }
+    else
+    {
+        cout << "operation,threads,size,distribution,durability,ops,errors,seconds,ops_per_sec,p50_us,p99_us,p999_us,"
+             << "speedup,retries,deadlocks,lock_waits,lock_wait_pct,cache_hit_pct\n";
+    }
+}
+
+// Prints one result.
+static void print_measure (const settings & s, const measure & m, bool first)
+{
+    double rate  = (m.seconds > 0 ? m.ops / m.seconds : 0);
+    double waits = percentage(m.stats.lock_waits, m.stats.lock_requests);
+    double hits  = percentage(m.stats.cache_hits, m.stats.cache_hits + m.stats.cache_misses);
+
+    if (s.json)
+    {
+        cout << (first ? "\n" : ",\n")
+             << "  {\"operation\": \""    << op_names[m.op]                  << "\""
+             <<  ", \"threads\": "        << m.threads
+             <<  ", \"size\": "           << m.size
+             <<  ", \"distribution\": \"" << dist_names[m.dist]              << "\""
+             <<  ", \"durability\": \""   << durability_names[m.durability]  << "\""
+             <<  ", \"ops\": "            << m.ops
+             <<  ", \"errors\": "         << m.errors
+             <<  ", \"seconds\": "        << m.seconds
+             <<  ", \"ops_per_sec\": "    << rate
+             <<  ", \"p50_us\": "         << m.p50
+             <<  ", \"p99_us\": "         << m.p99
+             <<  ", \"p999_us\": "        << m.p999
+             <<  ", \"speedup\": "        << m.speedup
+             <<  ", \"retries\": "        << m.retries
+             <<  ", \"deadlocks\": "      << m.stats.deadlocks
+             <<  ", \"lock_waits\": "     << m.stats.lock_waits
+             <<  ", \"lock_wait_pct\": "  << waits
+             <<  ", \"cache_hit_pct\": "  << hits
+             << "}";
+    }
+    else
+    {
+        cout << op_names[m.op]                 << ","
+             << m.threads                      << ","
+             << m.size                         << ","
+             << dist_names[m.dist]             << ","
+             << durability_names[m.durability] << ","
+             << m.ops                          << ","
+             << m.errors                       << ","
+             << m.seconds                      << ","
+             << rate                           << ","
+             << m.p50                          << ","
+             << m.p99                          << ","
+             << m.p999                         << ","
+             << m.speedup                      << ","
+             << m.retries                      << ","
+             << m.stats.deadlocks              << ","
+             << m.stats.lock_waits             << ","
+             << waits                          << ","
+             << hits                           << "\n";
+    }
+
+    cout.flush();
+}
+
+// Prints footer of results.
+static void print_footer (const settings & s)
+{
+    if (s.json)
+    {
+        cout << "\n]\n";
+    }
+
+    cout.flush();
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Benchmark.
+//--------------------------------------------------------------------------------------------------
+
+// Creates directory, returns "false" on failure.
+static bool make_directory (const string & path)
+{
+#ifdef WIN32
+    int res = _mkdir(path.c_str());
+#else
+    int res = mkdir(path.c_str(), 0755);
+#endif
+
+    return (res == 0 || errno == EEXIST);
+}
+
+// Measures specified operation.
+static measure benchmark (const run * r, int op)
+{
+    vector <thread_result> results(r->threads);
+    boost::barrier         sync(r->threads + 1);
+    boost::thread_group    group;
+    measure                m;
+
+    for (int i = 0; i < r->threads; i++)
+    {
+        group.create_thread(boost::bind(&worker, r, op, i, &sync, &results[i]));
+    }
+
+    // counters of the environment are cleared, so they are of the operation only
+    r->db->stats(&m.stats, true);
+
+    sync.wait();
+
+    boost::posix_time::ptime start = now();
+    group.join_all();
+
+    m.seconds = elapsed(start) / 1000000.0;
+    r->db->stats(&m.stats);
+
+    m.op         = op;
+    m.threads    = r->threads;
+    m.size       = r->size;
+    m.dist       = r->dist;
+    m.durability = r->durability;
+    m.errors     = 0;
+    m.retries    = 0;
+    m.speedup    = 1;
+
+    vector <double> latencies;
+
+    for (int i = 0; i < r->threads; i++)
+    {
+        latencies.insert(latencies.end(), results[i].latencies.begin(), results[i].latencies.end());
+        m.errors  += results[i].errors;
+        m.retries += results[i].retries;
+    }
+
+    sort(latencies.begin(), latencies.end());
+
+    m.ops  = latencies.size();
+    m.p50  = percentile(latencies, 0.50);
+    m.p99  = percentile(latencies, 0.99);
+    m.p999 = percentile(latencies, 0.999);
+
+    return m;
+}
+
+int main (int argc, char ** argv)
+{
+    log4cplus::BasicConfigurator::doConfigure();
+    log4cplus::Logger::getInstance(BDB_LOGGER_PORT).setLogLevel(log4cplus::OFF_LOG_LEVEL);
+
+    settings s;
+
+    if (!parse_settings(argc, argv, &s))
+    {
+        usage();
+        return -1;
+    }
+
+    if (!make_directory(s.home))
+    {
+        cerr << "Cannot create directory \"" << s.home << "\".\n";
+        return -1;
+    }
+
+    double zetan = zeta(s.records, ZIPF_THETA);
+    int    count = 0;
+    bool   first = true;
+
+    // Throughputs of the first number of threads by operation, size, distribution, and durability.
+    map <string, double> baselines;
+
+    print_header(s);
+
+    for (size_t t = 0; t < s.threads.size();      t++)
+    for (size_t z = 0; z < s.sizes.size();        z++)
+    for (size_t d = 0; d < s.dists.size();        d++)
+    for (size_t p = 0; p < s.durabilities.size(); p++)
+    {
+        stringstream home;
+        home << s.home << "/run" << ++count;
+
+        if (!make_directory(home.str()))
+        {
+            cerr << "Cannot create directory \"" << home.str() << "\".\n";
+            return -1;
+        }
+
+        try
+        {
+            run r;
+
+            r.records    = s.records;
+            r.threads    = s.threads[t];
+            r.size       = s.sizes[z];
+            r.dist       = s.dists[d];
+            r.durability = s.durabilities[p];
+            r.writes     = s.writes;
+            r.zetan      = zetan;
+
+            r.db = new bdb::database(home.str().c_str(), true);
+            r.db->set_durability(r.durability, s.window);
+
+            r.tbl     = r.db->add_table("bench", bench::key_id_compare, true);
+            r.ibucket = r.tbl->add_index("bench_bucket", bench::data_bucket_index, bench::bucket_ix_bucket_compare);
+            r.icolor  = r.tbl->add_index("bench_color",  bench::data_color_index,  bench::color_ix_color_compare);
+
+            // The table is always filled, even if insertions are not reported.
+            for (int op = OP_INSERT; op < OP_COUNT; op++)
+            {
+                if (op != OP_INSERT && !s.ops[op])
+                {
+                    continue;
+                }
+
+                measure m = benchmark(&r, op);
+
+                stringstream baseline;
+                baseline << op << "/" << z << "/" << d << "/" << p;
+
+                double rate = (m.seconds > 0 ? m.ops / m.seconds : 0);
+
+                if (baselines.find(baseline.str()) == baselines.end())
+                {
+                    baselines[baseline.str()] = rate;
+                }
+                else if (baselines[baseline.str()] > 0)
+                {
+                    m.speedup = rate / baselines[baseline.str()];
+                }
+
+                if (s.ops[op])
+                {
+                    print_measure(s, m, first);
+                    first = false;
+                }
+            }
+
+            delete r.db;
+        }
+        catch (bdb::exception & e)
+        {
+            cerr << "Benchmark failed with error " << e.error() << " in \"" << home.str() << "\".\n";
+            return -1;
+        }
+    }
+
+    print_footer(s);
+
+    return 0;
+}
@@ -0,0 +1,1152 @@
+// Generated by the protocol buffer compiler.  DO NOT EDIT!
+
+#define INTERNAL_SUPPRESS_PROTOBUF_FIELD_DEPRECATION
+#include "bench.pb.h"
+
+#include <algorithm>
+
+#include <google/protobuf/stubs/once.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite_inl.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/reflection_ops.h>
+#include <google/protobuf/wire_format.h>
+// @@protoc_insertion_point(includes)
+
+namespace bench {
+
+namespace {
+
+const ::google::protobuf::Descriptor* key_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  key_reflection_ = NULL;
+const ::google::protobuf::Descriptor* data_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  data_reflection_ = NULL;
+const ::google::protobuf::Descriptor* bucket_ix_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  bucket_ix_reflection_ = NULL;
+const ::google::protobuf::Descriptor* color_ix_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  color_ix_reflection_ = NULL;
+
+}  // namespace
+
+
+void protobuf_AssignDesc_bench_2eproto() {
+  protobuf_AddDesc_bench_2eproto();
+  const ::google::protobuf::FileDescriptor* file =
+    ::google::protobuf::DescriptorPool::generated_pool()->FindFileByName(
+      "bench.proto");
+  GOOGLE_CHECK(file != NULL);
+  key_descriptor_ = file->message_type(0);
+  static const int key_offsets_[1] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(key, id_),
+  };
+  key_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      key_descriptor_,
+      key::default_instance_,
+      key_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(key, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(key, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(key));
+  data_descriptor_ = file->message_type(1);
+  static const int data_offsets_[3] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(data, bucket_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(data, color_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(data, payload_),
+  };
+  data_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      data_descriptor_,
+      data::default_instance_,
+      data_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(data, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(data, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(data));
+  bucket_ix_descriptor_ = file->message_type(2);
+  static const int bucket_ix_offsets_[1] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(bucket_ix, bucket_),
+  };
+  bucket_ix_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      bucket_ix_descriptor_,
+      bucket_ix::default_instance_,
+      bucket_ix_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(bucket_ix, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(bucket_ix, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(bucket_ix));
+  color_ix_descriptor_ = file->message_type(3);
+  static const int color_ix_offsets_[1] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(color_ix, color_),
+  };
+  color_ix_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      color_ix_descriptor_,
+      color_ix::default_instance_,
+      color_ix_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(color_ix, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(color_ix, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(color_ix));
+}
+
+namespace {
+
+GOOGLE_PROTOBUF_DECLARE_ONCE(protobuf_AssignDescriptors_once_);
+inline void protobuf_AssignDescriptorsOnce() {
+  ::google::protobuf::GoogleOnceInit(&protobuf_AssignDescriptors_once_,
+                 &protobuf_AssignDesc_bench_2eproto);
+}
+
+void protobuf_RegisterTypes(const ::std::string&) {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    key_descriptor_, &key::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    data_descriptor_, &data::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    bucket_ix_descriptor_, &bucket_ix::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    color_ix_descriptor_, &color_ix::default_instance());
+}
+
+}  // namespace
+
+void protobuf_ShutdownFile_bench_2eproto() {
+  delete key::default_instance_;
+  delete key_reflection_;
+  delete data::default_instance_;
+  delete data_reflection_;
+  delete bucket_ix::default_instance_;
+  delete bucket_ix_reflection_;
+  delete color_ix::default_instance_;
+  delete color_ix_reflection_;
+}
+
+void protobuf_AddDesc_bench_2eproto() {
+  static bool already_here = false;
+  if (already_here) return;
+  already_here = true;
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  ::bdb::protobuf_AddDesc_bdb_2eproto();
+  ::google::protobuf::DescriptorPool::InternalAddGeneratedFile(
+    "\n\013bench.proto\022\005bench\032\tbdb.proto\"\027\n\003key\022\020"
+    "\n\002id\030\001 \002(\003B\004\310\363\030\001\"S\n\004data\022\035\n\006bucket\030\001 \002(\003"
+    "B\r\322\363\030\tbucket_ix\022\033\n\005color\030\002 \002(\003B\014\322\363\030\010colo"
+    "r_ix\022\017\n\007payload\030\003 \002(\014\"!\n\tbucket_ix\022\024\n\006bu"
+    "cket\030\001 \002(\003B\004\310\363\030\001\"\037\n\010color_ix\022\023\n\005color\030\001 "
+    "\002(\003B\004\310\363\030\001", 209);
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
+    "bench.proto", &protobuf_RegisterTypes);
+  key::default_instance_ = new key();
+  data::default_instance_ = new data();
+  bucket_ix::default_instance_ = new bucket_ix();
+  color_ix::default_instance_ = new color_ix();
+  key::default_instance_->InitAsDefaultInstance();
+  data::default_instance_->InitAsDefaultInstance();
+  bucket_ix::default_instance_->InitAsDefaultInstance();
+  color_ix::default_instance_->InitAsDefaultInstance();
+  ::google::protobuf::internal::OnShutdown(&protobuf_ShutdownFile_bench_2eproto);
+}
+
+// Force AddDescriptors() to be called at static initialization time.
+struct StaticDescriptorInitializer_bench_2eproto {
+  StaticDescriptorInitializer_bench_2eproto() {
+    protobuf_AddDesc_bench_2eproto();
+  }
+} static_descriptor_initializer_bench_2eproto_;
+
+
+// ===================================================================
+
+#ifndef _MSC_VER
+const int key::kIdFieldNumber;
+const int key::kMaxByteSize;
+#endif  // !_MSC_VER
+
+key::key()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+}
+
+void key::InitAsDefaultInstance() {
+}
+
+key::key(const key& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+}
+
+void key::SharedCtor() {
+  _cached_size_ = 0;
+  id_ = GOOGLE_LONGLONG(0);
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+key::~key() {
+  SharedDtor();
+}
+
+void key::SharedDtor() {
+  if (this != default_instance_) {
+  }
+}
+
+void key::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* key::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return key_descriptor_;
+}
+
+const key& key::default_instance() {
+  if (default_instance_ == NULL) protobuf_AddDesc_bench_2eproto();  return *default_instance_;
+}
+
+key* key::default_instance_ = NULL;
+
+key* key::New() const {
+  return new key;
+}
+
+void key::Clear() {
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    id_ = GOOGLE_LONGLONG(0);
+  }
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool key::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) return false
+  ::google::protobuf::uint32 tag;
+  while ((tag = input->ReadTag()) != 0) {
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // required int64 id = 1;
+      case 1: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int64, ::google::protobuf::internal::WireFormatLite::TYPE_INT64>(
+                 input, &id_)));
+          set_has_id();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectAtEnd()) return true;
+        break;
+      }
+      
+      default: {
+      handle_uninterpreted:
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          return true;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+  return true;
+#undef DO_
+}
+
+void key::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // required int64 id = 1;
+  if (has_id()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt64(1, this->id(), output);
+  }
+  
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+}
+
+::google::protobuf::uint8* key::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // Fast path:  all fields of fixed layout are set.
+  if ((_has_bits_[0] & 0x00000001u) == 0x00000001u && unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(1, this->id(), target);
+    return target;
+  }
+  
+  // required int64 id = 1;
+  if (has_id()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(1, this->id(), target);
+  }
+  
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  return target;
+}
+
+int key::ByteSize() const {
+  int total_size = 0;
+  
+  // Fast path:  all fields of fixed layout are set.
+  if ((_has_bits_[0] & 0x00000001u) == 0x00000001u && unknown_fields().empty()) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::Int64Size(
+        this->id());
+    GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+    _cached_size_ = total_size;
+    GOOGLE_SAFE_CONCURRENT_WRITES_END();
+    return total_size;
+  }
+  
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    // required int64 id = 1;
+    if (has_id()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int64Size(
+          this->id());
+    }
+    
+  }
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void key::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const key* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const key*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void key::MergeFrom(const key& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (from.has_id()) {
+      set_id(from.id());
+    }
+  }
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void key::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void key::CopyFrom(const key& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool key::IsInitialized() const {
+  if ((_has_bits_[0] & 0x00000001) != 0x00000001) return false;
+  
+  return true;
+}
+
+void key::Swap(key* other) {
+  if (other != this) {
+    std::swap(id_, other->id_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata key::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = key_descriptor_;
+  metadata.reflection = key_reflection_;
+  return metadata;
+}
+
+
+// ===================================================================
+
+#ifndef _MSC_VER
+const int data::kBucketFieldNumber;
+const int data::kColorFieldNumber;
+const int data::kPayloadFieldNumber;
+#endif  // !_MSC_VER
+
+data::data()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+}
+
+void data::InitAsDefaultInstance() {
+}
+
+data::data(const data& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+}
+
+void data::SharedCtor() {
+  _cached_size_ = 0;
+  bucket_ = GOOGLE_LONGLONG(0);
+  color_ = GOOGLE_LONGLONG(0);
+  payload_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+data::~data() {
+  SharedDtor();
+}
+
+void data::SharedDtor() {
+  if (payload_ != &::google::protobuf::internal::kEmptyString) {
+    delete payload_;
+  }
+  if (this != default_instance_) {
+  }
+}
+
+void data::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* data::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return data_descriptor_;
+}
+
+const data& data::default_instance() {
+  if (default_instance_ == NULL) protobuf_AddDesc_bench_2eproto();  return *default_instance_;
+}
+
+data* data::default_instance_ = NULL;
+
+data* data::New() const {
+  return new data;
+}
+
+void data::Clear() {
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    bucket_ = GOOGLE_LONGLONG(0);
+    color_ = GOOGLE_LONGLONG(0);
+    if (has_payload()) {
+      if (payload_ != &::google::protobuf::internal::kEmptyString) {
+        payload_->clear();
+      }
+    }
+  }
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool data::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) return false
+  ::google::protobuf::uint32 tag;
+  while ((tag = input->ReadTag()) != 0) {
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // required int64 bucket = 1;
+      case 1: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int64, ::google::protobuf::internal::WireFormatLite::TYPE_INT64>(
+                 input, &bucket_)));
+          set_has_bucket();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(16)) goto parse_color;
+        break;
+      }
+      
+      // required int64 color = 2;
+      case 2: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_color:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int64, ::google::protobuf::internal::WireFormatLite::TYPE_INT64>(
+                 input, &color_)));
+          set_has_color();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(26)) goto parse_payload;
+        break;
+      }
+      
+      // required bytes payload = 3;
+      case 3: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_payload:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadBytes(
+                input, this->mutable_payload()));
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectAtEnd()) return true;
+        break;
+      }
+      
+      default: {
+      handle_uninterpreted:
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          return true;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+  return true;
+#undef DO_
+}
+
+void data::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // required int64 bucket = 1;
+  if (has_bucket()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt64(1, this->bucket(), output);
+  }
+  
+  // required int64 color = 2;
+  if (has_color()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt64(2, this->color(), output);
+  }
+  
+  // required bytes payload = 3;
+  if (has_payload()) {
+    ::google::protobuf::internal::WireFormatLite::WriteBytes(
+      3, this->payload(), output);
+  }
+  
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+}
+
+::google::protobuf::uint8* data::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // required int64 bucket = 1;
+  if (has_bucket()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(1, this->bucket(), target);
+  }
+  
+  // required int64 color = 2;
+  if (has_color()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(2, this->color(), target);
+  }
+  
+  // required bytes payload = 3;
+  if (has_payload()) {
+    target =
+      ::google::protobuf::internal::WireFormatLite::WriteBytesToArray(
+        3, this->payload(), target);
+  }
+  
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  return target;
+}
+
+int data::ByteSize() const {
+  int total_size = 0;
+  
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    // required int64 bucket = 1;
+    if (has_bucket()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int64Size(
+          this->bucket());
+    }
+    
+    // required int64 color = 2;
+    if (has_color()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int64Size(
+          this->color());
+    }
+    
+    // required bytes payload = 3;
+    if (has_payload()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::BytesSize(
+          this->payload());
+    }
+    
+  }
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void data::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const data* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const data*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void data::MergeFrom(const data& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (from.has_bucket()) {
+      set_bucket(from.bucket());
+    }
+    if (from.has_color()) {
+      set_color(from.color());
+    }
+    if (from.has_payload()) {
+      set_payload(from.payload());
+    }
+  }
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void data::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void data::CopyFrom(const data& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool data::IsInitialized() const {
+  if ((_has_bits_[0] & 0x00000007) != 0x00000007) return false;
+  
+  return true;
+}
+
+void data::Swap(data* other) {
+  if (other != this) {
+    std::swap(bucket_, other->bucket_);
+    std::swap(color_, other->color_);
+    std::swap(payload_, other->payload_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata data::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = data_descriptor_;
+  metadata.reflection = data_reflection_;
+  return metadata;
+}
+
+
+// ===================================================================
+
+#ifndef _MSC_VER
+const int bucket_ix::kBucketFieldNumber;
+const int bucket_ix::kMaxByteSize;
+#endif  // !_MSC_VER
+
+bucket_ix::bucket_ix()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+}
+
+void bucket_ix::InitAsDefaultInstance() {
+}
+
+bucket_ix::bucket_ix(const bucket_ix& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+}
+
+void bucket_ix::SharedCtor() {
+  _cached_size_ = 0;
+  bucket_ = GOOGLE_LONGLONG(0);
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+bucket_ix::~bucket_ix() {
+  SharedDtor();
+}
+
+void bucket_ix::SharedDtor() {
+  if (this != default_instance_) {
+  }
+}
+
+void bucket_ix::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* bucket_ix::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return bucket_ix_descriptor_;
+}
+
+const bucket_ix& bucket_ix::default_instance() {
+  if (default_instance_ == NULL) protobuf_AddDesc_bench_2eproto();  return *default_instance_;
+}
+
+bucket_ix* bucket_ix::default_instance_ = NULL;
+
+bucket_ix* bucket_ix::New() const {
+  return new bucket_ix;
+}
+
+void bucket_ix::Clear() {
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    bucket_ = GOOGLE_LONGLONG(0);
+  }
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool bucket_ix::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) return false
+  ::google::protobuf::uint32 tag;
+  while ((tag = input->ReadTag()) != 0) {
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // required int64 bucket = 1;
+      case 1: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int64, ::google::protobuf::internal::WireFormatLite::TYPE_INT64>(
+                 input, &bucket_)));
+          set_has_bucket();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectAtEnd()) return true;
+        break;
+      }
+      
+      default: {
+      handle_uninterpreted:
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          return true;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+  return true;
+#undef DO_
+}
+
+void bucket_ix::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // required int64 bucket = 1;
+  if (has_bucket()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt64(1, this->bucket(), output);
+  }
+  
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+}
+
+::google::protobuf::uint8* bucket_ix::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // Fast path:  all fields of fixed layout are set.
+  if ((_has_bits_[0] & 0x00000001u) == 0x00000001u && unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(1, this->bucket(), target);
+    return target;
+  }
+  
+  // required int64 bucket = 1;
+  if (has_bucket()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(1, this->bucket(), target);
+  }
+  
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  return target;
+}
+
+int bucket_ix::ByteSize() const {
+  int total_size = 0;
+  
+  // Fast path:  all fields of fixed layout are set.
+  if ((_has_bits_[0] & 0x00000001u) == 0x00000001u && unknown_fields().empty()) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::Int64Size(
+        this->bucket());
+    GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+    _cached_size_ = total_size;
+    GOOGLE_SAFE_CONCURRENT_WRITES_END();
+    return total_size;
+  }
+  
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    // required int64 bucket = 1;
+    if (has_bucket()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int64Size(
+          this->bucket());
+    }
+    
+  }
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void bucket_ix::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const bucket_ix* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const bucket_ix*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void bucket_ix::MergeFrom(const bucket_ix& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (from.has_bucket()) {
+      set_bucket(from.bucket());
+    }
+  }
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void bucket_ix::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void bucket_ix::CopyFrom(const bucket_ix& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool bucket_ix::IsInitialized() const {
+  if ((_has_bits_[0] & 0x00000001) != 0x00000001) return false;
+  
+  return true;
+}
+
+void bucket_ix::Swap(bucket_ix* other) {
+  if (other != this) {
+    std::swap(bucket_, other->bucket_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata bucket_ix::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = bucket_ix_descriptor_;
+  metadata.reflection = bucket_ix_reflection_;
+  return metadata;
+}
+
+
+// ===================================================================
+
+#ifndef _MSC_VER
+const int color_ix::kColorFieldNumber;
+const int color_ix::kMaxByteSize;
+#endif  // !_MSC_VER
+
+color_ix::color_ix()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+}
+
+void color_ix::InitAsDefaultInstance() {
+}
+
+color_ix::color_ix(const color_ix& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+}
+
+void color_ix::SharedCtor() {
+  _cached_size_ = 0;
+  color_ = GOOGLE_LONGLONG(0);
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+color_ix::~color_ix() {
+  SharedDtor();
+}
+
+void color_ix::SharedDtor() {
+  if (this != default_instance_) {
+  }
+}
+
+void color_ix::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* color_ix::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return color_ix_descriptor_;
+}
+
+const color_ix& color_ix::default_instance() {
+  if (default_instance_ == NULL) protobuf_AddDesc_bench_2eproto();  return *default_instance_;
+}
+
+color_ix* color_ix::default_instance_ = NULL;
+
+color_ix* color_ix::New() const {
+  return new color_ix;
+}
+
+void color_ix::Clear() {
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    color_ = GOOGLE_LONGLONG(0);
+  }
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool color_ix::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) return false
+  ::google::protobuf::uint32 tag;
+  while ((tag = input->ReadTag()) != 0) {
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // required int64 color = 1;
+      case 1: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int64, ::google::protobuf::internal::WireFormatLite::TYPE_INT64>(
+                 input, &color_)));
+          set_has_color();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectAtEnd()) return true;
+        break;
+      }
+      
+      default: {
+      handle_uninterpreted:
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          return true;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+  return true;
+#undef DO_
+}
+
+void color_ix::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // required int64 color = 1;
+  if (has_color()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt64(1, this->color(), output);
+  }
+  
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+}
+
+::google::protobuf::uint8* color_ix::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // Fast path:  all fields of fixed layout are set.
+  if ((_has_bits_[0] & 0x00000001u) == 0x00000001u && unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(1, this->color(), target);
+    return target;
+  }
+  
+  // required int64 color = 1;
+  if (has_color()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(1, this->color(), target);
+  }
+  
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  return target;
+}
+
+int color_ix::ByteSize() const {
+  int total_size = 0;
+  
+  // Fast path:  all fields of fixed layout are set.
+  if ((_has_bits_[0] & 0x00000001u) == 0x00000001u && unknown_fields().empty()) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::Int64Size(
+        this->color());
+    GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+    _cached_size_ = total_size;
+    GOOGLE_SAFE_CONCURRENT_WRITES_END();
+    return total_size;
+  }
+  
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    // required int64 color = 1;
+    if (has_color()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int64Size(
+          this->color());
+    }
+    
+  }
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void color_ix::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const color_ix* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const color_ix*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void color_ix::MergeFrom(const color_ix& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (from.has_color()) {
+      set_color(from.color());
+    }
+  }
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void color_ix::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void color_ix::CopyFrom(const color_ix& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool color_ix::IsInitialized() const {
+  if ((_has_bits_[0] & 0x00000001) != 0x00000001) return false;
+  
+  return true;
+}
+
+void color_ix::Swap(color_ix* other) {
+  if (other != this) {
+    std::swap(color_, other->color_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata color_ix::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = color_ix_descriptor_;
+  metadata.reflection = color_ix_reflection_;
+  return metadata;
+}
+
+
+// @@protoc_insertion_point(namespace_scope)
+
+}  // namespace bench
+
+// @@protoc_insertion_point(global_scope)
@@ -0,0 +1,743 @@
+// Generated by the protocol buffer compiler.  DO NOT EDIT!
+// source: codec.proto
+
+#ifndef PROTOBUF_codec_2eproto__INCLUDED
+#define PROTOBUF_codec_2eproto__INCLUDED
+
+#include <string>
+
+#include <google/protobuf/stubs/common.h>
+
+#if GOOGLE_PROTOBUF_VERSION < 2004000
+#error This file was generated by a newer version of protoc which is
+#error incompatible with your Protocol Buffer headers.  Please update
+#error your headers.
+#endif
+#if 2004001 < GOOGLE_PROTOBUF_MIN_PROTOC_VERSION
+#error This file was generated by an older version of protoc which is
+#error incompatible with your Protocol Buffer headers.  Please
+#error regenerate this file with a newer version of protoc.
+#endif
+
+#include <google/protobuf/generated_message_util.h>
+#include <google/protobuf/repeated_field.h>
+#include <google/protobuf/extension_set.h>
+#include <google/protobuf/generated_message_reflection.h>
+// @@protoc_insertion_point(includes)
+
+namespace codec {
+
+// Internal implementation detail -- do not call these.
+void  protobuf_AddDesc_codec_2eproto();
+void protobuf_AssignDesc_codec_2eproto();
+void protobuf_ShutdownFile_codec_2eproto();
+
+class item;
+class wide;
+class blob;
+
+// ===================================================================
+
+class item : public ::google::protobuf::Message {
+ public:
+  item();
+  virtual ~item();
+  
+  item(const item& from);
+  
+  inline item& operator=(const item& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+  
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+  
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const item& default_instance();
+  
+  void Swap(item* other);
+  
+  // implements Message ----------------------------------------------
+  
+  item* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const item& from);
+  void MergeFrom(const item& from);
+  void Clear();
+  bool IsInitialized() const;
+  
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+  
+  ::google::protobuf::Metadata GetMetadata() const;
+  
+  // nested types ----------------------------------------------------
+  
+  // accessors -------------------------------------------------------
+  
+  // required int64 id = 1;
+  inline bool has_id() const;
+  inline void clear_id();
+  static const int kIdFieldNumber = 1;
+  inline ::google::protobuf::int64 id() const;
+  inline void set_id(::google::protobuf::int64 value);
+  
+  // required string name = 2;
+  inline bool has_name() const;
+  inline void clear_name();
+  static const int kNameFieldNumber = 2;
+  inline const ::std::string& name() const;
+  inline void set_name(const ::std::string& value);
+  inline void set_name(const char* value);
+  inline void set_name(const char* value, size_t size);
+  inline ::std::string* mutable_name();
+  inline ::std::string* release_name();
+  
+  // optional double weight = 3;
+  inline bool has_weight() const;
+  inline void clear_weight();
+  static const int kWeightFieldNumber = 3;
+  inline double weight() const;
+  inline void set_weight(double value);
+  
+  // @@protoc_insertion_point(class_scope:codec.item)
+ private:
+  inline void set_has_id();
+  inline void clear_has_id();
+  inline void set_has_name();
+  inline void clear_has_name();
+  inline void set_has_weight();
+  inline void clear_has_weight();
+  
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+  
+  ::google::protobuf::int64 id_;
+  ::std::string* name_;
+  double weight_;
+  
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(3 + 31) / 32];
+  
+  friend void  protobuf_AddDesc_codec_2eproto();
+  friend void protobuf_AssignDesc_codec_2eproto();
+  friend void protobuf_ShutdownFile_codec_2eproto();
+  
+  void InitAsDefaultInstance();
+  static item* default_instance_;
+};
+// -------------------------------------------------------------------
+
+class wide : public ::google::protobuf::Message {
+ public:
+  wide();
+  virtual ~wide();
+  
+  wide(const wide& from);
+  
+  inline wide& operator=(const wide& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+  
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+  
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const wide& default_instance();
+  
+  void Swap(wide* other);
+  
+  // implements Message ----------------------------------------------
+  
+  wide* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const wide& from);
+  void MergeFrom(const wide& from);
+  void Clear();
+  bool IsInitialized() const;
+  
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+  
+  ::google::protobuf::Metadata GetMetadata() const;
+  
+  // nested types ----------------------------------------------------
+  
+  // accessors -------------------------------------------------------
+  
+  // repeated int64 ids = 1 [packed = true];
+  inline int ids_size() const;
+  inline void clear_ids();
+  static const int kIdsFieldNumber = 1;
+  inline ::google::protobuf::int64 ids(int index) const;
+  inline void set_ids(int index, ::google::protobuf::int64 value);
+  inline void add_ids(::google::protobuf::int64 value);
+  inline const ::google::protobuf::RepeatedField< ::google::protobuf::int64 >&
+      ids() const;
+  inline ::google::protobuf::RepeatedField< ::google::protobuf::int64 >*
+      mutable_ids();
+  
+  // repeated string names = 2;
+  inline int names_size() const;
+  inline void clear_names();
+  static const int kNamesFieldNumber = 2;
+  inline const ::std::string& names(int index) const;
+  inline ::std::string* mutable_names(int index);
+  inline void set_names(int index, const ::std::string& value);
+  inline void set_names(int index, const char* value);
+  inline void set_names(int index, const char* value, size_t size);
+  inline ::std::string* add_names();
+  inline void add_names(const ::std::string& value);
+  inline void add_names(const char* value);
+  inline void add_names(const char* value, size_t size);
+  inline const ::google::protobuf::RepeatedPtrField< ::std::string>& names() const;
+  inline ::google::protobuf::RepeatedPtrField< ::std::string>* mutable_names();
+  
+  // repeated .codec.item items = 3;
+  inline int items_size() const;
+  inline void clear_items();
+  static const int kItemsFieldNumber = 3;
+  inline const ::codec::item& items(int index) const;
+  inline ::codec::item* mutable_items(int index);
+  inline ::codec::item* add_items();
+  inline const ::google::protobuf::RepeatedPtrField< ::codec::item >&
+      items() const;
+  inline ::google::protobuf::RepeatedPtrField< ::codec::item >*
+      mutable_items();
+  
+  // repeated double weights = 4 [packed = true];
+  inline int weights_size() const;
+  inline void clear_weights();
+  static const int kWeightsFieldNumber = 4;
+  inline double weights(int index) const;
+  inline void set_weights(int index, double value);
+  inline void add_weights(double value);
+  inline const ::google::protobuf::RepeatedField< double >&
+      weights() const;
+  inline ::google::protobuf::RepeatedField< double >*
+      mutable_weights();
+  
+  // @@protoc_insertion_point(class_scope:codec.wide)
+ private:
+  
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+  
+  ::google::protobuf::RepeatedField< ::google::protobuf::int64 > ids_;
+  mutable int _ids_cached_byte_size_;
+  ::google::protobuf::RepeatedPtrField< ::std::string> names_;
+  ::google::protobuf::RepeatedPtrField< ::codec::item > items_;
+  ::google::protobuf::RepeatedField< double > weights_;
+  mutable int _weights_cached_byte_size_;
+  
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(4 + 31) / 32];
+  
+  friend void  protobuf_AddDesc_codec_2eproto();
+  friend void protobuf_AssignDesc_codec_2eproto();
+  friend void protobuf_ShutdownFile_codec_2eproto();
+  
+  void InitAsDefaultInstance();
+  static wide* default_instance_;
+};
+// -------------------------------------------------------------------
+
+class blob : public ::google::protobuf::Message {
+ public:
+  blob();
+  virtual ~blob();
+  
+  blob(const blob& from);
+  
+  inline blob& operator=(const blob& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+  
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+  
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const blob& default_instance();
+  
+  void Swap(blob* other);
+  
+  // implements Message ----------------------------------------------
+  
+  blob* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const blob& from);
+  void MergeFrom(const blob& from);
+  void Clear();
+  bool IsInitialized() const;
+  
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+  
+  ::google::protobuf::Metadata GetMetadata() const;
+  
+  // nested types ----------------------------------------------------
+  
+  // accessors -------------------------------------------------------
+  
+  // required string name = 1;
+  inline bool has_name() const;
+  inline void clear_name();
+  static const int kNameFieldNumber = 1;
+  inline const ::std::string& name() const;
+  inline void set_name(const ::std::string& value);
+  inline void set_name(const char* value);
+  inline void set_name(const char* value, size_t size);
+  inline ::std::string* mutable_name();
+  inline ::std::string* release_name();
+  
+  // required bytes payload = 2;
+  inline bool has_payload() const;
+  inline void clear_payload();
+  static const int kPayloadFieldNumber = 2;
+  inline const ::std::string& payload() const;
+  inline void set_payload(const ::std::string& value);
+  inline void set_payload(const char* value);
+  inline void set_payload(const void* value, size_t size);
+  inline ::std::string* mutable_payload();
+  inline ::std::string* release_payload();
+  
+  // @@protoc_insertion_point(class_scope:codec.blob)
+ private:
+  inline void set_has_name();
+  inline void clear_has_name();
+  inline void set_has_payload();
+  inline void clear_has_payload();
+  
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+  
+  ::std::string* name_;
+  ::std::string* payload_;
+  
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(2 + 31) / 32];
+  
+  friend void  protobuf_AddDesc_codec_2eproto();
+  friend void protobuf_AssignDesc_codec_2eproto();
+  friend void protobuf_ShutdownFile_codec_2eproto();
+  
+  void InitAsDefaultInstance();
+  static blob* default_instance_;
+};
+// ===================================================================
+
+
+// ===================================================================
+
+// item
+
+// required int64 id = 1;
+inline bool item::has_id() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void item::set_has_id() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void item::clear_has_id() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void item::clear_id() {
+  id_ = GOOGLE_LONGLONG(0);
+  clear_has_id();
+}
+inline ::google::protobuf::int64 item::id() const {
+  return id_;
+}
+inline void item::set_id(::google::protobuf::int64 value) {
+  set_has_id();
+  id_ = value;
+}
+
+// required string name = 2;
+inline bool item::has_name() const {
+  return (_has_bits_[0] & 0x00000002u) != 0;
+}
+inline void item::set_has_name() {
+  _has_bits_[0] |= 0x00000002u;
+}
+inline void item::clear_has_name() {
+  _has_bits_[0] &= ~0x00000002u;
+}
+inline void item::clear_name() {
+  if (name_ != &::google::protobuf::internal::kEmptyString) {
+    name_->clear();
+  }
+  clear_has_name();
+}
+inline const ::std::string& item::name() const {
+  return *name_;
+}
+inline void item::set_name(const ::std::string& value) {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  name_->assign(value);
+}
+inline void item::set_name(const char* value) {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  name_->assign(value);
+}
+inline void item::set_name(const char* value, size_t size) {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  name_->assign(reinterpret_cast<const char*>(value), size);
+}
+inline ::std::string* item::mutable_name() {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  return name_;
+}
+inline ::std::string* item::release_name() {
+  clear_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    return NULL;
+  } else {
+    ::std::string* temp = name_;
+    name_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+    return temp;
+  }
+}
+
+// optional double weight = 3;
+inline bool item::has_weight() const {
+  return (_has_bits_[0] & 0x00000004u) != 0;
+}
+inline void item::set_has_weight() {
+  _has_bits_[0] |= 0x00000004u;
+}
+inline void item::clear_has_weight() {
+  _has_bits_[0] &= ~0x00000004u;
+}
+inline void item::clear_weight() {
+  weight_ = 0;
+  clear_has_weight();
+}
+inline double item::weight() const {
+  return weight_;
+}
+inline void item::set_weight(double value) {
+  set_has_weight();
+  weight_ = value;
+}
+
+// -------------------------------------------------------------------
+
+// wide
+
+// repeated int64 ids = 1 [packed = true];
+inline int wide::ids_size() const {
+  return ids_.size();
+}
+inline void wide::clear_ids() {
+  ids_.Clear();
+}
+inline ::google::protobuf::int64 wide::ids(int index) const {
+  return ids_.Get(index);
+}
+inline void wide::set_ids(int index, ::google::protobuf::int64 value) {
+  ids_.Set(index, value);
+}
+inline void wide::add_ids(::google::protobuf::int64 value) {
+  ids_.Add(value);
+}
+inline const ::google::protobuf::RepeatedField< ::google::protobuf::int64 >&
+wide::ids() const {
+  return ids_;
+}
+inline ::google::protobuf::RepeatedField< ::google::protobuf::int64 >*
+wide::mutable_ids() {
+  return &ids_;
+}
+
+// repeated string names = 2;
+inline int wide::names_size() const {
+  return names_.size();
+}
+inline void wide::clear_names() {
+  names_.Clear();
+}
+inline const ::std::string& wide::names(int index) const {
+  return names_.Get(index);
+}
+inline ::std::string* wide::mutable_names(int index) {
+  return names_.Mutable(index);
+}
+inline void wide::set_names(int index, const ::std::string& value) {
+  names_.Mutable(index)->assign(value);
+}
+inline void wide::set_names(int index, const char* value) {
+  names_.Mutable(index)->assign(value);
+}
+inline void wide::set_names(int index, const char* value, size_t size) {
+  names_.Mutable(index)->assign(
+    reinterpret_cast<const char*>(value), size);
+}
+inline ::std::string* wide::add_names() {
+  return names_.Add();
+}
+inline void wide::add_names(const ::std::string& value) {
+  names_.Add()->assign(value);
+}
+inline void wide::add_names(const char* value) {
+  names_.Add()->assign(value);
+}
+inline void wide::add_names(const char* value, size_t size) {
+  names_.Add()->assign(reinterpret_cast<const char*>(value), size);
+}
+inline const ::google::protobuf::RepeatedPtrField< ::std::string>&
+wide::names() const {
+  return names_;
+}
+inline ::google::protobuf::RepeatedPtrField< ::std::string>*
+wide::mutable_names() {
+  return &names_;
+}
+
+// repeated .codec.item items = 3;
+inline int wide::items_size() const {
+  return items_.size();
+}
+inline void wide::clear_items() {
+  items_.Clear();
+}
+inline const ::codec::item& wide::items(int index) const {
+  return items_.Get(index);
+}
+inline ::codec::item* wide::mutable_items(int index) {
+  return items_.Mutable(index);
+}
+inline ::codec::item* wide::add_items() {
+  return items_.Add();
+}
+inline const ::google::protobuf::RepeatedPtrField< ::codec::item >&
+wide::items() const {
+  return items_;
+}
+inline ::google::protobuf::RepeatedPtrField< ::codec::item >*
+wide::mutable_items() {
+  return &items_;
+}
+
+// repeated double weights = 4 [packed = true];
+inline int wide::weights_size() const {
+  return weights_.size();
+}
+inline void wide::clear_weights() {
+  weights_.Clear();
+}
+inline double wide::weights(int index) const {
+  return weights_.Get(index);
+}
+inline void wide::set_weights(int index, double value) {
+  weights_.Set(index, value);
+}
+inline void wide::add_weights(double value) {
+  weights_.Add(value);
+}
+inline const ::google::protobuf::RepeatedField< double >&
+wide::weights() const {
+  return weights_;
+}
+inline ::google::protobuf::RepeatedField< double >*
+wide::mutable_weights() {
+  return &weights_;
+}
+
+// -------------------------------------------------------------------
+
+// blob
+
+// required string name = 1;
+inline bool blob::has_name() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void blob::set_has_name() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void blob::clear_has_name() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void blob::clear_name() {
+  if (name_ != &::google::protobuf::internal::kEmptyString) {
+    name_->clear();
+  }
+  clear_has_name();
+}
+inline const ::std::string& blob::name() const {
+  return *name_;
+}
+inline void blob::set_name(const ::std::string& value) {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  name_->assign(value);
+}
+inline void blob::set_name(const char* value) {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  name_->assign(value);
+}
+inline void blob::set_name(const char* value, size_t size) {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  name_->assign(reinterpret_cast<const char*>(value), size);
+}
+inline ::std::string* blob::mutable_name() {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  return name_;
+}
+inline ::std::string* blob::release_name() {
+  clear_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    return NULL;
+  } else {
+    ::std::string* temp = name_;
+    name_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+    return temp;
+  }
+}
+
+// required bytes payload = 2;
+inline bool blob::has_payload() const {
+  return (_has_bits_[0] & 0x00000002u) != 0;
+}
+inline void blob::set_has_payload() {
+  _has_bits_[0] |= 0x00000002u;
+}
+inline void blob::clear_has_payload() {
+  _has_bits_[0] &= ~0x00000002u;
+}
+inline void blob::clear_payload() {
+  if (payload_ != &::google::protobuf::internal::kEmptyString) {
+    payload_->clear();
+  }
+  clear_has_payload();
+}
+inline const ::std::string& blob::payload() const {
+  return *payload_;
+}
+inline void blob::set_payload(const ::std::string& value) {
+  set_has_payload();
+  if (payload_ == &::google::protobuf::internal::kEmptyString) {
+    payload_ = new ::std::string;
+  }
+  payload_->assign(value);
+}
+inline void blob::set_payload(const char* value) {
+  set_has_payload();
+  if (payload_ == &::google::protobuf::internal::kEmptyString) {
+    payload_ = new ::std::string;
+  }
+  payload_->assign(value);
+}
+inline void blob::set_payload(const void* value, size_t size) {
+  set_has_payload();
+  if (payload_ == &::google::protobuf::internal::kEmptyString) {
+    payload_ = new ::std::string;
+  }
+  payload_->assign(reinterpret_cast<const char*>(value), size);
+}
+inline ::std::string* blob::mutable_payload() {
+  set_has_payload();
+  if (payload_ == &::google::protobuf::internal::kEmptyString) {
+    payload_ = new ::std::string;
+  }
+  return payload_;
+}
+inline ::std::string* blob::release_payload() {
+  clear_has_payload();
+  if (payload_ == &::google::protobuf::internal::kEmptyString) {
+    return NULL;
+  } else {
+    ::std::string* temp = payload_;
+    payload_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+    return temp;
+  }
+}
+
+
+// @@protoc_insertion_point(namespace_scope)
+
+}  // namespace codec
+
+#ifndef SWIG
+namespace google {
+namespace protobuf {
+
+
+}  // namespace google
+}  // namespace protobuf
+#endif  // SWIG
+
+// @@protoc_insertion_point(global_scope)
+
+#endif  // PROTOBUF_codec_2eproto__INCLUDED
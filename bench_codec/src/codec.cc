@@ -0,0 +1,738 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+// Boost C++ Libraries
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+// Berkeley DB
+#include <db.h>
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+#include <log4cplus/configurator.h>
+
+// Namespaces in use.
+using namespace std;
+using google::protobuf::Message;
+
+// Data schema.
+#include <codec.pb.h>
+#include <month.pb.h>
+#include <month.bdb.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Counting of allocations.
+//--------------------------------------------------------------------------------------------------
+
+// Number of blocks, allocated by "new" (the benchmark is single-threaded).
+static uint64_t allocations = 0;
+
+void * operator new (size_t size) throw (std::bad_alloc)
+{
+    allocations++;
+
+    void * ptr = malloc(size == 0 ? 1 : size);
+    if (ptr == NULL) throw std::bad_alloc();
+
+    return ptr;
+}
+
+void * operator new[] (size_t size) throw (std::bad_alloc)
+{
+    return operator new(size);
+}
+
+void operator delete (void * ptr) throw ()
+{
+    free(ptr);
+}
+
+void operator delete[] (void * ptr) throw ()
+{
+    free(ptr);
+}
+
+// Counts serialized "DBT" object, if it's allocated by "malloc" (which is not seen by "new").
+static inline void count_dbt (const DBT * dbt)
+{
+    if (dbt->flags & DB_DBT_APPMALLOC) allocations++;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Samples.
+//--------------------------------------------------------------------------------------------------
+
+// Number of elements of each repeated field of "wide" sample.
+#define WIDE_ELEMENTS   256
+
+// Size of payload of "blob" sample.
+#define BLOB_SIZE       (64 * 1024)
+
+// Sample of one message shape.
+struct sample
+{
+    const char *    name;       // Name of the shape.
+    Message *       msg;        // Filled message.
+    Message *       target;     // Message, reused by parsing.
+    int             field;      // Number of field, extracted straight from serialized data.
+    string          wire;       // Serialized message.
+    DBT             dbt;        // Serialized message, referencing "wire".
+    vector <char>   buffer;     // Caller-supplied buffer, which fits the message.
+    bdb::arena      pool;       // Arena of parsed messages.
+};
+
+// Sample of keys, compared by comparison functions.
+struct key_sample
+{
+    month::key  key1;           // The first key.
+    month::key  key2;           // The second key.
+    string      wire1;          // Serialized first key.
+    string      wire2;          // Serialized second key.
+    string      ordered1;       // The first key in order-preserving format.
+    string      ordered2;       // The second key in order-preserving format.
+    DBT         dbt1;           // References "wire1".
+    DBT         dbt2;           // References "wire2".
+    DBT         odbt1;          // References "ordered1".
+    DBT         odbt2;          // References "ordered2".
+};
+
+// Result of operations, which is never used, but isn't optimized away.
+static volatile int sink = 0;
+
+// Makes "DBT" object reference specified string.
+static void set_dbt (DBT * dbt, const string & str)
+{
+    memset(dbt, 0, sizeof(DBT));
+
+    dbt->data = (void *) str.data();
+    dbt->size = (u_int32_t) str.size();
+}
+
+// Fills sample of specified message.
+static void make_sample (sample * s, const char * name, Message * msg, int field)
+{
+    s->name   = name;
+    s->msg    = msg;
+    s->target = msg->New();
+    s->field  = field;
+
+    msg->SerializeToString(&s->wire);
+    set_dbt(&s->dbt, s->wire);
+
+    s->buffer.resize(s->wire.size());
+}
+
+// Creates samples of all shapes.
+static void make_samples (vector <sample *> * samples, key_sample * keys)
+{
+    month::data * mdata = new month::data;
+
+    mdata->set_season("Winter");
+    mdata->set_days(31);
+    mdata->set_ordnum(1);
+
+    codec::wide * wide = new codec::wide;
+
+    for (int i = 0; i < WIDE_ELEMENTS; i++)
+    {
+        stringstream name;
+        name << "element #" << i;
+
+        wide->add_ids((int64_t) i * 1000003);
+        wide->add_names(name.str());
+        wide->add_weights(i / 3.0);
+
+        codec::item * item = wide->add_items();
+
+        item->set_id(i);
+        item->set_name(name.str());
+        item->set_weight(i / 7.0);
+    }
+
+    codec::blob * blob = new codec::blob;
+
+    blob->set_name("payload");
+    blob->mutable_payload()->resize(BLOB_SIZE);
+
+    for (int i = 0; i < BLOB_SIZE; i++)
+    {
+        (*blob->mutable_payload())[i] = (char) (i * 31);
+    }
+
+    const int count = 3;
+    samples->resize(count);
+
+    for (int i = 0; i < count; i++)
+    {
+        (*samples)[i] = new sample;
+    }
+
+    make_sample((*samples)[0], "month", mdata, month::data::kSeasonFieldNumber);
+    make_sample((*samples)[1], "wide",  wide,  codec::wide::kNamesFieldNumber);
+    make_sample((*samples)[2], "blob",  blob,  codec::blob::kPayloadFieldNumber);
+
+    keys->key1.set_month("January");
+    keys->key2.set_month("February");
+
+    keys->key1.SerializeToString(&keys->wire1);
+    keys->key2.SerializeToString(&keys->wire2);
+
+    set_dbt(&keys->dbt1, keys->wire1);
+    set_dbt(&keys->dbt2, keys->wire2);
+
+    DBT dbt;
+
+    bdb::serialize_key(&keys->key1, &dbt);
+    keys->ordered1.assign((const char *) dbt.data, dbt.size);
+    bdb::release(&dbt);
+
+    bdb::serialize_key(&keys->key2, &dbt);
+    keys->ordered2.assign((const char *) dbt.data, dbt.size);
+    bdb::release(&dbt);
+
+    set_dbt(&keys->odbt1, keys->ordered1);
+    set_dbt(&keys->odbt2, keys->ordered2);
+}
+
+// Deletes samples of all shapes.
+static void free_samples (vector <sample *> * samples)
+{
+    for (size_t i = 0; i < samples->size(); i++)
+    {
+        delete (*samples)[i]->msg;
+        delete (*samples)[i]->target;
+        delete (*samples)[i];
+    }
+
+    samples->clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Benchmarked operations of messages.
+//  Each operation returns number of serialized bytes it has processed.
+//--------------------------------------------------------------------------------------------------
+
+// Serializes message into memory, allocated by "bdb::serialize".
+static size_t op_serialize (sample * s)
+{
+    DBT dbt;
+
+    bdb::serialize(s->msg, &dbt);
+    count_dbt(&dbt);
+
+    size_t bytes = dbt.size;
+    bdb::release(&dbt);
+
+    return bytes;
+}
+
+// Serializes message into caller-supplied buffer.
+static size_t op_serialize_buffer (sample * s)
+{
+    DBT dbt;
+
+    bdb::serialize(s->msg, &dbt, &s->buffer[0], s->buffer.size());
+    count_dbt(&dbt);
+
+    size_t bytes = dbt.size;
+    bdb::release(&dbt);
+
+    return bytes;
+}
+
+// Parses message into reused message.
+static size_t op_unserialize (sample * s)
+{
+    bdb::unserialize(&s->dbt, s->target);
+    return s->dbt.size;
+}
+
+// Parses message into new message, which is deleted then.
+static size_t op_unserialize_new (sample * s)
+{
+    Message * msg = s->msg->New();
+
+    bdb::unserialize(&s->dbt, msg);
+    delete msg;
+
+    return s->dbt.size;
+}
+
+// Parses message into message of arena, which is recycled then.
+static size_t op_unserialize_arena (sample * s)
+{
+    bdb::unserialize(&s->dbt, s->msg, &s->pool);
+    s->pool.reset();
+
+    return s->dbt.size;
+}
+
+// Extracts one field straight from serialized message, no message is parsed.
+static size_t op_extract_field (sample * s)
+{
+    bdb::field_value value;
+
+    sink += bdb::extract_field(&s->dbt, s->field, &value);
+    return s->dbt.size;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Benchmarked operations of keys.
+//--------------------------------------------------------------------------------------------------
+
+// Comparison of parsed month keys.
+int compare_months (const month::key & key1, const month::key & key2)
+{
+    return key1.month().compare(key2.month());
+}
+
+// Keys comparison function, which parses both keys (like the ones of the test).
+static int month_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    month::key key1, key2;
+
+    bdb::unserialize(dbt1, &key1);
+    bdb::unserialize(dbt2, &key2);
+
+    return key1.month().compare(key2.month());
+}
+
+// Keys comparison function of Berkeley DB for keys in order-preserving format (plain comparison of bytes).
+static int ordered_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    size_t size = (dbt1->size < dbt2->size ? dbt1->size : dbt2->size);
+    int res = memcmp(dbt1->data, dbt2->data, size);
+
+    return (res != 0 ? res : (int) dbt1->size - (int) dbt2->size);
+}
+
+// Compares keys by parsing both of them.
+static size_t op_compare_parse (key_sample * k)
+{
+    sink += month_compare(NULL, &k->dbt1, &k->dbt2);
+    return k->dbt1.size + k->dbt2.size;
+}
+
+// Compares keys by parsing the application key once per operation (see "bdb::compare_state").
+static size_t op_compare_state (key_sample * k)
+{
+    sink += bdb::message_compare <month::key, compare_months> (NULL, &k->dbt1, &k->dbt2);
+    return k->dbt1.size + k->dbt2.size;
+}
+
+// Compares keys by their field, decoded from serialized data (generated by "protoc --bdb_out").
+static size_t op_compare_field (key_sample * k)
+{
+    sink += month::key_month_compare(NULL, &k->dbt1, &k->dbt2);
+    return k->dbt1.size + k->dbt2.size;
+}
+
+// Compares keys of the only field by their first bytes.
+static size_t op_compare_single (key_sample * k)
+{
+    sink += bdb::string_key_compare(NULL, &k->dbt1, &k->dbt2);
+    return k->dbt1.size + k->dbt2.size;
+}
+
+// Compares keys in order-preserving format.
+static size_t op_compare_ordered (key_sample * k)
+{
+    sink += ordered_compare(NULL, &k->odbt1, &k->odbt2);
+    return k->odbt1.size + k->odbt2.size;
+}
+
+// Serializes key in order-preserving format.
+static size_t op_serialize_key (key_sample * k)
+{
+    DBT dbt;
+
+    bdb::serialize_key(&k->key1, &dbt);
+    count_dbt(&dbt);
+
+    size_t bytes = dbt.size;
+    bdb::release(&dbt);
+
+    return bytes;
+}
+
+// Parses key in order-preserving format.
+static size_t op_unserialize_key (key_sample * k)
+{
+    month::key key;
+
+    bdb::unserialize_key(&k->odbt1, &key);
+    return k->odbt1.size;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Definitions.
+//--------------------------------------------------------------------------------------------------
+
+// Benchmarked operation of message sample.
+typedef size_t (*message_op) (sample * s);
+
+// Benchmarked operation of key sample.
+typedef size_t (*key_op) (key_sample * k);
+
+// Operations of messages.
+static const struct { const char * name; message_op fn; } message_ops[] =
+{
+    { "serialize",          op_serialize         },
+    { "serialize_buffer",   op_serialize_buffer  },
+    { "unserialize",        op_unserialize       },
+    { "unserialize_new",    op_unserialize_new   },
+    { "unserialize_arena",  op_unserialize_arena },
+    { "extract_field",      op_extract_field     }
+};
+
+// Operations of keys.
+static const struct { const char * name; key_op fn; } key_ops[] =
+{
+    { "compare_parse",      op_compare_parse     },
+    { "compare_state",      op_compare_state     },
+    { "compare_field",      op_compare_field     },
+    { "compare_single",     op_compare_single    },
+    { "compare_ordered",    op_compare_ordered   },
+    { "serialize_key",      op_serialize_key     },
+    { "unserialize_key",    op_unserialize_key   }
+};
+
+#define MESSAGE_OPS (sizeof(message_ops) / sizeof(message_ops[0]))
+#define KEY_OPS     (sizeof(key_ops)     / sizeof(key_ops[0]))
+
+//--------------------------------------------------------------------------------------------------
+//  Settings.
+//--------------------------------------------------------------------------------------------------
+
+// Benchmark settings.
+struct settings
+{
+    int             iterations;     // Number of measured iterations of each operation.
+    bool            json;           // Whether to output results in JSON (otherwise CSV).
+    vector <string> ops;            // Operations to measure (all, if empty).
+    vector <string> shapes;         // Shapes of messages to measure (all, if empty).
+};
+
+// Splits comma-separated list.
+static vector <string> split (const string & list)
+{
+    vector <string> items;
+    stringstream    ss(list);
+    string          item;
+
+    while (getline(ss, item, ','))
+    {
+        if (!item.empty()) items.push_back(item);
+    }
+
+    return items;
+}
+
+// Checks whether the name is in the list (empty list contains all names).
+static bool selected (const vector <string> & list, const string & name)
+{
+    if (list.empty()) return true;
+
+    for (size_t i = 0; i < list.size(); i++)
+    {
+        if (list[i] == name) return true;
+    }
+
+    return false;
+}
+
+// Prints usage.
+static void usage ()
+{
+    cerr << "Usage: bench_codec [options]\n"
+         << "\n"
+         << "  --iterations=N           number of measured iterations of each operation (100000)\n"
+         << "  --ops=OP[,OP...]         operations: serialize, serialize_buffer, unserialize, unserialize_new,\n"
+         << "                           unserialize_arena, extract_field, compare_parse, compare_state,\n"
+         << "                           compare_field, compare_single, compare_ordered, serialize_key,\n"
+         << "                           unserialize_key (all)\n"
+         << "  --shapes=S[,S...]        shapes of messages: month, wide, blob, key (all)\n"
+         << "  --format=F               output format: csv, json (csv)\n"
+         << "\n"
+         << "Operations of keys are measured on \"key\" shape (\"month::key\") only, operations of messages\n"
+         << "on the others. Each operation is warmed up, and then timed in isolation, with no database.\n";
+}
+
+// Checks whether the name is a known operation.
+static bool known_op (const string & name)
+{
+    for (size_t i = 0; i < MESSAGE_OPS; i++)
+    {
+        if (name == message_ops[i].name) return true;
+    }
+
+    for (size_t i = 0; i < KEY_OPS; i++)
+    {
+        if (name == key_ops[i].name) return true;
+    }
+
+    return false;
+}
+
+// Parses command line.
+static bool parse_settings (int argc, char ** argv, settings * s)
+{
+    s->iterations = 100000;
+    s->json       = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        size_t pos = arg.find('=');
+
+        if (arg.compare(0, 2, "--") != 0 || pos == string::npos)
+        {
+            return false;
+        }
+
+        string name  = arg.substr(2, pos - 2);
+        string value = arg.substr(pos + 1);
+
+        bool res = true;
+
+        if (name == "iterations")
+        {
+            s->iterations = atoi(value.c_str());
+            res = (s->iterations > 0);
+        }
+        else if (name == "ops")
+        {
+            s->ops = split(value);
+            res = !s->ops.empty();
+
+            for (size_t j = 0; j < s->ops.size() && res; j++)
+            {
+                res = known_op(s->ops[j]);
+            }
+        }
+        else if (name == "shapes")
+        {
+            s->shapes = split(value);
+            res = !s->shapes.empty();
+
+            for (size_t j = 0; j < s->shapes.size() && res; j++)
+            {
+                const string & shape = s->shapes[j];
+                res = (shape == "month" || shape == "wide" || shape == "blob" || shape == "key");
+            }
+        }
+        else if (name == "format")
+        {
+            s->json = (value == "json");
+            res = (value == "json" || value == "csv");
+        }
+        else
+        {
+            res = false;
+        }
+
+        if (!res)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Results.
+//--------------------------------------------------------------------------------------------------
+
+// Result of measurement of one operation.
+struct measure
+{
+    const char *    op;             // Name of operation.
+    const char *    shape;          // Name of shape.
+    int             iterations;     // Number of measured iterations.
+    double          ns;             // Nanoseconds per operation.
+    double          bytes;          // Serialized bytes per operation.
+    double          allocs;         // Allocations per operation.
+};
+
+// Prints header of results.
+static void print_header (const settings & s)
+{
+    if (s.json)
+    {
+        cout << "[";
+    }
+    else
+    {
+        cout << "operation,shape,iterations,ns_per_op,bytes_per_op,allocs_per_op\n";
+    }
+}
+
+// Prints one result.
+static void print_measure (const settings & s, const measure & m, bool first)
+{
+    if (s.json)
+    {
+        cout << (first ? "\n" : ",\n")
+             << "  {\"operation\": \""    << m.op     << "\""
+             <<  ", \"shape\": \""        << m.shape  << "\""
+             <<  ", \"iterations\": "     << m.iterations
+             <<  ", \"ns_per_op\": "      << m.ns
+             <<  ", \"bytes_per_op\": "   << m.bytes
+             <<  ", \"allocs_per_op\": "  << m.allocs
+             << "}";
+    }
+    else
+    {
+        cout << m.op         << ","
+             << m.shape      << ","
+             << m.iterations << ","
+             << m.ns         << ","
+             << m.bytes      << ","
+             << m.allocs     << "\n";
+    }
+
+    cout.flush();
+}
+
+// Prints footer of results.
+static void print_footer (const settings & s)
+{
+    if (s.json)
+    {
+        cout << "\n]\n";
+    }
+
+    cout.flush();
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Benchmark.
+//--------------------------------------------------------------------------------------------------
+
+// Current time.
+static inline boost::posix_time::ptime now ()
+{
+    return boost::posix_time::microsec_clock::universal_time();
+}
+
+// Measures specified operation on specified sample ("S" is a sample, "F" is an operation of the sample).
+template <class S, class F>
+static measure benchmark (const char * op, const char * shape, F fn, S * s, int iterations)
+{
+    // warm up caches, free lists of arenas, and states of comparison functions
+    for (int i = 0; i < iterations / 10 + 1; i++)
+    {
+        fn(s);
+    }
+
+    uint64_t allocs = allocations;
+    uint64_t bytes  = 0;
+
+    boost::posix_time::ptime start = now();
+
+    for (int i = 0; i < iterations; i++)
+    {
+        bytes += fn(s);
+    }
+
+    double ns = (double) (now() - start).total_microseconds() * 1000.0;
+
+    measure m;
+
+    m.op         = op;
+    m.shape      = shape;
+    m.iterations = iterations;
+    m.ns         = ns / iterations;
+    m.bytes      = (double) bytes / iterations;
+    m.allocs     = (double) (allocations - allocs) / iterations;
+
+    return m;
+}
+
+int main (int argc, char ** argv)
+{
+    log4cplus::BasicConfigurator::doConfigure();
+    log4cplus::Logger::getInstance(BDB_LOGGER_PORT).setLogLevel(log4cplus::OFF_LOG_LEVEL);
+
+    settings s;
+
+    if (!parse_settings(argc, argv, &s))
+    {
+        usage();
+        return -1;
+    }
+
+    vector <sample *> samples;
+    key_sample        keys;
+
+    make_samples(&samples, &keys);
+
+    bool first = true;
+
+    print_header(s);
+
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        if (!selected(s.shapes, samples[i]->name)) continue;
+
+        for (size_t j = 0; j < MESSAGE_OPS; j++)
+        {
+            if (!selected(s.ops, message_ops[j].name)) continue;
+
+            measure m = benchmark(message_ops[j].name, samples[i]->name, message_ops[j].fn, samples[i], s.iterations);
+
+            print_measure(s, m, first);
+            first = false;
+        }
+    }
+
+    if (selected(s.shapes, "key"))
+    {
+        for (size_t j = 0; j < KEY_OPS; j++)
+        {
+            if (!selected(s.ops, key_ops[j].name)) continue;
+
+            measure m = benchmark(key_ops[j].name, "key", key_ops[j].fn, &keys, s.iterations);
+
+            print_measure(s, m, first);
+            first = false;
+        }
+    }
+
+    print_footer(s);
+
+    free_samples(&samples);
+
+    return 0;
+}
@@ -0,0 +1,530 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+// Standard C/C++ Libraries
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Namespaces in use.
+using namespace std;
+
+//--------------------------------------------------------------------------------------------------
+//  Definitions.
+//--------------------------------------------------------------------------------------------------
+
+// Compared metrics, and whether their higher values are better.
+static const struct { const char * name; bool higher; } metrics[] =
+{
+    { "ops_per_sec",    true  },    // "bench"
+    { "ns_per_op",      false },    // "bench_codec"
+    { "allocs_per_op",  false }     // "bench_codec"
+};
+
+// Fields, which identify a measurement (all its other fields are ignored).
+static const char * identity_fields[] =
+{
+    "operation", "shape", "threads", "size", "distribution", "durability"
+};
+
+#define METRICS         (sizeof(metrics)         / sizeof(metrics[0]))
+#define IDENTITY_FIELDS (sizeof(identity_fields) / sizeof(identity_fields[0]))
+
+// Fields of one measurement (values of strings are unquoted, numbers are kept as text).
+typedef map <string, string> record;
+
+// Samples of metrics of measurements by their identities and names of metrics.
+typedef map <string, map <string, vector <double> > > samples;
+
+//--------------------------------------------------------------------------------------------------
+//  Settings.
+//--------------------------------------------------------------------------------------------------
+
+// Comparison settings.
+struct settings
+{
+    string          baseline;   // File of baseline to compare with.
+    string          save;       // File to save results as new baseline.
+    double          alpha;      // Significance level of the test.
+    double          threshold;  // Minimal change of median to be reported, in percents.
+    vector <string> results;    // Files of results of benchmarks.
+};
+
+// Prints usage.
+static void usage ()
+{
+    cerr << "Usage: bench_compare [options] RESULT...\n"
+         << "\n"
+         << "  --baseline=FILE          baseline to compare results with\n"
+         << "  --save=FILE              save results as new baseline\n"
+         << "  --alpha=P                significance level of the test (0.05)\n"
+         << "  --threshold=PCT          minimal change of median, which counts, in percents (5)\n"
+         << "\n"
+         << "Results are JSON outputs of \"bench\" and \"bench_codec\" (\"--format=json\"), usually of several\n"
+         << "runs of the same suite. Samples of each measurement are compared with ones of the baseline by\n"
+         << "one-sided Mann-Whitney U test, and a measurement regresses, if it's significantly worse and its\n"
+         << "median is worse by more than the threshold. Exit code is \"1\" if any measurement regresses.\n";
+}
+
+// Parses command line.
+static bool parse_settings (int argc, char ** argv, settings * s)
+{
+    s->alpha     = 0.05;
+    s->threshold = 5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        size_t pos = arg.find('=');
+
+        if (arg.compare(0, 2, "--") != 0)
+        {
+            s->results.push_back(arg);
+            continue;
+        }
+
+        if (pos == string::npos)
+        {
+            return false;
+        }
+
+        string name  = arg.substr(2, pos - 2);
+        string value = arg.substr(pos + 1);
+
+        bool res = true;
+
+        if (name == "baseline")
+        {
+            s->baseline = value;
+        }
+        else if (name == "save")
+        {
+            s->save = value;
+        }
+        else if (name == "alpha")
+        {
+            s->alpha = atof(value.c_str());
+            res = (s->alpha > 0 && s->alpha < 1);
+        }
+        else if (name == "threshold")
+        {
+            s->threshold = atof(value.c_str());
+            res = (s->threshold >= 0);
+        }
+        else
+        {
+            res = false;
+        }
+
+        if (!res)
+        {
+            return false;
+        }
+    }
+
+    return (!s->results.empty() && (!s->baseline.empty() || !s->save.empty()));
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Reading of results.
+//--------------------------------------------------------------------------------------------------
+
+// Reader of JSON array of flat objects, as benchmarks output them.
+class json_reader
+{
+public:
+
+    json_reader (const string & text) : m_text(text), m_pos(0) { }
+
+    // Reads all objects of the array, returns "false" if the text is malformed.
+    bool read (vector <record> * records)
+    {
+        if (!skip('[')) return false;
+        if (peek(']')) return skip(']');
+
+        do
+        {
+            record r;
+
+            if (!read_object(&r)) return false;
+            records->push_back(r);
+        }
+        while (skip(','));
+
+        return skip(']');
+    }
+
+protected:
+
+    // Reads object of string and number values.
+    bool read_object (record * r)
+    {
+        if (!skip('{')) return false;
+        if (peek('}')) return skip('}');
+
+        do
+        {
+            string name, value;
+
+            if (!read_string(&name) || !skip(':')) return false;
+
+            if (peek('"'))
+            {
+                if (!read_string(&value)) return false;
+            }
+            else
+            {
+                while (m_pos < m_text.size() && m_text[m_pos] != ',' && m_text[m_pos] != '}' && !isspace((unsigned char) m_text[m_pos]))
+                {
+                    value += m_text[m_pos++];
+                }
+
+                if (value.empty()) return false;
+            }
+
+            (*r)[name] = value;
+        }
+        while (skip(','));
+
+        return skip('}');
+    }
+
+    // Reads quoted string (benchmarks don't escape anything but quotes and backslashes).
+    bool read_string (string * str)
+    {
+        if (!skip('"')) return false;
+
+        while (m_pos < m_text.size() && m_text[m_pos] != '"')
+        {
+            if (m_text[m_pos] == '\\') m_pos++;
+            if (m_pos < m_text.size()) *str += m_text[m_pos++];
+        }
+
+        return skip('"');
+    }
+
+    // Checks whether the next non-space character is the specified one.
+    bool peek (char c)
+    {
+        while (m_pos < m_text.size() && isspace((unsigned char) m_text[m_pos])) m_pos++;
+        return (m_pos < m_text.size() && m_text[m_pos] == c);
+    }
+
+    // Skips the next non-space character, if it's the specified one (returns "false" otherwise).
+    bool skip (char c)
+    {
+        if (!peek(c)) return false;
+
+        m_pos++;
+        return true;
+    }
+
+protected:
+
+    string         m_text;  // Text of JSON.
+    size_t         m_pos;   // Current position in the text.
+};
+
+// Returns identity of the measurement, e.g. "operation=select threads=1".
+static string identity (const record & r)
+{
+    string id;
+
+    for (size_t i = 0; i < IDENTITY_FIELDS; i++)
+    {
+        record::const_iterator f = r.find(identity_fields[i]);
+        if (f == r.end()) continue;
+
+        if (!id.empty()) id += " ";
+        id += f->first + "=" + f->second;
+    }
+
+    return id;
+}
+
+// Reads samples from specified file, returns "false" if the file can't be read.
+static bool read_samples (const string & path, samples * result)
+{
+    ifstream file(path.c_str());
+
+    if (!file)
+    {
+        cerr << "Cannot open \"" << path << "\".\n";
+        return false;
+    }
+
+    stringstream text;
+    text << file.rdbuf();
+
+    vector <record> records;
+    json_reader     reader(text.str());
+
+    if (!reader.read(&records))
+    {
+        cerr << "Malformed results in \"" << path << "\".\n";
+        return false;
+    }
+
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        string id = identity(records[i]);
+
+        for (size_t m = 0; m < METRICS; m++)
+        {
+            record::const_iterator f = records[i].find(metrics[m].name);
+            if (f != records[i].end()) (*result)[id][metrics[m].name].push_back(atof(f->second.c_str()));
+        }
+    }
+
+    return true;
+}
+
+// Saves samples as baseline (a JSON array of objects, one per sample, which "read_samples" reads back).
+static bool save_samples (const string & path, const samples & data)
+{
+    ofstream file(path.c_str());
+
+    if (!file)
+    {
+        cerr << "Cannot create \"" << path << "\".\n";
+        return false;
+    }
+
+    file.precision(10);
+    file << "[";
+
+    bool first = true;
+
+    for (samples::const_iterator i = data.begin(); i != data.end(); i++)
+    {
+        for (map <string, vector <double> >::const_iterator m = i->second.begin(); m != i->second.end(); m++)
+        {
+            for (size_t n = 0; n < m->second.size(); n++)
+            {
+                file << (first ? "\n" : ",\n") << "  {";
+                first = false;
+
+                // identity is "name=value" pairs, separated by spaces
+                stringstream ss(i->first);
+                string       pair;
+
+                while (ss >> pair)
+                {
+                    size_t pos = pair.find('=');
+                    file << "\"" << pair.substr(0, pos) << "\": \"" << pair.substr(pos + 1) << "\", ";
+                }
+
+                file << "\"" << m->first << "\": " << m->second[n] << "}";
+            }
+        }
+    }
+
+    file << "\n]\n";
+
+    return !file.fail();
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Statistics.
+//--------------------------------------------------------------------------------------------------
+
+// Returns median of the values.
+static double median (vector <double> values)
+{
+    if (values.empty()) return 0;
+
+    sort(values.begin(), values.end());
+
+    size_t n = values.size();
+    return (n % 2 == 1 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2);
+}
+
+// Returns standard normal distribution function (Abramowitz and Stegun, 26.2.17, error < 7.5e-8).
+static double normal_cdf (double z)
+{
+    double t = 1.0 / (1.0 + 0.2316419 * fabs(z));
+    double d = 0.3989422804014327 * exp(-z * z / 2);
+    double p = d * t * (0.319381530 + t * (-0.356563782 + t * (1.781477937 + t * (-1.821255978 + t * 1.330274429))));
+
+    return (z > 0 ? 1 - p : p);
+}
+
+/**
+ * Returns p-value of one-sided Mann-Whitney U test of hypothesis, that values of "a" tend to be less than
+ * values of "b" (normal approximation with correction for ties and continuity). The test uses only order
+ * of the values, so it's robust to outliers, which are common in timings.
+ */
+static double mann_whitney (const vector <double> & a, const vector <double> & b)
+{
+    vector <pair <double, int> > all;
+
+    for (size_t i = 0; i < a.size(); i++) all.push_back(make_pair(a[i], 0));
+    for (size_t i = 0; i < b.size(); i++) all.push_back(make_pair(b[i], 1));
+
+    sort(all.begin(), all.end());
+
+    double n1   = (double) a.size();
+    double n2   = (double) b.size();
+    double n    = n1 + n2;
+    double r1   = 0;
+    double ties = 0;
+
+    for (size_t i = 0; i < all.size(); )
+    {
+        size_t j = i;
+        while (j < all.size() && all[j].first == all[i].first) j++;
+
+        // tied values get the average of their ranks
+        double rank = (i + 1 + j) / 2.0;
+        double t    = (double) (j - i);
+
+        for (size_t k = i; k < j; k++)
+        {
+            if (all[k].second == 0) r1 += rank;
+        }
+
+        ties += t * t * t - t;
+        i = j;
+    }
+
+    double u    = r1 - n1 * (n1 + 1) / 2;
+    double mean = n1 * n2 / 2;
+    double var  = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)));
+
+    if (var <= 0) return 1;
+
+    return normal_cdf((u - mean + 0.5) / sqrt(var));
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Comparison.
+//--------------------------------------------------------------------------------------------------
+
+// Compares results with baseline, prints verdicts, and returns number of regressions.
+static int compare (const settings & s, const samples & baseline, const samples & current)
+{
+    int compared     = 0;
+    int regressions  = 0;
+    int improvements = 0;
+
+    cout.setf(ios::fixed);
+    cout.precision(3);
+
+    for (samples::const_iterator i = baseline.begin(); i != baseline.end(); i++)
+    {
+        samples::const_iterator c = current.find(i->first);
+
+        for (size_t m = 0; m < METRICS; m++)
+        {
+            map <string, vector <double> >::const_iterator bm = i->second.find(metrics[m].name);
+            if (bm == i->second.end()) continue;
+
+            if (c == current.end() || c->second.find(metrics[m].name) == c->second.end())
+            {
+                cout << "missing     " << i->first << " " << metrics[m].name << "\n";
+                continue;
+            }
+
+            const vector <double> & base = bm->second;
+            const vector <double> & cur  = c->second.find(metrics[m].name)->second;
+
+            double bmed   = median(base);
+            double cmed   = median(cur);
+            double change = (bmed != 0 ? 100.0 * (cmed - bmed) / fabs(bmed) : (cmed != 0 ? 100.0 : 0));
+
+            // "worse" is less for higher-better metrics, and greater for lower-better ones
+            double pworse  = (metrics[m].higher ? mann_whitney(cur, base) : mann_whitney(base, cur));
+            double pbetter = (metrics[m].higher ? mann_whitney(base, cur) : mann_whitney(cur, base));
+            double worse   = (metrics[m].higher ? -change : change);
+
+            const char * verdict = "ok         ";
+
+            if (pworse < s.alpha && worse > s.threshold)
+            {
+                verdict = "REGRESSION ";
+                regressions++;
+            }
+            else if (pbetter < s.alpha && -worse > s.threshold)
+            {
+                verdict = "improvement";
+                improvements++;
+            }
+
+            compared++;
+
+            cout << verdict << " " << i->first << " " << metrics[m].name << ": "
+                 << bmed << " -> " << cmed << " (" << (change >= 0 ? "+" : "") << change << "%, p = "
+                 << min(pworse, pbetter) << ")\n";
+        }
+    }
+
+    for (samples::const_iterator c = current.begin(); c != current.end(); c++)
+    {
+        if (baseline.find(c->first) == baseline.end()) cout << "new         " << c->first << "\n";
+    }
+
+    cout << "\n" << compared << " compared, " << regressions << " regressions, " << improvements << " improvements\n";
+
+    return regressions;
+}
+
+int main (int argc, char ** argv)
+{
+    settings s;
+
+    if (!parse_settings(argc, argv, &s))
+    {
+        usage();
+        return -1;
+    }
+
+    samples current;
+
+    for (size_t i = 0; i < s.results.size(); i++)
+    {
+        if (!read_samples(s.results[i], &current)) return -1;
+    }
+
+    if (!s.save.empty() && !save_samples(s.save, current))
+    {
+        return -1;
+    }
+
+    if (!s.baseline.empty())
+    {
+        samples baseline;
+
+        if (!read_samples(s.baseline, &baseline)) return -1;
+        if (compare(s, baseline, current) != 0) return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,43 @@
+#!/bin/bash
+#---------------------------------------------------------------------------------------------------
+#
+#  Performance regression gate: runs short fixed suite of "bench" and "bench_codec" several times,
+#  and compares the results with the baseline ("bench_compare" exits with "1" on regressions).
+#
+#  Usage: bench_compare/suite.sh [save]
+#
+#  "save" records the results as new baseline instead, which should be committed with the change,
+#  which is expected to shift the numbers. Baselines are valid only on the machine they are recorded on.
+#
+#  Environment: BIN      - directory of benchmark executables ("build/bin")
+#               BASELINE - file of baseline ("bench_compare/baseline.json")
+#               REPEAT   - number of runs of the suite ("5")
+#
+#---------------------------------------------------------------------------------------------------
+
+BIN=${BIN:-build/bin}
+BASELINE=${BASELINE:-bench_compare/baseline.json}
+REPEAT=${REPEAT:-5}
+
+WORK=$(mktemp -d) || exit 1
+trap 'rm -rf "$WORK"' EXIT
+
+for ((i = 1; i <= REPEAT; i++))
+do
+    "$BIN/bench" --home="$WORK/db$i" --records=5000 --threads=1,4 --size=100 --distribution=uniform \
+                 --durability=nosync --ops=insert,update,select,exists,scan,index_scan,join,mixed,remove \
+                 --format=json > "$WORK/bench$i.json"
+
+    "$BIN/bench_codec" --iterations=20000 --format=json > "$WORK/codec$i.json"
+
+    rm -rf "$WORK/db$i"
+done
+
+# incomplete results of a failed run are rejected by "bench_compare" as malformed
+
+if [ "$1" == "save" ]
+then
+    "$BIN/bench_compare" --save="$BASELINE" "$WORK"/*.json
+else
+    "$BIN/bench_compare" --baseline="$BASELINE" "$WORK"/*.json
+fi
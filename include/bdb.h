@@ -31,13 +31,20 @@
 #define BDB_H
 
 // Standard C/C++ Libraries
-#include <stack>
 #include <stdint.h>
+#include <cstddef>
+#include <cstring>
+#include <iosfwd>
+#include <iterator>
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 // Protocol Buffers
 #include <google/protobuf/message.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream.h>
 
 // C++ Logging Library
 #include <log4cplus/logger.h>
@@ -62,14 +69,194 @@
  */
 #define BDB_LOGGER_PORT     "bdb"
 
+/**
+ * Name of logging port of slow operations (see "bdb::database::set_slow_threshold").
+ */
+#define BDB_SLOW_LOGGER_PORT    "bdb.slow"
+
 /** @defgroup errcodes BDB exception codes. */
 //@{
 #define BDB_ERROR_UNKNOWN       1   /**< Unknown error.                */
 #define BDB_ERROR_NOT_FOUND     2   /**< Object is not found.          */
 #define BDB_ERROR_EXISTS        3   /**< Object already exists.        */
 #define BDB_ERROR_FOREIGN_KEY   4   /**< Foreign constraint violation. */
+#define BDB_ERROR_DEADLOCK      5   /**< Deadlock, or lock is not granted (the transaction can be retried). */
+//@}
+
+/** @defgroup txnflags Flags of transactions. */
+//@{
+#define BDB_TXN_DEFAULT     0   /**< Read committed data, and wait for locks.                               */
+#define BDB_TXN_NOWAIT      1   /**< Don't wait for locks (fail with BDB_ERROR_DEADLOCK if a lock is busy). */
+#define BDB_TXN_SNAPSHOT    2   /**< Read a snapshot of data (such tables should be multiversion).          */
+#define BDB_TXN_TOPLEVEL    4   /**< Begin top-level transaction, ignoring parent and current transactions. */
+//@}
+
+/** @defgroup deadlocks Policies of deadlock detector (which locker is rejected when a deadlock is found). */
+//@{
+#define BDB_DEADLOCK_DEFAULT    0   /**< Use Berkeley DB default policy.                        */
+#define BDB_DEADLOCK_NONE       1   /**< Don't run deadlock detector.                           */
+#define BDB_DEADLOCK_OLDEST     2   /**< Reject the oldest locker.                              */
+#define BDB_DEADLOCK_YOUNGEST   3   /**< Reject the youngest locker.                            */
+#define BDB_DEADLOCK_MINLOCKS   4   /**< Reject the locker with the minimum number of locks.    */
+#define BDB_DEADLOCK_MINWRITE   5   /**< Reject the locker with the minimum number of writes.   */
+#define BDB_DEADLOCK_MAXLOCKS   6   /**< Reject the locker with the maximum number of locks.    */
+#define BDB_DEADLOCK_RANDOM     7   /**< Reject a random locker.                                */
+//@}
+
+/** @defgroup replroles Roles of databases in replication groups. */
+//@{
+#define BDB_REPL_NONE       0   /**< The database is not replicated.                                    */
+#define BDB_REPL_MASTER     1   /**< Master site, which accepts writes.                                 */
+#define BDB_REPL_CLIENT     2   /**< Client site (read replica), which applies changes of the master.   */
+#define BDB_REPL_ELECTION   3   /**< Site, which elects the master together with other sites.           */
+//@}
+
+/** @defgroup recovery Recovery of the database on opening. */
+//@{
+#define BDB_RECOVERY_NONE       0   /**< Don't run recovery.                                                            */
+#define BDB_RECOVERY_NORMAL     1   /**< Run normal recovery ("DB_RECOVER").                                            */
+#define BDB_RECOVERY_FATAL      2   /**< Run catastrophic recovery from all available logs ("DB_RECOVER_FATAL").       */
+#define BDB_RECOVERY_AUTO       3   /**< Run normal recovery only if a process has failed uncleanly ("DB_REGISTER").    */
+#define BDB_RECOVERY_DETECT     4   /**< Fail to open, if a process has failed uncleanly ("DB_REGISTER" without recovery). */
+//@}
+
+/** @defgroup numapolicies Placement of shared regions of the environment on NUMA nodes. */
+//@{
+#define BDB_NUMA_DEFAULT      0   /**< Use system default placement (pages are taken from the node of the first thread, touching them). */
+#define BDB_NUMA_INTERLEAVE   1   /**< Pages of each region are interleaved over all nodes.                                    */
+#define BDB_NUMA_SPREAD       2   /**< Each region prefers a node of its own (round-robin), e.g. each of split cache regions.  */
+//@}
+
+/** @defgroup durability BDB transaction durability policies. */
+//@{
+#define BDB_DURABILITY_DEFAULT        0   /**< Use durability policy of the database.                   */
+#define BDB_DURABILITY_SYNC           1   /**< Write and synchronously flush the log on commit.         */
+#define BDB_DURABILITY_WRITE_NOSYNC   2   /**< Write the log on commit, but don't flush it.             */
+#define BDB_DURABILITY_NOSYNC         3   /**< Neither write nor flush the log on commit.               */
+#define BDB_DURABILITY_GROUP          4   /**< Flush the log once for a group of concurrent commits.    */
+//@}
+
+/** @defgroup keyformats Formats of table keys. */
+//@{
+#define BDB_KEY_PROTOBUF      0   /**< ProtoBuf wire format ("bdb::serialize"), needs keys comparison function.  */
+#define BDB_KEY_ORDERED       1   /**< Order-preserving format ("bdb::serialize_key"), sorted by Berkeley DB itself. */
+#define BDB_KEY_RECNO         2   /**< Record number ("bdb::serialize_recno"), used by recno and queue tables only. */
+#define BDB_KEY_RAW           3   /**< Raw bytes of single-field keys ("bdb::raw_key"), used by "bdb::typed_table" only. */
+#define BDB_KEY_RID           4   /**< Record id ("bdb::serialize_rid"), used by heap tables only.               */
+//@}
+
+/** @defgroup accessmethods Access methods of tables. */
+//@{
+#define BDB_ACCESS_BTREE      0   /**< Sorted balanced tree - all operations are supported.                          */
+#define BDB_ACCESS_HASH       1   /**< Hash table - lookups by key and unordered scans, no ranges of keys.           */
+#define BDB_ACCESS_RECNO      2   /**< Records, numbered by keys of single integer field, ordered by the numbers.    */
+#define BDB_ACCESS_QUEUE      3   /**< Fixed-length records, numbered as recno ones, with record-level locking.      */
+#define BDB_ACCESS_HEAP       4   /**< Records, identified by generated ids, with record-level locking and reuse of space (Berkeley DB 5.2 or later). */
+//@}
+
+/** @defgroup cachepriorities Priorities of pages of tables and indexes in the cache (pages of lower priority are evicted first). */
+//@{
+#define BDB_PRIORITY_DEFAULT      0   /**< Use Berkeley DB default priority.                  */
+#define BDB_PRIORITY_VERY_LOW     1   /**< Pages are evicted first, e.g. of reporting scans.  */
+#define BDB_PRIORITY_LOW          2   /**< Pages are evicted before default ones.             */
+#define BDB_PRIORITY_HIGH         3   /**< Pages are kept longer than default ones.           */
+#define BDB_PRIORITY_VERY_HIGH    4   /**< Pages are evicted last, e.g. of hot indexes.       */
+//@}
+
+/** @defgroup rangeflags Flags of range recordsets. */
+//@{
+#define BDB_RANGE_INCLUSIVE   0   /**< Both bounds of the range are inclusive.        */
+#define BDB_RANGE_EXCLUSIVE   1   /**< Upper bound of the range is exclusive.         */
+#define BDB_RANGE_REVERSE     2   /**< Records are fetched in descending order.       */
+#define BDB_RANGE_PREFIX      4   /**< Bounds are partial keys, matched as prefixes.  */
+//@}
+
+/** @defgroup joinflags Flags of joins. */
+//@{
+#define BDB_JOIN_SORT         0   /**< Most selective recordsets are iterated first.  */
+#define BDB_JOIN_NOSORT       1   /**< Recordsets are iterated in order of the list.  */
+#define BDB_JOIN_INTERSECT    2   /**< Records, which present in all recordsets.      */
+#define BDB_JOIN_UNION        4   /**< Records, which present in any recordset.       */
+#define BDB_JOIN_KEYS         8   /**< Only primary keys are fetched, data are empty. */
+//@}
+
+/** @defgroup joinmethods Methods of joins of different tables (see "bdb::table_join"). */
+//@{
+#define BDB_JOIN_HASH         0   /**< Records of the smaller side are hashed by join keys, the other side probes them. */
+#define BDB_JOIN_MERGE        1   /**< Both sides are walked at once, being ordered by join keys. */
+#define BDB_JOIN_INDEX        2   /**< Index (or table) of inner side is probed by batches of sorted join keys of outer side. */
+//@}
+
+/** @defgroup filterops Operators of recordset filters (see "bdb::recordset::add_filter"). */
+//@{
+#define BDB_FILTER_EQ         0   /**< Field is equal to the value.                   */
+#define BDB_FILTER_NE         1   /**< Field is not equal to the value.               */
+#define BDB_FILTER_LT         2   /**< Field is less than the value.                  */
+#define BDB_FILTER_LE         3   /**< Field is less than or equal to the value.      */
+#define BDB_FILTER_GT         4   /**< Field is greater than the value.               */
+#define BDB_FILTER_GE         5   /**< Field is greater than or equal to the value.   */
+//@}
+
+/** @defgroup fieldtypes Types of ProtoBuf fields, supported by "bdb::field_compare". */
+//@{
+#define BDB_FIELD_STRING      1   /**< "string" or "bytes" (lexicographical order).   */
+#define BDB_FIELD_INT32       2   /**< "int32" or "enum".                             */
+#define BDB_FIELD_INT64       3   /**< "int64".                                       */
+#define BDB_FIELD_UINT32      4   /**< "uint32" or "bool".                            */
+#define BDB_FIELD_UINT64      5   /**< "uint64".                                      */
+#define BDB_FIELD_SINT32      6   /**< "sint32".                                      */
+#define BDB_FIELD_SINT64      7   /**< "sint64".                                      */
+#define BDB_FIELD_FIXED32     8   /**< "fixed32".                                     */
+#define BDB_FIELD_FIXED64     9   /**< "fixed64".                                     */
+#define BDB_FIELD_SFIXED32   10   /**< "sfixed32".                                    */
+#define BDB_FIELD_SFIXED64   11   /**< "sfixed64".                                    */
+#define BDB_FIELD_FLOAT      12   /**< "float".                                       */
+#define BDB_FIELD_DOUBLE     13   /**< "double".                                      */
+//@}
+
+/** @defgroup latencyops Operations and phases, measured by latency histograms (see "bdb::get_latency_stats"). */
+//@{
+#define BDB_LATENCY_INSERT        0   /**< "bdb::table::insert".                                          */
+#define BDB_LATENCY_UPDATE        1   /**< "bdb::table::update".                                          */
+#define BDB_LATENCY_SELECT        2   /**< "bdb::table::select".                                          */
+#define BDB_LATENCY_EXISTS        3   /**< "bdb::table::exists".                                          */
+#define BDB_LATENCY_REMOVE        4   /**< "bdb::table::remove".                                          */
+#define BDB_LATENCY_UPSERT        5   /**< "bdb::table::upsert".                                          */
+#define BDB_LATENCY_FETCH         6   /**< Fetches of recordsets ("bdb::recordset::fetch" and others).   */
+#define BDB_LATENCY_SEQUENCE      7   /**< "bdb::sequence::id" and "bdb::sequence::ids".                  */
+#define BDB_LATENCY_COMMIT        8   /**< Commits of transactions.                                       */
+#define BDB_LATENCY_SERIALIZE     9   /**< Serialization of messages (phase of the operations above).     */
+#define BDB_LATENCY_UNSERIALIZE  10   /**< Unserialization of messages (phase of the operations above).   */
+#define BDB_LATENCY_BERKELEY     11   /**< Calls of Berkeley DB (phase of the operations above).          */
+#define BDB_LATENCY_CALLBACK     12   /**< Application callbacks of modifications, scans, and transactions. */
+#define BDB_LATENCY_OPERATIONS   13   /**< Number of measured operations and phases.                      */
 //@}
 
+/** @private Kinds of profiled callbacks (see "bdb::table_options::profile_callbacks"). */
+//@{
+#define BDB_CALLBACK_COMPARE        0   /**< @private Keys comparison function of table.   */
+#define BDB_CALLBACK_INDEX_COMPARE  1   /**< @private Comparison functions of its indexes. */
+#define BDB_CALLBACK_INDEX          2   /**< @private Indexing functions of its indexes.   */
+#define BDB_CALLBACK_KINDS          3   /**< @private Number of kinds.                     */
+//@}
+
+/** @defgroup changeops Operations of captured changes (see "bdb::change_stream"). */
+//@{
+#define BDB_CHANGE_INSERT   1   /**< New record is inserted.            */
+#define BDB_CHANGE_UPDATE   2   /**< Existing record is overwritten.    */
+#define BDB_CHANGE_REMOVE   3   /**< Record is removed.                 */
+//@}
+
+/** @defgroup verifyissues Issues, found by verification of the database (see "bdb::database::verify"). */
+//@{
+#define BDB_VERIFY_CORRUPTED    1   /**< File of table or index fails structural verification of Berkeley DB. */
+#define BDB_VERIFY_MISSING      2   /**< Record is not indexed by a key, which its indexing function makes.  */
+#define BDB_VERIFY_DANGLING     3   /**< Index entry refers to a missing record, or has a stale key.         */
+//@}
+
+/** Number of buckets of latency histogram (four buckets per each power of two of nanoseconds). */
+#define BDB_LATENCY_BUCKETS     160
+
 /** Berkeley DB forward definitions. */
 struct __db;            typedef struct __db          DB;            /**< @typedef */
 struct __db_env;        typedef struct __db_env      DB_ENV;        /**< @typedef */
@@ -84,19 +271,103 @@ struct __db_dbt;        typedef struct __db_dbt      DBT;           /**< @typede
 namespace bdb
 {
 
-using std::stack;
+using std::pair;
 using std::string;
 using std::vector;
 
+using google::protobuf::Descriptor;
+using google::protobuf::FieldDescriptor;
 using google::protobuf::Message;
+using google::protobuf::MessageLite;
 
 // Local forward definitions.
 class exception;
 class database;
+class transaction;
+class snapshot;
 class sequence;
 class table;
 class index;
 class recordset;
+class record_view;
+class arena;
+class aggregation;
+class write_batch;
+class value_stream;
+class txn_stacks;
+class group_commit;
+class maintenance;
+class trickle_writer;
+class scratch_arena;
+class key_order;
+class key_less;
+class batch_mutation;
+class batch_overlay;
+class row_cache;
+class key_filter;
+class prepared_key;
+class sharded_table;
+class sharded_recordset;
+class merge_state;
+class merge_input;
+class merge_greater;
+class partitioned_table;
+class partitioned_recordset;
+class partition_map;
+class callback_counters;
+class message_layout;
+class merged_recordset;
+class async_state;
+class async_queue;
+class pool_state;
+class group_state;
+class work_pool;
+class read_ahead;
+class sample_state;
+class top_state;
+class profile_state;
+class build_state;
+class sort_state;
+class sort_buffer;
+class sort_run;
+class sort_order;
+class sort_greater;
+class external_sorter;
+class notify_state;
+class notifier;
+class materialized_aggregate;
+class column_store;
+class column_chunk;
+class applier_state;
+class index_applier;
+class deferred_less;
+class reaper_state;
+class expiry_reaper;
+class expiry_less;
+class buffered_table;
+class buffer_state;
+class buffer_less;
+class series_table;
+class series_state;
+class foreign_cache;
+class cursor_slot;
+class cursor_state;
+class cursor_pool;
+class generator_block;
+class generator_state;
+class id_generator;
+class governor_state;
+class memory_governor;
+class sampler_state;
+class hot_sampler;
+class key_sketch;
+class join_state;
+class table_join;
+class join_less;
+class verify_job;
+class table_opener;
+
+template <class K, class D> class rows;
 
 //--------------------------------------------------------------------------------------------------
 //  Typedefs.
@@ -107,245 +378,3634 @@ class recordset;
  */
 typedef vector <recordset *> joinlist;
 
-//--------------------------------------------------------------------------------------------------
-//  Callback functions prototypes.
-//--------------------------------------------------------------------------------------------------
-
 /**
- * Application-specified keys comparison function.
- *
- * @param [in] dbt1 "DBT" structure, representing the application supplied key.
- * @param [in] dbt2 "DBT" structure, representing the current btree's key.
- * @return 0 if dbt1 is equal to dbt2.
- * @return -1 if dbt1 is less than dbt2.
- * @return +1 if dbt1 is greater than dbt2.
+ * List of keys to select.
  */
-typedef int (*compare_callback) (DB *, const DBT * dbt1, const DBT * dbt2);
+typedef vector <const Message *> keylist;
 
 /**
- * Application-specified function to create a key for secondary index from key/data of primary table.
- *
- * @param [in]  key    "DBT" structure, referencing the primary key.
- * @param [in]  data   "DBT" structure, referencing the primary data.
- * @param [out] result Zeroed "DBT" structure, which the callback function should fill in.
- * @return 0 on success.
- * @return A non-zero value if index should not contain a record for specified primary key/data pair.
+ * List of messages to receive selected data.
  */
-typedef int (*index_callback) (DB *, const DBT * key, const DBT * data, DBT * result);
+typedef vector <Message *> datalist;
 
 /**
- * Application-specified function to update a data from primary table based on key/data from foreign one.
- *
- * @param [in]     pkey    "DBT" structure, referencing the primary key.
- * @param [in,out] pdata   "DBT" structure, referencing the primary data.
- * @param [in]     fkey    "DBT" structure, referencing the foreign key.
- * @param [out]    changed A pointer to a boolean value, indicated whether the primary data has been changed.
- * @return 0 on success.
- * @return A non-zero value if primary data cannot be updated.
+ * List of records (pairs of key and data) to insert.
  */
-typedef int (*nullify_callback) (DB *, const DBT * pkey, DBT * pdata, const DBT * fkey, int * changed);
+typedef vector <pair <const Message *, const Message *> > bulklist;
 
-//--------------------------------------------------------------------------------------------------
-//  Static functions.
-//--------------------------------------------------------------------------------------------------
+/**
+ * Raw value of a field, extracted from serialized ProtoBuf message (see "bdb::extract_field").
+ */
+struct field_value
+{
+    const void * data;      /**< Raw bytes of the value ("NULL" if the field is absent). */
+    size_t       size;      /**< Size of the value in bytes.                             */
+    int          wiretype;  /**< ProtoBuf wire type of the field ("-1" if absent).       */
+};
 
-// Berkeley DB version.
-BDB_EXPORT void version (int * major, int * minor, int * patch = NULL);
+/**
+ * Reference to bytes of string (or bytes) field within serialized data, which are not copied into "std::string"
+ * (see "bdb::record_view::get"). It's valid as long as the data are, e.g. until the next fetch of the recordset.
+ */
+class string_ref
+{
+public:
 
-/** @defgroup serialization Serialization between Berkeley DB and Protocol Buffers. */
-//@{
-BDB_EXPORT void serialize   (const Message * from, DBT * to);
-BDB_EXPORT void unserialize (const DBT * from, Message * to);
-BDB_EXPORT void release     (DBT * dbt);
-//@}
+    /** Refers to empty string. */
+    string_ref () : m_data(NULL), m_size(0) { }
 
-/** @private */
-void* malloc  (size_t size);
-/** @private */
-void* realloc (void * ptr, size_t size);
-/** @private */
-void  free    (void * ptr);
+    /** Refers to specified bytes. */
+    string_ref (const char * data, size_t size) : m_data(data), m_size(size) { }
 
-//--------------------------------------------------------------------------------------------------
-//  Static variables.
-//--------------------------------------------------------------------------------------------------
+    /** Refers to specified zero-terminated string. */
+    string_ref (const char * str) : m_data(str), m_size(strlen(str)) { }
 
-/** @private Library's logger. */
-static log4cplus::Logger logger = log4cplus::Logger::getInstance(BDB_LOGGER_PORT);
+    /** Refers to bytes of specified string. */
+    string_ref (const string & str) : m_data(str.data()), m_size(str.size()) { }
 
-//--------------------------------------------------------------------------------------------------
-//  BDB classes.
-//--------------------------------------------------------------------------------------------------
+    /** Returns the first byte of the string (it's not terminated by zero). */
+    const char * data () const { return m_data; }
 
-/**
- * BDB exception.
- */
-class exception
-{
-public:
+    /** Returns size of the string in bytes. */
+    size_t size () const { return m_size; }
 
-    BDB_EXPORT exception  (int error);     /**< @private */
-    BDB_EXPORT ~exception () throw ();     /**< @private */
+    /** Checks whether the string is empty. */
+    bool empty () const { return m_size == 0; }
 
-    /**
-     * @return Exception's error code.
-     */
-    inline int error () { return m_error; }
+    /** Returns copy of the string. */
+    string str () const { return (m_size != 0 ? string(m_data, m_size) : string()); }
 
-protected:
+    /** Compares bytes of the strings, as "std::string::compare" does. */
+    int compare (const string_ref & other) const
+    {
+        size_t size = (m_size < other.m_size ? m_size : other.m_size);
+        int    res  = (size != 0 ? memcmp(m_data, other.m_data, size) : 0);
 
-    int m_error;    /**< @private */
-};
+        if (res != 0) return res;
 
-/**
- * User database.
- */
-class database
-{
-    friend class sequence;
-    friend class table;
-    friend class index;
-    friend class recordset;
+        return (m_size < other.m_size ? -1 : (m_size > other.m_size ? 1 : 0));
+    }
 
-public:
+    /** Checks whether the string starts with specified prefix. */
+    bool starts_with (const string_ref & prefix) const
+    {
+        return (prefix.m_size <= m_size && (prefix.m_size == 0 || memcmp(m_data, prefix.m_data, prefix.m_size) == 0));
+    }
 
-    BDB_EXPORT database  (const char * home, bool create = false);
-    BDB_EXPORT ~database () throw ();
+    /** Returns position of the first occurrence of specified substring since "pos" ("std::string::npos" if none). */
+    size_t find (const string_ref & sub, size_t pos = 0) const
+    {
+        for (size_t i = pos; i + sub.m_size <= m_size; i++)
+        {
+            if (sub.m_size == 0 || memcmp(m_data + i, sub.m_data, sub.m_size) == 0) return i;
+        }
 
-    BDB_EXPORT sequence * add_sequence (const char * name, bool create = false);
-    BDB_EXPORT table    * add_table    (const char * name, compare_callback fn_cmp, bool create = false);
+        return string::npos;
+    }
 
-    BDB_EXPORT void begin_transaction    ();
-    BDB_EXPORT void commit_transaction   ();
-    BDB_EXPORT void rollback_transaction ();
+    bool operator == (const string_ref & other) const { return compare(other) == 0; }
+    bool operator != (const string_ref & other) const { return compare(other) != 0; }
+    bool operator <  (const string_ref & other) const { return compare(other) <  0; }
 
 protected:
 
-    string               m_home;        /**< @private Home path of the database.  */
-    DB_ENV             * m_env;         /**< @private DB environment.             */
-    DB                 * m_seq;         /**< @private Sequences database.         */
-    stack <DB_TXN*>      m_txns;        /**< @private Active nested transactions. */
-    vector <sequence*>   m_sequences;   /**< @private List of database sequences. */
-    vector <table*>      m_tables;      /**< @private List of database tables.    */
+    const char * m_data;    /**< @private The first byte of the string.  */
+    size_t       m_size;    /**< @private Size of the string in bytes.   */
 };
 
 /**
- * Sequence of autogenerating unique IDs.
+ * @private Value of a field, decoded from serialized ProtoBuf message (see "bdb::compare_decoded").
  */
-class sequence
+struct decoded_field
 {
-    friend class database;
-
-protected:
-
-    sequence  (database * db, const char * name, bool create = false);
-    ~sequence () throw ();
-
-public:
-
-    BDB_EXPORT int64_t id ();
-
-protected:
-
-    database    * m_database;   /**< @private Master database. */
-    DB_SEQUENCE * m_seq;        /**< @private A sequence.      */
+    bool         found;     /**< @private Whether the message contains the field.                        */
+    uint64_t     value;     /**< @private Value of integer field, or size of length-delimited one.      */
+    const void * data;      /**< @private Content of length-delimited field.                            */
 };
 
 /**
- * Database table.
+ * Estimated proportions of keys before, within, and after a range (see "bdb::table::estimate_range").
  */
-class table
+struct key_estimate
 {
-    friend class database;
-    friend class index;
-    friend class recordset;
+    double less;            /**< Proportion of keys, which are less than the lower bound.    */
+    double equal;           /**< Proportion of keys within the range.                        */
+    double greater;         /**< Proportion of keys, which are greater than the upper bound. */
+};
 
-protected:
+/**
+ * Token of committed transaction (see "bdb::transaction::commit"), by which a replica waits until the
+ * transaction is applied (see "bdb::database::wait_applied"). Tokens can be passed between processes as is.
+ */
+struct commit_token
+{
+    unsigned char data[20];     /**< Contents of Berkeley DB token ("DB_TXN_TOKEN"). */
+};
 
-    table  (const char * name);
-    table  (database * db, const char * name, compare_callback fn_cmp, bool create = false);
-    ~table () throw ();
+/**
+ * Codec of large serialized values (see "bdb::set_codec"), e.g. LZ4 or zstd with a trained dictionary.
+ */
+struct value_codec
+{
+    size_t threshold;   /**< Minimal size of serialized value to compress, in bytes. */
 
-public:
+    /** Compresses "size" bytes of "src" into "dest", returns compressed size ("0" if it exceeds "capacity"). */
+    size_t (*fn_compress) (const void * src, size_t size, void * dest, size_t capacity);
 
-    BDB_EXPORT index * add_index (const char * name,
-                                  index_callback fn_idx,
-                                  compare_callback fn_cmp,
-                                  bool unique = false);
+    /** Decompresses "size" bytes of "src" into "dest" of original size "original", returns "false" on error. */
+    bool (*fn_decompress) (const void * src, size_t size, void * dest, size_t original);
+};
 
-    BDB_EXPORT bool exists (const Message * key                      );
-    BDB_EXPORT void remove (const Message * key                      );
-    BDB_EXPORT void insert (const Message * key, const Message * data);
-    BDB_EXPORT void update (const Message * key, const Message * data);
+/**
+ * Cipher of serialized values (see "bdb::set_cipher"), e.g. AES-GCM of a crypto library, which uses
+ * AES-NI or VAES instructions of the processor.
+ */
+struct value_cipher
+{
+    size_t overhead;    /**< Maximal number of bytes, added to encrypted value (e.g. nonce and tag). */
 
-    BDB_EXPORT void select (const Message * key, Message * data);
+    /** Encrypts "size" bytes of "src" into "dest" of "size + overhead" bytes, returns encrypted size ("0" on error). */
+    size_t (*fn_encrypt) (const void * src, size_t size, void * dest);
 
-protected:
+    /** Decrypts "size" bytes of "src" into "dest" of "size" bytes, sets decrypted size, returns "false" on error (e.g. wrong tag). */
+    bool (*fn_decrypt) (const void * src, size_t size, void * dest, size_t * decrypted);
+};
 
-    /** @private */
-    inline string get_filename () { return m_name + ".db"; }
+/**
+ * Aggregated values of a group of records (see "bdb::aggregation").
+ */
+struct aggregate_value
+{
+    uint64_t count;     /**< Number of records in the group.                            */
+    uint64_t values;    /**< Number of records, which contain the aggregated field.     */
+    int64_t  sum;       /**< Sum of values of the field.                                */
+    int64_t  min;       /**< Minimal value of the field ("0" if there are no values).   */
+    int64_t  max;       /**< Maximal value of the field ("0" if there are no values).   */
+};
 
-protected:
+/**
+ * Aggregated values by groups, keyed by raw value of grouping field (see "bdb::aggregation::groups").
+ */
+typedef std::map <string, aggregate_value> aggregate_groups;
 
-    string             m_name;          /**< @private Name of the table.         */
-    DB               * m_db;            /**< @private Berkeley DB database.      */
-    database         * m_database;      /**< @private Master database.           */
-    compare_callback   m_callback;      /**< @private Keys comparision function. */
-    vector <index*>    m_indexes;       /**< @private List of table indexes.     */
+/**
+ * @private Compiled condition of recordset filter (see "bdb::recordset::add_filter").
+ */
+struct filter_condition
+{
+    int    field;           /**< Field number.                                          */
+    int    type;            /**< Field type (see @ref fieldtypes "types").              */
+    int    op;              /**< Operator (see @ref filterops "operators").             */
+    string value;           /**< Serialized message, which contains the value to match. */
 };
 
 /**
- * Index of database table.
+ * Custom memory allocator (see "bdb::set_allocator").
  */
-class index : protected table
+struct allocator
 {
-    friend class table;
-    friend class recordset;
-
-protected:
+    void * (*fn_malloc)  (size_t size);                 /**< Allocates memory block.   */
+    void * (*fn_realloc) (void * ptr, size_t size);     /**< Reallocates memory block. */
+    void   (*fn_free)    (void * ptr);                  /**< Frees memory block.       */
+};
 
-    index (table * tbl,
-           const char * name,
-           index_callback fn_idx,
-           compare_callback fn_cmp,
-           compare_callback fn_dup,
-           bool unique = false);
+/**
+ * Statistics of database environment (see "bdb::database::stats").
+ * Counters are accumulated since the environment has been opened, or since they have been cleared.
+ */
+struct database_stats
+{
+    uint64_t cache_bytes;       /**< Size of the cache, in bytes.                                      */
+    uint64_t cache_pages;       /**< Number of pages in the cache.                                     */
+    uint64_t dirty_pages;       /**< Number of changed pages in the cache.                             */
+    uint64_t cache_hits;        /**< Number of pages, found in the cache.                              */
+    uint64_t cache_misses;      /**< Number of pages, not found in the cache.                          */
+    uint64_t pages_read;        /**< Number of pages, read into the cache.                             */
+    uint64_t pages_written;     /**< Number of pages, written from the cache.                          */
+    uint64_t pages_evicted;     /**< Number of pages, evicted from the cache.                          */
+    uint64_t lock_requests;     /**< Number of lock requests.                                          */
+    uint64_t lock_waits;        /**< Number of lock requests, which had to wait.                       */
+    uint64_t deadlocks;         /**< Number of deadlocks.                                              */
+    uint64_t lock_timeouts;     /**< Number of lock and transaction timeouts.                          */
+    uint64_t locks;             /**< Number of current locks.                                          */
+    uint64_t lockers;           /**< Number of current lockers.                                        */
+    uint64_t log_records;       /**< Number of written log records.                                    */
+    uint64_t log_bytes;         /**< Size of written log, in bytes.                                    */
+    uint64_t log_writes;        /**< Number of writes to the log.                                      */
+    uint64_t log_syncs;         /**< Number of flushes of the log to disk.                             */
+    uint64_t txn_begins;        /**< Number of begun transactions.                                     */
+    uint64_t txn_commits;       /**< Number of committed transactions.                                 */
+    uint64_t txn_aborts;        /**< Number of aborted transactions.                                   */
+    uint64_t txn_active;        /**< Number of active transactions.                                    */
+};
 
-public:
+/**
+ * Statistics of table (see "bdb::table::stats").
+ */
+struct table_stats
+{
+    uint64_t keys;              /**< Number of keys.                                                   */
+    uint64_t records;           /**< Number of records (differs from keys if there are duplicates).    */
+    uint64_t page_size;         /**< Size of pages, in bytes.                                          */
+    uint64_t pages;             /**< Number of pages.                                                  */
+    uint64_t free_pages;        /**< Number of pages in the free list ("0" for fast statistics).       */
+    uint64_t levels;            /**< Number of levels of Btree ("0" if not Btree, or fast statistics). */
+    uint64_t compare_calls;     /**< Calls of keys comparison function (see "bdb::table_options::profile_callbacks"). */
+    uint64_t compare_time;      /**< Time of keys comparison function, in nanoseconds.                 */
+    uint64_t index_compare_calls;   /**< Calls of comparison functions of indexes of the table.        */
+    uint64_t index_compare_time;    /**< Time of comparison functions of indexes, in nanoseconds.      */
+    uint64_t index_calls;       /**< Calls of indexing functions of indexes of the table.              */
+    uint64_t index_time;        /**< Time of indexing functions, in nanoseconds.                       */
+};
 
-    BDB_EXPORT void add_foreign (table * foreign, bool cascade = true);
-    BDB_EXPORT void add_foreign (table * foreign, nullify_callback nullify);
+/**
+ * Execution profile of recordset (see "bdb::recordset::profile").
+ */
+struct recordset_profile
+{
+    uint64_t examined;              /**< Records read by the recordset, including ones rejected by filters.  */
+    uint64_t returned;              /**< Records returned by fetches.                                        */
+    uint64_t cursor_calls;          /**< Calls of Berkeley DB cursors (refill of bulk buffer is one call).   */
+    uint64_t pages_read;            /**< Pages, read into the cache of the environment (by all its users).   */
+    uint64_t bytes_unserialized;    /**< Bytes of keys and data, unserialized into messages by fetches.      */
+    uint64_t callback_time;         /**< Time of filter callback and of profiled callbacks of the table, in nanoseconds. */
+    vector <string> join_order;     /**< Names of indexes of natural join, in order of their iteration.     */
+};
 
-    BDB_EXPORT bool exists (const Message * key);
+/**
+ * Memory and size of table or index (see "bdb::table::footprint").
+ * Resident pages are estimated by pages of the file, read into the cache, in proportion to the whole cache.
+ */
+struct table_footprint
+{
+    uint64_t records;           /**< Number of records (as of fast statistics).                        */
+    uint64_t page_size;         /**< Size of pages, in bytes.                                          */
+    uint64_t pages;             /**< Number of pages.                                                  */
+    uint64_t file_bytes;        /**< Size of the pages on disk, in bytes.                              */
+    uint64_t cached_pages;      /**< Estimated number of pages, resident in the cache.                 */
+    uint64_t cached_bytes;      /**< Estimated size of pages, resident in the cache, in bytes.         */
+    uint64_t cache_hits;        /**< Number of pages of the file, found in the cache.                  */
+    uint64_t cache_misses;      /**< Number of pages of the file, not found in the cache.              */
+    uint64_t sampled;           /**< Number of records, key and value sizes are sampled from.          */
+    uint64_t key_bytes;         /**< Average size of sampled keys, in bytes.                           */
+    uint64_t value_bytes;       /**< Average size of sampled values (as stored), in bytes.             */
+    uint64_t row_cache_bytes;   /**< Memory of records in the cache of records of the table.           */
+    uint64_t filter_bytes;      /**< Memory of Bloom filter of keys of the table.                      */
+};
 
-protected:
+/**
+ * Equi-depth histogram of keys of table (see "bdb::table::analyze"), persisted in the database.
+ * Each bucket has roughly the same number of records; keys of the first bucket are below the first bound,
+ * and keys of the last one are not below the last bound.
+ */
+struct key_histogram
+{
+    uint64_t         records;   /**< Number of records, when the histogram was built.                  */
+    uint64_t         time;      /**< Time of building of the histogram, in seconds since the epoch.    */
+    uint64_t         modified;  /**< Number of inserted and removed records since then (by this process). */
+    vector <string>  bounds;    /**< Serialized bounds between buckets, in ascending order.            */
+};
 
-    /** @private */
-    inline string get_filename () { return m_name + ".ix"; }
+/**
+ * Frequently accessed key of table or index (see "bdb::table::hot_keys").
+ * Counts are estimated by sampled accesses, multiplied by the sampling period.
+ */
+struct hot_key
+{
+    string   key;               /**< Serialized key.                                                   */
+    uint64_t count;             /**< Estimated number of accesses.                                     */
+    uint64_t error;             /**< Maximum overestimation of the count.                              */
 };
 
 /**
- * Data recordset.
+ * Issue, found by verification of the database (see "bdb::database::verify").
  */
-class recordset
+struct verify_issue
 {
-public:
+    int      kind;              /**< Kind of the issue (see @ref verifyissues "issues").               */
+    string   file;              /**< File of table or index.                                           */
+    string   key;               /**< Serialized index key (empty for corrupted file).                  */
+    string   primary;           /**< Serialized primary key (empty for corrupted file).                */
+};
 
-    BDB_EXPORT recordset  (table * tbl);
-    BDB_EXPORT recordset  (index * idx);
-    BDB_EXPORT recordset  (index * idx, const Message * key);
-    BDB_EXPORT recordset  (table * tbl, const joinlist & list);
-    BDB_EXPORT ~recordset () throw ();
+/**
+ * Results of compaction of table or index (see "bdb::table::compact").
+ */
+struct compact_result
+{
+    uint64_t pages_examined;    /**< Number of examined pages.                                         */
+    uint64_t pages_freed;       /**< Number of pages, freed by merging of half-empty pages.            */
+    uint64_t pages_truncated;   /**< Number of pages, returned to the file system ("DB_FREE_SPACE").   */
+    uint64_t levels;            /**< Number of levels, removed from Btree.                             */
+    uint64_t deadlocks;         /**< Number of steps, rolled back by deadlocks (and retried).          */
+    uint64_t steps;             /**< Number of committed steps (transactions).                         */
+    bool     completed;         /**< Whether the whole file is compacted (not stopped by a budget).    */
+};
 
-    BDB_EXPORT bool fetch  (Message * key, Message * data);
+/**
+ * Change of a record, captured by its table (see "bdb::table_options::capture_changes").
+ * Key and data are serialized as they are stored in the table (e.g. data are parsed by "bdb::unserialize").
+ */
+struct change_record
+{
+    uint64_t sequence;          /**< Number of the change in change log of the database.    */
+    int      operation;         /**< Operation (see @ref changeops "operations").           */
+    string   table;             /**< Name of changed table.                                 */
+    string   key;               /**< Serialized key of the record.                          */
+    string   olddata;           /**< Serialized old data (empty for insertion).             */
+    string   newdata;           /**< Serialized new data (empty for removal).               */
+};
+
+/**
+ * Notification of committed change of a record (see "bdb::table::subscribe").
+ * Key and data are serialized as they are stored in the table.
+ */
+struct change_notice
+{
+    string   key;               /**< Serialized key of the record.                                    */
+    string   data;              /**< Serialized new data (empty for removal, or if values are not requested). */
+    bool     removed;           /**< Whether the record is removed.                                   */
+};
+
+/**
+ * Histogram of latencies of an operation (see "bdb::get_latency_stats"), in nanoseconds.
+ * Bucket "i" counts latencies from "bdb::latency_bound(i)" up to (excluding) "bdb::latency_bound(i + 1)".
+ */
+struct latency_histogram
+{
+    uint64_t count;                         /**< Number of measurements.             */
+    uint64_t total;                         /**< Sum of all latencies.               */
+    uint64_t max;                           /**< Maximum latency.                    */
+    uint64_t buckets[BDB_LATENCY_BUCKETS];  /**< Numbers of measurements by buckets. */
+};
+
+/**
+ * Record of slow operation (see "bdb::database::set_slow_threshold").
+ */
+struct slow_operation
+{
+    int          operation;     /**< Operation (see @ref latencyops "operations").           */
+    const char * name;          /**< Name of the table ("" for commits).                      */
+    size_t       key_size;      /**< Size of serialized key, in bytes ("0" if unknown).       */
+    size_t       value_size;    /**< Size of serialized value, in bytes ("0" if unknown).     */
+    unsigned int txn_depth;     /**< Number of nested transactions of the calling thread.     */
+    uint64_t     duration;      /**< Duration of the operation, in nanoseconds.               */
+};
+
+/**
+ * Statistics of memory budget of database (see "bdb::database::stats").
+ * The library part of the budget is what is left of it after the cache of the environment.
+ */
+struct budget_stats
+{
+    uint64_t budget;            /**< Whole memory budget, in bytes ("0" - the database has no budget). */
+    uint64_t mpool_bytes;       /**< Part of the budget, taken by the cache of the environment.        */
+    uint64_t library_bytes;     /**< Part of the budget, left for the library.                         */
+    uint64_t filter_bytes;      /**< Memory, taken by Bloom filters of keys of tables.                 */
+    uint64_t buffer_bytes;      /**< Memory, reserved by buffers of buffered tables.                   */
+    uint64_t cache_limit;       /**< Memory, granted to caches of records of tables.                   */
+    uint64_t cache_bytes;       /**< Memory, taken by cached records.                                  */
+    uint64_t cache_evictions;   /**< Number of cached records, evicted for lack of memory.             */
+    uint64_t rebalances;        /**< Number of splits of the memory between caches of records.         */
+};
+
+/**
+ * Bounding box of locations (see "bdb::table::add_geo_index"), in degrees ("min_lon" must not exceed
+ * "max_lon", so boxes across the 180th meridian are queried as two boxes).
+ */
+struct geo_box
+{
+    double min_lat;     /**< The least latitude.     */
+    double min_lon;     /**< The least longitude.    */
+    double max_lat;     /**< The greatest latitude.  */
+    double max_lon;     /**< The greatest longitude. */
+};
+
+/**
+ * Point of time series (see "bdb::series_table").
+ */
+struct series_point
+{
+    int64_t time;   /**< Timestamp of the point. */
+    double  value;  /**< Value of the point.     */
+};
+
+/**
+ * Statistics of memory allocations (see "bdb::get_memory_stats").
+ */
+struct memory_stats
+{
+    uint64_t mallocs;       /**< Number of allocated blocks.                          */
+    uint64_t reallocs;      /**< Number of reallocated blocks.                        */
+    uint64_t frees;         /**< Number of freed blocks.                              */
+    uint64_t bytes;         /**< Total size of allocated and reallocated blocks.      */
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Callback functions prototypes.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Application-specified keys comparison function.
+ *
+ * @param [in] dbt1 "DBT" structure, representing the application supplied key.
+ * @param [in] dbt2 "DBT" structure, representing the current btree's key.
+ * @return 0 if dbt1 is equal to dbt2.
+ * @return -1 if dbt1 is less than dbt2.
+ * @return +1 if dbt1 is greater than dbt2.
+ */
+typedef int (*compare_callback) (DB *, const DBT * dbt1, const DBT * dbt2);
+
+/**
+ * Application-specified function to create a key for secondary index from key/data of primary table.
+ *
+ * @param [in]  key    "DBT" structure, referencing the primary key.
+ * @param [in]  data   "DBT" structure, referencing the primary data.
+ * @param [out] result Zeroed "DBT" structure, which the callback function should fill in.
+ * @return 0 on success.
+ * @return A non-zero value if index should not contain a record for specified primary key/data pair.
+ */
+typedef int (*index_callback) (DB *, const DBT * key, const DBT * data, DBT * result);
+
+/**
+ * Application-specified function to update a data from primary table based on key/data from foreign one.
+ *
+ * @param [in]     pkey    "DBT" structure, referencing the primary key.
+ * @param [in,out] pdata   "DBT" structure, referencing the primary data.
+ * @param [in]     fkey    "DBT" structure, referencing the foreign key.
+ * @param [out]    changed A pointer to a boolean value, indicated whether the primary data has been changed.
+ * @return 0 on success.
+ * @return A non-zero value if primary data cannot be updated.
+ */
+typedef int (*nullify_callback) (DB *, const DBT * pkey, DBT * pdata, const DBT * fkey, int * changed);
+
+/**
+ * Application-specified function to create a projection of primary data, stored in covering index.
+ *
+ * @param [in]  key    "DBT" structure, referencing the primary key.
+ * @param [in]  data   "DBT" structure, referencing the primary data.
+ * @param [out] result Zeroed "DBT" structure, which the callback function should fill in.
+ * @return 0 on success.
+ * @return A non-zero value if the projection cannot be created.
+ */
+typedef int (*project_callback) (DB *, const DBT * key, const DBT * data, DBT * result);
+
+/**
+ * Application-specified delta function of materialized aggregate (see "bdb::table::add_aggregate"), which
+ * returns group of a record and its contribution to the sum of the group. The contribution is added to the group
+ * on insertion of the record, is subtracted on its removal, and both are done on its update.
+ *
+ * @param [in]  key    "DBT" structure, referencing the primary key.
+ * @param [in]  data   "DBT" structure, referencing the primary data.
+ * @param [out] group  Zeroed "DBT" structure, which the callback function should fill in with key of the group (empty - the only group).
+ * @param [out] value  Contribution of the record to the sum of the group.
+ * @return 0 on success.
+ * @return DB_DONOTINDEX if the record is not aggregated.
+ * @return Another non-zero value if the contribution cannot be made.
+ */
+typedef int (*aggregate_callback) (DB *, const DBT * key, const DBT * data, DBT * group, int64_t * value);
+
+/**
+ * Application-specified function to upgrade serialized data of a record from one version of schema of its table
+ * to the next one (see "bdb::table::add_upgrade"), e.g. to move a field into a submessage.
+ *
+ * @param [in]  db      Berkeley DB handle of the table.
+ * @param [in]  version Version of schema of the data.
+ * @param [in]  data    "DBT" structure, referencing the data.
+ * @param [out] result  Zeroed "DBT" structure, which the callback function should fill in with data of the next version
+ *                      (with "DB_DBT_APPMALLOC" flag, if the data are allocated by the callback).
+ * @return 0 on success.
+ * @return A non-zero value if the data cannot be upgraded.
+ */
+typedef int (*upgrade_callback) (DB *, unsigned int version, const DBT * data, DBT * result);
+
+/**
+ * Application-specified function to compress a record of compressed table (see "Db::set_bt_compress()").
+ * The record is compressed against the previous one, e.g. by LZ4 or zstd codec of serialized data.
+ *
+ * @param [in]  prev_key  "DBT" structure, referencing the previous key.
+ * @param [in]  prev_data "DBT" structure, referencing the previous data.
+ * @param [in]  key       "DBT" structure, referencing the key to compress.
+ * @param [in]  data      "DBT" structure, referencing the data to compress.
+ * @param [out] dest      "DBT" structure, which the callback function should fill in.
+ * @return 0 on success.
+ * @return "DB_BUFFER_SMALL" if "dest" is too small (its size should be set to the required one).
+ */
+typedef int (*compress_callback) (DB *, const DBT * prev_key, const DBT * prev_data, const DBT * key, const DBT * data, DBT * dest);
+
+/**
+ * Application-specified function to decompress a record, compressed by "compress_callback".
+ *
+ * @param [in]     prev_key   "DBT" structure, referencing the previous key.
+ * @param [in]     prev_data  "DBT" structure, referencing the previous data.
+ * @param [in,out] compressed "DBT" structure, referencing the compressed stream (its size should be set to the consumed one).
+ * @param [out]    key        "DBT" structure, which the callback function should fill in with the key.
+ * @param [out]    data       "DBT" structure, which the callback function should fill in with the data.
+ * @return 0 on success.
+ * @return "DB_BUFFER_SMALL" if "key" or "data" is too small (their sizes should be set to the required ones).
+ */
+typedef int (*decompress_callback) (DB *, const DBT * prev_key, const DBT * prev_data, DBT * compressed, DBT * key, DBT * data);
+
+/**
+ * Partitioning function of table (see "Db::set_partition()"), which returns number of partition of a key.
+ * The number is taken modulo number of partitions.
+ *
+ * @param [in] db  Berkeley DB database.
+ * @param [in] key "DBT" structure, referencing the key.
+ */
+typedef u_int32_t (*partition_callback) (DB *, DBT * key);
+
+/**
+ * Application-specified function to modify a record in place (see "bdb::table::modify").
+ * The function can be called several times for the same record, if the modification is retried.
+ *
+ * @param [in,out] data  Current data of the record, which the function should change.
+ * @param [in]     param Parameter, specified for the modification.
+ * @return true  to write the changed data back.
+ * @return false to leave the record unchanged.
+ */
+typedef bool (*modify_callback) (Message * data, void * param);
+
+/**
+ * Application-specified function to merge a delta into a record (see "bdb::table::merge").
+ * The function works on serialized (and decompressed) messages, so the record is not parsed,
+ * unless the function parses it itself (see "bdb::merge_append" and "bdb::merge_add").
+ *
+ * @param [in]  data   Serialized data of the record ("NULL" if the record doesn't exist).
+ * @param [in]  delta  Serialized delta.
+ * @param [out] result Serialized merged data of the record.
+ * @param [in]  param  Parameter, specified for the merge.
+ * @return true  to write the merged data.
+ * @return false to leave the record as it is.
+ */
+typedef bool (*merge_callback) (const DBT * data, const DBT * delta, string * result, void * param);
+
+/**
+ * Application-specified function, called on completion of asynchronous operation (see "bdb::async_database").
+ * The function is called by a worker thread, after result of the operation (if any) is completed.
+ *
+ * @param [in] error Error of the operation ("0" on success, or one of "BDB_ERROR_*").
+ * @param [in] found Whether the record is found (by "exists" and "select" operations).
+ * @param [in] param Parameter, specified for the operation.
+ */
+typedef void (*completion_callback) (int error, bool found, void * param);
+
+/**
+ * Application-specified executor of completions of asynchronous operations (see "bdb::async_database::set_executor").
+ * The function must call "fn_run(arg)" once, on a thread of its choice (e.g. posting it to a reactor, which resumes
+ * a suspended coroutine or continuation), and must not block the calling worker thread.
+ *
+ * @param [in] fn_run Function, which completes the operation (its result and completion callback).
+ * @param [in] arg    Argument of the function.
+ * @param [in] param  Parameter, specified for the executor.
+ */
+typedef void (*executor_callback) (void (*fn_run) (void * arg), void * arg, void * param);
+
+/**
+ * Application-specified function to run in a transaction (see "bdb::database::run_in_transaction").
+ * The function can be called several times, if the transaction is retried.
+ *
+ * @param [in] txn   Transaction to use.
+ * @param [in] param Parameter, specified for the transaction.
+ */
+typedef void (*transaction_callback) (transaction * txn, void * param);
+
+/**
+ * Application-specified function to process records of parallel scan (see "bdb::table::parallel_scan").
+ * The function is called concurrently by several threads.
+ *
+ * @param [in] worker Number of calling thread (from 0).
+ * @param [in] key    "DBT" structure, referencing the primary key.
+ * @param [in] data   "DBT" structure, referencing the primary data.
+ * @param [in] param  Parameter, specified for the scan.
+ * @return 0 to continue the scan.
+ * @return A non-zero value to stop the scan.
+ */
+typedef int (*scan_callback) (int worker, const DBT * key, const DBT * data, void * param);
+
+/**
+ * Application-specified filter of records (see "bdb::recordset::set_filter").
+ * The function is called for each record before its data are unserialized, and decodes fields it needs from the view.
+ *
+ * @param [in] view  View of serialized data of the record.
+ * @param [in] param Parameter, specified for the filter.
+ * @return true  to return the record.
+ * @return false to skip the record.
+ */
+typedef bool (*filter_callback) (const record_view * view, void * param);
+
+/**
+ * Application-specified function to decode serialized key into state of comparison function (see "bdb::compare_state").
+ *
+ * @param [in] dbt "DBT" structure, referencing the serialized key.
+ * @return Decoded state.
+ */
+typedef void * (*state_callback) (const DBT * dbt);
+
+/**
+ * Application-specified function to free state of comparison function (see "bdb::compare_state").
+ *
+ * @param [in] state Decoded state.
+ */
+typedef void (*free_state_callback) (void * state);
+
+/**
+ * Application-specified handler of slow operations (see "bdb::database::set_slow_threshold").
+ * The function is called by the thread, which has performed the operation, and must not throw exceptions.
+ *
+ * @param [in] op    Record of the slow operation.
+ * @param [in] param Parameter, specified for the handler.
+ */
+typedef void (*slow_callback) (const slow_operation * op, void * param);
+
+/**
+ * Application-specified handler of change notifications of a table (see "bdb::table::subscribe").
+ * The function is called by notification thread of the database, once per committed transaction, which
+ * has changed the table, and must not throw exceptions (nor remove the table).
+ *
+ * @param [in] tbl     Changed table.
+ * @param [in] notices Changed records (the last change of each record in the transaction).
+ * @param [in] param   Parameter, specified for the subscription.
+ */
+typedef void (*notify_callback) (table * tbl, const vector <change_notice> & notices, void * param);
+
+//--------------------------------------------------------------------------------------------------
+//  Static functions.
+//--------------------------------------------------------------------------------------------------
+
+// Berkeley DB version.
+BDB_EXPORT void version (int * major, int * minor, int * patch = NULL);
+
+// Runtime logging.
+BDB_EXPORT int refresh_logging ();
+
+/** @defgroup serialization Serialization between Berkeley DB and Protocol Buffers. */
+//@{
+BDB_EXPORT void serialize   (const MessageLite * from, DBT * to);
+BDB_EXPORT void serialize   (const MessageLite * from, DBT * to, void * buffer, size_t size, bool compress = true);
+BDB_EXPORT void unserialize (const DBT * from, MessageLite * to);
+BDB_EXPORT Message * unserialize (const DBT * from, const Message * prototype, arena * to);
+BDB_EXPORT void release     (DBT * dbt);
+BDB_EXPORT void set_codec   (const value_codec * codec);
+BDB_EXPORT void set_cipher  (const value_cipher * cipher);
+
+BDB_EXPORT bool   should_compress  (size_t size);                                 /**< @private */
+BDB_EXPORT size_t compress_value   (const void * raw, size_t size, void * dest);  /**< @private */
+BDB_EXPORT bool   should_encrypt   ();                                            /**< @private */
+BDB_EXPORT size_t sealed_size      (size_t size);                                 /**< @private */
+BDB_EXPORT size_t encrypt_value    (const void * raw, size_t size, void * dest);  /**< @private */
+BDB_EXPORT const DBT * plain_value (const DBT * dbt);                             /**< @private */
+BDB_EXPORT size_t version_header   (unsigned int version, void * dest);          /**< @private */
+BDB_EXPORT unsigned int value_version (const DBT * dbt);                          /**< @private */
+
+BDB_EXPORT const Message * reflected (const MessageLite * msg);                    /**< @private */
+BDB_EXPORT Message       * reflected (MessageLite * msg);                          /**< @private */
+
+BDB_EXPORT void serialize_key   (const Message * from, DBT * to);
+BDB_EXPORT void serialize_key_prefix (const Message * from, DBT * to);
+BDB_EXPORT void unserialize_key (const DBT * from, Message * to);
+
+BDB_EXPORT void serialize_recno   (const Message * from, DBT * to);
+BDB_EXPORT void unserialize_recno (const DBT * from, Message * to);
+
+BDB_EXPORT void serialize_rid   (const Message * from, DBT * to);
+BDB_EXPORT void unserialize_rid (const DBT * from, Message * to);
+//@}
+
+/** @defgroup comparison Comparison and indexing of serialized ProtoBuf messages. */
+//@{
+BDB_EXPORT int compare_field (const DBT * dbt1, const DBT * dbt2, int field, int type);
+BDB_EXPORT int compare_single (const DBT * dbt1, const DBT * dbt2, int field, int type);
+BDB_EXPORT int compare_decoded (const decoded_field * f1, const decoded_field * f2, int type);  /**< @private */
+BDB_EXPORT int index_field   (const DBT * data, int field, int key_field, DBT * result);
+BDB_EXPORT int index_repeated (const DBT * data, int field, int key_field, DBT * result);
+BDB_EXPORT int index_value   (const field_value * value, int key_field, DBT * result);
+BDB_EXPORT int index_fields  (const DBT * data, const int * fields, const int * types, int count, DBT * result);
+BDB_EXPORT int index_words   (const DBT * data, int field, DBT * result);
+BDB_EXPORT uint64_t geo_key (double lat, double lon);                                  /**< @private */
+BDB_EXPORT bool geo_contains (const geo_box & box, uint64_t key);                      /**< @private */
+BDB_EXPORT void geo_ranges (const geo_box & box, size_t max, vector <pair <uint64_t, uint64_t> > * ranges);  /**< @private */
+BDB_EXPORT void split_words (const void * text, size_t size, vector <string> * words);  /**< @private */
+BDB_EXPORT void encode_word (const string & word, string * key);                       /**< @private */
+BDB_EXPORT int project_fields (const DBT * data, const int * fields, int count, DBT * result);
+BDB_EXPORT bool merge_append (const DBT * data, const DBT * delta, string * result, void * param);
+BDB_EXPORT bool merge_add    (const DBT * data, const DBT * delta, string * result, void * param);
+
+BDB_EXPORT bool extract_field  (const DBT * from, int field, field_value * value);
+BDB_EXPORT bool extract_field  (const DBT * from, int field, int64_t * value);
+BDB_EXPORT int  extract_fields (const DBT * from, const int * fields, int count, field_value * values);
+
+/**
+ * Keys comparison function, which compares keys by single field, decoding it straight from serialized data.
+ * No messages are constructed or parsed, so the function is much faster than one, which unserializes keys.
+ * Can be used wherever "compare_callback" is expected, e.g.:
+ *
+ * bdb::field_compare <month::key::kMonthFieldNumber, BDB_FIELD_STRING>
+ *
+ * @see compare_field
+ */
+template <int field, int type>
+int field_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    return compare_field(dbt1, dbt2, field, type);
+}
+
+/**
+ * Keys comparison function of keys of single field (see "bdb::compare_single"), which reads the field
+ * straight from the first bytes of the keys, e.g.:
+ *
+ * bdb::single_compare <month::ordnum_ix::kOrdnumFieldNumber, BDB_FIELD_INT64>
+ *
+ * Keys with the only field number 1 of the most common types are compared by built-in functions
+ * "bdb::int32_key_compare", "bdb::int64_key_compare", "bdb::uint64_key_compare",
+ * "bdb::string_key_compare", and "bdb::bytes_key_compare".
+ *
+ * @see compare_single
+ */
+template <int field, int type>
+int single_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    return compare_single(dbt1, dbt2, field, type);
+}
+
+BDB_EXPORT int int32_key_compare  (DB *, const DBT * dbt1, const DBT * dbt2);
+BDB_EXPORT int int64_key_compare  (DB *, const DBT * dbt1, const DBT * dbt2);
+BDB_EXPORT int uint64_key_compare (DB *, const DBT * dbt1, const DBT * dbt2);
+BDB_EXPORT int string_key_compare (DB *, const DBT * dbt1, const DBT * dbt2);
+BDB_EXPORT int bytes_key_compare  (DB *, const DBT * dbt1, const DBT * dbt2);
+
+BDB_EXPORT void * compare_state (const DBT * dbt, state_callback fn_decode, free_state_callback fn_free);
+
+/** Decoding function of "bdb::compare_state", which parses serialized key into message of type "T". */
+template <class T>
+void * parse_state (const DBT * dbt)
+{
+    T * key = new T;
+    unserialize(dbt, key);
+    return key;
+}
+
+/** Freeing function of "bdb::compare_state" for messages of type "T". */
+template <class T>
+void free_state (void * state)
+{
+    delete (T *) state;
+}
+
+/**
+ * Keys comparison function, which compares keys of type "T" by "fn_cmp", parsing them into messages.
+ * The application key ("dbt1") is parsed once per operation (see "bdb::compare_state"), e.g.:
+ *
+ * bdb::message_compare <month::key, compare_months>
+ */
+template <class T, int (*fn_cmp) (const T & key1, const T & key2)>
+int message_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    const T * key1 = (const T *) compare_state(dbt1, parse_state <T>, free_state <T>);
+
+    T key2;
+    unserialize(dbt2, &key2);
+
+    return fn_cmp(*key1, key2);
+}
+//@}
+
+/** @defgroup memory Memory allocation. */
+//@{
+BDB_EXPORT void set_allocator    (const allocator * alloc);
+BDB_EXPORT void set_memory_stats (bool enable);
+BDB_EXPORT void get_memory_stats (memory_stats * stats);
+//@}
+
+/** @defgroup latency Latency histograms. */
+//@{
+BDB_EXPORT void     set_latency_stats  (bool enable);
+BDB_EXPORT void     get_latency_stats  (int operation, latency_histogram * stats);
+BDB_EXPORT uint64_t latency_bound      (int bucket);
+BDB_EXPORT uint64_t latency_percentile (const latency_histogram * stats, double percentile);
+//@}
+
+/** @private */
+uint64_t monotonic_time ();
+
+/**
+ * @private Measures latency of an operation or a phase from construction until destruction of the scope,
+ * if latency histograms are enabled (see "bdb::set_latency_stats").
+ */
+class latency_scope
+{
+public:
+
+    latency_scope  (int operation);
+    ~latency_scope ();
+
+protected:
+
+    int      m_operation;   /**< @private Measured operation (see @ref latencyops "operations"). */
+    uint64_t m_start;       /**< @private Start time ("0" - the operation is not measured).     */
+};
+
+/**
+ * @private Scope of operation, which is reported when it takes longer than threshold of the database
+ * (see "bdb::database::set_slow_threshold").
+ */
+class slow_scope
+{
+public:
+
+    slow_scope  (database * db, int operation, const char * name);
+    ~slow_scope ();
+
+    inline void set_sizes (size_t key, size_t value) { m_key = key; m_value = value; }
+
+protected:
+
+    database   * m_database;    /**< @private Database of the operation.                            */
+    int          m_operation;   /**< @private Traced operation (see @ref latencyops "operations").  */
+    const char * m_name;        /**< @private Name of the table.                                    */
+    size_t       m_key;         /**< @private Size of serialized key.                               */
+    size_t       m_value;       /**< @private Size of serialized value.                             */
+    uint64_t     m_start;       /**< @private Start time ("0" - the operation is not traced).       */
+};
+
+/** @private Task of work pool (see "bdb::work_pool"). */
+typedef void (*task_callback) (void * param);
+
+/**
+ * @private Work-stealing pool of worker threads of database, shared by parallel operations of the library
+ * (parallel scans, cache warm-up, asynchronous operations), so they don't oversubscribe cores of the application.
+ * Each worker has its own deque of tasks: it runs its own tasks last in first out, and steals the oldest tasks
+ * of other workers when its deque is empty. The threads are started on first submitted task.
+ */
+class work_pool
+{
+public:
+
+    work_pool  (unsigned int nthreads, bool affinity, unsigned int first_cpu);
+    ~work_pool () throw ();
+
+    void submit  (task_callback fn_task, void * param);
+    bool run_one ();
+
+    unsigned int size () const;
+
+protected:
+
+    pool_state * m_state;   /**< @private Deques of tasks and worker threads. */
+};
+
+/**
+ * @private Group of tasks of work pool, which can be waited for. The waiting thread runs queued tasks meanwhile,
+ * so tasks can wait for groups of their own subtasks without exhausting the workers.
+ */
+class task_group
+{
+public:
+
+    task_group  (work_pool * pool);
+    ~task_group () throw ();
+
+    void run  (task_callback fn_task, void * param);
+    void wait ();
+
+protected:
+
+    work_pool   * m_pool;   /**< @private Pool, which runs the tasks.                   */
+    group_state * m_state;  /**< @private Number of incomplete tasks, and its condition. */
+};
+
+/**
+ * @private External merge sort of serialized records in order of keys of a table, within a memory budget.
+ * Added records are buffered; full buffers are sorted and spilled into temporary files (sorted runs) by tasks
+ * of the shared work pool, while next buffer is filled. Sorted records are read by k-way merge of the runs.
+ * Runs are written and read by large blocks, which are compressed by the codec (if specified).
+ * Methods return error codes of Berkeley DB or the system ("0" - success).
+ */
+class external_sorter
+{
+public:
+
+    external_sorter  (table * tbl, size_t memory, const value_codec * codec = NULL);
+    ~external_sorter () throw ();
+
+    int add    (const DBT * key, const DBT * data);
+    int finish ();
+    int next   (DBT * key, DBT * data);
+
+    uint64_t size () const;
+
+protected:
+
+    sort_state * m_state;   /**< @private Buffers, runs, and merging heap. */
+};
+
+/**
+ * @private Deliverer of change notifications of tables (see "bdb::table::subscribe").
+ * Changes are queued per Berkeley DB transaction; changes of committed nested transactions are merged into
+ * their parents, and changes of committed top-level transactions are delivered by a thread of its own
+ * (started on first subscription). Changes of aborted transactions are dropped.
+ */
+class notifier
+{
+public:
+
+    notifier  ();
+    ~notifier () throw ();
+
+    void subscribe   (table * tbl, notify_callback fn_notify, void * param, bool values);
+    void unsubscribe (table * tbl, notify_callback fn_notify, void * param);
+    void forget      (table * tbl);
+    void drain       ();
+    void shutdown    ();
+
+    bool active () const;
+
+    void add    (DB_TXN * txn, table * tbl, const DBT * key, const DBT * data, bool values);
+    void begin  (DB_TXN * txn, DB_TXN * parent);
+    void commit (DB_TXN * txn, DB_TXN * root);
+    void abort  (DB_TXN * txn);
+
+protected:
+
+    notify_state * m_state; /**< @private Subscriptions, queued changes, and delivering thread. */
+};
+
+/** @private */
+void* malloc  (size_t size);
+/** @private */
+void* realloc (void * ptr, size_t size);
+/** @private */
+void  free    (void * ptr);
+
+/**
+ * @private Layout of serialized messages of some type, made once per type by reflection:
+ * non-repeated scalar fields in order of their numbers, with their tags on the wire.
+ * Messages are compared by these fields in this order, decoding them straight from serialized data,
+ * so tables of types, known at run time only, don't need generated comparison functions.
+ */
+class message_layout
+{
+public:
+
+    static const message_layout * get (const Descriptor * type);
+
+    int compare (const DBT * dbt1, const DBT * dbt2) const;
+
+protected:
+
+    message_layout (const Descriptor * type);
+
+    void decode (const DBT * dbt, decoded_field * values) const;
+
+protected:
+
+    /** @private Field of the layout. */
+    struct layout_field
+    {
+        int      number;    /**< @private Field number.                                */
+        int      type;      /**< @private Field type (see @ref fieldtypes "types").     */
+        uint32_t tag;       /**< @private Tag of the field on the wire.                 */
+    };
+
+    vector <layout_field> m_fields;     /**< @private Fields in order of their numbers. */
+};
+
+/**
+ * @private Scope of temporary buffers, allocated from per-thread scratch arena.
+ * The arena is reset when the outermost scope of the thread ends.
+ */
+class scratch_scope
+{
+public:
+
+    scratch_scope  ();
+    ~scratch_scope () throw ();
+
+    void * alloc     (size_t size);
+    void   serialize (const MessageLite * from, DBT * to, bool compress = true);
+
+protected:
+
+    scratch_arena * m_arena;    /**< @private Arena of the current thread. */
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Static variables.
+//--------------------------------------------------------------------------------------------------
+
+/** @private Cached log level of library's logger ("-1" - not cached yet, see "bdb::refresh_logging"). */
+BDB_EXPORT extern volatile int log_level;
+
+/** @private Returns library's log4cplus logger, which is looked up once, on first use. */
+BDB_EXPORT log4cplus::Logger & library_logger ();
+
+/**
+ * @private Library's logger.
+ * Rejects messages below cached log level without asking log4cplus, which walks the loggers hierarchy.
+ * The port has no state, so it needs no initialization, and log4cplus logger is looked up on first message.
+ */
+class log_port
+{
+public:
+
+    inline bool isEnabledFor (log4cplus::LogLevel ll) const
+    {
+        int level = log_level;
+        if (level < 0) level = refresh_logging();
+
+        return (ll >= level);
+    }
+
+    inline void forcedLog (log4cplus::LogLevel ll, const log4cplus::tstring & message, const char * file = NULL, int line = -1) const
+    {
+        library_logger().forcedLog(ll, message, file, line);
+    }
+
+    inline log4cplus::LogLevel getChainedLogLevel () const
+    {
+        return library_logger().getChainedLogLevel();
+    }
+};
+
+/** @private Library's logger. */
+BDB_EXPORT extern const log_port logger;
+
+//--------------------------------------------------------------------------------------------------
+//  BDB classes.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * BDB exception.
+ */
+class exception
+{
+public:
+
+    BDB_EXPORT exception  (int error);     /**< @private */
+    BDB_EXPORT ~exception () throw ();     /**< @private */
+
+    /**
+     * @return Exception's error code.
+     */
+    inline int error () { return m_error; }
+
+protected:
+
+    int m_error;    /**< @private */
+};
+
+/**
+ * Key of a record, given either as a message, or as a key, serialized in advance (see "bdb::prepared_key").
+ * Converted implicitly from both, so a prepared key is passed wherever a key message is expected.
+ */
+class key_ref
+{
+public:
+
+    /** Refers to key message (of full or "LITE_RUNTIME" type). */
+    key_ref (const MessageLite * key) : m_message(key), m_prepared(NULL), m_data(NULL), m_size(0) { }
+
+    /** Refers to prepared key. */
+    key_ref (const prepared_key * key) : m_message(NULL), m_prepared(key), m_data(NULL), m_size(0) { }
+
+    /** Refers to raw bytes of the key, already in format of the table (see "bdb::raw_key"). */
+    key_ref (const void * data, size_t size) : m_message(NULL), m_prepared(NULL), m_data(data), m_size(size) { }
+
+    const MessageLite  * m_message;     /**< @private Key message ("NULL" if the key is prepared or raw). */
+    const prepared_key * m_prepared;    /**< @private Prepared key ("NULL" if it's a message or raw).     */
+    const void         * m_data;        /**< @private Raw bytes of the key ("NULL" if they aren't given). */
+    size_t               m_size;        /**< @private Size of raw bytes.                                  */
+};
+
+/**
+ * Key, serialized once in format of a table or an index, for repeated lookups. Can be passed to operations
+ * of the same table (or index) instead of key message, so the key is not serialized by each of them.
+ */
+class prepared_key
+{
+    friend class table;
+    friend class recordset;
+
+public:
+
+    BDB_EXPORT prepared_key (table * tbl, const MessageLite * key);
+    BDB_EXPORT prepared_key (index * idx, const MessageLite * key);
+
+    BDB_EXPORT void reset (const MessageLite * key);
+
+protected:
+
+    void prepare (const MessageLite * key);     /**< @private */
+
+protected:
+
+    table * m_table;    /**< @private Table (or index), the key is serialized for. */
+    string  m_key;      /**< @private Serialized key.                              */
+};
+
+/**
+ * Tuning options of database environment.
+ * Zero value of any option means Berkeley DB default.
+ */
+struct database_options
+{
+    BDB_EXPORT database_options ();
+
+    unsigned int cache_gbytes;      /**< Size of shared memory cache, gigabytes part.           */
+    unsigned int cache_bytes;       /**< Size of shared memory cache, bytes part.               */
+    int          cache_regions;     /**< Number of cache regions the cache is split into.       */
+    unsigned int log_buffer;        /**< Size of in-memory log buffer, in bytes.                */
+    unsigned int max_locks;         /**< Maximum number of locks.                               */
+    unsigned int max_lockers;       /**< Maximum number of lockers.                             */
+    unsigned int max_objects;       /**< Maximum number of locked objects.                      */
+    int          deadlocks;         /**< Policy of deadlock detector (see @ref deadlocks "policies"). */
+    bool         auto_commit;       /**< Whether operations outside of transactions are committed one by one. */
+    int          repl_role;         /**< Role in replication group (see @ref replroles "roles"); replicas should auto-commit. */
+    const char * repl_local;        /**< Address of the local site ("host:port").                               */
+    const char ** repl_remote;      /**< "NULL"-terminated list of addresses of other sites ("host:port").       */
+    unsigned int repl_priority;     /**< Priority of the site in elections ("0" - never becomes the master).    */
+    unsigned int repl_threads;      /**< Number of threads, processing replication messages ("0" - one thread). */
+    unsigned int checkpoint_minutes;    /**< Background checkpoint interval, in minutes ("0" - no interval).    */
+    unsigned int checkpoint_kbytes;     /**< Written log, which triggers background checkpoint, in kilobytes ("0" - no limit). */
+    bool         remove_logs;       /**< Whether background checkpoints remove log files, which are no longer needed. */
+    int          recovery;          /**< Recovery on opening (see @ref recovery "modes"); only one process may open the database while it runs. */
+    bool         in_memory;         /**< Whether the database is private to the process, and is kept in memory only (lost on closing). */
+    bool         concurrent;        /**< Whether to use concurrent data store (single writer, no transactions and recovery). */
+    unsigned int worker_threads;    /**< Number of threads of shared work pool of parallel operations ("0" - one per core). */
+    bool         worker_affinity;   /**< Whether each worker thread is bound to its own CPU (where supported).    */
+    unsigned int worker_first_cpu;  /**< CPU of the first worker thread; the next ones take the next CPUs (modulo number of CPUs). */
+    bool         direct_db;         /**< Whether database files bypass the system cache ("DB_DIRECT_DB", where supported).  */
+    bool         direct_log;        /**< Whether log files bypass the system cache ("DB_LOG_DIRECT", where supported).      */
+    bool         log_dsync;         /**< Whether log is written synchronously ("O_DSYNC"), instead of being flushed by "fsync". */
+    size_t       mmap_size;         /**< Maximum size of read-only file, which is mapped into memory instead of the cache, in bytes. */
+    bool         read_only;         /**< Whether existing database is opened read-only, without transactions and locks (private environment). */
+    unsigned int cursor_cache;      /**< Number of closed cursors of recordsets, kept by each thread for reuse in the same transaction ("0" - none). */
+    bool         multi_process;     /**< Whether several processes share the environment at once, and dead ones are detected (processes should auto-commit). */
+    long         shm_key;           /**< Base key of system shared memory segments of the regions ("0" - regions are files in the home). */
+    unsigned int max_threads;       /**< Maximum number of threads of all processes, which are tracked to detect dead ones ("0" - default). */
+    const char * log_dir;           /**< Directory of log files, e.g. on a device of its own ("NULL" - home directory). */
+    const char ** data_dirs;        /**< "NULL"-terminated list of directories of database files, the first is the default ("NULL" - home directory). */
+    const char * tmp_dir;           /**< Directory of temporary files, e.g. of the cache overflow ("NULL" - system default). */
+    uint64_t     memory_budget;     /**< Memory of the database, split between cache, Bloom filters, buffers and caches of records, in bytes ("0" - no budget). */
+    unsigned int mpool_percent;     /**< Part of the budget, taken by the cache, unless its size is specified, in percents ("0" - half). */
+    bool         huge_pages;        /**< Whether regions in system shared memory (see "shm_key") are backed by huge pages (Linux only). */
+    int          numa_policy;       /**< Placement of shared regions on NUMA nodes (see @ref numapolicies "policies", Linux only). */
+    const char * encrypt_password;  /**< Password of AES encryption of the log and of encrypted tables by Berkeley DB ("NULL" - no encryption), the same on each opening. */
+    bool         fast_shutdown;     /**< Whether dirty pages are written in background on closing, and handles are closed without flushing them one by one. */
+    unsigned int trickle_percent;   /**< Percentage of clean pages of the cache, kept by background writer of dirty pages ("0" - no writer). */
+};
+
+/**
+ * Tuning options of database table.
+ * Zero value of any option means Berkeley DB default.
+ */
+struct table_options
+{
+    BDB_EXPORT table_options ();
+
+    unsigned int        page_size;      /**< Size of database pages, in bytes (from 512 to 65536).  */
+    int                 key_format;     /**< Format of keys (see @ref keyformats "formats"), used by indexes of the table as well. */
+    bool                multiversion;   /**< Whether to keep multiple versions of pages for snapshot transactions. */
+    int                 access_method;  /**< Access method (see @ref accessmethods "methods"), the same as the table was created with. */
+    unsigned int        record_length;  /**< Length of records in queue tables, in bytes (shorter data are padded). */
+    bool                compression;    /**< Whether records of Btree table are compressed (Berkeley DB 4.8 or later), the same on each opening. */
+    compress_callback   fn_compress;    /**< Compression function ("NULL" - prefix compression of Berkeley DB). */
+    decompress_callback fn_decompress;  /**< Decompression function (required with compression function).      */
+    unsigned int        cache_records;  /**< Capacity of in-process cache of selected records ("0" - no cache). */
+    unsigned int        bloom_bits;     /**< Bits per key of in-memory Bloom filter of keys for "bdb::table::exists" ("0" - no filter). */
+    unsigned int        partitions;     /**< Number of partitions of Btree or hash table (Berkeley DB 4.8 or later, "0" - not partitioned), the same on each opening. */
+    const keylist     * partition_keys; /**< Ascending keys, which start partitions after the first one ("partitions - 1" keys), or "NULL". */
+    partition_callback  fn_partition;   /**< Partitioning function (required without partition keys).             */
+    const char       ** partition_dirs; /**< "NULL"-terminated list of directories of partitions ("NULL" - home directory). */
+    bool                lazy_open;      /**< Whether existing table is opened on first use, instead of on construction. */
+    bool                profile_callbacks;  /**< Whether calls and time of comparison and indexing functions are counted (see "bdb::table::stats"). */
+    const Descriptor  * key_type;       /**< Type of keys, compared by reflection if there is no comparison function (see "bdb::message_layout"). */
+    bool                read_only;      /**< Whether existing table is opened read-only, so it can be mapped into memory (see "bdb::database_options::mmap_size"). */
+    bool                capture_changes;    /**< Whether changes of records are captured into change log of the database (see "bdb::change_stream"). */
+    compare_callback    fn_dup_compare; /**< Comparison of primary keys within duplicate sets of indexes ("NULL" - keys comparison function), the same on each opening. */
+    bool                dup_bytewise;   /**< Whether primary keys within duplicate sets of indexes are sorted by Berkeley DB itself, by their bytes (the same on each opening). */
+    int                 ttl_field;      /**< Field of data of type "int64" with time of the record, in seconds since the epoch ("0" - records never expire). */
+    unsigned int        ttl;            /**< Time to live of records after time of their field, in seconds ("0" - the field is expiration time itself). */
+    int                 cache_priority; /**< Priority of pages of the table in the cache (see @ref cachepriorities "priorities"); indexes have their own one (see "bdb::index::set_cache_priority"). */
+    unsigned int        hot_sampling;   /**< Period of sampling of accessed keys, each thread counts every N-th one (see "bdb::table::hot_keys", "0" - no sampling). */
+    bool                distinct_sketch;    /**< Whether indexes of the table keep sketches of their distinct keys, persisted in the database (see "bdb::index::estimate_distinct"). */
+    const char        * data_dir;       /**< One of data directories of the database, where new files of the table and its indexes are created (Berkeley DB 4.8 or later, "NULL" - the first one). */
+    unsigned int        schema_version; /**< Current version of schema of data, which tags written values, so older ones are upgraded on read (see "bdb::table::add_upgrade", "0" - values are not tagged). */
+    bool                encrypted;      /**< Whether pages of the table and its indexes are encrypted by Berkeley DB (see "bdb::database_options::encrypt_password"), the same on each opening. */
+    unsigned int        blob_threshold; /**< Size of data, which are stored in external files instead of pages of the table, in bytes (Berkeley DB 6.0 or later, "0" - never). */
+};
+
+/**
+ * Options of online compaction of table or index (see "bdb::table::compact").
+ * Zero value of fill percent means Berkeley DB default, zero budget means no limit.
+ */
+struct compact_options
+{
+    BDB_EXPORT compact_options ();
+
+    unsigned int fill_percent;  /**< Desired fill factor of Btree pages, in percents (from 1 to 100).              */
+    unsigned int step_pages;    /**< Maximum number of pages, freed by each step in its own transaction ("0" - all). */
+    unsigned int max_pages;     /**< Budget of freed pages of the whole compaction.                               */
+    unsigned int timeout;       /**< Budget of time of the whole compaction, in milliseconds (checked between steps). */
+    bool         free_space;    /**< Whether freed pages at the end of the file are returned to the file system.  */
+};
+
+/**
+ * Options of sampling recordset of table or index (see "bdb::recordset::recordset").
+ * Samples are split equally between strata of equal numbers of records, so each part of key space is sampled.
+ */
+struct sample_options
+{
+    BDB_EXPORT sample_options ();
+
+    unsigned int count;     /**< Number of sampled records.                                 */
+    unsigned int strata;    /**< Number of strata ("0" or "1" - samples are not stratified). */
+    uint64_t     seed;      /**< Seed of random positions ("0" - random seed).              */
+};
+
+/**
+ * Index of table, opened with the table (see "bdb::table_spec").
+ */
+struct index_spec
+{
+    const char        * name;       /**< Name of the index.                                       */
+    index_callback      fn_idx;     /**< Indexing function (see "bdb::table::add_index").          */
+    compare_callback    fn_cmp;     /**< Index comparision function.                               */
+    bool                unique;     /**< Whether new index should contain unique keys only.        */
+    bool                immutable;  /**< Whether index keys of a record never change on update.    */
+};
+
+/**
+ * Table with its indexes, opened together with other tables (see "bdb::database::add_tables").
+ */
+struct table_spec
+{
+    const char          * name;     /**< Name of the table.                                        */
+    compare_callback      fn_cmp;   /**< Keys comparision function.                                */
+    bool                  create;   /**< Whether to create the table if it doesn't exist.          */
+    table_options         options;  /**< Tuning options of the table.                              */
+    vector <index_spec>   indexes;  /**< Indexes of the table.                                     */
+};
+
+/**
+ * User database.
+ */
+class database
+{
+    friend class transaction;
+    friend class sequence;
+    friend class id_generator;
+    friend class table;
+    friend class index;
+    friend class recordset;
+    friend class write_batch;
+    friend class value_stream;
+    friend class partitioned_table;
+    friend class slow_scope;
+    friend class async_database;
+    friend class table_builder;
+    friend class external_sorter;
+    friend class change_stream;
+    friend class materialized_aggregate;
+    friend class column_store;
+    friend class index_applier;
+    friend class expiry_reaper;
+    friend class buffered_table;
+    friend class series_table;
+    friend class verify_job;
+    friend class table_opener;
+    friend class table_join;
+
+    friend uint64_t dump (table * tbl, std::ostream & out, bool compress, transaction * txn);
+
+public:
+
+    BDB_EXPORT database  (const char * home, bool create = false, const database_options & options = database_options());
+    BDB_EXPORT ~database () throw ();
+
+    BDB_EXPORT sequence * add_sequence (const char * name, bool create = false, int cache = 0, bool autonomous = false);
+    BDB_EXPORT id_generator * add_generator (const char * name, unsigned int node);
+    BDB_EXPORT table    * add_table    (const char * name,
+                                        compare_callback fn_cmp,
+                                        bool create = false,
+                                        const table_options & options = table_options());
+    BDB_EXPORT void       remove_table (table * tbl);
+    BDB_EXPORT table    * get_table    (const char * name) const;
+    BDB_EXPORT void       add_tables   (const vector <table_spec> & specs, vector <table*> * tables = NULL, unsigned int nthreads = 4);
+
+    BDB_EXPORT void begin_transaction    ();
+    BDB_EXPORT void commit_transaction   ();
+    BDB_EXPORT void rollback_transaction ();
+
+    BDB_EXPORT void set_savepoint      ();
+    BDB_EXPORT void release_savepoint  ();
+    BDB_EXPORT void rollback_savepoint ();
+
+    BDB_EXPORT void run_in_transaction (transaction_callback fn_txn, void * param = NULL, unsigned int max_retries = 3);
+
+    BDB_EXPORT void set_durability (int policy, unsigned int window = 0, unsigned int size = 0);
+
+    BDB_EXPORT bool is_master    ();
+    BDB_EXPORT bool wait_applied (const commit_token & token, unsigned int timeout = 0);
+
+    BDB_EXPORT void checkpoint (bool remove_logs = false);
+    BDB_EXPORT void backup     (const char * target, bool update = false);
+
+    BDB_EXPORT void check_failures ();
+
+    BDB_EXPORT void stats (database_stats * result, bool clear = false);
+    BDB_EXPORT void stats (budget_stats * result);
+
+    BDB_EXPORT void         save_cache_snapshot ();
+    BDB_EXPORT unsigned int warm_cache          (unsigned int nthreads = 4);
+
+    BDB_EXPORT uint64_t verify (unsigned int nthreads = 4, vector <verify_issue> * issues = NULL);
+
+    BDB_EXPORT void set_slow_threshold (unsigned int threshold, slow_callback fn_slow = NULL, void * param = NULL);
+
+    BDB_EXPORT void trim_changes (uint64_t sequence);
+
+    BDB_EXPORT void wait_notifications ();
+
+protected:
+
+    DB_TXN * get_transaction (transaction * txn = NULL);                /**< @private */
+    int      begin_txn       (DB_TXN * parent, DB_TXN ** txn, int durability, int flags = BDB_TXN_DEFAULT); /**< @private */
+    int      commit_txn      (DB_TXN * txn, int durability, bool nested);      /**< @private */
+    int      abort_txn       (DB_TXN * txn);                    /**< @private */
+    u_int32_t read_flags     (transaction * txn = NULL);        /**< @private */
+    u_int32_t write_flags    ();                                /**< @private */
+    int      open_file       (DB * db, DB_TXN * txn, const string & file, const string & name, int type, u_int32_t flags);  /**< @private */
+    int      remove_file     (DB_TXN * txn, const string & file, const string & name);  /**< @private */
+    int      rename_file     (DB_TXN * txn, const string & file, const string & name, const string & newfile, const string & newname);  /**< @private */
+    int      open_changes    ();                                /**< @private */
+    int      append_change   (DB_TXN * txn, const string & table, const DBT * key, const DBT * olddata, const DBT * newdata);  /**< @private */
+    int      last_change     (uint64_t * sequence);             /**< @private */
+    int      begin_auto      (DB_TXN ** txn, DB_TXN ** own);    /**< @private */
+    int      end_auto        (DB_TXN * own, int res);          /**< @private */
+    int      start_replication (const database_options & options);  /**< @private */
+    int      place_regions   (const database_options & options);    /**< @private */
+    void     release_regions ();                                /**< @private */
+    unsigned int txn_depth   ();                                /**< @private */
+    DB_TXN * local_transaction ();                              /**< @private */
+    int      open_cursor     (DB * db, transaction * txn, DBC ** cursor);  /**< @private */
+    int      open_autonomous ();                                /**< @private */
+    int      open_histograms ();                                /**< @private */
+    void     close_cursor    (DBC * cursor);                    /**< @private */
+    void   * take_buffer     (size_t * size);                   /**< @private */
+    bool     give_buffer     (DBT * dbt);                       /**< @private */
+
+    static void on_event (DB_ENV * env, u_int32_t event, void * info);  /**< @private */
+
+protected:
+
+    string               m_home;        /**< @private Home path of the database.                    */
+    DB_ENV             * m_env;         /**< @private DB environment.                               */
+    DB                 * m_seq;         /**< @private Sequences database.                           */
+    DB                 * m_seqc;        /**< @private Database of cached sequences (opened on demand). */
+    DB                 * m_histograms;  /**< @private Database of histograms of keys of tables (opened on demand). */
+    DB                 * m_changes;     /**< @private Change log of captured changes (opened on demand). */
+    DB_TXN             * m_txn;         /**< @private Top-level transaction.                        */
+    txn_stacks         * m_txns;        /**< @private Per-thread stacks of nested transactions.     */
+    int                  m_durability;  /**< @private Default durability policy of transactions.    */
+    group_commit       * m_group;       /**< @private Coordinator of group commits.                 */
+    maintenance        * m_maintenance; /**< @private Background maintenance ("NULL" if none).   */
+    trickle_writer     * m_trickle;     /**< @private Background writer of dirty pages ("NULL" if none). */
+    work_pool          * m_pool;        /**< @private Shared pool of worker threads of parallel operations. */
+    notifier           * m_notifier;    /**< @private Deliverer of change notifications of tables.  */
+    index_applier      * m_applier;     /**< @private Background worker of deferred indexes.         */
+    expiry_reaper      * m_reaper;      /**< @private Background remover of expired records.         */
+    cursor_pool        * m_cursors;     /**< @private Per-thread caches of closed cursors ("NULL" if disabled). */
+    memory_governor    * m_governor;    /**< @private Memory budget of the library ("NULL" if no budget). */
+    bool                 m_memory;      /**< @private Whether the database is kept in memory only.  */
+    bool                 m_concurrent;  /**< @private Whether the database has no transactions (concurrent data store, or read-only). */
+    bool                 m_readonly;    /**< @private Whether the database is opened read-only.     */
+    bool                 m_fast_shutdown;   /**< @private Whether the database is closed without flushes of separate handles. */
+    u_int32_t            m_close_flags; /**< @private Flags of closing of handles ("DB_NOSYNC" on fast shutdown). */
+    volatile int         m_role;        /**< @private Current role in replication group (master, if not replicated). */
+    volatile uint64_t    m_slow;        /**< @private Threshold of slow operations, in nanoseconds ("0" - disabled). */
+    slow_callback        m_slow_callback;   /**< @private Handler of slow operations ("NULL" - logging). */
+    void               * m_slow_param;  /**< @private Parameter of the handler.                     */
+    vector <sequence*>   m_sequences;   /**< @private List of database sequences.                   */
+    vector <id_generator*> m_generators;    /**< @private List of generators of time-ordered IDs.   */
+    vector <table*>      m_tables;      /**< @private List of database tables.                      */
+    std::map <string, table*> m_names;  /**< @private Database tables by their names.               */
+};
+
+/**
+ * Database transaction.
+ * The transaction is rolled back on destruction, unless it has been committed or rolled back explicitly.
+ */
+class transaction
+{
+    friend class database;
+
+public:
+
+    BDB_EXPORT transaction  (database * db, transaction * parent = NULL, int durability = BDB_DURABILITY_DEFAULT, int flags = BDB_TXN_DEFAULT);
+    BDB_EXPORT ~transaction () throw ();
+
+    BDB_EXPORT void commit   ();
+    BDB_EXPORT void commit   (commit_token * token);
+    BDB_EXPORT void rollback ();
+
+    BDB_EXPORT void set_timeout (unsigned int lock_timeout, unsigned int txn_timeout = 0);
+
+protected:
+
+    database * m_database;      /**< @private Master database.                                     */
+    DB_TXN   * m_txn;           /**< @private Transaction ("NULL" when it's committed/rolled back). */
+    int        m_durability;    /**< @private Durability policy.                                   */
+    int        m_flags;         /**< @private Flags of the transaction.                            */
+    bool       m_nested;        /**< @private Whether the transaction has a parent.                */
+};
+
+/**
+ * Read-only snapshot of the database.
+ * The snapshot is a top-level transaction, which reads committed data as of its start without read locks,
+ * so long scans of recordsets, bound to it, don't block writers (tables must be multiversion).
+ */
+class snapshot : public transaction
+{
+public:
+
+    BDB_EXPORT snapshot  (database * db);
+};
+
+/**
+ * Sequence of autogenerating unique IDs.
+ */
+class sequence
+{
+    friend class database;
+
+protected:
+
+    sequence  (database * db, const char * name, bool create = false, int cache = 0, bool autonomous = false);
+    ~sequence () throw ();
+
+public:
+
+    BDB_EXPORT int64_t id  (transaction * txn = NULL);
+    BDB_EXPORT int64_t ids (int n, transaction * txn = NULL);
+
+protected:
+
+    int get (int delta, int64_t * id, transaction * txn);  /**< @private */
+
+protected:
+
+    database    * m_database;   /**< @private Master database.                */
+    DB_SEQUENCE * m_seq;        /**< @private A sequence.                     */
+    int           m_cache;      /**< @private Number of cached identifiers.   */
+    bool          m_autonomous; /**< @private Whether identifiers are allocated outside of transactions. */
+};
+
+/**
+ * Generator of time-ordered 64-bit IDs, unique across nodes without any coordination (see "bdb::database::add_generator").
+ * An ID consists of milliseconds since 2020-01-01 UTC (41 bits), number of the node (10 bits), and a counter
+ * within the millisecond (12 bits), so IDs of all nodes are sorted by their time, and are appended to btrees.
+ * IDs are generated in memory, and the generator only persists the time it has reserved IDs up to (once in several
+ * seconds), so IDs, generated after a crash (or after the clock is set back), are still greater than previous ones.
+ */
+class id_generator
+{
+    friend class database;
+
+protected:
+
+    id_generator  (database * db, const char * name, unsigned int node);
+    ~id_generator () throw ();
+
+public:
+
+    BDB_EXPORT int64_t id ();
+
+protected:
+
+    int take_block (generator_block * block);   /**< @private */
+    int reserve    (uint64_t until);            /**< @private */
+
+protected:
+
+    database        * m_database;   /**< @private Master database.                        */
+    string            m_key;        /**< @private Key of reserved time in the database.   */
+    unsigned int      m_node;       /**< @private Number of the node.                     */
+    generator_state * m_state;      /**< @private Current time and counter, and blocks of counters of all threads. */
+};
+
+/**
+ * Database table.
+ */
+class table
+{
+    friend class database;
+    friend class index;
+    friend class recordset;
+    friend class key_order;
+    friend class key_less;
+    friend class write_batch;
+    friend class value_stream;
+    friend class prepared_key;
+    friend class sharded_table;
+    friend class merged_recordset;
+    friend class merge_greater;
+    friend class table_builder;
+    friend class external_sorter;
+    friend class sort_order;
+    friend class sort_greater;
+    friend class notifier;
+    friend class materialized_aggregate;
+    friend class column_store;
+    friend class deferred_less;
+    friend class reaper_state;
+    friend class expiry_less;
+    friend class buffered_table;
+    friend class series_table;
+    friend class verify_job;
+    friend class table_opener;
+    friend class buffer_less;
+    friend class memory_governor;
+    friend class governor_state;
+    friend class table_join;
+
+    friend uint64_t dump (table * tbl, std::ostream & out, bool compress, transaction * txn);
+    friend class join_less;
+
+protected:
+
+    table  (const char * name);
+    table  (database * db, const char * name, compare_callback fn_cmp, bool create, const table_options & options);
+    ~table () throw ();
+
+public:
+
+    BDB_EXPORT index * add_index (const char * name,
+                                  index_callback fn_idx,
+                                  compare_callback fn_cmp,
+                                  bool unique = false,
+                                  bool immutable = false);
+
+    BDB_EXPORT index * add_index (const char * name,
+                                  index_callback fn_idx,
+                                  compare_callback fn_cmp,
+                                  project_callback fn_proj,
+                                  bool unique = false,
+                                  bool immutable = false);
+
+    BDB_EXPORT index * add_index (const char * name,
+                                  int field,
+                                  int key_field,
+                                  compare_callback fn_cmp,
+                                  bool unique = false,
+                                  bool immutable = false,
+                                  bool repeated = false);
+
+    BDB_EXPORT index * add_index (const char * name,
+                                  const int * fields,
+                                  const int * types,
+                                  int count,
+                                  bool unique = false,
+                                  bool immutable = false);
+
+    BDB_EXPORT index * add_index (const char * name,
+                                  const FieldDescriptor * field,
+                                  const Descriptor * key_type,
+                                  bool unique = false,
+                                  bool immutable = false);
+
+    BDB_EXPORT index * add_text_index (const char * name, int field);
+
+    BDB_EXPORT index * add_geo_index (const char * name, int lat_field, int lon_field, int type = BDB_FIELD_DOUBLE);
+
+    BDB_EXPORT index * add_deferred_index (const char * name,
+                                           index_callback fn_idx,
+                                           compare_callback fn_cmp);
+
+    BDB_EXPORT materialized_aggregate * add_aggregate (const char * name, aggregate_callback fn_agg);
+    BDB_EXPORT materialized_aggregate * add_aggregate (const char * name, int field, int type = BDB_FIELD_INT64, int group = 0);
+
+    BDB_EXPORT column_store * add_columns (const char * name, const int * fields, const int * types, int count, unsigned int rows = 1024);
+
+    BDB_EXPORT void     add_upgrade (unsigned int version, upgrade_callback fn_upgrade);
+    BDB_EXPORT uint64_t migrate     (unsigned int batch = 1000, unsigned int pause = 0);
+
+    BDB_EXPORT bool exists (key_ref key,                       transaction * txn = NULL);
+    BDB_EXPORT void remove (key_ref key,                       transaction * txn = NULL);
+    BDB_EXPORT void insert (key_ref key, const MessageLite * data, transaction * txn = NULL);
+    BDB_EXPORT void update (key_ref key, const MessageLite * data, transaction * txn = NULL);
+    BDB_EXPORT void append_bytes (key_ref key, const MessageLite * fragment, transaction * txn = NULL);
+    BDB_EXPORT bool upsert (key_ref key, const MessageLite * data, transaction * txn = NULL);
+    BDB_EXPORT bool modify (key_ref key, Message * data, modify_callback fn_mod, void * param = NULL, transaction * txn = NULL);
+    BDB_EXPORT bool merge  (key_ref key, const MessageLite * delta, merge_callback fn_merge = merge_append, void * param = NULL, transaction * txn = NULL);
+
+    BDB_EXPORT int try_insert (key_ref key, const MessageLite * data, transaction * txn = NULL);
+
+    BDB_EXPORT uint64_t insert (const MessageLite * data, transaction * txn = NULL);
+    BDB_EXPORT uint64_t insert_auto (sequence * seq, const MessageLite * data, Message * key, transaction * txn = NULL);
+    BDB_EXPORT int try_remove (key_ref key,                         transaction * txn = NULL);
+
+    BDB_EXPORT void insert_bulk (const bulklist & records, transaction * txn = NULL, unsigned int chunk = 0);
+    BDB_EXPORT void remove_many (const keylist & keys, transaction * txn = NULL, unsigned int chunk = 0);
+    BDB_EXPORT unsigned int remove_range (const Message * lower, const Message * upper, transaction * txn = NULL, unsigned int chunk = 0);
+
+    BDB_EXPORT void select (key_ref key, MessageLite * data, transaction * txn = NULL);
+    BDB_EXPORT bool find   (key_ref key, MessageLite * data, transaction * txn = NULL);
+    BDB_EXPORT void select_stream (key_ref key, Message * data, transaction * txn = NULL, unsigned int chunk = 0);
+    BDB_EXPORT void select_many (const keylist & keys, const datalist & data, vector <bool> * found, transaction * txn = NULL);
+
+    BDB_EXPORT unsigned int count (bool fast = false, transaction * txn = NULL);
+    BDB_EXPORT void estimate_range (const Message * lower, const Message * upper, key_estimate * result, transaction * txn = NULL);
+    BDB_EXPORT void stats (table_stats * result, bool fast = false, transaction * txn = NULL);
+    BDB_EXPORT void footprint (table_footprint * result, unsigned int samples = 64);
+
+    BDB_EXPORT void set_hot_sampling (unsigned int period);
+    BDB_EXPORT void hot_keys (vector <hot_key> * keys, unsigned int count = 10);
+
+    BDB_EXPORT bool analyze (unsigned int buckets = 64, double staleness = 0.0);
+    BDB_EXPORT bool get_histogram (key_histogram * result);
+
+    BDB_EXPORT void parallel_scan (unsigned int nthreads, scan_callback fn_scan, void * param = NULL);
+
+    BDB_EXPORT void compact (const compact_options & options = compact_options(), compact_result * result = NULL);
+
+    BDB_EXPORT void set_cache_priority (int priority);
+    BDB_EXPORT void clear_cache ();
+
+    BDB_EXPORT void subscribe   (notify_callback fn_notify, void * param = NULL, bool values = false);
+    BDB_EXPORT void unsubscribe (notify_callback fn_notify, void * param = NULL);
+
+protected:
+
+    /** @private */
+    inline string get_filename () { return m_name + ".db"; }
+
+    /** @private */
+    inline void check_open () { if (m_lazy) open_lazy(); }
+
+    /** @private */
+    inline void sample_key (const DBT * key) { if (m_sampler != NULL) sample_hot(key); }
+
+    void open_db    (bool create, DB_TXN * txn);            /**< @private */
+    void open_lazy  ();                                     /**< @private */
+    void sample_hot (const DBT * key);                      /**< @private */
+    void encode_key (const MessageLite * key, DBT * dbt, scratch_scope * scope = NULL);  /**< @private */
+    void encode_key (const key_ref & key, DBT * dbt, scratch_scope * scope = NULL);  /**< @private */
+    void decode_key (const DBT * dbt, MessageLite * key);   /**< @private */
+    int  compare_keys (const DBT * k1, const DBT * k2);  /**< @private */
+    int  find_bounds  (unsigned int nthreads, vector <string> * bounds, bool analyzed = true);  /**< @private */
+    int  load_histogram ();                                 /**< @private */
+    bool histogram_bounds (unsigned int nthreads, vector <string> * bounds);  /**< @private */
+    int  compact_file (DB * db, const compact_options & options, uint64_t deadline, compact_result * result);  /**< @private */
+    int  set_priority (DB * db, int priority);  /**< @private */
+    int  measure_file (DB * db, unsigned int samples, table_footprint * result);  /**< @private */
+    int  measure_cache (const string & file, table_footprint * result);  /**< @private */
+    bool is_tracked   ();                                   /**< @private */
+    bool is_numbered  ();                                   /**< @private */
+    void check_ordered (const char * operation);            /**< @private */
+    void write_bulk    (void *& ptr, DBT * bulk, const DBT * key, const DBT * data);  /**< @private */
+    int  set_partition (const table_options & options);     /**< @private */
+    int  build_filter  ();                                  /**< @private */
+    uint64_t filter_bytes ();                               /**< @private */
+    uint64_t cache_bytes  ();                               /**< @private */
+    uint64_t cache_evictions ();                            /**< @private */
+    void limit_cache   (uint64_t bytes);                    /**< @private */
+    int  track_change  (DB_TXN * txn, const DBT * key, const DBT * olddata, const DBT * newdata);  /**< @private */
+    int  insert_record (DB_TXN * txn, DBT * key, DBT * data);  /**< @private */
+    int  append_new    (DB_TXN * txn, DBT * key, DBT * data);  /**< @private */
+    int  update_record (DB_TXN * txn, DBT * key, DBT * data);  /**< @private */
+    void stamp_value   (DBT * data, scratch_scope * scope);   /**< @private */
+    void stamp_value   (DBT * data, unsigned int version, scratch_scope * scope);   /**< @private */
+    int  upgrade_value (const DBT * data, string * buffer, DBT * result);  /**< @private */
+    void unserialize_data (const DBT * from, MessageLite * to);  /**< @private */
+    int  remove_record (DB_TXN * txn, DBT * key);               /**< @private */
+    int  put_record    (DB_TXN * txn, DBT * key, DBT * data);   /**< @private */
+    int  put_records   (DB_TXN * txn, vector <DBT> & keys, vector <DBT> & data);  /**< @private */
+    int  remove_key    (key_ref key, transaction * txn);      /**< @private */
+    int  insert_key    (key_ref key, const MessageLite * data, transaction * txn);  /**< @private */
+    int  select_key    (key_ref key, MessageLite * data, transaction * txn, bool filter);  /**< @private */
+    int  remove_keys   (DB_TXN * txn, vector <DBT> & keys, const vector <size_t> & order, size_t first, size_t last);  /**< @private */
+    int  remove_chunk  (DB_TXN * txn, DBT * key, const DBT * upper, unsigned int chunk, unsigned int * count);  /**< @private */
+    int  modify_once   (DB_TXN * txn, DBT * key, Message * data, modify_callback fn_mod, void * param, bool * changed);  /**< @private */
+    int  merge_record  (DB_TXN * txn, DBT * key, const DBT * delta, merge_callback fn_merge, void * param, bool * created);  /**< @private */
+    int  append_record (DB_TXN * txn, DBT * key, const DBT * fragment);  /**< @private */
+    void count_callback (int kind, uint64_t start);         /**< @private */
+    uint64_t callback_time ();                              /**< @private */
+    void open_expiry   ();                                  /**< @private */
+    bool is_expired    (const DBT * data) const;            /**< @private */
+    int  reap_expired  (unsigned int * reaped);             /**< @private */
+
+    static int compare_profiled (DB * db, const DBT * dbt1, const DBT * dbt2);  /**< @private */
+    static int compare_dynamic  (DB * db, const DBT * dbt1, const DBT * dbt2);  /**< @private */
+
+protected:
+
+    string             m_name;          /**< @private Name of the table.         */
+    DB               * m_db;            /**< @private Berkeley DB database.      */
+    database         * m_database;      /**< @private Master database.           */
+    compare_callback   m_callback;      /**< @private Keys comparision function. */
+    table_options      m_options;       /**< @private Tuning options.            */
+    vector <index*>    m_indexes;       /**< @private List of table indexes.     */
+    vector <materialized_aggregate*> m_aggregates;  /**< @private List of materialized aggregates of the table. */
+    vector <column_store*> m_columns;   /**< @private List of column stores of the table. */
+    vector <upgrade_callback> m_upgrades;   /**< @private Upgrades of data, by versions of schema (see "bdb::table::add_upgrade"). */
+    vector <int>       m_fields;        /**< @private Fields, indexed by field indexes. */
+    row_cache        * m_cache;         /**< @private Cache of selected records ("NULL" if none). */
+    key_filter       * m_bloom;         /**< @private Bloom filter of keys ("NULL" if none).      */
+    volatile bool      m_lazy;          /**< @private Whether the table is not opened yet.        */
+    callback_counters * m_counters;     /**< @private Counters of profiled callbacks ("NULL" if not profiled). */
+    const message_layout * m_layout;    /**< @private Layout of keys, compared by reflection ("NULL" if not). */
+    volatile bool      m_notified;      /**< @private Whether the table has subscribers of change notifications. */
+    volatile bool      m_notify_values; /**< @private Whether any subscriber requests new values of records.      */
+    index            * m_expiry;        /**< @private Index of expiration times of records ("NULL" if records never expire). */
+    hot_sampler      * m_sampler;       /**< @private Sampler of accessed keys ("NULL" if keys are not sampled). */
+    key_histogram    * m_histogram;     /**< @private Histogram of keys ("NULL" if it's not loaded yet).  */
+    volatile uint64_t  m_modified;      /**< @private Number of inserted and removed records (approximate). */
+    volatile uint64_t  m_removed;       /**< @private Number of removed records (approximate).             */
+};
+
+/**
+ * Index of database table.
+ */
+class index : protected table
+{
+    friend class database;
+    friend class table;
+    friend class recordset;
+    friend class prepared_key;
+    friend class index_applier;
+    friend class applier_state;
+    friend class write_batch;
+    friend class table_join;
+    friend class verify_job;
+
+protected:
+
+    index (table * tbl,
+           const char * name,
+           index_callback fn_idx,
+           compare_callback fn_cmp,
+           compare_callback fn_dup,
+           bool unique = false,
+           project_callback fn_proj = NULL,
+           int field = 0,
+           int key_field = 0,
+           bool immutable = false,
+           const message_layout * layout = NULL,
+           bool deferred = false,
+           const int * fields = NULL,
+           const int * types = NULL,
+           int count = 0);
+    ~index () throw ();
+
+public:
+
+    BDB_EXPORT void add_foreign (table * foreign, bool cascade = true);
+    BDB_EXPORT void add_foreign (table * foreign, nullify_callback nullify);
+
+    BDB_EXPORT bool exists (key_ref key, transaction * txn = NULL);
+
+    BDB_EXPORT unsigned int count (key_ref key, transaction * txn = NULL);
+    BDB_EXPORT unsigned int distinct_keys (vector <string> * keys, vector <unsigned int> * counts = NULL, transaction * txn = NULL);
+    BDB_EXPORT uint64_t estimate_distinct (double staleness = 0.0);
+    BDB_EXPORT void rebuild_sketch ();
+    BDB_EXPORT void estimate_range (const Message * lower, const Message * upper, key_estimate * result, transaction * txn = NULL);
+
+    BDB_EXPORT void compact (const compact_options & options = compact_options(), compact_result * result = NULL);
+
+    BDB_EXPORT void set_cache_priority (int priority);
+
+    BDB_EXPORT void footprint (table_footprint * result, unsigned int samples = 64);
+
+    BDB_EXPORT void set_hot_sampling (unsigned int period);
+    BDB_EXPORT void hot_keys (vector <hot_key> * keys, unsigned int count = 10);
+
+    BDB_EXPORT bool wait_applied (unsigned int timeout = 0);
+
+protected:
+
+    /** @private */
+    inline string get_filename () { return m_name + ".ix"; }
+
+    int  open_cover  (table * tbl);                                             /**< @private */
+    int  make_cover  (const DBT * pkey, const DBT * pdata, DBT * skey, DBT * entry);  /**< @private */
+    int  put_cover   (DB_TXN * txn, const DBT * pkey, const DBT * pdata);       /**< @private */
+    int  del_cover   (DB_TXN * txn, const DBT * pkey, const DBT * pdata);       /**< @private */
+    int  move_cover  (DB_TXN * txn, const DBT * pkey, const DBT * olddata, const DBT * newdata);  /**< @private */
+    int  put_entry   (DB_TXN * txn, DBT * skey, DBT * entry);                   /**< @private */
+    int  del_entry   (DB_TXN * txn, DBT * skey, DBT * entry);                   /**< @private */
+    int  build_index (table * tbl, bool unique, compare_callback fn_dup);      /**< @private */
+    int  open_plain     (table * tbl, bool unique, compare_callback fn_dup);    /**< @private */
+    int  open_deferred  (table * tbl);                                          /**< @private */
+    int  apply_deferred ();                                                     /**< @private */
+    int  make_keys   (const string & pkey, const string & pdata, vector <string> * keys);  /**< @private */
+    int  open_sketch  ();                                                       /**< @private */
+    int  scan_sketch  (key_sketch * sketch);                                    /**< @private */
+    int  save_sketch  ();                                                       /**< @private */
+    void close_sketch ();                                                       /**< @private */
+
+    static int  index_by_field (DB * sec, const DBT * key, const DBT * data, DBT * result);  /**< @private */
+    static int  index_by_repeated (DB * sec, const DBT * key, const DBT * data, DBT * result);  /**< @private */
+    static int  index_by_fields (DB * sec, const DBT * key, const DBT * data, DBT * result);  /**< @private */
+    static int  index_by_words (DB * sec, const DBT * key, const DBT * data, DBT * result);  /**< @private */
+    static int  index_by_location (DB * sec, const DBT * key, const DBT * data, DBT * result);  /**< @private */
+    static int  index_profiled (DB * sec, const DBT * key, const DBT * data, DBT * result);  /**< @private */
+    static int  index_deferred (DB * sec, const DBT * key, const DBT * data, DBT * result);  /**< @private */
+    static int  index_sketched (DB * sec, const DBT * key, const DBT * data, DBT * result);  /**< @private */
+    static int  compare_profiled (DB * db, const DBT * dbt1, const DBT * dbt2);  /**< @private */
+    static int  dup_profiled   (DB * db, const DBT * dbt1, const DBT * dbt2);  /**< @private */
+    static int  compare_dynamic (DB * db, const DBT * dbt1, const DBT * dbt2);  /**< @private */
+    static int  dup_dynamic    (DB * db, const DBT * dbt1, const DBT * dbt2);  /**< @private */
+    static void begin_extract  (table * tbl, const DBT * data);                 /**< @private */
+    static void end_extract    ();                                              /**< @private */
+
+protected:
+
+    index_callback     m_indexer;       /**< @private Indexing function.                                   */
+    project_callback   m_projector;     /**< @private Projection function ("NULL" if not covering).        */
+    DB               * m_cover;         /**< @private Projections of covering index ("NULL" if not covering). */
+    table            * m_master;        /**< @private Master table.                                        */
+    int                m_field;         /**< @private Indexed field of primary data ("0" if not field index). */
+    int                m_keyfield;      /**< @private Field of index key (for field index).                */
+    vector <int>       m_columns;       /**< @private Indexed fields of primary data (for composite index). */
+    vector <int>       m_types;         /**< @private Types of indexed fields (for composite index).       */
+    int                m_pkformat;      /**< @private Format of primary keys, read from the index.         */
+    size_t             m_slot;          /**< @private Position of indexed field in "table::m_fields".      */
+    bool               m_immutable;     /**< @private Whether index keys never change on update.           */
+    DB               * m_plain;         /**< @private Handle of the index, not associated with master table, which reads primary keys as data. */
+    DB               * m_position;      /**< @private Position of deferred index in change log ("NULL" if not deferred). */
+    volatile uint64_t  m_applied;       /**< @private Sequence number of the next change to apply to deferred index. */
+    table            * m_foreign;       /**< @private Foreign table of the index ("NULL" if none).         */
+    key_sketch       * m_sketch;        /**< @private Sketch of distinct keys ("NULL" if it's not kept).   */
+};
+
+/**
+ * @private Background worker of deferred indexes (see "bdb::table::add_deferred_index"), which applies
+ * captured changes of their tables to the indexes by batches. The thread is started on the first index.
+ */
+class index_applier
+{
+public:
+
+    index_applier  (database * db);
+    ~index_applier () throw ();
+
+    void add      (index * idx);
+    void remove   (index * idx);
+    void shutdown ();
+    bool wait     (index * idx, uint64_t sequence, unsigned int timeout);
+
+    uint64_t min_applied () const;
+
+protected:
+
+    applier_state * m_state;    /**< @private Deferred indexes, and applying thread. */
+};
+
+/**
+ * @private Background remover of expired records of tables with time to live (see "bdb::table_options::ttl_field").
+ * The thread is started on the first table, and removes expired records by small batches, so it doesn't hold
+ * locks of the tables for long.
+ */
+class expiry_reaper
+{
+public:
+
+    expiry_reaper  (database * db);
+    ~expiry_reaper () throw ();
+
+    void add      (table * tbl);
+    void remove   (table * tbl);
+    void shutdown ();
+
+protected:
+
+    reaper_state * m_state;     /**< @private Tables with time to live, and removing thread. */
+};
+
+/**
+ * @private Per-thread caches of cursors of recordsets (see "bdb::database_options::cursor_cache").
+ * Cursors, closed within a transaction of the thread's own stack, are kept until the next recordset
+ * of the same handle and transaction, and are closed before the transaction is resolved. Each thread
+ * also keeps a buffer of the last closed recordset key, so keyed recordsets don't allocate memory.
+ */
+class cursor_pool
+{
+public:
+
+    cursor_pool  (unsigned int size);
+    ~cursor_pool () throw ();
+
+    int    open    (DB * db, DB_TXN * txn, u_int32_t flags, DBC ** cursor);
+    void   put     (DBC * cursor);
+    void   release (DB_TXN * txn);
+    void   clear   ();
+
+    void * take_buffer (size_t * size);
+    void   give_buffer (void * buffer, size_t size);
+
+protected:
+
+    cursor_state * m_state;     /**< @private Caches of all threads. */
+};
+
+/**
+ * @private Memory budget of a database (see "bdb::database_options::memory_budget"). The library part of
+ * the budget is taken by Bloom filters of tables and buffers of buffered tables first, and the rest is split
+ * between caches of records: half of it equally, and another half in proportion to evictions of the caches
+ * for lack of memory, so the memory moves to the caches under pressure. The split is rebalanced whenever
+ * tables are opened and closed, and whenever any cache has evicted a number of records for lack of memory.
+ */
+class memory_governor
+{
+public:
+
+    memory_governor  (uint64_t budget, uint64_t mpool);
+    ~memory_governor () throw ();
+
+    void add       (table * tbl);
+    void remove    (table * tbl);
+    void reserve   (int64_t bytes);
+    void rebalance ();
+    void stats     (budget_stats * result);
+
+protected:
+
+    governor_state * m_state;   /**< @private Consumers of the budget. */
+};
+
+/**
+ * @private Sampler of accessed keys of table or index (see "bdb::table_options::hot_sampling"). Each thread
+ * counts every N-th key it accesses in a heavy-hitter summary of its own ("Space-Saving": a fixed number of
+ * counters, where a new key replaces the least counted one and inherits its count as the error), so threads
+ * don't contend on sampling. Summaries of all threads are merged on demand.
+ */
+class hot_sampler
+{
+public:
+
+    hot_sampler  (unsigned int period);
+    ~hot_sampler () throw ();
+
+    void set_period (unsigned int period);
+    void sample     (const DBT * key);
+    void top        (unsigned int count, vector <hot_key> * keys);
+
+protected:
+
+    sampler_state * m_state;    /**< @private Summaries of all threads. */
+};
+
+/**
+ * Materialized aggregate of table: count of records and sum of their values by groups, which is stored
+ * in a database of its own and is maintained by the table on every change of its records, in the same
+ * transaction. So counts and sums of groups are read by a single lookup instead of a scan. Minimums and
+ * maximums can't be maintained on removals incrementally, so they are not kept (they are always "0").
+ */
+class materialized_aggregate
+{
+    friend class database;
+    friend class table;
+
+protected:
+
+    materialized_aggregate (table * tbl, const char * name, aggregate_callback fn_agg, int field, int type, int group);
+    ~materialized_aggregate () throw ();
+
+public:
+
+    BDB_EXPORT bool select (const string & group, aggregate_value * result, transaction * txn = NULL);
+    BDB_EXPORT void groups (aggregate_groups * result, transaction * txn = NULL);
+    BDB_EXPORT aggregate_value total (transaction * txn = NULL);
+
+protected:
+
+    /** @private */
+    inline string get_filename () { return m_name + ".agg"; }
+
+    int  make_delta   (const DBT * key, const DBT * data, string * group, int64_t * value, bool * found);  /**< @private */
+    int  apply_change (DB_TXN * txn, const DBT * key, const DBT * olddata, const DBT * newdata);  /**< @private */
+    int  update_group (DB_TXN * txn, const string & group, int64_t count, int64_t values, int64_t sum);  /**< @private */
+    int  build        ();                                   /**< @private */
+    int  read_groups  (DB_TXN * txn, u_int32_t flags, aggregate_groups * result);  /**< @private */
+
+protected:
+
+    table              * m_table;       /**< @private Master table.                                        */
+    string               m_name;        /**< @private Name of the aggregate.                               */
+    DB                 * m_db;          /**< @private Berkeley DB database of aggregated groups.           */
+    aggregate_callback   m_callback;    /**< @private Delta function ("NULL" for aggregate of a field).    */
+    aggregation        * m_decoder;     /**< @private Decoder of aggregated fields ("NULL" for delta function). */
+};
+
+/**
+ * Column store of table: values of selected integer fields of all records, which are stored in a database
+ * of their own by chunks of consecutive primary keys, and are maintained by the table on every change of
+ * its records, in the same transaction (like materialized aggregates). Each chunk keeps values of a field
+ * in a fixed-width column, so aggregation of a field reads only its column instead of parsing of every
+ * record, and by tight loops, which the compiler can vectorize. Chunks are compressed by the codec of
+ * values (see "bdb::set_codec"), if it's set. A change of a record rewrites its whole chunk, so the store
+ * is meant for tables, which are aggregated more often than they are changed.
+ */
+class column_store
+{
+    friend class database;
+    friend class table;
+
+protected:
+
+    column_store (table * tbl, const char * name, const int * fields, const int * types, int count, unsigned int rows);
+    ~column_store () throw ();
+
+public:
+
+    BDB_EXPORT aggregate_value aggregate (int field, transaction * txn = NULL);
+    BDB_EXPORT aggregate_value aggregate (int field, int filter, int64_t low, int64_t high, transaction * txn = NULL);
+
+protected:
+
+    /** @private */
+    inline string get_filename () { return m_name + ".col"; }
+
+    int  column_of    (int field);                          /**< @private */
+    void make_row     (const DBT * data, vector <int64_t> * values, vector <google::protobuf::uint8> * present);  /**< @private */
+    int  apply_change (DB_TXN * txn, const DBT * key, const DBT * olddata, const DBT * newdata);  /**< @private */
+    int  load_chunk   (DB_TXN * txn, const DBT * key, column_chunk * chunk, string * first, bool * found);  /**< @private */
+    int  store_chunk  (DB_TXN * txn, const column_chunk & chunk, const string & first, bool found);  /**< @private */
+    int  put_chunk    (DB_TXN * txn, const column_chunk & chunk, size_t from, size_t to);  /**< @private */
+    int  build        ();                                   /**< @private */
+    int  scan         (DB_TXN * txn, u_int32_t flags, int column, int filter, int64_t low, int64_t high, aggregate_value * result);  /**< @private */
+
+protected:
+
+    table                 * m_table;        /**< @private Master table.                            */
+    string                  m_name;         /**< @private Name of the store.                       */
+    DB                    * m_db;           /**< @private Berkeley DB database of chunks.          */
+    vector <int>            m_fields;       /**< @private Projected fields, by columns.            */
+    vector <aggregation*>   m_decoders;     /**< @private Decoders of projected fields, by columns. */
+    size_t                  m_rows;         /**< @private Maximum number of rows of a chunk.       */
+};
+
+/**
+ * Pool of messages of type "T", which recycles released messages instead of deleting them.
+ * Released messages are cleared, and protobuf keeps capacity of their strings, repeated fields and
+ * submessages, so parsing of next records into recycled messages mostly doesn't allocate memory.
+ * The pool isn't thread-safe, so each thread (or scanning loop) should use a pool of its own.
+ */
+template <class T>
+class message_pool
+{
+public:
+
+    /** Makes empty pool, which keeps up to specified number of released messages. */
+    explicit message_pool (size_t capacity = 64)
+      : m_capacity(capacity)
+    {
+        m_free.reserve(capacity);
+    }
+
+    /** Deletes all kept messages. */
+    ~message_pool ()
+    {
+        for (size_t i = 0; i < m_free.size(); i++)
+        {
+            delete m_free[i];
+        }
+    }
+
+    /** Returns a recycled message, or new one if the pool is empty. */
+    T * acquire ()
+    {
+        if (m_free.empty())
+        {
+            return new T;
+        }
+
+        T * msg = m_free.back();
+        m_free.pop_back();
+
+        return msg;
+    }
+
+    /** Returns the message to the pool (the message is deleted, if the pool is full). */
+    void release (T * msg)
+    {
+        if (msg == NULL) return;
+
+        if (m_free.size() >= m_capacity)
+        {
+            delete msg;
+            return;
+        }
+
+        msg->Clear();
+        m_free.push_back(msg);
+    }
+
+    /** Returns number of kept messages. */
+    size_t size () const
+    {
+        return m_free.size();
+    }
+
+protected:
+
+    size_t       m_capacity;    /**< @private Maximum number of kept messages. */
+    vector <T*>  m_free;        /**< @private Kept messages.                   */
+};
+
+/**
+ * Arena of messages, which owns messages of a batch (e.g. of fetched rows) and releases them all at once.
+ * Released messages are cleared and kept for the next batch, together with capacity of their strings,
+ * repeated fields and submessages, so a steady stream of batches mostly doesn't allocate memory.
+ * The arena isn't thread-safe, so each thread should use an arena of its own.
+ */
+class arena
+{
+public:
+
+    BDB_EXPORT arena  ();
+    BDB_EXPORT ~arena () throw ();
+
+    BDB_EXPORT Message * create (const Message * prototype);
+
+    /** Returns empty message of type "T", owned by the arena. */
+    template <class T>
+    T * create ()
+    {
+        return static_cast <T *> (create(&T::default_instance()));
+    }
+
+    BDB_EXPORT void   release (Message * msg);
+    BDB_EXPORT void   reset   ();
+    BDB_EXPORT void   clear   ();
+    BDB_EXPORT size_t size    () const;
+
+protected:
+
+    /** @private Released messages by their types. */
+    typedef std::map <const google::protobuf::Descriptor *, vector <Message*> > free_lists;
+
+    vector <Message*>   m_used;     /**< @private Messages of the current batch. */
+    free_lists          m_free;     /**< @private Released messages.             */
+};
+
+/**
+ * Data recordset. Recordsets can't be copied, but opened recordsets can be exchanged by "bdb::recordset::swap".
+ */
+class recordset
+{
+    friend class merged_recordset;
+    friend class merge_input;
+    friend class read_ahead;
+    friend class table_join;
+
+    template <class K, class D> friend class rows;
+
+public:
+
+    BDB_EXPORT recordset  (table * tbl, transaction * txn = NULL);
+    BDB_EXPORT recordset  (index * idx, transaction * txn = NULL);
+    BDB_EXPORT recordset  (index * idx, key_ref key, transaction * txn = NULL);
+    BDB_EXPORT recordset  (index * idx, const string & text, int flags = BDB_JOIN_INTERSECT, transaction * txn = NULL);
+    BDB_EXPORT recordset  (index * idx, const geo_box & box, transaction * txn = NULL);
+    BDB_EXPORT recordset  (table * tbl, const joinlist & list, int flags = BDB_JOIN_SORT);
+    BDB_EXPORT recordset  (table * tbl, const Message * lower, const Message * upper, int flags, transaction * txn = NULL);
+    BDB_EXPORT recordset  (index * idx, const Message * lower, const Message * upper, int flags, transaction * txn = NULL);
+    BDB_EXPORT recordset  (table * tbl, const sample_options & options, transaction * txn = NULL);
+    BDB_EXPORT recordset  (index * idx, const sample_options & options, transaction * txn = NULL);
+    BDB_EXPORT ~recordset () throw ();
+
+    BDB_EXPORT bool fetch  (MessageLite * key, MessageLite * data);
+    BDB_EXPORT bool fetch_key (MessageLite * key);
+    BDB_EXPORT bool fetch_prev (Message * key, Message * data);
+    BDB_EXPORT bool fetch_projection (Message * key, Message * projection);
+    BDB_EXPORT bool fetch_view (MessageLite * key, record_view * view);
+    BDB_EXPORT bool fetch_raw (string * key, MessageLite * data);
+
+    /**
+     * Fetches the next record into a message, acquired from specified pool ("NULL" if there are no more records).
+     * The message should be released to the pool, when the application is done with it.
+     */
+    template <class T>
+    bool fetch (Message * key, T ** data, message_pool <T> * pool)
+    {
+        T * msg = pool->acquire();
+
+        if (!fetch(key, msg))
+        {
+            pool->release(msg);
+            *data = NULL;
+            return false;
+        }
+
+        *data = msg;
+        return true;
+    }
+
+    /**
+     * Fetches the next record into a message, owned by specified arena ("NULL" if there are no more records).
+     * The message is valid until the arena is reset, so a batch of fetched records is released at once.
+     */
+    template <class T>
+    bool fetch (Message * key, T ** data, arena * batch)
+    {
+        T * msg = batch->create <T> ();
+
+        if (!fetch(key, msg))
+        {
+            batch->release(msg);
+            *data = NULL;
+            return false;
+        }
+
+        *data = msg;
+        return true;
+    }
+
+    BDB_EXPORT void rewind ();
+
+    BDB_EXPORT bool seek      (key_ref key);
+    BDB_EXPORT void seek_last ();
+
+    BDB_EXPORT bool position (string * token);
+    BDB_EXPORT void resume   (const string & token);
+
+    BDB_EXPORT unsigned int count ();
+
+    BDB_EXPORT void set_bulk       (unsigned int size);
+    BDB_EXPORT void set_read_ahead (unsigned int rows);
+    BDB_EXPORT void set_scan_resistant (bool resistant = true);
+
+    BDB_EXPORT void set_limit (unsigned int limit, unsigned int offset = 0);
+    BDB_EXPORT void set_top   (int field, int type, bool descending = false);
+
+    BDB_EXPORT void set_profiling (bool enable = true);
+    BDB_EXPORT void profile       (recordset_profile * result);
+
+    BDB_EXPORT void set_filter   (filter_callback fn, void * param = NULL);
+    BDB_EXPORT void add_filter   (int field, int type, int op, const Message * value);
+    BDB_EXPORT void clear_filter ();
+
+    BDB_EXPORT void swap (recordset & other);
+
+protected:
+
+    recordset (const recordset &);
+    recordset & operator = (const recordset &);
+
+protected:
+
+    bool fetch_record (MessageLite * key, MessageLite * data, record_view * view = NULL);    /**< @private */
+    bool read_record (bool keyonly, DBT * key, DBT * data);    /**< @private */
+    bool read_cursor (bool keyonly, DBT * key, DBT * data);    /**< @private */
+    void halt_read_ahead (bool discard);                /**< @private */
+    bool read_bulk  (DBT * key, DBT * data);            /**< @private */
+    bool read_dups  (bool keyonly, DBT * key, DBT * data);  /**< @private */
+    bool read_next  (DBT * key, DBT * data);            /**< @private */
+    bool read_accepted (bool keyonly, DBT * key, DBT * data);   /**< @private */
+    bool read_top   (DBT * key, DBT * data);            /**< @private */
+    bool is_ordered () const;                           /**< @private */
+    bool accept     (const DBT * data) const;           /**< @private */
+    bool is_filtered () const;                          /**< @private */
+    void next_bulk  (DBT * key, DBT * data);            /**< @private */
+    void combine     (const joinlist & list, int flags);  /**< @private */
+    void intersect_keys (vector <vector <string> > & lists, size_t smallest);  /**< @private */
+    void prepare     (bool keyonly);                    /**< @private */
+    void check_seekable (const char * operation);       /**< @private */
+    void set_bounds  (const Message * lower, const Message * upper);  /**< @private */
+    int  fetch_range ();                                /**< @private */
+    int  fetch_combined ();                             /**< @private */
+    void init_sample (const sample_options & options);  /**< @private */
+    int  fetch_sample ();                               /**< @private */
+    int  seek_sample (double fraction);                 /**< @private */
+    int  walk_sample (double fraction);                 /**< @private */
+    int  move        (int op, const DBT * key);         /**< @private */
+    void decode_key (const DBT * dbt, MessageLite * key);   /**< @private */
+    void copy_key   (const void * data, u_int32_t size);    /**< @private */
+    bool is_secondary () const;                         /**< @private */
+    void remember   (const DBT * key);                  /**< @private */
+    int  locate     (const DBT * pkey, const DBT * skey);   /**< @private */
+
+protected:
+
+    DBC   * m_cursor;    /**< @private Cursor.                                   */
+    DBC   * m_ccursor;   /**< @private Cursor of covering index ("NULL" if none). */
+    DBC   * m_dcursor;   /**< @private Cursor of plain handle of index, which reads duplicates in bulk ("NULL" if none). */
+    DBT   * m_key;       /**< @private Search key (in "m_keystore", "NULL" if none). */
+    int     m_type;      /**< @private Type of recordset.                        */
+    bool    m_isset;     /**< @private Whether the recordset is set.             */
+    DBT   * m_bulk;      /**< @private Bulk buffer ("NULL" if not in bulk mode). */
+    void  * m_bulkptr;   /**< @private Next record in bulk buffer.               */
+    DBT   * m_kbuf;      /**< @private Reusable buffer of fetched keys.          */
+    DBT   * m_dbuf;      /**< @private Reusable buffer of fetched data.          */
+    DBT   * m_sbuf;      /**< @private Reusable buffer of fetched index keys.    */
+    int     m_format;    /**< @private Format of primary keys.                   */
+    table * m_table;     /**< @private Source table (or index).                  */
+    DBT   * m_lower;     /**< @private Lower bound of range ("NULL" if none).    */
+    DBT   * m_upper;     /**< @private Upper bound of range ("NULL" if none).    */
+    int     m_flags;     /**< @private Flags of range or join recordset.         */
+    bool    m_keyonly;   /**< @private Whether current fetch skips data.         */
+    int     m_seek;      /**< @private Position, set by seeks.                   */
+    vector <string> * m_keys;   /**< @private Primary keys of combined recordset.    */
+    size_t            m_next;   /**< @private Next key of combined recordset.        */
+    uint32_t          m_recno;  /**< @private Record number, read from bulk buffer.  */
+    filter_callback   m_filter; /**< @private Filter function ("NULL" if none).          */
+    void            * m_param;  /**< @private Parameter of filter function.              */
+    vector <filter_condition> * m_conditions;   /**< @private Compiled filter conditions ("NULL" if none). */
+    read_ahead      * m_ahead;  /**< @private Rows, read ahead by background thread ("NULL" if disabled). */
+    sample_state    * m_sample; /**< @private Random positions of sampling recordset ("NULL" if not sampling). */
+    unsigned int      m_limit;  /**< @private Maximum number of fetched records ("0" - unlimited).             */
+    unsigned int      m_offset; /**< @private Number of accepted records, skipped before fetched ones.       */
+    unsigned int      m_passed; /**< @private Number of accepted records, read since opening (or rewind).    */
+    top_state       * m_top;    /**< @private Top records of top-N recordset ("NULL" if not ordered by field). */
+    profile_state   * m_profile;    /**< @private Counters of profiled recordset ("NULL" if not profiled).    */
+    string            m_last;   /**< @private Position of the last fetched record (see "bdb::recordset::position"). */
+    vector <string>   m_order;  /**< @private Names of indexes of natural join, in order of their iteration. */
+    void            * m_keystore[8];    /**< @private Storage of search key ("DBT" object is kept in the recordset itself). */
+    unsigned char     m_keybuf[64];     /**< @private Buffer of short search keys.                  */
+};
+
+/**
+ * Lightweight view of serialized data of a record, fetched by "bdb::recordset::fetch_view".
+ * Fields are decoded on demand, straight from serialized data, and the whole message is parsed only
+ * when requested, so records can be filtered without constructing strings and nested messages of
+ * rejected ones. The view references fetch buffers of the recordset, and is valid until its next fetch.
+ */
+class record_view
+{
+    friend class recordset;
+    friend class aggregation;
+
+public:
+
+    BDB_EXPORT record_view ();
+
+    BDB_EXPORT bool get (int field, field_value * value) const;
+    BDB_EXPORT bool get (int field, int64_t * value) const;
+    BDB_EXPORT bool get (int field, string * value) const;
+    BDB_EXPORT bool get (int field, string_ref * value) const;
+    BDB_EXPORT bool get (int field, record_view * nested) const;
+
+    BDB_EXPORT void   parse (MessageLite * data) const;
+    BDB_EXPORT size_t size  () const;
+
+protected:
+
+    void set (const DBT * dbt);     /**< @private */
+    void make (DBT * dbt) const;    /**< @private */
+
+protected:
+
+    const void * m_data;    /**< @private Serialized data of the record. */
+    size_t       m_size;    /**< @private Size of serialized data.       */
+};
+
+/**
+ * Single-pass range of records of a recordset with keys of type "K" and data of type "D", which are fetched
+ * into one pair of messages, reused by all rows. Data are fetched as a view (see "bdb::recordset::fetch_view"),
+ * and are unserialized only when requested, so rows can be filtered by their raw bytes. Unless the recordset
+ * is already in bulk (or read-ahead) mode, bulk mode is enabled, so scans of tables and of duplicates of
+ * index keys take the fast path by default:
+ *
+ *     bdb::rows <month::key, month::data> range(&rs);
+ *
+ *     for (bdb::rows <month::key, month::data>::iterator i = range.begin(); i != range.end(); ++i)
+ *     {
+ *         if (i->data().days() == 31) ...
+ *     }
+ *
+ * Compilers with range-based "for" can iterate it as "for (auto & row : range)".
+ */
+template <class K, class D>
+class rows
+{
+public:
+
+    /** Default size of bulk buffer, in bytes. */
+    static const unsigned int DEFAULT_BULK = 64 * 1024;
+
+    /** Current row of the range. It's valid until the iterator is incremented. */
+    class row
+    {
+        friend class rows;
+
+    public:
+
+        /** Returns key of the record. */
+        const K & key () const { return m_key; }
+
+        /** Returns data of the record, unserializing them on first call. */
+        const D & data ()
+        {
+            if (!m_parsed)
+            {
+                m_view.parse(&m_data);
+                m_parsed = true;
+            }
+
+            return m_data;
+        }
+
+        /** Returns view of raw bytes of data of the record. */
+        const record_view & view () const { return m_view; }
+
+    protected:
+
+        K           m_key;      /**< @private Key of the record.                    */
+        D           m_data;     /**< @private Data of the record (once parsed).     */
+        record_view m_view;     /**< @private Serialized data of the record.        */
+        bool        m_parsed;   /**< @private Whether data are already unserialized. */
+    };
+
+    /** Input iterator of the range. All iterators of the range share its current row. */
+    class iterator
+    {
+    public:
+
+        typedef std::input_iterator_tag iterator_category;
+        typedef row                     value_type;
+        typedef std::ptrdiff_t          difference_type;
+        typedef row *                   pointer;
+        typedef row &                   reference;
+
+        iterator () : m_rows(NULL) { }
+        explicit iterator (rows * range) : m_rows(range) { }
+
+        row & operator * () const { return m_rows->m_row; }
+        row * operator -> () const { return &m_rows->m_row; }
+
+        /** Fetches the next row; the iterator becomes equal to "end()" after the last one. */
+        iterator & operator ++ ()
+        {
+            if (!m_rows->next()) m_rows = NULL;
+            return *this;
+        }
+
+        bool operator == (const iterator & other) const { return m_rows == other.m_rows; }
+        bool operator != (const iterator & other) const { return m_rows != other.m_rows; }
+
+    protected:
+
+        rows * m_rows;      /**< @private Range of the iterator ("NULL" at the end). */
+    };
+
+    friend class iterator;
+
+    /** Makes range of remaining records of the recordset ("bulk" is size of bulk buffer, "0" - mode is kept). */
+    explicit rows (recordset * rs, unsigned int bulk = DEFAULT_BULK)
+      : m_rs(rs)
+    {
+        if (bulk != 0 && rs->m_bulk == NULL && rs->m_ahead == NULL) rs->set_bulk(bulk);
+    }
+
+    /** Fetches the first row, and returns iterator to it (or "end()" if there are no more records). */
+    iterator begin () { return iterator(next() ? this : NULL); }
+
+    /** Returns iterator past the last row. */
+    iterator end () { return iterator(); }
+
+protected:
+
+    /** Fetches the next row. */
+    bool next ()
+    {
+        m_row.m_parsed = false;
+        return m_rs->fetch_view(&m_row.m_key, &m_row.m_view);
+    }
+
+    rows (const rows &);
+    rows & operator = (const rows &);
+
+protected:
+
+    recordset * m_rs;       /**< @private Source recordset.   */
+    row         m_row;      /**< @private Current row.        */
+};
+
+/**
+ * Aggregation of integer field of records (count, sum, minimum and maximum), optionally grouped by another field.
+ * Fields are decoded straight from serialized data, so records are never unserialized. Any recordset
+ * (including joins and filtered ones) can be aggregated by "bdb::aggregation::run", while workers of
+ * parallel scan (see "bdb::table::parallel_scan") can aggregate their records into their own objects,
+ * which are merged at the end.
+ */
+class aggregation
+{
+    friend class materialized_aggregate;
+    friend class column_store;
+
+public:
+
+    BDB_EXPORT aggregation (int field, int type = BDB_FIELD_INT64, int group = 0);
+
+    BDB_EXPORT void run   (recordset * rs);
+    BDB_EXPORT void add   (const record_view * view);
+    BDB_EXPORT void add   (const DBT * data);
+    BDB_EXPORT void merge (const aggregation & other);
+    BDB_EXPORT void clear ();
+
+    BDB_EXPORT const aggregate_groups & groups () const;
+    BDB_EXPORT aggregate_value total () const;
+
+protected:
+
+    bool decode (const DBT * data, int64_t * value) const;  /**< @private */
+
+protected:
+
+    int              m_field;   /**< @private Aggregated field ("0" - records are counted only).   */
+    int              m_type;    /**< @private Type of aggregated field.                            */
+    int              m_group;   /**< @private Grouping field ("0" - all records are in one group). */
+    aggregate_groups m_groups;  /**< @private Aggregated values by groups.                         */
+};
+
+/**
+ * Batch of changes in one or several tables.
+ * The changes are serialized and kept in memory, and then are applied at once in a single transaction.
+ * In bulk-load mode ("validate"), distinct foreign keys of the batch are verified once before writing.
+ * Point reads of the batch ("find", "exists") see its own changes over the tables ("read your writes"),
+ * so a transaction can keep its writes in the batch, and write them in order of keys on commit, holding
+ * write locks of the tables for the commit only.
+ */
+class write_batch
+{
+public:
+
+    BDB_EXPORT write_batch  (database * db, bool validate = false);
+    BDB_EXPORT ~write_batch () throw ();
+
+    BDB_EXPORT void insert (table * tbl, key_ref key, const MessageLite * data);
+    BDB_EXPORT void update (table * tbl, key_ref key, const MessageLite * data);
+    BDB_EXPORT void remove (table * tbl, key_ref key);
+
+    BDB_EXPORT bool exists (table * tbl, key_ref key, transaction * txn = NULL);
+    BDB_EXPORT bool find   (table * tbl, key_ref key, MessageLite * data, transaction * txn = NULL);
+
+    BDB_EXPORT void commit (transaction * txn = NULL);
+    BDB_EXPORT void clear  ();
+
+    BDB_EXPORT size_t size ();
+
+protected:
+
+    static bool less (const batch_mutation & m1, const batch_mutation & m2);    /**< @private */
+
+    void add     (table * tbl, int kind, const DBT * key, const DBT * data);   /**< @private */
+    int  lookup  (table * tbl, key_ref key, string * data);                    /**< @private */
+    void reindex ();                                                           /**< @private */
+
+    int apply (DB_TXN * txn, size_t * failed);  /**< @private */
+    int apply_bulk (DB_TXN * txn, size_t first, size_t last);   /**< @private */
+    int validate (DB_TXN * txn, DB_TXN * parent, size_t * failed);  /**< @private */
+
+protected:
+
+    database                 * m_database;  /**< @private Master database.    */
+    vector <batch_mutation>  * m_mutations; /**< @private Collected changes.  */
+    bool                       m_validate;  /**< @private Whether foreign keys are validated before writing. */
+    foreign_cache            * m_verified;  /**< @private Foreign keys, verified in current transaction.      */
+    batch_overlay            * m_overlay;   /**< @private Last changes of records, read by the batch itself.  */
+};
+
+/**
+ * Offline builder of a table, which replaces the whole table at once.
+ * Records are written into a new file without logging ("DB_TXN_NOT_DURABLE"), in order of keys, so btree
+ * pages are filled up, and then the file takes place of the table on commit (see "bdb::table_builder::commit").
+ */
+class table_builder
+{
+public:
+
+    BDB_EXPORT table_builder  (database * db,
+                               const char * name,
+                               compare_callback fn_cmp,
+                               const table_options & options = table_options(),
+                               size_t memory = 0);
+    BDB_EXPORT ~table_builder () throw ();
+
+    BDB_EXPORT void add        (key_ref key, const MessageLite * data);
+    BDB_EXPORT void add        (const DBT * key, const DBT * data);
+    BDB_EXPORT void drop_index (const char * name);
+    BDB_EXPORT void commit     ();
+
+    BDB_EXPORT uint64_t size ();
+
+protected:
+
+    void check_active  ();                                  /**< @private */
+    int  add_record    (const DBT * key, const DBT * data); /**< @private */
+    int  put_record    (const DBT * key, const DBT * data); /**< @private */
+    int  flush_bulk    ();                                  /**< @private */
+    int  write_records ();                                  /**< @private */
+    int  swap_files    ();                                  /**< @private */
+    bool is_opened     ();                                  /**< @private */
+
+protected:
+
+    database    * m_database;   /**< @private Master database.                                    */
+    table       * m_table;      /**< @private Table of the new file ("NULL" when the build is over). */
+    string        m_name;       /**< @private Name of the replaced table.                         */
+    build_state * m_state;      /**< @private Sort of added records, and bulk buffer.             */
+};
+
+/** @defgroup dumps Binary dumps and columnar exports of tables. */
+//@{
+BDB_EXPORT uint64_t dump    (table * tbl, std::ostream & out, bool compress = false, transaction * txn = NULL);
+BDB_EXPORT uint64_t restore (table_builder * builder, std::istream & in);
+
+BDB_EXPORT uint64_t export_columns (table * tbl, const Descriptor * type, const char * prefix, unsigned int nthreads, unsigned int group = 65536);
+//@}
+
+/**
+ * Tailing reader of change log of the database, which returns captured changes of records in order
+ * of their sequence numbers (see "bdb::table_options::capture_changes"), starting from specified one.
+ * Changes are appended to the log in transactions of the changes, so they are read once committed.
+ */
+class change_stream
+{
+    friend class index;
+
+public:
+
+    BDB_EXPORT change_stream  (database * db, uint64_t from = 1);
+    BDB_EXPORT ~change_stream () throw ();
+
+    BDB_EXPORT bool next (change_record * change, unsigned int timeout = 0);
+
+    BDB_EXPORT uint64_t position ();
+
+protected:
+
+    int read_change (change_record * change);   /**< @private */
+
+protected:
+
+    database * m_database;  /**< @private Database of the change log.    */
+    uint64_t   m_next;      /**< @private Sequence of the next change.   */
+};
+
+/**
+ * Data of a table record as ProtoBuf input stream, read from the table by chunks ("DB_DBT_PARTIAL"),
+ * so large data can be parsed incrementally (see "bdb::table::select_stream").
+ */
+class value_stream : public google::protobuf::io::ZeroCopyInputStream
+{
+public:
+
+    BDB_EXPORT value_stream  (table * tbl, key_ref key, transaction * txn = NULL, unsigned int chunk = 0);
+    BDB_EXPORT ~value_stream () throw ();
+
+    BDB_EXPORT bool Next   (const void ** data, int * size);
+    BDB_EXPORT void BackUp (int count);
+    BDB_EXPORT bool Skip   (int count);
+
+    BDB_EXPORT google::protobuf::int64 ByteCount () const;
+
+    BDB_EXPORT int error () const;
+
+protected:
+
+    int fill ();            /**< @private */
+
+protected:
+
+    DBC                     * m_cursor;     /**< @private Cursor, positioned at the record.             */
+    void                    * m_stream;     /**< @private Stream of external file of the data ("DB_STREAM", "NULL" if the data are in pages). */
+    uint64_t                  m_length;     /**< @private Length of the data in external file.          */
+    vector <char>             m_chunk;      /**< @private Current chunk of the data.                    */
+    u_int32_t                 m_offset;     /**< @private Offset of the next chunk in the data.         */
+    size_t                    m_pos;        /**< @private Position of unread bytes in current chunk.    */
+    size_t                    m_size;       /**< @private Number of bytes in current chunk.             */
+    google::protobuf::int64   m_count;      /**< @private Number of bytes, read from the stream.        */
+    bool                      m_eof;        /**< @private Whether the last chunk is read.               */
+    int                       m_error;      /**< @private Error of the stream ("0" if none).            */
+};
+
+/**
+ * Raw encoding of single-field keys of type "T" for tables with "BDB_KEY_RAW" format (see "bdb::typed_table").
+ * Bytes of encoded keys are sorted by Berkeley DB itself in order of the keys, so such tables need no
+ * comparison function, and keys are neither serialized nor parsed as messages. Specialized for "int64_t"
+ * and "string"; other types of keys can be added by specializations with the same interface.
+ */
+template <class T>
+class raw_key;
+
+/**
+ * Raw encoding of integer keys: eight bytes of big-endian number with flipped sign bit,
+ * so negative numbers precede positive ones.
+ */
+template <>
+class raw_key <int64_t>
+{
+public:
+
+    /** Encodes specified key. */
+    explicit raw_key (int64_t key)
+    {
+        uint64_t value = (uint64_t) key ^ ((uint64_t) 1 << 63);
+
+        for (int i = sizeof(m_data) - 1; i >= 0; i--)
+        {
+            m_data[i] = (unsigned char) value;
+            value >>= 8;
+        }
+    }
+
+    /** Refers to encoded key. */
+    key_ref ref () const { return key_ref(m_data, sizeof(m_data)); }
+
+    /**
+     * Decodes specified raw bytes into a key.
+     *
+     * @throw bdb::exception BDB_ERROR_UNKNOWN - the bytes are not an encoded integer key.
+     */
+    static void decode (const string & raw, int64_t * key)
+    {
+        if (raw.size() != sizeof(uint64_t)) throw exception(BDB_ERROR_UNKNOWN);
+
+        uint64_t value = 0;
+
+        for (size_t i = 0; i < raw.size(); i++)
+        {
+            value = (value << 8) | (unsigned char) raw[i];
+        }
+
+        *key = (int64_t) (value ^ ((uint64_t) 1 << 63));
+    }
+
+protected:
+
+    unsigned char m_data[8];    /**< @private Encoded key. */
+};
+
+/**
+ * Raw encoding of string keys: bytes of the string as is, so keys are sorted as by "memcmp".
+ */
+template <>
+class raw_key <string>
+{
+public:
+
+    /** Encodes specified key (the string is referenced, not copied). */
+    explicit raw_key (const string & key) : m_key(key) { }
+
+    /** Refers to encoded key. */
+    key_ref ref () const { return key_ref(m_key.data(), m_key.size()); }
+
+    /** Decodes specified raw bytes into a key. */
+    static void decode (const string & raw, string * key)
+    {
+        *key = raw;
+    }
+
+protected:
+
+    const string & m_key;   /**< @private Encoded key. */
+};
+
+/**
+ * Table with single-field keys of type "K" (see "bdb::raw_key") and data messages of type "D", e.g.:
+ *
+ * bdb::typed_table <std::string, month::data> months(&db, "months", true);
+ *
+ * Keys are stored as raw bytes in "BDB_KEY_RAW" format, without tags and length prefixes of ProtoBuf, and are
+ * sorted by Berkeley DB itself, so the key path involves no messages and no comparison function at all.
+ * The table is owned by its database, and keys of its records can be fetched by "bdb::typed_table::fetch" only.
+ */
+template <class K, class D>
+class typed_table
+{
+public:
+
+    /** Adds (opens) table of the database in "BDB_KEY_RAW" format. */
+    typed_table (database * db, const char * name, bool create = false, const table_options & options = table_options())
+      : m_table(db->add_table(name, NULL, create, raw_options(options)))
+    {
+    }
+
+    /** Wraps existing table, opened in "BDB_KEY_RAW" format. */
+    explicit typed_table (table * tbl) : m_table(tbl) { }
+
+    /** @see bdb::table::exists */
+    bool exists (const K & key, transaction * txn = NULL)
+    {
+        return m_table->exists(raw_key <K> (key).ref(), txn);
+    }
+
+    /** @see bdb::table::remove */
+    void remove (const K & key, transaction * txn = NULL)
+    {
+        m_table->remove(raw_key <K> (key).ref(), txn);
+    }
+
+    /** @see bdb::table::insert */
+    void insert (const K & key, const D * data, transaction * txn = NULL)
+    {
+        m_table->insert(raw_key <K> (key).ref(), data, txn);
+    }
+
+    /** @see bdb::table::update */
+    void update (const K & key, const D * data, transaction * txn = NULL)
+    {
+        m_table->update(raw_key <K> (key).ref(), data, txn);
+    }
+
+    /** @see bdb::table::upsert */
+    bool upsert (const K & key, const D * data, transaction * txn = NULL)
+    {
+        return m_table->upsert(raw_key <K> (key).ref(), data, txn);
+    }
+
+    /** @see bdb::table::select */
+    void select (const K & key, D * data, transaction * txn = NULL)
+    {
+        m_table->select(raw_key <K> (key).ref(), data, txn);
+    }
+
+    /**
+     * Fetches the next record of a recordset of the table (or of its index), decoding its raw key.
+     * @see bdb::recordset::fetch_raw
+     */
+    bool fetch (recordset * rs, K * key, D * data)
+    {
+        string raw;
+
+        if (!rs->fetch_raw(&raw, data)) return false;
+
+        raw_key <K>::decode(raw, key);
+
+        return true;
+    }
+
+    /** Returns underlying table (e.g. to add indexes, or to open recordsets). */
+    table * get () const { return m_table; }
+
+protected:
+
+    /** @private Returns specified options with "BDB_KEY_RAW" format. */
+    static table_options raw_options (const table_options & options)
+    {
+        table_options result = options;
+        result.key_format = BDB_KEY_RAW;
+        return result;
+    }
+
+protected:
+
+    table * m_table;    /**< @private Underlying table. */
+};
+
+/**
+ * Data of "bdb::typed_table" and "bdb::table_t" as a fixed-layout struct "T", e.g. a point of time series:
+ *
+ * bdb::typed_table <int64_t, bdb::pod_record <point> > points(&db, "points", true);
+ *
+ * The struct is copied to and from stored values as is, after one marker byte (so the value is never taken
+ * for a compressed or versioned one), without tags, varints and parsing of ProtoBuf. "T" must be trivially
+ * copyable (no pointers, virtual functions, or non-POD members), and its layout is the format of stored data,
+ * so it must not change while the table exists (or data should be upgraded, see "bdb::table::add_upgrade").
+ * Functions, which read fields of ProtoBuf data (standard indexing functions, filters, column stores and
+ * so on), cannot be used with such data.
+ */
+template <class T>
+class pod_record : public MessageLite
+{
+public:
+
+    /** Marker of stored value. */
+    static const google::protobuf::uint8 MARKER = 'P';
+
+    /** Creates record with zeroed struct. */
+    pod_record () { memset(&m_value, 0, sizeof(T)); }
+
+    /** Creates record with specified struct. */
+    pod_record (const T & value) : m_value(value) { }
+
+    /** Returns the struct. */
+    const T & value () const { return m_value; }
+
+    /** Returns the struct to change it. */
+    T * mutable_value () { return &m_value; }
+
+    /** @private */
+    string GetTypeName () const { return "bdb.pod_record"; }
+
+    /** @private */
+    MessageLite * New () const { return new pod_record; }
+
+    /** Zeroes the struct. */
+    void Clear () { memset(&m_value, 0, sizeof(T)); }
+
+    /** @private The struct has no required fields. */
+    bool IsInitialized () const { return true; }
+
+    /** @private */
+    void CheckTypeAndMergeFrom (const MessageLite & other)
+    {
+        m_value = static_cast <const pod_record &> (other).m_value;
+    }
+
+    /** @private Copies the struct from the stream, which must contain exactly one record. */
+    bool MergePartialFromCodedStream (google::protobuf::io::CodedInputStream * input)
+    {
+        google::protobuf::uint8 marker = 0;
+
+        if (!input->ReadRaw(&marker, 1) || marker != MARKER) return false;
+        if (!input->ReadRaw(&m_value, sizeof(T))) return false;
+
+        return input->ExpectAtEnd();
+    }
+
+    /** @private */
+    int ByteSize () const { return (int) (1 + sizeof(T)); }
+
+    /** @private */
+    int GetCachedSize () const { return ByteSize(); }
+
+    /** @private */
+    void SerializeWithCachedSizes (google::protobuf::io::CodedOutputStream * output) const
+    {
+        output->WriteRaw(&MARKER, 1);
+        output->WriteRaw(&m_value, sizeof(T));
+    }
+
+    /** @private Copies the struct right into the buffer. */
+    google::protobuf::uint8 * SerializeWithCachedSizesToArray (google::protobuf::uint8 * target) const
+    {
+        *target = MARKER;
+        memcpy(target + 1, &m_value, sizeof(T));
+
+        return target + 1 + sizeof(T);
+    }
+
+protected:
+
+    T m_value;  /**< @private The struct. */
+};
+
+template <class T>
+const google::protobuf::uint8 pod_record <T>::MARKER;
+
+/**
+ * Comparison type of "bdb::table_t" and "bdb::table_t::add_index", which compares keys by "fn_cmp", e.g.:
+ *
+ * bdb::compare_with <month::key_month_compare>
+ */
+template <compare_callback fn_cmp>
+struct compare_with
+{
+    /** Returns the comparison function. */
+    static compare_callback callback () { return fn_cmp; }
+};
+
+/**
+ * Comparison type of "bdb::table_t", which leaves keys in order of their bytes (e.g. in "BDB_KEY_ORDERED" format).
+ */
+struct bytewise_compare
+{
+    /** Returns no comparison function, so keys are sorted by Berkeley DB itself. */
+    static compare_callback callback () { return NULL; }
+};
+
+/**
+ * Indexing type of "bdb::table_t::add_index", which extracts index keys by "fn_idx".
+ */
+template <index_callback fn_idx>
+struct extract_with
+{
+    /** Returns the indexing function. */
+    static index_callback callback () { return fn_idx; }
+};
+
+/**
+ * @private Key of generated message type "T", serialized in ProtoBuf format ("BDB_KEY_PROTOBUF") by
+ * qualified (so not virtual) calls of the generated methods, which the compiler can inline.
+ * Keys of other formats are referenced as messages, and are serialized by the table.
+ */
+template <class T>
+class direct_key
+{
+public:
+
+    /** Serializes specified key, if it's in ProtoBuf format ("direct"). */
+    direct_key (const T & key, bool direct) : m_key(key), m_data(NULL), m_size(0)
+    {
+        if (!direct) return;
+
+        m_size = (size_t) key.T::ByteSize();
+        m_data = (m_size <= sizeof(m_buffer) ? m_buffer : new google::protobuf::uint8 [m_size]);
+
+        key.T::SerializeWithCachedSizesToArray(m_data);
+    }
+
+    /** Frees memory of large key. */
+    ~direct_key ()
+    {
+        if (m_data != m_buffer) delete [] m_data;
+    }
+
+    /** Refers to serialized key (or to the message, if it's not serialized). */
+    key_ref ref () const
+    {
+        return (m_data != NULL ? key_ref(m_data, m_size) : key_ref(&m_key));
+    }
+
+    /** Parses serialized key by qualified calls of the generated methods. */
+    static void parse (const string & raw, T * key)
+    {
+        google::protobuf::io::CodedInputStream input((const google::protobuf::uint8 *) raw.data(), (int) raw.size());
+
+        key->T::Clear();
+        key->T::MergePartialFromCodedStream(&input);
+    }
+
+protected:
+
+    direct_key (const direct_key &);
+    direct_key & operator = (const direct_key &);
+
+protected:
+
+    const T                  & m_key;           /**< @private Key message.                              */
+    google::protobuf::uint8  * m_data;          /**< @private Serialized key ("NULL" if not serialized). */
+    size_t                     m_size;          /**< @private Size of serialized key.                   */
+    google::protobuf::uint8    m_buffer[64];    /**< @private Buffer of small keys.                     */
+};
+
+/**
+ * Index of "bdb::table_t" with keys of generated message type "IxKey" (see "bdb::table_t::add_index").
+ */
+template <class IxKey>
+class index_t
+{
+public:
+
+    /** @private Wraps index, which keys (and primary keys of its table) are in ProtoBuf format if "direct". */
+    index_t (index * idx, bool direct, bool primary) : m_index(idx), m_direct(direct), m_primary(primary) { }
+
+    /** @see bdb::index::exists */
+    bool exists (const IxKey & key, transaction * txn = NULL)
+    {
+        return m_index->exists(direct_key <IxKey> (key, m_direct).ref(), txn);
+    }
+
+    /** @see bdb::index::count */
+    unsigned int count (const IxKey & key, transaction * txn = NULL)
+    {
+        return m_index->count(direct_key <IxKey> (key, m_direct).ref(), txn);
+    }
+
+    /** Returns underlying index. */
+    index * get () const { return m_index; }
+
+    /** @private Whether keys of the index are serialized directly. */
+    bool is_direct () const { return m_direct; }
+
+    /** @private Whether primary keys of the table are serialized directly. */
+    bool is_primary_direct () const { return m_primary; }
+
+protected:
+
+    index * m_index;    /**< @private Underlying index.                            */
+    bool    m_direct;   /**< @private Whether index keys are in ProtoBuf format.   */
+    bool    m_primary;  /**< @private Whether primary keys are in ProtoBuf format. */
+};
+
+/**
+ * Table with keys of generated message type "Key" and data of generated message type "Data", which keys
+ * are compared by comparison type "Compare" (see "bdb::compare_with" and "bdb::bytewise_compare"), e.g.:
+ *
+ * bdb::table_t <month::key, month::data, bdb::compare_with <month::key_month_compare> > months(&db, "months", true);
+ *
+ * Keys in ProtoBuf format are serialized and parsed by qualified calls of methods of the generated types,
+ * which the compiler can inline, instead of virtual calls through "Message"; data go through the library
+ * as usual, since they may be compressed. The table is owned by its database.
+ */
+template <class Key, class Data, class Compare = bytewise_compare>
+class table_t
+{
+public:
+
+    /** Adds (opens) table of the database with comparison function of "Compare". */
+    table_t (database * db, const char * name, bool create = false, const table_options & options = table_options())
+      : m_table(db->add_table(name, Compare::callback(), create, options)),
+        m_direct(options.key_format == BDB_KEY_PROTOBUF &&
+                 options.access_method != BDB_ACCESS_RECNO && options.access_method != BDB_ACCESS_QUEUE),
+        m_ixdirect(options.key_format != BDB_KEY_ORDERED)
+    {
+    }
+
+    /**
+     * Adds index, which keys of type "IxKey" are extracted by indexing type "Extract" (see "bdb::extract_with"),
+     * and compared by comparison type "IxCompare".
+     * @see bdb::table::add_index
+     */
+    template <class IxKey, class Extract, class IxCompare>
+    index_t <IxKey> add_index (const char * name, bool unique = false, bool immutable = false)
+    {
+        return index_t <IxKey> (m_table->add_index(name, Extract::callback(), IxCompare::callback(), unique, immutable), m_ixdirect, m_direct);
+    }
+
+    /** @see bdb::table::exists */
+    bool exists (const Key & key, transaction * txn = NULL)
+    {
+        return m_table->exists(direct_key <Key> (key, m_direct).ref(), txn);
+    }
+
+    /** @see bdb::table::remove */
+    void remove (const Key & key, transaction * txn = NULL)
+    {
+        m_table->remove(direct_key <Key> (key, m_direct).ref(), txn);
+    }
+
+    /** @see bdb::table::insert */
+    void insert (const Key & key, const Data * data, transaction * txn = NULL)
+    {
+        m_table->insert(direct_key <Key> (key, m_direct).ref(), data, txn);
+    }
+
+    /** @see bdb::table::update */
+    void update (const Key & key, const Data * data, transaction * txn = NULL)
+    {
+        m_table->update(direct_key <Key> (key, m_direct).ref(), data, txn);
+    }
+
+    /** @see bdb::table::upsert */
+    bool upsert (const Key & key, const Data * data, transaction * txn = NULL)
+    {
+        return m_table->upsert(direct_key <Key> (key, m_direct).ref(), data, txn);
+    }
+
+    /** @see bdb::table::select */
+    void select (const Key & key, Data * data, transaction * txn = NULL)
+    {
+        m_table->select(direct_key <Key> (key, m_direct).ref(), data, txn);
+    }
+
+    /** Returns underlying table. */
+    table * get () const { return m_table; }
+
+    /** @private Whether keys of the table are serialized directly. */
+    bool is_direct () const { return m_direct; }
+
+protected:
+
+    table * m_table;        /**< @private Underlying table.                          */
+    bool    m_direct;       /**< @private Whether keys are in ProtoBuf format.       */
+    bool    m_ixdirect;     /**< @private Whether keys of indexes are in ProtoBuf format. */
+};
+
+/**
+ * Recordset of "bdb::table_t" (or of its index) with keys of type "Key" and data of type "Data".
+ * Keys in ProtoBuf format are parsed by qualified calls of methods of "Key" (see "bdb::table_t").
+ */
+template <class Key, class Data>
+class recordset_t
+{
+public:
+
+    /** Opens recordset of all records of the table. */
+    template <class Compare>
+    explicit recordset_t (table_t <Key, Data, Compare> * tbl, transaction * txn = NULL)
+      : m_rs(tbl->get(), txn),
+        m_direct(tbl->is_direct())
+    {
+    }
+
+    /** Opens recordset of all records of the index. */
+    template <class IxKey>
+    explicit recordset_t (index_t <IxKey> * idx, transaction * txn = NULL)
+      : m_rs(idx->get(), txn),
+        m_direct(idx->is_primary_direct())
+    {
+    }
+
+    /** Opens recordset of records with specified key of the index. */
+    template <class IxKey>
+    recordset_t (index_t <IxKey> * idx, const IxKey & key, transaction * txn = NULL)
+      : m_rs(idx->get(), direct_key <IxKey> (key, idx->is_direct()).ref(), txn),
+        m_direct(idx->is_primary_direct())
+    {
+    }
+
+    /** @see bdb::recordset::fetch */
+    bool fetch (Key * key, Data * data)
+    {
+        if (!m_direct) return m_rs.fetch(key, data);
+
+        if (!m_rs.fetch_raw(&m_raw, data)) return false;
+
+        direct_key <Key>::parse(m_raw, key);
+
+        return true;
+    }
+
+    /** @see bdb::recordset::rewind */
+    void rewind () { m_rs.rewind(); }
+
+    /** @see bdb::recordset::swap */
+    void swap (recordset_t & other)
+    {
+        m_rs.swap(other.m_rs);
+        std::swap(m_direct, other.m_direct);
+        m_raw.swap(other.m_raw);
+    }
+
+    /** Returns underlying recordset. */
+    recordset * get () { return &m_rs; }
+
+protected:
+
+    recordset_t (const recordset_t &);
+    recordset_t & operator = (const recordset_t &);
+
+protected:
+
+    recordset   m_rs;       /**< @private Underlying recordset.                  */
+    bool        m_direct;   /**< @private Whether keys are in ProtoBuf format.   */
+    string      m_raw;      /**< @private Raw key of the last fetched record.    */
+};
+
+/**
+ * Logical table, partitioned by hash of serialized keys across tables of the same name in several databases
+ * (e.g. in different home directories on different disks), so writes are spread over several logs and lock regions.
+ * Point operations are forwarded to the shard of the key in its own (implicit) transaction, and scans of all
+ * shards are merged in key order (see "bdb::sharded_recordset"). The list of databases, and its order, must be
+ * the same on each opening, since it defines the shard of each key.
+ */
+class sharded_table
+{
+    friend class sharded_recordset;
+
+public:
+
+    BDB_EXPORT sharded_table (const vector <database *> & shards,
+                              const char * name,
+                              compare_callback fn_cmp,
+                              bool create = false,
+                              const table_options & options = table_options());
+
+    BDB_EXPORT bool exists (const Message * key);
+    BDB_EXPORT void remove (const Message * key);
+    BDB_EXPORT void insert (const Message * key, const Message * data);
+    BDB_EXPORT void update (const Message * key, const Message * data);
+    BDB_EXPORT bool upsert (const Message * key, const Message * data);
+    BDB_EXPORT void select (const Message * key, Message * data);
+
+    BDB_EXPORT unsigned int count (bool fast = false);
+
+    BDB_EXPORT size_t  shard_of (const Message * key);
+    BDB_EXPORT size_t  size     () const;
+    BDB_EXPORT table * shard    (size_t n);
+
+protected:
+
+    vector <table *> m_shards;  /**< @private Tables of the shards, in order of the databases. */
+};
+
+/**
+ * Write-optimized front of a table, which buffers changes of records in memory ("memtable"), sorted by keys,
+ * and writes them to the table at once in order of keys, when the buffer is full (see "bdb::buffered_table::flush").
+ * So random writes become mostly sequential ones, and each page of the table is written once per flush.
+ * Each change is also appended to a log of the buffer (a recno table of the database), so changes, which are
+ * not flushed yet, are replayed into the buffer on the next opening. Point reads merge the buffer with
+ * the table; recordsets of the table see flushed changes only. Writes are blind: "put" overwrites existing
+ * record, and "remove" of missing one does nothing. Deltas of "merge" are coalesced in the buffer by merge function
+ * of the table (see "bdb::table::merge"), so the function must be associative, e.g. "bdb::merge_add" or "bdb::merge_append",
+ * and a flush merges all the deltas of a record into it at once. Changes are logged in the current transaction, but
+ * the buffer is not rolled back, so the table should be written outside of explicit transactions.
+ * The buffered table must be destroyed before its database, since it flushes the buffer on destruction.
+ */
+class buffered_table
+{
+public:
+
+    BDB_EXPORT buffered_table  (database * db,
+                                const char * name,
+                                compare_callback fn_cmp,
+                                bool create = false,
+                                const table_options & options = table_options(),
+                                size_t memory = 0,
+                                merge_callback fn_merge = merge_append,
+                                void * param = NULL);
+    BDB_EXPORT ~buffered_table () throw ();
+
+    BDB_EXPORT void put    (key_ref key, const MessageLite * data);
+    BDB_EXPORT void remove (key_ref key);
+    BDB_EXPORT void merge  (key_ref key, const MessageLite * delta);
+    BDB_EXPORT bool exists (key_ref key);
+    BDB_EXPORT void select (key_ref key, MessageLite * data);
+    BDB_EXPORT bool find   (key_ref key, MessageLite * data);
+    BDB_EXPORT void flush  ();
+
+    BDB_EXPORT size_t  size () const;
+    BDB_EXPORT table * get  () const;
+
+protected:
+
+    void change        (key_ref key, const MessageLite * data, int kind);  /**< @private */
+    int  lookup        (const string & key, string * data);     /**< @private */
+    int  resolve       (const string & key, const string & delta, string * data, bool * found);  /**< @private */
+    int  replay        ();                                      /**< @private */
+    int  write_changes ();                                      /**< @private */
+
+protected:
+
+    database       * m_database;    /**< @private Master database.                                   */
+    table          * m_table;       /**< @private Underlying table.                                  */
+    DB             * m_log;         /**< @private Log of buffered changes.                           */
+    size_t           m_memory;      /**< @private Size of buffered changes, which triggers a flush, in bytes. */
+    buffer_state   * m_state;       /**< @private Buffered changes, sorted by keys.                  */
+};
+
+/**
+ * Table of time series, which stores points of a series by blocks of fixed width of time, one block per record of
+ * an underlying table in "BDB_KEY_RAW" format (keys are identifiers of series and starts of blocks), instead of
+ * one record per point. Timestamps of a block are encoded by deltas of their deltas, and values by XOR with previous
+ * values (as in Gorilla of Facebook), so regular series take a few bits per point. Added points are buffered in
+ * memory, and are merged into their blocks by flushes (a point replaces stored one of the same time), so points,
+ * which are not flushed, are lost if the process crashes; range reads take buffered points into account.
+ */
+class series_table
+{
+public:
+
+    BDB_EXPORT series_table  (database * db,
+                              const char * name,
+                              bool create = false,
+                              int64_t width = 3600,
+                              const table_options & options = table_options(),
+                              size_t memory = 0);
+    BDB_EXPORT ~series_table () throw ();
+
+    BDB_EXPORT void     add   (uint64_t series, int64_t time, double value);
+    BDB_EXPORT void     flush ();
+    BDB_EXPORT uint64_t range (uint64_t series, int64_t from, int64_t to, vector <series_point> * points, transaction * txn = NULL);
+
+    BDB_EXPORT size_t  size () const;
+    BDB_EXPORT table * get  () const;
+
+protected:
+
+    int write_blocks ();    /**< @private */
+    int read_blocks  (DB_TXN * txn, u_int32_t flags, uint64_t series, int64_t from, int64_t to, vector <series_point> * points);  /**< @private */
+
+protected:
+
+    database       * m_database;    /**< @private Master database.                                   */
+    table          * m_table;       /**< @private Underlying table of blocks.                        */
+    int64_t          m_width;       /**< @private Width of blocks, in units of timestamps.           */
+    size_t           m_memory;      /**< @private Size of buffered points, which triggers a flush, in bytes. */
+    series_state   * m_state;       /**< @private Buffered points, by their blocks.                  */
+};
+
+/**
+ * Result of asynchronous operation ("future"), completed by a worker thread of "bdb::async_database".
+ * The result must outlive the operation, and can be reused by another operation once it's completed.
+ */
+class async_result
+{
+    friend class async_database;
+    friend class async_queue;
+
+public:
+
+    BDB_EXPORT async_result  ();
+    BDB_EXPORT ~async_result () throw ();
+
+    BDB_EXPORT bool is_ready ();
+    BDB_EXPORT int  wait     ();
+    BDB_EXPORT bool found    ();
+
+protected:
+
+    void reset    ();                       /**< @private */
+    void complete (int error, bool found);  /**< @private */
+
+protected:
+
+    async_state * m_state;  /**< @private Completion state, guarded by its mutex. */
+};
+
+/**
+ * Asynchronous facade of database, which runs operations on tables by worker threads (its own ones, or shared work
+ * pool of the database), so threads of the application (e.g. of an event loop) never block on disk I/O.
+ * Operations are queued per table, and complete in order of the queue of each table by results ("futures") and/or completion callbacks.
+ * Consecutive reads of a table are run as one pass of a cursor in order of keys ("bdb::table::select_many"),
+ * and consecutive writes are committed in one transaction ("bdb::write_batch"); if the transaction fails,
+ * its writes are retried one by one, so each of them completes with its own error.
+ * By default operations are completed by the worker threads; with an executor, completions are handed over to the
+ * application, so it can resume suspended callers (coroutines, continuations) on its own threads.
+ * Messages of keys and data are neither copied nor owned, and must remain unchanged until the operation completes.
+ */
+class async_database
+{
+public:
+
+    BDB_EXPORT async_database  (database * db, unsigned int nthreads = 0, unsigned int batch = 64);
+    BDB_EXPORT ~async_database () throw ();
+
+    BDB_EXPORT void exists (table * tbl, const Message * key, async_result * result,
+                            completion_callback fn_done = NULL, void * param = NULL);
+    BDB_EXPORT void select (table * tbl, const Message * key, Message * data, async_result * result,
+                            completion_callback fn_done = NULL, void * param = NULL);
+    BDB_EXPORT void insert (table * tbl, const Message * key, const Message * data, async_result * result,
+                            completion_callback fn_done = NULL, void * param = NULL);
+    BDB_EXPORT void update (table * tbl, const Message * key, const Message * data, async_result * result,
+                            completion_callback fn_done = NULL, void * param = NULL);
+    BDB_EXPORT void remove (table * tbl, const Message * key, async_result * result,
+                            completion_callback fn_done = NULL, void * param = NULL);
+
+    BDB_EXPORT void   set_executor (executor_callback fn_post, void * param = NULL);
+
+    BDB_EXPORT void   flush   ();
+    BDB_EXPORT size_t pending ();
+
+protected:
+
+    async_queue * m_queue;  /**< @private Queues of operations and worker threads. */
+};
+
+/**
+ * Recordset, which merges several recordsets of tables (or their ranges) with compatible keys into one,
+ * fetching the records in order of keys ("k-way merge" by heap of serialized keys, compared by comparison
+ * function of the first table). Records with equal keys are fetched from all the recordsets, in their order
+ * in the list. With prefetching, the next records of each recordset are read ahead by its own thread,
+ * so reads of the recordsets overlap in time; the recordsets must not be used otherwise meanwhile.
+ * The recordsets are not owned by the merged one, and must outlive it.
+ */
+class merged_recordset
+{
+public:
+
+    BDB_EXPORT merged_recordset  (const joinlist & list, bool prefetch = false);
+    BDB_EXPORT virtual ~merged_recordset () throw ();
+
+    BDB_EXPORT bool fetch     (Message * key, Message * data);
+    BDB_EXPORT bool fetch_key (Message * key);
+    BDB_EXPORT void rewind    ();
+
+protected:
+
+    bool fetch_record (Message * key, Message * data);  /**< @private */
+    bool advance      (size_t position);                /**< @private */
+    void start        ();                               /**< @private */
+    void stop         ();                               /**< @private */
+
+protected:
+
+    joinlist       m_list;      /**< @private Merged recordsets.                              */
+    table        * m_table;     /**< @private Table of the first recordset (compares keys).   */
+    bool           m_prefetch;  /**< @private Whether records are read ahead by threads.      */
+    merge_state  * m_state;     /**< @private Heap of current records, and prefetching threads. */
+};
+
+/**
+ * Join of recordsets of different tables (or their indexes and ranges) by equal join keys, extracted from
+ * their records by index callbacks ("NULL" callback joins by primary keys). Hash join reads the side with
+ * the smaller number of records into memory, hashing its raw join keys, and probes the hash by records of
+ * another side, so it works on any recordsets. Sort-merge join walks both recordsets at once, and requires
+ * them to be ordered by join keys (e.g. recordsets of indexes on the join keys), compared by the comparison
+ * function. Index nested-loop join reads batches of records of the outer (left) recordset, sorts their join
+ * keys by the comparison function of the inner index (or table), and probes it by one cursor, moving forward
+ * through the sorted keys, so probes of a batch get locality of pages. Pairs of records with equal join keys
+ * are fetched, left and right ones. The recordsets are not owned by the join, and must outlive it.
+ */
+class table_join
+{
+public:
+
+    BDB_EXPORT table_join  (recordset      * left,
+                            index_callback   fn_left,
+                            recordset      * right,
+                            index_callback   fn_right,
+                            int              method = BDB_JOIN_HASH,
+                            compare_callback fn_cmp = NULL);
+    BDB_EXPORT table_join  (recordset * outer, index_callback fn_outer, table * inner, unsigned int batch = 256, transaction * txn = NULL);
+    BDB_EXPORT table_join  (recordset * outer, index_callback fn_outer, index * inner, unsigned int batch = 256, transaction * txn = NULL);
+    BDB_EXPORT ~table_join () throw ();
+
+    BDB_EXPORT bool fetch  (Message * lkey, Message * ldata, Message * rkey, Message * rdata);
     BDB_EXPORT void rewind ();
 
 protected:
 
-    DBC  * m_cursor;    /**< @private Cursor.                       */
-    DBT  * m_key;       /**< @private Search key.                   */
-    int    m_type;      /**< @private Type of recordset.            */
-    bool   m_isset;     /**< @private Whether the recordset is set. */
+    table_join (const table_join &);
+    table_join & operator = (const table_join &);
+
+protected:
+
+    bool fetch_hash  ();                                /**< @private */
+    bool fetch_merge ();                                /**< @private */
+    bool fetch_index ();                                /**< @private */
+    void build       ();                                /**< @private */
+    bool fill_batch  ();                                /**< @private */
+    int  probe       (int op);                          /**< @private */
+    void open_inner  (table * inner, table * primary);  /**< @private */
+    bool advance     (size_t side);                     /**< @private */
+    void join_keys   (size_t side, const DBT * key, const DBT * data, vector <string> * keys);  /**< @private */
+    int  compare     (const string & key1, const string & key2) const;   /**< @private */
+
+protected:
+
+    recordset        * m_rs[2];     /**< @private Left and right recordsets.                      */
+    index_callback     m_fn[2];     /**< @private Extractors of join keys ("NULL" - primary keys). */
+    int                m_method;    /**< @private Method of the join.                             */
+    compare_callback   m_compare;   /**< @private Comparison of join keys ("NULL" - bytewise).     */
+    table            * m_inner;     /**< @private Probed index (or table) of index join ("NULL" if none).   */
+    table            * m_primary;   /**< @private Table of probed index (or the probed table itself).        */
+    unsigned int       m_batch;     /**< @private Number of outer records in a batch of index join.         */
+    transaction      * m_txn;       /**< @private Transaction of probes ("NULL" - current one).             */
+    join_state       * m_state;     /**< @private Hash of the build side, or current records of both sides. */
+};
+
+/**
+ * Recordset of all records of sharded table, merged in key order from recordsets of its shards.
+ */
+class sharded_recordset : public merged_recordset
+{
+public:
+
+    BDB_EXPORT sharded_recordset  (sharded_table * tbl, bool prefetch = false);
+    BDB_EXPORT ~sharded_recordset () throw ();
+
+    BDB_EXPORT void set_bulk  (unsigned int size);
+
+protected:
+
+    static joinlist open_shards (sharded_table * tbl);     /**< @private */
+};
+
+/**
+ * Logical table, partitioned by ranges of an integer field of keys (e.g. a timestamp) into separate tables
+ * of the same database, so a whole range of old records can be dropped at once by removal of its table files
+ * (see "bdb::database::remove_table") instead of removal of the records one by one. Partitions are created
+ * on demand by inserts, and are listed in a catalog of the partitioned table, so they are found on each opening.
+ * Partitions must not be dropped while other threads use them.
+ */
+class partitioned_table
+{
+    friend class partitioned_recordset;
+
+public:
+
+    BDB_EXPORT partitioned_table  (database * db,
+                                   const char * name,
+                                   compare_callback fn_cmp,
+                                   int field,
+                                   int64_t width,
+                                   bool create = false,
+                                   const table_options & options = table_options());
+    BDB_EXPORT ~partitioned_table () throw ();
+
+    BDB_EXPORT bool exists (const Message * key,                       transaction * txn = NULL);
+    BDB_EXPORT void remove (const Message * key,                       transaction * txn = NULL);
+    BDB_EXPORT void insert (const Message * key, const Message * data, transaction * txn = NULL);
+    BDB_EXPORT void update (const Message * key, const Message * data, transaction * txn = NULL);
+    BDB_EXPORT bool upsert (const Message * key, const Message * data, transaction * txn = NULL);
+    BDB_EXPORT void select (const Message * key, Message * data,       transaction * txn = NULL);
+    BDB_EXPORT bool find   (const Message * key, Message * data,       transaction * txn = NULL);
+
+    BDB_EXPORT unsigned int count (bool fast = false, transaction * txn = NULL);
+
+    BDB_EXPORT int64_t partition_of (const Message * key);
+    BDB_EXPORT void    partitions   (vector <int64_t> * list);
+    BDB_EXPORT table * partition    (int64_t number);
+
+    BDB_EXPORT void         drop_partition (int64_t number);
+    BDB_EXPORT unsigned int drop_before    (int64_t value);
+
+protected:
+
+    table * find_partition (const Message * key, bool create);  /**< @private */
+    table * open_partition (int64_t number, bool create);       /**< @private */
+
+protected:
+
+    database         * m_database;  /**< @private Master database.                                 */
+    string             m_name;      /**< @private Name of the table (prefix of partition names).   */
+    compare_callback   m_callback;  /**< @private Keys comparision function.                      */
+    int                m_field;     /**< @private Partitioning field of keys.                      */
+    int64_t            m_width;     /**< @private Width of the range of field values per partition. */
+    table_options      m_options;   /**< @private Tuning options of partitions.                    */
+    DB               * m_catalog;   /**< @private Catalog of partitions.                           */
+    partition_map    * m_map;       /**< @private Open partitions by their numbers.                */
+};
+
+/**
+ * Recordset of all records of partitioned table, merged in key order from recordsets of its partitions.
+ */
+class partitioned_recordset : public merged_recordset
+{
+public:
+
+    BDB_EXPORT partitioned_recordset  (partitioned_table * tbl, transaction * txn = NULL, bool prefetch = false);
+    BDB_EXPORT ~partitioned_recordset () throw ();
+
+protected:
+
+    static joinlist open_partitions (partitioned_table * tbl, transaction * txn);   /**< @private */
 };
 
 }
@@ -0,0 +1,69 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file include/google/protobuf/compiler/bdb/bdb_generator.h
+ * Contains declaration of BDB code generator.
+ * @author Artem Rodygin
+ */
+
+#ifndef GOOGLE_PROTOBUF_COMPILER_BDB_GENERATOR_H__
+#define GOOGLE_PROTOBUF_COMPILER_BDB_GENERATOR_H__
+
+#include <string>
+#include <google/protobuf/compiler/code_generator.h>
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+namespace bdb {
+
+/**
+ * Generator of BDB callback functions.
+ * For each "foo.proto" generates "foo.bdb.h" and "foo.bdb.cc" with keys comparison and index
+ * functions for fields, marked with custom options from "bdb.proto". Generated functions work
+ * with serialized messages directly, and don't construct or parse any messages.
+ */
+class LIBPROTOC_EXPORT BdbGenerator : public CodeGenerator
+{
+public:
+
+    BdbGenerator  ();
+    ~BdbGenerator ();
+
+    bool Generate (const FileDescriptor * file,
+                   const string & parameter,
+                   GeneratorContext * generator_context,
+                   string * error) const;
+
+private:
+
+    GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(BdbGenerator);
+};
+
+}  // namespace bdb
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
+
+#endif  // GOOGLE_PROTOBUF_COMPILER_BDB_GENERATOR_H__
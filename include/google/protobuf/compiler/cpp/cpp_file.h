@@ -59,9 +59,10 @@ class ExtensionGenerator;      // extension.h
 
 class FileGenerator {
  public:
-  // See generator.cc for the meaning of dllexport_decl.
+  // See generator.cc for the meaning of dllexport_decl and fixed_layout.
   explicit FileGenerator(const FileDescriptor* file,
-                         const string& dllexport_decl);
+                         const string& dllexport_decl,
+                         bool fixed_layout = false);
   ~FileGenerator();
 
   void GenerateHeader(io::Printer* printer);
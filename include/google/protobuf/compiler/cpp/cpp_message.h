@@ -55,9 +55,10 @@ class ExtensionGenerator;      // extension.h
 
 class MessageGenerator {
  public:
-  // See generator.cc for the meaning of dllexport_decl.
+  // See generator.cc for the meaning of dllexport_decl and fixed_layout.
   explicit MessageGenerator(const Descriptor* descriptor,
-                            const string& dllexport_decl);
+                            const string& dllexport_decl,
+                            bool fixed_layout = false);
   ~MessageGenerator();
 
   // Header stuff.
@@ -151,9 +152,14 @@ class MessageGenerator {
       bool unbounded);
 
 
+  // Helpers for messages of fixed layout (see generator.cc): prints the
+  // condition under which all fields are serialized in their order.
+  void GenerateFixedLayoutCondition(io::Printer* printer);
+
   const Descriptor* descriptor_;
   string classname_;
   string dllexport_decl_;
+  int max_byte_size_;   // -1 unless the message has fixed layout
   FieldGeneratorMap field_generators_;
   scoped_array<scoped_ptr<MessageGenerator> > nested_generators_;
   scoped_array<scoped_ptr<EnumGenerator> > enum_generators_;
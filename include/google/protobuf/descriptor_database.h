@@ -280,6 +280,13 @@ class LIBPROTOBUF_EXPORT EncodedDescriptorDatabase : public DescriptorDatabase {
   // need to keep it around.
   bool AddCopy(const void* encoded_file_descriptor, int size);
 
+  // Like Add(), but only remembers the bytes, which are parsed and indexed
+  // on the first lookup.  Used for descriptors of generated files, which are
+  // registered during static initialization, so that startup does not pay
+  // for parsing descriptors which may never be used.  Invalid or conflicting
+  // files are logged (and skipped) when they are indexed, not here.
+  void AddLazily(const void* encoded_file_descriptor, int size);
+
   // Like FindFileContainingSymbol but returns only the name of the file.
   bool FindNameOfFileContainingSymbol(const string& symbol_name,
                                       string* output);
@@ -299,6 +306,13 @@ class LIBPROTOBUF_EXPORT EncodedDescriptorDatabase : public DescriptorDatabase {
   SimpleDescriptorDatabase::DescriptorIndex<pair<const void*, int> > index_;
   vector<void*> files_to_delete_;
 
+  // Files added by AddLazily(), which are not indexed yet.
+  vector<pair<const void*, int> > pending_;
+  Mutex pending_mutex_;
+
+  // Indexes all pending files.  Called by each lookup.
+  void IndexPending();
+
   // If encoded_file.first is non-NULL, parse the data into *output and return
   // true, otherwise return false.
   bool MaybeParse(pair<const void*, int> encoded_file,
@@ -104,6 +104,9 @@ class RepeatedField {
 
   void AddAlreadyReserved(const Element& value);
   Element* AddAlreadyReserved();
+  // Appends n elements, for which space is already reserved, and returns
+  // the first of them.  The elements are not initialized.
+  Element* AddNAlreadyReserved(int n);
   int Capacity() const;
 
   // Gets the underlying array.  This pointer is possibly invalidated by
@@ -469,6 +472,14 @@ inline Element* RepeatedField<Element>::AddAlreadyReserved() {
   return &elements_[current_size_++];
 }
 
+template<typename Element>
+inline Element* RepeatedField<Element>::AddNAlreadyReserved(int n) {
+  GOOGLE_DCHECK_LE(size() + n, Capacity());
+  Element* first = elements_ + current_size_;
+  current_size_ += n;
+  return first;
+}
+
 template <typename Element>
 inline const Element& RepeatedField<Element>::Get(int index) const {
   GOOGLE_DCHECK_LT(index, size());
@@ -36,6 +36,7 @@
 #ifndef GOOGLE_PROTOBUF_WIRE_FORMAT_LITE_INL_H__
 #define GOOGLE_PROTOBUF_WIRE_FORMAT_LITE_INL_H__
 
+#include <string.h>
 #include <string>
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/message_lite.h>
@@ -319,12 +320,93 @@ bool WireFormatLite::ReadRepeatedPrimitiveNoInline(
       tag_size, tag, input, value);
 }
 
+// Counts varints in the buffer by their terminating bytes (the ones with
+// the high bit clear), a word of 8 bytes at a time.
+inline int CountVarints(const uint8* buffer, int size) {
+  int count = 0;
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64 word;
+    memcpy(&word, buffer + i, sizeof(word));
+    // One bit per terminating byte, moved to the low bit of the byte, and
+    // summed into the high byte by the multiplication.
+    uint64 stop = (~word & GOOGLE_ULONGLONG(0x8080808080808080)) >> 7;
+    count += static_cast<int>((stop * GOOGLE_ULONGLONG(0x0101010101010101)) >> 56);
+  }
+  for (; i < size; ++i) {
+    if (!(buffer[i] & 0x80)) ++count;
+  }
+  return count;
+}
+
 template <typename CType, enum WireFormatLite::FieldType DeclaredType>
 inline bool WireFormatLite::ReadPackedPrimitive(io::CodedInputStream* input,
                                                 RepeatedField<CType>* values) {
   uint32 length;
   if (!input->ReadVarint32(&length)) return false;
   io::CodedInputStream::Limit limit = input->PushLimit(length);
+
+  // When the whole array is in the buffer, the number of its values is
+  // known from the terminating bytes of the varints, and space for all of
+  // them is reserved at once.  Malformed arrays may have more values than
+  // terminators, so the rest of them are added with the capacity checks.
+  int reserved = 0;
+  const void* void_pointer;
+  int size;
+  input->GetDirectBufferPointerInline(&void_pointer, &size);
+  if (size > 0 && static_cast<uint32>(size) >= length) {
+    reserved = CountVarints(reinterpret_cast<const uint8*>(void_pointer),
+                            static_cast<int>(length));
+    values->Reserve(values->size() + reserved);
+  }
+
+  while (input->BytesUntilLimit() > 0) {
+    CType value;
+    if (!ReadPrimitive<CType, DeclaredType>(input, &value)) return false;
+    if (reserved > 0) {
+      values->AddAlreadyReserved(value);
+      --reserved;
+    } else {
+      values->Add(value);
+    }
+  }
+  input->PopLimit(limit);
+  return true;
+}
+
+template <typename CType, enum WireFormatLite::FieldType DeclaredType>
+inline bool WireFormatLite::ReadPackedFixedSizePrimitive(
+    io::CodedInputStream* input,
+    RepeatedField<CType>* values) {
+  uint32 length;
+  if (!input->ReadVarint32(&length)) return false;
+  if (length % sizeof(CType) != 0) return false;
+  const int new_entries = static_cast<int>(length / sizeof(CType));
+
+  // The whole array is in the buffer, so it's copied at once (on
+  // little-endian targets, where the wire format is the memory layout).
+  const void* void_pointer;
+  int size;
+  input->GetDirectBufferPointerInline(&void_pointer, &size);
+  if (size > 0 && static_cast<uint32>(size) >= length) {
+    values->Reserve(values->size() + new_entries);
+#if defined(PROTOBUF_LITTLE_ENDIAN)
+    if (new_entries > 0) {
+      memcpy(values->AddNAlreadyReserved(new_entries), void_pointer, length);
+    }
+#else
+    const uint8* buffer = reinterpret_cast<const uint8*>(void_pointer);
+    for (int i = 0; i < new_entries; ++i) {
+      CType value;
+      buffer = ReadPrimitiveFromArray<CType, DeclaredType>(buffer, &value);
+      values->AddAlreadyReserved(value);
+    }
+#endif
+    return input->Skip(static_cast<int>(length));
+  }
+
+  // The array crosses the end of the buffer.
+  io::CodedInputStream::Limit limit = input->PushLimit(length);
   while (input->BytesUntilLimit() > 0) {
     CType value;
     if (!ReadPrimitive<CType, DeclaredType>(input, &value)) return false;
@@ -334,6 +416,27 @@ inline bool WireFormatLite::ReadPackedPrimitive(io::CodedInputStream* input,
   return true;
 }
 
+// Specializations of ReadPackedPrimitive for the fixed size types, which use
+// the optimized code path.
+#define READ_PACKED_FIXED_SIZE_PRIMITIVE(CPPTYPE, DECLARED_TYPE)               \
+template <>                                                                    \
+inline bool WireFormatLite::ReadPackedPrimitive<                               \
+  CPPTYPE, WireFormatLite::DECLARED_TYPE>(                                     \
+    io::CodedInputStream* input,                                               \
+    RepeatedField<CPPTYPE>* values) {                                          \
+  return ReadPackedFixedSizePrimitive<                                         \
+    CPPTYPE, WireFormatLite::DECLARED_TYPE>(input, values);                    \
+}
+
+READ_PACKED_FIXED_SIZE_PRIMITIVE(uint32, TYPE_FIXED32);
+READ_PACKED_FIXED_SIZE_PRIMITIVE(uint64, TYPE_FIXED64);
+READ_PACKED_FIXED_SIZE_PRIMITIVE(int32, TYPE_SFIXED32);
+READ_PACKED_FIXED_SIZE_PRIMITIVE(int64, TYPE_SFIXED64);
+READ_PACKED_FIXED_SIZE_PRIMITIVE(float, TYPE_FLOAT);
+READ_PACKED_FIXED_SIZE_PRIMITIVE(double, TYPE_DOUBLE);
+
+#undef READ_PACKED_FIXED_SIZE_PRIMITIVE
+
 template <typename CType, enum WireFormatLite::FieldType DeclaredType>
 bool WireFormatLite::ReadPackedPrimitiveNoInline(io::CodedInputStream* input,
                                                  RepeatedField<CType>* values) {
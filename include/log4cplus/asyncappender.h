@@ -0,0 +1,138 @@
+// Module:  Log4CPLUS
+// File:    asyncappender.h
+// Created: 10/2026
+// Author:  Artem Rodygin
+//
+//
+// Copyright 2026 Artem Rodygin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file */
+
+#ifndef _LOG4CPLUS_ASYNC_APPENDER_HEADER_
+#define _LOG4CPLUS_ASYNC_APPENDER_HEADER_
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/appender.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/syncprims.h>
+#include <log4cplus/helpers/threads.h>
+#include <log4cplus/spi/loggingevent.h>
+
+#include <vector>
+
+
+namespace log4cplus {
+
+    /**
+     * Hands log events off to another appender, which is called in a
+     * background writer thread.  Events are queued in a bounded buffer,
+     * and the writer takes all queued events at once, so the calling
+     * thread never waits for the target appender to write or flush.
+     * Set <tt>ImmediateFlush</tt> of a file appender to <tt>false</tt>
+     * to let it write a batch of events with a single flush.
+     *
+     * <h3>Properties</h3>
+     * <dl>
+     * <dt><tt>Appender</tt></dt>
+     * <dd>Class of target appender. Properties of the target appender
+     * are given with <tt>Appender.</tt> prefix.</dd>
+     *
+     * <dt><tt>QueueSize</tt></dt>
+     * <dd>Maximum number of queued events (1024 by default).</dd>
+     *
+     * <dt><tt>OverflowPolicy</tt></dt>
+     * <dd>What to do with an event when the queue is full:
+     * <tt>Block</tt> the calling thread until the writer makes room (default),
+     * <tt>Drop</tt> the event, or
+     * <tt>Count</tt> - drop the event, and report number of dropped events
+     * to the target appender as soon as the queue has room.</dd>
+     * </dl>
+     *
+     * In single-threaded builds events are passed to the target appender
+     * synchronously.
+     */
+    class LOG4CPLUS_EXPORT AsyncAppender : public Appender {
+    public:
+        enum OverflowPolicy
+        {
+            BLOCK,
+            DROP,
+            COUNT
+        };
+
+      // Ctors
+        AsyncAppender(SharedAppenderPtr target,
+                      unsigned queueSize = 1024,
+                      OverflowPolicy policy = BLOCK);
+        AsyncAppender(const log4cplus::helpers::Properties& properties);
+
+      // Dtor
+        virtual ~AsyncAppender();
+
+      // Methods
+        virtual void close();
+
+        /** Returns number of events, dropped due to queue overflow. */
+        unsigned long getDropped() const;
+
+    protected:
+        void init();
+        virtual void append(const spi::InternalLoggingEvent& event);
+
+      // Data
+        SharedAppenderPtr target;
+        unsigned queueSize;
+        OverflowPolicy policy;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        class LOG4CPLUS_EXPORT WriterThread;
+        friend class WriterThread;
+
+        class LOG4CPLUS_EXPORT WriterThread
+            : public thread::AbstractThread
+            , public helpers::LogLogUser
+        {
+        public:
+            WriterThread (AsyncAppender &);
+            virtual ~WriterThread ();
+
+            virtual void run();
+
+            void terminate ();
+
+        protected:
+            AsyncAppender & aa;
+        };
+
+        std::vector<spi::InternalLoggingEvent> queue;
+        thread::Mutex queue_mutex;
+        thread::ManualResetEvent not_empty;
+        thread::ManualResetEvent not_full;
+        bool exit_flag;
+        unsigned long reported;
+        helpers::SharedObjectPtr<WriterThread> writer;
+#endif
+
+        volatile unsigned long dropped;
+
+    private:
+      // Disallow copying of instances of this class
+        AsyncAppender(const AsyncAppender&);
+        AsyncAppender& operator=(const AsyncAppender&);
+    };
+
+} // end namespace log4cplus
+
+#endif // _LOG4CPLUS_ASYNC_APPENDER_HEADER_
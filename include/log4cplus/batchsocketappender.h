@@ -0,0 +1,174 @@
+// Module:  Log4CPLUS
+// File:    batchsocketappender.h
+// Created: 10/2026
+// Author:  Artem Rodygin
+//
+//
+// Copyright 2026 Artem Rodygin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file */
+
+#ifndef _LOG4CPLUS_BATCH_SOCKET_APPENDER_HEADER_
+#define _LOG4CPLUS_BATCH_SOCKET_APPENDER_HEADER_
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/appender.h>
+#include <log4cplus/socketappender.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/socket.h>
+#include <log4cplus/helpers/syncprims.h>
+#include <log4cplus/helpers/threads.h>
+#include <log4cplus/helpers/timehelper.h>
+#include <log4cplus/spi/loggingevent.h>
+
+#include <vector>
+
+
+namespace log4cplus {
+
+    /**
+     * Sends log events to a remote log server in batches.  Events are
+     * queued, and a background sender thread sends them, when either
+     * <tt>BatchSize</tt> events are queued, or <tt>FlushInterval</tt>
+     * has passed since the previous batch.  The calling thread never
+     * waits for the network: the sender connects (and reconnects) on
+     * its own, and events above <tt>QueueSize</tt> are dropped while the
+     * server is slow or unreachable.
+     *
+     * Each batch is sent as one frame: length of the rest of the frame
+     * (4 bytes), format (1 byte: 0 - plain, 1 - zlib), length of the
+     * uncompressed batch (4 bytes), and the batch itself, which is the
+     * sequence of messages of {@link SocketAppender} (length and event,
+     * see {@link helpers::convertToBuffer}).  Use {@link helpers::readBatch}
+     * to unpack it.  Numbers are in network byte order.
+     *
+     * <h3>Properties</h3>
+     * <dl>
+     * <dt><tt>host</tt></dt>
+     * <dd>Remote host name to connect and send events to.</dd>
+     *
+     * <dt><tt>port</tt></dt>
+     * <dd>Port on remote host to send events to (9998 by default).</dd>
+     *
+     * <dt><tt>ServerName</tt></dt>
+     * <dd>Host name of event's origin prepended to each event.</dd>
+     *
+     * <dt><tt>BatchSize</tt></dt>
+     * <dd>Number of queued events, which are sent at once (256 by default).</dd>
+     *
+     * <dt><tt>FlushInterval</tt></dt>
+     * <dd>Maximum time an event waits in the queue, in milliseconds
+     * (1000 by default).</dd>
+     *
+     * <dt><tt>QueueSize</tt></dt>
+     * <dd>Maximum number of queued events (8192 by default).</dd>
+     *
+     * <dt><tt>Compress</tt></dt>
+     * <dd>Whether batches are compressed by zlib (<tt>true</tt> by default,
+     * where zlib is available).</dd>
+     *
+     * <dt><tt>ReconnectDelay</tt></dt>
+     * <dd>Delay between attempts to connect to the server, in seconds
+     * (5 by default).</dd>
+     * </dl>
+     *
+     * In single-threaded builds batches are sent synchronously by the
+     * thread, which fills them.
+     */
+    class LOG4CPLUS_EXPORT BatchSocketAppender : public Appender {
+    public:
+      // Ctors
+        BatchSocketAppender(const log4cplus::tstring& host, int port,
+                            const log4cplus::tstring& serverName = tstring(),
+                            unsigned batchSize = 256,
+                            unsigned flushInterval = 1000);
+        BatchSocketAppender(const log4cplus::helpers::Properties& properties);
+
+      // Dtor
+        virtual ~BatchSocketAppender();
+
+      // Methods
+        virtual void close();
+
+        /** Returns number of events, dropped due to queue overflow. */
+        unsigned long getDropped() const;
+
+    protected:
+        void init();
+        void sendBatch(const std::vector<spi::InternalLoggingEvent>& batch);
+        void countDropped(size_t count);
+        virtual void append(const spi::InternalLoggingEvent& event);
+
+      // Data
+        log4cplus::helpers::Socket socket;
+        log4cplus::tstring host;
+        int port;
+        log4cplus::tstring serverName;
+        unsigned batchSize;
+        unsigned flushInterval;
+        unsigned queueSize;
+        bool compress;
+        unsigned reconnectDelay;
+        log4cplus::helpers::Time lastConnect;
+        std::vector<spi::InternalLoggingEvent> queue;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        class LOG4CPLUS_EXPORT SenderThread;
+        friend class SenderThread;
+
+        class LOG4CPLUS_EXPORT SenderThread
+            : public thread::AbstractThread
+            , public helpers::LogLogUser
+        {
+        public:
+            SenderThread (BatchSocketAppender &);
+            virtual ~SenderThread ();
+
+            virtual void run();
+
+            void terminate ();
+
+        protected:
+            BatchSocketAppender & bsa;
+        };
+
+        thread::Mutex queue_mutex;
+        thread::ManualResetEvent batch_ready;
+        bool exit_flag;
+        helpers::SharedObjectPtr<SenderThread> sender;
+#endif
+
+        volatile unsigned long dropped;
+
+    private:
+      // Disallow copying of instances of this class
+        BatchSocketAppender(const BatchSocketAppender&);
+        BatchSocketAppender& operator=(const BatchSocketAppender&);
+    };
+
+    namespace helpers {
+        /**
+         * Unpacks events of a batch, received from {@link BatchSocketAppender}
+         * (the frame without its length).  Returns false if the batch is
+         * malformed, or is compressed while zlib is not available.
+         */
+        LOG4CPLUS_EXPORT
+        bool readBatch(const SocketBuffer& frame,
+                       std::vector<log4cplus::spi::InternalLoggingEvent>& events);
+    } // end namespace helpers
+
+} // end namespace log4cplus
+
+#endif // _LOG4CPLUS_BATCH_SOCKET_APPENDER_HEADER_
@@ -71,7 +71,8 @@ namespace log4cplus {
             LOG4CPLUS_MUTEX_PTR_DECLARE access_mutex;
 
         private:
-            mutable int count;
+            // changed by atomic operations, where supported
+            mutable volatile long count;
         };
 
 
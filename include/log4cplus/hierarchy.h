@@ -155,6 +155,9 @@ namespace log4cplus {
          * If a logger of that name already exists, then it will be
          * returned.  Otherwise, a new logger will be instantiated and
          * then linked with its existing ancestors as well as children.
+         *
+         * Each thread remembers the loggers it has already retrieved, so
+         * retrieving them again does not lock the hierarchy.
          *                                    
          * @param name The name of the logger to retrieve.
          */
@@ -296,6 +299,11 @@ namespace log4cplus {
        LoggerMap loggerPtrs;
        Logger root;
 
+       // Loggers, already looked up by each thread, and generation of the
+       // hierarchy they were looked up in (changed by clear())
+       LOG4CPLUS_THREAD_LOCAL_TYPE lookupCache;
+       volatile unsigned int generation;
+
        int disableValue;
 
        bool emittedNoAppenderWarning;
@@ -382,6 +382,16 @@ namespace log4cplus {
      * </tr>
      *
      * <tr>
+     *   <td align=center><b>X</b></td>
+     * 
+     *   <td>Used to output the MDC (mapped diagnostic context) associated
+     *   with the thread that generated the logging event, as
+     *   <tt>key=value</tt> pairs separated by space.  With a key in
+     *   braces, e.g. <b>%X{request}</b>, only value of the key is output.
+     *   </td>     
+     * </tr>
+     *
+     * <tr>
      *   <td align=center><b>"%%"</b></td>
      *   <td>The sequence "%%" outputs a single percent sign.
      *   </td>     
@@ -517,6 +527,7 @@ namespace log4cplus {
       // Data
         log4cplus::tstring pattern;
         std::vector<pattern::PatternConverter*> parsedPattern;
+        log4cplus::tstring formatted;
 
     private: 
       // Disallow copying of instances of this class
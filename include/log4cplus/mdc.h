@@ -0,0 +1,150 @@
+// Module:  Log4CPLUS
+// File:    mdc.h
+// Created: 10/2026
+// Author:  Artem Rodygin
+//
+//
+// Copyright 2026 Artem Rodygin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file
+ * This header defines the MDC class.
+ */
+
+#ifndef _LO4CPLUS_MDC_HEADER_
+#define _LO4CPLUS_MDC_HEADER_
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/tstring.h>
+#include <log4cplus/helpers/thread-config.h>
+
+#include <utility>
+#include <vector>
+
+
+namespace log4cplus {
+    // Forward declarations
+    class MDC;
+    struct MappedContext;
+
+    /** Copy of mapped diagnostic context, taken by a logging event. */
+    typedef std::vector<std::pair<log4cplus::tstring, log4cplus::tstring> > MappedContextCopy;
+
+#if defined (_MSC_VER) || defined (__HP_aCC)
+    LOG4CPLUS_EXPORT MDC& getMDC();
+#endif
+
+
+    /**
+     * The MDC class implements <i>mapped diagnostic contexts</i>: a small
+     * set of key/value pairs of the current thread (e.g. an id of the
+     * request being served), which is output with all log events of the
+     * thread by the <tt>%X</tt> (all pairs) or <tt>%X{key}</tt> (one
+     * value) conversions of PatternLayout.
+     *
+     * Each thread keeps its pairs in fixed-size storage of its own, so
+     * changing the context neither locks nor allocates memory (except
+     * the storage on first use by the thread), and the context is copied
+     * into a logging event only when the event is appended.  Up to
+     * <code>MAX_ENTRIES</code> pairs are kept; longer keys and values are
+     * truncated, and pairs above the limit are ignored.
+     */
+    class LOG4CPLUS_EXPORT MDC {
+    public:
+        enum
+        {
+            MAX_ENTRIES = 8,    /*!< Maximum number of pairs.             */
+            MAX_KEY = 32,       /*!< Maximum length of key + 1.           */
+            MAX_VALUE = 96      /*!< Maximum length of value + 1.         */
+        };
+
+        /**
+         * Sets value of the key in the context of the current thread,
+         * replacing the previous value of the key.
+         */
+        void put(const log4cplus::tchar* key, const log4cplus::tchar* value);
+        void put(const log4cplus::tstring& key, const log4cplus::tstring& value);
+
+        /**
+         * Removes the key from the context of the current thread.
+         */
+        void remove(const log4cplus::tchar* key);
+        void remove(const log4cplus::tstring& key);
+
+        /**
+         * Removes all keys from the context of the current thread.
+         */
+        void clear();
+
+        /**
+         * Returns value of the key in the context of the current thread
+         * (false if there is no such key).
+         */
+        bool get(const log4cplus::tstring& key, log4cplus::tstring* value);
+
+        /**
+         * Copies all pairs of the context of the current thread.
+         */
+        void copy(MappedContextCopy* result);
+
+      // Dtor
+        ~MDC();
+
+    private:
+      // Methods
+        MappedContext* getPtr(bool create);
+
+      // Data
+        LOG4CPLUS_THREAD_LOCAL_TYPE threadLocal;
+
+      // Disallow construction (and copying) except by getMDC()
+        MDC();
+        MDC(const MDC&);
+        MDC& operator=(const MDC&);
+
+      // Friends
+#if defined (_MSC_VER) || defined (__HP_aCC)
+        friend LOG4CPLUS_EXPORT MDC& getMDC();
+#else
+        friend MDC& getMDC();
+#endif
+    };
+
+
+    /**
+     * Return a reference to the singleton object.
+     */
+    LOG4CPLUS_EXPORT MDC& getMDC();
+
+
+    /**
+     * This class ensures that a {@link MDC#put} call is always matched with
+     * a {@link MDC#remove} call even in the face of exceptions.
+     */
+    class LOG4CPLUS_EXPORT MDCContextCreator {
+    public:
+        /** Puts the pair into the MDC. */
+        MDCContextCreator(const log4cplus::tchar* key, const log4cplus::tchar* value);
+
+        /** Removes the key from the MDC. */
+        ~MDCContextCreator();
+
+    private:
+        log4cplus::tchar key[MDC::MAX_KEY];
+    };
+
+} // end namespace log4cplus
+
+
+#endif // _LO4CPLUS_MDC_HEADER_
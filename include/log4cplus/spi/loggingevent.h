@@ -26,6 +26,7 @@
 #include <log4cplus/config.hxx>
 #include <log4cplus/loglevel.h>
 #include <log4cplus/ndc.h>
+#include <log4cplus/mdc.h>
 #include <log4cplus/tstring.h>
 #include <log4cplus/helpers/timehelper.h>
 #include <log4cplus/helpers/threads.h>
@@ -70,7 +71,8 @@ namespace log4cplus {
                        : log4cplus::tstring()) ),
                 line(line_),
                 threadCached(false),
-                ndcCached(false)
+                ndcCached(false),
+                mdcCached(false)
              {
              }
 
@@ -91,7 +93,8 @@ namespace log4cplus {
                 file(file_),
                 line(line_),
                 threadCached(true),
-                ndcCached(true)
+                ndcCached(true),
+                mdcCached(true)
              {
              }
 
@@ -104,8 +107,10 @@ namespace log4cplus {
                 timestamp(rhs.getTimestamp()),
                 file(rhs.getFile()),
                 line(rhs.getLine()),
+                mdc(rhs.getMDC()),
                 threadCached(true),
-                ndcCached(true)
+                ndcCached(true),
+                mdcCached(true)
              {
              }
 
@@ -147,6 +152,16 @@ namespace log4cplus {
                 return ndc; 
             }
 
+            /** The mapped diagnostic context (MDC) of logging event.  It is
+             *  copied from the thread on first request. */
+            const MappedContextCopy& getMDC() const {
+                if(!mdcCached) {
+                    log4cplus::getMDC().copy(&mdc);
+                    mdcCached = true;
+                }
+                return mdc;
+            }
+
             /** The name of thread in which this logging event was generated. */
             const log4cplus::tstring& getThread() const {
                 if(!threadCached) {
@@ -185,10 +200,13 @@ namespace log4cplus {
             log4cplus::helpers::Time timestamp;
             log4cplus::tstring file;
             int line;
+            mutable MappedContextCopy mdc;
             /** Indicates whether or not the Threadname has been retrieved. */
             mutable bool threadCached;
             /** Indicates whether or not the NDC has been retrieved. */
             mutable bool ndcCached;
+            /** Indicates whether or not the MDC has been retrieved. */
+            mutable bool mdcCached;
         };
 
     } // end namespace spi
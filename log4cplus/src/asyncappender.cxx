@@ -0,0 +1,268 @@
+// Module:  Log4CPLUS
+// File:    asyncappender.cxx
+// Created: 10/2026
+// Author:  Artem Rodygin
+//
+//
+// Copyright 2026 Artem Rodygin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdlib>
+#include <log4cplus/asyncappender.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/spi/factory.h>
+
+
+namespace log4cplus
+{
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+//////////////////////////////////////////////////////////////////////////////
+// AsyncAppender::WriterThread
+//////////////////////////////////////////////////////////////////////////////
+
+AsyncAppender::WriterThread::WriterThread (AsyncAppender & async_appender)
+    : aa (async_appender)
+{ }
+
+
+AsyncAppender::WriterThread::~WriterThread ()
+{ }
+
+
+void
+AsyncAppender::WriterThread::run ()
+{
+    std::vector<spi::InternalLoggingEvent> batch;
+    batch.reserve (aa.queueSize);
+
+    while (true)
+    {
+        // The timeout is a safety net only, producers signal the event
+        // when they put the first event into empty queue.
+        aa.not_empty.timed_wait (1000);
+
+        bool exit_now;
+        unsigned long lost;
+
+        // Take all queued events at once.
+
+        {
+            thread::MutexGuard guard (aa.queue_mutex);
+            batch.swap (aa.queue);
+            aa.not_empty.reset ();
+            exit_now = aa.exit_flag && batch.empty ();
+            lost = aa.dropped - aa.reported;
+            aa.reported += lost;
+        }
+
+        aa.not_full.signal ();
+
+        if (exit_now)
+            return;
+
+        if (aa.target.get () == 0)
+        {
+            batch.clear ();
+            continue;
+        }
+
+        if (lost != 0 && aa.policy == COUNT)
+        {
+            aa.target->doAppend (spi::InternalLoggingEvent (aa.name,
+                WARN_LOG_LEVEL,
+                LOG4CPLUS_TEXT("AsyncAppender dropped ")
+                + helpers::convertIntegerToString (lost)
+                + LOG4CPLUS_TEXT(" events"),
+                __FILE__, __LINE__));
+        }
+
+        for (std::vector<spi::InternalLoggingEvent>::const_iterator it
+            = batch.begin (); it != batch.end (); ++it)
+        {
+            aa.target->doAppend (*it);
+        }
+
+        batch.clear ();
+    }
+}
+
+
+void
+AsyncAppender::WriterThread::terminate ()
+{
+    {
+        thread::MutexGuard guard (aa.queue_mutex);
+        aa.exit_flag = true;
+        aa.not_empty.signal ();
+    }
+    join ();
+}
+
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// AsyncAppender ctors and dtor
+//////////////////////////////////////////////////////////////////////////////
+
+AsyncAppender::AsyncAppender(SharedAppenderPtr target_,
+    unsigned queueSize_, OverflowPolicy policy_)
+: target(target_),
+  queueSize(queueSize_),
+  policy(policy_)
+{
+    init ();
+}
+
+
+
+AsyncAppender::AsyncAppender(const helpers::Properties & properties)
+ : Appender(properties),
+   queueSize(1024),
+   policy(BLOCK)
+{
+    tstring factoryName = properties.getProperty( LOG4CPLUS_TEXT("Appender") );
+    spi::AppenderFactory* factory
+        = spi::getAppenderFactoryRegistry().get(factoryName);
+    if (factory == 0)
+    {
+        getLogLog().error(
+            LOG4CPLUS_TEXT("AsyncAppender::AsyncAppender()")
+            LOG4CPLUS_TEXT("- Cannot find AppenderFactory: ")
+            + factoryName);
+    }
+    else
+    {
+        target = factory->createObject(
+            properties.getPropertySubset( LOG4CPLUS_TEXT("Appender.") ));
+    }
+
+    if(properties.exists( LOG4CPLUS_TEXT("QueueSize") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("QueueSize") );
+        queueSize = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+    }
+
+    tstring tmp = helpers::toLower(
+        properties.getProperty( LOG4CPLUS_TEXT("OverflowPolicy") ));
+    if (tmp == LOG4CPLUS_TEXT("drop"))
+        policy = DROP;
+    else if (tmp == LOG4CPLUS_TEXT("count"))
+        policy = COUNT;
+
+    init ();
+}
+
+
+
+AsyncAppender::~AsyncAppender()
+{
+    destructorImpl();
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+// AsyncAppender public methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+AsyncAppender::close()
+{
+    getLogLog().debug(LOG4CPLUS_TEXT("Entering AsyncAppender::close()..."));
+
+    LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( access_mutex )
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        // The writer appends all queued events before it exits.
+        writer->terminate ();
+#endif
+
+        if (target.get () != 0)
+            target->close ();
+
+        closed = true;
+    LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
+}
+
+
+unsigned long
+AsyncAppender::getDropped() const
+{
+    return dropped;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+// AsyncAppender protected methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+AsyncAppender::init ()
+{
+    if (queueSize == 0)
+        queueSize = 1;
+
+    dropped = 0;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    queue.reserve (queueSize);
+    exit_flag = false;
+    reported = 0;
+    writer = new WriterThread (*this);
+    writer->start ();
+#endif
+}
+
+
+// This method does not need to be locked since it is called by
+// doAppend() which performs the locking
+void
+AsyncAppender::append(const spi::InternalLoggingEvent& event)
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    thread::MutexGuard guard (queue_mutex);
+
+    while (queue.size () >= queueSize)
+    {
+        if (policy != BLOCK)
+        {
+            ++dropped;
+            return;
+        }
+
+        not_full.reset ();
+        guard.unlock ();
+        not_full.timed_wait (100);
+        guard.lock ();
+    }
+
+    // The copy caches NDC and name of the calling thread.
+    bool wake = queue.empty ();
+    queue.push_back (event);
+
+    if (wake)
+        not_empty.signal ();
+
+#else
+    if (target.get () != 0)
+        target->doAppend (event);
+
+#endif
+}
+
+
+} // namespace log4cplus
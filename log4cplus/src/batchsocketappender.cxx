@@ -0,0 +1,488 @@
+// Module:  Log4CPLUS
+// File:    batchsocketappender.cxx
+// Created: 10/2026
+// Author:  Artem Rodygin
+//
+//
+// Copyright 2026 Artem Rodygin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdlib>
+#include <cstring>
+#include <log4cplus/batchsocketappender.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/helpers/timehelper.h>
+
+#if defined (LOG4CPLUS_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+
+namespace log4cplus
+{
+
+
+namespace
+{
+
+//! Size of frame header after the length: format and uncompressed size.
+static size_t const BATCH_HEADER_SIZE = 5;
+
+//! Formats of batches.
+enum { BATCH_PLAIN = 0, BATCH_ZLIB = 1 };
+
+
+//! Appends 4-byte number in network byte order.
+static
+void
+put_uint (std::vector<char> & data, unsigned val)
+{
+    data.push_back (static_cast<char>((val >> 24) & 0xFF));
+    data.push_back (static_cast<char>((val >> 16) & 0xFF));
+    data.push_back (static_cast<char>((val >>  8) & 0xFF));
+    data.push_back (static_cast<char>( val        & 0xFF));
+}
+
+
+//! Reads 4-byte number in network byte order.
+static
+unsigned
+get_uint (const char * data)
+{
+    const unsigned char * p = reinterpret_cast<const unsigned char *>(data);
+    return (static_cast<unsigned>(p[0]) << 24)
+        | (static_cast<unsigned>(p[1]) << 16)
+        | (static_cast<unsigned>(p[2]) <<  8)
+        |  static_cast<unsigned>(p[3]);
+}
+
+} // namespace
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+//////////////////////////////////////////////////////////////////////////////
+// BatchSocketAppender::SenderThread
+//////////////////////////////////////////////////////////////////////////////
+
+BatchSocketAppender::SenderThread::SenderThread (
+    BatchSocketAppender & batch_socket_appender)
+    : bsa (batch_socket_appender)
+{ }
+
+
+BatchSocketAppender::SenderThread::~SenderThread ()
+{ }
+
+
+void
+BatchSocketAppender::SenderThread::run ()
+{
+    std::vector<spi::InternalLoggingEvent> batch;
+    batch.reserve (bsa.batchSize);
+
+    while (true)
+    {
+        // Producers signal the event when a batch is full, otherwise
+        // the queued events are sent when the interval passes.
+        bsa.batch_ready.timed_wait (bsa.flushInterval);
+
+        bool exit_now;
+
+        {
+            thread::MutexGuard guard (bsa.queue_mutex);
+            batch.swap (bsa.queue);
+            bsa.batch_ready.reset ();
+            exit_now = bsa.exit_flag;
+        }
+
+        if (! batch.empty ())
+            bsa.sendBatch (batch);
+
+        batch.clear ();
+
+        if (exit_now)
+            return;
+    }
+}
+
+
+void
+BatchSocketAppender::SenderThread::terminate ()
+{
+    {
+        thread::MutexGuard guard (bsa.queue_mutex);
+        bsa.exit_flag = true;
+        bsa.batch_ready.signal ();
+    }
+    join ();
+}
+
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// BatchSocketAppender ctors and dtor
+//////////////////////////////////////////////////////////////////////////////
+
+BatchSocketAppender::BatchSocketAppender(const tstring& host_, int port_,
+    const tstring& serverName_, unsigned batchSize_, unsigned flushInterval_)
+: host(host_),
+  port(port_),
+  serverName(serverName_),
+  batchSize(batchSize_),
+  flushInterval(flushInterval_),
+  queueSize(8192),
+  compress(true),
+  reconnectDelay(5)
+{
+    init ();
+}
+
+
+
+BatchSocketAppender::BatchSocketAppender(const helpers::Properties & properties)
+ : Appender(properties),
+   port(9998),
+   batchSize(256),
+   flushInterval(1000),
+   queueSize(8192),
+   compress(true),
+   reconnectDelay(5)
+{
+    host = properties.getProperty( LOG4CPLUS_TEXT("host") );
+    if(properties.exists( LOG4CPLUS_TEXT("port") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("port") );
+        port = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+    }
+    serverName = properties.getProperty( LOG4CPLUS_TEXT("ServerName") );
+
+    if(properties.exists( LOG4CPLUS_TEXT("BatchSize") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("BatchSize") );
+        batchSize = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("FlushInterval") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("FlushInterval") );
+        flushInterval = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("QueueSize") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("QueueSize") );
+        queueSize = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("ReconnectDelay") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("ReconnectDelay") );
+        reconnectDelay = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+    }
+
+    tstring tmp = helpers::toLower(
+        properties.getProperty( LOG4CPLUS_TEXT("Compress") ));
+    if (tmp == LOG4CPLUS_TEXT("false"))
+        compress = false;
+
+    init ();
+}
+
+
+
+BatchSocketAppender::~BatchSocketAppender()
+{
+    destructorImpl();
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+// BatchSocketAppender public methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+BatchSocketAppender::close()
+{
+    getLogLog().debug(LOG4CPLUS_TEXT("Entering BatchSocketAppender::close()..."));
+
+    LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( access_mutex )
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        // The sender sends all queued events before it exits.
+        sender->terminate ();
+#else
+        if (! queue.empty ())
+            sendBatch (queue);
+        queue.clear ();
+#endif
+
+        socket.close ();
+        closed = true;
+    LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
+}
+
+
+unsigned long
+BatchSocketAppender::getDropped() const
+{
+    return dropped;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+// BatchSocketAppender protected methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+BatchSocketAppender::init ()
+{
+    if (batchSize == 0)
+        batchSize = 1;
+
+    if (queueSize < batchSize)
+        queueSize = batchSize;
+
+    if (flushInterval == 0)
+        flushInterval = 1;
+
+    dropped = 0;
+    queue.reserve (batchSize);
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    exit_flag = false;
+    sender = new SenderThread (*this);
+    sender->start ();
+#endif
+}
+
+
+// This method is called by the sender thread only (or by the thread,
+// which fills the batch, in single-threaded builds).
+void
+BatchSocketAppender::sendBatch(
+    const std::vector<spi::InternalLoggingEvent>& batch)
+{
+    std::vector<char> plain;
+    std::vector<char> frame;
+
+    for (size_t first = 0; first < batch.size (); first += batchSize)
+    {
+        size_t last = first + batchSize;
+        if (last > batch.size ())
+            last = batch.size ();
+
+        // Connecting blocks this thread only, and is not retried more
+        // often than once per delay.
+        if (! socket.isOpen ())
+        {
+            helpers::Time now = helpers::Time::gettimeofday ();
+
+            if (now.sec () >= lastConnect.sec () + static_cast<time_t>(reconnectDelay))
+            {
+                lastConnect = now;
+                socket = helpers::Socket (host, port);
+
+                if (! socket.isOpen ())
+                    getLogLog().error(
+                        LOG4CPLUS_TEXT("BatchSocketAppender::sendBatch()")
+                        LOG4CPLUS_TEXT("- Cannot connect to server"));
+            }
+        }
+
+        if (! socket.isOpen ())
+        {
+            countDropped (last - first);
+            continue;
+        }
+
+        // Messages of the batch are the same as of SocketAppender.
+        plain.clear ();
+
+        for (size_t i = first; i < last; ++i)
+        {
+            helpers::SocketBuffer buffer
+                = helpers::convertToBuffer (batch[i], serverName);
+            put_uint (plain, static_cast<unsigned>(buffer.getSize ()));
+            plain.insert (plain.end (), buffer.getBuffer (),
+                buffer.getBuffer () + buffer.getSize ());
+        }
+
+        size_t header = sizeof (unsigned) + BATCH_HEADER_SIZE;
+
+        frame.clear ();
+        frame.reserve (header + plain.size ());
+        put_uint (frame, 0);
+        frame.push_back (static_cast<char>(BATCH_PLAIN));
+        put_uint (frame, static_cast<unsigned>(plain.size ()));
+
+        bool packed = false;
+
+#if defined (LOG4CPLUS_HAVE_ZLIB)
+        if (compress)
+        {
+            uLongf size = compressBound (static_cast<uLong>(plain.size ()));
+            frame.resize (header + size);
+
+            int ret = compress2 (
+                reinterpret_cast<Bytef *>(&frame[header]), &size,
+                reinterpret_cast<const Bytef *>(&plain[0]),
+                static_cast<uLong>(plain.size ()), Z_BEST_SPEED);
+
+            // Incompressible batches are sent as they are.
+            packed = (ret == Z_OK && size < plain.size ());
+
+            if (packed)
+            {
+                frame.resize (header + size);
+                frame[sizeof (unsigned)] = static_cast<char>(BATCH_ZLIB);
+            }
+        }
+#endif
+
+        if (! packed)
+        {
+            frame.resize (header);
+            frame.insert (frame.end (), plain.begin (), plain.end ());
+        }
+
+        unsigned length = static_cast<unsigned>(frame.size () - sizeof (unsigned));
+        frame[0] = static_cast<char>((length >> 24) & 0xFF);
+        frame[1] = static_cast<char>((length >> 16) & 0xFF);
+        frame[2] = static_cast<char>((length >>  8) & 0xFF);
+        frame[3] = static_cast<char>( length        & 0xFF);
+
+        helpers::SocketBuffer msgBuffer (frame.size ());
+        std::memcpy (msgBuffer.getBuffer (), &frame[0], frame.size ());
+        msgBuffer.setSize (frame.size ());
+
+        // The socket is closed on failure, and reconnected for the next batch.
+        if (! socket.write (msgBuffer))
+            countDropped (last - first);
+    }
+}
+
+
+void
+BatchSocketAppender::countDropped(size_t count)
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    thread::MutexGuard guard (queue_mutex);
+#endif
+    dropped += static_cast<unsigned long>(count);
+}
+
+
+// This method does not need to be locked since it is called by
+// doAppend() which performs the locking
+void
+BatchSocketAppender::append(const spi::InternalLoggingEvent& event)
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    thread::MutexGuard guard (queue_mutex);
+
+    if (queue.size () >= queueSize)
+    {
+        ++dropped;
+        return;
+    }
+
+    // The copy caches NDC and name of the calling thread.
+    queue.push_back (event);
+
+    if (queue.size () == batchSize)
+        batch_ready.signal ();
+
+#else
+    queue.push_back (event);
+
+    if (queue.size () >= batchSize)
+    {
+        sendBatch (queue);
+        queue.clear ();
+    }
+
+#endif
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// namespace helpers methods
+/////////////////////////////////////////////////////////////////////////////
+
+namespace helpers
+{
+
+bool
+readBatch(const SocketBuffer& frame,
+    std::vector<spi::InternalLoggingEvent>& events)
+{
+    const char * data = frame.getBuffer ();
+    size_t size = frame.getSize ();
+
+    if (size < BATCH_HEADER_SIZE)
+        return false;
+
+    unsigned char format = static_cast<unsigned char>(data[0]);
+    size_t plainSize = get_uint (data + 1);
+
+    data += BATCH_HEADER_SIZE;
+    size -= BATCH_HEADER_SIZE;
+
+    std::vector<char> unpacked;
+
+    if (format == BATCH_ZLIB)
+    {
+#if defined (LOG4CPLUS_HAVE_ZLIB)
+        unpacked.resize (plainSize);
+        uLongf length = static_cast<uLongf>(plainSize);
+
+        int ret = uncompress (
+            reinterpret_cast<Bytef *>(unpacked.empty () ? 0 : &unpacked[0]),
+            &length, reinterpret_cast<const Bytef *>(data),
+            static_cast<uLong>(size));
+
+        if (ret != Z_OK || length != plainSize)
+            return false;
+
+        data = unpacked.empty () ? 0 : &unpacked[0];
+        size = plainSize;
+#else
+        return false;
+#endif
+    }
+    else if (format != BATCH_PLAIN || size != plainSize)
+        return false;
+
+    size_t pos = 0;
+
+    while (pos < size)
+    {
+        if (size - pos < sizeof (unsigned))
+            return false;
+
+        size_t length = get_uint (data + pos);
+        pos += sizeof (unsigned);
+
+        if (size - pos < length)
+            return false;
+
+        SocketBuffer buffer (length);
+        std::memcpy (buffer.getBuffer (), data + pos, length);
+        buffer.setSize (length);
+        pos += length;
+
+        events.push_back (readFromBuffer (buffer));
+    }
+
+    return true;
+}
+
+} // namespace helpers
+
+} // namespace log4cplus
@@ -20,6 +20,8 @@
 
 #include <log4cplus/spi/factory.h>
 #include <log4cplus/spi/loggerfactory.h>
+#include <log4cplus/asyncappender.h>
+#include <log4cplus/batchsocketappender.h>
 #include <log4cplus/consoleappender.h>
 #include <log4cplus/fileappender.h>
 #include <log4cplus/nullappender.h>
@@ -155,6 +157,8 @@ void initializeFactoryRegistry()
     REG_APPENDER (reg, RollingFileAppender);
     REG_APPENDER (reg, DailyRollingFileAppender);
     REG_APPENDER (reg, SocketAppender);
+    REG_APPENDER (reg, AsyncAppender);
+    REG_APPENDER (reg, BatchSocketAppender);
 #if defined(_WIN32)
 #  if defined(LOG4CPLUS_HAVE_NT_EVENT_LOG)
     REG_APPENDER (reg, NTEventLogAppender);
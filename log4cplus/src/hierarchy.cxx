@@ -35,6 +35,23 @@ using namespace log4cplus::helpers;
 namespace
 {
 
+//! Loggers, looked up by one thread.
+struct LoggerCache
+{
+    unsigned int generation;
+    std::map<tstring, Logger> loggers;
+};
+
+
+//! Frees cache of exited thread.
+static
+void
+free_cache (void * ptr)
+{
+    delete static_cast<LoggerCache *>(ptr);
+}
+
+
 static
 bool startsWith(tstring const & teststr, tstring const & substr)
 {
@@ -66,6 +83,8 @@ Hierarchy::Hierarchy()
   : hashtable_mutex(LOG4CPLUS_MUTEX_CREATE),
     defaultFactory(new DefaultLoggerFactory()),
     root(NULL),
+    lookupCache(LOG4CPLUS_THREAD_LOCAL_INIT (free_cache)),
+    generation(0),
     disableValue(DISABLE_OFF),  // Don't disable any LogLevel level by default.
     emittedNoAppenderWarning(false),
     emittedNoResourceBundleWarning(false)
@@ -77,6 +96,12 @@ Hierarchy::Hierarchy()
 Hierarchy::~Hierarchy()
 {
     shutdown();
+
+    // caches of other threads are freed when they exit
+    free_cache (LOG4CPLUS_GET_THREAD_LOCAL_VALUE( lookupCache ));
+    LOG4CPLUS_SET_THREAD_LOCAL_VALUE( lookupCache, NULL );
+    LOG4CPLUS_THREAD_LOCAL_CLEANUP( lookupCache );
+
     LOG4CPLUS_MUTEX_FREE( hashtable_mutex );
 }
 
@@ -92,6 +117,7 @@ Hierarchy::clear()
     LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( hashtable_mutex )
         provisionNodes.erase(provisionNodes.begin(), provisionNodes.end());
         loggerPtrs.erase(loggerPtrs.begin(), loggerPtrs.end());
+        ++generation;
     LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
 }
 
@@ -162,8 +188,32 @@ Hierarchy::getInstance(const log4cplus::tstring& name)
 Logger 
 Hierarchy::getInstance(const log4cplus::tstring& name, spi::LoggerFactory& factory)
 {
+    LoggerCache * cache = static_cast<LoggerCache *>
+        (LOG4CPLUS_GET_THREAD_LOCAL_VALUE( lookupCache ));
+
+    // loggers, looked up by the thread before, are taken without locking
+    if (cache != NULL && cache->generation == generation) {
+        std::map<tstring, Logger>::const_iterator it = cache->loggers.find(name);
+        if (it != cache->loggers.end())
+            return it->second;
+    }
+
+    if (cache == NULL) {
+        cache = new LoggerCache;
+        cache->generation = 0;
+        LOG4CPLUS_SET_THREAD_LOCAL_VALUE( lookupCache, cache );
+    }
+
     LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( hashtable_mutex )
-        return getInstanceImpl(name, factory);
+        Logger logger = getInstanceImpl(name, factory);
+
+        if (cache->generation != generation) {
+            cache->loggers.clear();
+            cache->generation = generation;
+        }
+
+        cache->loggers.insert(std::make_pair(name, logger));
+        return logger;
     LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
 }
 
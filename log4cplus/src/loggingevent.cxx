@@ -91,8 +91,10 @@ InternalLoggingEvent::operator=(const log4cplus::spi::InternalLoggingEvent& rhs)
     timestamp = rhs.timestamp;
     file = rhs.file;
     line = rhs.line;
+    mdc = rhs.getMDC();
     threadCached = true;
     ndcCached = true;
+    mdcCached = true;
 
     return *this;
 }
@@ -0,0 +1,258 @@
+// Module:  Log4CPLUS
+// File:    mdc.cxx
+// Created: 10/2026
+// Author:  Artem Rodygin
+//
+//
+// Copyright 2026 Artem Rodygin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/mdc.h>
+#include <log4cplus/helpers/threads.h>
+
+
+namespace log4cplus
+{
+
+
+//////////////////////////////////////////////////////////////////////////////
+// MappedContext
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Pairs of mapped diagnostic context of one thread, kept in place.
+ */
+struct MappedContext
+{
+    struct Entry
+    {
+        tchar key[MDC::MAX_KEY];
+        tchar value[MDC::MAX_VALUE];
+    };
+
+    Entry entries[MDC::MAX_ENTRIES];
+    size_t count;
+};
+
+
+namespace
+{
+
+
+//! Copies the string, truncating it to the size of the buffer.
+static
+void
+copy_string (tchar * dest, size_t size, const tchar * src)
+{
+    size_t i = 0;
+    for (; i + 1 < size && src[i] != 0; ++i)
+        dest[i] = src[i];
+
+    dest[i] = 0;
+}
+
+
+//! Compares the key with a stored key (truncated the same way).
+static
+bool
+equal_key (const tchar * stored, const tchar * key)
+{
+    size_t i = 0;
+    for (; i + 1 < MDC::MAX_KEY && key[i] != 0; ++i)
+        if (stored[i] != key[i])
+            return false;
+
+    return stored[i] == 0;
+}
+
+
+//! Frees context of exited thread.
+static
+void
+free_context (void * ptr)
+{
+    delete static_cast<MappedContext *>(ptr);
+}
+
+
+} // namespace
+
+
+//////////////////////////////////////////////////////////////////////////////
+// MDC
+//////////////////////////////////////////////////////////////////////////////
+
+MDC&
+getMDC()
+{
+    static MDC singleton;
+    return singleton;
+}
+
+
+MDC::MDC()
+    : threadLocal(LOG4CPLUS_THREAD_LOCAL_INIT (free_context))
+{ }
+
+
+MDC::~MDC()
+{
+    LOG4CPLUS_THREAD_LOCAL_CLEANUP( threadLocal );
+}
+
+
+void
+MDC::put(const tchar* key, const tchar* value)
+{
+    MappedContext * ctx = getPtr(true);
+
+    for (size_t i = 0; i < ctx->count; ++i)
+    {
+        if (equal_key (ctx->entries[i].key, key))
+        {
+            copy_string (ctx->entries[i].value, MAX_VALUE, value);
+            return;
+        }
+    }
+
+    // pairs above the limit are ignored
+    if (ctx->count == MAX_ENTRIES)
+        return;
+
+    MappedContext::Entry & entry = ctx->entries[ctx->count++];
+    copy_string (entry.key, MAX_KEY, key);
+    copy_string (entry.value, MAX_VALUE, value);
+}
+
+
+void
+MDC::put(const tstring& key, const tstring& value)
+{
+    put (key.c_str (), value.c_str ());
+}
+
+
+void
+MDC::remove(const tchar* key)
+{
+    MappedContext * ctx = getPtr(false);
+    if (ctx == NULL)
+        return;
+
+    for (size_t i = 0; i < ctx->count; ++i)
+    {
+        if (equal_key (ctx->entries[i].key, key))
+        {
+            // the last pair takes place of the removed one
+            if (i + 1 < ctx->count)
+                ctx->entries[i] = ctx->entries[ctx->count - 1];
+
+            --ctx->count;
+            return;
+        }
+    }
+}
+
+
+void
+MDC::remove(const tstring& key)
+{
+    remove (key.c_str ());
+}
+
+
+void
+MDC::clear()
+{
+    MappedContext * ctx = getPtr(false);
+    if (ctx != NULL)
+        ctx->count = 0;
+}
+
+
+bool
+MDC::get(const tstring& key, tstring* value)
+{
+    MappedContext * ctx = getPtr(false);
+    if (ctx == NULL)
+        return false;
+
+    for (size_t i = 0; i < ctx->count; ++i)
+    {
+        if (equal_key (ctx->entries[i].key, key.c_str ()))
+        {
+            value->assign (ctx->entries[i].value);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void
+MDC::copy(MappedContextCopy* result)
+{
+    result->clear ();
+
+    MappedContext * ctx = getPtr(false);
+    if (ctx == NULL)
+        return;
+
+    result->reserve (ctx->count);
+
+    for (size_t i = 0; i < ctx->count; ++i)
+    {
+        result->push_back (std::make_pair (tstring (ctx->entries[i].key),
+                                           tstring (ctx->entries[i].value)));
+    }
+}
+
+
+MappedContext*
+MDC::getPtr(bool create)
+{
+    MappedContext * ctx = static_cast<MappedContext *>
+        (LOG4CPLUS_GET_THREAD_LOCAL_VALUE( threadLocal ));
+
+    if (ctx == NULL && create)
+    {
+        ctx = new MappedContext;
+        ctx->count = 0;
+        LOG4CPLUS_SET_THREAD_LOCAL_VALUE( threadLocal, ctx );
+    }
+
+    return ctx;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// MDCContextCreator
+//////////////////////////////////////////////////////////////////////////////
+
+MDCContextCreator::MDCContextCreator(const tchar* key_, const tchar* value)
+{
+    copy_string (key, MDC::MAX_KEY, key_);
+    getMDC().put(key, value);
+}
+
+
+MDCContextCreator::~MDCContextCreator()
+{
+    getMDC().remove(key);
+}
+
+
+} // namespace log4cplus
@@ -127,10 +127,21 @@ namespace log4cplus {
             virtual ~PatternConverter() {}
             void formatAndAppend(log4cplus::tostream& output, 
                                  const InternalLoggingEvent& event);
+            void formatAndAppend(log4cplus::tstring& result,
+                                 const InternalLoggingEvent& event);
 
         protected:
             virtual log4cplus::tstring convert(const InternalLoggingEvent& event) = 0;
 
+            /**
+             * Appends converted field to the string.  Converters override
+             * this to append fields without making temporary strings.
+             */
+            virtual void append(log4cplus::tstring& result,
+                                const InternalLoggingEvent& event) {
+                result.append(convert(event));
+            }
+
         private:
             int minLen;
             size_t maxLen;
@@ -148,6 +159,10 @@ namespace log4cplus {
             virtual log4cplus::tstring convert(const InternalLoggingEvent&) {
                 return str;
             }
+            virtual void append(log4cplus::tstring& result,
+                                const InternalLoggingEvent&) {
+                result.append(str);
+            }
 
         private:
             log4cplus::tstring str;
@@ -173,6 +188,8 @@ namespace log4cplus {
                         FULL_LOCATION_CONVERTER };
             BasicPatternConverter(const FormattingInfo& info, Type type);
             virtual log4cplus::tstring convert(const InternalLoggingEvent& event);
+            virtual void append(log4cplus::tstring& result,
+                                const InternalLoggingEvent& event);
 
         private:
           // Disable copy
@@ -211,10 +228,27 @@ namespace log4cplus {
                                  const log4cplus::tstring& pattern, 
                                  bool use_gmtime);
             virtual log4cplus::tstring convert(const InternalLoggingEvent& event);
+            virtual void append(log4cplus::tstring& result,
+                                const InternalLoggingEvent& event);
 
         private:
+            /**
+             * Part of the pattern: either formatted by strftime (the same
+             * text within a second), or a %q/%Q field of the second.
+             */
+            struct Segment {
+                log4cplus::tchar field;
+                log4cplus::tstring format;
+                log4cplus::tstring text;
+            };
+
+            void split();
+
             bool use_gmtime;
             log4cplus::tstring format;
+            std::vector<Segment> segments;
+            time_t cachedSecond;
+            bool cacheValid;
         };
 
 
@@ -233,6 +267,25 @@ namespace log4cplus {
 
 
 
+        /**
+         * This PatternConverter is used to format the MDC field found in
+         * the InternalLoggingEvent object: either value of one key, or
+         * all pairs as <tt>key=value</tt>, separated by space.
+         */
+        class MDCPatternConverter : public PatternConverter {
+        public:
+            MDCPatternConverter(const FormattingInfo& info,
+                                const log4cplus::tstring& key);
+            virtual log4cplus::tstring convert(const InternalLoggingEvent& event);
+            virtual void append(log4cplus::tstring& result,
+                                const InternalLoggingEvent& event);
+
+        private:
+            log4cplus::tstring key;
+        };
+
+
+
         /**
          * This PatternConverter is used to format the NDC field found in
          * the InternalLoggingEvent object, optionally limited to
@@ -354,6 +407,29 @@ log4cplus::pattern::PatternConverter::formatAndAppend
 
 
 
+void
+log4cplus::pattern::PatternConverter::formatAndAppend
+                     (log4cplus::tstring& result, const InternalLoggingEvent& event)
+{
+    size_t start = result.length();
+    append(result, event);
+    size_t len = result.length() - start;
+
+    if(len > maxLen) {
+        result.erase(start, len - maxLen);
+    }
+    else if(static_cast<int>(len) < minLen) {
+        if(leftAlign) {
+            result.append(minLen - len, LOG4CPLUS_TEXT(' '));
+        }
+        else {
+            result.insert(start, minLen - len, LOG4CPLUS_TEXT(' '));
+        }
+    }
+}
+
+
+
 ////////////////////////////////////////////////
 // LiteralPatternConverter methods:
 ////////////////////////////////////////////////
@@ -425,6 +501,24 @@ log4cplus::pattern::BasicPatternConverter::convert
 
 
 
+void
+log4cplus::pattern::BasicPatternConverter::append
+                                            (log4cplus::tstring& result,
+                                             const InternalLoggingEvent& event)
+{
+    // fields, which are kept by the event, are appended without copying
+    switch(type) {
+    case NDC_CONVERTER:      result.append(event.getNDC());          break;
+    case MESSAGE_CONVERTER:  result.append(event.getMessage());      break;
+    case NEWLINE_CONVERTER:  result.push_back(LOG4CPLUS_TEXT('\n')); break;
+    case FILE_CONVERTER:     result.append(event.getFile());         break;
+    case THREAD_CONVERTER:   result.append(event.getThread());       break;
+    default:                 result.append(convert(event));
+    }
+}
+
+
+
 ////////////////////////////////////////////////
 // LoggerPatternConverter methods:
 ////////////////////////////////////////////////
@@ -476,8 +570,50 @@ log4cplus::pattern::DatePatternConverter::DatePatternConverter
                                                 bool use_gmtime_)
 : PatternConverter(info),
   use_gmtime(use_gmtime_),
-  format(pattern)
+  format(pattern),
+  cachedSecond(0),
+  cacheValid(false)
+{
+    split();
+}
+
+
+
+void
+log4cplus::pattern::DatePatternConverter::split()
 {
+    Segment text;
+    text.field = 0;
+
+    for(tstring::size_type i = 0; i < format.length(); ++i) {
+        log4cplus::tchar c = format[i];
+
+        if(c == LOG4CPLUS_TEXT('%') && i + 1 < format.length()) {
+            log4cplus::tchar next = format[++i];
+
+            if(next == LOG4CPLUS_TEXT('q') || next == LOG4CPLUS_TEXT('Q')) {
+                if(!text.format.empty()) {
+                    segments.push_back(text);
+                    text.format.clear();
+                }
+
+                Segment field;
+                field.field = next;
+                segments.push_back(field);
+                continue;
+            }
+
+            text.format.push_back(c);
+            text.format.push_back(next);
+        }
+        else {
+            text.format.push_back(c);
+        }
+    }
+
+    if(!text.format.empty()) {
+        segments.push_back(text);
+    }
 }
 
 
@@ -486,7 +622,64 @@ log4cplus::tstring
 log4cplus::pattern::DatePatternConverter::convert
                                             (const InternalLoggingEvent& event)
 {
-    return event.getTimestamp().getFormattedTime(format, use_gmtime);
+    log4cplus::tstring result;
+    append(result, event);
+    return result;
+}
+
+
+
+void
+log4cplus::pattern::DatePatternConverter::append
+                                            (log4cplus::tstring& result,
+                                             const InternalLoggingEvent& event)
+{
+    const Time& timestamp = event.getTimestamp();
+
+    // strftime is called once per second, since the layout is used under
+    // lock of its appender
+    if(!cacheValid || timestamp.sec() != cachedSecond) {
+        Time second(timestamp.sec(), 0);
+
+        for(std::vector<Segment>::iterator it = segments.begin();
+            it != segments.end();
+            ++it)
+        {
+            if(it->field == 0) {
+                it->text = second.getFormattedTime(it->format, use_gmtime);
+            }
+        }
+
+        cachedSecond = timestamp.sec();
+        cacheValid = true;
+    }
+
+    for(std::vector<Segment>::const_iterator it = segments.begin();
+        it != segments.end();
+        ++it)
+    {
+        if(it->field == 0) {
+            result.append(it->text);
+            continue;
+        }
+
+        // %q - milliseconds, %Q - milliseconds with fraction of microseconds
+        long usec = timestamp.usec();
+        long msec = usec / 1000;
+
+        result.push_back(static_cast<log4cplus::tchar>(LOG4CPLUS_TEXT('0') + msec / 100));
+        result.push_back(static_cast<log4cplus::tchar>(LOG4CPLUS_TEXT('0') + msec / 10 % 10));
+        result.push_back(static_cast<log4cplus::tchar>(LOG4CPLUS_TEXT('0') + msec % 10));
+
+        if(it->field == LOG4CPLUS_TEXT('Q')) {
+            usec %= 1000;
+
+            result.push_back(LOG4CPLUS_TEXT('.'));
+            result.push_back(static_cast<log4cplus::tchar>(LOG4CPLUS_TEXT('0') + usec / 100));
+            result.push_back(static_cast<log4cplus::tchar>(LOG4CPLUS_TEXT('0') + usec / 10 % 10));
+            result.push_back(static_cast<log4cplus::tchar>(LOG4CPLUS_TEXT('0') + usec % 10));
+        }
+    }
 }
 
 
@@ -512,6 +705,56 @@ log4cplus::pattern::HostnamePatternConverter::convert (
 
 
 
+////////////////////////////////////////////////
+// MDCPatternConverter methods:
+////////////////////////////////////////////////
+
+log4cplus::pattern::MDCPatternConverter::MDCPatternConverter (
+    const FormattingInfo& info, const log4cplus::tstring& key_)
+    : PatternConverter(info)
+    , key(key_)
+{ }
+
+
+log4cplus::tstring
+log4cplus::pattern::MDCPatternConverter::convert (
+    const InternalLoggingEvent& event)
+{
+    log4cplus::tstring result;
+    append(result, event);
+    return result;
+}
+
+
+void
+log4cplus::pattern::MDCPatternConverter::append (
+    log4cplus::tstring& result, const InternalLoggingEvent& event)
+{
+    const MappedContextCopy& mdc = event.getMDC();
+
+    for (MappedContextCopy::const_iterator it = mdc.begin();
+         it != mdc.end();
+         ++it)
+    {
+        if (key.empty())
+        {
+            if (it != mdc.begin())
+                result.push_back(LOG4CPLUS_TEXT(' '));
+
+            result.append(it->first);
+            result.push_back(LOG4CPLUS_TEXT('='));
+            result.append(it->second);
+        }
+        else if (it->first == key)
+        {
+            result.append(it->second);
+            return;
+        }
+    }
+}
+
+
+
 ////////////////////////////////////////////////
 // NDCPatternConverter methods:
 ////////////////////////////////////////////////
@@ -836,10 +1079,10 @@ log4cplus::pattern::PatternParser::finalizeConverter(log4cplus::tchar c)
             //getLogLog().debug("NDC converter.");      
             break;
 
-        // 'X' is MDC in log4j.
-        // Not implemented.
         case LOG4CPLUS_TEXT('X'):
-            goto not_implemented;
+            pc = new MDCPatternConverter (formattingInfo, extractOption());
+            //getLogLog().debug("MDC converter.");
+            break;
 
 not_implemented:;
         default:
@@ -946,12 +1189,18 @@ void
 PatternLayout::formatAndAppend(log4cplus::tostream& output, 
                                const InternalLoggingEvent& event)
 {
+    // the event is formatted into reused buffer and written at once, so
+    // the stream isn't called per field and small events allocate nothing
+    formatted.clear();
+
     for(PatternConverterList::iterator it=parsedPattern.begin(); 
         it!=parsedPattern.end(); 
         ++it)
     {
-        (*it)->formatAndAppend(output, event);
+        (*it)->formatAndAppend(formatted, event);
     }
+
+    output.write(formatted.data(), static_cast<std::streamsize>(formatted.length()));
 }
 
 
@@ -46,10 +46,16 @@ SharedObject::~SharedObject()
 void
 SharedObject::addReference() const
 {
+#if defined (LOG4CPLUS_USE_WIN32_THREADS)
+    InterlockedIncrement (&count);
+#elif defined (LOG4CPLUS_USE_PTHREADS) && defined (__GNUC__)
+    __sync_add_and_fetch (&count, 1);
+#else
     LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( access_mutex )
         assert (count >= 0);
         ++count;
     LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
+#endif
 }
 
 
@@ -57,11 +63,17 @@ void
 SharedObject::removeReference() const
 {
     bool destroy = false;
+#if defined (LOG4CPLUS_USE_WIN32_THREADS)
+    destroy = (InterlockedDecrement (&count) == 0);
+#elif defined (LOG4CPLUS_USE_PTHREADS) && defined (__GNUC__)
+    destroy = (__sync_sub_and_fetch (&count, 1) == 0);
+#else
     LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( access_mutex );
         assert (count > 0);
         if (--count == 0)
             destroy = true;
     LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
+#endif
     if (destroy)
         delete this;
 }
@@ -858,8 +858,12 @@ void DescriptorPool::InternalAddGeneratedFile(
   // Therefore, when we parse one, we have to be very careful to avoid using
   // any descriptor-based operations, since this might cause infinite recursion
   // or deadlock.
+  //
+  // Even the bytes are only remembered here:  they are parsed and indexed by
+  // the database on its first lookup, so static initialization of binaries
+  // with many generated files does not parse any FileDescriptorProto.
   InitGeneratedPoolOnce();
-  GOOGLE_CHECK(generated_database_->Add(encoded_file_descriptor, size));
+  generated_database_->AddLazily(encoded_file_descriptor, size);
 }
 
 
@@ -325,21 +325,45 @@ bool EncodedDescriptorDatabase::AddCopy(
   return Add(copy, size);
 }
 
+void EncodedDescriptorDatabase::AddLazily(
+    const void* encoded_file_descriptor, int size) {
+  MutexLock lock(&pending_mutex_);
+  pending_.push_back(make_pair(encoded_file_descriptor, size));
+}
+
+void EncodedDescriptorDatabase::IndexPending() {
+  MutexLock lock(&pending_mutex_);
+  if (pending_.empty()) return;
+
+  // Files are indexed in order of registration, so conflicts are resolved
+  // the same way as if they were added eagerly.
+  for (int i = 0; i < pending_.size(); i++) {
+    if (!Add(pending_[i].first, pending_[i].second)) {
+      GOOGLE_LOG(ERROR) << "Generated file descriptor could not be indexed "
+                    "by EncodedDescriptorDatabase::AddLazily().";
+    }
+  }
+  pending_.clear();
+}
+
 bool EncodedDescriptorDatabase::FindFileByName(
     const string& filename,
     FileDescriptorProto* output) {
+  IndexPending();
   return MaybeParse(index_.FindFile(filename), output);
 }
 
 bool EncodedDescriptorDatabase::FindFileContainingSymbol(
     const string& symbol_name,
     FileDescriptorProto* output) {
+  IndexPending();
   return MaybeParse(index_.FindSymbol(symbol_name), output);
 }
 
 bool EncodedDescriptorDatabase::FindNameOfFileContainingSymbol(
     const string& symbol_name,
     string* output) {
+  IndexPending();
   pair<const void*, int> encoded_file = index_.FindSymbol(symbol_name);
   if (encoded_file.first == NULL) return false;
 
@@ -370,6 +394,7 @@ bool EncodedDescriptorDatabase::FindFileContainingExtension(
     const string& containing_type,
     int field_number,
     FileDescriptorProto* output) {
+  IndexPending();
   return MaybeParse(index_.FindExtension(containing_type, field_number),
                     output);
 }
@@ -377,6 +402,7 @@ bool EncodedDescriptorDatabase::FindFileContainingExtension(
 bool EncodedDescriptorDatabase::FindAllExtensionNumbers(
     const string& extendee_type,
     vector<int>* output) {
+  IndexPending();
   return index_.FindAllExtensionNumbers(extendee_type, output);
 }
 
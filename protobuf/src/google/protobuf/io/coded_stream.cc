@@ -319,6 +319,89 @@ inline const uint8* ReadVarint32FromArray(const uint8* buffer, uint32* value) {
   return ptr;
 }
 
+#if defined(PROTOBUF_LITTLE_ENDIAN)
+
+// Decodes a varint from a word of its first 8 bytes instead of going
+// through them one at a time.  The buffer must have at least
+// kMaxVarintBytes bytes.  The terminating byte is found from the
+// continuation bits of the word, and then the 7-bit groups are packed
+// together in three steps, without branches on each byte.
+inline const uint8* ReadVarint64FromWord(
+    const uint8* buffer, uint64* value) GOOGLE_ATTRIBUTE_ALWAYS_INLINE;
+inline const uint8* ReadVarint64FromWord(const uint8* buffer, uint64* value) {
+  uint64 word;
+  memcpy(&word, buffer, sizeof(word));
+
+  // One bit per byte which terminates the varint.
+  uint64 stop = ~word & GOOGLE_ULONGLONG(0x8080808080808080);
+
+  if (stop == 0) {
+    // The varint is 9 or 10 bytes long.
+    uint32 b8 = buffer[8];
+    uint64 result = word & GOOGLE_ULONGLONG(0x7F7F7F7F7F7F7F7F);
+    result = ((result & GOOGLE_ULONGLONG(0x7F007F007F007F00)) >> 1) |
+              (result & GOOGLE_ULONGLONG(0x007F007F007F007F));
+    result = ((result & GOOGLE_ULONGLONG(0x3FFF00003FFF0000)) >> 2) |
+              (result & GOOGLE_ULONGLONG(0x00003FFF00003FFF));
+    result = ((result & GOOGLE_ULONGLONG(0x0FFFFFFF00000000)) >> 4) |
+              (result & GOOGLE_ULONGLONG(0x000000000FFFFFFF));
+    result |= static_cast<uint64>(b8 & 0x7F) << 56;
+    if (!(b8 & 0x80)) {
+      *value = result;
+      return buffer + 9;
+    }
+    uint32 b9 = buffer[9];
+    // We have overrun the maximum size of a varint (10 bytes).  The data
+    // must be corrupt.
+    if (b9 & 0x80) return NULL;
+    *value = result | (static_cast<uint64>(b9) << 63);
+    return buffer + 10;
+  }
+
+  // Keep the bytes up to the terminating one (its stop bit included; the
+  // masks below drop it).
+  uint64 result = word & (stop ^ (stop - 1));
+  result = ((result & GOOGLE_ULONGLONG(0x7F007F007F007F00)) >> 1) |
+            (result & GOOGLE_ULONGLONG(0x007F007F007F007F));
+  result = ((result & GOOGLE_ULONGLONG(0x3FFF00003FFF0000)) >> 2) |
+            (result & GOOGLE_ULONGLONG(0x00003FFF00003FFF));
+  result = ((result & GOOGLE_ULONGLONG(0x0FFFFFFF00000000)) >> 4) |
+            (result & GOOGLE_ULONGLONG(0x000000000FFFFFFF));
+  *value = result;
+
+#if defined(__GNUC__) && ((__GNUC__ > 3) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4))
+  return buffer + (__builtin_ctzll(stop) >> 3) + 1;
+#else
+  int size = 1;
+  while (!(stop & 0x80)) {
+    stop >>= 8;
+    ++size;
+  }
+  return buffer + size;
+#endif
+}
+
+#endif  // PROTOBUF_LITTLE_ENDIAN
+
+// Decodes a 32-bit varint when the buffer is known to contain the whole
+// varint: either it has at least kMaxVarintBytes bytes, or the varint
+// ends at the end of the buffer.
+inline const uint8* ReadVarint32FromBuffer(
+    const uint8* buffer, int size, uint32* value) GOOGLE_ATTRIBUTE_ALWAYS_INLINE;
+inline const uint8* ReadVarint32FromBuffer(
+    const uint8* buffer, int size, uint32* value) {
+#if defined(PROTOBUF_LITTLE_ENDIAN)
+  if (size >= kMaxVarintBytes) {
+    uint64 result;
+    const uint8* end = ReadVarint64FromWord(buffer, &result);
+    // The high-order bits of larger input are discarded.
+    *value = static_cast<uint32>(result);
+    return end;
+  }
+#endif
+  return ReadVarint32FromArray(buffer, value);
+}
+
 }  // namespace
 
 bool CodedInputStream::ReadVarint32Slow(uint32* value) {
@@ -335,7 +418,7 @@ bool CodedInputStream::ReadVarint32Fallback(uint32* value) {
       // Optimization:  If the varint ends at exactly the end of the buffer,
       // we can detect that and still use the fast path.
       (buffer_end_ > buffer_ && !(buffer_end_[-1] & 0x80))) {
-    const uint8* end = ReadVarint32FromArray(buffer_, value);
+    const uint8* end = ReadVarint32FromBuffer(buffer_, BufferSize(), value);
     if (end == NULL) return false;
     buffer_ = end;
     return true;
@@ -379,7 +462,7 @@ uint32 CodedInputStream::ReadTagFallback() {
       // we can detect that and still use the fast path.
       (buffer_end_ > buffer_ && !(buffer_end_[-1] & 0x80))) {
     uint32 tag;
-    const uint8* end = ReadVarint32FromArray(buffer_, &tag);
+    const uint8* end = ReadVarint32FromBuffer(buffer_, BufferSize(), &tag);
     if (end == NULL) {
       return 0;
     }
@@ -432,6 +515,15 @@ bool CodedInputStream::ReadVarint64Fallback(uint64* value) {
     // Fast path:  We have enough bytes left in the buffer to guarantee that
     // this read won't cross the end, so we can skip the checks.
 
+#if defined(PROTOBUF_LITTLE_ENDIAN)
+    if (BufferSize() >= kMaxVarintBytes) {
+      const uint8* end = ReadVarint64FromWord(buffer_, value);
+      if (end == NULL) return false;
+      buffer_ = end;
+      return true;
+    }
+#endif
+
     const uint8* ptr = buffer_;
     uint32 b;
 
@@ -0,0 +1,365 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+/** @file protoc/src/google/protobuf/compiler/bdb/bdb_generator.cc
+ * Contains implementation of BDB code generator.
+ * @author Artem Rodygin
+ */
+
+#include <google/protobuf/compiler/bdb/bdb_generator.h>
+
+// Standard C/C++ Libraries
+#include <string>
+#include <vector>
+
+// Protocol Buffers
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/io/printer.h>
+#include <google/protobuf/io/zero_copy_stream.h>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/unknown_field_set.h>
+
+/** @defgroup bdboptions Numbers of custom options (see "bdb.proto"). */
+//@{
+#define BDB_OPTION_SORT_KEY     51001   /**< Generate keys comparison function. */
+#define BDB_OPTION_INDEX_KEY    51002   /**< Generate index function.           */
+//@}
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+namespace bdb {
+
+using std::vector;
+
+//--------------------------------------------------------------------------------------------------
+//  Helper functions.
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Finds custom option with specified number in options of specified field.
+ * Custom options are unknown to the compiler, so they are kept as unknown fields of the options.
+ */
+static const UnknownField * find_option (const FieldDescriptor * field, int number)
+{
+    const UnknownFieldSet & options = field->options().unknown_fields();
+
+    for (int i = 0; i < options.field_count(); i++)
+    {
+        if (options.field(i).number() == number)
+        {
+            return &options.field(i);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Returns name of "bdb::compare_field" type of specified field, or empty string if the type is not supported.
+ */
+static string field_type (const FieldDescriptor * field)
+{
+    switch (field->type())
+    {
+        case FieldDescriptor::TYPE_STRING:
+        case FieldDescriptor::TYPE_BYTES:       return "BDB_FIELD_STRING";
+        case FieldDescriptor::TYPE_INT32:
+        case FieldDescriptor::TYPE_ENUM:        return "BDB_FIELD_INT32";
+        case FieldDescriptor::TYPE_INT64:       return "BDB_FIELD_INT64";
+        case FieldDescriptor::TYPE_UINT32:
+        case FieldDescriptor::TYPE_BOOL:        return "BDB_FIELD_UINT32";
+        case FieldDescriptor::TYPE_UINT64:      return "BDB_FIELD_UINT64";
+        case FieldDescriptor::TYPE_SINT32:      return "BDB_FIELD_SINT32";
+        case FieldDescriptor::TYPE_SINT64:      return "BDB_FIELD_SINT64";
+        case FieldDescriptor::TYPE_FIXED32:     return "BDB_FIELD_FIXED32";
+        case FieldDescriptor::TYPE_FIXED64:     return "BDB_FIELD_FIXED64";
+        case FieldDescriptor::TYPE_SFIXED32:    return "BDB_FIELD_SFIXED32";
+        case FieldDescriptor::TYPE_SFIXED64:    return "BDB_FIELD_SFIXED64";
+        case FieldDescriptor::TYPE_FLOAT:       return "BDB_FIELD_FLOAT";
+        case FieldDescriptor::TYPE_DOUBLE:      return "BDB_FIELD_DOUBLE";
+        default:                                return "";
+    }
+}
+
+/**
+ * Returns name of generated function for specified field, e.g. "data_season_index".
+ * The name is relative to the package namespace.
+ */
+static string function_name (const FieldDescriptor * field, const string & suffix)
+{
+    string name = field->containing_type()->full_name();
+    const string & package = field->file()->package();
+
+    if (!package.empty())
+    {
+        name = name.substr(package.size() + 1);
+    }
+
+    return StringReplace(name, ".", "_", true) + "_" + field->name() + "_" + suffix;
+}
+
+/**
+ * Returns file name without ".proto" extension.
+ */
+static string strip_proto (const string & filename)
+{
+    return HasSuffixString(filename, ".proto") ? StripSuffixString(filename, ".proto") : filename;
+}
+
+/**
+ * Single function to be generated.
+ */
+struct function
+{
+    string name;        /**< Name of the function.                                          */
+    bool   index;       /**< Whether it's an index function (otherwise, comparison one).     */
+    string number;      /**< Number of the field.                                           */
+    string type;        /**< Type of the field (for comparison function).                   */
+    string key_number;  /**< Number of the field in index key (for index function).         */
+};
+
+/**
+ * Collects functions to be generated for all fields of specified message and its nested messages.
+ * Returns "false" and sets "error" if the options are invalid.
+ */
+static bool collect (const Descriptor * message, vector <function> & functions, string * error)
+{
+    for (int i = 0; i < message->field_count(); i++)
+    {
+        const FieldDescriptor * field = message->field(i);
+
+        const UnknownField * sort_key  = find_option(field, BDB_OPTION_SORT_KEY);
+        const UnknownField * index_key = find_option(field, BDB_OPTION_INDEX_KEY);
+
+        if (sort_key == NULL && index_key == NULL) continue;
+
+        if (field->is_repeated() || field_type(field).empty())
+        {
+            *error = field->full_name() + ": BDB options are supported for non-repeated scalar fields only.";
+            return false;
+        }
+
+        if (sort_key != NULL && sort_key->type() == UnknownField::TYPE_VARINT && sort_key->varint() != 0)
+        {
+            function f;
+            f.name   = function_name(field, "compare");
+            f.index  = false;
+            f.number = SimpleItoa(field->number());
+            f.type   = field_type(field);
+            functions.push_back(f);
+        }
+
+        if (index_key != NULL && index_key->type() == UnknownField::TYPE_LENGTH_DELIMITED)
+        {
+            const string   & name    = index_key->length_delimited();
+            const string   & package = field->file()->package();
+            const Descriptor * key   = field->file()->pool()->FindMessageTypeByName(name);
+
+            if (key == NULL && !package.empty())
+            {
+                key = field->file()->pool()->FindMessageTypeByName(package + "." + name);
+            }
+
+            if (key == NULL)
+            {
+                *error = field->full_name() + ": unknown index key \"" + name + "\".";
+                return false;
+            }
+
+            const FieldDescriptor * key_field = key->FindFieldByName(field->name());
+
+            if (key_field == NULL && key->field_count() == 1)
+            {
+                key_field = key->field(0);
+            }
+
+            if (key_field == NULL || key_field->type() != field->type() || key_field->is_repeated())
+            {
+                *error = field->full_name() + ": index key \"" + key->full_name() + "\" has no matching field.";
+                return false;
+            }
+
+            function f;
+            f.name       = function_name(field, "index");
+            f.index      = true;
+            f.number     = SimpleItoa(field->number());
+            f.key_number = SimpleItoa(key_field->number());
+            functions.push_back(f);
+        }
+    }
+
+    for (int i = 0; i < message->nested_type_count(); i++)
+    {
+        if (!collect(message->nested_type(i), functions, error)) return false;
+    }
+
+    return true;
+}
+
+/**
+ * Prints opening of package namespaces.
+ */
+static void open_namespaces (io::Printer & printer, const vector <string> & parts)
+{
+    for (unsigned int i = 0; i < parts.size(); i++)
+    {
+        printer.Print("namespace $part$ {\n", "part", parts[i]);
+    }
+
+    if (!parts.empty()) printer.Print("\n");
+}
+
+/**
+ * Prints closing of package namespaces.
+ */
+static void close_namespaces (io::Printer & printer, const vector <string> & parts)
+{
+    if (!parts.empty()) printer.Print("\n");
+
+    for (int i = (int) parts.size() - 1; i >= 0; i--)
+    {
+        printer.Print("}  // namespace $part$\n", "part", parts[i]);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Implementation of class "BdbGenerator".
+//--------------------------------------------------------------------------------------------------
+
+BdbGenerator::BdbGenerator ()
+{ }
+
+BdbGenerator::~BdbGenerator ()
+{ }
+
+/**
+ * Generates "foo.bdb.h" and "foo.bdb.cc" for specified "foo.proto".
+ */
+bool BdbGenerator::Generate (const FileDescriptor * file,
+                             const string &,
+                             GeneratorContext * generator_context,
+                             string * error) const
+{
+    vector <function> functions;
+
+    for (int i = 0; i < file->message_type_count(); i++)
+    {
+        if (!collect(file->message_type(i), functions, error)) return false;
+    }
+
+    string basename = strip_proto(file->name());
+    string guard    = "BDB_" + StringReplace(StringReplace(basename, "/", "_", true), ".", "_", true) + "_INCLUDED";
+
+    vector <string> parts;
+    SplitStringUsing(file->package(), ".", &parts);
+
+    // header
+    {
+        scoped_ptr <io::ZeroCopyOutputStream> output(generator_context->Open(basename + ".bdb.h"));
+        io::Printer printer(output.get(), '$');
+
+        printer.Print("// Generated by the BDB code generator.  DO NOT EDIT!\n"
+                      "// source: $filename$\n"
+                      "\n"
+                      "#ifndef $guard$\n"
+                      "#define $guard$\n"
+                      "\n"
+                      "#include <bdb.h>\n"
+                      "\n",
+                      "filename", file->name(),
+                      "guard", guard);
+
+        open_namespaces(printer, parts);
+
+        for (unsigned int i = 0; i < functions.size(); i++)
+        {
+            if (functions[i].index)
+            {
+                printer.Print("int $name$ (DB *, const DBT * key, const DBT * data, DBT * result);\n", "name", functions[i].name);
+            }
+            else
+            {
+                printer.Print("int $name$ (DB *, const DBT * dbt1, const DBT * dbt2);\n", "name", functions[i].name);
+            }
+        }
+
+        close_namespaces(printer, parts);
+
+        printer.Print("\n#endif  // $guard$\n", "guard", guard);
+    }
+
+    // source
+    {
+        scoped_ptr <io::ZeroCopyOutputStream> output(generator_context->Open(basename + ".bdb.cc"));
+        io::Printer printer(output.get(), '$');
+
+        printer.Print("// Generated by the BDB code generator.  DO NOT EDIT!\n"
+                      "// source: $filename$\n"
+                      "\n"
+                      "#include \"$basename$.bdb.h\"\n"
+                      "\n",
+                      "filename", file->name(),
+                      "basename", basename);
+
+        open_namespaces(printer, parts);
+
+        for (unsigned int i = 0; i < functions.size(); i++)
+        {
+            if (i != 0) printer.Print("\n");
+
+            if (functions[i].index)
+            {
+                printer.Print("int $name$ (DB *, const DBT *, const DBT * data, DBT * result)\n"
+                              "{\n"
+                              "    return bdb::index_field(data, $number$, $key_number$, result);\n"
+                              "}\n",
+                              "name", functions[i].name,
+                              "number", functions[i].number,
+                              "key_number", functions[i].key_number);
+            }
+            else
+            {
+                printer.Print("int $name$ (DB *, const DBT * dbt1, const DBT * dbt2)\n"
+                              "{\n"
+                              "    return bdb::compare_field(dbt1, dbt2, $number$, $type$);\n"
+                              "}\n",
+                              "name", functions[i].name,
+                              "number", functions[i].number,
+                              "type", functions[i].type);
+            }
+        }
+
+        close_namespaces(printer, parts);
+    }
+
+    return true;
+}
+
+}  // namespace bdb
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
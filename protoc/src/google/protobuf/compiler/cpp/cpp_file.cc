@@ -51,7 +51,8 @@ namespace cpp {
 // ===================================================================
 
 FileGenerator::FileGenerator(const FileDescriptor* file,
-                             const string& dllexport_decl)
+                             const string& dllexport_decl,
+                             bool fixed_layout)
   : file_(file),
     message_generators_(
       new scoped_ptr<MessageGenerator>[file->message_type_count()]),
@@ -65,7 +66,8 @@ FileGenerator::FileGenerator(const FileDescriptor* file,
 
   for (int i = 0; i < file->message_type_count(); i++) {
     message_generators_[i].reset(
-      new MessageGenerator(file->message_type(i), dllexport_decl));
+      new MessageGenerator(file->message_type(i), dllexport_decl,
+                           fixed_layout));
   }
 
   for (int i = 0; i < file->enum_type_count(); i++) {
@@ -80,9 +80,21 @@ bool CppGenerator::Generate(const FileDescriptor* file,
   // __declspec(dllimport) depending on what is being compiled.
   string dllexport_decl;
 
+  // If the fixed_layout option is passed to the compiler, messages which
+  // have only required fields of scalar (numeric, bool, or enum) types get
+  // straight-line ByteSize() and SerializeWithCachedSizesToArray() code for
+  // the common case when all the fields are set, without checking has-bits
+  // of each field, and a kMaxByteSize constant, so that the message can be
+  // serialized into a buffer on the stack:
+  //   protoc --cpp_out=fixed_layout:outdir foo.proto
+  //   ::google::protobuf::uint8 buffer[Foo::kMaxByteSize];
+  bool fixed_layout = false;
+
   for (int i = 0; i < options.size(); i++) {
     if (options[i].first == "dllexport_decl") {
       dllexport_decl = options[i].second;
+    } else if (options[i].first == "fixed_layout") {
+      fixed_layout = true;
     } else {
       *error = "Unknown generator option: " + options[i].first;
       return false;
@@ -95,7 +107,7 @@ bool CppGenerator::Generate(const FileDescriptor* file,
   string basename = StripProto(file->name());
   basename.append(".pb");
 
-  FileGenerator file_generator(file, dllexport_decl);
+  FileGenerator file_generator(file, dllexport_decl, fixed_layout);
 
   // Generate header.
   {
@@ -275,15 +275,61 @@ void OptimizePadding(vector<const FieldDescriptor*>* fields) {
   }
 }
 
+// Returns the maximum size of the serialized message if it has fixed
+// layout:  all of its fields are required and of scalar types, so that a
+// complete message always has all of them, and nothing else, on the wire.
+// Otherwise returns -1.
+int FixedLayoutMaxSize(const Descriptor* descriptor) {
+  if (descriptor->field_count() == 0 || descriptor->field_count() > 32 ||
+      descriptor->extension_range_count() > 0 ||
+      descriptor->options().message_set_wire_format()) {
+    return -1;
+  }
+
+  int total_size = 0;
+
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    const FieldDescriptor* field = descriptor->field(i);
+    if (!field->is_required()) return -1;
+
+    int value_size;
+    switch (field->type()) {
+      case FieldDescriptor::TYPE_BOOL    : value_size = 1; break;
+      case FieldDescriptor::TYPE_UINT32  :
+      case FieldDescriptor::TYPE_SINT32  : value_size = 5; break;
+      // Negative values of int32 and enums are sign-extended to 64 bits.
+      case FieldDescriptor::TYPE_INT32   :
+      case FieldDescriptor::TYPE_ENUM    :
+      case FieldDescriptor::TYPE_INT64   :
+      case FieldDescriptor::TYPE_UINT64  :
+      case FieldDescriptor::TYPE_SINT64  : value_size = 10; break;
+      case FieldDescriptor::TYPE_FIXED32 :
+      case FieldDescriptor::TYPE_SFIXED32:
+      case FieldDescriptor::TYPE_FLOAT   : value_size = 4; break;
+      case FieldDescriptor::TYPE_FIXED64 :
+      case FieldDescriptor::TYPE_SFIXED64:
+      case FieldDescriptor::TYPE_DOUBLE  : value_size = 8; break;
+      default: return -1;
+    }
+
+    total_size += WireFormat::TagSize(field->number(), field->type()) +
+                  value_size;
+  }
+
+  return total_size;
+}
+
 }
 
 // ===================================================================
 
 MessageGenerator::MessageGenerator(const Descriptor* descriptor,
-                                   const string& dllexport_decl)
+                                   const string& dllexport_decl,
+                                   bool fixed_layout)
   : descriptor_(descriptor),
     classname_(ClassName(descriptor, false)),
     dllexport_decl_(dllexport_decl),
+    max_byte_size_(fixed_layout ? FixedLayoutMaxSize(descriptor) : -1),
     field_generators_(descriptor),
     nested_generators_(new scoped_ptr<MessageGenerator>[
       descriptor->nested_type_count()]),
@@ -294,7 +340,8 @@ MessageGenerator::MessageGenerator(const Descriptor* descriptor,
 
   for (int i = 0; i < descriptor->nested_type_count(); i++) {
     nested_generators_[i].reset(
-      new MessageGenerator(descriptor->nested_type(i), dllexport_decl));
+      new MessageGenerator(descriptor->nested_type(i), dllexport_decl,
+                           fixed_layout));
   }
 
   for (int i = 0; i < descriptor->enum_type_count(); i++) {
@@ -493,6 +540,14 @@ GenerateClassDefinition(io::Printer* printer) {
     "static const $classname$& default_instance();\n"
     "\n");
 
+  if (max_byte_size_ >= 0) {
+    printer->Print(
+      "// Maximum size of the serialized message (fixed layout).\n"
+      "static const int kMaxByteSize = $size$;\n"
+      "\n",
+      "size", SimpleItoa(max_byte_size_));
+  }
+
 
   printer->Print(vars,
     "void Swap($classname$* other);\n"
@@ -861,6 +916,11 @@ GenerateClassMethods(io::Printer* printer) {
       "classname", ClassName(FieldScope(field), false),
       "constant_name", FieldConstantName(field));
   }
+  if (max_byte_size_ >= 0) {
+    printer->Print(
+      "const int $classname$::kMaxByteSize;\n",
+      "classname", classname_);
+  }
   printer->Print(
     "#endif  // !_MSC_VER\n"
     "\n");
@@ -1684,6 +1744,22 @@ GenerateSerializeWithCachedSizesToArray(io::Printer* printer) {
     "classname", classname_);
   printer->Indent();
 
+  if (max_byte_size_ >= 0) {
+    GenerateFixedLayoutCondition(printer);
+    printer->Indent();
+    scoped_array<const FieldDescriptor*> ordered_fields(
+      SortFieldsByNumber(descriptor_));
+    for (int i = 0; i < descriptor_->field_count(); i++) {
+      field_generators_.get(ordered_fields[i])
+                       .GenerateSerializeWithCachedSizesToArray(printer);
+    }
+    printer->Outdent();
+    printer->Print(
+      "  return target;\n"
+      "}\n"
+      "\n");
+  }
+
   GenerateSerializeWithCachedSizesBody(printer, true);
 
   printer->Outdent();
@@ -1774,6 +1850,23 @@ GenerateByteSize(io::Printer* printer) {
     "int total_size = 0;\n"
     "\n");
 
+  if (max_byte_size_ >= 0) {
+    GenerateFixedLayoutCondition(printer);
+    printer->Indent();
+    for (int i = 0; i < descriptor_->field_count(); i++) {
+      field_generators_.get(descriptor_->field(i)).GenerateByteSize(printer);
+    }
+    printer->Print(
+      "GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();\n"
+      "_cached_size_ = total_size;\n"
+      "GOOGLE_SAFE_CONCURRENT_WRITES_END();\n"
+      "return total_size;\n");
+    printer->Outdent();
+    printer->Print(
+      "}\n"
+      "\n");
+  }
+
   int last_index = -1;
 
   for (int i = 0; i < descriptor_->field_count(); i++) {
@@ -1861,6 +1954,23 @@ GenerateByteSize(io::Printer* printer) {
   printer->Print("}\n");
 }
 
+void MessageGenerator::
+GenerateFixedLayoutCondition(io::Printer* printer) {
+  // All fields are required, so their has-bits are the lowest ones.
+  uint32 mask = descriptor_->field_count() == 32 ?
+      0xffffffffu : (1u << descriptor_->field_count()) - 1;
+  char buffer[kFastToBufferSize];
+
+  printer->Print(
+    "// Fast path:  all fields of fixed layout are set.\n"
+    "if ((_has_bits_[0] & 0x$mask$u) == 0x$mask$u",
+    "mask", FastHex32ToBuffer(mask, buffer));
+  if (HasUnknownFields(descriptor_->file())) {
+    printer->Print(" && unknown_fields().empty()");
+  }
+  printer->Print(") {\n");
+}
+
 void MessageGenerator::
 GenerateIsInitialized(io::Printer* printer) {
   printer->Print(
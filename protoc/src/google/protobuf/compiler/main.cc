@@ -34,6 +34,7 @@
 #include <google/protobuf/compiler/cpp/cpp_generator.h>
 #include <google/protobuf/compiler/python/python_generator.h>
 #include <google/protobuf/compiler/java/java_generator.h>
+#include <google/protobuf/compiler/bdb/bdb_generator.h>
 
 
 int main(int argc, char* argv[]) {
@@ -57,5 +58,10 @@ int main(int argc, char* argv[]) {
   cli.RegisterGenerator("--python_out", &py_generator,
                         "Generate Python source file.");
 
+  // BDB callbacks
+  google::protobuf::compiler::bdb::BdbGenerator bdb_generator;
+  cli.RegisterGenerator("--bdb_out", &bdb_generator,
+                        "Generate BDB comparison and index functions.");
+
   return cli.Run(argc, argv);
 }
@@ -0,0 +1,309 @@
+// Generated by the protocol buffer compiler.  DO NOT EDIT!
+// source: counter.proto
+
+#ifndef PROTOBUF_counter_2eproto__INCLUDED
+#define PROTOBUF_counter_2eproto__INCLUDED
+
+#include <string>
+
+#include <google/protobuf/stubs/common.h>
+
+#if GOOGLE_PROTOBUF_VERSION < 2004000
+#error This file was generated by a newer version of protoc which is
+#error incompatible with your Protocol Buffer headers.  Please update
+#error your headers.
+#endif
+#if 2004001 < GOOGLE_PROTOBUF_MIN_PROTOC_VERSION
+#error This file was generated by an older version of protoc which is
+#error incompatible with your Protocol Buffer headers.  Please
+#error regenerate this file with a newer version of protoc.
+#endif
+
+#include <google/protobuf/generated_message_util.h>
+#include <google/protobuf/repeated_field.h>
+#include <google/protobuf/extension_set.h>
+// @@protoc_insertion_point(includes)
+
+namespace counter {
+
+// Internal implementation detail -- do not call these.
+void  protobuf_AddDesc_counter_2eproto();
+void protobuf_AssignDesc_counter_2eproto();
+void protobuf_ShutdownFile_counter_2eproto();
+
+class key;
+class data;
+
+// ===================================================================
+
+class key : public ::google::protobuf::MessageLite {
+ public:
+  key();
+  virtual ~key();
+  
+  key(const key& from);
+  
+  inline key& operator=(const key& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  
+  static const key& default_instance();
+  
+  void Swap(key* other);
+  
+  // implements Message ----------------------------------------------
+  
+  key* New() const;
+  void CheckTypeAndMergeFrom(const ::google::protobuf::MessageLite& from);
+  void CopyFrom(const key& from);
+  void MergeFrom(const key& from);
+  void Clear();
+  bool IsInitialized() const;
+  
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+  
+  ::std::string GetTypeName() const;
+  
+  // nested types ----------------------------------------------------
+  
+  // accessors -------------------------------------------------------
+  
+  // required int64 id = 1;
+  inline bool has_id() const;
+  inline void clear_id();
+  static const int kIdFieldNumber = 1;
+  inline ::google::protobuf::int64 id() const;
+  inline void set_id(::google::protobuf::int64 value);
+  
+  // @@protoc_insertion_point(class_scope:counter.key)
+ private:
+  inline void set_has_id();
+  inline void clear_has_id();
+  
+  ::google::protobuf::int64 id_;
+  
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(1 + 31) / 32];
+  
+  friend void  protobuf_AddDesc_counter_2eproto();
+  friend void protobuf_AssignDesc_counter_2eproto();
+  friend void protobuf_ShutdownFile_counter_2eproto();
+  
+  void InitAsDefaultInstance();
+  static key* default_instance_;
+};
+// -------------------------------------------------------------------
+
+class data : public ::google::protobuf::MessageLite {
+ public:
+  data();
+  virtual ~data();
+  
+  data(const data& from);
+  
+  inline data& operator=(const data& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  
+  static const data& default_instance();
+  
+  void Swap(data* other);
+  
+  // implements Message ----------------------------------------------
+  
+  data* New() const;
+  void CheckTypeAndMergeFrom(const ::google::protobuf::MessageLite& from);
+  void CopyFrom(const data& from);
+  void MergeFrom(const data& from);
+  void Clear();
+  bool IsInitialized() const;
+  
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+  
+  ::std::string GetTypeName() const;
+  
+  // nested types ----------------------------------------------------
+  
+  // accessors -------------------------------------------------------
+  
+  // required string name = 1;
+  inline bool has_name() const;
+  inline void clear_name();
+  static const int kNameFieldNumber = 1;
+  inline const ::std::string& name() const;
+  inline void set_name(const ::std::string& value);
+  inline void set_name(const char* value);
+  inline void set_name(const char* value, size_t size);
+  inline ::std::string* mutable_name();
+  inline ::std::string* release_name();
+  
+  // required int64 value = 2;
+  inline bool has_value() const;
+  inline void clear_value();
+  static const int kValueFieldNumber = 2;
+  inline ::google::protobuf::int64 value() const;
+  inline void set_value(::google::protobuf::int64 value);
+  
+  // @@protoc_insertion_point(class_scope:counter.data)
+ private:
+  inline void set_has_name();
+  inline void clear_has_name();
+  inline void set_has_value();
+  inline void clear_has_value();
+  
+  ::std::string* name_;
+  ::google::protobuf::int64 value_;
+  
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(2 + 31) / 32];
+  
+  friend void  protobuf_AddDesc_counter_2eproto();
+  friend void protobuf_AssignDesc_counter_2eproto();
+  friend void protobuf_ShutdownFile_counter_2eproto();
+  
+  void InitAsDefaultInstance();
+  static data* default_instance_;
+};
+// ===================================================================
+
+
+// ===================================================================
+
+// key
+
+// required int64 id = 1;
+inline bool key::has_id() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void key::set_has_id() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void key::clear_has_id() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void key::clear_id() {
+  id_ = GOOGLE_LONGLONG(0);
+  clear_has_id();
+}
+inline ::google::protobuf::int64 key::id() const {
+  return id_;
+}
+inline void key::set_id(::google::protobuf::int64 value) {
+  set_has_id();
+  id_ = value;
+}
+
+// -------------------------------------------------------------------
+
+// data
+
+// required string name = 1;
+inline bool data::has_name() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void data::set_has_name() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void data::clear_has_name() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void data::clear_name() {
+  if (name_ != &::google::protobuf::internal::kEmptyString) {
+    name_->clear();
+  }
+  clear_has_name();
+}
+inline const ::std::string& data::name() const {
+  return *name_;
+}
+inline void data::set_name(const ::std::string& value) {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  name_->assign(value);
+}
+inline void data::set_name(const char* value) {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  name_->assign(value);
+}
+inline void data::set_name(const char* value, size_t size) {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  name_->assign(reinterpret_cast<const char*>(value), size);
+}
+inline ::std::string* data::mutable_name() {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  return name_;
+}
+inline ::std::string* data::release_name() {
+  clear_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    return NULL;
+  } else {
+    ::std::string* temp = name_;
+    name_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+    return temp;
+  }
+}
+
+// required int64 value = 2;
+inline bool data::has_value() const {
+  return (_has_bits_[0] & 0x00000002u) != 0;
+}
+inline void data::set_has_value() {
+  _has_bits_[0] |= 0x00000002u;
+}
+inline void data::clear_has_value() {
+  _has_bits_[0] &= ~0x00000002u;
+}
+inline void data::clear_value() {
+  value_ = GOOGLE_LONGLONG(0);
+  clear_has_value();
+}
+inline ::google::protobuf::int64 data::value() const {
+  return value_;
+}
+inline void data::set_value(::google::protobuf::int64 value) {
+  set_has_value();
+  value_ = value;
+}
+
+
+// @@protoc_insertion_point(namespace_scope)
+
+}  // namespace counter
+
+// @@protoc_insertion_point(global_scope)
+
+#endif  // PROTOBUF_counter_2eproto__INCLUDED
@@ -0,0 +1,21 @@
+// Generated by the BDB code generator.  DO NOT EDIT!
+// source: month.proto
+
+#ifndef BDB_month_INCLUDED
+#define BDB_month_INCLUDED
+
+#include <bdb.h>
+
+namespace month {
+
+int key_month_compare (DB *, const DBT * dbt1, const DBT * dbt2);
+int data_season_index (DB *, const DBT * key, const DBT * data, DBT * result);
+int data_days_index (DB *, const DBT * key, const DBT * data, DBT * result);
+int data_ordnum_index (DB *, const DBT * key, const DBT * data, DBT * result);
+int season_ix_season_compare (DB *, const DBT * dbt1, const DBT * dbt2);
+int days_ix_days_compare (DB *, const DBT * dbt1, const DBT * dbt2);
+int ordnum_ix_ordnum_compare (DB *, const DBT * dbt1, const DBT * dbt2);
+
+}  // namespace month
+
+#endif  // BDB_month_INCLUDED
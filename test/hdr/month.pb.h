@@ -13,7 +13,7 @@
 #error incompatible with your Protocol Buffer headers.  Please update
 #error your headers.
 #endif
-#if 2004000 < GOOGLE_PROTOBUF_MIN_PROTOC_VERSION
+#if 2004001 < GOOGLE_PROTOBUF_MIN_PROTOC_VERSION
 #error This file was generated by an older version of protoc which is
 #error incompatible with your Protocol Buffer headers.  Please
 #error regenerate this file with a newer version of protoc.
@@ -23,6 +23,7 @@
 #include <google/protobuf/repeated_field.h>
 #include <google/protobuf/extension_set.h>
 #include <google/protobuf/generated_message_reflection.h>
+#include "bdb.pb.h"
 // @@protoc_insertion_point(includes)
 
 namespace month {
@@ -341,6 +342,9 @@ class days_ix : public ::google::protobuf::Message {
   static const ::google::protobuf::Descriptor* descriptor();
   static const days_ix& default_instance();
   
+  // Maximum size of the serialized message (fixed layout).
+  static const int kMaxByteSize = 11;
+  
   void Swap(days_ix* other);
   
   // implements Message ----------------------------------------------
@@ -423,6 +427,9 @@ class ordnum_ix : public ::google::protobuf::Message {
   static const ::google::protobuf::Descriptor* descriptor();
   static const ordnum_ix& default_instance();
   
+  // Maximum size of the serialized message (fixed layout).
+  static const int kMaxByteSize = 11;
+  
   void Swap(ordnum_ix* other);
   
   // implements Message ----------------------------------------------
@@ -0,0 +1,43 @@
+// Generated by the BDB code generator.  DO NOT EDIT!
+// source: month.proto
+
+#include "month.bdb.h"
+
+namespace month {
+
+int key_month_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    return bdb::compare_field(dbt1, dbt2, 1, BDB_FIELD_STRING);
+}
+
+int data_season_index (DB *, const DBT *, const DBT * data, DBT * result)
+{
+    return bdb::index_field(data, 1, 1, result);
+}
+
+int data_days_index (DB *, const DBT *, const DBT * data, DBT * result)
+{
+    return bdb::index_field(data, 2, 1, result);
+}
+
+int data_ordnum_index (DB *, const DBT *, const DBT * data, DBT * result)
+{
+    return bdb::index_field(data, 3, 1, result);
+}
+
+int season_ix_season_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    return bdb::compare_field(dbt1, dbt2, 1, BDB_FIELD_STRING);
+}
+
+int days_ix_days_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    return bdb::compare_field(dbt1, dbt2, 1, BDB_FIELD_INT32);
+}
+
+int ordnum_ix_ordnum_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    return bdb::compare_field(dbt1, dbt2, 1, BDB_FIELD_INT64);
+}
+
+}  // namespace month
@@ -164,12 +164,15 @@ void protobuf_AddDesc_month_2eproto() {
   already_here = true;
   GOOGLE_PROTOBUF_VERIFY_VERSION;
 
+  ::bdb::protobuf_AddDesc_bdb_2eproto();
   ::google::protobuf::DescriptorPool::InternalAddGeneratedFile(
-    "\n\013month.proto\022\005month\"\024\n\003key\022\r\n\005month\030\001 \002"
-    "(\t\"4\n\004data\022\016\n\006season\030\001 \002(\t\022\014\n\004days\030\002 \002(\005"
-    "\022\016\n\006ordnum\030\003 \002(\003\"\033\n\tseason_ix\022\016\n\006season\030"
-    "\001 \002(\t\"\027\n\007days_ix\022\014\n\004days\030\001 \002(\005\"\033\n\tordnum"
-    "_ix\022\016\n\006ordnum\030\001 \002(\003", 179);
+    "\n\013month.proto\022\005month\032\tbdb.proto\"\032\n\003key\022\023"
+    "\n\005month\030\001 \002(\tB\004\310\363\030\001\"_\n\004data\022\035\n\006season\030\001 "
+    "\002(\tB\r\322\363\030\tseason_ix\022\031\n\004days\030\002 \002(\005B\013\322\363\030\007da"
+    "ys_ix\022\035\n\006ordnum\030\003 \002(\003B\r\322\363\030\tordnum_ix\"!\n\t"
+    "season_ix\022\024\n\006season\030\001 \002(\tB\004\310\363\030\001\"\035\n\007days_"
+    "ix\022\022\n\004days\030\001 \002(\005B\004\310\363\030\001\"!\n\tordnum_ix\022\024\n\006o"
+    "rdnum\030\001 \002(\003B\004\310\363\030\001", 257);
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
     "month.proto", &protobuf_RegisterTypes);
   key::default_instance_ = new key();
@@ -952,6 +955,7 @@ void season_ix::Swap(season_ix* other) {
 
 #ifndef _MSC_VER
 const int days_ix::kDaysFieldNumber;
+const int days_ix::kMaxByteSize;
 #endif  // !_MSC_VER
 
 days_ix::days_ix()
@@ -1063,6 +1067,12 @@ void days_ix::SerializeWithCachedSizes(
 
 ::google::protobuf::uint8* days_ix::SerializeWithCachedSizesToArray(
     ::google::protobuf::uint8* target) const {
+  // Fast path:  all fields of fixed layout are set.
+  if ((_has_bits_[0] & 0x00000001u) == 0x00000001u && unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(1, this->days(), target);
+    return target;
+  }
+  
   // required int32 days = 1;
   if (has_days()) {
     target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(1, this->days(), target);
@@ -1078,6 +1088,17 @@ void days_ix::SerializeWithCachedSizes(
 int days_ix::ByteSize() const {
   int total_size = 0;
   
+  // Fast path:  all fields of fixed layout are set.
+  if ((_has_bits_[0] & 0x00000001u) == 0x00000001u && unknown_fields().empty()) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::Int32Size(
+        this->days());
+    GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+    _cached_size_ = total_size;
+    GOOGLE_SAFE_CONCURRENT_WRITES_END();
+    return total_size;
+  }
+  
   if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
     // required int32 days = 1;
     if (has_days()) {
@@ -1160,6 +1181,7 @@ void days_ix::Swap(days_ix* other) {
 
 #ifndef _MSC_VER
 const int ordnum_ix::kOrdnumFieldNumber;
+const int ordnum_ix::kMaxByteSize;
 #endif  // !_MSC_VER
 
 ordnum_ix::ordnum_ix()
@@ -1271,6 +1293,12 @@ void ordnum_ix::SerializeWithCachedSizes(
 
 ::google::protobuf::uint8* ordnum_ix::SerializeWithCachedSizesToArray(
     ::google::protobuf::uint8* target) const {
+  // Fast path:  all fields of fixed layout are set.
+  if ((_has_bits_[0] & 0x00000001u) == 0x00000001u && unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(1, this->ordnum(), target);
+    return target;
+  }
+  
   // required int64 ordnum = 1;
   if (has_ordnum()) {
     target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(1, this->ordnum(), target);
@@ -1286,6 +1314,17 @@ void ordnum_ix::SerializeWithCachedSizes(
 int ordnum_ix::ByteSize() const {
   int total_size = 0;
   
+  // Fast path:  all fields of fixed layout are set.
+  if ((_has_bits_[0] & 0x00000001u) == 0x00000001u && unknown_fields().empty()) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::Int64Size(
+        this->ordnum());
+    GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+    _cached_size_ = total_size;
+    GOOGLE_SAFE_CONCURRENT_WRITES_END();
+    return total_size;
+  }
+  
   if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
     // required int64 ordnum = 1;
     if (has_ordnum()) {
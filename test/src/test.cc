@@ -25,7 +25,18 @@
 #include <bdb.h>
 
 // Standard C/C++ Libraries
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+// Protocol Buffers
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/dynamic_message.h>
 
 // C++ Logging Library
 #include <log4cplus/logger.h>
@@ -36,7 +47,9 @@ using namespace std;
 
 // Data schema.
 #include <month.pb.h>
+#include <month.bdb.h>
 #include <season.pb.h>
+#include <counter.pb.h>
 
 // Name of database.
 #define DATABASE_NAME   "testdb"
@@ -143,12 +156,8 @@ int days_ix_index (DB *, const DBT *, const DBT * data, DBT * result)
 // Sort callback function.
 int ordnum_ix_compare (DB *, const DBT * dbt1, const DBT * dbt2)
 {
-    month::ordnum_ix key1, key2;
-
-    bdb::unserialize(dbt1, &key1);
-    bdb::unserialize(dbt2, &key2);
-
-    return (int)(key1.ordnum() - key2.ordnum());
+    // difference of "int64" values can't be returned as "int"
+    return bdb::int64_key_compare(NULL, dbt1, dbt2);
 }
 
 // Index callback function.
@@ -164,6 +173,297 @@ int ordnum_ix_index (DB *, const DBT *, const DBT * data, DBT * result)
     return 0;
 }
 
+//--------------------------------------------------------------------------------------------------
+// Custom memory allocator.
+//--------------------------------------------------------------------------------------------------
+
+// Number of allocated and freed blocks.
+int allocated = 0, freed = 0;
+
+void * counting_malloc (size_t size)
+{
+    allocated++;
+    return malloc(size);
+}
+
+void * counting_realloc (void * ptr, size_t size)
+{
+    if (ptr == NULL) allocated++;
+    return realloc(ptr, size);
+}
+
+void counting_free (void * ptr)
+{
+    if (ptr != NULL) freed++;
+    free(ptr);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Covering index.
+//--------------------------------------------------------------------------------------------------
+
+// Projection callback function.
+int days_projection (DB *, const DBT *, const DBT * data, DBT * result)
+{
+    static const int fields[] = { month::data::kDaysFieldNumber };
+    return bdb::project_fields(data, fields, 1, result);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Parallel scan.
+//--------------------------------------------------------------------------------------------------
+
+// Scan callback function (counts records per worker).
+int count_scanned (int worker, const DBT *, const DBT *, void * param)
+{
+    ((unsigned int *) param)[worker]++;
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Modification in place.
+//--------------------------------------------------------------------------------------------------
+
+// Modification callback function (adds specified number of days).
+bool add_days (google::protobuf::Message * data, void * param)
+{
+    month::data * d = (month::data *) data;
+    d->set_days(d->days() + *(int *) param);
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Retried transactions.
+//--------------------------------------------------------------------------------------------------
+
+// Transaction callback function (fails with a deadlock on first attempt).
+void deadlock_once (bdb::transaction * txn, void * param)
+{
+    bdb::table * t = (bdb::table *) ((void **) param)[0];
+    int * calls    = (int *) ((void **) param)[1];
+
+    month::key  key;
+    month::data data;
+
+    key.set_month("April");
+    data.set_season("Spring");
+    data.set_days(30);
+    data.set_ordnum(4);
+
+    t->insert(&key, &data, txn);
+
+    if ((*calls)++ == 0) throw bdb::exception(BDB_ERROR_DEADLOCK);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Value compression.
+//--------------------------------------------------------------------------------------------------
+
+// Number of compressed values.
+int compressed = 0;
+
+// Compression function (run-length encoding as pairs of count and byte).
+size_t rle_compress (const void * src, size_t size, void * dest, size_t capacity)
+{
+    const unsigned char * in  = (const unsigned char *) src;
+    unsigned char       * out = (unsigned char *) dest;
+
+    size_t packed = 0;
+
+    for (size_t i = 0; i < size; )
+    {
+        size_t run = 1;
+        while (i + run < size && run < 255 && in[i + run] == in[i]) run++;
+
+        if (packed + 2 > capacity) return 0;
+
+        out[packed++] = (unsigned char) run;
+        out[packed++] = in[i];
+
+        i += run;
+    }
+
+    compressed++;
+
+    return packed;
+}
+
+// Decompression function.
+bool rle_decompress (const void * src, size_t size, void * dest, size_t original)
+{
+    const unsigned char * in  = (const unsigned char *) src;
+    unsigned char       * out = (unsigned char *) dest;
+
+    size_t unpacked = 0;
+
+    for (size_t i = 0; i + 1 < size; i += 2)
+    {
+        if (unpacked + in[i] > original) return false;
+
+        memset(out + unpacked, in[i + 1], in[i]);
+        unpacked += in[i];
+    }
+
+    return (unpacked == original);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Value ciphers.
+//--------------------------------------------------------------------------------------------------
+
+// Number of encrypted values.
+int encrypted = 0;
+
+// Encryption function (XOR by a key, followed by a checksum byte as the tag).
+size_t xor_encrypt (const void * src, size_t size, void * dest)
+{
+    const unsigned char * in  = (const unsigned char *) src;
+    unsigned char       * out = (unsigned char *) dest;
+
+    unsigned char sum = 0;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        out[i] = in[i] ^ 0x5A;
+        sum += in[i];
+    }
+
+    out[size] = sum;
+    encrypted++;
+
+    return size + 1;
+}
+
+// Decryption function.
+bool xor_decrypt (const void * src, size_t size, void * dest, size_t * decrypted)
+{
+    const unsigned char * in  = (const unsigned char *) src;
+    unsigned char       * out = (unsigned char *) dest;
+
+    if (size == 0) return false;
+
+    unsigned char sum = 0;
+
+    for (size_t i = 0; i + 1 < size; i++)
+    {
+        out[i] = in[i] ^ 0x5A;
+        sum += out[i];
+    }
+
+    *decrypted = size - 1;
+
+    return (sum == in[size - 1]);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Recordset filters.
+//--------------------------------------------------------------------------------------------------
+
+// Filter function (rejects months of specified season).
+bool other_season (const bdb::record_view * view, void * param)
+{
+    string season;
+    return !view->get(month::data::kSeasonFieldNumber, &season) || season != (const char *) param;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Comparison states.
+//--------------------------------------------------------------------------------------------------
+
+// Number of parsed application keys.
+int parsed_keys = 0;
+
+// Comparison of parsed month keys.
+int compare_months (const month::key & key1, const month::key & key2)
+{
+    return key1.month().compare(key2.month());
+}
+
+// Decoding function, which counts parsed keys.
+void * parse_month (const DBT * dbt)
+{
+    parsed_keys++;
+    return bdb::parse_state <month::key> (dbt);
+}
+
+// Keys comparison function, which parses application key once per operation.
+int month_state_compare (DB *, const DBT * dbt1, const DBT * dbt2)
+{
+    const month::key * key1 = (const month::key *) bdb::compare_state(dbt1, parse_month, bdb::free_state <month::key>);
+
+    month::key key2;
+    bdb::unserialize(dbt2, &key2);
+
+    return compare_months(*key1, key2);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Slow operations.
+//--------------------------------------------------------------------------------------------------
+
+// Handler of slow operations (counts reported commits of transactions).
+void count_slow_commits (const bdb::slow_operation * op, void * param)
+{
+    if (op->operation == BDB_LATENCY_COMMIT) (*(int *) param)++;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Asynchronous operations.
+//--------------------------------------------------------------------------------------------------
+
+// Completion callback (counts successful operations; callbacks of one table are called by one thread at a time).
+void count_completed (int error, bool, void * param)
+{
+    if (error == 0) (*(int *) param)++;
+}
+
+// Deferred completions of asynchronous operations.
+vector <pair <void (*) (void *), void *> > deferred;
+
+// Executor of completions (defers them until the main thread runs them).
+void defer_completion (void (*fn_run) (void *), void * arg, void *)
+{
+    deferred.push_back(make_pair(fn_run, arg));
+}
+
+//--------------------------------------------------------------------------------------------------
+// Change notifications.
+//--------------------------------------------------------------------------------------------------
+
+// Notification callback function (counts notifications and notified records).
+void count_notices (bdb::table *, const vector <bdb::change_notice> & notices, void * param)
+{
+    ((unsigned int *) param)[0]++;
+    ((unsigned int *) param)[1] += notices.size();
+}
+
+//--------------------------------------------------------------------------------------------------
+// Versions of schema.
+//--------------------------------------------------------------------------------------------------
+
+// Upgrade callback function (numbers of months of version "0" are counted from zero).
+int upgrade_ordnum (DB *, unsigned int, const DBT * data, DBT * result)
+{
+    month::data d;
+
+    bdb::unserialize(data, &d);
+    d.set_ordnum(d.ordnum() + 1);
+    bdb::serialize(&d, result);
+
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Fixed-layout records.
+//--------------------------------------------------------------------------------------------------
+
+// Point of time series.
+struct point
+{
+    int64_t time;
+    double  value;
+};
+
 //--------------------------------------------------------------------------------------------------
 
 // Main routine.
@@ -1314,11 +1614,5826 @@ int main ()
     {
         CHECK(false);
     }
+
+    // 33 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Commit and rollback explicit transactions.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            month::key  key;
+            month::data data;
+
+            key.set_month("Undecimber");
+            data.set_season("Winter");
+            data.set_days(1);
+            data.set_ordnum(13);
+
+            bool res = true;
+
+            {
+                bdb::transaction txn(db);
+                tmonth->insert(&key, &data, &txn);
+                res = res && tmonth->exists(&key, &txn);
+                txn.rollback();
+            }
+
+            res = res && !tmonth->exists(&key);
+
+            {
+                bdb::transaction txn(db);
+                tmonth->insert(&key, &data, &txn);
+                txn.commit();
+            }
+
+            res = res && tmonth->exists(&key);
+
+            {
+                bdb::transaction txn(db);
+                tmonth->remove(&key, &txn);
+                // the transaction is not completed, and must be rolled back on destruction
+            }
+
+            res = res && tmonth->exists(&key);
+
+            tmonth->remove(&key);
+            res = res && !tmonth->exists(&key);
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 34 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Commit transactions with different durability policies.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            month::key  key;
+            month::data data;
+
+            key.set_month("Undecimber");
+            data.set_season("Winter");
+            data.set_days(1);
+            data.set_ordnum(13);
+
+            bool res = true;
+
+            {
+                bdb::transaction txn(db, NULL, BDB_DURABILITY_WRITE_NOSYNC);
+                tmonth->insert(&key, &data, &txn);
+                txn.commit();
+            }
+
+            res = res && tmonth->exists(&key);
+
+            {
+                bdb::transaction txn(db, NULL, BDB_DURABILITY_NOSYNC);
+                tmonth->remove(&key, &txn);
+                txn.commit();
+            }
+
+            res = res && !tmonth->exists(&key);
+
+            db->set_durability(BDB_DURABILITY_GROUP, 1000, 2);
+
+            {
+                bdb::transaction txn(db);
+                tmonth->insert(&key, &data, &txn);
+                txn.commit();
+            }
+
+            res = res && tmonth->exists(&key);
+
+            db->set_durability(BDB_DURABILITY_DEFAULT);
+
+            tmonth->remove(&key);
+            res = res && !tmonth->exists(&key);
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 35 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Insert records in bulk.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            const char * names[] = { "Bulk I", "Bulk II", "Bulk III" };
+
+            month::key  keys [3];
+            month::data datas[3];
+
+            bdb::bulklist records;
+
+            for (int i = 0; i < 3; i++)
+            {
+                keys[i].set_month(names[i]);
+                datas[i].set_season("Winter");
+                datas[i].set_days(1);
+                datas[i].set_ordnum(101 + i);
+
+                records.push_back(std::make_pair(&keys[i], &datas[i]));
+            }
+
+            tmonth->insert_bulk(records, NULL, 2);
+
+            bool res = true;
+
+            for (int i = 0; i < 3; i++)
+            {
+                month::data data;
+                tmonth->select(&keys[i], &data);
+                res = res && (data.ordnum() == 101 + i);
+            }
+
+            for (int i = 0; i < 3; i++)
+            {
+                tmonth->remove(&keys[i]);
+            }
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 36 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Check recordset gained from table in bulk mode.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            month::key  key;
+            month::data data;
+
+            vector <string> expected;
+
+            rs = new bdb::recordset(tmonth);
+
+            while (rs->fetch(&key, &data))
+            {
+                expected.push_back(key.month());
+            }
+
+            delete rs;
+
+            rs = new bdb::recordset(tmonth);
+            rs->set_bulk(1);
+
+            bool         res = true;
+            unsigned int i   = 0;
+
+            while (rs->fetch(&key, &data))
+            {
+                res = res && i < expected.size() && key.month() == expected[i];
+                i++;
+            }
+
+            res = res && (i == expected.size());
+
+            rs->rewind();
+            res = res && rs->fetch(&key, &data) && key.month() == expected[0];
+
+            delete rs;
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 37 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Generate ranges of identifiers with regular and cached sequences.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            int64_t first = seq->ids(3);
+            int64_t next  = seq->id();
+
+            bdb::sequence * cached = db->add_sequence("cached", true, 100);
+
+            int64_t cfirst = cached->ids(10);
+            int64_t cnext  = cached->id();
+
+            CHECK(next == first + 3 && cfirst == 1 && cnext == 11);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 38 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Check table sorted by field of serialized keys.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tfield = db->add_table("field", bdb::field_compare <month::key::kMonthFieldNumber, BDB_FIELD_STRING>, true);
+
+            const char * names [4] = { "March", "January", "Mar", "February" };
+            const char * sorted[4] = { "February", "January", "Mar", "March" };
+
+            month::key  key;
+            month::data data;
+
+            data.set_season("Winter");
+            data.set_days(1);
+
+            for (int i = 0; i < 4; i++)
+            {
+                key.set_month(names[i]);
+                data.set_ordnum(i);
+                tfield->insert(&key, &data);
+            }
+
+            rs = new bdb::recordset(tfield);
+
+            bool res = true;
+            int  i   = 0;
+
+            while (rs->fetch(&key, &data))
+            {
+                res = res && i < 4 && key.month() == sorted[i];
+                i++;
+            }
+
+            delete rs;
+
+            CHECK(res && i == 4);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 39 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Check table with order-preserving keys.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.key_format = BDB_KEY_ORDERED;
+
+            bdb::table * tordered = db->add_table("ordered", NULL, true, options);
+
+            const char * names [4] = { "March", "January", "Mar", "February" };
+            const char * sorted[4] = { "February", "January", "Mar", "March" };
+
+            month::key  key;
+            month::data data;
+
+            data.set_season("Winter");
+            data.set_days(1);
+
+            for (int i = 0; i < 4; i++)
+            {
+                key.set_month(names[i]);
+                data.set_ordnum(i);
+                tordered->insert(&key, &data);
+            }
+
+            key.set_month("Mar");
+            tordered->select(&key, &data);
+
+            bool res = (data.ordnum() == 2);
+            int  i   = 0;
+
+            rs = new bdb::recordset(tordered);
+
+            while (rs->fetch(&key, &data))
+            {
+                res = res && i < 4 && key.month() == sorted[i];
+                i++;
+            }
+
+            delete rs;
+
+            CHECK(res && i == 4);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 40 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Check table and index with generated callback functions.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tgen = db->add_table("generated", month::key_month_compare, true);
+            bdb::index * igen = tgen->add_index("generated_season", month::data_season_index, month::season_ix_season_compare);
+
+            const char * names  [3] = { "December", "March", "January" };
+            const char * seasons[3] = { "Winter", "Spring", "Winter" };
+
+            month::key  key;
+            month::data data;
+
+            for (int i = 0; i < 3; i++)
+            {
+                key.set_month(names[i]);
+                data.set_season(seasons[i]);
+                data.set_days(31);
+                data.set_ordnum(i);
+                tgen->insert(&key, &data);
+            }
+
+            month::season_ix skey;
+            skey.set_season("Winter");
+
+            rs = new bdb::recordset(igen, &skey);
+
+            bool res = true;
+            int  i   = 0;
+
+            while (rs->fetch(&key, &data))
+            {
+                res = res && data.season() == "Winter";
+                i++;
+            }
+
+            delete rs;
+
+            CHECK(res && i == 2);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 41 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Check custom memory allocator and allocation statistics.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::allocator alloc = { counting_malloc, counting_realloc, counting_free };
+            bdb::set_allocator(&alloc);
+            bdb::set_memory_stats(true);
+
+            month::season_ix skey;
+            skey.set_season("Winter");
+
+            rs = new bdb::recordset(iseason, &skey);
+            delete rs;
+
+            bdb::memory_stats stats;
+            bdb::get_memory_stats(&stats);
+
+            bdb::set_memory_stats(false);
+            bdb::set_allocator(NULL);
+
+            CHECK(allocated != 0 && allocated == freed && stats.mallocs == (uint64_t) allocated && stats.frees == (uint64_t) freed);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 42 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Select several records by their keys at once.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tmany = db->add_table("many", month::key_month_compare, true);
+
+            const char * names[3] = { "June", "April", "May" };
+
+            month::key  key;
+            month::data data;
+
+            for (int i = 0; i < 3; i++)
+            {
+                key.set_month(names[i]);
+                data.set_season("Spring");
+                data.set_days(30);
+                data.set_ordnum(i);
+                tmany->insert(&key, &data);
+            }
+
+            month::key  k[4];
+            month::data d[4];
+
+            k[0].set_month("May");
+            k[1].set_month("July");
+            k[2].set_month("April");
+            k[3].set_month("June");
+
+            bdb::keylist  keys;
+            bdb::datalist datas;
+            vector <bool> found;
+
+            for (int i = 0; i < 4; i++)
+            {
+                keys.push_back(&k[i]);
+                datas.push_back(&d[i]);
+            }
+
+            tmany->select_many(keys, datas, &found);
+
+            CHECK(found.size() == 4 &&
+                  found[0] && d[0].ordnum() == 2 &&
+                  !found[1] &&
+                  found[2] && d[2].ordnum() == 1 &&
+                  found[3] && d[3].ordnum() == 0);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 43 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Check recordsets gained from table with key range.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tmany = db->add_table("many", month::key_month_compare);
+
+            month::key  lower, upper;
+            month::key  key;
+            month::data data;
+
+            lower.set_month("B");
+            upper.set_month("June");
+
+            // April < June < May
+
+            bool res = true;
+            int  i   = 0;
+
+            rs = new bdb::recordset(tmany, &lower, &upper, BDB_RANGE_INCLUSIVE);
+
+            while (rs->fetch(&key, &data))
+            {
+                res = res && key.month() == "June";
+                i++;
+            }
+
+            delete rs;
+
+            res = res && i == 1;
+
+            rs = new bdb::recordset(tmany, NULL, &upper, BDB_RANGE_EXCLUSIVE);
+
+            res = res && rs->fetch(&key, &data) && key.month() == "April";
+            res = res && !rs->fetch(&key, &data);
+
+            delete rs;
+
+            rs = new bdb::recordset(tmany, &upper, NULL, BDB_RANGE_REVERSE);
+
+            res = res && rs->fetch(&key, &data) && key.month() == "May";
+            res = res && rs->fetch(&key, &data) && key.month() == "June";
+            res = res && !rs->fetch(&key, &data);
+
+            rs->rewind();
+
+            res = res && rs->fetch(&key, &data) && key.month() == "May";
+
+            delete rs;
+            rs = NULL;
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 44 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Check recordset gained from table with key prefix.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.key_format = BDB_KEY_ORDERED;
+
+            // composite keys (season, days, ordnum)
+            bdb::table * tprefix = db->add_table("prefix", NULL, true, options);
+
+            const char * seasons[5] = { "Winter", "Spring", "Winter", "Summer", "Winter" };
+            const int    days   [5] = { 31, 31, 28, 30, 31 };
+
+            month::data key;
+            month::key  data;
+
+            for (int i = 0; i < 5; i++)
+            {
+                key.set_season(seasons[i]);
+                key.set_days(days[i]);
+                key.set_ordnum(i);
+                data.set_month("");
+                tprefix->insert(&key, &data);
+            }
+
+            month::data prefix;
+            prefix.set_season("Winter");
+
+            bool res = true;
+            int  i   = 0;
+
+            rs = new bdb::recordset(tprefix, &prefix, &prefix, BDB_RANGE_PREFIX);
+
+            const int expected[3] = { 2, 0, 4 };
+
+            while (rs->fetch(&key, &data))
+            {
+                res = res && i < 3 && key.season() == "Winter" && key.ordnum() == expected[i];
+                i++;
+            }
+
+            delete rs;
+
+            res = res && i == 3;
+
+            prefix.set_days(31);
+
+            rs = new bdb::recordset(tprefix, &prefix, &prefix, BDB_RANGE_PREFIX | BDB_RANGE_REVERSE);
+
+            res = res && rs->fetch(&key, &data) && key.ordnum() == 4;
+            res = res && rs->fetch(&key, &data) && key.ordnum() == 0;
+            res = res && !rs->fetch(&key, &data);
+
+            delete rs;
+            rs = NULL;
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 45 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Fetch keys only from recordsets.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tmany = db->add_table("many", month::key_month_compare);
+
+            const char * sorted[3] = { "April", "June", "May" };
+
+            month::key  key;
+            month::data data;
+
+            bool res = true;
+            int  i   = 0;
+
+            rs = new bdb::recordset(tmany);
+
+            while (rs->fetch_key(&key))
+            {
+                res = res && i < 3 && key.month() == sorted[i];
+                i++;
+            }
+
+            delete rs;
+
+            res = res && i == 3;
+
+            // keys fetched from index are the same as ones fetched with data
+            rs = new bdb::recordset(iseason);
+
+            vector <string> keys;
+
+            while (rs->fetch(&key, &data))
+            {
+                keys.push_back(key.month());
+            }
+
+            rs->rewind();
+
+            for (i = 0; rs->fetch_key(&key); i++)
+            {
+                res = res && i < (int) keys.size() && key.month() == keys[i];
+            }
+
+            delete rs;
+            rs = NULL;
+
+            CHECK(res && i == (int) keys.size() && i != 0);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 46 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Count records of tables, indexes, and recordsets.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tmany = db->add_table("many", month::key_month_compare);
+
+            bool res = (tmany->count() == 3 && tmany->count(true) == 3);
+
+            month::season_ix skey;
+            month::days_ix   dkey;
+
+            month::key  key;
+            month::data data;
+
+            skey.set_season("Autumn");
+            dkey.set_days(30);
+
+            // count by fetching all records
+            unsigned int expected = 0;
+
+            rs = new bdb::recordset(iseason, &skey);
+            while (rs->fetch(&key, &data)) expected++;
+
+            res = res && expected != 0;
+            res = res && iseason->count(&skey) == expected;
+            res = res && rs->count() == expected;
+            res = res && rs->fetch(&key, &data) && data.season() == "Autumn";
+
+            delete rs;
+
+            skey.set_season("Keyser Soze");
+            res = res && iseason->count(&skey) == 0;
+
+            skey.set_season("Autumn");
+
+            bdb::joinlist r;
+            r.push_back(new bdb::recordset(iseason, &skey));
+            r.push_back(new bdb::recordset(idays,   &dkey));
+
+            rs = new bdb::recordset(tmonth, r);
+
+            expected = 0;
+            while (rs->fetch(&key, &data)) expected++;
+
+            delete rs;
+
+            rs = new bdb::recordset(tmonth, r);
+            res = res && rs->count() == expected;
+            delete rs;
+            rs = NULL;
+
+            for (unsigned i = 0; i < r.size(); i++)
+            {
+                delete r[i];
+            }
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 47 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Fetch records backward, and seek in recordset.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tmany = db->add_table("many", month::key_month_compare);
+
+            month::key  key;
+            month::key  seek;
+            month::data data;
+
+            // April < June < May
+
+            rs = new bdb::recordset(tmany);
+
+            bool res = true;
+
+            res = res && rs->fetch_prev(&key, &data) && key.month() == "May";
+            res = res && rs->fetch_prev(&key, &data) && key.month() == "June";
+            res = res && rs->fetch_prev(&key, &data) && key.month() == "April";
+            res = res && !rs->fetch_prev(&key, &data);
+
+            seek.set_month("June");
+            res = res && rs->seek(&seek);
+            res = res && rs->fetch(&key, &data) && key.month() == "June" && data.ordnum() == 0;
+            res = res && rs->fetch(&key, &data) && key.month() == "May";
+
+            seek.set_month("K");
+            res = res && rs->seek(&seek);
+            res = res && rs->fetch_prev(&key, &data) && key.month() == "June";
+
+            seek.set_month("Z");
+            res = res && !rs->seek(&seek);
+            res = res && !rs->fetch(&key, &data);
+            res = res && rs->fetch_prev(&key, &data) && key.month() == "May";
+
+            rs->seek_last();
+            res = res && rs->fetch_prev(&key, &data) && key.month() == "May";
+
+            delete rs;
+            rs = NULL;
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 48 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Join several recordsets in order of the list.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            month::season_ix skey;
+            month::days_ix   dkey;
+
+            skey.set_season("Autumn");
+            dkey.set_days(30);
+
+            bdb::joinlist r;
+            r.push_back(new bdb::recordset(idays,   &dkey));
+            r.push_back(new bdb::recordset(iseason, &skey));
+
+            rs = new bdb::recordset(tmonth, r);
+            unsigned int sorted = rs->count();
+            delete rs;
+
+            rs = new bdb::recordset(tmonth, r, BDB_JOIN_NOSORT);
+            unsigned int unsorted = rs->count();
+            delete rs;
+            rs = NULL;
+
+            for (unsigned i = 0; i < r.size(); i++)
+            {
+                delete r[i];
+            }
+
+            CHECK(sorted != 0 && sorted == unsorted);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 49 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Intersect and unite recordsets by primary keys.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            month::season_ix skey, wkey;
+            month::days_ix   lower, upper;
+
+            month::key  key;
+            month::data data;
+
+            skey.set_season("Autumn");
+            wkey.set_season("Winter");
+            lower.set_days(28);
+            upper.set_days(30);
+
+            // expected numbers of records
+            unsigned int both   = 0;
+            unsigned int either = 0;
+
+            rs = new bdb::recordset(tmonth);
+
+            while (rs->fetch(&key, &data))
+            {
+                if (data.season() == "Autumn" && data.days() >= 28 && data.days() <= 30) both++;
+                if (data.season() == "Autumn" || data.season() == "Winter") either++;
+            }
+
+            delete rs;
+
+            bdb::joinlist r;
+            r.push_back(new bdb::recordset(iseason, &skey));
+            r.push_back(new bdb::recordset(idays, &lower, &upper, BDB_RANGE_INCLUSIVE));
+
+            rs = new bdb::recordset(tmonth, r, BDB_JOIN_INTERSECT);
+
+            bool res = true;
+            unsigned int i = 0;
+
+            while (rs->fetch(&key, &data))
+            {
+                res = res && data.season() == "Autumn" && data.days() >= 28 && data.days() <= 30;
+                i++;
+            }
+
+            delete rs;
+
+            res = res && i == both && both != 0;
+
+            for (unsigned j = 0; j < r.size(); j++)
+            {
+                delete r[j];
+            }
+
+            r.clear();
+            r.push_back(new bdb::recordset(iseason, &skey));
+            r.push_back(new bdb::recordset(iseason, &wkey));
+
+            rs = new bdb::recordset(tmonth, r, BDB_JOIN_UNION);
+            res = res && rs->count() == either && either != 0;
+            delete rs;
+            rs = NULL;
+
+            for (unsigned j = 0; j < r.size(); j++)
+            {
+                delete r[j];
+            }
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 50 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Fetch projections from covering index.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tcovered = db->add_table("covered", month::key_month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("January");
+            data.set_season("Winter");
+            data.set_days(31);
+            data.set_ordnum(1);
+            tcovered->insert(&key, &data);
+
+            // existing records are projected on creation of the index
+            bdb::index * icovered = tcovered->add_index("covered_season", month::data_season_index, month::season_ix_season_compare, days_projection);
+
+            key.set_month("February");
+            data.set_days(28);
+            data.set_ordnum(2);
+            tcovered->insert(&key, &data);
+
+            key.set_month("December");
+            data.set_days(30);
+            data.set_ordnum(12);
+            tcovered->insert(&key, &data);
+
+            data.set_days(31);
+            tcovered->update(&key, &data);
+
+            key.set_month("January");
+            tcovered->remove(&key);
+
+            month::season_ix skey;
+            skey.set_season("Winter");
+
+            rs = new bdb::recordset(icovered, &skey);
+
+            bool res = true;
+            int  days = 0;
+            int  i    = 0;
+
+            while (rs->fetch_projection(&key, &data))
+            {
+                res = res && !data.has_season() && !data.has_ordnum();
+                days += data.days();
+                i++;
+            }
+
+            delete rs;
+            rs = NULL;
+
+            CHECK(res && i == 2 && days == 28 + 31);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 51 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Scan table by several threads.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.key_format = BDB_KEY_ORDERED;
+
+            unsigned int scanned[4] = { 0, 0, 0, 0 };
+
+            tmonth->parallel_scan(4, count_scanned, scanned);
+
+            bool res = (scanned[0] + scanned[1] + scanned[2] + scanned[3] == tmonth->count());
+
+            bdb::table * tordered = db->add_table("ordered", NULL, false, options);
+
+            memset(scanned, 0, sizeof(scanned));
+            tordered->parallel_scan(3, count_scanned, scanned);
+
+            res = res && (scanned[0] + scanned[1] + scanned[2] == tordered->count()) && scanned[3] == 0;
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 52 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Estimate number of records in key range.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            month::days_ix lower, upper;
+
+            lower.set_days(29);
+            upper.set_days(30);
+
+            bdb::key_estimate all, some;
+
+            idays->estimate_range(NULL, NULL, &all);
+            idays->estimate_range(&lower, &upper, &some);
+
+            CHECK(all.less == 0.0 && all.greater == 0.0 && all.equal == 1.0 &&
+                  some.equal > 0.0 && some.equal < 1.0 &&
+                  some.less + some.equal + some.greater > 0.99);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 53 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Insert or update records.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("March");
+            data.set_season("Spring");
+            data.set_days(30);
+            data.set_ordnum(3);
+
+            bool created = tupserted->upsert(&key, &data);
+
+            data.set_days(31);
+
+            bool updated = !tupserted->upsert(&key, &data);
+
+            tupserted->select(&key, &data);
+
+            CHECK(created && updated && data.days() == 31);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 54 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Modify record in place.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("March");
+
+            int days = 1;
+
+            bool changed = tupserted->modify(&key, &data, add_days, &days);
+
+            tupserted->select(&key, &data);
+
+            CHECK(changed && data.days() == 32);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 55 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Retry deadlocked transaction.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+
+            int    calls    = 0;
+            void * param[2] = { tupserted, &calls };
+
+            db->run_in_transaction(deadlock_once, param);
+
+            month::key key;
+            key.set_month("April");
+
+            CHECK(calls == 2 && tupserted->exists(&key));
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 56 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Use multiversion table in transaction with timeouts.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.multiversion = true;
+
+            bdb::table * tversions = db->add_table("versions", month::key_month_compare, true, options);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("May");
+            data.set_season("Spring");
+            data.set_days(31);
+            data.set_ordnum(5);
+
+            bdb::transaction txn(db, NULL, BDB_DURABILITY_DEFAULT, BDB_TXN_NOWAIT);
+            txn.set_timeout(100000, 1000000);
+
+            tversions->insert(&key, &data, &txn);
+            txn.commit();
+
+            CHECK(tversions->exists(&key));
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 57 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Scan snapshot of multiversion table.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.multiversion = true;
+
+            bdb::table * tversions = db->add_table("versions", month::key_month_compare, false, options);
+
+            bdb::snapshot snap(db);
+
+            rs = new bdb::recordset(tversions, &snap);
+
+            month::key  key;
+            month::data data;
+
+            int i = 0;
+
+            while (rs->fetch(&key, &data)) i++;
+
+            delete rs;
+            rs = NULL;
+
+            snap.commit();
+
+            // the record is inserted in top-level transaction of the database, which is not committed yet
+            CHECK(i == 0);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 58 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Commit changes outside of transactions one by one.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            // reopen database in auto-commit mode
+            delete db;
+
+            bdb::database_options dboptions;
+            dboptions.auto_commit = true;
+
+            db = new bdb::database(DATABASE_NAME, false, dboptions);
+
+            seq = db->add_sequence("month");
+
+            tseason = db->add_table("season", season_compare);
+            tmonth  = db->add_table("month",  month_compare );
+
+            iseason = tmonth->add_index("season", season_ix_index, season_ix_compare);
+            idays   = tmonth->add_index("days",   days_ix_index,   days_ix_compare);
+            iordnum = tmonth->add_index("ordnum", ordnum_ix_index, ordnum_ix_compare, true);
+
+            bdb::table_options options;
+            options.multiversion = true;
+
+            bdb::table * tversions = db->add_table("versions", month::key_month_compare, false, options);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("June");
+            data.set_season("Summer");
+            data.set_days(30);
+            data.set_ordnum(6);
+
+            tversions->insert(&key, &data);
+
+            // both records are committed now
+            bdb::snapshot snap(db);
+
+            rs = new bdb::recordset(tversions, &snap);
+
+            int i = 0;
+
+            while (rs->fetch(&key, &data)) i++;
+
+            delete rs;
+            rs = NULL;
+
+            CHECK(i == 2);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 59 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Apply batch of changes.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+
+            bdb::write_batch batch(db);
+
+            month::key  key;
+            month::data data;
+
+            data.set_season("Summer");
+            data.set_days(31);
+
+            key.set_month("July");
+            data.set_ordnum(7);
+            batch.insert(tupserted, &key, &data);
+
+            key.set_month("August");
+            data.set_ordnum(8);
+            batch.insert(tupserted, &key, &data);
+
+            key.set_month("March");
+            data.set_season("Spring");
+            data.set_ordnum(3);
+            batch.update(tupserted, &key, &data);
+
+            key.set_month("April");
+            batch.remove(tupserted, &key);
+
+            size_t size = batch.size();
+
+            batch.commit();
+
+            key.set_month("March");
+            tupserted->select(&key, &data);
+
+            month::key april, august;
+            april.set_month("April");
+            august.set_month("August");
+
+            CHECK(size == 4 && batch.size() == 0 && data.days() == 31 &&
+                  tupserted->exists(&august) && !tupserted->exists(&april));
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 60 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Delete many records, and records in key range.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tremoved = db->add_table("removed", month::key_month_compare, true);
+
+            const char * months[] = { "January", "February", "March", "April", "May", "June" };
+
+            month::key  key;
+            month::data data;
+
+            data.set_season("Any");
+            data.set_days(30);
+
+            for (int i = 0; i < 6; i++)
+            {
+                key.set_month(months[i]);
+                data.set_ordnum(i + 1);
+                tremoved->insert(&key, &data);
+            }
+
+            month::key k1, k2;
+
+            k1.set_month("February");
+            k2.set_month("May");
+
+            bdb::keylist keys;
+            keys.push_back(&k2);
+            keys.push_back(&k1);
+
+            tremoved->remove_many(keys, NULL, 1);
+
+            // months are ordered by name, so the range contains January and June
+            month::key lower, upper;
+
+            lower.set_month("January");
+            upper.set_month("June");
+
+            unsigned int removed = tremoved->remove_range(&lower, &upper, NULL, 1);
+
+            unsigned int left = tremoved->count();
+
+            CHECK(removed == 2 && left == 2);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 61 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Build new index of populated table.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+            bdb::index * iupserted = tupserted->add_index("upserted_days", month::data_days_index, month::days_ix_days_compare);
+
+            month::days_ix key;
+            key.set_days(31);
+
+            CHECK(iupserted->count(&key) == 3);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 62 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Maintain several field indexes on write.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+            bdb::index * iseasons  = tupserted->add_index("upserted_seasons",  month::data::kSeasonFieldNumber, month::season_ix::kSeasonFieldNumber, month::season_ix_season_compare);
+            bdb::index * iordnums  = tupserted->add_index("upserted_ordnums",  month::data::kOrdnumFieldNumber, month::ordnum_ix::kOrdnumFieldNumber, month::ordnum_ix_ordnum_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("September");
+            data.set_season("Autumn");
+            data.set_days(30);
+            data.set_ordnum(9);
+
+            tupserted->insert(&key, &data);
+
+            month::season_ix season;
+            month::ordnum_ix ordnum;
+
+            season.set_season("Summer");
+            ordnum.set_ordnum(9);
+
+            unsigned int summer = iseasons->count(&season);
+
+            season.set_season("Autumn");
+
+            CHECK(summer == 2 && iseasons->count(&season) == 1 && iordnums->exists(&ordnum));
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 63 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Update records with immutable index.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+            bdb::index * iordnums  = tupserted->add_index("upserted_ordinals", month::data::kOrdnumFieldNumber, month::ordnum_ix::kOrdnumFieldNumber, month::ordnum_ix_ordnum_compare, true, true);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("September");
+            tupserted->select(&key, &data);
+
+            data.set_season("Fall");
+            tupserted->update(&key, &data);
+
+            month::ordnum_ix ordnum;
+            ordnum.set_ordnum(9);
+
+            tupserted->select(&key, &data);
+
+            CHECK(iordnums->exists(&ordnum) && data.season() == "Fall");
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 64 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Use hash and recno tables.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+
+            options.access_method = BDB_ACCESS_HASH;
+            bdb::table * thashed = db->add_table("hashed", NULL, true, options);
+
+            options.access_method = BDB_ACCESS_RECNO;
+            bdb::table * tnumbered = db->add_table("numbered", NULL, true, options);
+
+            month::key       key;
+            month::ordnum_ix num;
+            month::data      data;
+
+            key.set_month("May");
+            data.set_season("Spring");
+            data.set_days(31);
+            data.set_ordnum(5);
+            thashed->insert(&key, &data);
+
+            num.set_ordnum(5);
+            tnumbered->insert(&num, &data);
+
+            key.set_month("June");
+            data.set_season("Summer");
+            data.set_days(30);
+            data.set_ordnum(6);
+            thashed->insert(&key, &data);
+
+            num.set_ordnum(6);
+            tnumbered->insert(&num, &data);
+
+            tnumbered->remove(&num);
+
+            key.set_month("May");
+            thashed->select(&key, &data);
+
+            bool hashed = (data.days() == 31 && thashed->count() == 2);
+
+            rs = new bdb::recordset(tnumbered);
+
+            unsigned int fetched = 0;
+
+            while (rs->fetch(&num, &data))
+            {
+                if (num.ordnum() == 5 && data.ordnum() == 5) fetched++;
+            }
+
+            delete rs;
+
+            num.set_ordnum(6);
+
+            CHECK(hashed && fetched == 1 && !tnumbered->exists(&num));
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 65 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Use compressed table.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.key_format  = BDB_KEY_ORDERED;
+            options.compression = true;
+
+            bdb::table * tcompressed = db->add_table("compressed", NULL, true, options);
+
+            month::key  key;
+            month::data data;
+
+            const char * months[6] = { "January", "February", "March", "April", "May", "June" };
+
+            data.set_season("Spring");
+            data.set_days(30);
+
+            for (int i = 0; i < 6; i++)
+            {
+                key.set_month(months[i]);
+                data.set_ordnum(i + 1);
+
+                tcompressed->insert(&key, &data);
+            }
+
+            key.set_month("April");
+            tcompressed->select(&key, &data);
+
+            CHECK(tcompressed->count() == 6 && data.ordnum() == 4);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 66 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Compress large values.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::value_codec codec = { 64, rle_compress, rle_decompress };
+            bdb::set_codec(&codec);
+
+            bdb::table * tpacked = db->add_table("packed", month::key_month_compare, true);
+            bdb::index * ipacked = tpacked->add_index("packed_days", month::data_days_index, month::days_ix_days_compare);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("January");
+            data.set_season(string(1000, 'w'));
+            data.set_days(31);
+            data.set_ordnum(1);
+
+            tpacked->insert(&key, &data);
+
+            data.Clear();
+            tpacked->select(&key, &data);
+
+            month::days_ix days;
+            days.set_days(31);
+
+            CHECK(compressed != 0 && data.season() == string(1000, 'w') && data.ordnum() == 1 && ipacked->exists(&days));
+
+            bdb::set_codec(NULL);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        bdb::set_codec(NULL);
+        CHECK(false);
+    }
+
+    // 67 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Select record by chunks.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("September");
+            tupserted->select_stream(&key, &data, NULL, 3);
+
+            bool found = (data.season() == "Fall" && data.days() == 30 && data.ordnum() == 9);
+
+            key.set_month("December");
+
+            try
+            {
+                tupserted->select_stream(&key, &data);
+                CHECK(false);
+            }
+            catch (bdb::exception & e)
+            {
+                CHECK(found && e.error() == BDB_ERROR_NOT_FOUND);
+            }
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 68 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Filter records by views of their data.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+
+            month::key       key;
+            month::data      data;
+            bdb::record_view view;
+
+            int     parsed = 0;
+            int64_t days   = 0;
+            string  season;
+
+            rs = new bdb::recordset(tupserted);
+
+            while (rs->fetch_view(&key, &view))
+            {
+                if (view.get(month::data::kDaysFieldNumber, &days) && days == 30)
+                {
+                    view.parse(&data);
+                    parsed++;
+                }
+            }
+
+            delete rs;
+
+            bool found = (parsed == 1 && key.month() != "" && data.season() == "Fall" && data.ordnum() == 9);
+
+            rs = new bdb::recordset(tupserted);
+            rs->set_bulk(4096);
+
+            bool fetched = rs->fetch_view(NULL, &view);
+
+            found = found && fetched && view.get(month::data::kSeasonFieldNumber, &season) && !view.get(month::data::kDaysFieldNumber, &season);
+
+            delete rs;
+
+            CHECK(found && season != "");
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 69 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Filter records inside of fetches.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+
+            month::key  key;
+            month::data data;
+            month::data value;
+
+            value.set_days(31);
+
+            rs = new bdb::recordset(tupserted);
+            rs->add_filter(month::data::kDaysFieldNumber, BDB_FIELD_INT32, BDB_FILTER_GE, &value);
+
+            unsigned int longest = rs->count();
+
+            rs->set_filter(other_season, (void *) "Summer");
+
+            bool found = (rs->fetch(&key, &data) && key.month() == "March" && data.days() == 31 && !rs->fetch_key(&key));
+
+            rs->clear_filter();
+
+            unsigned int all = rs->count();
+
+            delete rs;
+
+            CHECK(found && longest == 3 && all == 4);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 70 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Aggregate records by groups.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+
+            bdb::aggregation seasons(month::data::kDaysFieldNumber, BDB_FIELD_INT32, month::data::kSeasonFieldNumber);
+            bdb::aggregation longest(month::data::kDaysFieldNumber, BDB_FIELD_INT32);
+
+            month::data value;
+            value.set_days(31);
+
+            rs = new bdb::recordset(tupserted);
+            seasons.run(rs);
+            delete rs;
+
+            rs = new bdb::recordset(tupserted);
+            rs->add_filter(month::data::kDaysFieldNumber, BDB_FIELD_INT32, BDB_FILTER_LT, &value);
+            longest.run(rs);
+            delete rs;
+
+            const bdb::aggregate_groups & groups = seasons.groups();
+
+            bool found = (groups.size() == 3 &&
+                          groups.find("Summer")->second.count == 2 &&
+                          groups.find("Summer")->second.sum   == 62 &&
+                          groups.find("Fall")->second.max     == 30);
+
+            longest.merge(seasons);
+
+            bdb::aggregate_value total = longest.total();
+
+            CHECK(found && total.count == 5 && total.sum == 153 && total.min == 30 && total.max == 31);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 71 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Select records through the cache.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.cache_records = 16;
+
+            bdb::table * tcached = db->add_table("cached", month::key_month_compare, true, options);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("May");
+            data.set_season("Spring");
+            data.set_days(31);
+            data.set_ordnum(5);
+
+            tcached->insert(&key, &data);
+
+            tcached->select(&key, &data);
+            tcached->select(&key, &data);
+
+            bool found = (data.days() == 31);
+
+            // rolled back changes invalidate the record, but never get into the cache
+            db->begin_transaction();
+            data.set_days(30);
+            tcached->update(&key, &data);
+            tcached->select(&key, &data);
+            db->rollback_transaction();
+
+            tcached->select(&key, &data);
+
+            found = found && (data.days() == 31);
+
+            tcached->remove(&key);
+
+            try
+            {
+                tcached->select(&key, &data);
+                CHECK(false);
+            }
+            catch (bdb::exception & e)
+            {
+                CHECK(found && e.error() == BDB_ERROR_NOT_FOUND);
+            }
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 72 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Check keys by Bloom filter.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.bloom_bits = 10;
+
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare, false, options);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("July");
+            bool found = tupserted->exists(&key);
+
+            key.set_month("November");
+            found = found && !tupserted->exists(&key);
+
+            data.set_season("Fall");
+            data.set_days(30);
+            data.set_ordnum(11);
+
+            tupserted->insert(&key, &data);
+            found = found && tupserted->exists(&key);
+
+            tupserted->remove(&key);
+
+            CHECK(found && !tupserted->exists(&key));
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 73 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Compare keys by cached states.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tstateful = db->add_table("stateful", month_state_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            const char * months[8] = { "January", "February", "March", "April", "May", "June", "July", "August" };
+
+            data.set_season("Summer");
+            data.set_days(31);
+
+            for (int i = 0; i < 8; i++)
+            {
+                key.set_month(months[i]);
+                data.set_ordnum(i + 1);
+
+                tstateful->insert(&key, &data);
+            }
+
+            key.set_month("May");
+            tstateful->select(&key, &data);
+
+            parsed_keys = 0;
+
+            tstateful->select(&key, &data);
+            tstateful->select(&key, &data);
+
+            bool found = (parsed_keys == 0 && data.ordnum() == 5);
+
+            tstateful = db->add_table("stateful", bdb::message_compare <month::key, compare_months>);
+
+            key.set_month("July");
+            tstateful->select(&key, &data);
+
+            CHECK(found && data.ordnum() == 7);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 74 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Look up records by prepared keys.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+            bdb::index * iupserted = tupserted->add_index("upserted_days", month::data_days_index, month::days_ix_days_compare);
+
+            month::key     key;
+            month::data    data;
+            month::days_ix days;
+
+            key.set_month("September");
+            days.set_days(31);
+
+            bdb::prepared_key september(tupserted, &key);
+            bdb::prepared_key summer(iupserted, &days);
+
+            tupserted->select(&september, &data);
+
+            bool found = (data.ordnum() == 9 && tupserted->exists(&september) && iupserted->count(&summer) == 3);
+
+            bdb::recordset * rs = new bdb::recordset(iupserted, &summer);
+
+            unsigned int count = 0;
+
+            while (rs->fetch(NULL, &data))
+            {
+                count++;
+            }
+
+            delete rs;
+
+            bool thrown = false;
+
+            try
+            {
+                iupserted->exists(&september);
+            }
+            catch (bdb::exception & e)
+            {
+                thrown = (e.error() == BDB_ERROR_UNKNOWN);
+            }
+
+            CHECK(found && count == 3 && thrown);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 75 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Route records of sharded table.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            vector <bdb::database *> shards(1, db);
+
+            bdb::sharded_table tsharded(shards, "sharded", month::key_month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            const char * months[3] = { "October", "December", "November" };
+
+            data.set_season("Fall");
+            data.set_days(30);
+
+            for (int i = 0; i < 3; i++)
+            {
+                key.set_month(months[i]);
+                data.set_ordnum(i + 10);
+
+                tsharded.insert(&key, &data);
+            }
+
+            key.set_month("November");
+            tsharded.select(&key, &data);
+
+            bool found = (data.ordnum() == 12 && tsharded.shard_of(&key) == 0 && tsharded.count() == 3);
+
+            bdb::sharded_recordset * srs = new bdb::sharded_recordset(&tsharded);
+
+            string order;
+
+            while (srs->fetch(&key, &data))
+            {
+                order += key.month().substr(0, 1);
+            }
+
+            delete srs;
+
+            CHECK(found && order == "DNO");
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 76 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Merge recordsets of several tables.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tsharded  = db->add_table("sharded",  month::key_month_compare);
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+
+            bdb::joinlist list;
+
+            list.push_back(new bdb::recordset(tsharded));
+            list.push_back(new bdb::recordset(tupserted));
+
+            bdb::merged_recordset * mrs = new bdb::merged_recordset(list, true);
+
+            month::key  key;
+            month::data data;
+
+            string order;
+
+            while (mrs->fetch(&key, &data))
+            {
+                order += key.month().substr(0, 1);
+            }
+
+            mrs->rewind();
+
+            unsigned int count = 0;
+
+            while (mrs->fetch_key(&key))
+            {
+                count++;
+            }
+
+            delete mrs;
+
+            delete list[0];
+            delete list[1];
+
+            CHECK(order == "ADJMNOS" && count == 7);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 77 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Drop old partitions of partitioned table.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::partitioned_table * ttimeline = new bdb::partitioned_table(db, "timeline", month::ordnum_ix_ordnum_compare, month::ordnum_ix::kOrdnumFieldNumber, 4, true);
+
+            month::ordnum_ix key;
+            month::data      data;
+
+            data.set_season("Winter");
+            data.set_days(31);
+
+            for (int i = 1; i <= 8; i++)
+            {
+                key.set_ordnum(i);
+                data.set_ordnum(i);
+
+                ttimeline->insert(&key, &data);
+            }
+
+            vector <int64_t> partitions;
+            ttimeline->partitions(&partitions);
+
+            bool created = (partitions.size() == 3 && ttimeline->count() == 8);
+
+            unsigned int dropped = ttimeline->drop_before(4);
+
+            key.set_ordnum(2);
+
+            bool found = ttimeline->exists(&key);
+
+            bdb::partitioned_recordset * prs = new bdb::partitioned_recordset(ttimeline);
+
+            int64_t first = 0;
+
+            if (prs->fetch(&key, &data)) first = data.ordnum();
+
+            delete prs;
+            delete ttimeline;
+
+            CHECK(created && dropped == 1 && !found && first == 4);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 78 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Split table into partitions.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            month::key  bound1, bound2;
+
+            bound1.set_month("H");
+            bound2.set_month("P");
+
+            bdb::keylist bounds;
+
+            bounds.push_back(&bound1);
+            bounds.push_back(&bound2);
+
+            bdb::table_options options;
+
+            options.partitions     = 3;
+            options.partition_keys = &bounds;
+
+            bdb::table * tsplit = db->add_table("split", month::key_month_compare, true, options);
+
+            month::key  key;
+            month::data data;
+
+            const char * months[4] = { "September", "April", "June", "December" };
+
+            data.set_season("Any");
+            data.set_days(30);
+
+            for (int i = 0; i < 4; i++)
+            {
+                key.set_month(months[i]);
+                data.set_ordnum(i);
+
+                tsplit->insert(&key, &data);
+            }
+
+            rs = new bdb::recordset(tsplit);
+
+            string order;
+
+            while (rs->fetch(&key, &data))
+            {
+                order += key.month().substr(0, 1);
+            }
+
+            delete rs;
+            rs = NULL;
+
+            key.set_month("June");
+            tsplit->select(&key, &data);
+
+            CHECK(order == "ADJS" && data.ordnum() == 2);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 79 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Check replication role of the database.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            CHECK(db->is_master());
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 80 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Checkpoint the database.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            db->checkpoint(true);
+
+            CHECK(true);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 81 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Open tables lazily.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+
+            options.lazy_open = true;
+
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare, false, options);
+            bdb::table * tmissing  = db->add_table("missing",  month::key_month_compare, false, options);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("September");
+            tupserted->select(&key, &data);
+
+            bool missed = false;
+
+            try
+            {
+                tmissing->exists(&key);
+            }
+            catch (bdb::exception & e)
+            {
+                missed = (e.error() == BDB_ERROR_NOT_FOUND);
+            }
+
+            CHECK(data.ordnum() == 9 && missed);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 82 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Warm the cache by saved snapshot.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            db->save_cache_snapshot();
+
+            CHECK(db->warm_cache(2) != 0);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 83 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Keep the database in memory only.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            int found = 0;
+
+            // transactional and concurrent data store
+            for (int i = 0; i < 2; i++)
+            {
+                bdb::database_options dboptions;
+
+                dboptions.in_memory  = true;
+                dboptions.concurrent = (i != 0);
+
+                bdb::database * mdb = new bdb::database(DATABASE_NAME, false, dboptions);
+
+                bdb::table * tmemory = mdb->add_table("memory", month::key_month_compare, true);
+
+                month::key  key;
+                month::data data;
+
+                key.set_month("May");
+                data.set_season("Spring");
+                data.set_days(31);
+                data.set_ordnum(5);
+
+                tmemory->insert(&key, &data);
+
+                data.Clear();
+                tmemory->select(&key, &data);
+
+                if (data.ordnum() == 5 && tmemory->count() == 1) found++;
+
+                delete mdb;
+            }
+
+            CHECK(found == 2);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 84 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Get statistics of the database and a table.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+
+            bdb::database_stats dbstats;
+            bdb::table_stats    tstats;
+
+            db->stats(&dbstats);
+            tupserted->stats(&tstats);
+
+            CHECK(dbstats.cache_bytes != 0 && dbstats.cache_hits != 0 && tstats.records == 4 && tstats.levels != 0);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 85 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Measure latencies of operations.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("September");
+
+            bdb::set_latency_stats(true);
+
+            for (int i = 0; i < 3; i++)
+            {
+                tupserted->select(&key, &data);
+            }
+
+            bdb::latency_histogram selects, berkeley;
+
+            bdb::get_latency_stats(BDB_LATENCY_SELECT,   &selects);
+            bdb::get_latency_stats(BDB_LATENCY_BERKELEY, &berkeley);
+
+            bdb::set_latency_stats(false);
+
+            uint64_t median = bdb::latency_percentile(&selects, 50.0);
+
+            CHECK(selects.count == 3 && berkeley.count == 3 && median != 0 && median <= selects.max);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 86 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Report slow operations.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("September");
+
+            int commits = 0;
+
+            db->set_slow_threshold(1, count_slow_commits, &commits);
+
+            bdb::transaction txn(db);
+            tupserted->select(&key, &data, &txn);
+            tupserted->update(&key, &data, &txn);
+            txn.commit();
+
+            db->set_slow_threshold(0);
+
+            tupserted->select(&key, &data);
+
+            CHECK(commits == 1);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 87 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Profile comparison and indexing functions.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+
+            options.profile_callbacks = true;
+
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare, false, options);
+            tupserted->add_index("upserted_days", month::data_days_index, month::days_ix_days_compare);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("September");
+
+            tupserted->select(&key, &data);
+            tupserted->update(&key, &data);
+
+            bdb::table_stats stats;
+            tupserted->stats(&stats, true);
+
+            CHECK(stats.compare_calls != 0 && stats.index_calls != 0 && stats.index_calls <= 2);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 88 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Fetch records into pooled messages.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+
+            bdb::message_pool <month::data> pool(4);
+            bdb::recordset rs(tupserted);
+
+            month::key    key;
+            month::data * data = NULL;
+            month::data * first = NULL;
+
+            int  count  = 0;
+            bool reused = true;
+
+            while (rs.fetch(&key, &data, &pool))
+            {
+                if (first == NULL) first = data;
+                reused = reused && (data == first);
+
+                count++;
+                pool.release(data);
+            }
+
+            CHECK(count == 4 && reused && data == NULL && pool.size() == 1);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 89 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Fetch batches of records into arena.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tupserted = db->add_table("upserted", month::key_month_compare);
+
+            bdb::arena batch;
+            vector <month::data *> first, second;
+
+            for (int n = 0; n < 2; n++)
+            {
+                bdb::recordset rs(tupserted);
+
+                month::key    key;
+                month::data * data;
+
+                while (rs.fetch(&key, &data, &batch))
+                {
+                    (n == 0 ? first : second).push_back(data);
+                }
+
+                if (n == 0) batch.reset();
+            }
+
+            size_t used = batch.size();
+            bool   ninth = false;
+
+            for (size_t i = 0; i < second.size(); i++)
+            {
+                if (second[i]->ordnum() == 9) ninth = true;
+            }
+
+            std::sort(first.begin(), first.end());
+            std::sort(second.begin(), second.end());
+
+            CHECK(used == 4 && first.size() == 4 && first == second && ninth);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 90 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Serialize messages of fixed layout into stack buffer.");
+
+        month::ordnum_ix ix;
+        ix.set_ordnum(-1);
+
+        google::protobuf::uint8 buffer[month::ordnum_ix::kMaxByteSize];
+
+        int size = ix.ByteSize();
+        int end  = (int) (ix.SerializeWithCachedSizesToArray(buffer) - buffer);
+
+        month::ordnum_ix parsed;
+        bool res = parsed.ParseFromArray(buffer, end) && parsed.ordnum() == -1;
+
+        // incomplete message takes general path
+        month::ordnum_ix empty;
+
+        CHECK(size == month::ordnum_ix::kMaxByteSize && end == size && res && empty.ByteSize() == 0);
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 91 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Table of message types, known at run time only.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            using google::protobuf::Descriptor;
+            using google::protobuf::Message;
+            using google::protobuf::Reflection;
+
+            google::protobuf::DynamicMessageFactory factory;
+
+            const Descriptor * tkey  = month::key::descriptor();
+            const Descriptor * tdata = month::data::descriptor();
+            const Descriptor * tdays = month::days_ix::descriptor();
+
+            bdb::table_options options;
+            options.key_type = tkey;
+
+            bdb::table * tdynamic = db->add_table("dynamic", NULL, true, options);
+            bdb::index * idynamic = tdynamic->add_index("dynamic_days", tdata->FindFieldByName("days"), tdays);
+
+            Message * key  = factory.GetPrototype(tkey)->New();
+            Message * data = factory.GetPrototype(tdata)->New();
+
+            const Reflection * rkey  = key->GetReflection();
+            const Reflection * rdata = data->GetReflection();
+
+            const char * months[] = { "June", "April", "May" };
+            const int    days[]   = { 30, 30, 31 };
+
+            for (int i = 0; i < 3; i++)
+            {
+                rkey->SetString(key, tkey->FindFieldByName("month"), months[i]);
+                rdata->SetString(data, tdata->FindFieldByName("season"), "Spring");
+                rdata->SetInt32(data, tdata->FindFieldByName("days"), days[i]);
+                rdata->SetInt64(data, tdata->FindFieldByName("ordnum"), i);
+                tdynamic->insert(key, data);
+            }
+
+            string order;
+
+            {
+                bdb::recordset rs(tdynamic);
+                while (rs.fetch(key, data)) order += rkey->GetString(*key, tkey->FindFieldByName("month")) + ",";
+            }
+
+            Message * ix = factory.GetPrototype(tdays)->New();
+            ix->GetReflection()->SetInt32(ix, tdays->FindFieldByName("days"), 30);
+
+            unsigned int count = idynamic->count(ix);
+
+            delete ix;
+            delete data;
+            delete key;
+
+            CHECK(order == "April,June,May," && count == 2);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 92 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Typed tables with raw keys.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::typed_table <int64_t, month::data> numbers(db, "typed_numbers", true);
+            bdb::typed_table <string,  month::data> names  (db, "typed_names",   true);
+
+            month::data data;
+            data.set_season("Spring");
+            data.set_days(30);
+
+            const int64_t keys[] = { 5, -3, 1000000, 0, -70000 };
+
+            for (int i = 0; i < 5; i++)
+            {
+                data.set_ordnum(keys[i]);
+                numbers.insert(keys[i], &data);
+            }
+
+            names.insert("May",   &data);
+            names.insert("April", &data);
+
+            string order;
+
+            {
+                bdb::recordset rs(numbers.get());
+                int64_t key, prev = 0;
+
+                while (numbers.fetch(&rs, &key, &data))
+                {
+                    order += (key == data.ordnum() && (order.empty() || key > prev) ? "+" : "-");
+                    prev = key;
+                }
+            }
+
+            string first;
+
+            {
+                bdb::recordset rs(names.get());
+                names.fetch(&rs, &first, &data);
+            }
+
+            bool exists = numbers.exists(-3) && !numbers.exists(3) && names.exists("May");
+
+            numbers.select(-70000, &data);
+
+            CHECK(order == "+++++" && first == "April" && exists && data.ordnum() == -70000);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 93 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Strongly typed tables, indexes and recordsets.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            typedef bdb::table_t <month::key, month::data, bdb::compare_with <month::key_month_compare> > months_t;
+
+            months_t tstrong(db, "strong", true);
+
+            bdb::index_t <month::days_ix> istrong =
+                tstrong.add_index <month::days_ix,
+                                   bdb::extract_with <month::data_days_index>,
+                                   bdb::compare_with <month::days_ix_days_compare> > ("strong_days");
+
+            month::key  key;
+            month::data data;
+
+            const char * months[] = { "June", "April", "May" };
+            const int    days[]   = { 30, 30, 31 };
+
+            for (int i = 0; i < 3; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season("Spring");
+                data.set_days(days[i]);
+                data.set_ordnum(i);
+                tstrong.insert(key, &data);
+            }
+
+            string order;
+
+            {
+                bdb::recordset_t <month::key, month::data> rs(&tstrong);
+                while (rs.fetch(&key, &data)) order += key.month() + ",";
+            }
+
+            month::days_ix ix;
+            ix.set_days(30);
+
+            string found;
+
+            {
+                bdb::recordset_t <month::key, month::data> rs(&istrong, ix);
+                while (rs.fetch(&key, &data)) found += key.month() + ",";
+            }
+
+            key.set_month("May");
+            bool exists = tstrong.exists(key) && istrong.count(ix) == 2;
+
+            CHECK(order == "April,June,May," && found == "April,June," && exists);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 94 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Table of LITE_RUNTIME messages.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tlite = db->add_table("lite", bdb::field_compare <counter::key::kIdFieldNumber, BDB_FIELD_INT64>, true);
+
+            counter::key  key;
+            counter::data data;
+
+            const int64_t ids[] = { 7, -2, 3 };
+
+            for (int i = 0; i < 3; i++)
+            {
+                key.set_id(ids[i]);
+                data.set_name("counter");
+                data.set_value(ids[i] * 10);
+                tlite->insert(&key, &data);
+            }
+
+            key.set_id(3);
+            tlite->select(&key, &data);
+
+            bool selected = (data.value() == 30);
+            bool sorted   = true;
+            int64_t prev  = 0;
+            int count     = 0;
+
+            {
+                bdb::recordset rs(tlite);
+
+                while (rs.fetch(&key, &data))
+                {
+                    sorted = sorted && (count == 0 || key.id() > prev) && data.value() == key.id() * 10;
+                    prev   = key.id();
+                    count++;
+                }
+            }
+
+            CHECK(selected && sorted && count == 3);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 95 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Asynchronous operations.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tasync = db->add_table("async", month_compare, true);
+
+            const char * months[] = { "July", "August", "September" };
+
+            month::key  keys[3];
+            month::data data[3];
+
+            int completed = 0;
+
+            bdb::async_database adb(db, 2, 8);
+
+            for (int i = 0; i < 3; i++)
+            {
+                keys[i].set_month(months[i]);
+                data[i].set_season("Summer");
+                data[i].set_days(30 + i);
+                data[i].set_ordnum(7 + i);
+                adb.insert(tasync, &keys[i], &data[i], NULL, count_completed, &completed);
+            }
+
+            adb.flush();
+
+            month::key  missing;
+            month::data selected, other;
+
+            missing.set_month("December");
+
+            bdb::async_result r1, r2, r3;
+
+            adb.select(tasync, &keys[1], &selected, &r1);
+            adb.select(tasync, &missing, &other, &r2);
+            adb.exists(tasync, &keys[2], &r3);
+
+            bool reads = (r1.wait() == 0 && r1.found() && selected.days() == 31 &&
+                          r2.wait() == BDB_ERROR_NOT_FOUND && !r2.found() &&
+                          r3.found());
+
+            bdb::async_result r4;
+            adb.insert(tasync, &keys[0], &data[0], &r4);
+
+            CHECK(completed == 3 && reads && r4.wait() == BDB_ERROR_EXISTS && adb.pending() == 0);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 96 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Asynchronous operations with executor of completions.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tasync = db->add_table("async_executor", month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("August");
+            data.set_season("Summer");
+            data.set_days(31);
+            data.set_ordnum(8);
+            tasync->insert(&key, &data);
+            data.Clear();
+
+            int completed = 0;
+
+            bdb::async_database adb(db);
+            adb.set_executor(defer_completion);
+
+            bdb::async_result result;
+            adb.select(tasync, &key, &data, &result, count_completed, &completed);
+            adb.flush();
+
+            bool deferred_ok = (!result.is_ready() && completed == 0 && deferred.size() == 1);
+
+            for (size_t i = 0; i < deferred.size(); i++)
+            {
+                deferred[i].first(deferred[i].second);
+            }
+
+            deferred.clear();
+
+            CHECK(deferred_ok && result.is_ready() && result.wait() == 0 && completed == 1 && data.days() == 31);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 97 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Check recordset with read-ahead.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            month::key  key;
+            month::data data;
+
+            vector <string> expected;
+
+            rs = new bdb::recordset(tmonth);
+
+            while (rs->fetch(&key, &data))
+            {
+                expected.push_back(key.month());
+            }
+
+            delete rs;
+
+            rs = new bdb::recordset(tmonth);
+            rs->set_read_ahead(3);
+
+            bool         res = true;
+            unsigned int i   = 0;
+
+            while (rs->fetch(&key, &data))
+            {
+                res = res && i < expected.size() && key.month() == expected[i];
+                i++;
+
+                // rows, which are already read ahead, are kept
+                if (i == 2) rs->set_read_ahead(2);
+            }
+
+            res = res && (i == expected.size());
+
+            rs->rewind();
+            res = res && rs->fetch(&key, &data) && key.month() == expected[0];
+            res = res && rs->count() == expected.size();
+
+            delete rs;
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 98 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Online compaction of table and index.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tcompact = db->add_table("compact", month_compare, true);
+            bdb::index * icompact = tcompact->add_index("compact_days", days_ix_index, days_ix_compare);
+
+            month::key  key;
+            month::data data;
+
+            for (int i = 0; i < 200; i++)
+            {
+                key.set_month(string("m") + (char) ('0' + i / 100) + (char) ('0' + i / 10 % 10) + (char) ('0' + i % 10));
+                data.set_season(string(100, 'x'));
+                data.set_days(i % 31);
+                data.set_ordnum(i);
+                tcompact->insert(&key, &data);
+            }
+
+            for (int i = 1; i < 200; i += 2)
+            {
+                key.set_month(string("m") + (char) ('0' + i / 100) + (char) ('0' + i / 10 % 10) + (char) ('0' + i % 10));
+                tcompact->remove(&key);
+            }
+
+            bdb::compact_options options;
+            options.fill_percent = 90;
+            options.step_pages   = 2;
+            options.free_space   = true;
+
+            bdb::compact_result tresult, iresult;
+
+            tcompact->compact(options, &tresult);
+            icompact->compact(options, &iresult);
+
+            key.set_month("m100");
+
+            CHECK(tresult.completed && iresult.completed && tresult.steps >= 1 &&
+                  tcompact->count() == 100 && tcompact->exists(&key));
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 99 //----------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Offline build of table with external sorting.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            month::key  key;
+            month::data data;
+
+            {
+                bdb::table_builder builder(db, "built", month_compare, bdb::table_options(), 512);
+
+                // records are added in reverse order, and are sorted by the builder
+                for (int i = 99; i >= 0; i--)
+                {
+                    key.set_month(string("m") + (char) ('0' + i / 10) + (char) ('0' + i % 10));
+                    data.set_season("winter");
+                    data.set_days(i % 31);
+                    data.set_ordnum(i);
+                    builder.add(&key, &data);
+                }
+
+                builder.commit();
+            }
+
+            bdb::table * tbuilt = db->add_table("built", month_compare);
+
+            key.set_month("m42");
+            tbuilt->select(&key, &data);
+
+            CHECK(tbuilt->count() == 100 && data.ordnum() == 42);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 100 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Capture changes of table.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.capture_changes = true;
+
+            bdb::table * tcaptured = db->add_table("captured", month_compare, true, options);
+
+            bdb::change_stream stream(db);
+            bdb::change_record change;
+
+            // changes made before are skipped
+            while (stream.next(&change)) {}
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("march");
+            data.set_season("spring");
+            data.set_days(31);
+            data.set_ordnum(3);
+
+            tcaptured->insert(&key, &data);
+
+            data.set_ordnum(4);
+            tcaptured->update(&key, &data);
+            tcaptured->remove(&key);
+
+            bool res = stream.next(&change) && change.operation == BDB_CHANGE_INSERT && change.table == "captured" && change.olddata.empty();
+            res = res && stream.next(&change) && change.operation == BDB_CHANGE_UPDATE && !change.olddata.empty() && !change.newdata.empty();
+            res = res && stream.next(&change) && change.operation == BDB_CHANGE_REMOVE && change.newdata.empty();
+            res = res && !stream.next(&change, 20);
+
+            db->trim_changes(change.sequence);
+
+            bdb::change_stream trimmed(db);
+            res = res && !trimmed.next(&change);
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 101 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Notify subscribers of committed changes.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tnotified = db->add_table("notified", month_compare, true);
+
+            unsigned int counts[2] = { 0, 0 };
+            tnotified->subscribe(count_notices, counts);
+
+            month::key  key;
+            month::data data;
+
+            data.set_season("summer");
+            data.set_days(30);
+            data.set_ordnum(6);
+
+            // changes of one transaction are coalesced into one notification per record
+            db->begin_transaction();
+            key.set_month("june");
+            tnotified->insert(&key, &data);
+            data.set_days(31);
+            tnotified->update(&key, &data);
+            key.set_month("july");
+            tnotified->insert(&key, &data);
+            db->commit_transaction();
+
+            // changes of rolled back transaction are dropped
+            db->begin_transaction();
+            key.set_month("august");
+            tnotified->insert(&key, &data);
+            db->rollback_transaction();
+
+            db->wait_notifications();
+
+            tnotified->unsubscribe(count_notices, counts);
+
+            CHECK(counts[0] == 1 && counts[1] == 2);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 102 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Maintain materialized aggregate of table.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tsummed = db->add_table("summed", month_compare, true);
+            bdb::materialized_aggregate * seasons = tsummed->add_aggregate("summed_seasons", month::data::kDaysFieldNumber, BDB_FIELD_INT32, month::data::kSeasonFieldNumber);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("june");
+            data.set_season("summer");
+            data.set_days(30);
+            data.set_ordnum(6);
+            tsummed->insert(&key, &data);
+
+            key.set_month("july");
+            data.set_days(31);
+            data.set_ordnum(7);
+            tsummed->insert(&key, &data);
+
+            key.set_month("september");
+            data.set_days(30);
+            data.set_ordnum(9);
+            tsummed->insert(&key, &data);
+
+            // the record moves from one group to another
+            data.set_season("autumn");
+            tsummed->update(&key, &data);
+
+            key.set_month("july");
+            tsummed->remove(&key);
+
+            bdb::aggregate_value summer, autumn;
+
+            bool res = seasons->select("summer", &summer) && summer.count == 1 && summer.sum == 30;
+            res = res && seasons->select("autumn", &autumn) && autumn.count == 1 && autumn.values == 1 && autumn.sum == 30;
+            res = res && !seasons->select("winter", &summer) && seasons->total().count == 2;
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 103 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Apply changes to deferred index in background.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tlazy  = db->add_table("lazy", month_compare, true);
+            bdb::index * ilazy  = tlazy->add_deferred_index("lazy_seasons", season_ix_index, season_ix_compare);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("june");
+            data.set_season("Summer");
+            data.set_days(30);
+            data.set_ordnum(6);
+            tlazy->insert(&key, &data);
+
+            key.set_month("july");
+            data.set_days(31);
+            data.set_ordnum(7);
+            tlazy->insert(&key, &data);
+
+            key.set_month("august");
+            data.set_ordnum(8);
+            tlazy->insert(&key, &data);
+
+            // the record moves to another index key, and removed one leaves the index
+            data.set_season("Autumn");
+            data.set_days(31);
+            tlazy->update(&key, &data);
+
+            key.set_month("july");
+            tlazy->remove(&key);
+
+            bool res = ilazy->wait_applied(5000);
+
+            month::season_ix season;
+
+            season.set_season("Summer");
+            res = res && ilazy->count(&season) == 1;
+
+            season.set_season("Autumn");
+            res = res && ilazy->count(&season) == 1;
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 104 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Validate foreign keys of batch before writing.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tparents  = db->add_table("validated_seasons", season_compare, true);
+            bdb::table * tchildren = db->add_table("validated_months",  month_compare,  true);
+            bdb::index * iparents  = tchildren->add_index("validated_season", season_ix_index, season_ix_compare);
+
+            iparents->add_foreign(tparents);
+
+            season::key  parent;
+            season::data pdata;
+
+            parent.set_season("Summer");
+            tparents->insert(&parent, &pdata);
+
+            bdb::write_batch batch(db, true);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("June");
+            data.set_season("Summer");
+            data.set_days(30);
+            data.set_ordnum(6);
+            batch.insert(tchildren, &key, &data);
+
+            batch.commit();
+
+            key.set_month("July");
+            data.set_days(31);
+            data.set_ordnum(7);
+            batch.insert(tchildren, &key, &data);
+
+            // the season doesn't exist, so nothing of the batch is written
+            key.set_month("December");
+            data.set_season("Winter");
+            data.set_ordnum(12);
+            batch.insert(tchildren, &key, &data);
+
+            bool res = false;
+
+            try
+            {
+                batch.commit();
+            }
+            catch (bdb::exception &e)
+            {
+                res = (BDB_ERROR_FOREIGN_KEY == e.error());
+            }
+
+            month::key june, july;
+            june.set_month("June");
+            july.set_month("July");
+
+            CHECK(res && batch.size() == 2 && tchildren->exists(&june) && !tchildren->exists(&july));
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 105 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Order keys of single field by built-in comparison functions.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tsingle = db->add_table("single", bdb::int64_key_compare, true);
+            bdb::table * tnames  = db->add_table("single_names", bdb::string_key_compare, true);
+
+            counter::key  key;
+            counter::data data;
+
+            // differences of these ids don't fit into "int"
+            const int64_t ids[] = { (int64_t) 1 << 40, -((int64_t) 1 << 40), 3, -2, 1000 };
+
+            for (int i = 0; i < 5; i++)
+            {
+                key.set_id(ids[i]);
+                data.set_name("counter");
+                data.set_value(ids[i]);
+                tsingle->insert(&key, &data);
+            }
+
+            bool sorted  = true;
+            int64_t prev = 0;
+            int count    = 0;
+
+            {
+                bdb::recordset rs(tsingle);
+
+                while (rs.fetch(&key, &data))
+                {
+                    sorted = sorted && (count == 0 || key.id() > prev);
+                    prev   = key.id();
+                    count++;
+                }
+            }
+
+            month::key  mkey;
+            month::data mdata;
+
+            const char * months[] = { "May", "March", "Mar", "April" };
+
+            for (int i = 0; i < 4; i++)
+            {
+                mkey.set_month(months[i]);
+                mdata.set_season("Spring");
+                mdata.set_days(30);
+                mdata.set_ordnum(i);
+                tnames->insert(&mkey, &mdata);
+            }
+
+            string names;
+
+            {
+                bdb::recordset rs(tnames);
+
+                while (rs.fetch(&mkey, &mdata))
+                {
+                    names += mkey.month() + ",";
+                }
+            }
+
+            CHECK(sorted && count == 5 && names == "April,Mar,March,May,");
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 106 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Sort duplicate sets of indexes by separate comparison function.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options bytewise, single;
+
+            bytewise.dup_bytewise = true;
+            single.fn_dup_compare = bdb::string_key_compare;
+
+            bdb::table * tables[2];
+
+            tables[0] = db->add_table("dup_bytewise", month_compare, true, bytewise);
+            tables[1] = db->add_table("dup_single",   month_compare, true, single);
+
+            bool res = true;
+
+            for (int t = 0; t < 2; t++)
+            {
+                bdb::index * iseasons = tables[t]->add_index("dup_seasons", season_ix_index, season_ix_compare);
+
+                month::key  key;
+                month::data data;
+
+                const char * months[] = { "June", "July", "August", "May" };
+
+                for (int i = 0; i < 4; i++)
+                {
+                    key.set_month(months[i]);
+                    data.set_season("Summer");
+                    data.set_days(31);
+                    data.set_ordnum(i);
+                    tables[t]->insert(&key, &data);
+                }
+
+                // removed and moved records leave their duplicate sets
+                key.set_month("July");
+                tables[t]->remove(&key);
+
+                key.set_month("May");
+                data.set_season("Spring");
+                tables[t]->update(&key, &data);
+
+                month::season_ix season;
+                season.set_season("Summer");
+
+                unsigned int fetched = 0;
+
+                {
+                    bdb::recordset rs(iseasons, &season);
+
+                    while (rs.fetch(&key, &data)) fetched++;
+                }
+
+                res = res && fetched == 2 && iseasons->count(&season) == 2;
+            }
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 107 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Read duplicates of index in bulk, and distinct keys of index.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tdups    = db->add_table("bulk_dups", month_compare, true);
+            bdb::index * iseasons = tdups->add_index("bulk_seasons", season_ix_index, season_ix_compare);
+
+            month::key  key;
+            month::data data;
+
+            const char * months[] = { "December", "January", "February", "June", "July", "August" };
+
+            for (int i = 0; i < 6; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season(i < 3 ? "Winter" : "Summer");
+                data.set_days(30);
+                data.set_ordnum(i);
+                tdups->insert(&key, &data);
+            }
+
+            month::season_ix season;
+            season.set_season("Winter");
+
+            unsigned int fetched = 0;
+            bool winter = true;
+
+            {
+                bdb::recordset rs(iseasons, &season);
+                rs.set_bulk(1024);
+
+                while (rs.fetch(&key, &data))
+                {
+                    winter = winter && data.season() == "Winter";
+                    fetched++;
+                }
+            }
+
+            vector <string>       keys;
+            vector <unsigned int> counts;
+
+            unsigned int distinct = iseasons->distinct_keys(&keys, &counts);
+
+            bool res = (fetched == 3 && winter && distinct == 2 && counts.size() == 2 && counts[0] == 3 && counts[1] == 3);
+
+            // keys of the index are in ProtoBuf format
+            res = res && season.ParseFromString(keys[0]) && season.season() == "Summer";
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 108 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Fetch primary keys only of joined recordsets.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tjoin   = db->add_table("join_keys", month_compare);
+            bdb::index * jseason = tjoin->add_index("join_keys_seasons", season_ix_index, season_ix_compare);
+            bdb::index * jdays   = tjoin->add_index("join_keys_days",    days_ix_index,   days_ix_compare);
+
+            month::key  key;
+            month::data data;
+
+            const char * months[] = { "December", "January", "February", "June", "July", "August" };
+            const int    days[]   = { 31, 31, 28, 30, 31, 31 };
+
+            for (int i = 0; i < 6; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season(i < 3 ? "Winter" : "Summer");
+                data.set_days(days[i]);
+                data.set_ordnum(i);
+                tjoin->insert(&key, &data);
+            }
+
+            month::season_ix skey;
+            month::days_ix   dkey;
+
+            skey.set_season("Winter");
+            dkey.set_days(31);
+
+            bdb::joinlist list;
+            list.push_back(new bdb::recordset(jseason, &skey));
+            list.push_back(new bdb::recordset(jdays,   &dkey));
+
+            unsigned int fetched = 0;
+            bool empty = true;
+
+            {
+                bdb::recordset rs(tjoin, list, BDB_JOIN_KEYS);
+
+                // data of keys-only join are empty
+                while (rs.fetch(&key, &data))
+                {
+                    empty = empty && !data.has_season() && (key.month() == "December" || key.month() == "January");
+                    fetched++;
+                }
+            }
+
+            for (unsigned i = 0; i < list.size(); i++)
+            {
+                delete list[i];
+            }
+
+            list.clear();
+
+            dkey.set_days(30);
+
+            list.push_back(new bdb::recordset(jseason, &skey));
+            list.push_back(new bdb::recordset(jdays,   &dkey));
+
+            unsigned int combined = 0;
+
+            {
+                bdb::recordset rs(tjoin, list, BDB_JOIN_UNION | BDB_JOIN_KEYS);
+                while (rs.fetch_key(&key)) combined++;
+            }
+
+            for (unsigned i = 0; i < list.size(); i++)
+            {
+                delete list[i];
+            }
+
+            CHECK(fetched == 2 && empty && combined == 4);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 109 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Recycle cursors of recordsets within transactions of a thread.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::database_options dboptions;
+
+            dboptions.in_memory    = true;
+            dboptions.cursor_cache = 4;
+
+            bdb::database * mdb = new bdb::database(DATABASE_NAME, false, dboptions);
+
+            bdb::table * trecycled = mdb->add_table("recycled", month_compare, true);
+            bdb::index * iseasons  = trecycled->add_index("recycled_seasons", season_ix_index, season_ix_compare);
+
+            month::key  key;
+            month::data data;
+
+            const char * months[] = { "December", "January", "February", "June", "July", "August" };
+
+            for (int i = 0; i < 6; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season(i < 3 ? "Winter" : "Summer");
+                data.set_days(30);
+                data.set_ordnum(i);
+                trecycled->insert(&key, &data);
+            }
+
+            month::season_ix season;
+
+            unsigned int fetched = 0;
+
+            mdb->begin_transaction();
+
+            // cursors and keys of closed recordsets are reused by the next ones
+            for (int i = 0; i < 10; i++)
+            {
+                season.set_season(i % 2 == 0 ? "Winter" : "Summer");
+
+                bdb::recordset rs(iseasons, &season);
+                while (rs.fetch(&key, &data)) fetched++;
+            }
+
+            // cursors of nested transaction are closed on its rollback
+            mdb->begin_transaction();
+
+            {
+                bdb::recordset rs(trecycled);
+                while (rs.fetch(&key, &data)) fetched++;
+            }
+
+            mdb->rollback_transaction();
+
+            {
+                bdb::recordset rs(trecycled);
+                while (rs.fetch(&key, &data)) fetched++;
+            }
+
+            mdb->commit_transaction();
+
+            {
+                bdb::recordset rs(trecycled);
+                while (rs.fetch(&key, &data)) fetched++;
+            }
+
+            delete mdb;
+
+            CHECK(fetched == 30 + 6 + 6 + 6);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 110 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Exchange opened recordsets with short and long keys.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tswapped = db->add_table("swapped", month_compare, true);
+            bdb::index * iseasons = tswapped->add_index("swapped_seasons", season_ix_index, season_ix_compare);
+
+            month::key  key;
+            month::data data;
+
+            const char * months[] = { "December", "January", "February", "June", "July", "August", "Undecimber" };
+
+            // the last season is longer than buffer of short keys
+            string endless(100, 'x');
+
+            for (int i = 0; i < 7; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season(i < 3 ? "Winter" : (i < 6 ? "Summer" : endless.c_str()));
+                data.set_days(30);
+                data.set_ordnum(i);
+                tswapped->insert(&key, &data);
+            }
+
+            month::season_ix winter, summer, longest;
+
+            winter.set_season("Winter");
+            summer.set_season("Summer");
+            longest.set_season(endless);
+
+            bdb::recordset rs1(iseasons, &winter);
+            bdb::recordset rs2(iseasons, &summer);
+
+            bool res = rs1.fetch(&key, &data) && data.season() == "Winter";
+
+            rs1.swap(rs2);
+
+            unsigned int winters = 0, summers = 0;
+
+            while (rs1.fetch(&key, &data)) if (data.season() == "Summer") summers++;
+            while (rs2.fetch(&key, &data)) if (data.season() == "Winter") winters++;
+
+            res = res && summers == 3 && winters == 2;
+
+            {
+                bdb::recordset rs3(iseasons, &longest);
+
+                rs3.swap(rs1);
+                res = res && rs1.fetch(&key, &data) && key.month() == "Undecimber" && !rs1.fetch(&key, &data);
+            }
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 111 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Iterate rows of recordsets, reusing their messages.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * titerated = db->add_table("iterated", month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            const char * months[] = { "December", "January", "February", "June", "July", "August" };
+            const int    days[]   = { 31, 31, 28, 30, 31, 31 };
+
+            for (int i = 0; i < 6; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season(i < 3 ? "Winter" : "Summer");
+                data.set_days(days[i]);
+                data.set_ordnum(i);
+                titerated->insert(&key, &data);
+            }
+
+            bdb::recordset rs(titerated);
+
+            bdb::rows <month::key, month::data> range(&rs);
+
+            unsigned int fetched = 0, longest = 0;
+
+            for (bdb::rows <month::key, month::data>::iterator i = range.begin(); i != range.end(); ++i)
+            {
+                int64_t ordnum = -1;
+
+                // raw bytes of data are available without unserializing them
+                if (i->view().get(3, &ordnum) && ordnum >= 0 && !i->key().month().empty()) fetched++;
+                if (i->data().days() == 31) longest++;
+            }
+
+            CHECK(fetched == 6 && longest == 4 && range.begin() == range.end());
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 112 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Allocate identifiers of autonomous sequence outside of transactions.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::sequence * seq = db->add_sequence("autonomous", true, 0, true);
+
+            int64_t first = seq->id();
+
+            db->begin_transaction();
+            int64_t second = seq->id();
+            db->rollback_transaction();
+
+            // identifiers of rolled back transaction are not returned back
+            int64_t third = seq->id();
+
+            CHECK(second == first + 1 && third == second + 1);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 113 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Generate time-ordered IDs of nodes.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::id_generator * gen = db->add_generator("orders", 7);
+
+            bool    res  = true;
+            int64_t last = 0;
+
+            for (int i = 0; i < 10000; i++)
+            {
+                int64_t id = gen->id();
+
+                res  = res && id > last && ((id >> 12) & 1023) == 7;
+                last = id;
+            }
+
+            // generator of the same name continues after the time, reserved by the previous one
+            bdb::id_generator * reopened = db->add_generator("orders", 8);
+
+            int64_t id = reopened->id();
+
+            CHECK(res && id > last && ((id >> 12) & 1023) == 8);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 114 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Share the environment by several processes.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            // reopen database as one of processes, sharing the environment
+            delete db;
+
+            bdb::database_options dboptions;
+            dboptions.auto_commit   = true;
+            dboptions.multi_process = true;
+
+            db = new bdb::database(DATABASE_NAME, false, dboptions);
+
+            seq = db->add_sequence("month");
+
+            tseason = db->add_table("season", season_compare);
+            tmonth  = db->add_table("month",  month_compare );
+
+            iseason = tmonth->add_index("season", season_ix_index, season_ix_compare);
+            idays   = tmonth->add_index("days",   days_ix_index,   days_ix_compare);
+            iordnum = tmonth->add_index("ordnum", ordnum_ix_index, ordnum_ix_compare, true);
+
+            // no process has died
+            db->check_failures();
+
+            bdb::table * tshared = db->add_table("shared", month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("June");
+            data.set_season("Summer");
+            data.set_days(30);
+            data.set_ordnum(6);
+
+            tshared->insert(&key, &data);
+
+            data.Clear();
+            tshared->select(&key, &data);
+
+            CHECK(data.days() == 30);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 115 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Look up, insert and remove records without exceptions.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tfound = db->add_table("found", month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("June");
+            data.set_season("Summer");
+            data.set_days(30);
+            data.set_ordnum(6);
+
+            bool res = (tfound->try_insert(&key, &data) == 0);
+            res = res && (tfound->try_insert(&key, &data) == BDB_ERROR_EXISTS);
+
+            data.Clear();
+            res = res && tfound->find(&key, &data) && data.days() == 30;
+
+            res = res && (tfound->try_remove(&key) == 0);
+            res = res && (tfound->try_remove(&key) == BDB_ERROR_NOT_FOUND);
+
+            data.Clear();
+            res = res && !tfound->find(&key, &data) && !data.has_days();
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 116 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Index records by each value of repeated field.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            // each record has one value of the field, so it is indexed once
+            bdb::table * ttags = db->add_table("tags", month_compare, true);
+            bdb::index * itags = ttags->add_index("tags_season", month::data::kSeasonFieldNumber, month::season_ix::kSeasonFieldNumber,
+                                                  season_ix_compare, false, false, true);
+
+            month::key       key;
+            month::data      value;
+            month::season_ix skey;
+
+            key.set_month("June");
+            value.set_season("Summer");
+            value.set_days(30);
+            value.set_ordnum(6);
+            ttags->insert(&key, &value);
+
+            key.set_month("July");
+            value.set_days(31);
+            value.set_ordnum(7);
+            ttags->insert(&key, &value);
+
+            skey.set_season("Summer");
+            bool res = (itags->count(&skey) == 2);
+
+            ttags->remove(&key);
+            res = res && itags->count(&skey) == 1;
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 117 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Make composite index from fields of data in order-preserving format.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            static const int fields[] = { month::data::kSeasonFieldNumber, month::data::kDaysFieldNumber, month::data::kOrdnumFieldNumber };
+            static const int types[]  = { BDB_FIELD_STRING, BDB_FIELD_INT32, BDB_FIELD_INT64 };
+
+            bdb::table * tcomp = db->add_table("composite", month_compare, true);
+            bdb::index * icomp = tcomp->add_index("composite_ix", fields, types, 3);
+
+            static const char * months[] = { "June", "July", "August", "December" };
+            static const char * seasons[] = { "Summer", "Summer", "Summer", "Winter" };
+            static const int    days[]   = { 30, 31, 31, 31 };
+
+            month::key  key;
+            month::data data;
+
+            for (int i = 0; i < 4; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season(seasons[i]);
+                data.set_days(days[i]);
+                data.set_ordnum(i < 3 ? i + 6 : 12);
+                tcomp->insert(&key, &data);
+            }
+
+            // data message has the same fields as the key, so it's a complete key of the index
+            data.set_season("Summer");
+            data.set_days(31);
+            data.set_ordnum(8);
+
+            bdb::recordset * rs = new bdb::recordset(icomp, &data);
+            bool res = rs->fetch(&key, &data) && key.month() == "August" && !rs->fetch(&key, &data);
+            delete rs;
+
+            // leading field only, records are sorted by the rest of fields
+            month::season_ix skey;
+            skey.set_season("Summer");
+
+            rs = new bdb::recordset(icomp, &skey, &skey, BDB_RANGE_PREFIX);
+            res = res && rs->fetch(&key, &data) && key.month() == "June";
+            res = res && rs->fetch(&key, &data) && key.month() == "July";
+            res = res && rs->fetch(&key, &data) && key.month() == "August";
+            res = res && !rs->fetch(&key, &data);
+            delete rs;
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 118 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Search records by words of string field with full-text index.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * ttext = db->add_table("text", month_compare, true);
+            bdb::index * itext = ttext->add_text_index("text_ix", month::data::kSeasonFieldNumber);
+
+            static const char * months[]  = { "June", "August", "December" };
+            static const char * seasons[] = { "Early summer", "Late SUMMER, hot summer", "Early winter" };
+
+            month::key  key;
+            month::data data;
+
+            for (int i = 0; i < 3; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season(seasons[i]);
+                data.set_days(31);
+                data.set_ordnum(i);
+                ttext->insert(&key, &data);
+            }
+
+            bdb::recordset * rs = new bdb::recordset(itext, string("summer late"));
+            bool res = rs->fetch(&key, &data) && key.month() == "August" && !rs->fetch(&key, &data);
+            delete rs;
+
+            rs = new bdb::recordset(itext, string("winter, late"), BDB_JOIN_UNION);
+            res = res && rs->count() == 2;
+            delete rs;
+
+            // single word is a key of the index
+            month::season_ix skey;
+            skey.set_season("early");
+
+            res = res && itext->count(&skey) == 2;
+
+            key.set_month("June");
+            ttext->remove(&key);
+            res = res && itext->count(&skey) == 1;
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 119 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Hide expired records of table with time to live.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            // ordinal number is expiration time of the record itself
+            bdb::table_options options;
+            options.ttl_field = month::data::kOrdnumFieldNumber;
+
+            bdb::table * tttl = db->add_table("ttl", month_compare, true, options);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("January");
+            data.set_season("Winter");
+            data.set_days(31);
+            data.set_ordnum(1);
+            tttl->insert(&key, &data);
+
+            key.set_month("February");
+            data.set_days(28);
+            data.set_ordnum((int64_t) 2000000000 * 2);
+            tttl->insert(&key, &data);
+
+            key.set_month("January");
+            bool res = !tttl->find(&key, &data);
+
+            key.set_month("February");
+            res = res && tttl->find(&key, &data) && data.days() == 28;
+
+            bdb::recordset * rs = new bdb::recordset(tttl);
+            res = res && rs->count() == 1;
+            delete rs;
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 120 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Buffer random writes in memory and flush them to the table in order of keys.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::buffered_table * tbuf = new bdb::buffered_table(db, "buffered", month_compare, true);
+
+            static const char * months[] = { "March", "January", "February" };
+
+            month::key  key;
+            month::data data;
+
+            for (int i = 0; i < 3; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season("Winter");
+                data.set_days(30 + i);
+                data.set_ordnum(i);
+                tbuf->put(&key, &data);
+            }
+
+            key.set_month("March");
+            tbuf->remove(&key);
+
+            // changes are not in the table yet, but reads see them
+            bool res = tbuf->size() == 3 && tbuf->get()->count() == 0;
+            res = res && !tbuf->exists(&key);
+
+            key.set_month("February");
+            res = res && tbuf->find(&key, &data) && data.days() == 32;
+
+            tbuf->flush();
+
+            res = res && tbuf->size() == 0 && tbuf->get()->count() == 2;
+            res = res && tbuf->find(&key, &data) && data.days() == 32;
+
+            delete tbuf;
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 121 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Merge deltas into records without reading them, directly and through the buffer.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tmerge = db->add_table("merged", month_compare, true);
+
+            int field = 2;
+
+            month::key  key;
+            month::data data;
+            month::data delta;
+
+            key.set_month("April");
+            delta.set_season("Spring");
+            delta.set_days(10);
+            delta.set_ordnum(4);
+
+            // the first delta creates the record, and the next ones are added to it
+            bool res = tmerge->merge(&key, &delta, bdb::merge_add, &field);
+            res = res && !tmerge->merge(&key, &delta, bdb::merge_add, &field);
+            res = res && !tmerge->merge(&key, &delta, bdb::merge_add, &field);
+
+            tmerge->select(&key, &data);
+            res = res && data.days() == 30 && data.season() == "Spring";
+
+            bdb::buffered_table * tbuf = new bdb::buffered_table(db, "merged", month_compare, false, bdb::table_options(), 0, bdb::merge_add, &field);
+
+            delta.set_days(1);
+            tbuf->merge(&key, &delta);
+            tbuf->merge(&key, &delta);
+
+            // coalesced deltas are seen by reads before the flush
+            res = res && tbuf->size() == 1 && tbuf->find(&key, &data) && data.days() == 32;
+
+            tbuf->flush();
+
+            tmerge->select(&key, &data);
+            res = res && data.days() == 32;
+
+            delete tbuf;
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 122 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Append fragments to data of existing records, writing the fragments only.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tappend = db->add_table("appended", month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("May");
+            data.set_season("Spring");
+            data.set_days(30);
+            data.set_ordnum(5);
+            tappend->insert(&key, &data);
+
+            // the last value of a singular field wins, when the data are parsed
+            data.set_days(31);
+            tappend->append_bytes(&key, &data);
+
+            data.Clear();
+            tappend->select(&key, &data);
+
+            bool res = data.days() == 31 && data.ordnum() == 5;
+
+            key.set_month("June");
+
+            try
+            {
+                tappend->append_bytes(&key, &data);
+                res = false;
+            }
+            catch (bdb::exception & e)
+            {
+                res = res && BDB_ERROR_NOT_FOUND == e.error();
+            }
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 123 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Roll back changes since savepoint, and release savepoints without changes.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tsave = db->add_table("savepoints", month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            data.set_season("Summer");
+            data.set_days(30);
+            data.set_ordnum(6);
+
+            db->begin_transaction();
+
+            key.set_month("June");
+            tsave->insert(&key, &data);
+
+            // empty savepoints cost nothing
+            db->set_savepoint();
+            db->set_savepoint();
+            db->release_savepoint();
+
+            key.set_month("July");
+            tsave->insert(&key, &data);
+
+            db->rollback_savepoint();
+
+            db->set_savepoint();
+            key.set_month("August");
+            tsave->insert(&key, &data);
+            db->release_savepoint();
+
+            db->commit_transaction();
+
+            key.set_month("June");
+            bool res = tsave->exists(&key);
+
+            key.set_month("July");
+            res = res && !tsave->exists(&key);
+
+            key.set_month("August");
+            res = res && tsave->exists(&key);
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 124 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Read own changes of write batch before they are written to the table.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tover = db->add_table("overlay", month_compare, true);
+
+            bdb::write_batch batch(db);
+
+            month::key  key;
+            month::data data;
+
+            data.set_season("Autumn");
+            data.set_days(30);
+            data.set_ordnum(9);
+
+            key.set_month("September");
+            batch.insert(tover, &key, &data);
+
+            data.set_days(31);
+            batch.update(tover, &key, &data);
+
+            key.set_month("October");
+            batch.insert(tover, &key, &data);
+            batch.remove(tover, &key);
+
+            // the batch sees its last changes, while the table is still empty
+            bool res = tover->count() == 0 && !batch.exists(tover, &key);
+
+            key.set_month("September");
+            data.Clear();
+            res = res && batch.find(tover, &key, &data) && data.days() == 31;
+
+            batch.commit();
+
+            res = res && tover->count() == 1 && batch.size() == 0;
+            res = res && batch.find(tover, &key, &data) && data.days() == 31;
+
+            CHECK(res);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 125 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Keep pages of hot tables cached, while scan-resistant recordsets read the others.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.cache_priority = BDB_PRIORITY_HIGH;
+
+            bdb::table * thot = db->add_table("hot", month_compare, true, options);
+            bdb::index * ihot = thot->add_index("hot_days", month::data::kDaysFieldNumber, month::days_ix::kDaysFieldNumber, days_ix_compare);
+
+            ihot->set_cache_priority(BDB_PRIORITY_VERY_HIGH);
+
+            month::key  key;
+            month::data data;
+
+            static const char * months[] = { "January", "February", "March" };
+
+            for (int i = 0; i < 3; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season("Winter");
+                data.set_days(28 + i);
+                data.set_ordnum(i + 1);
+                thot->insert(&key, &data);
+            }
+
+            unsigned int fetched = 0;
+
+            {
+                bdb::recordset rs(thot);
+                rs.set_scan_resistant();
+
+                while (rs.fetch(&key, &data)) fetched++;
+            }
+
+            CHECK(fetched == 3);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 126 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Split memory budget between the cache, Bloom filters, buffers and caches of records.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::database_options dboptions;
+
+            dboptions.in_memory     = true;
+            dboptions.auto_commit   = true;
+            dboptions.memory_budget = 64 * 1024 * 1024;
+            dboptions.mpool_percent = 75;
+
+            bdb::database * mdb = new bdb::database(DATABASE_NAME, false, dboptions);
+
+            bdb::table_options options;
+            options.cache_records = 1000;
+            options.bloom_bits    = 10;
+
+            bdb::table * tbudget = mdb->add_table("budget", month_compare, true, options);
+
+            month::key  key;
+            month::data data;
+
+            static const char * months[] = { "January", "February", "March" };
+
+            for (int i = 0; i < 3; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season("Winter");
+                data.set_days(28 + i);
+                data.set_ordnum(i + 1);
+                tbudget->insert(&key, &data);
+            }
+
+            for (int i = 0; i < 3; i++)
+            {
+                key.set_month(months[i]);
+                tbudget->select(&key, &data);
+            }
+
+            bdb::budget_stats stats;
+            mdb->stats(&stats);
+
+            bool split = (stats.budget        == 64 * 1024 * 1024) &&
+                         (stats.mpool_bytes   == 48 * 1024 * 1024) &&
+                         (stats.library_bytes == 16 * 1024 * 1024) &&
+                         (stats.filter_bytes  != 0) &&
+                         (stats.cache_limit   == stats.library_bytes - stats.filter_bytes) &&
+                         (stats.cache_bytes   != 0 && stats.cache_bytes <= stats.cache_limit);
+
+            delete mdb;
+
+            // the database without a budget has no split
+            bdb::budget_stats none;
+            db->stats(&none);
+
+            CHECK(split && none.budget == 0);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 127 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Take footprints of a table and its index on disk and in the cache.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.bloom_bits = 10;
+
+            bdb::table * tsized = db->add_table("sized", month_compare, true, options);
+            bdb::index * isized = tsized->add_index("sized_days", month::data::kDaysFieldNumber, month::days_ix::kDaysFieldNumber, days_ix_compare);
+
+            month::key  key;
+            month::data data;
+
+            static const char * months[] = { "April", "May", "June", "July", "August" };
+
+            for (int i = 0; i < 5; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season(i < 2 ? "Spring" : "Summer");
+                data.set_days(30 + i % 2);
+                data.set_ordnum(i + 4);
+                tsized->insert(&key, &data);
+            }
+
+            bdb::table_footprint tfp, ifp;
+
+            tsized->footprint(&tfp, 4);
+            isized->footprint(&ifp);
+
+            CHECK(tfp.pages != 0 && tfp.file_bytes == tfp.pages * tfp.page_size &&
+                  tfp.sampled == 4 && tfp.key_bytes != 0 && tfp.value_bytes != 0 &&
+                  tfp.cached_pages <= tfp.pages && tfp.filter_bytes != 0 &&
+                  ifp.pages != 0 && ifp.sampled == 5);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 128 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Find the most accessed keys of a table by sampled accesses.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.hot_sampling = 1;
+
+            bdb::table * tskewed = db->add_table("skewed", month_compare, true, options);
+
+            month::key  key;
+            month::data data;
+
+            static const char * months[] = { "September", "October", "November" };
+
+            for (int i = 0; i < 3; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season("Autumn");
+                data.set_days(30 + i % 2);
+                data.set_ordnum(i + 9);
+                tskewed->insert(&key, &data);
+            }
+
+            // "October" is read ten times as often as the others
+            for (int i = 0; i < 30; i++)
+            {
+                key.set_month(i % 3 == 0 ? "September" : i % 3 == 1 ? "November" : "October");
+                tskewed->select(&key, &data);
+
+                key.set_month("October");
+                for (int j = 0; j < 5; j++) tskewed->exists(&key);
+            }
+
+            vector <bdb::hot_key> hot;
+            tskewed->hot_keys(&hot, 2);
+
+            month::key top;
+            if (!hot.empty()) top.ParseFromString(hot[0].key);
+
+            CHECK(hot.size() == 2 && top.month() == "October" && hot[0].count >= 160 && hot[1].count < hot[0].count);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 129 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Build a histogram of keys of a table, and keep it while it's fresh.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tanalyzed = db->add_table("analyzed", month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            static const char * months[] = { "January", "February", "March", "April", "May", "June",
+                                             "July", "August", "September", "October", "November", "December" };
+
+            for (int i = 0; i < 12; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season("Any");
+                data.set_days(30 + i % 2);
+                data.set_ordnum(i + 1);
+                tanalyzed->insert(&key, &data);
+            }
+
+            bool built = tanalyzed->analyze(4);
+
+            bdb::key_histogram hist;
+            bool found = tanalyzed->get_histogram(&hist);
+
+            bool bounds = (hist.bounds.size() == 3);
+            for (size_t i = 0; bounds && i < hist.bounds.size(); i++) bounds = !hist.bounds[i].empty();
+
+            bool kept = !tanalyzed->analyze(4, 1.0);
+
+            CHECK(built && found && bounds && hist.modified == 0 && kept);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 130 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Estimate distinct keys of an index by its sketch, and rebuild the sketch after removals.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.distinct_sketch = true;
+
+            bdb::table * tsketched = db->add_table("sketched", month_compare, true, options);
+            bdb::index * iseasons  = tsketched->add_index("sketched_seasons", season_ix_index, season_ix_compare);
+
+            month::key  key;
+            month::data data;
+
+            static const char * months[]  = { "January", "February", "March", "April", "May", "June",
+                                              "July", "August", "September", "October", "November", "December" };
+            static const char * seasons[] = { "Winter", "Spring", "Summer", "Autumn" };
+
+            for (int i = 0; i < 12; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season(seasons[(i + 1) % 12 / 3]);
+                data.set_days(30 + i % 2);
+                data.set_ordnum(i + 1);
+                tsketched->insert(&key, &data);
+            }
+
+            uint64_t before = iseasons->estimate_distinct();
+
+            // all records of the spring are gone
+            for (int i = 2; i < 5; i++)
+            {
+                key.set_month(months[i]);
+                tsketched->remove(&key);
+            }
+
+            uint64_t stale = iseasons->estimate_distinct();
+            uint64_t after = iseasons->estimate_distinct(0.5);
+
+            CHECK(before == 4 && stale == 4 && after == 3);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 131 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Read a table and its index by pages, resuming each page by the position of the previous one.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tpaged   = db->add_table("paged", month_compare, true);
+            bdb::index * iseasons = tpaged->add_index("paged_seasons", season_ix_index, season_ix_compare);
+
+            month::key  key;
+            month::data data;
+
+            static const char * months[]  = { "January", "February", "March", "April", "May", "June",
+                                              "July", "August", "September", "October", "November", "December" };
+            static const char * seasons[] = { "Winter", "Spring", "Summer", "Autumn" };
+
+            for (int i = 0; i < 12; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season(seasons[(i + 1) % 12 / 3]);
+                data.set_days(30 + i % 2);
+                data.set_ordnum(i + 1);
+                tpaged->insert(&key, &data);
+            }
+
+            vector <string> scanned, paged, iscanned, ipaged;
+
+            {
+                bdb::recordset rs(tpaged);
+                while (rs.fetch(&key, &data)) scanned.push_back(key.month());
+            }
+
+            {
+                bdb::recordset rs(iseasons);
+                while (rs.fetch(&key, &data)) iscanned.push_back(key.month());
+            }
+
+            string token;
+
+            // pages of five records
+            for (int page = 0; page < 4; page++)
+            {
+                bdb::recordset rs(tpaged);
+                if (page != 0) rs.resume(token);
+
+                for (int i = 0; i < 5 && rs.fetch(&key, &data); i++) paged.push_back(key.month());
+
+                rs.position(&token);
+            }
+
+            token.clear();
+
+            for (int page = 0; page < 4; page++)
+            {
+                bdb::recordset rs(iseasons);
+                if (page != 0) rs.resume(token);
+
+                for (int i = 0; i < 4 && rs.fetch(&key, &data); i++) ipaged.push_back(key.month());
+
+                rs.position(&token);
+            }
+
+            CHECK(scanned.size() == 12 && paged == scanned && iscanned.size() == 12 && ipaged == iscanned);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 132 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Fetch stratified random samples of records of a table, in order of the table.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tsampled = db->add_table("sampled", month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            static const char * months[] = { "January", "February", "March", "April", "May", "June",
+                                             "July", "August", "September", "October", "November", "December" };
+
+            for (int i = 0; i < 12; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season("Any");
+                data.set_days(30 + i % 2);
+                data.set_ordnum(i + 1);
+                tsampled->insert(&key, &data);
+            }
+
+            tsampled->analyze(4);
+
+            bdb::sample_options options;
+            options.count  = 8;
+            options.strata = 4;
+            options.seed   = 12345;
+
+            vector <string> scanned;
+
+            {
+                bdb::recordset rs(tsampled);
+                while (rs.fetch(&key, &data)) scanned.push_back(key.month());
+            }
+
+            vector <size_t> ranks;
+
+            {
+                bdb::recordset rs(tsampled, options);
+
+                while (rs.fetch(&key, &data))
+                {
+                    ranks.push_back(std::find(scanned.begin(), scanned.end(), key.month()) - scanned.begin());
+                }
+            }
+
+            // samples are ordered, and both halves of the table are sampled
+            bool ordered = (ranks.size() == 8);
+            for (size_t i = 1; ordered && i < ranks.size(); i++) ordered = (ranks[i - 1] <= ranks[i] && ranks[i] < 12);
+
+            CHECK(ordered && ranks.front() < 6 && ranks.back() >= 6);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 133 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Join records of months with records of their seasons by hash join and by sort-merge join.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tjmonths  = db->add_table("joined_months",  month_compare,  true);
+            bdb::table * tjseasons = db->add_table("joined_seasons", season_compare, true);
+            bdb::index * ijseasons = tjmonths->add_index("joined_seasons_ix", season_ix_index, season_ix_compare);
+
+            month::key   mkey;
+            month::data  mdata;
+            season::key  skey;
+            season::data sdata;
+
+            static const char * months[]  = { "January", "February", "March", "April", "May", "June",
+                                              "July", "August", "September", "October", "November", "December" };
+            static const char * seasons[] = { "Winter", "Spring", "Summer", "Autumn" };
+
+            for (int i = 0; i < 12; i++)
+            {
+                mkey.set_month(months[i]);
+                mdata.set_season(seasons[(i + 1) % 12 / 3]);
+                mdata.set_days(30 + i % 2);
+                mdata.set_ordnum(i + 1);
+                tjmonths->insert(&mkey, &mdata);
+            }
+
+            // a season without months
+            skey.set_season("Any");
+            tjseasons->insert(&skey, &sdata);
+
+            for (int i = 0; i < 4; i++)
+            {
+                skey.set_season(seasons[i]);
+                tjseasons->insert(&skey, &sdata);
+            }
+
+            int hashed = 0, merged = 0;
+            bool matched = true;
+
+            {
+                bdb::recordset lrs(tjmonths);
+                bdb::recordset rrs(tjseasons);
+
+                bdb::table_join join(&lrs, season_ix_index, &rrs, NULL, BDB_JOIN_HASH);
+
+                while (join.fetch(&mkey, &mdata, &skey, NULL))
+                {
+                    matched = matched && (mdata.season() == skey.season());
+                    hashed++;
+                }
+            }
+
+            {
+                bdb::recordset lrs(ijseasons);
+                bdb::recordset rrs(tjseasons);
+
+                bdb::table_join join(&lrs, season_ix_index, &rrs, NULL, BDB_JOIN_MERGE, season_compare);
+
+                while (join.fetch(&mkey, &mdata, &skey, NULL))
+                {
+                    matched = matched && (mdata.season() == skey.season());
+                    merged++;
+                }
+            }
+
+            CHECK(matched && hashed == 12 && merged == 12);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 134 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Join records of months with seasons, and seasons with months, by index nested-loop join in batches.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tlmonths  = db->add_table("looped_months",  month_compare,  true);
+            bdb::table * tlseasons = db->add_table("looped_seasons", season_compare, true);
+            bdb::index * ilseasons = tlmonths->add_index("looped_seasons_ix", season_ix_index, season_ix_compare);
+
+            month::key   mkey;
+            month::data  mdata;
+            season::key  skey;
+            season::data sdata;
+
+            static const char * months[]  = { "January", "February", "March", "April", "May", "June",
+                                              "July", "August", "September", "October", "November", "December" };
+            static const char * seasons[] = { "Winter", "Spring", "Summer", "Autumn" };
+
+            for (int i = 0; i < 12; i++)
+            {
+                mkey.set_month(months[i]);
+                mdata.set_season(seasons[(i + 1) % 12 / 3]);
+                mdata.set_days(30 + i % 2);
+                mdata.set_ordnum(i + 1);
+                tlmonths->insert(&mkey, &mdata);
+            }
+
+            // a season without months
+            skey.set_season("Any");
+            tlseasons->insert(&skey, &sdata);
+
+            for (int i = 0; i < 4; i++)
+            {
+                skey.set_season(seasons[i]);
+                tlseasons->insert(&skey, &sdata);
+            }
+
+            int probed = 0, scanned = 0;
+            bool matched = true;
+
+            {
+                bdb::recordset rs(tlmonths);
+                bdb::table_join join(&rs, season_ix_index, tlseasons, 5);
+
+                while (join.fetch(&mkey, &mdata, &skey, NULL))
+                {
+                    matched = matched && (mdata.season() == skey.season());
+                    probed++;
+                }
+            }
+
+            // every season probes duplicates of the index
+            {
+                bdb::recordset rs(tlseasons);
+                bdb::table_join join(&rs, NULL, ilseasons, 2);
+
+                while (join.fetch(&skey, NULL, &mkey, &mdata))
+                {
+                    matched = matched && (mdata.season() == skey.season());
+                    scanned++;
+                }
+            }
+
+            CHECK(matched && probed == 12 && scanned == 12);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 135 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Fetch a page of records by limit and offset, and top records of a table by a field.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tlimited = db->add_table("limited", month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            static const char * months[] = { "January", "February", "March", "April", "May", "June",
+                                             "July", "August", "September", "October", "November", "December" };
+
+            for (int i = 0; i < 12; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season("Any");
+                data.set_days(30 + i % 2);
+                data.set_ordnum(i + 1);
+                tlimited->insert(&key, &data);
+            }
+
+            vector <string> scanned, paged;
+
+            {
+                bdb::recordset rs(tlimited);
+                while (rs.fetch(&key, &data)) scanned.push_back(key.month());
+            }
+
+            {
+                bdb::recordset rs(tlimited);
+                rs.set_limit(5, 2);
+
+                while (rs.fetch(&key, &data)) paged.push_back(key.month());
+            }
+
+            vector <int64_t> ordnums;
+
+            {
+                bdb::recordset rs(tlimited);
+                rs.set_limit(3, 1);
+                rs.set_top(month::data::kOrdnumFieldNumber, BDB_FIELD_INT64, true);
+
+                while (rs.fetch(&key, &data)) ordnums.push_back(data.ordnum());
+            }
+
+            CHECK(paged.size() == 5 && paged[0] == scanned[2] && paged[4] == scanned[6] &&
+                  ordnums.size() == 3 && ordnums[0] == 11 && ordnums[1] == 10 && ordnums[2] == 9);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 136 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Profile a filtered scan of a table: records examined and returned, cursor calls and unserialized bytes.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tprofiled = db->add_table("profiled", month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            static const char * months[] = { "January", "February", "March", "April", "May", "June",
+                                             "July", "August", "September", "October", "November", "December" };
+
+            for (int i = 0; i < 12; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season("Any");
+                data.set_days(30 + i % 2);
+                data.set_ordnum(i + 1);
+                tprofiled->insert(&key, &data);
+            }
+
+            month::data value;
+            value.set_season("Any");
+            value.set_days(31);
+            value.set_ordnum(0);
+
+            bdb::recordset rs(tprofiled);
+
+            rs.add_filter(month::data::kDaysFieldNumber, BDB_FIELD_INT32, BDB_FILTER_EQ, &value);
+            rs.set_profiling();
+
+            int fetched = 0;
+            while (rs.fetch(&key, &data)) fetched++;
+
+            bdb::recordset_profile profile;
+            rs.profile(&profile);
+
+            CHECK(fetched == 6 && profile.examined == 12 && profile.returned == 6 &&
+                  profile.cursor_calls >= 12 && profile.bytes_unserialized > 0 && profile.join_order.empty());
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 137 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Aggregate fields of a table by its column store, maintained on inserts, updates and removals.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tcolumnar = db->add_table("columnar", month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            static const char * months[] = { "January", "February", "March", "April", "May", "June",
+                                             "July", "August", "September", "October", "November", "December" };
+
+            // June is inserted after the store is built
+            for (int i = 0; i < 12; i++)
+            {
+                if (i == 5) continue;
+
+                key.set_month(months[i]);
+                data.set_season("Any");
+                data.set_days(30 + i % 2);
+                data.set_ordnum(i + 1);
+                tcolumnar->insert(&key, &data);
+            }
+
+            static const int fields[] = { month::data::kDaysFieldNumber, month::data::kOrdnumFieldNumber };
+            static const int types[]  = { BDB_FIELD_INT32, BDB_FIELD_INT64 };
+
+            bdb::column_store * columns = tcolumnar->add_columns("columnar_days", fields, types, 2, 4);
+
+            // the chunk of May splits
+            key.set_month("June");
+            data.set_days(31);
+            data.set_ordnum(6);
+            tcolumnar->insert(&key, &data);
+
+            key.set_month("March");
+            tcolumnar->remove(&key);
+
+            key.set_month("June");
+            data.set_ordnum(100);
+            tcolumnar->update(&key, &data);
+
+            bdb::aggregate_value all  = columns->aggregate(month::data::kDaysFieldNumber);
+            bdb::aggregate_value half = columns->aggregate(month::data::kDaysFieldNumber, month::data::kOrdnumFieldNumber, 1, 6);
+
+            CHECK(all.count == 11 && all.values == 11 && all.sum == 336 && all.min == 30 && all.max == 31 &&
+                  half.count == 4 && half.sum == 122);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 138 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Dump a table into a stream, and restore it by a builder of another table.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tdumped = db->add_table("dumped", month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            static const char * months[] = { "January", "February", "March", "April", "May", "June",
+                                             "July", "August", "September", "October", "November", "December" };
+            static const char * seasons[] = { "Winter", "Spring", "Summer", "Autumn" };
+
+            for (int i = 0; i < 12; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season(seasons[(i + 1) % 12 / 3]);
+                data.set_days(30 + i % 2);
+                data.set_ordnum(i + 1);
+                tdumped->insert(&key, &data);
+            }
+
+            std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+
+            uint64_t dumped = bdb::dump(tdumped, stream, true);
+            uint64_t restored = 0;
+
+            {
+                bdb::table_builder builder(db, "restored", month_compare);
+
+                restored = bdb::restore(&builder, stream);
+                builder.commit();
+            }
+
+            bdb::table * trestored = db->add_table("restored", month_compare);
+
+            key.set_month("July");
+            trestored->select(&key, &data);
+
+            CHECK(dumped == 12 && restored == 12 && trestored->count() == 12 && data.ordnum() == 7 && data.season() == seasons[2]);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 139 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Export a table into columnar files by parallel scan.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * texported = db->add_table("exported", month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            static const char * months[] = { "January", "February", "March", "April", "May", "June",
+                                             "July", "August", "September", "October", "November", "December" };
+            static const char * seasons[] = { "Winter", "Spring", "Summer", "Autumn" };
+
+            for (int i = 0; i < 12; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season(seasons[(i + 1) % 12 / 3]);
+                data.set_days(30 + i % 2);
+                data.set_ordnum(i + 1);
+                texported->insert(&key, &data);
+            }
+
+            // a single range is written into the only file by groups of five rows
+            uint64_t exported = bdb::export_columns(texported, month::data::descriptor(), DATABASE_NAME "/exported", 1, 5);
+
+            std::ifstream file(DATABASE_NAME "/exported.0.cols", std::ios::in | std::ios::binary);
+
+            char magic[8] = { 0 };
+            file.read(magic, sizeof(magic));
+
+            CHECK(exported == 12 && file.good() && memcmp(magic, "BDBCOLS1", sizeof(magic)) == 0);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 140 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Upgrade data of older version of schema on read, and migrate them.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            month::key  key;
+            month::data data;
+
+            static const char * months[] = { "January", "February", "March", "April", "May", "June",
+                                             "July", "August", "September", "October", "November", "December" };
+            static const char * seasons[] = { "Winter", "Spring", "Summer", "Autumn" };
+
+            // the builder writes untagged data of version "0"
+            {
+                bdb::table_builder builder(db, "schemed", month_compare);
+
+                for (int i = 0; i < 12; i++)
+                {
+                    key.set_month(months[i]);
+                    data.set_season(seasons[(i + 1) % 12 / 3]);
+                    data.set_days(30 + i % 2);
+                    data.set_ordnum(i);
+                    builder.add(&key, &data);
+                }
+
+                builder.commit();
+            }
+
+            bdb::table_options options;
+            options.schema_version = 1;
+
+            bdb::table * tschemed = db->add_table("schemed", month_compare, false, options);
+            tschemed->add_upgrade(0, upgrade_ordnum);
+
+            key.set_month("July");
+            tschemed->select(&key, &data);
+
+            bool upgraded = (data.ordnum() == 7);
+
+            // updated record is of current version already
+            key.set_month("May");
+            data.set_ordnum(5);
+            tschemed->update(&key, &data);
+
+            uint64_t migrated = tschemed->migrate(5);
+
+            key.set_month("December");
+            tschemed->select(&key, &data);
+
+            CHECK(upgraded && migrated == 11 && tschemed->migrate() == 0 && data.ordnum() == 12);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 141 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Typed table with fixed-layout records.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::typed_table <int64_t, bdb::pod_record <point> > points(db, "points", true);
+
+            for (int i = 0; i < 10; i++)
+            {
+                point p = { i * 1000, i * 0.5 };
+
+                bdb::pod_record <point> record(p);
+                points.insert(p.time, &record);
+            }
+
+            bdb::pod_record <point> record;
+            double sum = 0;
+
+            {
+                bdb::recordset rs(points.get());
+                int64_t time;
+
+                while (points.fetch(&rs, &time, &record)) sum += record.value().value;
+            }
+
+            points.select(3000, &record);
+
+            CHECK(record.value().time == 3000 && record.value().value == 1.5 && sum == 22.5);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 142 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Time series by compressed blocks with buffered points.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::series_table series(db, "series", true, 100);
+
+            // two series of a point per ten seconds, in five blocks each
+            for (int i = 0; i < 50; i++)
+            {
+                series.add(1, i * 10, 20.0 + i % 4 * 0.5);
+                series.add(2, i * 10, i);
+            }
+
+            series.flush();
+
+            // buffered points replace stored ones, and are read before the next flush
+            series.add(2, 120, -1.0);
+            series.add(2, 125, -2.0);
+
+            vector <bdb::series_point> points;
+
+            uint64_t count = series.range(2, 100, 199, &points);
+
+            bool buffered = (count == 11 && points[2].time == 120 && points[2].value == -1.0 && points[3].time == 125);
+
+            series.flush();
+            series.range(1, 95, 305, &points);
+
+            double sum = 0;
+            for (size_t i = 0; i < points.size(); i++) sum += points[i].value;
+
+            CHECK(buffered && series.size() == 0 && series.get()->count() == 10 && points.size() == 21 && points[0].time == 100 && sum == 21 * 20.0 + 16.0);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 143 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Decomposition of bounding box into ranges of Z-order keys.");
+
+        bdb::geo_box box = { 55.5, 37.3, 56.0, 38.0 };
+
+        vector <pair <uint64_t, uint64_t> > ranges;
+        bdb::geo_ranges(box, 32, &ranges);
+
+        // locations in the box are in some range and in the cells of the box, outer ones are not in the cells
+        const double inner[][2] = { { 55.75, 37.62 }, { 55.5, 37.3 }, { 56.0, 38.0 }, { 55.99, 37.31 } };
+        const double outer[][2] = { { 59.94, 30.31 }, { 55.75, 38.5 }, { 55.4, 37.62 }, { -55.75, -37.62 } };
+
+        bool found = (!ranges.empty() && ranges.size() <= 32);
+
+        for (int i = 0; i < 4; i++)
+        {
+            uint64_t key = bdb::geo_key(inner[i][0], inner[i][1]);
+
+            bool covered = false;
+            for (size_t j = 0; j < ranges.size(); j++) covered = covered || (key >= ranges[j].first && key <= ranges[j].second);
+
+            found = found && covered && bdb::geo_contains(box, key) && !bdb::geo_contains(box, bdb::geo_key(outer[i][0], outer[i][1]));
+        }
+
+        for (size_t j = 1; j < ranges.size(); j++) found = found && (ranges[j - 1].second < ranges[j].first);
+
+        CHECK(found);
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 144 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Encryption of stored values by a cipher.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::value_cipher cipher = { 1, xor_encrypt, xor_decrypt };
+            bdb::set_cipher(&cipher);
+
+            bdb::table * tsealed = db->add_table("sealed", month::key_month_compare, true);
+            bdb::index * isealed = tsealed->add_index("sealed_days", month::data_days_index, month::days_ix_days_compare);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("February");
+            data.set_season("Winter");
+            data.set_days(28);
+            data.set_ordnum(2);
+
+            tsealed->insert(&key, &data);
+
+            data.Clear();
+            tsealed->select(&key, &data);
+
+            month::days_ix days;
+            days.set_days(28);
+
+            bool found = (encrypted != 0 && data.season() == "Winter" && data.ordnum() == 2 && isealed->exists(&days));
+
+            // filters and projections read decrypted values as well
+            bdb::recordset rs(tsealed);
+            rs.add_filter(month::data::kDaysFieldNumber, BDB_FIELD_INT32, BDB_FILTER_EQ, &data);
+
+            CHECK(found && rs.fetch(&key, &data) && key.month() == "February");
+
+            bdb::set_cipher(NULL);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        bdb::set_cipher(NULL);
+        CHECK(false);
+    }
+
+    // 145 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Parallel verification of the database.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tverified = db->add_table("verified", month::key_month_compare, true);
+            tverified->add_index("verified_days", month::data_days_index, month::days_ix_days_compare);
+
+            month::key  key;
+            month::data data;
+
+            const char * months[] = { "March", "April", "May" };
+
+            for (int i = 0; i < 3; i++)
+            {
+                key.set_month(months[i]);
+                data.set_season("Spring");
+                data.set_days(30 + (i + 1) % 2);
+                data.set_ordnum(i + 3);
+
+                tverified->insert(&key, &data);
+            }
+
+            vector <bdb::verify_issue> issues;
+            uint64_t count = db->verify(2, &issues);
+
+            // issues of other tables are not expected, but the new ones must be consistent anyway
+            bool consistent = (count >= issues.size());
+
+            for (size_t i = 0; i < issues.size(); i++)
+            {
+                consistent = consistent && issues[i].file != "verified.db" && issues[i].file != "verified_days.ix";
+            }
+
+            CHECK(consistent);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 146 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Opening of several tables at once, and lookup of tables by names.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            const char * names[]   = { "opened1", "opened2", "opened3" };
+            const char * indexes[] = { "opened1_days", "opened2_days", "opened3_days" };
+
+            vector <bdb::table_spec> specs(3);
+
+            for (int i = 0; i < 3; i++)
+            {
+                bdb::index_spec idx = { indexes[i], month::data_days_index, month::days_ix_days_compare, false, false };
+
+                specs[i].name   = names[i];
+                specs[i].fn_cmp = month::key_month_compare;
+                specs[i].create = true;
+                specs[i].indexes.push_back(idx);
+            }
+
+            vector <bdb::table *> tables;
+            db->add_tables(specs, &tables, 2);
+
+            bool found = (tables.size() == 3);
+
+            for (int i = 0; found && i < 3; i++)
+            {
+                found = (tables[i] != NULL && db->get_table(names[i]) == tables[i]);
+            }
+
+            CHECK(found && db->get_table("absent") == NULL);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 147 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Fast shutdown of the database.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            delete db;
+            db = NULL;
+
+            bdb::database_options dboptions;
+            dboptions.auto_commit   = true;
+            dboptions.fast_shutdown = true;
+
+            db = new bdb::database(DATABASE_NAME, false, dboptions);
+
+            bdb::table * tclosed = db->add_table("closed", month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("July");
+            data.set_season("Summer");
+            data.set_days(31);
+            data.set_ordnum(7);
+
+            tclosed->insert(&key, &data);
+
+            // the record survives closing without flushes of separate handles
+            delete db;
+            db = NULL;
+
+            dboptions.fast_shutdown = false;
+            dboptions.multi_process = true;
+
+            db = new bdb::database(DATABASE_NAME, false, dboptions);
+
+            seq = db->add_sequence("month");
+
+            tseason = db->add_table("season", season_compare);
+            tmonth  = db->add_table("month",  month_compare );
+
+            iseason = tmonth->add_index("season", season_ix_index, season_ix_compare);
+            idays   = tmonth->add_index("days",   days_ix_index,   days_ix_compare);
+            iordnum = tmonth->add_index("ordnum", ordnum_ix_index, ordnum_ix_compare, true);
+
+            tclosed = db->add_table("closed", month_compare);
+
+            data.Clear();
+            tclosed->select(&key, &data);
+
+            CHECK(data.days() == 31);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 148 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Background writing of dirty pages.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            delete db;
+            db = NULL;
+
+            bdb::database_options dboptions;
+            dboptions.auto_commit     = true;
+            dboptions.multi_process   = true;
+            dboptions.trickle_percent = 50;
+
+            db = new bdb::database(DATABASE_NAME, false, dboptions);
+
+            seq = db->add_sequence("month");
+
+            tseason = db->add_table("season", season_compare);
+            tmonth  = db->add_table("month",  month_compare );
+
+            iseason = tmonth->add_index("season", season_ix_index, season_ix_compare);
+            idays   = tmonth->add_index("days",   days_ix_index,   days_ix_compare);
+            iordnum = tmonth->add_index("ordnum", ordnum_ix_index, ordnum_ix_compare, true);
+
+            bdb::table * ttrickled = db->add_table("trickled", month_compare, true);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("August");
+            data.set_season("Summer");
+            data.set_days(31);
+            data.set_ordnum(8);
+
+            ttrickled->insert(&key, &data);
+
+            data.Clear();
+            ttrickled->select(&key, &data);
+
+            CHECK(data.days() == 31);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 149 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Insert records into heap table by generated ids, and find them by index.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.access_method = BDB_ACCESS_HEAP;
+
+            bdb::table * theap = db->add_table("heap", NULL, true, options);
+            bdb::index * iheap = theap->add_index("heap_days", month::data_days_index, month::days_ix_days_compare);
+
+            month::ordnum_ix id;
+            month::data      data;
+            month::days_ix   days;
+
+            data.set_season("Autumn");
+            data.set_days(30);
+            data.set_ordnum(9);
+
+            uint64_t september = theap->insert(&data);
+
+            data.set_days(31);
+            data.set_ordnum(10);
+
+            uint64_t october = theap->insert(&data);
+
+            id.set_ordnum((int) september);
+
+            data.Clear();
+            theap->select(&id, &data);
+
+            days.set_days(31);
+
+            CHECK(september != october && data.ordnum() == 9 && iheap->exists(&days) && theap->count() == 2);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 150 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Store large data in external files, and read them by stream.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.blob_threshold = 1024;
+
+            bdb::table * tblob = db->add_table("blob", month_compare, true, options);
+
+            month::key  key;
+            month::data data;
+
+            key.set_month("November");
+            data.set_season(string(64 * 1024, 'A'));
+            data.set_days(30);
+            data.set_ordnum(11);
+
+            tblob->insert(&key, &data);
+
+            data.Clear();
+            tblob->select_stream(&key, &data, NULL, 4096);
+
+            CHECK(data.season().size() == 64 * 1024 && data.days() == 30);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 151 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Insert records with generated keys.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table_options options;
+            options.key_format = BDB_KEY_ORDERED;
+
+            bdb::table * tauto = db->add_table("auto", NULL, true, options);
+
+            options.access_method = BDB_ACCESS_RECNO;
+
+            bdb::table * tappended = db->add_table("appended", NULL, true, options);
+
+            month::ordnum_ix key1, key2, key3;
+            month::data      data;
+
+            data.set_season("Winter");
+            data.set_days(31);
+            data.set_ordnum(12);
+
+            uint64_t id1 = tauto->insert_auto(seq, &data, &key1);
+            uint64_t id2 = tauto->insert_auto(seq, &data, &key2);
+            uint64_t id3 = tappended->insert_auto(NULL, &data, &key3);
+
+            data.Clear();
+            tauto->select(&key2, &data);
+
+            bool sequenced = (id2 > id1 && (uint64_t) key2.ordnum() == id2 && data.ordnum() == 12);
+
+            data.Clear();
+            tappended->select(&key3, &data);
+
+            CHECK(sequenced && id3 == 1 && data.days() == 31);
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
+
+    // 152 //---------------------------------------------------------------------------------------
+    try
+    {
+        TEST("Inspect string fields of records without copying them.");
+
+        if (db == NULL) BLOCK();
+        else
+        {
+            bdb::table * tblob = db->add_table("blob", month_compare);
+
+            month::key       key;
+            bdb::record_view view;
+            bdb::string_ref  season;
+
+            rs = new bdb::recordset(tblob);
+
+            bool fetched = rs->fetch_view(&key, &view) && view.get(month::data::kSeasonFieldNumber, &season);
+            bool aliased = fetched && season.size() == 64 * 1024 && season.starts_with("AAAA") && season.find("B") == string::npos;
+
+            // integer field has no string value
+            aliased = aliased && !view.get(month::data::kDaysFieldNumber, &season);
+
+            delete rs;
+
+            CHECK(aliased && key.month() == "November");
+        }
+    }
+    catch (bdb::exception &)
+    {
+        CHECK(false);
+    }
     //----------------------------------------------------------------------------------------------
 
     if (db != NULL) delete db;
 
-    #define PLANNED 32
+    #define PLANNED 152
 
     cout << "PLANNED:  " << PLANNED << "\n";
     cout << "EXECUTED: " << (passed + failed + blocked) << "\n";
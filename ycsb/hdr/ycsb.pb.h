@@ -0,0 +1,342 @@
+// Generated by the protocol buffer compiler.  DO NOT EDIT!
+// source: ycsb.proto
+
+#ifndef PROTOBUF_ycsb_2eproto__INCLUDED
+#define PROTOBUF_ycsb_2eproto__INCLUDED
+
+#include <string>
+
+#include <google/protobuf/stubs/common.h>
+
+#if GOOGLE_PROTOBUF_VERSION < 2004000
+#error This file was generated by a newer version of protoc which is
+#error incompatible with your Protocol Buffer headers.  Please update
+#error your headers.
+#endif
+#if 2004001 < GOOGLE_PROTOBUF_MIN_PROTOC_VERSION
+#error This file was generated by an older version of protoc which is
+#error incompatible with your Protocol Buffer headers.  Please
+#error regenerate this file with a newer version of protoc.
+#endif
+
+#include <google/protobuf/generated_message_util.h>
+#include <google/protobuf/repeated_field.h>
+#include <google/protobuf/extension_set.h>
+#include <google/protobuf/generated_message_reflection.h>
+// @@protoc_insertion_point(includes)
+
+namespace ycsb {
+
+// Internal implementation detail -- do not call these.
+void  protobuf_AddDesc_ycsb_2eproto();
+void protobuf_AssignDesc_ycsb_2eproto();
+void protobuf_ShutdownFile_ycsb_2eproto();
+
+class key;
+class data;
+
+// ===================================================================
+
+class key : public ::google::protobuf::Message {
+ public:
+  key();
+  virtual ~key();
+  
+  key(const key& from);
+  
+  inline key& operator=(const key& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+  
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+  
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const key& default_instance();
+  
+  void Swap(key* other);
+  
+  // implements Message ----------------------------------------------
+  
+  key* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const key& from);
+  void MergeFrom(const key& from);
+  void Clear();
+  bool IsInitialized() const;
+  
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+  
+  ::google::protobuf::Metadata GetMetadata() const;
+  
+  // nested types ----------------------------------------------------
+  
+  // accessors -------------------------------------------------------
+  
+  // required string id = 1;
+  inline bool has_id() const;
+  inline void clear_id();
+  static const int kIdFieldNumber = 1;
+  inline const ::std::string& id() const;
+  inline void set_id(const ::std::string& value);
+  inline void set_id(const char* value);
+  inline void set_id(const char* value, size_t size);
+  inline ::std::string* mutable_id();
+  inline ::std::string* release_id();
+  
+  // @@protoc_insertion_point(class_scope:ycsb.key)
+ private:
+  inline void set_has_id();
+  inline void clear_has_id();
+  
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+  
+  ::std::string* id_;
+  
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(1 + 31) / 32];
+  
+  friend void  protobuf_AddDesc_ycsb_2eproto();
+  friend void protobuf_AssignDesc_ycsb_2eproto();
+  friend void protobuf_ShutdownFile_ycsb_2eproto();
+  
+  void InitAsDefaultInstance();
+  static key* default_instance_;
+};
+// -------------------------------------------------------------------
+
+class data : public ::google::protobuf::Message {
+ public:
+  data();
+  virtual ~data();
+  
+  data(const data& from);
+  
+  inline data& operator=(const data& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+  
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+  
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const data& default_instance();
+  
+  void Swap(data* other);
+  
+  // implements Message ----------------------------------------------
+  
+  data* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const data& from);
+  void MergeFrom(const data& from);
+  void Clear();
+  bool IsInitialized() const;
+  
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+  
+  ::google::protobuf::Metadata GetMetadata() const;
+  
+  // nested types ----------------------------------------------------
+  
+  // accessors -------------------------------------------------------
+  
+  // repeated bytes fields = 1;
+  inline int fields_size() const;
+  inline void clear_fields();
+  static const int kFieldsFieldNumber = 1;
+  inline const ::std::string& fields(int index) const;
+  inline ::std::string* mutable_fields(int index);
+  inline void set_fields(int index, const ::std::string& value);
+  inline void set_fields(int index, const char* value);
+  inline void set_fields(int index, const void* value, size_t size);
+  inline ::std::string* add_fields();
+  inline void add_fields(const ::std::string& value);
+  inline void add_fields(const char* value);
+  inline void add_fields(const void* value, size_t size);
+  inline const ::google::protobuf::RepeatedPtrField< ::std::string>& fields() const;
+  inline ::google::protobuf::RepeatedPtrField< ::std::string>* mutable_fields();
+  
+  // @@protoc_insertion_point(class_scope:ycsb.data)
+ private:
+  
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+  
+  ::google::protobuf::RepeatedPtrField< ::std::string> fields_;
+  
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(1 + 31) / 32];
+  
+  friend void  protobuf_AddDesc_ycsb_2eproto();
+  friend void protobuf_AssignDesc_ycsb_2eproto();
+  friend void protobuf_ShutdownFile_ycsb_2eproto();
+  
+  void InitAsDefaultInstance();
+  static data* default_instance_;
+};
+// ===================================================================
+
+
+// ===================================================================
+
+// key
+
+// required string id = 1;
+inline bool key::has_id() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void key::set_has_id() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void key::clear_has_id() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void key::clear_id() {
+  if (id_ != &::google::protobuf::internal::kEmptyString) {
+    id_->clear();
+  }
+  clear_has_id();
+}
+inline const ::std::string& key::id() const {
+  return *id_;
+}
+inline void key::set_id(const ::std::string& value) {
+  set_has_id();
+  if (id_ == &::google::protobuf::internal::kEmptyString) {
+    id_ = new ::std::string;
+  }
+  id_->assign(value);
+}
+inline void key::set_id(const char* value) {
+  set_has_id();
+  if (id_ == &::google::protobuf::internal::kEmptyString) {
+    id_ = new ::std::string;
+  }
+  id_->assign(value);
+}
+inline void key::set_id(const char* value, size_t size) {
+  set_has_id();
+  if (id_ == &::google::protobuf::internal::kEmptyString) {
+    id_ = new ::std::string;
+  }
+  id_->assign(reinterpret_cast<const char*>(value), size);
+}
+inline ::std::string* key::mutable_id() {
+  set_has_id();
+  if (id_ == &::google::protobuf::internal::kEmptyString) {
+    id_ = new ::std::string;
+  }
+  return id_;
+}
+inline ::std::string* key::release_id() {
+  clear_has_id();
+  if (id_ == &::google::protobuf::internal::kEmptyString) {
+    return NULL;
+  } else {
+    ::std::string* temp = id_;
+    id_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+    return temp;
+  }
+}
+
+// -------------------------------------------------------------------
+
+// data
+
+// repeated bytes fields = 1;
+inline int data::fields_size() const {
+  return fields_.size();
+}
+inline void data::clear_fields() {
+  fields_.Clear();
+}
+inline const ::std::string& data::fields(int index) const {
+  return fields_.Get(index);
+}
+inline ::std::string* data::mutable_fields(int index) {
+  return fields_.Mutable(index);
+}
+inline void data::set_fields(int index, const ::std::string& value) {
+  fields_.Mutable(index)->assign(value);
+}
+inline void data::set_fields(int index, const char* value) {
+  fields_.Mutable(index)->assign(value);
+}
+inline void data::set_fields(int index, const void* value, size_t size) {
+  fields_.Mutable(index)->assign(
+    reinterpret_cast<const char*>(value), size);
+}
+inline ::std::string* data::add_fields() {
+  return fields_.Add();
+}
+inline void data::add_fields(const ::std::string& value) {
+  fields_.Add()->assign(value);
+}
+inline void data::add_fields(const char* value) {
+  fields_.Add()->assign(value);
+}
+inline void data::add_fields(const void* value, size_t size) {
+  fields_.Add()->assign(reinterpret_cast<const char*>(value), size);
+}
+inline const ::google::protobuf::RepeatedPtrField< ::std::string>&
+data::fields() const {
+  return fields_;
+}
+inline ::google::protobuf::RepeatedPtrField< ::std::string>*
+data::mutable_fields() {
+  return &fields_;
+}
+
+
+// @@protoc_insertion_point(namespace_scope)
+
+}  // namespace ycsb
+
+#ifndef SWIG
+namespace google {
+namespace protobuf {
+
+
+}  // namespace google
+}  // namespace protobuf
+#endif  // SWIG
+
+// @@protoc_insertion_point(global_scope)
+
+#endif  // PROTOBUF_ycsb_2eproto__INCLUDED
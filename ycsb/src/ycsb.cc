@@ -0,0 +1,1001 @@
+//--------------------------------------------------------------------------------------------------
+//
+//  BDB Library
+//  Copyright (C) 2009  Artem Rodygin
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//--------------------------------------------------------------------------------------------------
+//  Author                  Date            Description of modifications
+//--------------------------------------------------------------------------------------------------
+//  Artem Rodygin           2026-10-14      Initial creation.
+//--------------------------------------------------------------------------------------------------
+
+#include <bdb.h>
+
+// Standard C/C++ Libraries
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+
+#ifdef WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Boost C++ Libraries
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+// C++ Logging Library
+#include <log4cplus/logger.h>
+#include <log4cplus/configurator.h>
+
+// Namespaces in use.
+using namespace std;
+
+// Data schema.
+#include <ycsb.pb.h>
+
+//--------------------------------------------------------------------------------------------------
+//  Definitions.
+//--------------------------------------------------------------------------------------------------
+
+// Operations of YCSB core workload.
+#define OP_INSERT       0
+#define OP_READ         1
+#define OP_UPDATE       2
+#define OP_SCAN         3
+#define OP_RMW          4
+#define OP_COUNT        5
+
+// Return codes of operations.
+#define RET_OK          0
+#define RET_NOT_FOUND   1
+#define RET_ERROR       2
+#define RET_COUNT       3
+
+// Request distributions.
+#define DIST_UNIFORM    0
+#define DIST_ZIPFIAN    1
+#define DIST_LATEST     2
+
+// Phases of benchmark.
+#define PHASE_LOAD      0
+#define PHASE_RUN       1
+#define PHASE_ALL       2
+
+// Skew of zipfian distribution.
+#define ZIPF_THETA      0.99
+
+// Number of items of scrambled zipfian distribution, and its zeta (the same constants as YCSB uses).
+#define SCRAMBLED_ITEMS 10000000000LL
+#define SCRAMBLED_ZETAN 26.46902820178302
+
+// Maximum number of retries of deadlocked transaction.
+#define MAX_RETRIES     10
+
+// Names of operations (as YCSB reports them).
+static const char * op_names[OP_COUNT] = { "INSERT", "READ", "UPDATE", "SCAN", "READ-MODIFY-WRITE" };
+
+// Names of properties of proportions of operations.
+static const char * op_properties[OP_COUNT] =
+{
+    "insertproportion", "readproportion", "updateproportion", "scanproportion", "readmodifywriteproportion"
+};
+
+// Names of return codes (as YCSB reports them).
+static const char * ret_names[RET_COUNT] = { "OK", "NOT_FOUND", "ERROR" };
+
+// Names of distributions.
+static const char * dist_names[] = { "uniform", "zipfian", "latest" };
+
+// Names of phases.
+static const char * phase_names[] = { "load", "run", "all" };
+
+// Names of durability policies (indexed by policy codes).
+static const char * durability_names[] = { "default", "sync", "write_nosync", "nosync", "group" };
+
+// Default properties (the same as of YCSB core workload, where they match).
+static const char * default_properties =
+    "recordcount=1000,operationcount=1000,threadcount=1,fieldcount=10,fieldlength=100,writeallfields=false,"
+    "readproportion=0.95,updateproportion=0.05,insertproportion=0,scanproportion=0,readmodifywriteproportion=0,"
+    "requestdistribution=uniform,maxscanlength=1000,scanlengthdistribution=uniform,insertorder=hashed,"
+    "durability=nosync";
+
+// Properties of core workloads A-F.
+static const char * core_workloads[] =
+{
+    // A - update heavy
+    "readproportion=0.5,updateproportion=0.5,scanproportion=0,insertproportion=0,readmodifywriteproportion=0,"
+    "requestdistribution=zipfian",
+
+    // B - read mostly
+    "readproportion=0.95,updateproportion=0.05,scanproportion=0,insertproportion=0,readmodifywriteproportion=0,"
+    "requestdistribution=zipfian",
+
+    // C - read only
+    "readproportion=1,updateproportion=0,scanproportion=0,insertproportion=0,readmodifywriteproportion=0,"
+    "requestdistribution=zipfian",
+
+    // D - read latest
+    "readproportion=0.95,updateproportion=0,scanproportion=0,insertproportion=0.05,readmodifywriteproportion=0,"
+    "requestdistribution=latest",
+
+    // E - short ranges
+    "readproportion=0,updateproportion=0,scanproportion=0.95,insertproportion=0.05,readmodifywriteproportion=0,"
+    "requestdistribution=zipfian,maxscanlength=100,scanlengthdistribution=uniform",
+
+    // F - read-modify-write
+    "readproportion=0.5,updateproportion=0,scanproportion=0,insertproportion=0,readmodifywriteproportion=0.5,"
+    "requestdistribution=zipfian"
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Settings.
+//--------------------------------------------------------------------------------------------------
+
+// Properties of workload by their names.
+typedef map <string, string> properties;
+
+// Benchmark settings.
+struct settings
+{
+    string      home;       // Directory of benchmark database.
+    int         phase;      // Phase to run.
+    properties  props;      // Properties of workload.
+};
+
+// Parameters of workload, parsed from its properties.
+struct workload
+{
+    int64_t records;                // Number of records, loaded by load phase.
+    int64_t operations;             // Number of operations of run phase.
+    int     threads;                // Number of client threads.
+    int     fields;                 // Number of fields of a record.
+    int     length;                 // Size of a field, in bytes.
+    bool    writeall;               // Whether updates write all fields (otherwise one field is modified).
+    double  proportions[OP_COUNT];  // Proportions of operations.
+    int     dist;                   // Distribution of requested keys.
+    int     maxscan;                // Maximum number of records of a scan.
+    int     scandist;               // Distribution of lengths of scans ("uniform" or "zipfian").
+    bool    hashed;                 // Whether keys are hashed (otherwise they are inserted in order).
+    int     durability;             // Durability policy of transactions.
+};
+
+// Splits list, separated by specified character.
+static vector <string> split (const string & list, char separator)
+{
+    vector <string> items;
+    stringstream    ss(list);
+    string          item;
+
+    while (getline(ss, item, separator))
+    {
+        if (!item.empty()) items.push_back(item);
+    }
+
+    return items;
+}
+
+// Removes leading and trailing whitespaces.
+static string trim (const string & str)
+{
+    size_t first = str.find_first_not_of(" \t\r\n");
+    size_t last  = str.find_last_not_of(" \t\r\n");
+
+    return (first == string::npos ? string() : str.substr(first, last - first + 1));
+}
+
+// Sets property "NAME=VALUE", returns "false" if the property is unknown (and can't be defined).
+static bool set_property (const string & pair, properties * props, bool define = false)
+{
+    size_t pos = pair.find('=');
+    if (pos == string::npos) return false;
+
+    string name = trim(pair.substr(0, pos));
+
+    if (!define && props->find(name) == props->end()) return false;
+
+    (*props)[name] = trim(pair.substr(pos + 1));
+    return true;
+}
+
+// Sets comma-separated list of properties.
+static bool set_properties (const string & list, properties * props, bool define = false)
+{
+    vector <string> items = split(list, ',');
+
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        if (!set_property(items[i], props, define)) return false;
+    }
+
+    return true;
+}
+
+// Sets properties from file of YCSB format (lines "NAME=VALUE", "#" starts a comment).
+static bool load_properties (const string & path, properties * props)
+{
+    ifstream file(path.c_str());
+    if (!file) return false;
+
+    string line;
+
+    while (getline(file, line))
+    {
+        line = trim(line.substr(0, line.find('#')));
+
+        if (!line.empty() && !set_property(line, props)) return false;
+    }
+
+    return true;
+}
+
+// Finds specified name in the list of names, returns its index, or "-1".
+static int find_name (const string & name, const char ** names, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (name == names[i]) return i;
+    }
+
+    return -1;
+}
+
+// Prints usage.
+static void usage ()
+{
+    cerr << "Usage: ycsb [options]\n"
+         << "\n"
+         << "  --home=DIR               directory of benchmark database (\"ycsbdb\")\n"
+         << "  --phase=P                phase: load, run, all (all)\n"
+         << "  --workload=W             core workload: a, b, c, d, e, f\n"
+         << "  --properties=FILE        file of workload properties in YCSB format\n"
+         << "  --NAME=VALUE             workload property, e.g. --recordcount=100000\n"
+         << "\n"
+         << "Workload properties (defaults are of YCSB core workload):\n"
+         << "\n"
+         << "  recordcount, operationcount, threadcount, fieldcount, fieldlength, writeallfields,\n"
+         << "  readproportion, updateproportion, insertproportion, scanproportion, readmodifywriteproportion,\n"
+         << "  requestdistribution (uniform, zipfian, latest), maxscanlength, scanlengthdistribution\n"
+         << "  (uniform, zipfian), insertorder (hashed, ordered), durability (sync, write_nosync, nosync, group)\n"
+         << "\n"
+         << "Options are applied in order, so properties override ones of preceding workload or file.\n"
+         << "Load phase inserts records into table \"usertable\", run phase runs operations against them,\n"
+         << "and each phase reports its metrics in YCSB format.\n";
+}
+
+// Parses command line.
+static bool parse_settings (int argc, char ** argv, settings * s)
+{
+    s->home  = "ycsbdb";
+    s->phase = PHASE_ALL;
+
+    set_properties(default_properties, &s->props, true);
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        size_t pos = arg.find('=');
+
+        if (arg.compare(0, 2, "--") != 0 || pos == string::npos)
+        {
+            return false;
+        }
+
+        string name  = arg.substr(2, pos - 2);
+        string value = arg.substr(pos + 1);
+
+        bool res = true;
+
+        if (name == "home")
+        {
+            s->home = value;
+        }
+        else if (name == "phase")
+        {
+            s->phase = find_name(value, phase_names, 3);
+            res = (s->phase >= 0);
+        }
+        else if (name == "workload")
+        {
+            res = (value.size() == 1 && value[0] >= 'a' && value[0] <= 'f');
+            if (res) set_properties(core_workloads[value[0] - 'a'], &s->props);
+        }
+        else if (name == "properties")
+        {
+            res = load_properties(value, &s->props);
+        }
+        else
+        {
+            res = set_property(arg.substr(2), &s->props);
+        }
+
+        if (!res)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Parses properties of workload.
+static bool parse_workload (const properties & props, workload * w)
+{
+    properties p = props;
+
+    w->records    = atoll(p["recordcount"].c_str());
+    w->operations = atoll(p["operationcount"].c_str());
+    w->threads    = atoi(p["threadcount"].c_str());
+    w->fields     = atoi(p["fieldcount"].c_str());
+    w->length     = atoi(p["fieldlength"].c_str());
+    w->writeall   = (p["writeallfields"] == "true");
+    w->dist       = find_name(p["requestdistribution"], dist_names, 3);
+    w->maxscan    = atoi(p["maxscanlength"].c_str());
+    w->scandist   = find_name(p["scanlengthdistribution"], dist_names, 2);
+    w->hashed     = (p["insertorder"] == "hashed");
+    w->durability = find_name(p["durability"], durability_names, 5);
+
+    double total = 0;
+
+    for (int op = OP_INSERT; op < OP_COUNT; op++)
+    {
+        w->proportions[op] = atof(p[op_properties[op]].c_str());
+
+        if (w->proportions[op] < 0) return false;
+        total += w->proportions[op];
+    }
+
+    return (w->records    >  0 &&
+            w->operations >= 0 &&
+            w->threads    >  0 &&
+            w->fields     >  0 &&
+            w->length     >= 0 &&
+            w->dist       >= 0 &&
+            w->maxscan    >  0 &&
+            w->scandist   >= 0 &&
+            w->durability >  0 &&
+            total         >  0);
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Generators.
+//--------------------------------------------------------------------------------------------------
+
+// Pseudo-random generator (xorshift64*).
+class random_generator
+{
+public:
+
+    random_generator (uint64_t seed) : m_state(seed * 0x9E3779B97F4A7C15ULL + 1) { }
+
+    // Returns next pseudo-random number.
+    uint64_t next ()
+    {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+
+        return m_state * 2685821657736338717ULL;
+    }
+
+    // Returns next pseudo-random number from [0, 1).
+    double uniform ()
+    {
+        return (double) (next() >> 11) / 9007199254740992.0;
+    }
+
+protected:
+
+    uint64_t m_state;   // State of the generator.
+};
+
+// Generator of zipfian distribution of [0, n) (the most popular item is "0"), which allows "n" to grow.
+// Zeta of the items is computed by the first call, unless it's specified.
+class zipfian_generator
+{
+public:
+
+    zipfian_generator (int64_t n = 0, double zetan = 0)
+      : m_n(n),
+        m_zetan(zetan),
+        m_zeta2(zeta(0, 2, 0))
+    { }
+
+    // Returns next item of [0, n), updating zeta if number of items is changed.
+    int64_t next (random_generator * rnd, int64_t n)
+    {
+        if (n != m_n)
+        {
+            m_zetan = (n > m_n ? zeta(m_n, n, m_zetan) : zeta(0, n, 0));
+            m_n     = n;
+        }
+
+        double alpha = 1.0 / (1.0 - ZIPF_THETA);
+        double eta   = (1.0 - pow(2.0 / n, 1.0 - ZIPF_THETA)) / (1.0 - m_zeta2 / m_zetan);
+
+        double u  = rnd->uniform();
+        double uz = u * m_zetan;
+
+        if (uz < 1.0) return 0;
+        if (uz < 1.0 + pow(0.5, ZIPF_THETA)) return (n > 1 ? 1 : 0);
+
+        int64_t item = (int64_t) (n * pow(eta * u - eta + 1.0, alpha));
+        return (item < n ? item : n - 1);
+    }
+
+protected:
+
+    // Adds zeta terms of items [from, to) to specified sum.
+    static double zeta (int64_t from, int64_t to, double sum)
+    {
+        for (int64_t i = from; i < to; i++)
+        {
+            sum += 1.0 / pow((double) (i + 1), ZIPF_THETA);
+        }
+
+        return sum;
+    }
+
+protected:
+
+    int64_t m_n;        // Number of items.
+    double  m_zetan;    // Zeta of "n" items.
+    double  m_zeta2;    // Zeta of two items.
+};
+
+// Returns FNV-1a hash of the number (as YCSB hashes keys and scrambled zipfian items).
+static int64_t fnv_hash (int64_t value)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    for (int i = 0; i < 8; i++)
+    {
+        hash ^= (uint64_t) (value & 0xFF);
+        hash *= 1099511628211ULL;
+        value >>= 8;
+    }
+
+    int64_t result = (int64_t) hash;
+    return (result < 0 ? -result : result);
+}
+
+// Sequence of numbers of inserted keys, shared by all threads.
+class key_sequence
+{
+public:
+
+    key_sequence (int64_t start) : m_next(start), m_last(start - 1) { }
+
+    // Returns number of the next key to insert.
+    int64_t next ()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        return m_next++;
+    }
+
+    // Acknowledges that the key is inserted.
+    void acknowledge (int64_t keynum)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        m_done.insert(keynum);
+
+        while (!m_done.empty() && *m_done.begin() == m_last + 1)
+        {
+            m_last++;
+            m_done.erase(m_done.begin());
+        }
+    }
+
+    // Returns the last key, such that it and all keys before it are inserted (read without lock, since
+    // it only grows, and a stale value just makes choice of keys slightly less recent).
+    int64_t last () const
+    {
+        return m_last;
+    }
+
+protected:
+
+    boost::mutex        m_mutex;    // Guards the sequence.
+    int64_t             m_next;     // Number of the next key.
+    volatile int64_t    m_last;     // The last contiguously inserted key.
+    set <int64_t>       m_done;     // Inserted keys after the last contiguous one.
+};
+
+//--------------------------------------------------------------------------------------------------
+//  Benchmark run.
+//--------------------------------------------------------------------------------------------------
+
+// Parameters of one phase, shared by its threads.
+struct run
+{
+    bdb::database * db;
+    bdb::table    * tbl;
+    workload        w;
+    key_sequence  * inserts;    // Keys, inserted by the phase.
+};
+
+// Results of one thread.
+struct thread_result
+{
+    vector <double> latencies[OP_COUNT];            // Latencies of operations, in microseconds.
+    int64_t         returns[OP_COUNT][RET_COUNT];   // Numbers of return codes of operations.
+};
+
+// Client of one thread.
+class client
+{
+public:
+
+    client (const run * r, uint64_t seed)
+      : m_run(r),
+        m_rnd(seed),
+        m_keys(r->w.dist == DIST_ZIPFIAN ? SCRAMBLED_ITEMS : 0, r->w.dist == DIST_ZIPFIAN ? SCRAMBLED_ZETAN : 0)
+    {
+        // YCSB makes room for keys, which are expected to be inserted by the run
+        m_items = r->w.records + (int64_t) (r->w.operations * r->w.proportions[OP_INSERT] * 2.0);
+    }
+
+    // Runs one operation, returns its code.
+    int execute (int op)
+    {
+        try
+        {
+            switch (op)
+            {
+                case OP_INSERT: insert(m_run->inserts->next()); break;
+                case OP_READ:   read();                         break;
+                case OP_UPDATE: update();                       break;
+                case OP_SCAN:   scan();                         break;
+                case OP_RMW:    modify();                       break;
+            }
+        }
+        catch (bdb::exception & e)
+        {
+            return (e.error() == BDB_ERROR_NOT_FOUND ? RET_NOT_FOUND : RET_ERROR);
+        }
+
+        return RET_OK;
+    }
+
+    // Chooses operation by proportions of the workload.
+    int choose_op ()
+    {
+        double total = 0;
+
+        for (int op = OP_INSERT; op < OP_COUNT; op++)
+        {
+            total += m_run->w.proportions[op];
+        }
+
+        double u = m_rnd.uniform() * total;
+
+        for (int op = OP_INSERT; op < OP_COUNT; op++)
+        {
+            if (u < m_run->w.proportions[op]) return op;
+            u -= m_run->w.proportions[op];
+        }
+
+        return OP_READ;
+    }
+
+    // Inserts record with specified number.
+    void insert (int64_t keynum)
+    {
+        make_key(keynum);
+        make_data();
+
+        m_run->db->run_in_transaction(insert_record, this, MAX_RETRIES);
+        m_run->inserts->acknowledge(keynum);
+    }
+
+protected:
+
+    // Reads all fields of existing record.
+    void read ()
+    {
+        make_key(choose_key());
+        m_run->tbl->select(&m_key, &m_data);
+    }
+
+    // Writes all fields of existing record, or modifies one of them (read-modify-write of a record).
+    void update ()
+    {
+        make_key(choose_key());
+
+        if (m_run->w.writeall)
+        {
+            make_data();
+            m_run->db->run_in_transaction(write_record, this, MAX_RETRIES);
+        }
+        else
+        {
+            m_field = (int) (m_rnd.next() % m_run->w.fields);
+            make_field(&m_value);
+
+            m_run->tbl->modify(&m_key, &m_data, modify_field, this);
+        }
+    }
+
+    // Scans records, starting at existing one.
+    void scan ()
+    {
+        make_key(choose_key());
+
+        int length = (m_run->w.scandist == DIST_ZIPFIAN ? (int) m_scans.next(&m_rnd, m_run->w.maxscan) + 1
+                                                        : (int) (m_rnd.next() % m_run->w.maxscan) + 1);
+
+        bdb::recordset rs(m_run->tbl);
+        rs.set_limit(length);
+
+        if (rs.seek(&m_key))
+        {
+            ycsb::key key;
+            while (rs.fetch(&key, &m_data)) {}
+        }
+    }
+
+    // Reads existing record, and writes one of its fields back.
+    void modify ()
+    {
+        make_key(choose_key());
+
+        m_field = (int) (m_rnd.next() % m_run->w.fields);
+        make_field(&m_value);
+
+        m_run->tbl->modify(&m_key, &m_data, modify_field, this);
+    }
+
+    // Inserts the record, called by "bdb::database::run_in_transaction".
+    static void insert_record (bdb::transaction * txn, void * param)
+    {
+        client * c = (client *) param;
+        c->m_run->tbl->insert(&c->m_key, &c->m_data, txn);
+    }
+
+    // Writes the record, called by "bdb::database::run_in_transaction".
+    static void write_record (bdb::transaction * txn, void * param)
+    {
+        client * c = (client *) param;
+        c->m_run->tbl->update(&c->m_key, &c->m_data, txn);
+    }
+
+    // Changes one field of the record, called by "bdb::table::modify".
+    static bool modify_field (google::protobuf::Message * data, void * param)
+    {
+        client     * c   = (client *) param;
+        ycsb::data * rec = static_cast <ycsb::data *> (data);
+
+        while (rec->fields_size() <= c->m_field)
+        {
+            rec->add_fields();
+        }
+
+        rec->set_fields(c->m_field, c->m_value);
+        return true;
+    }
+
+    // Chooses number of existing key by distribution of the workload.
+    int64_t choose_key ()
+    {
+        int64_t last = m_run->inserts->last();
+        int64_t keynum;
+
+        if (m_run->w.dist == DIST_LATEST)
+        {
+            return last - m_keys.next(&m_rnd, last + 1);
+        }
+
+        // keys, which are not inserted yet, are skipped
+        do
+        {
+            if (m_run->w.dist == DIST_ZIPFIAN)
+            {
+                keynum = fnv_hash(m_keys.next(&m_rnd, SCRAMBLED_ITEMS)) % m_items;
+            }
+            else
+            {
+                keynum = (int64_t) (m_rnd.next() % (uint64_t) m_run->w.records);
+            }
+        }
+        while (keynum > last);
+
+        return keynum;
+    }
+
+    // Makes key of record with specified number.
+    void make_key (int64_t keynum)
+    {
+        stringstream key;
+        key << "user" << (m_run->w.hashed ? fnv_hash(keynum) : keynum);
+
+        m_key.set_id(key.str());
+    }
+
+    // Makes random value of a field.
+    void make_field (string * value)
+    {
+        value->resize(m_run->w.length);
+
+        for (int i = 0; i < m_run->w.length; i++)
+        {
+            (*value)[i] = (char) (' ' + m_rnd.next() % 95);
+        }
+    }
+
+    // Makes random values of all fields of the record.
+    void make_data ()
+    {
+        m_data.Clear();
+
+        for (int i = 0; i < m_run->w.fields; i++)
+        {
+            make_field(m_data.add_fields());
+        }
+    }
+
+protected:
+
+    const run *         m_run;      // Parameters of the phase.
+    random_generator    m_rnd;      // Generator of the thread.
+    zipfian_generator   m_keys;     // Generator of keys (if they are zipfian or latest).
+    zipfian_generator   m_scans;    // Generator of lengths of scans (if they are zipfian).
+    int64_t             m_items;    // Number of keys of scrambled zipfian distribution.
+    ycsb::key           m_key;      // Key of current operation.
+    ycsb::data          m_data;     // Data of current operation.
+    int                 m_field;    // Modified field of current operation.
+    string              m_value;    // Value of modified field.
+};
+
+// Current time.
+static inline boost::posix_time::ptime now ()
+{
+    return boost::posix_time::microsec_clock::universal_time();
+}
+
+// Microseconds elapsed since specified time.
+static inline double elapsed (const boost::posix_time::ptime & start)
+{
+    return (double) (now() - start).total_microseconds();
+}
+
+// Thread of benchmark phase.
+static void worker (const run      * r,         // Parameters of the phase.
+                    int              phase,     // Phase to run.
+                    int              thread,    // Number of the thread.
+                    boost::barrier * sync,      // Start barrier.
+                    thread_result  * result)    // Results of the thread.
+{
+    client c(r, (uint64_t) phase * r->w.threads + thread + 1);
+
+    memset(result->returns, 0, sizeof(result->returns));
+
+    // Operations are divided between threads evenly.
+    int64_t count = r->w.operations / r->w.threads + (thread < r->w.operations % r->w.threads ? 1 : 0);
+
+    sync->wait();
+
+    for (int64_t i = 0; phase == PHASE_LOAD || i < count; i++)
+    {
+        int op  = OP_INSERT;
+        int ret = RET_OK;
+
+        boost::posix_time::ptime start = now();
+
+        if (phase == PHASE_LOAD)
+        {
+            int64_t keynum = r->inserts->next();
+            if (keynum >= r->w.records) break;
+
+            try
+            {
+                c.insert(keynum);
+            }
+            catch (bdb::exception &)
+            {
+                ret = RET_ERROR;
+            }
+        }
+        else
+        {
+            op  = c.choose_op();
+            ret = c.execute(op);
+        }
+
+        result->latencies[op].push_back(elapsed(start));
+        result->returns[op][ret]++;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Results.
+//--------------------------------------------------------------------------------------------------
+
+// Returns specified percentile of sorted latencies.
+static double percentile (const vector <double> & sorted, double p)
+{
+    if (sorted.empty()) return 0;
+
+    size_t n = (size_t) ceil(p * sorted.size());
+    return sorted[(n > 0 ? n - 1 : 0)];
+}
+
+// Prints metrics of the phase in YCSB format.
+static void print_metrics (const vector <thread_result> & results, double seconds)
+{
+    size_t total = 0;
+
+    vector <double> latencies[OP_COUNT];
+    int64_t         returns[OP_COUNT][RET_COUNT];
+
+    memset(returns, 0, sizeof(returns));
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        for (int op = OP_INSERT; op < OP_COUNT; op++)
+        {
+            latencies[op].insert(latencies[op].end(), results[i].latencies[op].begin(), results[i].latencies[op].end());
+
+            for (int ret = RET_OK; ret < RET_COUNT; ret++)
+            {
+                returns[op][ret] += results[i].returns[op][ret];
+            }
+        }
+    }
+
+    for (int op = OP_INSERT; op < OP_COUNT; op++)
+    {
+        total += latencies[op].size();
+    }
+
+    cout << "[OVERALL], RunTime(ms), "          << seconds * 1000.0                      << "\n"
+         << "[OVERALL], Throughput(ops/sec), "  << (seconds > 0 ? total / seconds : 0)  << "\n";
+
+    for (int op = OP_INSERT; op < OP_COUNT; op++)
+    {
+        vector <double> & sorted = latencies[op];
+        if (sorted.empty()) continue;
+
+        sort(sorted.begin(), sorted.end());
+
+        double sum = 0;
+
+        for (size_t i = 0; i < sorted.size(); i++)
+        {
+            sum += sorted[i];
+        }
+
+        string name = string("[") + op_names[op] + "], ";
+
+        cout << name << "Operations, "                  << sorted.size()                << "\n"
+             << name << "AverageLatency(us), "          << sum / sorted.size()          << "\n"
+             << name << "MinLatency(us), "              << sorted.front()               << "\n"
+             << name << "MaxLatency(us), "              << sorted.back()                << "\n"
+             << name << "95thPercentileLatency(us), "   << percentile(sorted, 0.95)     << "\n"
+             << name << "99thPercentileLatency(us), "   << percentile(sorted, 0.99)     << "\n";
+
+        for (int ret = RET_OK; ret < RET_COUNT; ret++)
+        {
+            if (returns[op][ret] != 0) cout << name << "Return=" << ret_names[ret] << ", " << returns[op][ret] << "\n";
+        }
+    }
+
+    cout.flush();
+}
+
+//--------------------------------------------------------------------------------------------------
+//  Benchmark.
+//--------------------------------------------------------------------------------------------------
+
+// Creates directory, returns "false" on failure.
+static bool make_directory (const string & path)
+{
+#ifdef WIN32
+    int res = _mkdir(path.c_str());
+#else
+    int res = mkdir(path.c_str(), 0755);
+#endif
+
+    return (res == 0 || errno == EEXIST);
+}
+
+// Runs specified phase, and prints its metrics.
+static void benchmark (const run * r, int phase)
+{
+    vector <thread_result> results(r->w.threads);
+    boost::barrier         sync(r->w.threads + 1);
+    boost::thread_group    group;
+
+    for (int i = 0; i < r->w.threads; i++)
+    {
+        group.create_thread(boost::bind(&worker, r, phase, i, &sync, &results[i]));
+    }
+
+    sync.wait();
+
+    boost::posix_time::ptime start = now();
+    group.join_all();
+
+    print_metrics(results, elapsed(start) / 1000000.0);
+}
+
+int main (int argc, char ** argv)
+{
+    log4cplus::BasicConfigurator::doConfigure();
+    log4cplus::Logger::getInstance(BDB_LOGGER_PORT).setLogLevel(log4cplus::OFF_LOG_LEVEL);
+
+    settings s;
+    run      r;
+
+    if (!parse_settings(argc, argv, &s) || !parse_workload(s.props, &r.w))
+    {
+        usage();
+        return -1;
+    }
+
+    if (!make_directory(s.home))
+    {
+        cerr << "Cannot create directory \"" << s.home << "\".\n";
+        return -1;
+    }
+
+    try
+    {
+        r.db = new bdb::database(s.home.c_str(), true);
+        r.db->set_durability(r.w.durability, 1000);
+
+        r.tbl = r.db->add_table("usertable", bdb::string_key_compare, true);
+
+        if (s.phase != PHASE_RUN)
+        {
+            key_sequence inserts(0);
+            r.inserts = &inserts;
+
+            benchmark(&r, PHASE_LOAD);
+        }
+
+        if (s.phase != PHASE_LOAD)
+        {
+            if (s.phase == PHASE_ALL) cout << "\n";
+
+            key_sequence inserts(r.w.records);
+            r.inserts = &inserts;
+
+            benchmark(&r, PHASE_RUN);
+        }
+
+        delete r.db;
+    }
+    catch (bdb::exception & e)
+    {
+        cerr << "Benchmark failed with error " << e.error() << " in \"" << s.home << "\".\n";
+        return -1;
+    }
+
+    return 0;
+}